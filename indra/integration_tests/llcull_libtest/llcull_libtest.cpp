@@ -0,0 +1,371 @@
+/** 
+ * @file llcull_libtest.cpp
+ * @brief Headless benchmark for octree frustum culling
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "llcamera.h"
+#include "llvector4a.h"
+
+// system libraries
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// doc string provided when invoking the program with --help 
+static const char USAGE[] = "\n"
+"usage:\tllcull_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --input <file>\n"
+"        Scene bounds to cull, one box per line as \"cx cy cz rx ry rz\" in agent space.\n"
+"        Default is a synthetic region of randomly placed boxes.\n"
+" -n, --count <n>\n"
+"        Number of boxes in the synthetic scene. Default is 20000.\n"
+" -f, --frames <n>\n"
+"        Number of camera positions to cull from. Default is 500.\n"
+" -l, --leaf <n>\n"
+"        Maximum number of boxes in a leaf node. Default is 8.\n"
+"\n";
+
+// Octree node built from the scene bounds.  Parents hold the union of their
+// children's bounds, like LLViewerOctreeGroup::mBounds after rebound().
+struct CullNode
+{
+	LLVector4a mCenter;
+	LLVector4a mRadius;
+	std::vector<CullNode*> mChildren;
+	std::vector<S32> mBoxes;
+
+	~CullNode()
+	{
+		for (U32 i = 0; i < mChildren.size(); i++)
+		{
+			delete mChildren[i];
+		}
+	}
+};
+
+struct Box
+{
+	LLVector4a mCenter;
+	LLVector4a mRadius;
+};
+
+static void calc_bounds(CullNode* node, const std::vector<Box>& boxes)
+{
+	LLVector4a min, max;
+	min.splat(FLT_MAX);
+	max.splat(-FLT_MAX);
+
+	for (U32 i = 0; i < node->mBoxes.size(); i++)
+	{
+		const Box& box = boxes[node->mBoxes[i]];
+		LLVector4a lo, hi;
+		lo.setSub(box.mCenter, box.mRadius);
+		hi.setAdd(box.mCenter, box.mRadius);
+		min.setMin(min, lo);
+		max.setMax(max, hi);
+	}
+	for (U32 i = 0; i < node->mChildren.size(); i++)
+	{
+		const CullNode* child = node->mChildren[i];
+		LLVector4a lo, hi;
+		lo.setSub(child->mCenter, child->mRadius);
+		hi.setAdd(child->mCenter, child->mRadius);
+		min.setMin(min, lo);
+		max.setMax(max, hi);
+	}
+
+	node->mCenter.setAdd(min, max);
+	node->mCenter.mul(0.5f);
+	node->mRadius.setSub(max, min);
+	node->mRadius.mul(0.5f);
+}
+
+// splits around the center of the node's volume into octants, the way
+// LLOctreeNode places elements by their position
+static CullNode* build_tree(std::vector<S32>& ids, const std::vector<Box>& boxes, const LLVector4a& center, F32 size, U32 leaf_size, S32 depth)
+{
+	CullNode* node = new CullNode;
+	if (ids.size() <= leaf_size || depth > 12)
+	{
+		node->mBoxes.swap(ids);
+	}
+	else
+	{
+		std::vector<S32> octants[8];
+		for (U32 i = 0; i < ids.size(); i++)
+		{
+			const LLVector4a& pos = boxes[ids[i]].mCenter;
+			U32 octant = (pos[0] > center[0] ? 1 : 0) | (pos[1] > center[1] ? 2 : 0) | (pos[2] > center[2] ? 4 : 0);
+			octants[octant].push_back(ids[i]);
+		}
+
+		F32 half = size * 0.5f;
+		for (U32 i = 0; i < 8; i++)
+		{
+			if (octants[i].empty())
+			{
+				continue;
+			}
+			LLVector4a child_center(center[0] + ((i & 1) ? half : -half),
+									center[1] + ((i & 2) ? half : -half),
+									center[2] + ((i & 4) ? half : -half));
+			node->mChildren.push_back(build_tree(octants[i], boxes, child_center, half, leaf_size, depth + 1));
+		}
+	}
+	calc_bounds(node, boxes);
+	return node;
+}
+
+// same shape as LLViewerOctreeCull::traverse(), one frustum test per node
+static void cull_single(LLCamera& camera, const CullNode* node, S32 res, U32& visible)
+{
+	if (res != 2)
+	{
+		res = camera.AABBInFrustumNoFarClip(node->mCenter, node->mRadius);
+		if (!res)
+		{
+			return;
+		}
+	}
+
+	visible += node->mBoxes.size();
+	for (U32 i = 0; i < node->mChildren.size(); i++)
+	{
+		cull_single(camera, node->mChildren[i], res, visible);
+	}
+}
+
+// tests the children of a partially visible node together, the way
+// LLViewerOctreeCull::traverseChildren() does
+static void cull_batched(LLCamera& camera, const CullNode* node, S32 res, U32& visible)
+{
+	visible += node->mBoxes.size();
+
+	U32 count = node->mChildren.size();
+	if (res == 2)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			cull_batched(camera, node->mChildren[i], 2, visible);
+		}
+		return;
+	}
+
+	LLAABBBatch batch;
+	S32 results[LLAABBBatch::MAX_BOXES];
+	for (U32 i = 0; i < count; i++)
+	{
+		batch.add(node->mChildren[i]->mCenter, node->mChildren[i]->mRadius);
+	}
+	camera.AABBInFrustum(batch, results, NULL, false);
+
+	for (U32 i = 0; i < count; i++)
+	{
+		if (results[i])
+		{
+			cull_batched(camera, node->mChildren[i], results[i], visible);
+		}
+	}
+}
+
+static bool load_bounds(const std::string& filename, std::vector<Box>& boxes)
+{
+	std::ifstream input(filename.c_str());
+	if (!input.is_open())
+	{
+		return false;
+	}
+
+	F32 cx, cy, cz, rx, ry, rz;
+	while (input >> cx >> cy >> cz >> rx >> ry >> rz)
+	{
+		Box box;
+		box.mCenter.set(cx, cy, cz);
+		box.mRadius.set(rx, ry, rz);
+		boxes.push_back(box);
+	}
+	return !boxes.empty();
+}
+
+static void make_bounds(U32 count, std::vector<Box>& boxes)
+{
+	U32 seed = 12345;
+	for (U32 i = 0; i < count; i++)
+	{
+		F32 v[6];
+		for (U32 j = 0; j < 6; j++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			v[j] = (seed >> 8) / 16777216.f;
+		}
+		Box box;
+		box.mCenter.set(v[0] * 256.f, v[1] * 256.f, 20.f + v[2] * 60.f);
+		box.mRadius.set(0.25f + v[3] * v[3] * 8.f, 0.25f + v[4] * v[4] * 8.f, 0.25f + v[5] * v[5] * 8.f);
+		boxes.push_back(box);
+	}
+}
+
+static void setup_camera(LLCamera& camera, U32 frame, U32 frames)
+{
+	F32 angle = F_TWO_PI * frame / frames;
+	LLVector3 origin(128.f + cosf(angle) * 96.f, 128.f + sinf(angle) * 96.f, 40.f);
+	LLVector3 at(128.f + cosf(angle * 3.f) * 64.f, 128.f + sinf(angle * 2.f) * 64.f, 30.f);
+
+	camera.lookAt(origin, at);
+	camera.setFar(128.f);
+
+	F32 tan_y = tanf(camera.getView() * 0.5f);
+	F32 tan_x = tan_y * camera.getAspect();
+	LLVector3 near_center = origin + camera.getAtAxis() * camera.getNear();
+	LLVector3 right = camera.getLeftAxis() * (-camera.getNear() * tan_x);
+	LLVector3 up = camera.getUpAxis() * (camera.getNear() * tan_y);
+
+	LLVector3 frust[8];
+	frust[0] = near_center - right - up;
+	frust[1] = near_center + right - up;
+	frust[2] = near_center + right + up;
+	frust[3] = near_center - right + up;
+	for (U32 i = 0; i < 4; i++)
+	{
+		LLVector3 vec = frust[i] - origin;
+		vec.normVec();
+		frust[i+4] = origin + vec * camera.getFar();
+	}
+	camera.calcAgentFrustumPlanes(frust);
+}
+
+int main(int argc, char** argv)
+{
+	std::string input_filename;
+	U32 count = 20000;
+	U32 frames = 500;
+	U32 leaf_size = 8;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--input") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			input_filename = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--count") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			count = atoi(argv[++arg]);
+		}
+		else if ((!strcmp(argv[arg], "--frames") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			frames = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--leaf") || !strcmp(argv[arg], "-l")) && arg < argc-1)
+		{
+			leaf_size = llmax(atoi(argv[++arg]), 1);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<Box> boxes;
+	if (!input_filename.empty())
+	{
+		if (!load_bounds(input_filename, boxes))
+		{
+			std::cout << "Could not read bounds from " << input_filename << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		make_bounds(count, boxes);
+	}
+
+	// root covers the scene the way a region's octree covers the region
+	LLVector4a min, max;
+	min.splat(FLT_MAX);
+	max.splat(-FLT_MAX);
+	std::vector<S32> ids;
+	for (U32 i = 0; i < boxes.size(); i++)
+	{
+		min.setMin(min, boxes[i].mCenter);
+		max.setMax(max, boxes[i].mCenter);
+		ids.push_back(i);
+	}
+	LLVector4a center;
+	center.setAdd(min, max);
+	center.mul(0.5f);
+	LLVector4a extent;
+	extent.setSub(max, min);
+	F32 size = llmax(extent[0], llmax(extent[1], extent[2])) * 0.5f;
+
+	CullNode* root = build_tree(ids, boxes, center, size, leaf_size, 0);
+
+	LLCamera camera;
+	U32 single_visible = 0;
+	U32 batched_visible = 0;
+
+	LLTimer timer;
+	for (U32 frame = 0; frame < frames; frame++)
+	{
+		setup_camera(camera, frame, frames);
+		cull_single(camera, root, 0, single_visible);
+	}
+	F64 single_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	for (U32 frame = 0; frame < frames; frame++)
+	{
+		setup_camera(camera, frame, frames);
+		S32 res = camera.AABBInFrustumNoFarClip(root->mCenter, root->mRadius);
+		if (res)
+		{
+			cull_batched(camera, root, res, batched_visible);
+		}
+	}
+	F64 batched_time = timer.getElapsedTimeF64();
+
+	std::cout << "boxes : " << boxes.size() << ", frames : " << frames << std::endl;
+	std::cout << "single box cull : " << single_time * 1000.0 / frames << " ms/frame, visible : " << single_visible << std::endl;
+	std::cout << "batched cull    : " << batched_time * 1000.0 / frames << " ms/frame, visible : " << batched_visible << std::endl;
+
+	delete root;
+
+	if (single_visible != batched_visible)
+	{
+		std::cout << "Batched cull disagrees with the single box cull" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,319 @@
+/**
+ * @file llinvcache_libtest.cpp
+ * @brief Headless benchmark for loading the login inventory cache
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "llfile.h"
+#include "llinventory.h"
+#include "llinventorycache.h"
+#include "llparallelfor.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "llsys.h"
+
+// system libraries
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllinvcache_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --items <n>\n"
+"        Number of synthetic inventory items. Default is 300000, a very large inventory.\n"
+" -f, --folders <n>\n"
+"        Number of synthetic folders. Default is 6000.\n"
+" -t, --threads <n>\n"
+"        Number of worker threads for the binary load. Default is based on CPU cores.\n"
+"\n";
+
+// same chunking as LLInventoryModel::loadFromBinaryFile()
+static const S32 LOAD_CHUNK = 4096;
+
+typedef std::vector<LLPointer<LLInventoryCategory> > cat_array_t;
+typedef std::vector<LLPointer<LLInventoryItem> > item_array_t;
+
+static U32 next_random(U32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+// A spread of item kinds roughly like a long-lived inventory: mostly
+// objects, textures and clothing, a good share of links and no-mod items.
+static void make_inventory(S32 folder_count, S32 item_count, cat_array_t& categories, item_array_t& items)
+{
+	static const LLAssetType::EType ASSET_TYPES[] =
+	{
+		LLAssetType::AT_OBJECT, LLAssetType::AT_TEXTURE, LLAssetType::AT_CLOTHING,
+		LLAssetType::AT_NOTECARD, LLAssetType::AT_LSL_TEXT, LLAssetType::AT_LANDMARK,
+		LLAssetType::AT_BODYPART, LLAssetType::AT_LINK
+	};
+	static const S32 ASSET_TYPE_COUNT = sizeof(ASSET_TYPES) / sizeof(ASSET_TYPES[0]);
+
+	U32 seed = 24680;
+	LLUUID root_id;
+	root_id.generate();
+	for (S32 i = 0; i < folder_count; ++i)
+	{
+		LLUUID id;
+		id.generate();
+		const LLUUID& parent_id = i ? categories[next_random(seed) % i]->getUUID() : root_id;
+		std::ostringstream name;
+		name << "Folder " << i;
+		categories.push_back(new LLInventoryCategory(id, parent_id, LLFolderType::FT_NONE, name.str()));
+	}
+
+	LLUUID creator_id, owner_id, group_id;
+	creator_id.generate();
+	owner_id.generate();
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		LLUUID id, asset_id;
+		id.generate();
+		asset_id.generate();
+		LLAssetType::EType type = ASSET_TYPES[next_random(seed) % ASSET_TYPE_COUNT];
+		PermissionMask base = (next_random(seed) % 3) ? PERM_ALL : (PERM_MOVE | PERM_COPY);
+		LLPermissions perm;
+		perm.init(creator_id, owner_id, creator_id, group_id);
+		perm.initMasks(base, base, PERM_NONE, PERM_NONE, PERM_MOVE | PERM_TRANSFER);
+		std::ostringstream name;
+		name << "Item " << i << " (" << LLAssetType::lookup(type) << ")";
+		std::string desc = (next_random(seed) % 4) ? std::string() : std::string("(No Description)");
+		items.push_back(new LLInventoryItem(id, categories[next_random(seed) % folder_count]->getUUID(),
+			perm, asset_id, type, LLInventoryType::defaultForAssetType(type), name.str(), desc,
+			LLSaleInfo::DEFAULT, 0, 1262304000 + (S32)(next_random(seed) % 400000000)));
+	}
+}
+
+// what LLInventoryModel::saveToFile() + cache() write
+static void save_notation(const std::string& filename, const cat_array_t& categories, const item_array_t& items)
+{
+	std::string plain_filename = filename + ".tmp";
+	{
+		llofstream file(plain_filename.c_str());
+		LLSD cache_ver;
+		cache_ver["inv_cache_version"] = 2;
+		file << LLSDOStreamer<LLSDNotationFormatter>(cache_ver) << std::endl;
+		for (U32 i = 0; i < categories.size(); ++i)
+		{
+			file << LLSDOStreamer<LLSDNotationFormatter>(categories[i]->exportLLSD()) << std::endl;
+		}
+		for (U32 i = 0; i < items.size(); ++i)
+		{
+			file << LLSDOStreamer<LLSDNotationFormatter>(items[i]->asLLSD()) << std::endl;
+		}
+	}
+	gzip_file(plain_filename, filename);
+	LLFile::remove(plain_filename);
+}
+
+// what LLInventoryModel::loadSkeleton() + loadFromFile() do
+static void load_notation(const std::string& filename, cat_array_t& categories, item_array_t& items)
+{
+	std::string plain_filename = filename + ".tmp";
+	gunzip_file(filename, plain_filename);
+	llifstream file(plain_filename.c_str());
+	std::string line;
+	LLPointer<LLSDParser> parser = new LLSDNotationParser();
+	while (std::getline(file, line))
+	{
+		LLSD s_item;
+		std::istringstream iss(line);
+		if (parser->parse(iss, s_item, line.length()) == LLSDParser::PARSE_FAILURE)
+		{
+			break;
+		}
+		if (s_item.has("cat_id"))
+		{
+			LLPointer<LLInventoryCategory> inv_cat = new LLInventoryCategory(LLUUID::null, LLUUID::null, LLFolderType::FT_NONE, "");
+			inv_cat->importLLSD(s_item);
+			categories.push_back(inv_cat);
+		}
+		else if (s_item.has("item_id"))
+		{
+			LLPointer<LLInventoryItem> inv_item = new LLInventoryItem;
+			if (inv_item->fromLLSD(s_item))
+			{
+				items.push_back(inv_item);
+			}
+		}
+	}
+	file.close();
+	LLFile::remove(plain_filename);
+}
+
+static void save_binary(const std::string& filename, const cat_array_t& categories, const item_array_t& items)
+{
+	LLInventoryCacheFile cache_file;
+	cache_file.setCacheVersion(2);
+	cache_file.reserve(categories.size(), items.size());
+	for (U32 i = 0; i < categories.size(); ++i)
+	{
+		cache_file.addCategory(categories[i], LLUUID::null, 1);
+	}
+	for (U32 i = 0; i < items.size(); ++i)
+	{
+		cache_file.addItem(items[i]);
+	}
+	cache_file.save(filename);
+}
+
+// what LLInventoryModel::loadFromBinaryFile() does
+static bool load_binary(const std::string& filename, LLParallelFor& pool, cat_array_t& categories, item_array_t& items)
+{
+	LLInventoryCacheFile cache_file;
+	if (cache_file.load(filename) != LLInventoryCacheFile::LOAD_OK)
+	{
+		return false;
+	}
+	for (S32 i = 0; i < cache_file.getCategoryCount(); ++i)
+	{
+		LLPointer<LLInventoryCategory> inv_cat = new LLInventoryCategory(LLUUID::null, LLUUID::null, LLFolderType::FT_NONE, "");
+		cache_file.getCategory(i, inv_cat);
+		categories.push_back(inv_cat);
+	}
+	const S32 item_count = cache_file.getItemCount();
+	items.resize(item_count);
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		items[i] = new LLInventoryItem;
+	}
+	const S32 chunk_count = (item_count + LOAD_CHUNK - 1) / LOAD_CHUNK;
+	pool.run(chunk_count, [&](S32 chunk)
+	{
+		const S32 end = llmin(item_count, (chunk + 1) * LOAD_CHUNK);
+		for (S32 i = chunk * LOAD_CHUNK; i < end; ++i)
+		{
+			cache_file.getItem(i, items[i]);
+		}
+	});
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		LLInventoryCacheFile::claimItemStrings(items[i]);
+	}
+	return true;
+}
+
+static bool same_inventory(const item_array_t& a, const item_array_t& b)
+{
+	if (a.size() != b.size())
+	{
+		return false;
+	}
+	for (U32 i = 0; i < a.size(); ++i)
+	{
+		if (!llsd_equals(a[i]->asLLSD(), b[i]->asLLSD()))
+		{
+			std::cout << "Item " << a[i]->getUUID() << " differs" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	S32 item_count = 300000;
+	S32 folder_count = 6000;
+	S32 threads = LLParallelFor::getDefaultWorkerCount();
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--items") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			item_count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--folders") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			folder_count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--threads") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			threads = atoi(argv[++arg]);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+	threads = llmax(threads, 0);
+
+	cat_array_t categories;
+	item_array_t items;
+	make_inventory(folder_count, item_count, categories, items);
+
+	std::string base = std::string(LLFile::tmpdir()) + "llinvcache_libtest";
+	std::string notation_filename = base + ".inv.llsd.gz";
+	std::string binary_filename = base + ".inv.bin.gz";
+	save_notation(notation_filename, categories, items);
+	save_binary(binary_filename, categories, items);
+
+	LLTimer timer;
+	cat_array_t notation_categories;
+	item_array_t notation_items;
+	timer.reset();
+	load_notation(notation_filename, notation_categories, notation_items);
+	F64 notation_time = timer.getElapsedTimeF64();
+
+	LLParallelFor pool("InventoryCacheLoad", threads);
+	cat_array_t binary_categories;
+	item_array_t binary_items;
+	timer.reset();
+	bool loaded = load_binary(binary_filename, pool, binary_categories, binary_items);
+	F64 binary_time = timer.getElapsedTimeF64();
+
+	llstat notation_stat, binary_stat;
+	LLFile::stat(notation_filename, &notation_stat);
+	LLFile::stat(binary_filename, &binary_stat);
+
+	std::cout << "folders : " << folder_count << ", items : " << item_count << std::endl;
+	std::cout << "notation load : " << notation_time * 1000.0 << " ms, file : " << notation_stat.st_size / 1024 << " KB" << std::endl;
+	std::cout << "binary load   : " << binary_time * 1000.0 << " ms, file : " << binary_stat.st_size / 1024 << " KB"
+			  << ", threads : " << threads << std::endl;
+
+	LLFile::remove(notation_filename);
+	LLFile::remove(binary_filename);
+
+	// both formats have to hand the model the very same items
+	if (!loaded || notation_categories.size() != binary_categories.size()
+		|| !same_inventory(notation_items, binary_items))
+	{
+		std::cout << "Binary cache disagrees with the notation cache" << std::endl;
+		return 1;
+	}
+	return 0;
+}
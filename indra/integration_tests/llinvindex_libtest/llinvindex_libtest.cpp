@@ -0,0 +1,410 @@
+/**
+ * @file llinvindex_libtest.cpp
+ * @brief Headless benchmark for the inventory model indices
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "lluuid.h"
+
+// system libraries
+#include <iostream>
+#include <map>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllinvindex_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --items <n>\n"
+"        Number of synthetic inventory items. Default is 300000.\n"
+" -f, --folders <n>\n"
+"        Number of synthetic folders. Default is 6000.\n"
+" -l, --links <percent>\n"
+"        Share of the items that are links. Default is 15.\n"
+" -r, --repeat <n>\n"
+"        Number of times each operation is timed. Default is 10.\n"
+"\n";
+
+// the parts of an inventory object the model's indices care about
+struct Object
+{
+	LLUUID mID;
+	LLUUID mParentID;
+	LLUUID mLinkedID;	// null unless a link
+	bool mIsCategory;
+};
+
+typedef std::vector<Object*> child_array_t;
+
+// LLInventoryModel's indices before: ordered maps, heap allocated child
+// arrays and an ordered multimap of backlinks.
+struct OrderedModel
+{
+	typedef std::map<LLUUID, Object*> object_map_t;
+	typedef std::map<LLUUID, child_array_t*> parent_map_t;
+	typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
+
+	object_map_t mCategoryMap;
+	object_map_t mItemMap;
+	parent_map_t mParentChildCategoryTree;
+	parent_map_t mParentChildItemTree;
+	backlink_mmap_t mBacklinkMMap;
+
+	~OrderedModel()
+	{
+		for (parent_map_t::iterator it = mParentChildCategoryTree.begin(); it != mParentChildCategoryTree.end(); ++it)
+		{
+			delete it->second;
+		}
+		for (parent_map_t::iterator it = mParentChildItemTree.begin(); it != mParentChildItemTree.end(); ++it)
+		{
+			delete it->second;
+		}
+	}
+
+	void addCategory(Object* cat)
+	{
+		mCategoryMap[cat->mID] = cat;
+		mParentChildCategoryTree[cat->mID] = new child_array_t;
+		mParentChildItemTree[cat->mID] = new child_array_t;
+	}
+
+	void addItem(Object* item)
+	{
+		mItemMap[item->mID] = item;
+		if (item->mLinkedID.notNull())
+		{
+			mBacklinkMMap.insert(std::make_pair(item->mLinkedID, item->mID));
+		}
+	}
+
+	child_array_t* getChildCategories(const LLUUID& id) const
+	{
+		parent_map_t::const_iterator it = mParentChildCategoryTree.find(id);
+		return it != mParentChildCategoryTree.end() ? it->second : NULL;
+	}
+
+	child_array_t* getChildItems(const LLUUID& id) const
+	{
+		parent_map_t::const_iterator it = mParentChildItemTree.find(id);
+		return it != mParentChildItemTree.end() ? it->second : NULL;
+	}
+
+	Object* getItem(const LLUUID& id) const
+	{
+		object_map_t::const_iterator it = mItemMap.find(id);
+		return it != mItemMap.end() ? it->second : NULL;
+	}
+
+	template <typename F>
+	void forEachBacklink(const LLUUID& target_id, F func) const
+	{
+		std::pair<backlink_mmap_t::const_iterator, backlink_mmap_t::const_iterator> range = mBacklinkMMap.equal_range(target_id);
+		for (backlink_mmap_t::const_iterator it = range.first; it != range.second; ++it)
+		{
+			func(it->second);
+		}
+	}
+};
+
+// And after: hashed indices with the child arrays stored in the map nodes.
+struct HashedModel
+{
+	typedef boost::unordered_map<LLUUID, Object*, FSUUIDHash> object_map_t;
+	typedef boost::unordered_map<LLUUID, child_array_t, FSUUIDHash> parent_map_t;
+	typedef boost::unordered_multimap<LLUUID, LLUUID, FSUUIDHash> backlink_mmap_t;
+
+	object_map_t mCategoryMap;
+	object_map_t mItemMap;
+	parent_map_t mParentChildCategoryTree;
+	parent_map_t mParentChildItemTree;
+	backlink_mmap_t mBacklinkMMap;
+
+	void addCategory(Object* cat)
+	{
+		mCategoryMap[cat->mID] = cat;
+		mParentChildCategoryTree[cat->mID];
+		mParentChildItemTree[cat->mID];
+	}
+
+	void addItem(Object* item)
+	{
+		mItemMap[item->mID] = item;
+		if (item->mLinkedID.notNull())
+		{
+			mBacklinkMMap.insert(std::make_pair(item->mLinkedID, item->mID));
+		}
+	}
+
+	child_array_t* getChildCategories(const LLUUID& id) const
+	{
+		parent_map_t::const_iterator it = mParentChildCategoryTree.find(id);
+		return it != mParentChildCategoryTree.end() ? const_cast<child_array_t*>(&it->second) : NULL;
+	}
+
+	child_array_t* getChildItems(const LLUUID& id) const
+	{
+		parent_map_t::const_iterator it = mParentChildItemTree.find(id);
+		return it != mParentChildItemTree.end() ? const_cast<child_array_t*>(&it->second) : NULL;
+	}
+
+	Object* getItem(const LLUUID& id) const
+	{
+		object_map_t::const_iterator it = mItemMap.find(id);
+		return it != mItemMap.end() ? it->second : NULL;
+	}
+
+	template <typename F>
+	void forEachBacklink(const LLUUID& target_id, F func) const
+	{
+		std::pair<backlink_mmap_t::const_iterator, backlink_mmap_t::const_iterator> range = mBacklinkMMap.equal_range(target_id);
+		for (backlink_mmap_t::const_iterator it = range.first; it != range.second; ++it)
+		{
+			func(it->second);
+		}
+	}
+};
+
+static U32 next_random(U32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return seed >> 8;
+}
+
+// Random folder tree under one root, items spread over it, links pointing
+// at random non-link items (so some items collect several links).
+static void make_inventory(S32 folder_count, S32 item_count, S32 link_percent,
+						   std::vector<Object>& folders, std::vector<Object>& items)
+{
+	U32 seed = 97531;
+	folders.resize(folder_count);
+	for (S32 i = 0; i < folder_count; ++i)
+	{
+		folders[i].mID.generate();
+		folders[i].mParentID = i ? folders[next_random(seed) % i].mID : LLUUID::null;
+		folders[i].mIsCategory = true;
+	}
+	items.resize(item_count);
+	S32 target_count = 0;
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		Object& item = items[i];
+		item.mID.generate();
+		item.mParentID = folders[next_random(seed) % folder_count].mID;
+		item.mIsCategory = false;
+		if (target_count > 0 && (S32)(next_random(seed) % 100) < link_percent)
+		{
+			item.mLinkedID = items[next_random(seed) % target_count].mID;
+		}
+		else
+		{
+			// keep the link targets at the front
+			std::swap(item.mID, items[target_count].mID);
+			std::swap(item.mParentID, items[target_count].mParentID);
+			++target_count;
+		}
+	}
+}
+
+template <class MODEL>
+static void fill_model(MODEL& model, std::vector<Object>& folders, std::vector<Object>& items)
+{
+	for (U32 i = 0; i < folders.size(); ++i)
+	{
+		model.addCategory(&folders[i]);
+	}
+	for (U32 i = 1; i < folders.size(); ++i)
+	{
+		model.getChildCategories(folders[i].mParentID)->push_back(&folders[i]);
+	}
+	for (U32 i = 0; i < items.size(); ++i)
+	{
+		model.addItem(&items[i]);
+		model.getChildItems(items[i].mParentID)->push_back(&items[i]);
+	}
+}
+
+// LLInventoryModel::collectDescendentsIf() with a predicate that takes everything
+template <class MODEL>
+static void collect_descendents(const MODEL& model, const LLUUID& id, U64& cats, U64& items)
+{
+	child_array_t* cat_array = model.getChildCategories(id);
+	if (cat_array)
+	{
+		for (U32 i = 0; i < cat_array->size(); ++i)
+		{
+			++cats;
+			collect_descendents(model, (*cat_array)[i]->mID, cats, items);
+		}
+	}
+	child_array_t* item_array = model.getChildItems(id);
+	if (item_array)
+	{
+		items += item_array->size();
+	}
+}
+
+// LLInventoryModel::getBacklinkCount() over every item
+template <class MODEL>
+static U64 count_links(const MODEL& model, const std::vector<Object>& items)
+{
+	U64 count = 0;
+	for (U32 i = 0; i < items.size(); ++i)
+	{
+		model.forEachBacklink(items[i].mID, [&count](const LLUUID&) { ++count; });
+	}
+	return count;
+}
+
+// LLInventoryModel::collectLinksTo() for a sample of targets
+template <class MODEL>
+static U64 find_links(const MODEL& model, const std::vector<Object>& items, U32 stride)
+{
+	U64 found = 0;
+	for (U32 i = 0; i < items.size(); i += stride)
+	{
+		model.forEachBacklink(items[i].mID, [&model, &found](const LLUUID& link_id)
+		{
+			if (model.getItem(link_id))
+			{
+				++found;
+			}
+		});
+	}
+	return found;
+}
+
+struct Results
+{
+	U64 mCats;
+	U64 mItems;
+	U64 mLinks;
+	U64 mFound;
+	F64 mTraverseTime;
+	F64 mCountTime;
+	F64 mFindTime;
+};
+
+template <class MODEL>
+static void run(const MODEL& model, const LLUUID& root_id, const std::vector<Object>& items, U32 repeat, Results& results)
+{
+	LLTimer timer;
+	results.mTraverseTime = results.mCountTime = results.mFindTime = 0.0;
+	for (U32 r = 0; r < repeat; ++r)
+	{
+		results.mCats = results.mItems = 0;
+		timer.reset();
+		collect_descendents(model, root_id, results.mCats, results.mItems);
+		results.mTraverseTime += timer.getElapsedTimeF64();
+
+		timer.reset();
+		results.mLinks = count_links(model, items);
+		results.mCountTime += timer.getElapsedTimeF64();
+
+		timer.reset();
+		results.mFound = find_links(model, items, 7);
+		results.mFindTime += timer.getElapsedTimeF64();
+	}
+}
+
+static void print(const char* label, const Results& results, U32 repeat)
+{
+	std::cout << label << " traverse : " << results.mTraverseTime * 1000.0 / repeat << " ms"
+			  << ", count links : " << results.mCountTime * 1000.0 / repeat << " ms"
+			  << ", find links : " << results.mFindTime * 1000.0 / repeat << " ms" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	S32 item_count = 300000;
+	S32 folder_count = 6000;
+	S32 link_percent = 15;
+	U32 repeat = 10;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--items") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			item_count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--folders") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			folder_count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--links") || !strcmp(argv[arg], "-l")) && arg < argc-1)
+		{
+			link_percent = llclamp(atoi(argv[++arg]), 0, 100);
+		}
+		else if ((!strcmp(argv[arg], "--repeat") || !strcmp(argv[arg], "-r")) && arg < argc-1)
+		{
+			repeat = llmax(atoi(argv[++arg]), 1);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<Object> folders;
+	std::vector<Object> items;
+	make_inventory(folder_count, item_count, link_percent, folders, items);
+	const LLUUID root_id = folders[0].mID;
+
+	Results ordered_results, hashed_results;
+	{
+		OrderedModel model;
+		fill_model(model, folders, items);
+		run(model, root_id, items, repeat, ordered_results);
+	}
+	{
+		HashedModel model;
+		fill_model(model, folders, items);
+		run(model, root_id, items, repeat, hashed_results);
+	}
+
+	std::cout << "folders : " << folder_count << ", items : " << item_count
+			  << ", links : " << ordered_results.mLinks << std::endl;
+	print("ordered maps :", ordered_results, repeat);
+	print("hashed       :", hashed_results, repeat);
+
+	// the two layouts have to see the same inventory
+	if (ordered_results.mCats != hashed_results.mCats || ordered_results.mItems != hashed_results.mItems
+		|| ordered_results.mLinks != hashed_results.mLinks || ordered_results.mFound != hashed_results.mFound)
+	{
+		std::cout << "Hashed indices disagree with the ordered maps" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,371 @@
+/**
+ * @file llpartsim_libtest.cpp
+ * @brief Headless benchmark for the particle group update
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "llmath.h"
+#include "llparallelfor.h"
+#include "llpartdata.h"
+
+// system libraries
+#include <iostream>
+#include <vector>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllpartsim_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -s, --sources <n>\n"
+"        Number of synthetic particle sources. Default is 12, about the viewer's particle limit.\n"
+" -f, --frames <n>\n"
+"        Number of frames to simulate at 45 fps. Default is 600.\n"
+" -t, --threads <n>\n"
+"        Number of worker threads for the parallel update. Default is based on CPU cores.\n"
+"\n";
+
+static const F32 FRAME_TIME = 1.f / 45.f;
+
+// the fields of LLViewerPart the group update reads and writes
+struct Part
+{
+	U32 mFlags;
+	F32 mLastUpdateTime;
+	F32 mMaxAge;
+	LLVector3 mPosAgent;
+	LLVector3 mVelocity;
+	LLVector3 mAccel;
+	LLColor4 mColor;
+	LLColor4 mStartColor;
+	LLColor4 mEndColor;
+	LLVector2 mScale;
+	LLVector2 mStartScale;
+	LLVector2 mEndScale;
+	F32 mStartGlow;
+	F32 mEndGlow;
+	U8 mGlow;
+};
+
+// One synthetic source and the group its particles live in.  Both
+// simulations spawn from a copy of the same sources, so they see the same
+// particles in the same frames.
+struct Source
+{
+	LLPartSysData mData;
+	LLVector3 mPosAgent;
+	F32 mBurstTime;
+	U32 mSeed;
+	std::vector<Part*> mParticles;
+	std::vector<U8> mDead;	// outcome of simulate()
+
+	~Source()
+	{
+		for (U32 i = 0; i < mParticles.size(); i++)
+		{
+			delete mParticles[i];
+		}
+	}
+};
+
+static F32 next_random(U32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return (seed >> 8) / 16777216.f;
+}
+
+static void make_sources(U32 count, std::vector<Source*>& sources)
+{
+	U32 seed = 13579;
+	for (U32 i = 0; i < count; i++)
+	{
+		Source* source = new Source;
+		LLPartSysData& data = source->mData;
+		data.mPattern = LLPartSysData::LL_PART_SRC_PATTERN_EXPLODE;
+		data.mBurstRate = 0.05f + next_random(seed) * 0.25f;
+		data.mBurstPartCount = 5 + (U8) (next_random(seed) * 35.f);
+		data.setBurstSpeedMin(0.2f + next_random(seed));
+		data.setBurstSpeedMax(data.mBurstSpeedMin + next_random(seed) * 2.f);
+		data.setBurstRadius(next_random(seed) * 0.5f);
+		data.setPartAccel(LLVector3(0.f, 0.f, -0.5f - next_random(seed) * 2.f));
+
+		LLPartData& part = data.mPartData;
+		part.mFlags = LLPartData::LL_PART_INTERP_COLOR_MASK | LLPartData::LL_PART_INTERP_SCALE_MASK;
+		part.setMaxAge(2.f + next_random(seed) * 8.f);
+		part.setStartColor(LLVector3(next_random(seed), next_random(seed), next_random(seed)));
+		part.setEndColor(LLVector3(next_random(seed), next_random(seed), next_random(seed)));
+		part.mStartColor.mV[VALPHA] = 1.f;
+		part.mEndColor.mV[VALPHA] = 0.f;
+		part.setStartScale(0.1f + next_random(seed), 0.1f + next_random(seed));
+		part.setEndScale(0.1f + next_random(seed) * 2.f, 0.1f + next_random(seed) * 2.f);
+		part.mStartGlow = next_random(seed) * 0.2f;
+		part.mEndGlow = 0.f;
+
+		source->mPosAgent.setVec(next_random(seed) * 256.f, next_random(seed) * 256.f, 20.f + next_random(seed) * 40.f);
+		source->mBurstTime = 0.f;
+		source->mSeed = seed;
+		sources.push_back(source);
+	}
+}
+
+static void copy_sources(const std::vector<Source*>& from, std::vector<Source*>& to)
+{
+	for (U32 i = 0; i < from.size(); i++)
+	{
+		Source* source = new Source;
+		source->mData = from[i]->mData;
+		source->mPosAgent = from[i]->mPosAgent;
+		source->mBurstTime = from[i]->mBurstTime;
+		source->mSeed = from[i]->mSeed;
+		to.push_back(source);
+	}
+}
+
+// bursts the way LLViewerPartSourceScript::update() does for the explode pattern
+static void spawn(Source* source, F32 dt)
+{
+	const LLPartSysData& data = source->mData;
+	source->mBurstTime += dt;
+	while (source->mBurstTime >= data.mBurstRate)
+	{
+		source->mBurstTime -= data.mBurstRate;
+		for (U32 i = 0; i < data.mBurstPartCount; i++)
+		{
+			Part* part = new Part;
+			part->mFlags = data.mPartData.mFlags;
+			part->mLastUpdateTime = 0.f;
+			part->mMaxAge = data.mPartData.mMaxAge;
+			part->mStartColor = data.mPartData.mStartColor;
+			part->mEndColor = data.mPartData.mEndColor;
+			part->mColor = part->mStartColor;
+			part->mStartScale = data.mPartData.mStartScale;
+			part->mEndScale = data.mPartData.mEndScale;
+			part->mScale = part->mStartScale;
+			part->mStartGlow = data.mPartData.mStartGlow;
+			part->mEndGlow = data.mPartData.mEndGlow;
+			part->mGlow = 0;
+			part->mAccel = data.mPartAccel;
+
+			LLVector3 dir(next_random(source->mSeed) - 0.5f, next_random(source->mSeed) - 0.5f, next_random(source->mSeed) - 0.5f);
+			dir.normVec();
+			F32 speed = lerp(data.mBurstSpeedMin, data.mBurstSpeedMax, next_random(source->mSeed));
+			part->mPosAgent = source->mPosAgent + dir * data.mBurstRadius;
+			part->mVelocity = dir * speed;
+			source->mParticles.push_back(part);
+		}
+	}
+}
+
+// the steps of LLViewerPartGroup::simulate() that don't need the world
+static void simulate(Source* source, F32 dt)
+{
+	std::vector<Part*>& particles = source->mParticles;
+	const S32 count = (S32)particles.size();
+	source->mDead.resize(count);
+	for (S32 i = 0; i < count; i++)
+	{
+		Part* part = particles[i];
+
+		const F32 cur_time = part->mLastUpdateTime + dt;
+		const F32 frac = cur_time / part->mMaxAge;
+
+		part->mPosAgent += dt*part->mVelocity;
+		part->mPosAgent += 0.5f*dt*dt*part->mAccel;
+		part->mVelocity += part->mAccel*dt;
+
+		if (part->mFlags & LLPartData::LL_PART_INTERP_COLOR_MASK)
+		{
+			part->mColor.setVec(part->mStartColor);
+			part->mColor *= 1.f - frac;
+			part->mColor %= 1.f - frac;
+			part->mColor += frac%(frac*part->mEndColor);
+		}
+
+		if (part->mFlags & LLPartData::LL_PART_INTERP_SCALE_MASK)
+		{
+			part->mScale.setVec(part->mStartScale);
+			part->mScale *= 1.f - frac;
+			part->mScale += frac*part->mEndScale;
+		}
+
+		part->mGlow = (U8) ll_round(lerp(part->mStartGlow, part->mEndGlow, frac)*255.f);
+		part->mLastUpdateTime = cur_time;
+
+		source->mDead[i] = part->mLastUpdateTime > part->mMaxAge;
+	}
+}
+
+// LLViewerPartGroup::commitUpdate(), one compaction pass
+static void commit(Source* source)
+{
+	std::vector<Part*>& particles = source->mParticles;
+	S32 kept = 0;
+	for (S32 i = 0; i < (S32)particles.size(); i++)
+	{
+		if (source->mDead[i])
+		{
+			delete particles[i];
+		}
+		else
+		{
+			particles[kept++] = particles[i];
+		}
+	}
+	particles.resize(kept);
+}
+
+// spawns and steps every source for a number of frames, returning the time
+// spent in the group updates
+static F64 run_frames(std::vector<Source*>& sources, U32 frames, LLParallelFor* pool, U64& particle_frames)
+{
+	LLParallelFor::func_t simulate_group = [&sources](S32 i)
+	{
+		simulate(sources[i], FRAME_TIME);
+	};
+
+	F64 time = 0.0;
+	LLTimer timer;
+	for (U32 frame = 0; frame < frames; frame++)
+	{
+		// spawning is the same work for both, only the update is timed
+		for (U32 i = 0; i < sources.size(); i++)
+		{
+			spawn(sources[i], FRAME_TIME);
+			particle_frames += sources[i]->mParticles.size();
+		}
+
+		timer.reset();
+		if (pool)
+		{
+			pool->run((S32)sources.size(), simulate_group);
+		}
+		else
+		{
+			for (S32 i = 0; i < (S32)sources.size(); i++)
+			{
+				simulate_group(i);
+			}
+		}
+		for (U32 i = 0; i < sources.size(); i++)
+		{
+			commit(sources[i]);
+		}
+		time += timer.getElapsedTimeF64();
+	}
+	return time;
+}
+
+static void checksum(const std::vector<Source*>& sources, U64& count, F64& sum)
+{
+	for (U32 i = 0; i < sources.size(); i++)
+	{
+		const std::vector<Part*>& particles = sources[i]->mParticles;
+		count += particles.size();
+		for (U32 j = 0; j < particles.size(); j++)
+		{
+			const Part* part = particles[j];
+			sum += part->mPosAgent.mV[VX] + part->mPosAgent.mV[VY] + part->mPosAgent.mV[VZ];
+			sum += part->mColor.mV[VALPHA] + part->mScale.mV[VX] + part->mGlow;
+		}
+	}
+}
+
+static void delete_sources(std::vector<Source*>& sources)
+{
+	for (U32 i = 0; i < sources.size(); i++)
+	{
+		delete sources[i];
+	}
+	sources.clear();
+}
+
+int main(int argc, char** argv)
+{
+	U32 source_count = 12;
+	U32 frames = 600;
+	S32 threads = LLParallelFor::getDefaultWorkerCount();
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--sources") || !strcmp(argv[arg], "-s")) && arg < argc-1)
+		{
+			source_count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--frames") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			frames = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--threads") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			threads = atoi(argv[++arg]);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+	threads = llmax(threads, 1);
+
+	std::vector<Source*> serial_sources;
+	std::vector<Source*> parallel_sources;
+	make_sources(source_count, serial_sources);
+	copy_sources(serial_sources, parallel_sources);
+
+	U64 particle_frames = 0;
+	F64 serial_time = run_frames(serial_sources, frames, NULL, particle_frames);
+
+	LLParallelFor pool("ParticleUpdate", threads);
+	U64 parallel_particle_frames = 0;
+	F64 parallel_time = run_frames(parallel_sources, frames, &pool, parallel_particle_frames);
+
+	U64 serial_count = 0, parallel_count = 0;
+	F64 serial_sum = 0.0, parallel_sum = 0.0;
+	checksum(serial_sources, serial_count, serial_sum);
+	checksum(parallel_sources, parallel_count, parallel_sum);
+
+	std::cout << "sources : " << source_count << ", frames : " << frames << ", average particles : " << particle_frames / frames << std::endl;
+	std::cout << "serial update   : " << serial_time * 1000.0 / frames << " ms/frame, particles : " << serial_count << std::endl;
+	std::cout << "parallel update : " << parallel_time * 1000.0 / frames << " ms/frame, particles : " << parallel_count
+			  << ", threads : " << threads << std::endl;
+
+	delete_sources(serial_sources);
+	delete_sources(parallel_sources);
+
+	// each group is stepped by one thread, so the results are identical
+	if (serial_count != parallel_count || serial_sum != parallel_sum)
+	{
+		std::cout << "Parallel update disagrees with the serial update" << std::endl;
+		return 1;
+	}
+	return 0;
+}
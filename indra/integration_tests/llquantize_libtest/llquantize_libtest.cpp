@@ -0,0 +1,219 @@
+/**
+ * @file llquantize_libtest.cpp
+ * @brief Headless benchmark for dequantizing terse object updates
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "indra_constants.h"
+#include "llmath.h"
+#include "llquantize.h"
+
+// system libraries
+#include <iostream>
+#include <vector>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllquantize_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -n, --count <n>\n"
+"        Number of 16 bit terse update blocks. Default is 100000.\n"
+" -r, --repeat <n>\n"
+"        Number of passes over the blocks. Default is 100.\n"
+"\n";
+
+// the 16 quantized values of a terse block: pos, vel, acc, rot and angv
+static const S32 TERSE_16_VALUES = 16;
+
+struct TerseBlock
+{
+	U8 mData[TERSE_16_VALUES * sizeof(U16)];	// as they arrive in the message
+	F32 mSize;	// of the region, sets the velocity and position ranges
+};
+
+static void make_blocks(U32 count, std::vector<TerseBlock>& blocks)
+{
+	U32 seed = 12345;
+	blocks.resize(count);
+	for (U32 i = 0; i < count; i++)
+	{
+		for (S32 j = 0; j < TERSE_16_VALUES; j++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			// a quarter of the values sit at the quantized zero, like resting objects
+			U16 val = (seed >> 30) ? (U16)(seed >> 8) : 32767;
+			memcpy(&blocks[i].mData[j * sizeof(U16)], &val, sizeof(U16));
+		}
+		blocks[i].mSize = (i % 4) ? 256.f : 512.f;
+	}
+}
+
+// one U16_to_F32() call per value, as processUpdateMessage() used to do
+static void dequantize_scalar(const TerseBlock& block, F32* out)
+{
+	const F32 size = block.mSize;
+	const F32 MIN_HEIGHT = -size;
+	const F32 MAX_HEIGHT = REGION_HEIGHT_METERS;
+	const U16* val = (const U16*)block.mData;
+	out[0] = U16_to_F32(val[0], -0.5f*size, 1.5f*size);
+	out[1] = U16_to_F32(val[1], -0.5f*size, 1.5f*size);
+	out[2] = U16_to_F32(val[2], MIN_HEIGHT, MAX_HEIGHT);
+	for (S32 i = 3; i < 9; i++)
+	{
+		out[i] = U16_to_F32(val[i], -size, size);
+	}
+	for (S32 i = 9; i < 13; i++)
+	{
+		out[i] = U16_to_F32(val[i], -1.f, 1.f);
+	}
+	for (S32 i = 13; i < TERSE_16_VALUES; i++)
+	{
+		out[i] = U16_to_F32(val[i], -size, size);
+	}
+}
+
+// the whole block in one U16_to_F32_batch() call, with the ranges stored
+// to arrays first
+static void dequantize_arrays(const TerseBlock& block, F32* out)
+{
+	const F32 size = block.mSize;
+	const F32 MIN_HEIGHT = -size;
+	const F32 MAX_HEIGHT = REGION_HEIGHT_METERS;
+	U16 terse_val[TERSE_16_VALUES];
+	const F32 terse_lower[TERSE_16_VALUES] = { -0.5f*size, -0.5f*size, MIN_HEIGHT,
+												-size, -size, -size,
+												-size, -size, -size,
+												-1.f, -1.f, -1.f, -1.f,
+												-size, -size, -size };
+	const F32 terse_upper[TERSE_16_VALUES] = { 1.5f*size, 1.5f*size, MAX_HEIGHT,
+												size, size, size,
+												size, size, size,
+												1.f, 1.f, 1.f, 1.f,
+												size, size, size };
+	memcpy(terse_val, block.mData, sizeof(terse_val));
+	U16_to_F32_batch(terse_val, terse_lower, terse_upper, out, TERSE_16_VALUES);
+}
+
+// four U16_to_F32_4() calls with the ranges built in registers, as
+// processUpdateMessage() does now
+static void dequantize_registers(const TerseBlock& block, F32* out)
+{
+	const F32 size = block.mSize;
+	const F32 MIN_HEIGHT = -size;
+	const F32 MAX_HEIGHT = REGION_HEIGHT_METERS;
+	const U16* val = (const U16*)block.mData;
+	_mm_storeu_ps(out, U16_to_F32_4(val, _mm_setr_ps(-0.5f*size, -0.5f*size, MIN_HEIGHT, -size),
+										 _mm_setr_ps(1.5f*size, 1.5f*size, MAX_HEIGHT, size)));
+	_mm_storeu_ps(out + 4, U16_to_F32_4(val + 4, _mm_set1_ps(-size), _mm_set1_ps(size)));
+	_mm_storeu_ps(out + 8, U16_to_F32_4(val + 8, _mm_setr_ps(-size, -1.f, -1.f, -1.f),
+												 _mm_setr_ps(size, 1.f, 1.f, 1.f)));
+	_mm_storeu_ps(out + 12, U16_to_F32_4(val + 12, _mm_setr_ps(-1.f, -size, -size, -size),
+												   _mm_setr_ps(1.f, size, size, size)));
+}
+
+int main(int argc, char** argv)
+{
+	U32 count = 100000;
+	U32 repeat = 100;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--count") || !strcmp(argv[arg], "-n")) && arg < argc-1)
+		{
+			count = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--repeat") || !strcmp(argv[arg], "-r")) && arg < argc-1)
+		{
+			repeat = llmax(atoi(argv[++arg]), 1);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+
+	std::vector<TerseBlock> blocks;
+	make_blocks(count, blocks);
+	std::vector<F32> scalar_out(count * TERSE_16_VALUES);
+	std::vector<F32> arrays_out(count * TERSE_16_VALUES);
+	std::vector<F32> registers_out(count * TERSE_16_VALUES);
+
+	LLTimer timer;
+	for (U32 pass = 0; pass < repeat; pass++)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			dequantize_scalar(blocks[i], &scalar_out[i * TERSE_16_VALUES]);
+		}
+	}
+	F64 scalar_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	for (U32 pass = 0; pass < repeat; pass++)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			dequantize_arrays(blocks[i], &arrays_out[i * TERSE_16_VALUES]);
+		}
+	}
+	F64 arrays_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	for (U32 pass = 0; pass < repeat; pass++)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			dequantize_registers(blocks[i], &registers_out[i * TERSE_16_VALUES]);
+		}
+	}
+	F64 registers_time = timer.getElapsedTimeF64();
+
+	F64 updates = (F64)count * repeat;
+	std::cout << "blocks : " << count << ", passes : " << repeat << std::endl;
+	std::cout << "scalar                       : " << scalar_time * 1.0e9 / updates << " ns/block, "
+			  << updates / scalar_time / 1.0e6 << " M blocks/s" << std::endl;
+	std::cout << "batched, ranges in arrays    : " << arrays_time * 1.0e9 / updates << " ns/block, "
+			  << updates / arrays_time / 1.0e6 << " M blocks/s" << std::endl;
+	std::cout << "batched, ranges in registers : " << registers_time * 1.0e9 / updates << " ns/block, "
+			  << updates / registers_time / 1.0e6 << " M blocks/s" << std::endl;
+
+	// the batched paths have to be bit identical, zero snapping included
+	size_t bytes = scalar_out.size() * sizeof(F32);
+	if (memcmp(&scalar_out[0], &arrays_out[0], bytes) || memcmp(&scalar_out[0], &registers_out[0], bytes))
+	{
+		std::cout << "Batched dequantize disagrees with the scalar one" << std::endl;
+		return 1;
+	}
+	return 0;
+}
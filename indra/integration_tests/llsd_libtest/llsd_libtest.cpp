@@ -0,0 +1,265 @@
+/**
+ * @file llsd_libtest.cpp
+ * @brief Headless benchmark for parsing XML LLSD documents
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "llsd.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "lluuid.h"
+
+// system libraries
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllsd_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -i, --input <file>\n"
+"        XML LLSD document to parse, e.g. a captured caps or event queue\n"
+"        response. Default is a synthetic FetchInventoryDescendents reply.\n"
+" -f, --folders <n>\n"
+"        Number of folders in the synthetic reply, 100 items each.\n"
+"        Default is 200.\n"
+" -r, --repeat <n>\n"
+"        Number of times the document is parsed by each parser. Default is 10.\n"
+"\n"
+"Link it with an older llsd.cpp to compare LLSD implementations.\n"
+"\n";
+
+// every allocation made by the program, LLSD values included
+static U64 sAllocations = 0;
+
+void* operator new(size_t size)
+{
+	++sAllocations;
+	void* ptr = malloc(size ? size : 1);
+	if (!ptr)
+	{
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+// a reply shaped like the ones AIS and FetchInventoryDescendents2 send: most
+// values are booleans, zeroes, empty strings and null ids
+static LLSD make_inventory_reply(S32 folders)
+{
+	LLSD folder_list = LLSD::emptyArray();
+	U32 seed = 7;
+	for (S32 f = 0; f < folders; ++f)
+	{
+		LLSD folder;
+		folder["folder_id"] = LLUUID::null;
+		folder["owner_id"] = LLUUID::null;
+		folder["version"] = f;
+		folder["descendents"] = 100;
+
+		LLSD items = LLSD::emptyArray();
+		for (S32 i = 0; i < 100; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			LLUUID id;
+			id.mData[0] = seed;
+			id.mData[1] = seed >> 8;
+			id.mData[2] = seed >> 16;
+
+			LLSD item;
+			item["item_id"] = id;
+			item["parent_id"] = LLUUID::null;
+			id.mData[3] = 1;
+			item["asset_id"] = id;
+			item["name"] = llformat("Item name %d", seed % 1000);
+			item["desc"] = (seed & 1) ? std::string() : std::string("(No Description)");
+			item["type"] = (S32)(seed % 4 ? 0 : 6);
+			item["inv_type"] = (S32)(seed % 3);
+			item["flags"] = 0;
+			item["created_at"] = (S32)(seed & 0xffff);
+
+			LLSD permissions;
+			permissions["base_mask"] = 0;
+			permissions["owner_mask"] = 0;
+			permissions["group_mask"] = 0;
+			permissions["everyone_mask"] = 0;
+			permissions["next_owner_mask"] = 0;
+			permissions["is_owner_group"] = false;
+			permissions["creator_id"] = id;
+			permissions["owner_id"] = id;
+			permissions["last_owner_id"] = LLUUID::null;
+			permissions["group_id"] = LLUUID::null;
+			item["permissions"] = permissions;
+
+			LLSD sale_info;
+			sale_info["sale_price"] = 0;
+			sale_info["sale_type"] = 0;
+			item["sale_info"] = sale_info;
+
+			items.append(item);
+		}
+		folder["items"] = items;
+		folder_list.append(folder);
+	}
+
+	LLSD reply;
+	reply["folders"] = folder_list;
+	return reply;
+}
+
+static bool load_document(const std::string& filename, std::string& xml)
+{
+	std::ifstream input(filename.c_str(), std::ios::binary);
+	if (!input.is_open())
+	{
+		return false;
+	}
+	std::ostringstream contents;
+	contents << input.rdbuf();
+	xml = contents.str();
+	return !xml.empty();
+}
+
+// parses xml repeat times, keeping the best time and the allocations of the
+// last parse
+static S32 parse_document(const std::string& xml, bool buffer, S32 repeat, LLSD& parsed, F64& best_time, U64& allocations)
+{
+	S32 parsed_count = 0;
+	LLTimer timer;
+	for (S32 run = 0; run < repeat; ++run)
+	{
+		parsed.clear();
+		std::istringstream input(xml);
+		U64 start_allocations = sAllocations;
+		timer.reset();
+		if (buffer)
+		{
+			parsed_count = LLSDSerialize::fromXMLBuffer(parsed, xml.data(), xml.size());
+		}
+		else
+		{
+			parsed_count = LLSDSerialize::fromXML(parsed, input);
+		}
+		F64 parse_time = timer.getElapsedTimeF64();
+		allocations = sAllocations - start_allocations;
+		best_time = run ? llmin(best_time, parse_time) : parse_time;
+	}
+	return parsed_count;
+}
+
+int main(int argc, char** argv)
+{
+	std::string input_filename;
+	S32 folders = 200;
+	S32 repeat = 10;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if ((!strcmp(argv[arg], "--input") || !strcmp(argv[arg], "-i")) && arg < argc-1)
+		{
+			input_filename = argv[++arg];
+		}
+		else if ((!strcmp(argv[arg], "--folders") || !strcmp(argv[arg], "-f")) && arg < argc-1)
+		{
+			folders = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--repeat") || !strcmp(argv[arg], "-r")) && arg < argc-1)
+		{
+			repeat = llmax(atoi(argv[++arg]), 1);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+
+	std::string xml;
+	if (!input_filename.empty())
+	{
+		if (!load_document(input_filename, xml))
+		{
+			std::cout << "Could not read a document from " << input_filename << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::ostringstream output;
+		LLSDSerialize::toXML(make_inventory_reply(folders), output);
+		xml = output.str();
+	}
+
+	LLSD expat_parsed;
+	F64 expat_time = 0.0;
+	U64 expat_allocations = 0;
+	S32 expat_count = parse_document(xml, false, repeat, expat_parsed, expat_time, expat_allocations);
+
+	std::cout << "document : " << xml.size() / 1024 << " KB, values : " << expat_count << std::endl;
+	std::cout << "expat parser  : best of " << repeat << " : " << expat_time * 1000.0 << " ms"
+			  << ", allocations : " << expat_allocations << std::endl;
+	if (expat_count <= 0)
+	{
+		std::cout << "Could not parse the document" << std::endl;
+		return 1;
+	}
+
+	LLSD buffer_parsed;
+	F64 buffer_time = 0.0;
+	U64 buffer_allocations = 0;
+	S32 buffer_count = parse_document(xml, true, repeat, buffer_parsed, buffer_time, buffer_allocations);
+
+	std::cout << "buffer parser : best of " << repeat << " : " << buffer_time * 1000.0 << " ms"
+			  << ", allocations : " << buffer_allocations << std::endl;
+
+	// the buffer parser has to give the same document and count as expat
+	if (buffer_count != expat_count || !llsd_equals(buffer_parsed, expat_parsed))
+	{
+		std::cout << "Buffer parser disagrees with the expat parser" << std::endl;
+		return 1;
+	}
+	return 0;
+}
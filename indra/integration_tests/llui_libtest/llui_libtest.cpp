@@ -38,11 +38,50 @@
 #include "llfloater.h"
 #include "llfontfreetype.h"
 #include "llfontgl.h"
+#include "llkeywords.h"
+#include "llmemory.h"
+#include "llscrollcontainer.h"
+#include "llscrolllistctrl.h"
+#include "llsdserialize.h"
+#include "lltexteditor.h"
+#include "lltexture.h"
+#include "lltimer.h"
 #include "lltransutil.h"
 #include "llui.h"
 #include "lluictrlfactory.h"
+#include "llurlregistry.h"
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <boost/algorithm/string/find.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/unordered_map.hpp>
+
+// doc string provided when invoking the program with --help
+static const char USAGE[] = "\n"
+"usage:\tllui_libtest [options]\n"
+"\n"
+" -h, --help\n"
+"        Print this help\n"
+" -c, --check\n"
+"        Check trimming a text editor to its line limit and the text segment\n"
+"        pool, exits with 1 when a check fails.\n"
+" -s, --scroll-list <rows>\n"
+"        Time filling, sorting and searching a scroll list of <rows> rows,\n"
+"        one row at a time and from a data source.\n"
+" -t, --text <lines>\n"
+"        Time appending <lines> chat lines to a text editor, reflowing after\n"
+"        each one, with and without a line limit, and resizing it.\n"
+" -l, --max-lines <n>\n"
+"        Only time --text with a line limit of <n>, 0 for none, so the\n"
+"        memory use of each case is measured in its own process.\n"
+" -m, --match <lines>\n"
+"        Time finding links in <lines> chat lines: the old Url heuristic,\n"
+"        then trying only the Url regexes whose literals occur and trying\n"
+"        all of them.  Also times syntax coloring an LSL script of <lines>\n"
+"        lines.\n"
+"\n";
 
 // *TODO: switch to using TUT
 // *TODO: teach Parabuild about this program, run automatically after full builds
@@ -63,6 +102,21 @@ std::string rlvGetAnonym(const LLAvatarName& avName)
 }
 // [/RLVa:KB]
 
+// LLUIImage asks its texture for its size as soon as it is made
+class TestTexture : public LLTexture
+{
+public:
+	/*virtual*/ S32 getWidth(S32 discard_level) const
+	{
+		return 16;
+	}
+
+	/*virtual*/ S32 getHeight(S32 discard_level) const
+	{
+		return 16;
+	}
+};
+
 // We can't create LLImageGL objects because we have no window or rendering 
 // context.  Provide enough of an LLUIImage to test the LLUI library without
 // an underlying image.
@@ -70,7 +124,7 @@ class TestUIImage : public LLUIImage
 {
 public:
 	TestUIImage()
-	:	LLUIImage( std::string(), NULL ) // NULL ImageGL, don't deref!
+	:	LLUIImage( std::string(), new TestTexture() ) // no ImageGL behind it
 	{ }
 
 	/*virtual*/ S32 getWidth() const
@@ -85,7 +139,6 @@ public:
 };
 
 
-class LLTexture ;
 // We need to supply dummy images
 class TestImageProvider : public LLImageProviderInterface
 {
@@ -126,14 +179,17 @@ void init_llui()
 #else
 	const char* newview_path = "../../../newview";
 #endif
-	gDirUtilp->initAppDirs("SecondLife", newview_path);
-	gDirUtilp->setSkinFolder("default", "en");
+	// LLDir ignores skin files whose path holds "..", so resolve it first
+	boost::system::error_code error;
+	boost::filesystem::path app_path = boost::filesystem::canonical(newview_path, error);
+	gDirUtilp->initAppDirs("SecondLife", error ? std::string(newview_path) : app_path.string());
+	gDirUtilp->setSkinFolder("default", "", "en");
 	
 	// colors are no longer stored in a LLControlGroup file
 	LLUIColorTable::instance().loadFromSettings();
 
 	std::string config_filename = gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "settings.xml");
-	gSavedSettings.loadFromFile(config_filename);
+	gSavedSettings.loadFromFile(config_filename, true);	// defaults, like LLAppViewer does
 	
 	// See LLAppViewer::init()
 	LLUI::settings_map_t settings;
@@ -143,7 +199,7 @@ void init_llui()
 	settings["account"] = &gSavedPerAccountSettings;
 	
 	// Don't use real images as we don't have a GL context
-	LLUI::initClass(settings, &gTestImageProvider);
+	LLUI::initParamSingleton(settings, &gTestImageProvider, (LLUIAudioCallback)NULL, (LLUIAudioCallback)NULL);
 	
 	const bool no_register_widgets = false;
 	LLWidgetReg::initClass( no_register_widgets );
@@ -160,7 +216,7 @@ void init_llui()
 	LLFontGL::initClass(96.f, 1.f, 1.f,
 						gDirUtilp->getAppRODataDir(),
 						"fonts.xml",
-						f.0,
+						0.f,
 						false );	// don't create gl textures
 	
 	LLFloaterView::Params fvparams;
@@ -216,14 +272,642 @@ void export_test_floaters()
 }
 |*==========================================================================*/
 
+// Rows of a made up radar: a name and a distance
+class BenchDataSource : public LLScrollListDataSource
+{
+public:
+	BenchDataSource(S32 rows)
+	{
+		U32 seed = 17;
+		mIDs.resize(rows);
+		mNames.resize(rows);
+		mDistances.resize(rows);
+		for (S32 row = 0; row < rows; ++row)
+		{
+			seed = seed * 1664525 + 1013904223;
+			mIDs[row].generate();
+			mNames[row] = llformat("Resident %08x", seed);
+			mDistances[row] = llformat("%.2f", (F32)(seed % 100000) / 100.f);
+		}
+	}
+
+	/*virtual*/ S32 getRowCount() const { return mIDs.size(); }
+	/*virtual*/ LLSD getRowValue(S32 row) const { return mIDs[row]; }
+
+	/*virtual*/ std::string getCellText(S32 row, const std::string& column) const
+	{
+		return column == "name" ? mNames[row] : mDistances[row];
+	}
+
+	/*virtual*/ LLSD getRowElement(S32 row) const
+	{
+		LLSD element;
+		element["id"] = mIDs[row];
+		element["columns"][0]["column"] = "name";
+		element["columns"][0]["value"] = mNames[row];
+		element["columns"][1]["column"] = "distance";
+		element["columns"][1]["value"] = mDistances[row];
+		return element;
+	}
+
+	const std::string& getName(S32 row) const { return mNames[row]; }
+
+private:
+	uuid_vec_t mIDs;
+	std::vector<std::string> mNames;
+	std::vector<std::string> mDistances;
+};
+
+static LLScrollListCtrl* make_list()
+{
+	LLScrollListCtrl::Params params(LLUICtrlFactory::getDefaultParams<LLScrollListCtrl>());
+	params.name("bench_list");
+	params.rect(LLRect(0, 400, 300, 0));
+	LLScrollListCtrl* list = LLUICtrlFactory::create<LLScrollListCtrl>(params);
+
+	LLSD column;
+	column["name"] = "name";
+	column["label"] = "Name";
+	column["width"] = 200;
+	list->addColumn(column);
+	column["name"] = "distance";
+	column["label"] = "Distance";
+	column["width"] = 80;
+	list->addColumn(column);
+	return list;
+}
+
+static void time_scroll_list(BenchDataSource& source, bool virtual_rows)
+{
+	LLScrollListCtrl* list = make_list();
+	LLTimer timer;
+
+	timer.reset();
+	if (virtual_rows)
+	{
+		list->setDataSource(&source);
+	}
+	else
+	{
+		for (S32 row = 0; row < source.getRowCount(); ++row)
+		{
+			list->addElement(source.getRowElement(row));
+		}
+	}
+	F64 fill_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	list->sortOnce(0, TRUE);
+	F64 sort_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	bool found = list->getItemByLabel(source.getName(source.getRowCount() / 2), TRUE, 0) != NULL;
+	F64 find_time = timer.getElapsedTimeF64();
+
+	std::cout << (virtual_rows ? "data source  :" : "addElement() :")
+			  << " fill : " << fill_time * 1000.0 << " ms"
+			  << ", sort : " << sort_time * 1000.0 << " ms"
+			  << ", find : " << find_time * 1000.0 << " ms" << (found ? "" : " (not found)");
+	if (virtual_rows)
+	{
+		std::cout << ", rows with cells : " << list->getNumBuiltDataRows();
+	}
+	std::cout << std::endl;
+
+	timer.reset();
+	delete list;
+	F64 delete_time = timer.getElapsedTimeF64();
+	std::cout << "               delete : " << delete_time * 1000.0 << " ms" << std::endl;
+}
+
+template<typename T>
+static T* make_text_editor(S32 max_lines)
+{
+	LLTextEditor::Params params(LLUICtrlFactory::getDefaultParams<LLTextEditor>());
+	params.name("bench_text");
+	params.rect(LLRect(0, 400, 300, 0));
+	params.read_only(true);
+	params.wrap(true);
+	params.track_end(true);
+	params.max_text_length(S32_MAX);
+	params.max_lines(max_lines);
+	return LLUICtrlFactory::create<T>(params);
+}
+
+static LLTextEditor* make_text_editor(S32 max_lines)
+{
+	return make_text_editor<LLTextEditor>(max_lines);
+}
+
+// A chat line of the made up log; some wrap, some carry a link
+static std::string make_chat_line(S32 line, U32& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	std::string text = llformat("[12:%02d] Resident %08x: ", line % 60, seed);
+	text.append((seed % 5) ? "hello there, how is everyone doing today?" : "see http://example.com/some/page for the details, it is a rather long line that wraps");
+	return text;
+}
+
+static void time_text(S32 lines, S32 max_lines)
+{
+	LLTextEditor* editor = make_text_editor(max_lines);
+	U64 start_rss = LLMemory::getCurrentRSS();
+	LLTimer timer;
+	LLTimer slice_timer;
+	F64 append_time = 0.0;
+	F64 reflow_time = 0.0;
+	F64 worst_slice = 0.0;
+	const S32 SLICE_LINES = llmax(lines / 10, 1);
+
+	U32 seed = 17;
+	for (S32 line = 0; line < lines; ++line)
+	{
+		std::string text = make_chat_line(line, seed);
+
+		timer.reset();
+		editor->appendText(text, line > 0);
+		append_time += timer.getElapsedTimeF64();
+
+		timer.reset();
+		editor->getTextBoundingRect();	// forces the reflow a frame would do
+		reflow_time += timer.getElapsedTimeF64();
+
+		if ((line + 1) % SLICE_LINES == 0)
+		{
+			F64 slice_time = slice_timer.getElapsedTimeF64();
+			worst_slice = llmax(worst_slice, slice_time);
+			slice_timer.reset();
+		}
+	}
+	U64 end_rss = LLMemory::getCurrentRSS();
+
+	std::cout << (max_lines ? llformat("max_lines %6d :", max_lines) : std::string("no line limit    :"))
+			  << " append : " << append_time * 1000.0 << " ms"
+			  << ", reflow : " << reflow_time * 1000.0 << " ms"
+			  << ", slowest " << SLICE_LINES << " lines : " << worst_slice * 1000.0 << " ms"
+			  << ", lines : " << editor->getLineCount()
+			  << ", rss change : " << ((S64)end_rss - (S64)start_rss) / 1024 << " KB" << std::endl;
+
+	timer.reset();
+	editor->reshape(300, 600);
+	editor->getTextBoundingRect();
+	F64 height_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	editor->reshape(400, 600);
+	editor->getTextBoundingRect();
+	F64 width_time = timer.getElapsedTimeF64();
+
+	std::cout << "                   resize height : " << height_time * 1000.0 << " ms"
+			  << ", resize width : " << width_time * 1000.0 << " ms" << std::endl;
+
+	delete editor;
+}
+
+// Shows the checks below how a text editor laid out its document
+class CheckTextEditor : public LLTextEditor
+{
+public:
+	CheckTextEditor(const LLTextEditor::Params& p) : LLTextEditor(p) {}
+
+	S32 getScrollIndex() const { return mScrollIndex; }
+
+	// where the top of the view is, relative to the line holding mScrollIndex
+	S32 getScrollOffset() const
+	{
+		return getVisibleDocumentRect().mTop - getDocRectFromDocIndex(mScrollIndex).mTop;
+	}
+
+	std::string getLayout() const
+	{
+		std::ostringstream layout;
+		for (line_list_t::const_iterator it = mLineInfoList.begin(); it != mLineInfoList.end(); ++it)
+		{
+			layout << "line " << it->mLineNum << " [" << it->mDocIndexStart << ", " << it->mDocIndexEnd << ") " << it->mRect << "\n";
+		}
+		for (segment_set_t::const_iterator it = mSegments.begin(); it != mSegments.end(); ++it)
+		{
+			layout << "segment [" << (*it)->getStart() << ", " << (*it)->getEnd() << ")\n";
+		}
+		return layout.str();
+	}
+};
+
+static bool check(bool condition, const std::string& what)
+{
+	if (!condition)
+	{
+		std::cout << "FAILED : " << what << std::endl;
+	}
+	return condition;
+}
+
+// Lines trimmed off the top of a wrapped document leave it laid out the way
+// a full reflow of the remaining text does, and leave the view where it was.
+static bool check_trim()
+{
+	static const S32 LINES = 300;
+	static const S32 MAX_LINES = 100;
+	std::vector<std::string> lines;
+	U32 seed = 17;
+	for (S32 line = 0; line < LINES; ++line)
+	{
+		lines.push_back(make_chat_line(line, seed));
+	}
+	bool ok = true;
+
+	// trimmed while appending, scrolled to the bottom
+	CheckTextEditor* trimmed = make_text_editor<CheckTextEditor>(MAX_LINES);
+	for (S32 line = 0; line < LINES; ++line)
+	{
+		trimmed->appendText(lines[line], line > 0);
+		trimmed->getTextBoundingRect();
+	}
+	std::string text = trimmed->getText();
+	S32 kept = std::count(text.begin(), text.end(), '\n') + 1;
+	ok &= check(kept < LINES, "appending trims");
+	ok &= check(trimmed->getLineCount() >= MAX_LINES && trimmed->getLineCount() <= MAX_LINES + MAX_LINES / 8, "line count is kept near max_lines");
+
+	CheckTextEditor* full = make_text_editor<CheckTextEditor>(0);
+	for (S32 line = LINES - kept; line < LINES; ++line)
+	{
+		full->appendText(lines[line], line > LINES - kept);
+	}
+	full->getTextBoundingRect();
+	ok &= check(full->getText() == text, "trimmed text");
+	ok &= check(full->getLayout() == trimmed->getLayout(), "trimmed layout equals a fresh one");
+
+	// appending reflows from the layout before the new line, so the scroll
+	// index lags a line behind until the next reflow, trimmed or not
+	std::string layout = trimmed->getLayout();
+	trimmed->needsReflow();
+	trimmed->getTextBoundingRect();
+	full->needsReflow();
+	full->getTextBoundingRect();
+	ok &= check(trimmed->getLayout() == layout, "trimmed layout survives a full reflow");
+	ok &= check(trimmed->getScrollIndex() == full->getScrollIndex(), "trimmed scroll index equals a fresh one");
+	delete trimmed;
+	delete full;
+
+	// trimmed by hand, scrolled to the middle
+	CheckTextEditor* scrolled = make_text_editor<CheckTextEditor>(0);
+	for (S32 line = 0; line < LINES; ++line)
+	{
+		scrolled->appendText(lines[line], line > 0);
+	}
+	scrolled->getTextBoundingRect();
+	scrolled->getScrollContainer()->goToTop();
+	for (S32 page = 0; page < 20; ++page)
+	{
+		scrolled->getScrollContainer()->pageDown(7);
+	}
+	scrolled->needsReflow();	// picks the scroll index up from the view
+	scrolled->getTextBoundingRect();
+	S32 scroll_index = scrolled->getScrollIndex();
+	S32 scroll_offset = scrolled->getScrollOffset();
+	LLWString untrimmed = scrolled->getWText();
+
+	S32 cut = scrolled->removeFirstLines(MAX_LINES);
+	ok &= check(cut > 0 && cut < scroll_index, "trims above the view");
+	ok &= check(cut > 0 && untrimmed[cut - 1] == '\n', "trims whole paragraphs");
+	ok &= check(scrolled->getWText() == untrimmed.substr(cut), "trims only the top");
+	ok &= check(scrolled->getScrollIndex() == scroll_index - cut, "scroll index follows the text");
+	ok &= check(scrolled->getScrollOffset() == scroll_offset, "view stays on the same text");
+
+	layout = scrolled->getLayout();
+	scrolled->needsReflow();
+	scrolled->getTextBoundingRect();
+	ok &= check(scrolled->getLayout() == layout, "hand trimmed layout survives a full reflow");
+	ok &= check(scrolled->getScrollIndex() == scroll_index - cut && scrolled->getScrollOffset() == scroll_offset, "full reflow keeps the view");
+	delete scrolled;
+
+	return ok;
+}
+
+// Freed segments are handed out again to the next segment of their size
+static bool check_segment_pool()
+{
+	bool ok = true;
+	LLTextSegmentPtr segment = new LLIndexSegment();
+	void* freed = segment.get();
+	segment = NULL;
+	segment = new LLIndexSegment();
+	ok &= check(segment.get() == freed, "freed segment is reused");
+	ok &= check(segment->getStart() == 0 && segment->getEnd() == 0, "reused segment is constructed");
+
+	if (sizeof(LLLineBreakTextSegment) != sizeof(LLIndexSegment))
+	{
+		segment = NULL;
+		LLTextSegmentPtr line_break = new LLLineBreakTextSegment(5);
+		ok &= check(line_break.get() != freed, "pooled by size");
+		ok &= check(line_break->getStart() == 5 && line_break->getEnd() == 6, "line break segment is constructed");
+	}
+
+	// a whole document's worth goes back to the pool and comes out again
+	LLTextEditor* editor = make_text_editor(0);
+	U32 seed = 17;
+	for (S32 line = 0; line < 1000; ++line)
+	{
+		editor->appendText(make_chat_line(line, seed), line > 0);
+	}
+	std::string text = editor->getText();
+	delete editor;
+	editor = make_text_editor(0);
+	editor->appendText(text, false);
+	ok &= check(editor->getText() == text, "document built from pooled segments");
+	delete editor;
+
+	return ok;
+}
+
+// The "could this be a Url" test findUrl() ran before LLLiteralMatcher,
+// kept to compare the two.  Lines it passes went on to every regex.
+static bool old_url_heuristic(const std::string& text)
+{
+	static const char* JIRA_KEYS[] = { "ARVD", "BUG", "CHOP", "CHUIBUG", "CTS", "DOC", "DN", "ECC", "EXP", "FIRE", "FITMESH", "LEAP", "LLSD", "MATBUG", "MISC", "OPEN", "PATHBUG", "PLAT", "PYO", "SCR", "SH", "SINV", "SLS", "SNOW", "SOCIAL", "STORM", "SUN", "SUP", "SVC", "TPV", "VWR", "WEB" };
+	if (text.find("://") != std::string::npos ||
+		boost::ifind_first(text, "www.") ||
+		boost::ifind_first(text, ".com") ||
+		boost::ifind_first(text, ".net") ||
+		boost::ifind_first(text, ".edu") ||
+		boost::ifind_first(text, ".org") ||
+		text.find("<nolink>") != std::string::npos ||
+		text.find("<icon") != std::string::npos ||
+		text.find("@") != std::string::npos)
+	{
+		return true;
+	}
+	for (size_t i = 0; i < LL_ARRAY_SIZE(JIRA_KEYS); ++i)
+	{
+		if (text.find(JIRA_KEYS[i]) != std::string::npos)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static S32 find_urls(const std::vector<std::string>& lines)
+{
+	S32 found = 0;
+	LLUrlMatch match;
+	for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it)
+	{
+		// the way LLTextBase walks a line, one link at a time
+		std::string text = *it;
+		while (!text.empty() && LLUrlRegistry::instance().findUrl(text, match))
+		{
+			++found;
+			text = text.substr(match.getEnd() + 1);
+		}
+	}
+	return found;
+}
+
+static void time_url_matching(S32 lines)
+{
+	std::vector<std::string> chat;
+	U32 seed = 17;
+	for (S32 line = 0; line < lines; ++line)
+	{
+		seed = seed * 1664525 + 1013904223;
+		switch ((seed >> 8) % 16)
+		{
+		case 0:
+			chat.push_back(llformat("check http://example.com/page?id=%u it has everything", seed));
+			break;
+		case 1:
+			chat.push_back("the store is at www.example.net/store, drop by");
+			break;
+		case 2:
+			chat.push_back(llformat("meet me at http://maps.secondlife.com/secondlife/Ahern/%u/%u/22 or secondlife:///app/worldmap/Ahern/128/128/0", seed % 256, (seed >> 16) % 256));
+			break;
+		case 3:
+			chat.push_back(llformat("mail resident%u@example.org about it", seed % 1000));
+			break;
+		case 4:
+			chat.push_back(llformat("that was fixed in FIRE-%u a while ago", seed % 30000));
+			break;
+		case 5:
+			chat.push_back("THE SHOP IS OPEN NOW, SUPER SALE!!");
+			break;
+		default:
+			chat.push_back(llformat("[12:%02d] Resident %08x: hello there, how is everyone doing today?", line % 60, seed));
+			break;
+		}
+	}
+
+	LLTimer timer;
+	S32 old_passed = 0;
+	for (std::vector<std::string>::const_iterator it = chat.begin(); it != chat.end(); ++it)
+	{
+		old_passed += old_url_heuristic(*it);
+	}
+	F64 old_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	LLUrlRegistry::instance().setUseAnchors(false);
+	S32 all_found = find_urls(chat);
+	F64 all_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	LLUrlRegistry::instance().setUseAnchors(true);
+	S32 anchored_found = find_urls(chat);
+	F64 anchored_time = timer.getElapsedTimeF64();
+
+	std::cout << "urls, old heuristic  : " << old_time * 1000.0 << " ms, lines passed : " << old_passed << std::endl;
+	std::cout << "urls, every regex    : " << all_time * 1000.0 << " ms, found : " << all_found << std::endl;
+	std::cout << "urls, anchored regex : " << anchored_time * 1000.0 << " ms, found : " << anchored_found << std::endl;
+}
+
+static void time_keywords(S32 lines)
+{
+	LLSD syntax;
+	llifstream file(gDirUtilp->getExpandedFilename(LL_PATH_APP_SETTINGS, "keywords_lsl_default.xml").c_str());
+	if (!file.is_open() || LLSDSerialize::fromXML(syntax, file) == LLSDParser::PARSE_FAILURE)
+	{
+		std::cout << "can't read keywords_lsl_default.xml" << std::endl;
+		return;
+	}
+
+	LLTimer timer;
+	LLKeywords keywords;
+	keywords.initialize(syntax);
+	keywords.processTokens();
+	F64 load_time = timer.getElapsedTimeF64();
+
+	static const char* SCRIPT[] = {
+		"// greets whoever touches it",
+		"integer gCount = 0;",
+		"default",
+		"{",
+		"    touch_start(integer total_number)",
+		"    {",
+		"        key toucher = llDetectedKey(0);",
+		"        llSay(PUBLIC_CHANNEL, \"Hello, \" + llKey2Name(toucher) + \"!\");",
+		"        if (++gCount > 10) llSetTimerEvent(5.0);",
+		"    }",
+		"    timer() { llSetText((string)gCount, <1.0, 1.0, 1.0>, 1.0); }",
+		"}",
+	};
+	std::string text;
+	for (S32 line = 0; line < lines; ++line)
+	{
+		text.append(SCRIPT[line % LL_ARRAY_SIZE(SCRIPT)]).append("\n");
+	}
+	LLWString wtext = utf8str_to_wstring(text);
+
+	LLTextEditor* editor = make_text_editor(0);
+	std::vector<LLTextSegmentPtr> segments;
+	timer.reset();
+	keywords.findSegments(&segments, wtext, LLColor4::white, *editor);
+	F64 find_time = timer.getElapsedTimeF64();
+
+	std::cout << "lsl, keywords : " << load_time * 1000.0 << " ms"
+			  << ", coloring " << wtext.size() << " chars : " << find_time * 1000.0 << " ms"
+			  << ", segments : " << segments.size() << std::endl;
+
+	// The word lookups findSegments() makes: in the ordered mWordTokenMap it
+	// used to search, and in the hashed index, skipping words longer than
+	// any keyword, it searches now.
+	std::vector<std::pair<const llwchar*, size_t> > words;
+	for (const llwchar* cur = wtext.c_str(); *cur; )
+	{
+		const llwchar* p = cur;
+		while (*p && (iswalnum(*p) || (*p == '_') || (*p == '#')))
+		{
+			p++;
+		}
+		if (p > cur)
+		{
+			words.push_back(std::make_pair(cur, (size_t)(p - cur)));
+		}
+		cur = (p > cur) ? p : cur + 1;
+	}
+	LLKeywords::word_token_map_t ordered;
+	boost::unordered_map<LLKeywords::WStringMapIndex, LLKeywordToken*> hashed;
+	size_t max_word_length = 0;
+	for (LLKeywords::keyword_iterator_t it = keywords.begin(); it != keywords.end(); ++it)
+	{
+		ordered.insert(*it);
+		hashed.insert(*it);
+		max_word_length = llmax(max_word_length, it->second->getToken().size());
+	}
+
+	timer.reset();
+	S32 ordered_found = 0;
+	for (size_t word = 0; word < words.size(); ++word)
+	{
+		LLKeywords::WStringMapIndex index(words[word].first, words[word].second);
+		ordered_found += ordered.find(index) != ordered.end();
+	}
+	F64 ordered_time = timer.getElapsedTimeF64();
+
+	timer.reset();
+	S32 hashed_found = 0;
+	for (size_t word = 0; word < words.size(); ++word)
+	{
+		LLKeywords::WStringMapIndex index(words[word].first, words[word].second);
+		hashed_found += words[word].second <= max_word_length && hashed.find(index) != hashed.end();
+	}
+	F64 hashed_time = timer.getElapsedTimeF64();
+
+	std::cout << "lsl, " << words.size() << " words, ordered map : " << ordered_time * 1000.0 << " ms, found : " << ordered_found << std::endl;
+	std::cout << "lsl, " << words.size() << " words, hashed      : " << hashed_time * 1000.0 << " ms, found : " << hashed_found << std::endl;
+
+	segments.clear();
+	delete editor;
+}
+
 int main(int argc, char** argv)
 {
+	S32 scroll_list_rows = 0;
+	S32 text_lines = 0;
+	S32 text_max_lines = -1;	// both with and without a line limit
+	S32 match_lines = 0;
+	bool run_checks = false;
+
+	// Analyze command line arguments
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp(argv[arg], "--help") || !strcmp(argv[arg], "-h"))
+		{
+			std::cout << USAGE << std::endl;
+			return 0;
+		}
+		else if (!strcmp(argv[arg], "--check") || !strcmp(argv[arg], "-c"))
+		{
+			run_checks = true;
+		}
+		else if ((!strcmp(argv[arg], "--scroll-list") || !strcmp(argv[arg], "-s")) && arg < argc-1)
+		{
+			scroll_list_rows = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--text") || !strcmp(argv[arg], "-t")) && arg < argc-1)
+		{
+			text_lines = llmax(atoi(argv[++arg]), 1);
+		}
+		else if ((!strcmp(argv[arg], "--max-lines") || !strcmp(argv[arg], "-l")) && arg < argc-1)
+		{
+			text_max_lines = llmax(atoi(argv[++arg]), 0);
+		}
+		else if ((!strcmp(argv[arg], "--match") || !strcmp(argv[arg], "-m")) && arg < argc-1)
+		{
+			match_lines = llmax(atoi(argv[++arg]), 1);
+		}
+		else
+		{
+			std::cout << "Unknown argument : " << argv[arg] << USAGE << std::endl;
+			return 1;
+		}
+	}
+
 	// Must init LLError for llerrs to actually cause errors.
-	LLError::initForApplication(".");
+	LLError::initForApplication(".", ".");
 
 	init_llui();
 	
 //	export_test_floaters();
+
+	if (run_checks)
+	{
+		bool trim_ok = check_trim();
+		bool pool_ok = check_segment_pool();
+		std::cout << "trim : " << (trim_ok ? "ok" : "FAILED") << ", segment pool : " << (pool_ok ? "ok" : "FAILED") << std::endl;
+		if (!trim_ok || !pool_ok)
+		{
+			return 1;
+		}
+	}
+
+	if (scroll_list_rows)
+	{
+		BenchDataSource source(scroll_list_rows);
+		std::cout << "rows : " << scroll_list_rows << std::endl;
+		time_scroll_list(source, false);
+		time_scroll_list(source, true);
+	}
+
+	if (text_lines)
+	{
+		std::cout << "lines : " << text_lines << std::endl;
+		if (text_max_lines < 0)
+		{
+			time_text(text_lines, 0);
+			time_text(text_lines, llmin(text_lines, 10000));
+		}
+		else
+		{
+			time_text(text_lines, text_max_lines);
+		}
+	}
+
+	if (match_lines)
+	{
+		std::cout << "lines : " << match_lines << std::endl;
+		time_url_matching(match_lines);
+		time_keywords(match_lines);
+	}
 	
 	return 0;
 }
@@ -103,5 +103,7 @@ void LLWidgetReg::initClass(bool register_widgets)
 	}
 
 	// *HACK: Usually this is registered as a viewer text editor
-	LLDefaultChildRegistry::Register<LLTextEditor> text_editor("text_editor");
+	// LLUICtrlFactory takes a param block under one name only, and
+	// LLTextEditor::Params is "simple_text_editor" already.
+	//LLDefaultChildRegistry::Register<LLTextEditor> text_editor("text_editor");
 }
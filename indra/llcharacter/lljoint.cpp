@@ -57,8 +57,8 @@ JointKey JointKey::construct( std::string aName )
 }
 // </FS:ND>
 
-S32 LLJoint::sNumUpdates = 0;
-S32 LLJoint::sNumTouches = 0;
+LLAtomicS32 LLJoint::sNumUpdates(0);
+LLAtomicS32 LLJoint::sNumTouches(0);
 
 template <class T> 
 bool attachment_map_iter_compare_key(const T& a, const T& b)
@@ -38,6 +38,7 @@
 #include "m4math.h"
 #include "llquaternion.h"
 #include "xform.h"
+#include "llatomic.h"
 
 //<FS:ND> Query by JointKey rather than just a string, the key can be a U32 index for faster lookup
 struct JointKey
@@ -171,8 +172,9 @@ public:
 	joints_t mChildren;
 
 	// debug statics
-	static S32		sNumTouches;
-	static S32		sNumUpdates;
+	// atomic, skeletons may be updated on several threads at once
+	static LLAtomicS32	sNumTouches;
+	static LLAtomicS32	sNumUpdates;
     typedef std::set<std::string> debug_joint_name_t;
     static debug_joint_name_t s_debugJointNames;
     static void setDebugJointNames(const debug_joint_name_t& names);
@@ -43,6 +43,8 @@
 #include "message.h"
 #include "llfilesystem.h"
 
+#include <algorithm>
+
 #include "nd/ndexceptions.h" // <FS:ND/> For nd::exceptions::xran
 
 //-----------------------------------------------------------------------------
@@ -130,6 +132,30 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
 //-----------------------------------------------------------------------------
 
 
+//-----------------------------------------------------------------------------
+// find_key()
+// Returns the index of the first key at or after time, i.e. what
+// lower_bound() would return.  cursor holds the result of the previous
+// lookup: playback moves forward a key at a time, so that key or the one
+// after it is almost always the answer and the binary search is only
+// needed after a seek or a loop.
+//-----------------------------------------------------------------------------
+static S32 find_key(const std::vector<F32>& times, F32 time, S32& cursor)
+{
+	const S32 num_keys = (S32)times.size();
+	for (S32 i = cursor; i <= cursor + 1 && i <= num_keys; ++i)
+	{
+		if ((i == num_keys || times[i] >= time) && (i == 0 || times[i - 1] < time))
+		{
+			cursor = i;
+			return i;
+		}
+	}
+
+	cursor = (S32)(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+	return cursor;
+}
+
 //-----------------------------------------------------------------------------
 // ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
@@ -144,51 +170,41 @@ LLKeyframeMotion::ScaleCurve::ScaleCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::ScaleCurve::~ScaleCurve() 
 {
-	mKeys.clear();
+	mKeyTimes.clear();
+	mScales.clear();
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration, S32& cursor) const
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty())
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	S32 right = find_key(mKeyTimes, time, cursor);
+	if (right == (S32)mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mScale;
+		value = mScales[right - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mScale;
+		value = mScales[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		ScaleKey& scale_before = left->second;
-		ScaleKey& scale_after = right->second;
-		if (right == mKeys.end())
-		{
-			scale_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, scale_before, scale_after);
+		S32 left = right - 1;
+		F32 u = (time - mKeyTimes[left]) / (mKeyTimes[right] - mKeyTimes[left]);
+		value = interp(u, mScales[left], mScales[right]);
 	}
 	return value;
 }
@@ -196,17 +212,17 @@ LLVector3 LLKeyframeMotion::ScaleCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, ScaleKey& before, ScaleKey& after)
+LLVector3 LLKeyframeMotion::ScaleCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mScale;
+		return before;
 
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return lerp(before.mScale, after.mScale, u);
+		return lerp(before, after, u);
 	}
 }
 
@@ -224,51 +240,41 @@ LLKeyframeMotion::RotationCurve::RotationCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::RotationCurve::~RotationCurve()
 {
-	mKeys.clear();
+	mKeyTimes.clear();
+	mRotations.clear();
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // RotationCurve::getValue()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
+LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration, S32& cursor) const
 {
 	LLQuaternion value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty())
 	{
 		value = LLQuaternion::DEFAULT;
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	S32 right = find_key(mKeyTimes, time, cursor);
+	if (right == (S32)mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mRotation;
+		value = mRotations[right - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mRotation;
+		value = mRotations[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		RotationKey& rot_before = left->second;
-		RotationKey& rot_after = right->second;
-		if (right == mKeys.end())
-		{
-			rot_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, rot_before, rot_after);
+		S32 left = right - 1;
+		F32 u = (time - mKeyTimes[left]) / (mKeyTimes[right] - mKeyTimes[left]);
+		value = interp(u, mRotations[left], mRotations[right]);
 	}
 	return value;
 }
@@ -276,17 +282,17 @@ LLQuaternion LLKeyframeMotion::RotationCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, RotationKey& before, RotationKey& after)
+LLQuaternion LLKeyframeMotion::RotationCurve::interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mRotation;
+		return before;
 
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return nlerp(u, before.mRotation, after.mRotation);
+		return nlerp(u, before, after);
 	}
 }
 
@@ -305,51 +311,41 @@ LLKeyframeMotion::PositionCurve::PositionCurve()
 //-----------------------------------------------------------------------------
 LLKeyframeMotion::PositionCurve::~PositionCurve()
 {
-	mKeys.clear();
+	mKeyTimes.clear();
+	mPositions.clear();
 	mNumKeys = 0;
 }
 
 //-----------------------------------------------------------------------------
 // PositionCurve::getValue()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
+LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration, S32& cursor) const
 {
 	LLVector3 value;
 
-	if (mKeys.empty())
+	if (mKeyTimes.empty())
 	{
 		value.clearVec();
 		return value;
 	}
 	
-	key_map_t::iterator right = mKeys.lower_bound(time);
-	if (right == mKeys.end())
+	S32 right = find_key(mKeyTimes, time, cursor);
+	if (right == (S32)mKeyTimes.size())
 	{
 		// Past last key
-		--right;
-		value = right->second.mPosition;
+		value = mPositions[right - 1];
 	}
-	else if (right == mKeys.begin() || right->first == time)
+	else if (right == 0 || mKeyTimes[right] == time)
 	{
 		// Before first key or exactly on a key
-		value = right->second.mPosition;
+		value = mPositions[right];
 	}
 	else
 	{
 		// Between two keys
-		key_map_t::iterator left = right; --left;
-		F32 index_before = left->first;
-		F32 index_after = right->first;
-		PositionKey& pos_before = left->second;
-		PositionKey& pos_after = right->second;
-		if (right == mKeys.end())
-		{
-			pos_after = mLoopInKey;
-			index_after = duration;
-		}
-
-		F32 u = (time - index_before) / (index_after - index_before);
-		value = interp(u, pos_before, pos_after);
+		S32 left = right - 1;
+		F32 u = (time - mKeyTimes[left]) / (mKeyTimes[right] - mKeyTimes[left]);
+		value = interp(u, mPositions[left], mPositions[right]);
 	}
 
 	llassert(value.isFinite());
@@ -360,16 +356,16 @@ LLVector3 LLKeyframeMotion::PositionCurve::getValue(F32 time, F32 duration)
 //-----------------------------------------------------------------------------
 // interp()
 //-----------------------------------------------------------------------------
-LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, PositionKey& after)
+LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, const LLVector3& before, const LLVector3& after) const
 {
 	switch (mInterpolationType)
 	{
 	case IT_STEP:
-		return before.mPosition;
+		return before;
 	default:
 	case IT_LINEAR:
 	case IT_SPLINE:
-		return lerp(before.mPosition, after.mPosition, u);
+		return lerp(before, after, u);
 	}
 }
 
@@ -383,7 +379,7 @@ LLVector3 LLKeyframeMotion::PositionCurve::interp(F32 u, PositionKey& before, Po
 //-----------------------------------------------------------------------------
 // JointMotion::update()
 //-----------------------------------------------------------------------------
-void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration)
+void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time, F32 duration, KeyCursor& cursor)
 {
 	// this value being 0 is the cause of https://jira.lindenlab.com/browse/SL-22678 but I haven't 
 	// managed to get a stack to see how it got here. Testing for 0 here will stop the crash.
@@ -399,7 +395,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::SCALE) && mScaleCurve.mNumKeys)
 	{
-		joint_state->setScale( mScaleCurve.getValue( time, duration ) );
+		joint_state->setScale( mScaleCurve.getValue( time, duration, cursor.mScale ) );
 	}
 
 	//-------------------------------------------------------------------------
@@ -407,7 +403,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::ROT) && mRotationCurve.mNumKeys)
 	{
-		joint_state->setRotation( mRotationCurve.getValue( time, duration ) );
+		joint_state->setRotation( mRotationCurve.getValue( time, duration, cursor.mRotation ) );
 	}
 
 	//-------------------------------------------------------------------------
@@ -415,7 +411,7 @@ void LLKeyframeMotion::JointMotion::update(LLJointState* joint_state, F32 time,
 	//-------------------------------------------------------------------------
 	if ((usage & LLJointState::POS) && mPositionCurve.mNumKeys)
 	{
-		joint_state->setPosition( mPositionCurve.getValue( time, duration ) );
+		joint_state->setPosition( mPositionCurve.getValue( time, duration, cursor.mPosition ) );
 	}
 }
 
@@ -732,11 +728,16 @@ BOOL LLKeyframeMotion::onUpdate(F32 time, U8* joint_mask)
 void LLKeyframeMotion::applyKeyframes(F32 time)
 {
 	llassert_always (mJointMotionList->getNumJointMotions() <= mJointStates.size());
+	if (mKeyCursors.size() != mJointMotionList->getNumJointMotions())
+	{
+		mKeyCursors.resize(mJointMotionList->getNumJointMotions());
+	}
 	for (U32 i=0; i<mJointMotionList->getNumJointMotions(); i++)
 	{
 		mJointMotionList->getJointMotion(i)->update(mJointStates[i],
 													  time, 
-													  mJointMotionList->mDuration );
+													  mJointMotionList->mDuration,
+													  mKeyCursors[i]);
 	}
 
 	LLJoint::JointPriority* pose_priority = (LLJoint::JointPriority* )mCharacter->getAnimationData("Hand Pose Priority");
@@ -1621,8 +1622,9 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id)
 				return FALSE;
 			}
 
-			rCurve->mKeys[time] = rot_key;
+			rCurve->addKey(rot_key);
 		}
+		rCurve->finalizeKeys();
 
 		//---------------------------------------------------------------------
 		// scan position curve header
@@ -1715,13 +1717,14 @@ BOOL LLKeyframeMotion::deserialize(LLDataPacker& dp, const LLUUID& asset_id)
 				return FALSE;
 			}
 			
-			pCurve->mKeys[pos_key.mTime] = pos_key;
+			pCurve->addKey(pos_key);
 
 			if (is_pelvis)
 			{
 				mJointMotionList->mPelvisBBox.addPoint(pos_key.mPosition);
 			}
 		}
+		pCurve->finalizeKeys();
 
 		joint_motion->mUsage = joint_state->getUsage();
 	}
@@ -2050,14 +2053,14 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 		success &= dp.packS32(joint_motionp->mRotationCurve.mNumKeys, "num_rot_keys");
 
 		LL_DEBUGS("BVH") << "Joint " << joint_motionp->mJointName << LL_ENDL;
-		for (RotationCurve::key_map_t::iterator iter = joint_motionp->mRotationCurve.mKeys.begin();
-			 iter != joint_motionp->mRotationCurve.mKeys.end(); ++iter)
+		RotationCurve& rot_curve = joint_motionp->mRotationCurve;
+		for (size_t k = 0; k < rot_curve.mKeyTimes.size(); ++k)
 		{
-			RotationKey& rot_key = iter->second;
-			U16 time_short = F32_to_U16(rot_key.mTime, 0.f, mJointMotionList->mDuration);
+			F32 key_time = rot_curve.mKeyTimes[k];
+			U16 time_short = F32_to_U16(key_time, 0.f, mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
-			LLVector3 rot_angles = rot_key.mRotation.packToVector3();
+			LLVector3 rot_angles = rot_curve.mRotations[k].packToVector3();
 			
 			U16 x, y, z;
 			rot_angles.quantize16(-1.f, 1.f, -1.f, 1.f);
@@ -2068,27 +2071,28 @@ BOOL LLKeyframeMotion::serialize(LLDataPacker& dp) const
 			success &= dp.packU16(y, "rot_angle_y");
 			success &= dp.packU16(z, "rot_angle_z");
 
-			LL_DEBUGS("BVH") << "  rot: t " << rot_key.mTime << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
+			LL_DEBUGS("BVH") << "  rot: t " << key_time << " angles " << rot_angles.mV[VX] <<","<< rot_angles.mV[VY] <<","<< rot_angles.mV[VZ] << LL_ENDL;
 		}
 
 		success &= dp.packS32(joint_motionp->mPositionCurve.mNumKeys, "num_pos_keys");
-		for (PositionCurve::key_map_t::iterator iter = joint_motionp->mPositionCurve.mKeys.begin();
-			 iter != joint_motionp->mPositionCurve.mKeys.end(); ++iter)
+		PositionCurve& pos_curve = joint_motionp->mPositionCurve;
+		for (size_t k = 0; k < pos_curve.mKeyTimes.size(); ++k)
 		{
-			PositionKey& pos_key = iter->second;
-			U16 time_short = F32_to_U16(pos_key.mTime, 0.f, mJointMotionList->mDuration);
+			F32 key_time = pos_curve.mKeyTimes[k];
+			LLVector3& key_position = pos_curve.mPositions[k];
+			U16 time_short = F32_to_U16(key_time, 0.f, mJointMotionList->mDuration);
 			success &= dp.packU16(time_short, "time");
 
 			U16 x, y, z;
-			pos_key.mPosition.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			x = F32_to_U16(pos_key.mPosition.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			y = F32_to_U16(pos_key.mPosition.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
-			z = F32_to_U16(pos_key.mPosition.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			key_position.quantize16(-LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET, -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			x = F32_to_U16(key_position.mV[VX], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			y = F32_to_U16(key_position.mV[VY], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
+			z = F32_to_U16(key_position.mV[VZ], -LL_MAX_PELVIS_OFFSET, LL_MAX_PELVIS_OFFSET);
 			success &= dp.packU16(x, "pos_x");
 			success &= dp.packU16(y, "pos_y");
 			success &= dp.packU16(z, "pos_z");
 
-			LL_DEBUGS("BVH") << "  pos: t " << pos_key.mTime << " pos " << pos_key.mPosition.mV[VX] <<","<< pos_key.mPosition.mV[VY] <<","<< pos_key.mPosition.mV[VZ] << LL_ENDL;
+			LL_DEBUGS("BVH") << "  pos: t " << key_time << " pos " << key_position.mV[VX] <<","<< key_position.mV[VY] <<","<< key_position.mV[VZ] << LL_ENDL;
 		}
 	}	
 
@@ -31,7 +31,9 @@
 // Header files
 //-----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "llassetstorage.h"
 #include "llbboxlocal.h"
@@ -278,6 +280,45 @@ public:
 
 	enum InterpolationType { IT_STEP, IT_LINEAR, IT_SPLINE };
 
+	//-------------------------------------------------------------------------
+	// sortKeys()
+	// Sorts parallel key time and value arrays, filled in file order, by
+	// time.  Of keys with the same time the last one in the file is kept,
+	// as the old map based storage did.  Returns the number of keys kept.
+	//-------------------------------------------------------------------------
+	template<class VALUE>
+	static S32 sortKeys(std::vector<F32>& times, std::vector<VALUE>& values)
+	{
+		std::vector<size_t> order(times.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+						 [&times](size_t a, size_t b) { return times[a] < times[b]; });
+
+		std::vector<F32> sorted_times;
+		std::vector<VALUE> sorted_values;
+		sorted_times.reserve(order.size());
+		sorted_values.reserve(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			size_t key = order[i];
+			if (!sorted_times.empty() && sorted_times.back() == times[key])
+			{
+				sorted_values.back() = values[key];
+			}
+			else
+			{
+				sorted_times.push_back(times[key]);
+				sorted_values.push_back(values[key]);
+			}
+		}
+		times.swap(sorted_times);
+		values.swap(sorted_values);
+		return (S32)times.size();
+	}
+
 	//-------------------------------------------------------------------------
 	// ScaleKey
 	//-------------------------------------------------------------------------
@@ -325,13 +366,20 @@ public:
 	public:
 		ScaleCurve();
 		~ScaleCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, ScaleKey& before, ScaleKey& after);
+		// cursor is the caller's key index from the previous lookup, which
+		// makes lookups during normal playback constant time
+		LLVector3 getValue(F32 time, F32 duration, S32& cursor) const;
+		LLVector3 getValue(F32 time, F32 duration) const { S32 cursor = 0; return getValue(time, duration, cursor); }
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+
+		// keys are added in file order and sorted once by finalizeKeys()
+		void addKey(const ScaleKey& key) { mKeyTimes.push_back(key.mTime); mScales.push_back(key.mScale); }
+		void finalizeKeys() { mNumKeys = sortKeys(mKeyTimes, mScales); }
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, ScaleKey> key_map_t;
-		key_map_t 			mKeys;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mScales;
 		ScaleKey			mLoopInKey;
 		ScaleKey			mLoopOutKey;
 	};
@@ -344,15 +392,19 @@ public:
 	public:
 		RotationCurve();
 		~RotationCurve();
-		LLQuaternion getValue(F32 time, F32 duration);
-		LLQuaternion interp(F32 u, RotationKey& before, RotationKey& after);
+		LLQuaternion getValue(F32 time, F32 duration, S32& cursor) const;
+		LLQuaternion getValue(F32 time, F32 duration) const { S32 cursor = 0; return getValue(time, duration, cursor); }
+		LLQuaternion interp(F32 u, const LLQuaternion& before, const LLQuaternion& after) const;
+
+		void addKey(const RotationKey& key) { mKeyTimes.push_back(key.mTime); mRotations.push_back(key.mRotation); }
+		void finalizeKeys() { mNumKeys = sortKeys(mKeyTimes, mRotations); }
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, RotationKey> key_map_t;
-		key_map_t		mKeys;
-		RotationKey		mLoopInKey;
-		RotationKey		mLoopOutKey;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLQuaternion>	mRotations;
+		RotationKey			mLoopInKey;
+		RotationKey			mLoopOutKey;
 	};
 
 	//-------------------------------------------------------------------------
@@ -363,15 +415,33 @@ public:
 	public:
 		PositionCurve();
 		~PositionCurve();
-		LLVector3 getValue(F32 time, F32 duration);
-		LLVector3 interp(F32 u, PositionKey& before, PositionKey& after);
+		LLVector3 getValue(F32 time, F32 duration, S32& cursor) const;
+		LLVector3 getValue(F32 time, F32 duration) const { S32 cursor = 0; return getValue(time, duration, cursor); }
+		LLVector3 interp(F32 u, const LLVector3& before, const LLVector3& after) const;
+
+		void addKey(const PositionKey& key) { mKeyTimes.push_back(key.mTime); mPositions.push_back(key.mPosition); }
+		void finalizeKeys() { mNumKeys = sortKeys(mKeyTimes, mPositions); }
 
 		InterpolationType	mInterpolationType;
 		S32					mNumKeys;
-		typedef std::map<F32, PositionKey> key_map_t;
-		key_map_t		mKeys;
-		PositionKey		mLoopInKey;
-		PositionKey		mLoopOutKey;
+		std::vector<F32>	mKeyTimes;
+		std::vector<LLVector3>	mPositions;
+		PositionKey			mLoopInKey;
+		PositionKey			mLoopOutKey;
+	};
+
+	//-------------------------------------------------------------------------
+	// KeyCursor
+	// Last key looked up in each curve of a joint, kept per motion instance
+	// since the curves themselves are shared through LLKeyframeDataCache
+	//-------------------------------------------------------------------------
+	struct KeyCursor
+	{
+		KeyCursor() : mScale(0), mRotation(0), mPosition(0) {}
+
+		S32	mScale;
+		S32	mRotation;
+		S32	mPosition;
 	};
 
 	//-------------------------------------------------------------------------
@@ -387,7 +457,7 @@ public:
 		U32				mUsage;
 		LLJoint::JointPriority	mPriority;
 
-		void update(LLJointState* joint_state, F32 time, F32 duration);
+		void update(LLJointState* joint_state, F32 time, F32 duration, KeyCursor& cursor);
 	};
 	
 	//-------------------------------------------------------------------------
@@ -424,6 +494,7 @@ public:
 protected:
 	JointMotionList*				mJointMotionList;
 	std::vector<LLPointer<LLJointState> > mJointStates;
+	std::vector<KeyCursor>			mKeyCursors;
 	LLJoint*						mPelvisp;
 	LLCharacter*					mCharacter;
 	typedef std::list<JointConstraint*>	constraint_list_t;
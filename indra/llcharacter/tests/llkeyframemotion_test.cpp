@@ -0,0 +1,101 @@
+/**
+ * @file llkeyframemotion_test.cpp
+ * @brief Keyframe curve key ordering test cases.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llkeyframemotion.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct llkeyframemotion_data
+	{
+	};
+	typedef test_group<llkeyframemotion_data> llkeyframemotion_test;
+	typedef llkeyframemotion_test::object llkeyframemotion_object;
+	tut::llkeyframemotion_test llkeyframemotion_testcase("LLKeyframeMotion");
+
+	template<> template<>
+	void llkeyframemotion_object::test<1>()
+	{
+		// keys come back in time order, and the last of equal times wins
+		std::vector<F32> times;
+		std::vector<S32> values;
+		const F32 file_times[] = { 0.5f, 0.1f, 0.5f, 0.3f, 0.1f, 0.9f };
+		for (S32 i = 0; i < LL_ARRAY_SIZE(file_times); ++i)
+		{
+			times.push_back(file_times[i]);
+			values.push_back(i);
+		}
+
+		S32 count = LLKeyframeMotion::sortKeys(times, values);
+		ensure_equals("count", count, 4);
+		ensure_equals("times size", times.size(), (size_t)4);
+		ensure_equals("values size", values.size(), (size_t)4);
+		ensure_equals("time 0", times[0], 0.1f);
+		ensure_equals("time 1", times[1], 0.3f);
+		ensure_equals("time 2", times[2], 0.5f);
+		ensure_equals("time 3", times[3], 0.9f);
+		ensure_equals("last 0.1 kept", values[0], 4);
+		ensure_equals("0.3", values[1], 3);
+		ensure_equals("last 0.5 kept", values[2], 2);
+		ensure_equals("0.9", values[3], 5);
+
+		times.clear();
+		values.clear();
+		ensure_equals("empty", LLKeyframeMotion::sortKeys(times, values), 0);
+	}
+
+	template<> template<>
+	void llkeyframemotion_object::test<2>()
+	{
+		// curves finalize the keys they were given in file order
+		LLKeyframeMotion::PositionCurve curve;
+		curve.addKey(LLKeyframeMotion::PositionKey(1.f, LLVector3(1.f, 0.f, 0.f)));
+		curve.addKey(LLKeyframeMotion::PositionKey(0.f, LLVector3(0.f, 0.f, 0.f)));
+		curve.addKey(LLKeyframeMotion::PositionKey(1.f, LLVector3(2.f, 0.f, 0.f)));
+		curve.finalizeKeys();
+
+		ensure_equals("key count", curve.mNumKeys, 2);
+		ensure_equals("first time", curve.mKeyTimes[0], 0.f);
+		ensure_equals("second time", curve.mKeyTimes[1], 1.f);
+		ensure_equals("duplicate replaced", curve.mPositions[1], LLVector3(2.f, 0.f, 0.f));
+
+		S32 cursor = 0;
+		ensure_equals("between keys", curve.getValue(0.5f, 1.f, cursor), LLVector3(1.f, 0.f, 0.f));
+		ensure_equals("past last key", curve.getValue(2.f, 1.f, cursor), LLVector3(2.f, 0.f, 0.f));
+		ensure_equals("seek back", curve.getValue(0.f, 1.f, cursor), LLVector3(0.f, 0.f, 0.f));
+
+		LLKeyframeMotion::RotationCurve rotations;
+		LLQuaternion turned(F_PI_BY_TWO, LLVector3::z_axis);
+		rotations.addKey(LLKeyframeMotion::RotationKey(2.f, turned));
+		rotations.addKey(LLKeyframeMotion::RotationKey(0.f, LLQuaternion::DEFAULT));
+		rotations.finalizeKeys();
+		ensure_equals("rotation key count", rotations.mNumKeys, 2);
+		ensure_equals("rotation order", rotations.mRotations[1], turned);
+	}
+}
@@ -0,0 +1,191 @@
+/**
+ * @file   llliteralmatcher.cpp
+ * @brief  Implementation of LLLiteralMatcher.
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llliteralmatcher.h"
+
+#include <deque>
+
+static inline char ascii_lower(char c)
+{
+	return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+LLLiteralMatcher::LLLiteralMatcher()
+:	mDirty(true),
+	mClassCount(1)
+{
+}
+
+S32 LLLiteralMatcher::add(const std::string& literal, bool case_sensitive)
+{
+	Literal entry;
+	entry.mText = literal;
+	entry.mCaseSensitive = case_sensitive;
+	mLiterals.push_back(entry);
+	mDirty = true;
+	return (S32)mLiterals.size() - 1;
+}
+
+void LLLiteralMatcher::clear()
+{
+	mLiterals.clear();
+	mDirty = true;
+}
+
+void LLLiteralMatcher::build() const
+{
+	// bytes that appear in no literal share class 0, which always leads
+	// back to the root; letters share a class with their other case
+	for (S32 i = 0; i < 256; ++i)
+	{
+		mClassOf[i] = 0;
+	}
+	mClassCount = 1;
+	for (std::vector<Literal>::const_iterator it = mLiterals.begin(); it != mLiterals.end(); ++it)
+	{
+		for (std::string::const_iterator c = it->mText.begin(); c != it->mText.end(); ++c)
+		{
+			unsigned char lower = (unsigned char)ascii_lower(*c);
+			if (!mClassOf[lower])
+			{
+				mClassOf[lower] = mClassCount++;
+				if (lower >= 'a' && lower <= 'z')
+				{
+					mClassOf[lower - 'a' + 'A'] = mClassOf[lower];
+				}
+			}
+		}
+	}
+
+	// trie of the lower case literals, -1 where there is no edge yet
+	mNext.assign(mClassCount, -1);
+	mOutput.assign(1, std::vector<S32>());
+	for (S32 id = 0; id < (S32)mLiterals.size(); ++id)
+	{
+		const std::string& text = mLiterals[id].mText;
+		if (text.empty())
+		{
+			continue;
+		}
+		S32 state = 0;
+		for (std::string::const_iterator c = text.begin(); c != text.end(); ++c)
+		{
+			S32& next = mNext[state * mClassCount + getClass(*c)];
+			if (next < 0)
+			{
+				next = (S32)mOutput.size();
+				mOutput.push_back(std::vector<S32>());
+				mNext.resize(mNext.size() + mClassCount, -1);
+			}
+			// mNext may have moved, read the edge again
+			state = mNext[state * mClassCount + getClass(*c)];
+		}
+		mOutput[state].push_back(id);
+	}
+
+	// breadth first, fill the missing edges from the failure links so that
+	// find() takes exactly one step per byte
+	std::vector<S32> fail(mOutput.size(), 0);
+	std::deque<S32> queue;
+	for (S32 c = 0; c < mClassCount; ++c)
+	{
+		S32& next = mNext[c];
+		if (next < 0 || c == 0)
+		{
+			next = 0;
+		}
+		else
+		{
+			queue.push_back(next);
+		}
+	}
+	while (!queue.empty())
+	{
+		S32 state = queue.front();
+		queue.pop_front();
+		for (S32 c = 0; c < mClassCount; ++c)
+		{
+			S32 fallback = mNext[fail[state] * mClassCount + c];
+			S32& next = mNext[state * mClassCount + c];
+			if (next < 0 || c == 0)
+			{
+				next = fallback;
+			}
+			else
+			{
+				fail[next] = fallback;
+				const std::vector<S32>& inherited = mOutput[fallback];
+				mOutput[next].insert(mOutput[next].end(), inherited.begin(), inherited.end());
+				queue.push_back(next);
+			}
+		}
+	}
+
+	mDirty = false;
+}
+
+void LLLiteralMatcher::find(const char* text, size_t length, std::vector<bool>& found) const
+{
+	if (mDirty)
+	{
+		build();
+	}
+
+	found.assign(mLiterals.size(), false);
+	size_t remaining = mLiterals.size();
+	for (S32 id = 0; id < (S32)mLiterals.size(); ++id)
+	{
+		if (mLiterals[id].mText.empty())
+		{
+			found[id] = true;
+			--remaining;
+		}
+	}
+
+	S32 state = 0;
+	for (size_t i = 0; i < length && remaining; ++i)
+	{
+		state = mNext[state * mClassCount + getClass(text[i])];
+		const std::vector<S32>& output = mOutput[state];
+		for (std::vector<S32>::const_iterator it = output.begin(); it != output.end(); ++it)
+		{
+			if (found[*it])
+			{
+				continue;
+			}
+			// the automaton ignores case, case sensitive literals are checked here
+			const Literal& literal = mLiterals[*it];
+			if (!literal.mCaseSensitive
+				|| !memcmp(text + i + 1 - literal.mText.size(), literal.mText.data(), literal.mText.size()))
+			{
+				found[*it] = true;
+				--remaining;
+			}
+		}
+	}
+}
@@ -0,0 +1,84 @@
+/**
+ * @file   llliteralmatcher.h
+ * @brief  Finds which of a set of literal strings occur in a text in one pass.
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLITERALMATCHER_H
+#define LL_LLLITERALMATCHER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * LLLiteralMatcher compiles a set of literals into one automaton
+ * (Aho-Corasick) and reports which of them occur in a text, reading the
+ * text once no matter how many literals there are.  It answers "could
+ * this text match" questions cheaply, so that expensive matching such as
+ * regexes only runs where one of its literals was seen.
+ *
+ * Literals are bytes; a literal added as case insensitive matches any ASCII
+ * case of itself.  Adding literals after find() rebuilds the automaton on
+ * the next find().
+ */
+class LL_COMMON_API LLLiteralMatcher
+{
+public:
+	LLLiteralMatcher();
+
+	/// Returns the id of literal, ids count up from 0.  The same literal
+	/// added twice gets two ids.
+	S32 add(const std::string& literal, bool case_sensitive = true);
+	S32 getCount() const { return (S32)mLiterals.size(); }
+	void clear();
+
+	/// found[id] is set for every literal that occurs in text and cleared
+	/// for the rest.
+	void find(const char* text, size_t length, std::vector<bool>& found) const;
+	void find(const std::string& text, std::vector<bool>& found) const
+	{
+		find(text.data(), text.size(), found);
+	}
+
+private:
+	struct Literal
+	{
+		std::string	mText;
+		bool		mCaseSensitive;
+	};
+
+	void build() const;
+	S32 getClass(char c) const { return mClassOf[(unsigned char)c]; }
+
+	std::vector<Literal>			mLiterals;
+
+	// the automaton, built on demand
+	mutable bool					mDirty;
+	mutable S32						mClassCount;	// distinct lower case bytes in the literals, plus "any other"
+	mutable S32						mClassOf[256];	// byte to class, 0 for bytes in no literal
+	mutable std::vector<S32>		mNext;			// state * mClassCount + class to state
+	mutable std::vector<std::vector<S32> >	mOutput;	// literals ending in each state
+};
+
+#endif // LL_LLLITERALMATCHER_H
@@ -241,15 +241,17 @@ U64 LLMemory::getCurrentRSS()
 	// Eee-yew!	 See Documentation/filesystems/proc.txt in your
 	// nearest friendly kernel tree for details.
 	
+	// rss is the 24th field, in pages, after starttime and vsize
 	{
 		int ret = fscanf(fp, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*d %*d "
-						 "%*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %Lu",
+						 "%*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*d %*u %*u %Lu",
 						 &rss);
 		if (ret != 1)
 		{
 			LL_WARNS() << "couldn't parse contents of " << statPath << LL_ENDL;
 			rss = 0;
 		}
+		rss *= sysconf(_SC_PAGESIZE);
 	}
 	
 	fclose(fp);
@@ -0,0 +1,187 @@
+/**
+ * @file   llparallelfor.cpp
+ * @brief  Implementation of LLParallelFor.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llparallelfor.h"
+
+// more workers than this only add wake up cost for per-frame sized jobs
+static const S32 MAX_SHARED_WORKERS = 8;
+
+LLParallelFor* LLParallelFor::sShared = NULL;
+
+LLParallelFor::LLParallelFor(const std::string& name, S32 worker_count)
+:	mName(name),
+	mGeneration(0),
+	mActive(0),
+	mQuit(false),
+	mFunc(NULL),
+	mCount(0),
+	mNext(0)
+{
+	startWorkers(worker_count);
+}
+
+LLParallelFor::~LLParallelFor()
+{
+	stopWorkers();
+}
+
+// static
+S32 LLParallelFor::getDefaultWorkerCount()
+{
+	S32 hw_threads = (S32)std::thread::hardware_concurrency();
+	return llmax(hw_threads - 1, 0);
+}
+
+// static
+void LLParallelFor::setSharedWorkerCount(S32 worker_count)
+{
+	if (worker_count < 0)
+	{
+		worker_count = getDefaultWorkerCount();
+	}
+	worker_count = llmin(worker_count, MAX_SHARED_WORKERS);
+
+	if (worker_count == 0)
+	{
+		delete sShared;
+		sShared = NULL;
+	}
+	else if (!sShared)
+	{
+		sShared = new LLParallelFor("Shared", worker_count);
+	}
+	else
+	{
+		sShared->setWorkerCount(worker_count);
+	}
+}
+
+void LLParallelFor::setWorkerCount(S32 worker_count)
+{
+	if (worker_count != getWorkerCount())
+	{
+		stopWorkers();
+		startWorkers(worker_count);
+	}
+}
+
+void LLParallelFor::startWorkers(S32 worker_count)
+{
+	mQuit = false;
+	for (S32 i = 0; i < worker_count; ++i)
+	{
+		mWorkers.push_back(std::thread(&LLParallelFor::workerLoop, this, mGeneration));
+	}
+	LL_DEBUGS("LLParallelFor") << mName << " started " << worker_count << " workers" << LL_ENDL;
+}
+
+void LLParallelFor::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWorkReady.notify_all();
+
+	for (std::vector<std::thread>::iterator it = mWorkers.begin(); it != mWorkers.end(); ++it)
+	{
+		it->join();
+	}
+	mWorkers.clear();
+}
+
+void LLParallelFor::run(S32 count, const func_t& func)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (mWorkers.empty() || count == 1)
+	{
+		for (S32 i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFunc = &func;
+		mCount = count;
+		mNext = 0;
+		mActive = (S32)mWorkers.size();
+		++mGeneration;
+	}
+	mWorkReady.notify_all();
+
+	doWork();
+
+	// Workers may still be finishing their last index, and must be out of
+	// doWork() before func goes out of scope.
+	std::unique_lock<std::mutex> lock(mMutex);
+	mWorkDone.wait(lock, [this]() { return mActive == 0; });
+	mFunc = NULL;
+}
+
+void LLParallelFor::doWork()
+{
+	for (S32 i = mNext++; i < mCount; i = mNext++)
+	{
+		(*mFunc)(i);
+	}
+}
+
+void LLParallelFor::workerLoop(U32 generation)
+{
+	// generation is the last run() this worker is not part of
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkReady.wait(lock, [&]() { return mQuit || mGeneration != generation; });
+			if (mQuit)
+			{
+				return;
+			}
+			generation = mGeneration;
+		}
+
+		doWork();
+
+		bool last;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			last = (--mActive == 0);
+		}
+		if (last)
+		{
+			mWorkDone.notify_one();
+		}
+	}
+}
@@ -0,0 +1,104 @@
+/**
+ * @file   llparallelfor.h
+ * @brief  Small fork/join pool for splitting a frame's work across cores.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPARALLELFOR_H
+#define LL_LLPARALLELFOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+/**
+ * LLParallelFor runs a function over a range of indices on a fixed set of
+ * worker threads and returns once every index has been processed.  The
+ * calling thread takes part in the work, so a pool with no workers simply
+ * runs the loop inline.
+ *
+ * This is meant for short, independent, per-frame jobs where the caller
+ * needs the results before it can carry on, e.g. updating every avatar's
+ * skeleton.  Anything longer lived belongs on an LLQueuedThread.
+ *
+ * run() must only be called from one thread at a time, and func must not
+ * touch anything another index might also touch.
+ */
+class LL_COMMON_API LLParallelFor : private boost::noncopyable
+{
+public:
+	typedef std::function<void(S32 index)> func_t;
+
+	LLParallelFor(const std::string& name, S32 worker_count);
+	~LLParallelFor();
+
+	// Calls func(i) for each i in [0, count), blocking until all are done.
+	void run(S32 count, const func_t& func);
+
+	// Stops the current workers and starts worker_count new ones.
+	void setWorkerCount(S32 worker_count);
+	S32 getWorkerCount() const { return (S32)mWorkers.size(); }
+
+	const std::string& getName() const { return mName; }
+
+	// A sensible default for worker_count: one less than the number of
+	// hardware threads, leaving a core for the calling thread.
+	static S32 getDefaultWorkerCount();
+
+	// One pool shared by all of the main thread's per-frame jobs, so they
+	// don't each keep their own idle threads around.  NULL when those jobs
+	// run inline.  As with run(), only use it from the main thread.
+	static LLParallelFor* getShared() { return sShared; }
+	// worker_count < 0 picks a default, 0 removes the shared pool.
+	static void setSharedWorkerCount(S32 worker_count);
+
+private:
+	void startWorkers(S32 worker_count);
+	void stopWorkers();
+	void workerLoop(U32 generation);
+	void doWork();
+
+	std::string					mName;
+	std::vector<std::thread>	mWorkers;
+
+	std::mutex					mMutex;
+	std::condition_variable		mWorkReady;
+	std::condition_variable		mWorkDone;
+	U32							mGeneration;	// bumped for each run()
+	S32							mActive;		// workers still inside the current run()
+	bool						mQuit;
+
+	const func_t*				mFunc;
+	S32							mCount;
+	std::atomic<S32>			mNext;
+
+	static LLParallelFor*		sShared;
+};
+
+#endif // LL_LLPARALLELFOR_H
@@ -338,6 +338,7 @@ private:
 
 	void parsePart(const char* buf, int len);
 	friend class LLSDSerialize;
+	friend class LLSDXMLBufferParser; // <FS/> shares Impl's element table and value conversion
 };
 
 /** 
@@ -825,6 +826,13 @@ public:
 		return fromXMLEmbedded(sd, str, emit_errors);
 //		return fromXMLDocument(sd, str, emit_errors);
 	}
+	// <FS> Parses a complete XML document held in memory.  Uses a single
+	// pass parser over the buffer when enabled, falling back to fromXML()
+	// for anything that parser does not accept, so results are identical.
+	static S32 fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors=true);
+	static void setUseFastXMLParser(bool enable);
+	static bool getUseFastXMLParser();
+	// </FS>
 
 	/*
 	 * Binary Methods
@@ -29,8 +29,10 @@
 
 #include <iostream>
 #include <deque>
+#include <atomic>
 
 #include "apr_base64.h"
+#include "llmemorystream.h"
 #include <boost/regex.hpp>
 #include <stack>
 
@@ -305,6 +307,7 @@ private:
 		ELEMENT_UNKNOWN
 	};
 	static Element readElement(const XML_Char* name);
+	static void setValue(LLSD& value, Element element, const std::string& content);
 	
 	static const XML_Char* findAttribute(const XML_Char* name, const XML_Char** pairs);
 	
@@ -328,6 +331,8 @@ private:
 	
 	std::string mCurrentKey;		// Current XML <tag>
 	std::string mCurrentContent;	// String data between <tag> and </tag>
+
+	friend class LLSDXMLBufferParser;
 };
 
 
@@ -750,6 +755,113 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 	LLSD& value = *mStack.back();
 	mStack.pop_back();
 	
+	setValue(value, element, mCurrentContent);
+
+	mCurrentContent.clear();
+}
+
+void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
+{
+	#ifdef XML_PARSER_PERFORMANCE_TESTS
+	XML_Timer timer( &charDataTime );
+	#endif	// XML_PARSER_PERFORMANCE_TESTS
+
+	mCurrentContent.append(data, length);
+}
+
+
+void LLSDXMLParser::Impl::sStartElementHandler(
+	void* userData, const XML_Char* name, const XML_Char** attributes)
+{
+	((LLSDXMLParser::Impl*)userData)->startElementHandler(name, attributes);
+}
+
+void LLSDXMLParser::Impl::sEndElementHandler(
+	void* userData, const XML_Char* name)
+{
+	((LLSDXMLParser::Impl*)userData)->endElementHandler(name);
+}
+
+void LLSDXMLParser::Impl::sCharacterDataHandler(
+	void* userData, const XML_Char* data, int length)
+{
+	((LLSDXMLParser::Impl*)userData)->characterDataHandler(data, length);
+}
+
+
+/*
+	This code is time critical
+
+	This is a sample of tag occurances of text in simstate file with ~8000 objects.
+	A tag pair (<key>something</key>) counts is counted as two:
+
+		key     - 2680178
+		real    - 1818362
+		integer -  906078
+		array   -  295682
+		map     -  191818
+		uuid    -  177903
+		binary  -  175748
+		string  -   53482
+		undef   -   40353
+		boolean -   33874
+		llsd    -   16332
+		uri     -      38
+		date    -       1
+*/
+LLSDXMLParser::Impl::Element LLSDXMLParser::Impl::readElement(const XML_Char* name)
+{
+	#ifdef XML_PARSER_PERFORMANCE_TESTS
+	XML_Timer timer( &readElementTime );
+	#endif // XML_PARSER_PERFORMANCE_TESTS
+
+	XML_Char c = *name;
+	switch (c)
+	{
+		case 'k':
+			if (strcmp(name, "key") == 0) { return ELEMENT_KEY; }
+			break;
+		case 'r':
+			if (strcmp(name, "real") == 0) { return ELEMENT_REAL; }
+			break;
+		case 'i':
+			if (strcmp(name, "integer") == 0) { return ELEMENT_INTEGER; }
+			break;
+		case 'a':
+			if (strcmp(name, "array") == 0) { return ELEMENT_ARRAY; }
+			break;
+		case 'm':
+			if (strcmp(name, "map") == 0) { return ELEMENT_MAP; }
+			break;
+		case 'u':
+			if (strcmp(name, "uuid") == 0) { return ELEMENT_UUID; }
+			if (strcmp(name, "undef") == 0) { return ELEMENT_UNDEF; }
+			if (strcmp(name, "uri") == 0) { return ELEMENT_URI; }
+			break;
+		case 'b':
+			if (strcmp(name, "binary") == 0) { return ELEMENT_BINARY; }
+			if (strcmp(name, "boolean") == 0) { return ELEMENT_BOOL; }
+			break;
+		case 's':
+			if (strcmp(name, "string") == 0) { return ELEMENT_STRING; }
+			break;
+		case 'l':
+			if (strcmp(name, "llsd") == 0) { return ELEMENT_LLSD; }
+			break;
+		case 'd':
+			if (strcmp(name, "date") == 0) { return ELEMENT_DATE; }
+			break;
+	}
+	return ELEMENT_UNKNOWN;
+}
+
+
+
+
+
+// static
+void LLSDXMLParser::Impl::setValue(LLSD& value, Element element, const std::string& content)
+{
 	switch (element)
 	{
 		case ELEMENT_UNDEF:
@@ -757,56 +869,56 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 			break;
 		
 		case ELEMENT_BOOL:
-			value = (mCurrentContent == "true" || mCurrentContent == "1");
+			value = (content == "true" || content == "1");
 			break;
 		
 		case ELEMENT_INTEGER:
 			{
 				S32 i;
 				// sscanf okay here with different locales - ints don't change for different locale settings like floats do.
-				if ( sscanf(mCurrentContent.c_str(), "%d", &i ) == 1 )
+				if ( sscanf(content.c_str(), "%d", &i ) == 1 )
 				{	// See if sscanf works - it's faster
 					value = i;
 				}
 				else
 				{
-					value = LLSD(mCurrentContent).asInteger();
+					value = LLSD(content).asInteger();
 				}
 			}
 			break;
 		
 		case ELEMENT_REAL:
 			{
-				value = LLSD(mCurrentContent).asReal();
+				value = LLSD(content).asReal();
 				// removed since this breaks when locale has decimal separator that isn't '.'
 				// investigated changing local to something compatible each time but deemed higher
 				// risk that just using LLSD.asReal() each time.
 				//F64 r;
-				//if ( sscanf(mCurrentContent.c_str(), "%lf", &r ) == 1 )
+				//if ( sscanf(content.c_str(), "%lf", &r ) == 1 )
 				//{	// See if sscanf works - it's faster
 				//	value = r;
 				//}
 				//else
 				//{
-				//	value = LLSD(mCurrentContent).asReal();
+				//	value = LLSD(content).asReal();
 				//}
 			}
 			break;
 		
 		case ELEMENT_STRING:
-			value = mCurrentContent;
+			value = content;
 			break;
 		
 		case ELEMENT_UUID:
-			value = LLSD(mCurrentContent).asUUID();
+			value = LLSD(content).asUUID();
 			break;
 		
 		case ELEMENT_DATE:
-			value = LLSD(mCurrentContent).asDate();
+			value = LLSD(content).asDate();
 			break;
 		
 		case ELEMENT_URI:
-			value = LLSD(mCurrentContent).asURI();
+			value = LLSD(content).asURI();
 			break;
 		
 		case ELEMENT_BINARY:
@@ -817,7 +929,7 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 			// so performance impact shold be negligible. + poppy 2009-09-04
 			boost::regex r;
 			r.assign("\\s");
-			std::string stripped = boost::regex_replace(mCurrentContent, r, "");
+			std::string stripped = boost::regex_replace(content, r, "");
 			S32 len = apr_base64_decode_len(stripped.c_str());
 			std::vector<U8> data;
 			data.resize(len);
@@ -835,108 +947,754 @@ void LLSDXMLParser::Impl::endElementHandler(const XML_Char* name)
 			// other values, map and array, have already been set
 			break;
 	}
+}
 
-	mCurrentContent.clear();
+/**
+ * LLSDXMLBufferParser
+ *
+ * Single pass parser for a complete XML LLSD document held in one contiguous
+ * buffer.  Tags are matched in place, and character data is decoded straight
+ * into a reused string, so no per element allocations are made besides the
+ * LLSD values themselves.
+ *
+ * It only accepts the well-formed subset of XML that LLSD documents actually
+ * use.  Anything else (DOCTYPEs, unknown elements, stray text, malformed
+ * markup, ...) makes parse() return false without touching the output, so
+ * the caller can fall back to the expat parser and get exactly its result.
+ */
+class LLSDXMLBufferParser
+{
+public:
+	LLSDXMLBufferParser(const char* buf, size_t len)
+		: mCur(buf), mEnd(buf + len), mParseCount(0)
+	{
+	}
+
+	bool parse(LLSD& data, S32& parse_count);
+
+private:
+	typedef LLSDXMLParser::Impl::Element Element;
+
+	// Deep documents are left to expat rather than risking our stack.
+	static const S32 MAX_DEPTH = 256;
+
+	struct Tag
+	{
+		Element mElement;
+		const char* mName;
+		size_t mNameLen;
+		bool mSelfClosing;
+		bool mBase64;		// true unless a non-base64 encoding is given
+	};
+
+	bool parseValue(LLSD& value, const Tag& tag, S32 depth);
+	bool parseMap(LLSD& value, S32 depth);
+	bool parseArray(LLSD& value, S32 depth);
+	bool readText(std::string& text);
+	bool readStartTag(Tag& tag);
+	bool readEndTag(const char* name, size_t name_len);
+	bool skipMisc();
+	bool skipComment();
+	bool skipDeclaration();
+	bool atEndTag() const { return (mEnd - mCur >= 2) && mCur[0] == '<' && mCur[1] == '/'; }
+	bool consumeChar();
+	bool matches(const char* str) const;
+
+	static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+	static bool isNameChar(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+			|| c == '_' || c == ':' || c == '.' || c == '-';
+	}
+	static void appendUTF8(std::string& out, U32 code);
+
+	const char* mCur;
+	const char* mEnd;
+	S32 mParseCount;
+	std::string mText;
+	std::string mKey;
+};
+
+bool LLSDXMLBufferParser::parse(LLSD& data, S32& parse_count)
+{
+	// Optional UTF-8 byte order mark and XML declaration
+	if (matches("\xEF\xBB\xBF"))
+	{
+		mCur += 3;
+	}
+	if (matches("<?xml") && !skipDeclaration())
+	{
+		return false;
+	}
+
+	Tag tag;
+	if (!skipMisc() || !readStartTag(tag) || tag.mElement != LLSDXMLParser::Impl::ELEMENT_LLSD)
+	{
+		return false;
+	}
+
+	LLSD result;
+	if (!tag.mSelfClosing)
+	{
+		if (!skipMisc())
+		{
+			return false;
+		}
+		if (!atEndTag())
+		{
+			Tag value_tag;
+			if (!readStartTag(value_tag) || !parseValue(result, value_tag, 0) || !skipMisc())
+			{
+				return false;
+			}
+		}
+		if (!readEndTag("llsd", 4))
+		{
+			return false;
+		}
+	}
+
+	// Like the expat parser, stop at </llsd> and ignore anything after it.
+	data = result;
+	parse_count = mParseCount;
+	return true;
 }
 
-void LLSDXMLParser::Impl::characterDataHandler(const XML_Char* data, int length)
+bool LLSDXMLBufferParser::parseValue(LLSD& value, const Tag& tag, S32 depth)
 {
-	#ifdef XML_PARSER_PERFORMANCE_TESTS
-	XML_Timer timer( &charDataTime );
-	#endif	// XML_PARSER_PERFORMANCE_TESTS
+	switch (tag.mElement)
+	{
+		case LLSDXMLParser::Impl::ELEMENT_LLSD:
+		case LLSDXMLParser::Impl::ELEMENT_KEY:
+		case LLSDXMLParser::Impl::ELEMENT_UNKNOWN:
+			return false;
 
-	mCurrentContent.append(data, length);
+		case LLSDXMLParser::Impl::ELEMENT_BINARY:
+			if (!tag.mBase64)
+			{
+				return false;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	++mParseCount;
+
+	if (tag.mElement == LLSDXMLParser::Impl::ELEMENT_MAP)
+	{
+		value = LLSD::emptyMap();
+		return tag.mSelfClosing || (depth < MAX_DEPTH && parseMap(value, depth + 1));
+	}
+	if (tag.mElement == LLSDXMLParser::Impl::ELEMENT_ARRAY)
+	{
+		value = LLSD::emptyArray();
+		return tag.mSelfClosing || (depth < MAX_DEPTH && parseArray(value, depth + 1));
+	}
+
+	mText.clear();
+	if (!tag.mSelfClosing)
+	{
+		if (!readText(mText) || !readEndTag(tag.mName, tag.mNameLen))
+		{
+			return false;
+		}
+	}
+	LLSDXMLParser::Impl::setValue(value, tag.mElement, mText);
+	return true;
 }
 
+bool LLSDXMLBufferParser::parseMap(LLSD& value, S32 depth)
+{
+	while (true)
+	{
+		if (!skipMisc())
+		{
+			return false;
+		}
+		if (atEndTag())
+		{
+			return readEndTag("map", 3);
+		}
+
+		Tag tag;
+		if (!readStartTag(tag) || tag.mElement != LLSDXMLParser::Impl::ELEMENT_KEY || tag.mSelfClosing)
+		{
+			return false;
+		}
+		mKey.clear();
+		if (!readText(mKey) || !readEndTag("key", 3) || mKey.empty())
+		{	// the expat parser skips values with an empty key
+			return false;
+		}
 
-void LLSDXMLParser::Impl::sStartElementHandler(
-	void* userData, const XML_Char* name, const XML_Char** attributes)
+		if (!skipMisc() || !readStartTag(tag))
+		{
+			return false;
+		}
+		if (!parseValue(value[mKey], tag, depth))
+		{
+			return false;
+		}
+	}
+}
+
+bool LLSDXMLBufferParser::parseArray(LLSD& value, S32 depth)
 {
-	((LLSDXMLParser::Impl*)userData)->startElementHandler(name, attributes);
+	while (true)
+	{
+		if (!skipMisc())
+		{
+			return false;
+		}
+		if (atEndTag())
+		{
+			return readEndTag("array", 5);
+		}
+
+		Tag tag;
+		if (!readStartTag(tag))
+		{
+			return false;
+		}
+		if (!parseValue(value.append(LLSD()), tag, depth))
+		{
+			return false;
+		}
+	}
 }
 
-void LLSDXMLParser::Impl::sEndElementHandler(
-	void* userData, const XML_Char* name)
+// Reads character data up to the next tag, decoding entities and character
+// references, unwrapping CDATA sections and normalising line ends the same
+// way expat does.  Fails on anything that is not well-formed.
+bool LLSDXMLBufferParser::readText(std::string& text)
 {
-	((LLSDXMLParser::Impl*)userData)->endElementHandler(name);
+	while (mCur < mEnd)
+	{
+		const char* run = mCur;
+		while (mCur < mEnd)
+		{
+			unsigned char c = (unsigned char)*mCur;
+			if (c == '<' || c == '&' || c == '\r' || c == ']' || c < 0x20 || c >= 0x80)
+			{
+				break;
+			}
+			++mCur;
+		}
+		text.append(run, mCur - run);
+		if (mCur >= mEnd)
+		{
+			break;
+		}
+
+		char c = *mCur;
+		if (c == '<')
+		{
+			if (matches("<!--"))
+			{
+				if (!skipComment())
+				{
+					return false;
+				}
+			}
+			else if (matches("<![CDATA["))
+			{
+				mCur += 9;
+				while (!matches("]]>"))
+				{
+					if (mCur >= mEnd)
+					{
+						return false;
+					}
+					if (*mCur == '\r')
+					{
+						text += '\n';
+						++mCur;
+						if (mCur < mEnd && *mCur == '\n')
+						{
+							++mCur;
+						}
+						continue;
+					}
+					const char* start = mCur;
+					if (!consumeChar())
+					{
+						return false;
+					}
+					text.append(start, mCur - start);
+				}
+				mCur += 3;
+			}
+			else
+			{
+				return true;
+			}
+		}
+		else if (c == '&')
+		{
+			const char* semi = (const char*)memchr(mCur, ';', std::min<size_t>(mEnd - mCur, 12));
+			if (!semi)
+			{
+				return false;
+			}
+			const char* name = mCur + 1;
+			size_t len = semi - name;
+			if (len == 2 && !strncmp(name, "lt", 2))		text += '<';
+			else if (len == 2 && !strncmp(name, "gt", 2))	text += '>';
+			else if (len == 3 && !strncmp(name, "amp", 3))	text += '&';
+			else if (len == 4 && !strncmp(name, "quot", 4))	text += '"';
+			else if (len == 4 && !strncmp(name, "apos", 4))	text += '\'';
+			else if (len >= 2 && name[0] == '#')
+			{
+				bool hex = (name[1] == 'x');
+				const char* digit = name + (hex ? 2 : 1);
+				if (digit == semi)
+				{
+					return false;
+				}
+				U32 code = 0;
+				for (; digit < semi; ++digit)
+				{
+					char d = *digit;
+					U32 nibble;
+					if (d >= '0' && d <= '9')					nibble = d - '0';
+					else if (hex && d >= 'a' && d <= 'f')		nibble = d - 'a' + 10;
+					else if (hex && d >= 'A' && d <= 'F')		nibble = d - 'A' + 10;
+					else return false;
+					code = code * (hex ? 16 : 10) + nibble;
+					if (code > 0x10FFFF)
+					{
+						return false;
+					}
+				}
+				// Only characters allowed by the XML spec may be referenced
+				if (!(code == 0x9 || code == 0xA || code == 0xD
+					  || (code >= 0x20 && code <= 0xD7FF)
+					  || (code >= 0xE000 && code <= 0xFFFD)
+					  || code >= 0x10000))
+				{
+					return false;
+				}
+				appendUTF8(text, code);
+			}
+			else
+			{
+				return false;
+			}
+			mCur = semi + 1;
+		}
+		else if (c == '\r')
+		{
+			text += '\n';
+			++mCur;
+			if (mCur < mEnd && *mCur == '\n')
+			{
+				++mCur;
+			}
+		}
+		else if (c == ']')
+		{
+			if (matches("]]>"))
+			{
+				return false;
+			}
+			text += c;
+			++mCur;
+		}
+		else
+		{
+			const char* start = mCur;
+			if (!consumeChar())
+			{
+				return false;
+			}
+			text.append(start, mCur - start);
+		}
+	}
+	// ran off the end of the buffer inside an element
+	return false;
 }
 
-void LLSDXMLParser::Impl::sCharacterDataHandler(
-	void* userData, const XML_Char* data, int length)
+bool LLSDXMLBufferParser::readStartTag(Tag& tag)
 {
-	((LLSDXMLParser::Impl*)userData)->characterDataHandler(data, length);
+	if (mCur >= mEnd || *mCur != '<')
+	{
+		return false;
+	}
+	++mCur;
+
+	tag.mName = mCur;
+	while (mCur < mEnd && isNameChar(*mCur))
+	{
+		++mCur;
+	}
+	tag.mNameLen = mCur - tag.mName;
+	char first = tag.mNameLen ? tag.mName[0] : '0';
+	if (tag.mNameLen == 0 || tag.mNameLen > 15 || (first >= '0' && first <= '9') || first == '.' || first == '-')
+	{
+		return false;
+	}
+
+	char name[16];
+	memcpy(name, tag.mName, tag.mNameLen);
+	name[tag.mNameLen] = '\0';
+	tag.mElement = LLSDXMLParser::Impl::readElement(name);
+	tag.mSelfClosing = false;
+	tag.mBase64 = true;
+
+	bool have_encoding = false;
+	while (true)
+	{
+		const char* before_space = mCur;
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd)
+		{
+			return false;
+		}
+		if (*mCur == '>')
+		{
+			++mCur;
+			return true;
+		}
+		if (*mCur == '/')
+		{
+			if (mEnd - mCur < 2 || mCur[1] != '>')
+			{
+				return false;
+			}
+			mCur += 2;
+			tag.mSelfClosing = true;
+			return true;
+		}
+
+		// attribute: must be separated from what precedes it by whitespace
+		if (mCur == before_space || !isNameChar(*mCur))
+		{
+			return false;
+		}
+		const char* attr = mCur;
+		while (mCur < mEnd && isNameChar(*mCur))
+		{
+			++mCur;
+		}
+		size_t attr_len = mCur - attr;
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd || *mCur != '=')
+		{
+			return false;
+		}
+		++mCur;
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd || (*mCur != '"' && *mCur != '\''))
+		{
+			return false;
+		}
+		char quote = *mCur++;
+		const char* value = mCur;
+		while (mCur < mEnd && *mCur != quote)
+		{
+			char c = *mCur;
+			if (c == '<' || c == '&' || isSpace(c) || (unsigned char)c < 0x20 || (unsigned char)c >= 0x80)
+			{	// leave normalisation, references and unicode to expat
+				return false;
+			}
+			++mCur;
+		}
+		if (mCur >= mEnd)
+		{
+			return false;
+		}
+		size_t value_len = mCur - value;
+		++mCur;
+
+		if (attr_len == 8 && !strncmp(attr, "encoding", 8))
+		{
+			if (have_encoding)
+			{	// duplicate attribute
+				return false;
+			}
+			have_encoding = true;
+			if (tag.mElement == LLSDXMLParser::Impl::ELEMENT_BINARY)
+			{
+				tag.mBase64 = (value_len == 6 && !strncmp(value, "base64", 6));
+			}
+		}
+		else
+		{	// not worth tracking duplicates of attributes LLSD never uses
+			return false;
+		}
+	}
 }
 
+bool LLSDXMLBufferParser::readEndTag(const char* name, size_t name_len)
+{
+	if (!atEndTag() || (size_t)(mEnd - mCur) < name_len + 3)
+	{
+		return false;
+	}
+	mCur += 2;
+	if (strncmp(mCur, name, name_len) != 0)
+	{
+		return false;
+	}
+	mCur += name_len;
+	while (mCur < mEnd && isSpace(*mCur))
+	{
+		++mCur;
+	}
+	if (mCur >= mEnd || *mCur != '>')
+	{
+		return false;
+	}
+	++mCur;
+	return true;
+}
 
-/*
-	This code is time critical
+// Skips whitespace and comments between elements.  Fails on any other
+// character data, which LLSD never places outside of a scalar value.
+bool LLSDXMLBufferParser::skipMisc()
+{
+	while (mCur < mEnd)
+	{
+		if (isSpace(*mCur))
+		{
+			++mCur;
+		}
+		else if (matches("<!--"))
+		{
+			if (!skipComment())
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return *mCur == '<' && !matches("<!") && !matches("<?");
+		}
+	}
+	return false;
+}
 
-	This is a sample of tag occurances of text in simstate file with ~8000 objects.
-	A tag pair (<key>something</key>) counts is counted as two:
+bool LLSDXMLBufferParser::skipComment()
+{
+	mCur += 4;
+	while (mCur < mEnd)
+	{
+		if (matches("--"))
+		{	// "--" may only appear as the end of the comment
+			if (!matches("-->"))
+			{
+				return false;
+			}
+			mCur += 3;
+			return true;
+		}
+		if (!consumeChar())
+		{
+			return false;
+		}
+	}
+	return false;
+}
 
-		key     - 2680178
-		real    - 1818362
-		integer -  906078
-		array   -  295682
-		map     -  191818
-		uuid    -  177903
-		binary  -  175748
-		string  -   53482
-		undef   -   40353
-		boolean -   33874
-		llsd    -   16332
-		uri     -      38
-		date    -       1
-*/
-LLSDXMLParser::Impl::Element LLSDXMLParser::Impl::readElement(const XML_Char* name)
+// Accepts the usual <?xml version="1.0" [encoding="utf-8"] [standalone=...] ?>
+// declaration.  The document is always decoded as UTF-8, as with expat.
+bool LLSDXMLBufferParser::skipDeclaration()
 {
-	#ifdef XML_PARSER_PERFORMANCE_TESTS
-	XML_Timer timer( &readElementTime );
-	#endif // XML_PARSER_PERFORMANCE_TESTS
+	mCur += 5;
+	static const char* const ATTRIBUTES[] = { "version", "encoding", "standalone" };
+	S32 next_attribute = 0;
+	while (true)
+	{
+		const char* before_space = mCur;
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (matches("?>"))
+		{
+			mCur += 2;
+			return next_attribute > 0;
+		}
+		if (mCur == before_space)
+		{
+			return false;
+		}
 
-	XML_Char c = *name;
-	switch (c)
+		S32 found = -1;
+		for (S32 i = next_attribute; i < LL_ARRAY_SIZE(ATTRIBUTES) && found < 0; ++i)
+		{
+			if (matches(ATTRIBUTES[i]))
+			{
+				found = i;
+			}
+		}
+		if (found < 0 || (found > 0 && next_attribute == 0))
+		{	// version must come first
+			return false;
+		}
+		mCur += strlen(ATTRIBUTES[found]);
+		next_attribute = found + 1;
+
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd || *mCur != '=')
+		{
+			return false;
+		}
+		++mCur;
+		while (mCur < mEnd && isSpace(*mCur))
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd || (*mCur != '"' && *mCur != '\''))
+		{
+			return false;
+		}
+		char quote = *mCur++;
+		const char* value = mCur;
+		while (mCur < mEnd && *mCur != quote)
+		{
+			++mCur;
+		}
+		if (mCur >= mEnd)
+		{
+			return false;
+		}
+		std::string val(value, mCur - value);
+		++mCur;
+
+		if ((found == 0 && val != "1.0")
+			|| (found == 1 && LLStringUtil::compareInsensitive(val, "utf-8") != 0)
+			|| (found == 2 && val != "yes" && val != "no"))
+		{
+			return false;
+		}
+	}
+}
+
+// Consumes one character, which must be valid UTF-8 and allowed in XML.
+bool LLSDXMLBufferParser::consumeChar()
+{
+	unsigned char c = (unsigned char)*mCur;
+	if (c < 0x80)
 	{
-		case 'k':
-			if (strcmp(name, "key") == 0) { return ELEMENT_KEY; }
-			break;
-		case 'r':
-			if (strcmp(name, "real") == 0) { return ELEMENT_REAL; }
-			break;
-		case 'i':
-			if (strcmp(name, "integer") == 0) { return ELEMENT_INTEGER; }
-			break;
-		case 'a':
-			if (strcmp(name, "array") == 0) { return ELEMENT_ARRAY; }
-			break;
-		case 'm':
-			if (strcmp(name, "map") == 0) { return ELEMENT_MAP; }
-			break;
-		case 'u':
-			if (strcmp(name, "uuid") == 0) { return ELEMENT_UUID; }
-			if (strcmp(name, "undef") == 0) { return ELEMENT_UNDEF; }
-			if (strcmp(name, "uri") == 0) { return ELEMENT_URI; }
-			break;
-		case 'b':
-			if (strcmp(name, "binary") == 0) { return ELEMENT_BINARY; }
-			if (strcmp(name, "boolean") == 0) { return ELEMENT_BOOL; }
-			break;
-		case 's':
-			if (strcmp(name, "string") == 0) { return ELEMENT_STRING; }
-			break;
-		case 'l':
-			if (strcmp(name, "llsd") == 0) { return ELEMENT_LLSD; }
-			break;
-		case 'd':
-			if (strcmp(name, "date") == 0) { return ELEMENT_DATE; }
-			break;
+		if (c < 0x20 && c != '\t' && c != '\n' && c != '\r')
+		{
+			return false;
+		}
+		++mCur;
+		return true;
 	}
-	return ELEMENT_UNKNOWN;
+
+	S32 extra;
+	U32 code;
+	U32 min_code;
+	if (c >= 0xC2 && c <= 0xDF)		{ extra = 1; code = c & 0x1F; min_code = 0x80; }
+	else if (c >= 0xE0 && c <= 0xEF)	{ extra = 2; code = c & 0x0F; min_code = 0x800; }
+	else if (c >= 0xF0 && c <= 0xF4)	{ extra = 3; code = c & 0x07; min_code = 0x10000; }
+	else return false;
+
+	if (mEnd - mCur <= extra)
+	{
+		return false;
+	}
+	for (S32 i = 1; i <= extra; ++i)
+	{
+		unsigned char cont = (unsigned char)mCur[i];
+		if ((cont & 0xC0) != 0x80)
+		{
+			return false;
+		}
+		code = (code << 6) | (cont & 0x3F);
+	}
+	if (code < min_code || code > 0x10FFFF
+		|| (code >= 0xD800 && code <= 0xDFFF)
+		|| code == 0xFFFE || code == 0xFFFF)
+	{
+		return false;
+	}
+	mCur += extra + 1;
+	return true;
 }
 
+bool LLSDXMLBufferParser::matches(const char* str) const
+{
+	size_t len = strlen(str);
+	return (size_t)(mEnd - mCur) >= len && !memcmp(mCur, str, len);
+}
 
+// static
+void LLSDXMLBufferParser::appendUTF8(std::string& out, U32 code)
+{
+	if (code < 0x80)
+	{
+		out += (char)code;
+	}
+	else if (code < 0x800)
+	{
+		out += (char)(0xC0 | (code >> 6));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		out += (char)(0xE0 | (code >> 12));
+		out += (char)(0x80 | ((code >> 6) & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		out += (char)(0xF0 | (code >> 18));
+		out += (char)(0x80 | ((code >> 12) & 0x3F));
+		out += (char)(0x80 | ((code >> 6) & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+}
 
+static std::atomic<bool> sUseFastXMLParser(true);
 
+// static
+void LLSDSerialize::setUseFastXMLParser(bool enable)
+{
+	sUseFastXMLParser = enable;
+}
+
+// static
+bool LLSDSerialize::getUseFastXMLParser()
+{
+	return sUseFastXMLParser;
+}
+
+// static
+S32 LLSDSerialize::fromXMLBuffer(LLSD& sd, const char* buf, size_t len, bool emit_errors)
+{
+	if (sUseFastXMLParser)
+	{
+		S32 parse_count = 0;
+		LLSDXMLBufferParser parser(buf, len);
+		if (parser.parse(sd, parse_count))
+		{
+			return parse_count;
+		}
+	}
+
+	// Either disabled or the document uses something the buffer parser does
+	// not handle: let expat deal with it.
+	LLMemoryStream stream((const U8*)buf, (S32)len);
+	return fromXML(sd, stream, emit_errors);
+}
 
 /**
  * LLSDXMLParser
@@ -1353,6 +1353,93 @@ BOOL gzip_file(const std::string& srcfile, const std::string& dstfile)
 	return retval;
 }
 
+BOOL gunzip_file_to_buffer(const std::string& srcfile, std::vector<U8>& dst)
+{
+	const S32 UNCOMPRESS_BUFFER_SIZE = 256 * 1024;
+	BOOL retval = FALSE;
+	gzFile src = NULL;
+	S32 bytes = 0;
+	size_t used = 0;
+
+	dst.clear();
+#ifdef LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(srcfile);
+    src = gzopen_w(utf16filename.c_str(), "rb");
+#else
+    src = gzopen(srcfile.c_str(), "rb");
+#endif
+	if (! src) goto err;
+	gzbuffer(src, UNCOMPRESS_BUFFER_SIZE);
+	do
+	{
+		// grow geometrically and inflate straight into the tail
+		if (dst.size() - used < (size_t)UNCOMPRESS_BUFFER_SIZE)
+		{
+			dst.resize(llmax(dst.size() * 2, used + UNCOMPRESS_BUFFER_SIZE));
+		}
+		bytes = gzread(src, &dst[used], UNCOMPRESS_BUFFER_SIZE);
+		if (bytes < 0)
+		{
+			LL_WARNS() << "gzread failed on " << srcfile << ": " << gzerror(src, NULL) << LL_ENDL;
+			goto err;
+		}
+		used += bytes;
+	} while (bytes > 0 && gzeof(src) == 0);
+	dst.resize(used);
+	retval = TRUE;
+err:
+	if (src != NULL) gzclose(src);
+	if (!retval) dst.clear();
+	return retval;
+}
+
+BOOL gzip_buffer_to_file(const U8* src, size_t size, const std::string& dstfile)
+{
+	const size_t COMPRESS_CHUNK_SIZE = 1024 * 1024;
+	std::string tmpfile;
+	BOOL retval = FALSE;
+	gzFile dst = NULL;
+	tmpfile = dstfile + ".t";
+
+#ifdef LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(tmpfile);
+    dst = gzopen_w(utf16filename.c_str(), "wb");
+#else
+    dst = gzopen(tmpfile.c_str(), "wb");
+#endif
+
+	if (! dst) goto err;
+
+	while (size > 0)
+	{
+		unsigned chunk = (unsigned)llmin(size, COMPRESS_CHUNK_SIZE);
+		if (gzwrite(dst, src, chunk) <= 0)
+		{
+			LL_WARNS() << "gzwrite failed: " << gzerror(dst, NULL) << LL_ENDL;
+			goto err;
+		}
+		src += chunk;
+		size -= chunk;
+	}
+
+	if (gzclose(dst) != Z_OK)
+	{
+		dst = NULL;
+		LL_WARNS() << "gzclose failed on " << tmpfile << LL_ENDL;
+		goto err;
+	}
+	dst = NULL;
+#if LL_WINDOWS
+	// Rename in windows needs the dstfile to not exist.
+	LLFile::remove(dstfile);
+#endif
+	if (LLFile::rename(tmpfile, dstfile) == -1) goto err;		/* Flawfinder: ignore */
+	retval = TRUE;
+ err:
+	if (dst != NULL) gzclose(dst);
+	return retval;
+}
+
 #if LL_DARWIN
 // disable warnings about Gestalt calls being deprecated
 // until Apple get's on the ball and provides an alternative
@@ -40,6 +40,7 @@
 #include "llsingleton.h"
 #include <iosfwd>
 #include <string>
+#include <vector>
 
 class LL_COMMON_API LLOSInfo : public LLSingleton<LLOSInfo>
 {
@@ -149,6 +150,11 @@ LL_COMMON_API std::ostream& operator<<(std::ostream& s, const LLMemoryInfo& info
 BOOL LL_COMMON_API gunzip_file(const std::string& srcfile, const std::string& dstfile);
 // gzip srcfile into dstfile.  Returns FALSE on error.
 BOOL LL_COMMON_API gzip_file(const std::string& srcfile, const std::string& dstfile);
+// gunzip srcfile straight into memory, replacing the contents of dst.
+// Returns FALSE on error.
+BOOL LL_COMMON_API gunzip_file_to_buffer(const std::string& srcfile, std::vector<U8>& dst);
+// gzip size bytes of src into dstfile.  Returns FALSE on error.
+BOOL LL_COMMON_API gzip_buffer_to_file(const U8* src, size_t size, const std::string& dstfile);
 
 extern LL_COMMON_API LLCPUInfo gSysCPU;
 
@@ -0,0 +1,138 @@
+/**
+ * @file   llliteralmatcher_test.cpp
+ * @brief  Test for LLLiteralMatcher.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Copyright (c) 2024, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llliteralmatcher.h"
+// STL headers
+#include <string>
+#include <vector>
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llliteralmatcher_data
+    {
+        static std::string lower(std::string text)
+        {
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] >= 'A' && text[i] <= 'Z')
+                {
+                    text[i] += 'a' - 'A';
+                }
+            }
+            return text;
+        }
+
+        // what a plain search for every literal finds
+        std::vector<bool> naive(const std::vector<std::string>& literals, const std::vector<bool>& case_sensitive,
+                                const std::string& text)
+        {
+            std::string lower_text(lower(text));
+            std::vector<bool> found;
+            for (size_t i = 0; i < literals.size(); ++i)
+            {
+                if (case_sensitive[i])
+                {
+                    found.push_back(text.find(literals[i]) != std::string::npos);
+                }
+                else
+                {
+                    found.push_back(lower_text.find(lower(literals[i])) != std::string::npos);
+                }
+            }
+            return found;
+        }
+    };
+    typedef test_group<llliteralmatcher_data> llliteralmatcher_group;
+    typedef llliteralmatcher_group::object object;
+    llliteralmatcher_group llliteralmatchergrp("llliteralmatcher");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("overlapping literals and case");
+        LLLiteralMatcher matcher;
+        ensure_equals(matcher.add("he", false), 0);
+        matcher.add("she", false);
+        matcher.add("his", false);
+        matcher.add("hers", false);
+        matcher.add("BUG", true);
+        matcher.add("://", true);
+
+        std::vector<bool> found;
+        matcher.find("uSHErs", found);
+        ensure_equals("count", (S32)found.size(), 6);
+        ensure("he inside she", found[0]);
+        ensure("she", found[1]);
+        ensure("no his", !found[2]);
+        ensure("hers after she", found[3]);
+        ensure("no bug", !found[4]);
+
+        matcher.find("a bug report", found);
+        ensure("lower case bug", !found[4]);
+        matcher.find("DEBUGGING", found);
+        ensure("upper case bug", found[4]);
+        matcher.find("http:/ /x", found);
+        ensure("split separator", !found[5]);
+        matcher.find("see http://x", found);
+        ensure("separator", found[5]);
+        matcher.find("", found);
+        ensure("empty text", !found[0]);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("same answers as searching each literal");
+        std::vector<std::string> literals;
+        std::vector<bool> case_sensitive;
+        const char* words[] = { "www.", ".com", ".net", "<nolink>", "<icon", "@", "://", "/app/agent/",
+                                "/app/agentself/", "secondlife:///app/chat/", "SH", "SINV", "SLS", "a", "aa", "aaa" };
+        LLLiteralMatcher matcher;
+        for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i)
+        {
+            literals.push_back(words[i]);
+            case_sensitive.push_back(i % 2 == 0);
+            matcher.add(literals.back(), case_sensitive.back());
+        }
+
+        const char* alphabet = "aAsShHiI/:.@<>wWcomnet";
+        U32 seed = 7;
+        for (S32 round = 0; round < 2000; ++round)
+        {
+            std::string text;
+            S32 length = round % 40;
+            for (S32 i = 0; i < length; ++i)
+            {
+                seed = seed * 1664525 + 1013904223;
+                text += alphabet[(seed >> 16) % strlen(alphabet)];
+            }
+            if (round % 3 == 0)
+            {
+                text.insert(text.size() / 2, words[round % literals.size()]);
+            }
+            std::vector<bool> found;
+            matcher.find(text, found);
+            ensure("matches naive search for \"" + text + "\"", found == naive(literals, case_sensitive, text));
+        }
+
+        // literals added later are picked up
+        S32 id = matcher.add("ONE MORE", false);
+        std::vector<bool> found;
+        matcher.find("just one more", found);
+        ensure("added later", found[id]);
+    }
+}
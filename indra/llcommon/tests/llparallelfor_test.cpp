@@ -0,0 +1,135 @@
+/**
+ * @file   llparallelfor_test.cpp
+ * @brief  Test for LLParallelFor.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Copyright (c) 2024, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llparallelfor.h"
+// STL headers
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llparallelfor_data
+    {
+    };
+    typedef test_group<llparallelfor_data> llparallelfor_group;
+    typedef llparallelfor_group::object object;
+    llparallelfor_group llparallelforgrp("llparallelfor");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("every index exactly once");
+        LLParallelFor pool("test", 3);
+        std::vector<std::atomic<S32> > hits(1000);
+        for (S32 pass = 0; pass < 50; ++pass)
+        {
+            for (size_t i = 0; i < hits.size(); ++i)
+            {
+                hits[i] = 0;
+            }
+            pool.run((S32)hits.size(), [&hits](S32 i) { ++hits[i]; });
+            for (size_t i = 0; i < hits.size(); ++i)
+            {
+                ensure_equals("index visited once", hits[i].load(), 1);
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("no workers runs inline");
+        LLParallelFor pool("test", 0);
+        ensure_equals(pool.getWorkerCount(), 0);
+        std::thread::id caller = std::this_thread::get_id();
+        S32 count = 0;
+        pool.run(10, [&](S32 i)
+                 {
+                     ensure("ran on the calling thread", std::this_thread::get_id() == caller);
+                     ensure_equals("in order", i, count);
+                     ++count;
+                 });
+        ensure_equals(count, 10);
+        pool.run(0, [&](S32) { ++count; });
+        ensure_equals("empty range does nothing", count, 10);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("resizing between runs");
+        LLParallelFor pool("test", 1);
+        for (S32 workers = 0; workers < 5; ++workers)
+        {
+            pool.setWorkerCount(workers);
+            ensure_equals(pool.getWorkerCount(), workers);
+
+            std::atomic<S32> sum(0);
+            pool.run(100, [&sum](S32 i) { sum += i; });
+            ensure_equals("all indices summed", sum.load(), 4950);
+        }
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("work is shared between threads");
+        LLParallelFor pool("test", 3);
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        // each index waits for at least one other thread to have joined
+        // in, which only finishes if the workers take part
+        std::atomic<S32> started(0);
+        pool.run(4, [&](S32)
+                 {
+                     {
+                         std::lock_guard<std::mutex> lock(mutex);
+                         threads.insert(std::this_thread::get_id());
+                     }
+                     ++started;
+                     while (started.load() < 2)
+                     {
+                         std::this_thread::yield();
+                     }
+                 });
+        ensure("more than one thread took part", threads.size() > 1);
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("shared pool");
+        ensure("no shared pool until asked for", !LLParallelFor::getShared());
+        LLParallelFor::setSharedWorkerCount(2);
+        LLParallelFor* shared = LLParallelFor::getShared();
+        ensure("shared pool created", shared != NULL);
+        ensure_equals("worker count", shared->getWorkerCount(), 2);
+
+        LLParallelFor::setSharedWorkerCount(100);
+        ensure("same pool resized", LLParallelFor::getShared() == shared);
+        ensure("worker count capped", shared->getWorkerCount() < 100);
+        std::atomic<S32> sum(0);
+        shared->run(100, [&sum](S32 i) { sum += i; });
+        ensure_equals("all indices summed", sum.load(), 4950);
+
+        LLParallelFor::setSharedWorkerCount(0);
+        ensure("shared pool removed", !LLParallelFor::getShared());
+    }
+} // namespace tut
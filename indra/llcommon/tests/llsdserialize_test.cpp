@@ -61,6 +61,8 @@ using namespace boost::phoenix;
 #include "../test/namedtempfile.h"
 #include "stringize.h"
 
+#include <random>
+
 std::vector<U8> string_to_vector(const std::string& str)
 {
 	return std::vector<U8>(str.begin(), str.end());
@@ -762,6 +764,160 @@ namespace tut
     }
 
 
+	// Parses doc with LLSDSerialize::fromXMLBuffer() both with and without
+	// the buffer parser and requires identical results and counts.
+	static void ensureBufferParseMatches(const std::string& msg, const std::string& doc)
+	{
+		LLSD fast_result;
+		LLSD slow_result;
+		LLSDSerialize::setUseFastXMLParser(true);
+		S32 fast_count = LLSDSerialize::fromXMLBuffer(fast_result, doc.data(), doc.size(), false);
+		LLSDSerialize::setUseFastXMLParser(false);
+		S32 slow_count = LLSDSerialize::fromXMLBuffer(slow_result, doc.data(), doc.size(), false);
+		LLSDSerialize::setUseFastXMLParser(true);
+
+		// compare the binary serializations so that reals are compared bitwise
+		std::ostringstream fast_binary;
+		std::ostringstream slow_binary;
+		LLSDSerialize::toBinary(fast_result, fast_binary);
+		LLSDSerialize::toBinary(slow_result, slow_binary);
+		ensure_equals(msg + " (count): " + doc, fast_count, slow_count);
+		ensure(msg + ": " + doc, fast_binary.str() == slow_binary.str());
+	}
+
+	template<> template<>
+	void TestLLSDXMLParsingObject::test<6>()
+	{
+		// the buffer parser must agree with expat on everything it accepts,
+		// and hand everything else over to it
+		const char* docs[] = {
+			"<llsd/>",
+			"<llsd></llsd>",
+			"<?xml version=\"1.0\" ?><llsd><integer>3</integer></llsd>",
+			"\xEF\xBB\xBF<?xml version='1.0' encoding='UTF-8' standalone=\"yes\"?>\n"
+				"<!-- comment --><llsd><string>a&#13;b&#x10FFFF;&amp;&lt;&gt;&quot;&apos;</string></llsd>junk <<<",
+			"<llsd><map><key>a</key><integer>1</integer><key>a</key><real>2</real></map></llsd>",
+			"<llsd><map><key></key><integer>1</integer><key>b</key><integer>2</integer></map></llsd>",
+			"<llsd><map><key>a</key></map></llsd>",
+			"<llsd><map><integer>1</integer></map></llsd>",
+			"<llsd><array><key>x</key><integer>1</integer></array></llsd>",
+			"<llsd><string><![CDATA[x<y\r\nz\r]]></string></llsd>",
+			"<llsd><string>line\r\nline\rline</string></llsd>",
+			"<llsd><binary encoding=\"base64\">aGVs\nbG8=</binary></llsd>",
+			"<llsd><binary encoding=\"base16\">aGVsbG8=</binary></llsd>",
+			"<llsd><array><undef/><boolean>true</boolean><boolean/><integer/><real>-0</real><uuid/>"
+				"<date>2006-02-01T14:29:53Z</date><uri>http://example.com/</uri></array></llsd>",
+			"<llsd><bigint>1</bigint></llsd>",
+			"<llsd><integer>1</integer><integer>2</integer></llsd>",
+			"<llsd><llsd><integer>1</integer></llsd></llsd>",
+			"<llsd> text <integer>1</integer></llsd>",
+			"<llsd><string>a<!-- c -->b</string></llsd>",
+			"<llsd><string>a<!-- c -- d -->b</string></llsd>",
+			"<llsd><integer >1</integer ></llsd >",
+			"<llsd><integer a='1'>1</integer></llsd>",
+			"<llsd><integer>1</integer></llsdx>",
+			"<llsd><string>\x01</string></llsd>",
+			"<llsd><string>\xEF\xBF\xBE</string></llsd>",
+			"<llsd><string>\xC0\x80</string></llsd>",
+			"<llsd><string>&#0;</string></llsd>",
+			"<llsd><string>&#xD800;</string></llsd>",
+			"<llsd><string>&bogus;</string></llsd>",
+			"<llsd><string>]]></string></llsd>",
+			" <?xml version=\"1.0\"?><llsd/>",
+			"<?xml version=\"1.0\"?><!DOCTYPE llsd><llsd/>",
+			"<?xml version=\"1.0\"?><?pi data?><llsd/>",
+			"<llsd><string>truncated",
+			""
+		};
+		for (size_t i = 0; i < LL_ARRAY_SIZE(docs); ++i)
+		{
+			ensureBufferParseMatches("edge case", docs[i]);
+		}
+	}
+
+	static LLSD random_llsd(std::minstd_rand& gen, S32 depth)
+	{
+		static const char* const pieces[] = {
+			"a", "Z", "0", " ", "\t", "\n", "\r\n", "&", "<", ">", "\"", "'", "]]>",
+			"\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80"
+		};
+		std::string str;
+		for (U32 i = gen() % 6; i > 0; --i)
+		{
+			str += pieces[gen() % LL_ARRAY_SIZE(pieces)];
+		}
+
+		switch (gen() % (depth < 4 ? 11 : 8))
+		{
+			case 0:		return LLSD();
+			case 1:		return LLSD(gen() % 2 == 0);
+			case 2:		return LLSD(S32(gen()) - S32(gen()));
+			case 3:		return LLSD(F64(gen()) / F64(gen() % 1000 + 1) - 1e6);
+			case 4:		return LLSD(str);
+			case 5:		return LLSD(LLUUID::generateNewID());
+			case 6:		return LLSD(std::vector<U8>(str.begin(), str.end()));
+			case 7:		return LLSD(LLURI(str));
+			case 8:
+			case 9:
+			{
+				LLSD map = LLSD::emptyMap();
+				for (U32 i = gen() % 5; i > 0; --i)
+				{
+					map[str + stringize(i)] = random_llsd(gen, depth + 1);
+				}
+				return map;
+			}
+			default:
+			{
+				LLSD array = LLSD::emptyArray();
+				for (U32 i = gen() % 5; i > 0; --i)
+				{
+					array.append(random_llsd(gen, depth + 1));
+				}
+				return array;
+			}
+		}
+	}
+
+	template<> template<>
+	void TestLLSDXMLParsingObject::test<7>()
+	{
+		// serialized random trees, plus corrupted and truncated copies of
+		// them, must parse identically with and without the buffer parser
+		std::minstd_rand gen(20090904);
+		for (S32 i = 0; i < 500; ++i)
+		{
+			LLSD sd = random_llsd(gen, 0);
+			std::ostringstream out;
+			if (i % 2)
+			{
+				LLSDSerialize::toPrettyXML(sd, out);
+			}
+			else
+			{
+				out << "<?xml version=\"1.0\" ?>\n";
+				LLSDSerialize::toXML(sd, out);
+			}
+			std::string doc(out.str());
+			ensureBufferParseMatches("random", doc);
+
+			for (S32 j = 0; j < 4; ++j)
+			{
+				static const char mutations[] = "<>/&;\"'= \r\n!?-]x\x80";
+				std::string mutated(doc);
+				size_t pos = gen() % mutated.size();
+				switch (gen() % 3)
+				{
+					case 0:		mutated[pos] = mutations[gen() % (sizeof(mutations) - 1)]; break;
+					case 1:		mutated.resize(pos); break;
+					default:	mutated.insert(pos, 1, mutations[gen() % (sizeof(mutations) - 1)]); break;
+				}
+				ensureBufferParseMatches("mutated", mutated);
+			}
+		}
+	}
+
+
 	/*
 	TODO:
 		test XML parsing
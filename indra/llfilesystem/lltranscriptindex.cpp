@@ -0,0 +1,651 @@
+/**
+ * @file lltranscriptindex.cpp
+ * @brief Message, time and word index kept next to a plain text chat transcript.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltranscriptindex.h"
+
+#include <algorithm>
+#include <map>
+#include "llfile.h"
+#include "llmutex.h"
+
+static const char INDEX_MAGIC[8] = "LLTRIDX";
+static const char WORDS_MAGIC[8] = "LLTRWRD";
+static const U32 HASHED_LENGTH = 64;	// at each end of the indexed bytes
+static const size_t READ_CHUNK_SIZE = 256 * 1024;
+static const size_t MIN_WORD_LENGTH = 2;
+static const size_t READ_BATCH_SIZE = 256;	// messages
+
+static U32 hash_bytes(const char* data, size_t length)
+{
+	// FNV-1a
+	U32 hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (U8)data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static bool is_word_char(char c)
+{
+	// bytes of multibyte UTF-8 characters count as letters
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (U8)c >= 0x80;
+}
+
+// Lower cased words of text, shorter ones are left out.
+static void split_words(const char* text, size_t length, std::vector<std::string>& words)
+{
+	size_t i = 0;
+	while (i < length)
+	{
+		while (i < length && !is_word_char(text[i]))
+		{
+			++i;
+		}
+		size_t start = i;
+		while (i < length && is_word_char(text[i]))
+		{
+			++i;
+		}
+		if (i - start >= MIN_WORD_LENGTH)
+		{
+			std::string word(text + start, i - start);
+			for (std::string::iterator it = word.begin(); it != word.end(); ++it)
+			{
+				if (*it >= 'A' && *it <= 'Z')
+				{
+					*it += 'a' - 'A';
+				}
+			}
+			words.push_back(word);
+		}
+	}
+}
+
+static bool has_bom(const char* text, size_t length)
+{
+	return length >= 3 && text[0] == (char)0xEF && text[1] == (char)0xBB && text[2] == (char)0xBF;
+}
+
+static LLFILE* open_for_update(const std::string& filename)
+{
+	LLFILE* file = LLFile::fopen(filename, "r+b");
+	if (!file)
+	{
+		file = LLFile::fopen(filename, "w+b");
+	}
+	return file;
+}
+
+static U32 hash_range(LLFILE* file, U64 offset, U32 length)
+{
+	char bytes[HASHED_LENGTH];
+	length = llmin(length, (U32)sizeof(bytes));
+	if (fseek(file, (long)offset, SEEK_SET) || fread(bytes, 1, length, file) != length)
+	{
+		return 0;
+	}
+	return hash_bytes(bytes, length);
+}
+
+// One update of a transcript at a time, and no loading of it in the middle
+// of one: the chat log saves on the main thread while the transcript search
+// loads indices on its own.  Every transcript has a lock of its own, so a
+// save never waits for another transcript being indexed.
+class LLTranscriptLock
+{
+public:
+	LLTranscriptLock(const std::string& transcript);
+	~LLTranscriptLock();
+
+private:
+	struct PathMutex
+	{
+		LLMutex	mMutex;
+		S32		mUsers;
+	};
+	typedef std::map<std::string, PathMutex*> path_map_t;
+
+	// guards the map, never held while a transcript is locked
+	static LLMutex& getPathsMutex();
+	static path_map_t& getPaths();
+
+	path_map_t::iterator mPath;
+};
+
+// static
+LLMutex& LLTranscriptLock::getPathsMutex()
+{
+	static LLMutex sMutex;
+	return sMutex;
+}
+
+// static
+LLTranscriptLock::path_map_t& LLTranscriptLock::getPaths()
+{
+	static path_map_t sPaths;
+	return sPaths;
+}
+
+LLTranscriptLock::LLTranscriptLock(const std::string& transcript)
+{
+	{
+		LLMutexLock lock(&getPathsMutex());
+		mPath = getPaths().insert(std::make_pair(transcript, (PathMutex*)NULL)).first;
+		if (!mPath->second)
+		{
+			mPath->second = new PathMutex;
+			mPath->second->mUsers = 0;
+		}
+		++mPath->second->mUsers;
+	}
+	mPath->second->mMutex.lock();
+}
+
+LLTranscriptLock::~LLTranscriptLock()
+{
+	mPath->second->mMutex.unlock();
+	LLMutexLock lock(&getPathsMutex());
+	if (!--mPath->second->mUsers)
+	{
+		delete mPath->second;
+		getPaths().erase(mPath);
+	}
+}
+
+LLTranscriptIndex::LLTranscriptIndex(const std::string& transcript, bool index_words)
+:	mTranscript(transcript),
+	mIndexWords(index_words),
+	mLoaded(false)
+{
+}
+
+// static
+std::string LLTranscriptIndex::getIndexFilename(const std::string& transcript)
+{
+	return transcript + ".idx";
+}
+
+// static
+std::string LLTranscriptIndex::getWordsFilename(const std::string& transcript)
+{
+	return transcript + ".words";
+}
+
+// static
+void LLTranscriptIndex::removeIndex(const std::string& transcript)
+{
+	LLFile::remove(getIndexFilename(transcript), ENOENT);
+	LLFile::remove(getWordsFilename(transcript), ENOENT);
+}
+
+// static
+U32 LLTranscriptIndex::parseTime(const char* line, size_t length)
+{
+	// [YYYY/M/D H:MM] or [YYYY/M/D H:MM:SS]
+	S32 fields[6] = { 0, 0, 0, 0, 0, 0 };
+	static const char separators[6] = { '/', '/', ' ', ':', ':', ']' };
+	size_t i = 1;
+	if (length < 2 || line[0] != '[')
+	{
+		return 0;
+	}
+	for (S32 field = 0; field < 6; ++field)
+	{
+		size_t start = i;
+		while (i < length && line[i] >= '0' && line[i] <= '9' && i - start < 4)
+		{
+			fields[field] = fields[field] * 10 + (line[i] - '0');
+			++i;
+		}
+		if (i == start || i >= length)
+		{
+			return 0;
+		}
+		if (line[i] == ']' && field >= 4)
+		{
+			break;
+		}
+		if (line[i] != separators[field])
+		{
+			return 0;
+		}
+		++i;
+		// the date and the time may be parted by several spaces
+		while (field == 2 && i < length && line[i] == ' ')
+		{
+			++i;
+		}
+	}
+
+	S32 year = fields[0], month = fields[1], day = fields[2];
+	if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 || fields[3] > 23 || fields[4] > 59 || fields[5] > 60)
+	{
+		return 0;
+	}
+
+	// days since 1970/1/1 of the civil date
+	year -= month <= 2;
+	S32 era = year / 400;
+	S32 year_of_era = year - era * 400;
+	S32 day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	S32 day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+	S32 days = era * 146097 + day_of_era - 719468;
+
+	return (U32)days * 86400 + fields[3] * 3600 + fields[4] * 60 + fields[5];
+}
+
+void LLTranscriptIndex::addWords(const char* text, size_t length, U32 message, std::vector<Posting>& postings) const
+{
+	std::vector<std::string> words;
+	split_words(text, length, words);
+	std::vector<U32> hashes;
+	hashes.reserve(words.size());
+	for (std::vector<std::string>::const_iterator it = words.begin(); it != words.end(); ++it)
+	{
+		hashes.push_back(hash_bytes(it->data(), it->size()));
+	}
+	std::sort(hashes.begin(), hashes.end());
+	hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+	for (std::vector<U32>::const_iterator it = hashes.begin(); it != hashes.end(); ++it)
+	{
+		Posting posting;
+		posting.mWord = *it;
+		posting.mMessage = message;
+		postings.push_back(posting);
+	}
+}
+
+bool LLTranscriptIndex::update()
+{
+	LLTranscriptLock lock(mTranscript);
+	LLFILE* text = LLFile::fopen(mTranscript, "rb");
+	if (!text)
+	{
+		return false;
+	}
+	fseek(text, 0, SEEK_END);
+	U64 text_size = ftell(text);
+
+	LLFILE* index = open_for_update(getIndexFilename(mTranscript));
+	LLFILE* words = mIndexWords ? open_for_update(getWordsFilename(mTranscript)) : NULL;
+	if (!index || (mIndexWords && !words))
+	{
+		if (index) fclose(index);
+		if (words) fclose(words);
+		fclose(text);
+		return false;
+	}
+
+	IndexHeader header;
+	WordsHeader words_header;
+	bool current = fread(&header, sizeof(header), 1, index) == 1
+		&& !memcmp(header.mMagic, INDEX_MAGIC, sizeof(header.mMagic))
+		&& header.mVersion == FORMAT_VERSION
+		&& header.mIndexedSize <= text_size
+		&& header.mPrefixLength <= header.mIndexedSize
+		&& header.mTailLength <= header.mIndexedSize
+		&& header.mPrefixHash == hash_range(text, 0, header.mPrefixLength)
+		&& header.mTailHash == hash_range(text, header.mIndexedSize - header.mTailLength, header.mTailLength);
+	if (current && words)
+	{
+		current = fread(&words_header, sizeof(words_header), 1, words) == 1
+			&& !memcmp(words_header.mMagic, WORDS_MAGIC, sizeof(words_header.mMagic))
+			&& words_header.mVersion == FORMAT_VERSION
+			&& words_header.mIndexedSize == header.mIndexedSize;
+	}
+	if (!current)
+	{
+		// start over
+		memset(&header, 0, sizeof(header));
+		memcpy(header.mMagic, INDEX_MAGIC, sizeof(header.mMagic));
+		header.mVersion = FORMAT_VERSION;
+		header.mPrefixHash = hash_bytes(NULL, 0);
+		header.mTailHash = hash_bytes(NULL, 0);
+		memset(&words_header, 0, sizeof(words_header));
+		memcpy(words_header.mMagic, WORDS_MAGIC, sizeof(words_header.mMagic));
+		words_header.mVersion = FORMAT_VERSION;
+	}
+
+	bool ok = true;
+	if (header.mIndexedSize < text_size)
+	{
+		// a continuation line extends the last message already on disk
+		Entry last;
+		bool have_last = header.mCount > 0
+			&& !fseek(index, (long)(sizeof(IndexHeader) + (header.mCount - 1) * sizeof(Entry)), SEEK_SET)
+			&& fread(&last, sizeof(last), 1, index) == 1;
+		U32 first_write = header.mCount;
+		U32 prev_time = have_last ? last.mTime : 0;
+		std::vector<Entry> entries;
+		std::vector<Posting> postings;
+
+		U64 offset = header.mIndexedSize;
+		std::vector<char> buffer;
+		fseek(text, (long)offset, SEEK_SET);
+		while (offset < text_size)
+		{
+			size_t kept = buffer.size();
+			size_t chunk = (size_t)llmin((U64)READ_CHUNK_SIZE, text_size - offset - kept);
+			if (!chunk)
+			{
+				break;
+			}
+			buffer.resize(kept + chunk);
+			if (fread(&buffer[kept], 1, chunk, text) != chunk)
+			{
+				ok = false;
+				break;
+			}
+
+			// only complete lines are indexed, the rest waits for its end
+			size_t pos = 0;
+			const char* data = &buffer[0];
+			const char* newline;
+			while ((newline = (const char*)memchr(data + pos, '\n', buffer.size() - pos)) != NULL)
+			{
+				size_t next = newline - data + 1;
+				const char* line = data + pos;
+				size_t length = newline - line;
+				if (length && line[length - 1] == '\r')
+				{
+					--length;
+				}
+				if (!offset && !pos && has_bom(line, length))
+				{
+					line += 3;
+					length -= 3;
+				}
+
+				U64 line_offset = offset + pos;
+				bool continues = (!length || line[0] == ' ') && (have_last || !entries.empty());
+				if (continues)
+				{
+					if (entries.empty())
+					{
+						entries.push_back(last);
+						--first_write;
+					}
+					entries.back().mLength = (U32)(line_offset + (next - pos) - entries.back().mOffset);
+				}
+				else
+				{
+					Entry entry;
+					entry.mOffset = line_offset;
+					entry.mLength = (U32)(next - pos);
+					entry.mTime = parseTime(line, length);
+					if (!entry.mTime)
+					{
+						entry.mTime = prev_time;
+					}
+					prev_time = entry.mTime;
+					entries.push_back(entry);
+				}
+				if (words)
+				{
+					addWords(line, length, first_write + entries.size() - 1, postings);
+				}
+				pos = next;
+			}
+			offset += pos;
+			buffer.erase(buffer.begin(), buffer.begin() + pos);
+		}
+
+		// records first, headers last, so a half written update reads as stale
+		if (!entries.empty())
+		{
+			ok = ok && !fseek(index, (long)(sizeof(IndexHeader) + first_write * sizeof(Entry)), SEEK_SET)
+				&& fwrite(&entries[0], sizeof(Entry), entries.size(), index) == entries.size();
+			header.mCount = first_write + entries.size();
+		}
+		if (words && !postings.empty())
+		{
+			ok = ok && !fseek(words, (long)(sizeof(WordsHeader) + (U64)words_header.mCount * sizeof(Posting)), SEEK_SET)
+				&& fwrite(&postings[0], sizeof(Posting), postings.size(), words) == postings.size();
+			words_header.mCount += postings.size();
+		}
+		header.mIndexedSize = offset;
+		header.mPrefixLength = (U32)llmin((U64)HASHED_LENGTH, offset);
+		header.mPrefixHash = hash_range(text, 0, header.mPrefixLength);
+		header.mTailLength = (U32)llmin((U64)HASHED_LENGTH, offset);
+		header.mTailHash = hash_range(text, offset - header.mTailLength, header.mTailLength);
+		words_header.mIndexedSize = offset;
+	}
+
+	if (ok && words)
+	{
+		ok = !fseek(words, 0, SEEK_SET) && fwrite(&words_header, sizeof(words_header), 1, words) == 1;
+	}
+	if (ok)
+	{
+		ok = !fseek(index, 0, SEEK_SET) && fwrite(&header, sizeof(header), 1, index) == 1;
+	}
+
+	if (words)
+	{
+		fclose(words);
+	}
+	fclose(index);
+	fclose(text);
+	return ok;
+}
+
+bool LLTranscriptIndex::load()
+{
+	// the files can't change between the update and reading them back
+	LLTranscriptLock lock(mTranscript);
+	mLoaded = false;
+	mEntries.clear();
+	mPostings.clear();
+	if (!update())
+	{
+		return false;
+	}
+
+	LLFILE* index = LLFile::fopen(getIndexFilename(mTranscript), "rb");
+	if (!index)
+	{
+		return false;
+	}
+	IndexHeader header;
+	bool ok = fread(&header, sizeof(header), 1, index) == 1;
+	if (ok && header.mCount)
+	{
+		mEntries.resize(header.mCount);
+		ok = fread(&mEntries[0], sizeof(Entry), header.mCount, index) == header.mCount;
+	}
+	fclose(index);
+
+	LLFILE* words = mIndexWords ? LLFile::fopen(getWordsFilename(mTranscript), "rb") : NULL;
+	if (ok && words)
+	{
+		WordsHeader words_header;
+		ok = fread(&words_header, sizeof(words_header), 1, words) == 1;
+		std::vector<Posting> postings;
+		U32 remaining = ok ? words_header.mCount : 0;
+		while (ok && remaining)
+		{
+			postings.resize(llmin(remaining, (U32)(READ_CHUNK_SIZE / sizeof(Posting))));
+			ok = fread(&postings[0], sizeof(Posting), postings.size(), words) == postings.size();
+			for (std::vector<Posting>::const_iterator it = postings.begin(); ok && it != postings.end(); ++it)
+			{
+				// continuation lines can name the same message again
+				std::vector<U32>& messages = mPostings[it->mWord];
+				if (messages.empty() || messages.back() != it->mMessage)
+				{
+					messages.push_back(it->mMessage);
+				}
+			}
+			remaining -= postings.size();
+		}
+	}
+	if (words)
+	{
+		fclose(words);
+	}
+
+	if (!ok)
+	{
+		mEntries.clear();
+		mPostings.clear();
+		return false;
+	}
+	mLoaded = true;
+	return true;
+}
+
+struct EntryTimeLess
+{
+	bool operator()(const LLTranscriptIndex::Entry& entry, U32 time) const
+	{
+		return entry.mTime < time;
+	}
+};
+
+S32 LLTranscriptIndex::findTime(U32 time) const
+{
+	return std::lower_bound(mEntries.begin(), mEntries.end(), time, EntryTimeLess()) - mEntries.begin();
+}
+
+bool LLTranscriptIndex::readMessages(S32 first, S32 count, std::vector<std::string>& messages) const
+{
+	messages.clear();
+	first = llmax(first, 0);
+	count = llmin(count, getCount() - first);
+	if (count <= 0)
+	{
+		return true;
+	}
+
+	// the messages are one run of the transcript
+	U64 start = mEntries[first].mOffset;
+	const Entry& last = mEntries[first + count - 1];
+	size_t size = (size_t)(last.mOffset + last.mLength - start);
+	std::vector<char> buffer(size);
+	LLFILE* text = LLFile::fopen(mTranscript, "rb");
+	if (!text)
+	{
+		return false;
+	}
+	bool ok = !fseek(text, (long)start, SEEK_SET) && fread(&buffer[0], 1, size, text) == size;
+	fclose(text);
+	if (!ok)
+	{
+		return false;
+	}
+
+	messages.reserve(count);
+	for (S32 i = first; i < first + count; ++i)
+	{
+		const char* message = &buffer[0] + (mEntries[i].mOffset - start);
+		size_t length = mEntries[i].mLength;
+		while (length && (message[length - 1] == '\n' || message[length - 1] == '\r'))
+		{
+			--length;
+		}
+		if (!mEntries[i].mOffset && has_bom(message, length))
+		{
+			message += 3;
+			length -= 3;
+		}
+		messages.push_back(std::string(message, length));
+	}
+	return true;
+}
+
+void LLTranscriptIndex::search(const std::string& query, std::vector<S32>& messages) const
+{
+	messages.clear();
+	std::vector<std::string> query_words;
+	split_words(query.data(), query.size(), query_words);
+	std::sort(query_words.begin(), query_words.end());
+	query_words.erase(std::unique(query_words.begin(), query_words.end()), query_words.end());
+	if (query_words.empty() || mEntries.empty())
+	{
+		return;
+	}
+
+	std::vector<S32> candidates;
+	if (mIndexWords && mLoaded)
+	{
+		for (std::vector<std::string>::const_iterator it = query_words.begin(); it != query_words.end(); ++it)
+		{
+			postings_map_t::const_iterator found = mPostings.find(hash_bytes(it->data(), it->size()));
+			if (found == mPostings.end())
+			{
+				return;
+			}
+			if (it == query_words.begin())
+			{
+				candidates.assign(found->second.begin(), found->second.end());
+			}
+			else
+			{
+				std::vector<S32> both;
+				std::set_intersection(candidates.begin(), candidates.end(), found->second.begin(), found->second.end(), std::back_inserter(both));
+				candidates.swap(both);
+			}
+		}
+	}
+	else
+	{
+		for (S32 i = 0; i < getCount(); ++i)
+		{
+			candidates.push_back(i);
+		}
+	}
+
+	// hashes can collide, only the text tells.  Neighbouring candidates
+	// are read in one go.
+	std::vector<std::string> text;
+	std::vector<std::string> message_words;
+	size_t i = 0;
+	while (i < candidates.size())
+	{
+		size_t run = 1;
+		while (i + run < candidates.size() && run < READ_BATCH_SIZE && candidates[i + run] == candidates[i] + (S32)run)
+		{
+			++run;
+		}
+		if (readMessages(candidates[i], run, text))
+		{
+			for (size_t j = 0; j < text.size(); ++j)
+			{
+				message_words.clear();
+				split_words(text[j].data(), text[j].size(), message_words);
+				std::sort(message_words.begin(), message_words.end());
+				if (std::includes(message_words.begin(), message_words.end(), query_words.begin(), query_words.end()))
+				{
+					messages.push_back(candidates[i + j]);
+				}
+			}
+		}
+		i += run;
+	}
+}
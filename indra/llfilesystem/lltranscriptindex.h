@@ -0,0 +1,140 @@
+/**
+ * @file lltranscriptindex.h
+ * @brief Message, time and word index kept next to a plain text chat transcript.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRANSCRIPTINDEX_H
+#define LL_LLTRANSCRIPTINDEX_H
+
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+// The transcript stays the plain text file it always was; this indexes it
+// from two files next to it, both only ever appended to:
+//
+//	<transcript>.idx	where every message starts, how long it is and the
+//						time written in front of it
+//	<transcript>.words	(word hash, message) pairs, only if words are indexed
+//
+// A message is a line plus the lines that continue it, the ones starting
+// with a space or empty ones, the same way the chat log loader reads them.
+//
+// update() indexes whatever was appended to the transcript since it last
+// ran, so calling it after every saved line only reads that line.  The
+// index remembers how much of the transcript it covers and hashes of the
+// first bytes and of the last bytes it covers.  A transcript that shrank,
+// was replaced or had lines inserted, removed or resized before its end is
+// indexed again from the start.  Checking the ends is all update() can do
+// without reading the whole file: a same length edit in the middle that
+// leaves both ends alone goes unnoticed until removeIndex() is called.
+// search() still confirms every hit against the text.
+class LLTranscriptIndex
+{
+public:
+	struct Entry
+	{
+		U64		mOffset;
+		U32		mLength;	// bytes, line endings included
+		U32		mTime;		// written time as seconds since 1970, 0 if none yet
+	};
+
+	LLTranscriptIndex(const std::string& transcript, bool index_words = true);
+
+	// Catches the index files up with the transcript.  Only what was
+	// appended is read, unless the index has to start over.  False if the
+	// transcript or the index files can't be read.  Safe to call
+	// from any thread, updates of the same transcript are done one at a
+	// time and updates of different ones don't wait for each other.
+	bool update();
+
+	// update() and then read the index into memory for the calls below.
+	bool load();
+	bool isLoaded() const				{ return mLoaded; }
+
+	S32 getCount() const				{ return mEntries.size(); }
+	const Entry& getEntry(S32 index) const	{ return mEntries[index]; }
+	// First message written at or after time, getCount() if none.
+	S32 findTime(U32 time) const;
+
+	// Raw text of messages [first, first + count), continuation lines
+	// included, without the final line ending.
+	bool readMessages(S32 first, S32 count, std::vector<std::string>& messages) const;
+
+	// Messages containing every word of query, case insensitive, oldest
+	// first.  Candidates come from the word index when there is one and
+	// are always confirmed against the transcript.
+	void search(const std::string& query, std::vector<S32>& messages) const;
+
+	// "[2009/11/20 3:00]" style timestamp at the start of line as seconds
+	// since 1970, read as if it were UTC; 0 if the line has no full date.
+	static U32 parseTime(const char* line, size_t length);
+
+	static std::string getIndexFilename(const std::string& transcript);
+	static std::string getWordsFilename(const std::string& transcript);
+	static void removeIndex(const std::string& transcript);
+
+	// File layout
+	struct IndexHeader
+	{
+		char	mMagic[8];
+		U32		mVersion;
+		U32		mCount;
+		U64		mIndexedSize;	// bytes of the transcript covered
+		U32		mPrefixHash;	// of the first mPrefixLength bytes
+		U32		mPrefixLength;
+		U32		mTailHash;		// of the mTailLength bytes before mIndexedSize
+		U32		mTailLength;
+	};
+
+	struct WordsHeader
+	{
+		char	mMagic[8];
+		U32		mVersion;
+		U32		mCount;
+		U64		mIndexedSize;	// same as the index when both are current
+	};
+
+	struct Posting
+	{
+		U32		mWord;
+		U32		mMessage;
+	};
+
+	// Bump when the layout above changes.
+	static const U32 FORMAT_VERSION = 2;
+
+private:
+	void addWords(const char* text, size_t length, U32 message, std::vector<Posting>& postings) const;
+
+	std::string		mTranscript;
+	bool			mIndexWords;
+	bool			mLoaded;
+
+	std::vector<Entry>	mEntries;
+	typedef boost::unordered_map<U32, std::vector<U32> > postings_map_t;
+	postings_map_t		mPostings;
+};
+
+#endif // LL_LLTRANSCRIPTINDEX_H
@@ -0,0 +1,138 @@
+/**
+ * @file lltranscriptsearchthread.cpp
+ * @brief Searches chat transcripts through their indices on a worker thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltranscriptsearchthread.h"
+
+#include "llfile.h"
+#include "lltranscriptindex.h"
+
+// Loaded word indices are kept for the most recently searched transcripts
+// only, each one costs memory in proportion to its transcript.
+static const size_t MAX_LOADED_TRANSCRIPTS = 16;
+
+LLTranscriptSearchThread::LLTranscriptSearchThread()
+:	LLThread("transcript search")
+{
+}
+
+LLTranscriptSearchThread::~LLTranscriptSearchThread()
+{
+	mRequests.close();
+	mResults.close();
+	shutdown();
+	for (loaded_list_t::iterator it = mLoaded.begin(); it != mLoaded.end(); ++it)
+	{
+		delete it->mIndex;
+	}
+	mLoaded.clear();
+}
+
+// virtual
+void LLTranscriptSearchThread::run()
+{
+	try
+	{
+		while (!isQuitting())
+		{
+			Request request = mRequests.popBack();
+			// the user kept typing, only the newest text matters
+			while (mRequests.tryPopBack(request))
+			{
+			}
+
+			Result result;
+			result.mID = request.mID;
+			bool superseded = false;
+			for (size_t i = 0; i < request.mPaths.size() && !superseded; ++i)
+			{
+				if (isTextInTranscript(request.mPaths[i], request.mText))
+				{
+					result.mFileNames.insert(request.mFileNames[i]);
+				}
+				superseded = isQuitting() || mRequests.size();
+			}
+			if (!superseded)
+			{
+				// waits out the UI thread polling, rather than losing the result
+				mResults.pushFront(result);
+			}
+		}
+	}
+	catch (const LLThreadSafeQueueInterrupt&)
+	{
+		// closed on shutdown
+	}
+}
+
+bool LLTranscriptSearchThread::isTextInTranscript(const std::string& path, const std::string& text)
+{
+	llstat stat_data;
+	if (path.empty() || LLFile::stat(path, &stat_data))
+	{
+		return false;
+	}
+
+	loaded_list_t::iterator it = mLoaded.begin();
+	while (it != mLoaded.end() && it->mPath != path)
+	{
+		++it;
+	}
+	if (it != mLoaded.end())
+	{
+		mLoaded.splice(mLoaded.begin(), mLoaded, it);
+	}
+	else
+	{
+		if (mLoaded.size() >= MAX_LOADED_TRANSCRIPTS)
+		{
+			delete mLoaded.back().mIndex;
+			mLoaded.pop_back();
+		}
+		LoadedIndex loaded;
+		loaded.mPath = path;
+		loaded.mSize = -1;
+		loaded.mIndex = new LLTranscriptIndex(path);
+		mLoaded.push_front(loaded);
+	}
+
+	// loaded again only when something was written to the transcript
+	LoadedIndex& loaded = mLoaded.front();
+	if (loaded.mSize != (S64)stat_data.st_size)
+	{
+		loaded.mSize = stat_data.st_size;
+		if (!loaded.mIndex->load())
+		{
+			loaded.mSize = -1;
+			return false;
+		}
+	}
+
+	std::vector<S32> messages;
+	loaded.mIndex->search(text, messages);
+	return !messages.empty();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file lltranscriptsearchthread.h
+ * @brief Searches chat transcripts through their indices on a worker thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRANSCRIPTSEARCHTHREAD_H
+#define LL_LLTRANSCRIPTSEARCHTHREAD_H
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "llthread.h"
+#include "llthreadsafequeue.h"
+
+class LLTranscriptIndex;
+
+// Searches transcripts for the conversation log filter, so the UI never
+// waits on indexing or loading a large transcript.  The indices are only
+// ever touched by this thread; the chat log may still save to the same
+// transcripts meanwhile, LLTranscriptIndex keeps the two apart.
+//
+// Only the newest request is run.  One still waiting, or still running,
+// when a newer one is posted is dropped without a result.  The indices of
+// the most recently searched transcripts stay loaded and are only loaded
+// again once their transcript changed size.
+class LLTranscriptSearchThread : public LLThread
+{
+public:
+	struct Request
+	{
+		U32							mID;
+		std::string					mText;
+		std::vector<std::string>	mFileNames;	// handed back in the result
+		std::vector<std::string>	mPaths;		// of the same transcripts
+	};
+
+	struct Result
+	{
+		U32							mID;
+		std::set<std::string>		mFileNames;	// transcripts with a message containing every word
+	};
+
+	LLTranscriptSearchThread();
+	~LLTranscriptSearchThread();
+
+	// tryPushFront() gives up when the other thread holds the queue, which
+	// would lose the request; the queue is drained long before it fills.
+	void post(const Request& request)	{ mRequests.pushFront(request); }
+	bool getResult(Result& result)		{ return mResults.tryPopBack(result); }
+
+protected:
+	virtual void run();
+
+private:
+	struct LoadedIndex
+	{
+		std::string			mPath;
+		S64					mSize;	// of the transcript when loaded
+		LLTranscriptIndex*	mIndex;
+	};
+	typedef std::list<LoadedIndex> loaded_list_t;
+
+	bool isTextInTranscript(const std::string& path, const std::string& text);
+
+	LLThreadSafeQueue<Request>	mRequests;
+	LLThreadSafeQueue<Result>	mResults;
+	loaded_list_t				mLoaded;	// most recently used first
+};
+
+#endif // LL_LLTRANSCRIPTSEARCHTHREAD_H
@@ -0,0 +1,232 @@
+/**
+ * @file lltranscriptindex_test.cpp
+ * @brief Tests for the chat transcript index.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltranscriptindex.h"
+#include "llfile.h"
+#include "lluuid.h"
+#include "stringize.h"
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct transcriptindex_data
+	{
+		std::string mFilename;
+
+		transcriptindex_data()
+		{
+			LLUUID random;
+			random.generate();
+			mFilename = STRINGIZE(LLFile::tmpdir() << "lltranscriptindex-test-" << random << ".txt");
+		}
+
+		~transcriptindex_data()
+		{
+			LLTranscriptIndex::removeIndex(mFilename);
+			LLFile::remove(mFilename, ENOENT);
+		}
+
+		void append(const std::string& text, const char* mode = "ab")
+		{
+			LLFILE* file = LLFile::fopen(mFilename, mode);
+			fwrite(text.data(), 1, text.size(), file);
+			fclose(file);
+		}
+
+		std::string message(const LLTranscriptIndex& index, S32 i)
+		{
+			std::vector<std::string> messages;
+			ensure("read", index.readMessages(i, 1, messages));
+			ensure_equals("one message", (S32)messages.size(), 1);
+			return messages[0];
+		}
+	};
+	typedef test_group<transcriptindex_data> transcriptindex_test;
+	typedef transcriptindex_test::object transcriptindex_object;
+	tut::transcriptindex_test transcriptindex("LLTranscriptIndex");
+
+	// messages are split the way the chat log loader reads them
+	template<> template<>
+	void transcriptindex_object::test<1>()
+	{
+		append("\xEF\xBB\xBF[2009/11/20 3:00]  Igor ProductEngine: howdy\n"
+			   "[2009/11/20 3:05:10]  Second Life: two\n lines\n"
+			   "\n"
+			   "[3:06]  Igor ProductEngine: no date\r\n"
+			   "unfinished");
+
+		LLTranscriptIndex index(mFilename);
+		ensure("load", index.load());
+		ensure_equals("count", index.getCount(), 3);
+		ensure_equals("bom", message(index, 0), std::string("[2009/11/20 3:00]  Igor ProductEngine: howdy"));
+		ensure_equals("continued", message(index, 1), std::string("[2009/11/20 3:05:10]  Second Life: two\n lines"));
+		ensure_equals("crlf", message(index, 2), std::string("[3:06]  Igor ProductEngine: no date"));
+
+		ensure_equals("time", index.getEntry(0).mTime, LLTranscriptIndex::parseTime("[2009/11/20 3:00]", 17));
+		ensure("seconds", index.getEntry(1).mTime == index.getEntry(0).mTime + 5 * 60 + 10);
+		ensure_equals("time without date", index.getEntry(2).mTime, index.getEntry(1).mTime);
+		ensure_equals("find time", index.findTime(index.getEntry(0).mTime + 1), 1);
+		ensure_equals("find late", index.findTime(index.getEntry(2).mTime + 1), 3);
+		ensure_equals("no date", LLTranscriptIndex::parseTime("[3:06]", 6), 0U);
+		ensure_equals("epoch", LLTranscriptIndex::parseTime("[1970/1/1 0:00]", 15), 0U);
+		ensure_equals("leap day", LLTranscriptIndex::parseTime("[2024/3/1 0:00]", 15) - LLTranscriptIndex::parseTime("[2024/2/28 0:00]", 16), 2U * 86400);
+
+		// the unfinished line is indexed once it ends, the rest is read from where the index stopped
+		append(" line\n continues\n[2009/11/21 1:00]  Igor ProductEngine: next\n");
+		ensure("reload", index.load());
+		ensure_equals("appended count", index.getCount(), 5);
+		ensure_equals("finished line", message(index, 3), std::string("unfinished line\n continues"));
+		ensure_equals("next", message(index, 4), std::string("[2009/11/21 1:00]  Igor ProductEngine: next"));
+
+		std::vector<std::string> messages;
+		ensure("read run", index.readMessages(3, 10, messages));
+		ensure_equals("clamped", (S32)messages.size(), 2);
+	}
+
+	// words are found through the index and confirmed against the text
+	template<> template<>
+	void transcriptindex_object::test<2>()
+	{
+		static const S32 MESSAGE_COUNT = 2000;
+		for (S32 i = 0; i < MESSAGE_COUNT; ++i)
+		{
+			append(STRINGIZE("[2020/1/1 0:00]  Speaker" << (i % 7) << ": message number" << i << ((i % 100) ? "" : " Banana split") << "\n"));
+		}
+		append(" banana\n");
+
+		LLTranscriptIndex index(mFilename);
+		ensure("load", index.load());
+		ensure_equals("count", index.getCount(), MESSAGE_COUNT);
+
+		std::vector<S32> found;
+		index.search("BANANA", found);
+		ensure_equals("banana", (S32)found.size(), MESSAGE_COUNT / 100 + 1);
+		ensure_equals("first", found.front(), 0);
+		ensure_equals("continuation", found.back(), MESSAGE_COUNT - 1);
+
+		index.search("split banana", found);
+		ensure_equals("all words", (S32)found.size(), MESSAGE_COUNT / 100);
+		index.search("speaker3 number703", found);
+		ensure_equals("one", (S32)found.size(), 1);
+		ensure_equals("which", found[0], 703);
+		index.search("nan", found);
+		ensure("part of a word", found.empty());
+		index.search("missing", found);
+		ensure("missing", found.empty());
+
+		// without the word index every message is looked at, with the same results
+		LLTranscriptIndex plain(mFilename, false);
+		ensure("load plain", plain.load());
+		plain.search("split banana", found);
+		ensure_equals("plain", (S32)found.size(), MESSAGE_COUNT / 100);
+
+		// the word file fell behind while words were off and is built again
+		append("[2020/1/2 0:00]  Speaker1: late banana\n");
+		ensure("update plain", plain.update());
+		ensure("reload", index.load());
+		index.search("banana", found);
+		ensure_equals("late", (S32)found.size(), MESSAGE_COUNT / 100 + 2);
+	}
+
+	// an index that doesn't match its transcript is built again
+	template<> template<>
+	void transcriptindex_object::test<3>()
+	{
+		append("[2020/1/1 0:00]  A: one\n[2020/1/1 0:01]  A: two\n");
+		LLTranscriptIndex index(mFilename);
+		ensure("update", index.update());
+		ensure("index file", LLFile::isfile(LLTranscriptIndex::getIndexFilename(mFilename)));
+
+		// replaced by a shorter transcript
+		append("[2020/1/1 0:00]  B: one\n", "wb");
+		ensure("shorter", index.load());
+		ensure_equals("shorter count", index.getCount(), 1);
+		ensure_equals("shorter text", message(index, 0), std::string("[2020/1/1 0:00]  B: one"));
+
+		// same length, different start
+		append("[2020/1/1 0:00]  C: one\n", "wb");
+		ensure("same size", index.load());
+		ensure_equals("same size text", message(index, 0), std::string("[2020/1/1 0:00]  C: one"));
+
+		// a damaged index file
+		append("garbage", "wb");
+		LLFILE* file = LLFile::fopen(LLTranscriptIndex::getIndexFilename(mFilename), "wb");
+		fputs("garbage", file);
+		fclose(file);
+		append("\n[2020/1/1 0:02]  A: three\n");
+		ensure("damaged", index.load());
+		ensure_equals("damaged count", index.getCount(), 2);
+
+		LLTranscriptIndex::removeIndex(mFilename);
+		ensure("removed", !LLFile::isfile(LLTranscriptIndex::getIndexFilename(mFilename)));
+		ensure("removed words", !LLFile::isfile(LLTranscriptIndex::getWordsFilename(mFilename)));
+		LLFile::remove(mFilename);
+		LLTranscriptIndex missing(mFilename);
+		ensure("no transcript", !missing.load());
+	}
+
+	// a transcript edited before its end is indexed again, not just its new tail
+	template<> template<>
+	void transcriptindex_object::test<4>()
+	{
+		static const S32 MESSAGE_COUNT = 20;
+		std::string before, after;
+		for (S32 i = 0; i < MESSAGE_COUNT; ++i)
+		{
+			std::string line = STRINGIZE("[2020/1/1 0:00]  A: message number" << i << "\n");
+			before += line;
+			after += (i == MESSAGE_COUNT / 2) ? std::string("[2020/1/1 0:00]  A: edited by hand, and longer than it was\n") : line;
+		}
+		ensure("larger", after.size() > before.size());
+
+		append(before, "wb");
+		LLTranscriptIndex index(mFilename);
+		ensure("load", index.load());
+		ensure_equals("count", index.getCount(), MESSAGE_COUNT);
+
+		// same first bytes and bigger, but what the index covered has moved
+		append(after, "wb");
+		ensure("edited", index.load());
+		ensure_equals("edited count", index.getCount(), MESSAGE_COUNT);
+		ensure_equals("edited text", message(index, MESSAGE_COUNT / 2), std::string("[2020/1/1 0:00]  A: edited by hand, and longer than it was"));
+		ensure_equals("after the edit", message(index, MESSAGE_COUNT - 1), STRINGIZE("[2020/1/1 0:00]  A: message number" << (MESSAGE_COUNT - 1)));
+
+		std::vector<S32> found;
+		index.search("hand", found);
+		ensure_equals("edited word", (S32)found.size(), 1);
+		ensure_equals("edited message", found[0], MESSAGE_COUNT / 2);
+		index.search(STRINGIZE("number" << (MESSAGE_COUNT / 2)), found);
+		ensure("old word gone", found.empty());
+
+		// later appends carry on from the rebuilt index
+		append("[2020/1/1 0:01]  A: last\n");
+		ensure("appended", index.load());
+		ensure_equals("appended count", index.getCount(), MESSAGE_COUNT + 1);
+		ensure_equals("edit kept", message(index, MESSAGE_COUNT / 2), std::string("[2020/1/1 0:00]  A: edited by hand, and longer than it was"));
+	}
+}
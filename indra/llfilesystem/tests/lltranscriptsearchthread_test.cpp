@@ -0,0 +1,190 @@
+/**
+ * @file lltranscriptsearchthread_test.cpp
+ * @brief Test cases for LLTranscriptSearchThread
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltranscriptsearchthread.h"
+#include "../lltranscriptindex.h"
+#include "llfile.h"
+#include "lltimer.h"
+#include "lluuid.h"
+#include "stringize.h"
+#include "../test/lltut.h"
+
+namespace tut
+{
+	struct transcriptsearchthread_data
+	{
+		std::string mPrefix;
+		std::vector<std::string> mPaths;
+		LLTranscriptSearchThread mThread;
+		U32 mLastID;
+
+		transcriptsearchthread_data()
+		:	mLastID(0)
+		{
+			LLUUID random;
+			random.generate();
+			mPrefix = STRINGIZE(LLFile::tmpdir() << "lltranscriptsearchthread-test-" << random << "-");
+			mThread.start();
+		}
+
+		~transcriptsearchthread_data()
+		{
+			for (std::vector<std::string>::const_iterator it = mPaths.begin(); it != mPaths.end(); ++it)
+			{
+				LLTranscriptIndex::removeIndex(*it);
+				LLFile::remove(*it, ENOENT);
+			}
+		}
+
+		std::string getPath(const std::string& name)
+		{
+			return mPrefix + name + ".txt";
+		}
+
+		void append(const std::string& name, const std::string& text)
+		{
+			std::string path = getPath(name);
+			if (std::find(mPaths.begin(), mPaths.end(), path) == mPaths.end())
+			{
+				mPaths.push_back(path);
+			}
+			LLFILE* file = LLFile::fopen(path, "ab");
+			fwrite(text.data(), 1, text.size(), file);
+			fclose(file);
+		}
+
+		U32 post(const std::vector<std::string>& names, const std::string& text)
+		{
+			LLTranscriptSearchThread::Request request;
+			request.mID = ++mLastID;
+			request.mText = text;
+			request.mFileNames = names;
+			for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+			{
+				request.mPaths.push_back(getPath(*it));
+			}
+			mThread.post(request);
+			return request.mID;
+		}
+
+		// Waits for the result of search id, dropping older ones the way the
+		// conversation log does.
+		std::set<std::string> wait(U32 id)
+		{
+			LLTimer timer;
+			LLTranscriptSearchThread::Result result;
+			while (timer.getElapsedTimeF32() < 10.f)
+			{
+				while (mThread.getResult(result))
+				{
+					if (result.mID == id)
+					{
+						return result.mFileNames;
+					}
+				}
+				ms_sleep(1);
+			}
+			fail(STRINGIZE("no result for search " << id));
+			return std::set<std::string>();
+		}
+
+		std::string join(const std::set<std::string>& names)
+		{
+			std::string joined;
+			for (std::set<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+			{
+				joined += (joined.empty() ? "" : ",") + *it;
+			}
+			return joined;
+		}
+	};
+	typedef test_group<transcriptsearchthread_data> transcriptsearchthread_test;
+	typedef transcriptsearchthread_test::object transcriptsearchthread_object;
+	tut::transcriptsearchthread_test transcriptsearchthread("LLTranscriptSearchThread");
+
+	// the names of the transcripts with a message holding every word come back
+	template<> template<>
+	void transcriptsearchthread_object::test<1>()
+	{
+		append("alice", "[2020/1/1 0:00]  Alice: apples and pears\n");
+		append("bob", "[2020/1/1 0:00]  Bob: apples\n[2020/1/1 0:01]  Bob: pears\n");
+		append("carol", "[2020/1/1 0:00]  Carol: cherries\n");
+
+		std::vector<std::string> names;
+		names.push_back("alice");
+		names.push_back("bob");
+		names.push_back("carol");
+		names.push_back("nobody");
+
+		ensure_equals("one word", join(wait(post(names, "APPLES"))), "alice,bob");
+		ensure_equals("one message", join(wait(post(names, "pears apples"))), "alice");
+		ensure_equals("none", join(wait(post(names, "bananas"))), "");
+	}
+
+	// the newest search is answered, and a transcript that grew is searched again
+	template<> template<>
+	void transcriptsearchthread_object::test<2>()
+	{
+		append("alice", "[2020/1/1 0:00]  Alice: apples\n");
+		std::vector<std::string> names(1, "alice");
+
+		post(names, "apples");
+		U32 newest = post(names, "cherries");
+		ensure_equals("not yet", join(wait(newest)), "");
+
+		append("alice", "[2020/1/1 0:01]  Alice: cherries\n");
+		ensure_equals("grown", join(wait(post(names, "cherries"))), "alice");
+	}
+
+	// the chat log keeps saving to a transcript while it is searched
+	template<> template<>
+	void transcriptsearchthread_object::test<3>()
+	{
+		static const S32 LINE_COUNT = 200;
+		std::vector<std::string> names(1, "busy");
+		append("busy", "[2020/1/1 0:00]  Alice: first\n");
+		for (S32 i = 0; i < LINE_COUNT; ++i)
+		{
+			append("busy", STRINGIZE("[2020/1/1 0:00]  Alice: word" << i << "\n"));
+			LLTranscriptIndex(getPath("busy")).update();
+			if (!(i % 10))
+			{
+				post(names, "first");
+			}
+		}
+		ensure_equals("last line", join(wait(post(names, STRINGIZE("word" << (LINE_COUNT - 1))))), "busy");
+
+		LLTranscriptIndex index(getPath("busy"));
+		ensure("load", index.load());
+		ensure_equals("every line", index.getCount(), LINE_COUNT + 1);
+		std::vector<S32> found;
+		index.search(STRINGIZE("word" << (LINE_COUNT / 2)), found);
+		ensure_equals("found once", (S32)found.size(), 1);
+		ensure_equals("in its place", found[0], LINE_COUNT / 2 + 1);
+	}
+}
@@ -106,6 +106,7 @@ public:
 	// Member Variables
 	//--------------------------------------------------------------------
 protected:
+	friend class LLInventoryCacheFile; // fills names from worker threads without touching LLTrace
 	LLUUID mUUID;
 	LLUUID mParentUUID; // Parent category.  Root categories have LLUUID::NULL.
 	LLAssetType::EType mType;
@@ -214,6 +215,7 @@ public:
 	// Member Variables
 	//--------------------------------------------------------------------
 protected:
+	friend class LLInventoryCacheFile;
 	LLPermissions mPermissions;
 	LLUUID mAssetUUID;
 	std::string mDescription;
@@ -0,0 +1,468 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llinventorycache.h"
+
+#include "llinventory.h"
+#include "llsys.h"
+#include "llxorcipher.h"
+#include <algorithm>
+
+///----------------------------------------------------------------------------
+/// Local function declarations, constants, enums, and typedefs
+///----------------------------------------------------------------------------
+
+static const char CACHE_MAGIC[8] = { 'L', 'L', 'I', 'N', 'V', 'B', 'I', 'N' };
+static const U32 CATEGORY_BIT = 0x80000000;
+
+// Same key LLInventoryItem::asLLSD() uses for "shadow_id", so restricted
+// asset ids are no more readable here than in the notation cache.
+static const LLUUID SHADOW_KEY("3c115e51-04f4-523c-9fa6-98aff1034730");
+
+static inline U32 align_offset(U32 offset)
+{
+	return (offset + 7) & ~7;
+}
+
+template<class RECORD>
+static inline bool is_aligned(const U8* base, U32 offset)
+{
+	return (reinterpret_cast<uintptr_t>(base + offset) % alignof(RECORD)) == 0;
+}
+
+static bool index_less(const LLInventoryCacheFile::IndexEntry& a,
+					   const LLInventoryCacheFile::IndexEntry& b)
+{
+	return a.mID < b.mID;
+}
+
+// inventory_and_asset_types_match() goes through an LLSingleton, which
+// locks on every call.  Flatten it once so getItem() stays lock free.
+static U8 sTypesMatch[LLInventoryType::IT_COUNT][LLAssetType::AT_COUNT];
+static bool sTypesMatchInitialized = false;
+
+static void init_types_match()
+{
+	if (sTypesMatchInitialized) return;
+	for (S32 it = 0; it < LLInventoryType::IT_COUNT; ++it)
+	{
+		for (S32 at = 0; at < LLAssetType::AT_COUNT; ++at)
+		{
+			sTypesMatch[it][at] = inventory_and_asset_types_match(
+				(LLInventoryType::EType)it, (LLAssetType::EType)at) ? 1 : 0;
+		}
+	}
+	sTypesMatchInitialized = true;
+}
+
+static bool types_match(S32 inv_type, S32 asset_type)
+{
+	if (inv_type < 0 || inv_type >= LLInventoryType::IT_COUNT
+		|| asset_type < 0 || asset_type >= LLAssetType::AT_COUNT)
+	{
+		return false;
+	}
+	return sTypesMatch[inv_type][asset_type] != 0;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventoryCacheFile
+///----------------------------------------------------------------------------
+
+LLInventoryCacheFile::LLInventoryCacheFile()
+:	mCacheVersion(0),
+	mCategoryCount(0),
+	mItemCount(0),
+	mCategoryRecords(NULL),
+	mItemRecords(NULL),
+	mIndex(NULL),
+	mStringPool(NULL),
+	mStringPoolSize(0)
+{
+}
+
+void LLInventoryCacheFile::reserve(S32 categories, S32 items)
+{
+	mCategories.reserve(categories);
+	mItems.reserve(items);
+	// names are short, descriptions usually empty
+	mStrings.reserve((categories + items) * 24);
+}
+
+LLInventoryCacheFile::StringRef LLInventoryCacheFile::addString(const std::string& str)
+{
+	StringRef ref;
+	ref.mOffset = (U32)mStrings.size();
+	ref.mLength = (U32)str.size();
+	mStrings.insert(mStrings.end(), str.begin(), str.end());
+	return ref;
+}
+
+std::string LLInventoryCacheFile::getString(const StringRef& ref) const
+{
+	return std::string(mStringPool + ref.mOffset, ref.mLength);
+}
+
+void LLInventoryCacheFile::addCategory(const LLInventoryCategory* cat, const LLUUID& owner_id, S32 version)
+{
+	CategoryRecord rec;
+	memset(&rec, 0, sizeof(rec));
+	rec.mID = cat->getUUID();
+	rec.mParentID = cat->getParentUUID();
+	rec.mOwnerID = owner_id;
+	rec.mName = addString(cat->getName());
+	rec.mVersion = version;
+	rec.mType = (S8)cat->getType();
+	rec.mPreferredType = (S8)cat->getPreferredType();
+	mCategories.push_back(rec);
+	mCategoryCount = (S32)mCategories.size();
+}
+
+void LLInventoryCacheFile::addItem(const LLInventoryItem* item)
+{
+	ItemRecord rec;
+	memset(&rec, 0, sizeof(rec));
+	const LLPermissions& perm = item->getPermissions();
+	rec.mID = item->getUUID();
+	rec.mParentID = item->getParentUUID();
+	rec.mAssetID = item->getAssetUUID();
+	U32 mask = perm.getMaskBase();
+	if (((mask & PERM_ITEM_UNRESTRICTED) != PERM_ITEM_UNRESTRICTED)
+		&& rec.mAssetID.notNull())
+	{
+		LLXORCipher cipher(SHADOW_KEY.mData, UUID_BYTES);
+		cipher.encrypt(rec.mAssetID.mData, UUID_BYTES);
+		rec.mAssetShadowed = 1;
+	}
+	rec.mCreatorID = perm.getCreator();
+	rec.mOwnerID = perm.getOwner();
+	rec.mLastOwnerID = perm.getLastOwner();
+	rec.mGroupID = perm.getGroup();
+	rec.mMaskBase = perm.getMaskBase();
+	rec.mMaskOwner = perm.getMaskOwner();
+	rec.mMaskGroup = perm.getMaskGroup();
+	rec.mMaskEveryone = perm.getMaskEveryone();
+	rec.mMaskNext = perm.getMaskNextOwner();
+	rec.mFlags = item->getFlags();
+	rec.mCreationDate = (S32)item->getCreationDate();
+	rec.mSalePrice = item->getSaleInfo().getSalePrice();
+	rec.mName = addString(item->getName());
+	rec.mDescription = addString(item->getDescription());
+	rec.mType = (S8)item->getType();
+	rec.mInventoryType = (S8)item->getInventoryType();
+	rec.mSaleType = (S8)item->getSaleInfo().getSaleType();
+	mItems.push_back(rec);
+	mItemCount = (S32)mItems.size();
+}
+
+bool LLInventoryCacheFile::save(const std::string& filename)
+{
+	std::vector<IndexEntry> index;
+	index.reserve(mCategories.size() + mItems.size());
+	for (U32 i = 0; i < mCategories.size(); ++i)
+	{
+		IndexEntry entry;
+		entry.mID = mCategories[i].mID;
+		entry.mRecord = i | CATEGORY_BIT;
+		index.push_back(entry);
+	}
+	for (U32 i = 0; i < mItems.size(); ++i)
+	{
+		IndexEntry entry;
+		entry.mID = mItems[i].mID;
+		entry.mRecord = i;
+		index.push_back(entry);
+	}
+	std::sort(index.begin(), index.end(), index_less);
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.mFormatVersion = FORMAT_VERSION;
+	header.mCacheVersion = mCacheVersion;
+	header.mCategoryCount = (U32)mCategories.size();
+	header.mItemCount = (U32)mItems.size();
+	header.mStringPoolSize = (U32)mStrings.size();
+	header.mCategoryOffset = align_offset(sizeof(Header));
+	header.mItemOffset = align_offset(header.mCategoryOffset + header.mCategoryCount * sizeof(CategoryRecord));
+	header.mIndexOffset = align_offset(header.mItemOffset + header.mItemCount * sizeof(ItemRecord));
+	header.mStringOffset = align_offset(header.mIndexOffset + (U32)index.size() * sizeof(IndexEntry));
+	header.mFileSize = header.mStringOffset + header.mStringPoolSize;
+
+	std::vector<U8> data(header.mFileSize, 0);
+	memcpy(&data[0], &header, sizeof(header));
+	if (!mCategories.empty())
+	{
+		memcpy(&data[header.mCategoryOffset], &mCategories[0], mCategories.size() * sizeof(CategoryRecord));
+	}
+	if (!mItems.empty())
+	{
+		memcpy(&data[header.mItemOffset], &mItems[0], mItems.size() * sizeof(ItemRecord));
+	}
+	if (!index.empty())
+	{
+		memcpy(&data[header.mIndexOffset], &index[0], index.size() * sizeof(IndexEntry));
+	}
+	if (!mStrings.empty())
+	{
+		memcpy(&data[header.mStringOffset], &mStrings[0], mStrings.size());
+	}
+
+	if (!gzip_buffer_to_file(&data[0], data.size(), filename))
+	{
+		LL_WARNS("Inventory") << "Unable to write inventory cache " << filename << LL_ENDL;
+		return false;
+	}
+	return true;
+}
+
+LLInventoryCacheFile::ELoadResult LLInventoryCacheFile::load(const std::string& filename)
+{
+	std::vector<U8> data;
+	if (!gunzip_file_to_buffer(filename, data))
+	{
+		return LOAD_NO_FILE;
+	}
+	return loadFromBuffer(data);
+}
+
+LLInventoryCacheFile::ELoadResult LLInventoryCacheFile::loadFromBuffer(std::vector<U8>& data)
+{
+	mData.swap(data);
+	mCategoryRecords = NULL;
+	mItemRecords = NULL;
+	mIndex = NULL;
+	mStringPool = NULL;
+	mStringPoolSize = 0;
+	mCategoryCount = 0;
+	mItemCount = 0;
+
+	const U64 size = mData.size();
+	if (size < sizeof(Header))
+	{
+		return LOAD_NOT_BINARY;
+	}
+	Header header;
+	memcpy(&header, &mData[0], sizeof(header));
+	if (memcmp(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+	{
+		return LOAD_NOT_BINARY;
+	}
+	if (header.mFormatVersion != FORMAT_VERSION)
+	{
+		return LOAD_BAD_FORMAT;
+	}
+
+	// All arithmetic in 64 bits so hostile counts cannot wrap.
+	const U64 index_count = (U64)header.mCategoryCount + header.mItemCount;
+	if (header.mFileSize != size
+		|| header.mCategoryCount > S32_MAX
+		|| header.mItemCount > S32_MAX
+		|| (U64)header.mCategoryOffset + (U64)header.mCategoryCount * sizeof(CategoryRecord) > size
+		|| (U64)header.mItemOffset + (U64)header.mItemCount * sizeof(ItemRecord) > size
+		|| (U64)header.mIndexOffset + index_count * sizeof(IndexEntry) > size
+		|| (U64)header.mStringOffset + header.mStringPoolSize > size)
+	{
+		LL_WARNS("Inventory") << "Inventory cache sections out of range" << LL_ENDL;
+		return LOAD_CORRUPT;
+	}
+
+	// The records are read in place, so every section has to sit on its
+	// type's alignment; save() pads them all to 8 bytes.
+	const U8* base = &mData[0];
+	if (!is_aligned<CategoryRecord>(base, header.mCategoryOffset)
+		|| !is_aligned<ItemRecord>(base, header.mItemOffset)
+		|| !is_aligned<IndexEntry>(base, header.mIndexOffset))
+	{
+		LL_WARNS("Inventory") << "Inventory cache sections misaligned" << LL_ENDL;
+		return LOAD_CORRUPT;
+	}
+	const CategoryRecord* cats = reinterpret_cast<const CategoryRecord*>(base + header.mCategoryOffset);
+	const ItemRecord* items = reinterpret_cast<const ItemRecord*>(base + header.mItemOffset);
+	const IndexEntry* index = reinterpret_cast<const IndexEntry*>(base + header.mIndexOffset);
+	const U64 pool_size = header.mStringPoolSize;
+
+	for (U32 i = 0; i < header.mCategoryCount; ++i)
+	{
+		const StringRef& name = cats[i].mName;
+		if ((U64)name.mOffset + name.mLength > pool_size)
+		{
+			LL_WARNS("Inventory") << "Inventory cache category string out of range" << LL_ENDL;
+			return LOAD_CORRUPT;
+		}
+	}
+	for (U32 i = 0; i < header.mItemCount; ++i)
+	{
+		const StringRef& name = items[i].mName;
+		const StringRef& desc = items[i].mDescription;
+		if ((U64)name.mOffset + name.mLength > pool_size
+			|| (U64)desc.mOffset + desc.mLength > pool_size)
+		{
+			LL_WARNS("Inventory") << "Inventory cache item string out of range" << LL_ENDL;
+			return LOAD_CORRUPT;
+		}
+	}
+	for (U64 i = 0; i < index_count; ++i)
+	{
+		U32 record = index[i].mRecord;
+		bool bad_record = (record & CATEGORY_BIT)
+			? (record & ~CATEGORY_BIT) >= header.mCategoryCount
+			: record >= header.mItemCount;
+		if (bad_record || (i > 0 && index[i].mID < index[i - 1].mID))
+		{
+			LL_WARNS("Inventory") << "Inventory cache index is corrupt" << LL_ENDL;
+			return LOAD_CORRUPT;
+		}
+	}
+
+	init_types_match();
+
+	mCacheVersion = header.mCacheVersion;
+	mCategoryCount = (S32)header.mCategoryCount;
+	mItemCount = (S32)header.mItemCount;
+	mCategoryRecords = cats;
+	mItemRecords = items;
+	mIndex = index;
+	mStringPool = reinterpret_cast<const char*>(base + header.mStringOffset);
+	mStringPoolSize = header.mStringPoolSize;
+	return LOAD_OK;
+}
+
+void LLInventoryCacheFile::getCategory(S32 index, LLInventoryCategory* cat) const
+{
+	llassert(index >= 0 && index < mCategoryCount);
+	const CategoryRecord& rec = mCategoryRecords[index];
+	cat->setUUID(rec.mID);
+	cat->setParent(rec.mParentID);
+	cat->setType((LLAssetType::EType)rec.mType);
+	cat->setPreferredType((LLFolderType::EType)rec.mPreferredType);
+	cat->disclaimMem(cat->mName);
+	cat->mName = getString(rec.mName);
+	LLStringUtil::replaceNonstandardASCII(cat->mName, ' ');
+	LLStringUtil::replaceChar(cat->mName, '|', ' ');
+	cat->claimMem(cat->mName);
+}
+
+const LLUUID& LLInventoryCacheFile::getCategoryOwner(S32 index) const
+{
+	llassert(index >= 0 && index < mCategoryCount);
+	return mCategoryRecords[index].mOwnerID;
+}
+
+S32 LLInventoryCacheFile::getCategoryVersion(S32 index) const
+{
+	llassert(index >= 0 && index < mCategoryCount);
+	return mCategoryRecords[index].mVersion;
+}
+
+// Mirrors LLInventoryItem::fromLLSD().  Strings are assigned to the members
+// directly: the setters claim memory through LLTrace, which is not safe off
+// the main thread, so claimItemStrings() does that part later.
+void LLInventoryCacheFile::getItem(S32 index, LLInventoryItem* item) const
+{
+	llassert(index >= 0 && index < mItemCount);
+	const ItemRecord& rec = mItemRecords[index];
+
+	item->mUUID = rec.mID;
+	item->mParentUUID = rec.mParentID;
+
+	LLPermissions& perm = item->mPermissions;
+	perm.init(rec.mCreatorID, rec.mOwnerID, rec.mLastOwnerID, rec.mGroupID);
+	perm.setMaskBase(rec.mMaskBase);
+	perm.setMaskOwner(rec.mMaskOwner);
+	perm.setMaskEveryone(rec.mMaskEveryone);
+	perm.setMaskGroup(rec.mMaskGroup);
+	perm.setMaskNext(rec.mMaskNext);
+	perm.fix();
+
+	item->mSaleInfo = LLSaleInfo((LLSaleInfo::EForSale)rec.mSaleType, rec.mSalePrice);
+
+	item->mAssetUUID = rec.mAssetID;
+	if (rec.mAssetShadowed)
+	{
+		LLXORCipher cipher(SHADOW_KEY.mData, UUID_BYTES);
+		cipher.decrypt(item->mAssetUUID.mData, UUID_BYTES);
+	}
+
+	item->mType = (LLAssetType::EType)rec.mType;
+	item->mInventoryType = (LLInventoryType::EType)rec.mInventoryType;
+	item->mFlags = rec.mFlags;
+
+	item->mName = getString(rec.mName);
+	LLStringUtil::replaceNonstandardASCII(item->mName, ' ');
+	LLStringUtil::replaceChar(item->mName, '|', ' ');
+	item->mDescription = getString(rec.mDescription);
+	LLStringUtil::replaceNonstandardASCII(item->mDescription, ' ');
+
+	item->mCreationDate = rec.mCreationDate;
+
+	if ((LLInventoryType::IT_NONE == item->mInventoryType)
+		|| (!LLAssetType::lookupIsLinkType(item->mType)
+			&& !types_match(item->mInventoryType, item->mType)))
+	{
+		item->mInventoryType = LLInventoryType::defaultForAssetType(item->mType);
+	}
+
+	perm.initMasks(item->mInventoryType);
+}
+
+// static
+void LLInventoryCacheFile::claimItemStrings(LLInventoryItem* item)
+{
+	item->claimMem(item->mName);
+	item->claimMem(item->mDescription);
+}
+
+S32 LLInventoryCacheFile::findRecord(const LLUUID& id, bool category) const
+{
+	if (!mIndex) return -1;
+	IndexEntry key;
+	key.mID = id;
+	key.mRecord = 0;
+	const IndexEntry* end = mIndex + mCategoryCount + mItemCount;
+	const IndexEntry* it = std::lower_bound(mIndex, end, key, index_less);
+	// Ids are unique in practice, but step over a colliding entry of the
+	// other kind just in case.
+	for (; it != end && it->mID == id; ++it)
+	{
+		if (((it->mRecord & CATEGORY_BIT) != 0) == category)
+		{
+			return (S32)(it->mRecord & ~CATEGORY_BIT);
+		}
+	}
+	return -1;
+}
+
+S32 LLInventoryCacheFile::findCategory(const LLUUID& id) const
+{
+	return findRecord(id, true);
+}
+
+S32 LLInventoryCacheFile::findItem(const LLUUID& id) const
+{
+	return findRecord(id, false);
+}
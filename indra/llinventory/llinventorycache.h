@@ -0,0 +1,197 @@
+/**
+ * @file llinventorycache.h
+ * @brief LLInventoryCacheFile class declaration.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "lluuid.h"
+#include <string>
+#include <vector>
+
+class LLInventoryCategory;
+class LLInventoryItem;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventoryCacheFile
+//
+//   Binary form of the login inventory cache.  The file is a header followed
+//   by fixed size category and item records, a UUID index sorted by id and
+//   one string pool holding every name and description.  Records refer to
+//   strings and to each other by offset, never by pointer, so a loaded image
+//   is usable in place.  On disk the whole image is gzipped.
+//
+//   Items are decoded straight from their records, and getItem() touches
+//   nothing but the item it fills, so a loader can spread the items over
+//   worker threads.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventoryCacheFile
+{
+public:
+	enum ELoadResult
+	{
+		LOAD_OK,
+		LOAD_NO_FILE,		// missing or not a gzip file
+		LOAD_NOT_BINARY,	// wrong magic, probably an older cache
+		LOAD_BAD_FORMAT,	// different binary layout version
+		LOAD_CORRUPT		// truncated or inconsistent
+	};
+
+	// Bump when the record layout below changes.
+	static const U32 FORMAT_VERSION = 1;
+
+	LLInventoryCacheFile();
+
+	//--------------------------------------------------------------------
+	// Writing
+	//--------------------------------------------------------------------
+public:
+	// cache_version is the caller's own version stamp (the inventory
+	// model's cache version) and is handed back by getCacheVersion().
+	void setCacheVersion(S32 cache_version) { mCacheVersion = cache_version; }
+	void reserve(S32 categories, S32 items);
+	void addCategory(const LLInventoryCategory* cat, const LLUUID& owner_id, S32 version);
+	void addItem(const LLInventoryItem* item);
+	bool save(const std::string& filename);
+
+	//--------------------------------------------------------------------
+	// Reading
+	//--------------------------------------------------------------------
+public:
+	ELoadResult load(const std::string& filename);
+	// Same checks as load() on an already decompressed image.
+	ELoadResult loadFromBuffer(std::vector<U8>& data);
+
+	S32 getCacheVersion() const		{ return mCacheVersion; }
+	S32 getCategoryCount() const	{ return mCategoryCount; }
+	S32 getItemCount() const		{ return mItemCount; }
+
+	// Main thread only: claims the name like the setters do.
+	void getCategory(S32 index, LLInventoryCategory* cat) const;
+	const LLUUID& getCategoryOwner(S32 index) const;
+	S32 getCategoryVersion(S32 index) const;
+	// Safe to call concurrently for different items.  Call claimItemStrings()
+	// on the main thread afterwards.
+	void getItem(S32 index, LLInventoryItem* item) const;
+	// Reports the name and description getItem() filled in to LLTrace.
+	static void claimItemStrings(LLInventoryItem* item);
+
+	// Record index of the category or item with this id, or -1.
+	S32 findCategory(const LLUUID& id) const;
+	S32 findItem(const LLUUID& id) const;
+
+	//--------------------------------------------------------------------
+	// File layout
+	//--------------------------------------------------------------------
+public:
+	struct Header
+	{
+		char	mMagic[8];
+		U32		mFormatVersion;
+		S32		mCacheVersion;
+		U32		mCategoryCount;
+		U32		mItemCount;
+		U32		mStringPoolSize;
+		U32		mCategoryOffset;
+		U32		mItemOffset;
+		U32		mIndexOffset;
+		U32		mStringOffset;
+		U32		mFileSize;
+	};
+
+	struct StringRef
+	{
+		U32		mOffset;
+		U32		mLength;
+	};
+
+	struct CategoryRecord
+	{
+		LLUUID		mID;
+		LLUUID		mParentID;
+		LLUUID		mOwnerID;
+		StringRef	mName;
+		S32			mVersion;
+		S8			mType;
+		S8			mPreferredType;
+		U8			mPad[2];
+	};
+
+	struct ItemRecord
+	{
+		LLUUID		mID;
+		LLUUID		mParentID;
+		LLUUID		mAssetID;		// shadowed the same way as the notation cache
+		LLUUID		mCreatorID;
+		LLUUID		mOwnerID;
+		LLUUID		mLastOwnerID;
+		LLUUID		mGroupID;
+		U32			mMaskBase;
+		U32			mMaskOwner;
+		U32			mMaskGroup;
+		U32			mMaskEveryone;
+		U32			mMaskNext;
+		U32			mFlags;
+		S32			mCreationDate;
+		S32			mSalePrice;
+		StringRef	mName;
+		StringRef	mDescription;
+		S8			mType;
+		S8			mInventoryType;
+		S8			mSaleType;
+		U8			mAssetShadowed;
+	};
+
+	// High bit of mRecord set for categories.
+	struct IndexEntry
+	{
+		LLUUID		mID;
+		U32			mRecord;
+	};
+
+private:
+	StringRef addString(const std::string& str);
+	std::string getString(const StringRef& ref) const;
+	S32 findRecord(const LLUUID& id, bool category) const;
+
+	S32							mCacheVersion;
+	S32							mCategoryCount;
+	S32							mItemCount;
+
+	// writing
+	std::vector<CategoryRecord>	mCategories;
+	std::vector<ItemRecord>		mItems;
+	std::vector<char>			mStrings;
+
+	// reading: everything points into mData
+	std::vector<U8>				mData;
+	const CategoryRecord*		mCategoryRecords;
+	const ItemRecord*			mItemRecords;
+	const IndexEntry*			mIndex;
+	const char*					mStringPool;
+	U32							mStringPoolSize;
+};
+
+#endif // LL_LLINVENTORYCACHE_H
@@ -0,0 +1,300 @@
+/**
+ * @file llinventorysearchindex.cpp
+ * @brief Substring index over inventory items.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llinventorysearchindex.h"
+
+#include <algorithm>
+
+///----------------------------------------------------------------------------
+/// Local function declarations, constants, enums, and typedefs
+///----------------------------------------------------------------------------
+
+static const size_t RUN_LENGTH = 3;
+static const size_t UUID_STRING_LENGTH = 36;
+
+// Don't bother rebuilding the run lists for a handful of stale references.
+static const U32 MIN_STALE_RUNS_FOR_REBUILD = 65536;
+
+static inline U32 make_run(const char* text, S32 field)
+{
+	return ((U32)field << 24) | ((U32)(U8)text[0] << 16) | ((U32)(U8)text[1] << 8) | (U32)(U8)text[2];
+}
+
+static inline bool contains(const char* text, size_t len, const std::string& substring)
+{
+	return len >= substring.size()
+		&& std::search(text, text + len, substring.begin(), substring.end()) != text + len;
+}
+
+///----------------------------------------------------------------------------
+/// Class LLInventorySearchIndex
+///----------------------------------------------------------------------------
+
+LLInventorySearchIndex::LLInventorySearchIndex()
+:	mLiveRuns(0),
+	mStaleRuns(0)
+{
+}
+
+// static
+void LLInventorySearchIndex::getAssetIDString(const LLUUID& id, char* out)
+{
+	// same text as LLUUID::asString(), upper cased like the folder view does
+	id.toString(out);
+	for (size_t i = 0; i < UUID_STRING_LENGTH; ++i)
+	{
+		if (out[i] >= 'a' && out[i] <= 'f')
+		{
+			out[i] -= 'a' - 'A';
+		}
+	}
+}
+
+// static
+size_t LLInventorySearchIndex::getFieldText(const Entry& entry, S32 field, const char*& text, char* buffer)
+{
+	switch (field)
+	{
+	case 0:
+		text = entry.mName.c_str();
+		return entry.mName.size();
+	case 1:
+		text = entry.mDescription.c_str();
+		return entry.mDescription.size();
+	default:
+		getAssetIDString(entry.mAssetID, buffer);
+		text = buffer;
+		return UUID_STRING_LENGTH;
+	}
+}
+
+// static
+void LLInventorySearchIndex::collectRuns(const char* text, size_t len, S32 field, std::vector<U32>& runs)
+{
+	for (size_t i = 0; i + RUN_LENGTH <= len; ++i)
+	{
+		runs.push_back(make_run(text + i, field));
+	}
+}
+
+void LLInventorySearchIndex::indexSlot(U32 slot_index)
+{
+	Slot& slot = mEntries[slot_index];
+
+	std::vector<U32>& runs = mScratchRuns;
+	runs.clear();
+	char buffer[UUID_STRING_LENGTH + 1];
+	for (S32 field = 0; field < NUM_TEXT_FIELDS; ++field)
+	{
+		const char* text;
+		size_t len = getFieldText(slot.mEntry, field, text, buffer);
+		collectRuns(text, len, field, runs);
+	}
+	// a run repeated within an entry is only listed once
+	std::sort(runs.begin(), runs.end());
+	runs.erase(std::unique(runs.begin(), runs.end()), runs.end());
+
+	for (std::vector<U32>::const_iterator it = runs.begin(); it != runs.end(); ++it)
+	{
+		mRuns[*it].push_back(slot_index);
+	}
+	mCreators[slot.mEntry.mCreatorID].push_back(slot_index);
+
+	slot.mRunCount = runs.size() + 1;
+	mLiveRuns += slot.mRunCount;
+}
+
+void LLInventorySearchIndex::add(const Entry& entry)
+{
+	remove(entry.mID);
+
+	U32 slot_index;
+	if (!mFreeSlots.empty())
+	{
+		slot_index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else
+	{
+		slot_index = mEntries.size();
+		mEntries.push_back(Slot());
+	}
+	Slot& slot = mEntries[slot_index];
+	slot.mEntry = entry;
+	slot.mLive = true;
+	mSlots[entry.mID] = slot_index;
+
+	indexSlot(slot_index);
+}
+
+void LLInventorySearchIndex::remove(const LLUUID& id)
+{
+	boost::unordered_map<LLUUID, U32, FSUUIDHash>::iterator it = mSlots.find(id);
+	if (it == mSlots.end())
+	{
+		return;
+	}
+	Slot& slot = mEntries[it->second];
+	slot.mLive = false;
+	slot.mEntry = Entry();
+	mFreeSlots.push_back(it->second);
+	mSlots.erase(it);
+
+	mLiveRuns -= slot.mRunCount;
+	mStaleRuns += slot.mRunCount;
+	if (mStaleRuns > mLiveRuns && mStaleRuns > MIN_STALE_RUNS_FOR_REBUILD)
+	{
+		rebuild();
+	}
+}
+
+void LLInventorySearchIndex::clear()
+{
+	mEntries.clear();
+	mFreeSlots.clear();
+	mSlots.clear();
+	mRuns.clear();
+	mCreators.clear();
+	mLiveRuns = 0;
+	mStaleRuns = 0;
+}
+
+void LLInventorySearchIndex::rebuild()
+{
+	// slot numbers stay, only the lists are redone
+	mRuns.clear();
+	mCreators.clear();
+	mLiveRuns = 0;
+	mStaleRuns = 0;
+	for (U32 i = 0; i < mEntries.size(); ++i)
+	{
+		if (mEntries[i].mLive)
+		{
+			indexSlot(i);
+		}
+	}
+}
+
+bool LLInventorySearchIndex::has(const LLUUID& id) const
+{
+	return mSlots.find(id) != mSlots.end();
+}
+
+void LLInventorySearchIndex::find(const std::string& substring, U32 field_mask, id_set_t& ids,
+								  const creator_name_map_t* names) const
+{
+	if (substring.empty())
+	{
+		return;
+	}
+
+	char buffer[UUID_STRING_LENGTH + 1];
+	for (S32 field = 0; field < NUM_TEXT_FIELDS; ++field)
+	{
+		if (!(field_mask & (1 << field)))
+		{
+			continue;
+		}
+
+		if (substring.size() < RUN_LENGTH)
+		{
+			// too short to have a run of its own, look at everything
+			for (U32 i = 0; i < mEntries.size(); ++i)
+			{
+				const Slot& slot = mEntries[i];
+				const char* text;
+				size_t len = slot.mLive ? getFieldText(slot.mEntry, field, text, buffer) : 0;
+				if (len && contains(text, len, substring))
+				{
+					ids.insert(slot.mEntry.mID);
+				}
+			}
+			continue;
+		}
+
+		// every entry containing substring is listed under each of its runs,
+		// so the shortest of those lists is all there is to check
+		const std::vector<U32>* shortest = NULL;
+		for (size_t i = 0; i + RUN_LENGTH <= substring.size(); ++i)
+		{
+			run_map_t::const_iterator it = mRuns.find(make_run(substring.c_str() + i, field));
+			if (it == mRuns.end())
+			{
+				shortest = NULL;
+				break;
+			}
+			if (!shortest || it->second.size() < shortest->size())
+			{
+				shortest = &it->second;
+			}
+		}
+		if (!shortest)
+		{
+			continue;
+		}
+		for (std::vector<U32>::const_iterator it = shortest->begin(); it != shortest->end(); ++it)
+		{
+			// slots may have been removed or reused since they were listed
+			const Slot& slot = mEntries[*it];
+			const char* text;
+			size_t len = slot.mLive ? getFieldText(slot.mEntry, field, text, buffer) : 0;
+			if (len && contains(text, len, substring))
+			{
+				ids.insert(slot.mEntry.mID);
+			}
+		}
+	}
+
+	if ((field_mask & FIELD_CREATOR) && names)
+	{
+		for (creator_map_t::const_iterator it = mCreators.begin(); it != mCreators.end(); ++it)
+		{
+			creator_name_map_t::const_iterator name_it = names->find(it->first);
+			if (name_it == names->end() || name_it->second.find(substring) == std::string::npos)
+			{
+				continue;
+			}
+			for (std::vector<U32>::const_iterator slot_it = it->second.begin(); slot_it != it->second.end(); ++slot_it)
+			{
+				const Slot& slot = mEntries[*slot_it];
+				if (slot.mLive && slot.mEntry.mCreatorID == it->first)
+				{
+					ids.insert(slot.mEntry.mID);
+				}
+			}
+		}
+	}
+}
+
+void LLInventorySearchIndex::getCreators(uuid_vec_t& creators) const
+{
+	creators.reserve(creators.size() + mCreators.size());
+	for (creator_map_t::const_iterator it = mCreators.begin(); it != mCreators.end(); ++it)
+	{
+		creators.push_back(it->first);
+	}
+}
@@ -0,0 +1,127 @@
+/**
+ * @file llinventorysearchindex.h
+ * @brief LLInventorySearchIndex class declaration.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYSEARCHINDEX_H
+#define LL_LLINVENTORYSEARCHINDEX_H
+
+#include "lluuid.h"
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventorySearchIndex
+//
+//   Substring index over inventory item names, descriptions, asset ids and
+//   creators.  Every three character run of the upper cased text maps to
+//   the entries containing it, so a search only looks at the entries
+//   listed under the rarest run of the search string instead of at the
+//   whole inventory.  Matches are confirmed against the stored text, so
+//   find() is exact.
+//
+//   Creator names are not stored; the caller passes the upper cased names
+//   it knows to find(), since they arrive long after the items do.
+//
+//   Not thread safe.  Entries are only ever appended to the run lists;
+//   removed and replaced ones are skipped while searching and dropped when
+//   the lists get rebuilt.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventorySearchIndex
+{
+public:
+	enum EField
+	{
+		FIELD_NAME			= 0x1,
+		FIELD_DESCRIPTION	= 0x2,
+		FIELD_ASSET_ID		= 0x4,
+		FIELD_CREATOR		= 0x8,
+		FIELD_ALL			= 0xf
+	};
+
+	struct Entry
+	{
+		LLUUID		mID;
+		LLUUID		mCreatorID;
+		LLUUID		mAssetID;
+		std::string	mName;			// upper case
+		std::string	mDescription;	// upper case
+	};
+
+	typedef boost::unordered_set<LLUUID, FSUUIDHash> id_set_t;
+	// creator id -> upper case user name
+	typedef boost::unordered_map<LLUUID, std::string, FSUUIDHash> creator_name_map_t;
+
+	LLInventorySearchIndex();
+
+	// Replaces any entry with the same id.
+	void add(const Entry& entry);
+	void remove(const LLUUID& id);
+	void clear();
+
+	S32 size() const			{ return (S32)mSlots.size(); }
+	bool has(const LLUUID& id) const;
+
+	// Adds the ids of the entries with substring (upper case) in one of
+	// the fields of field_mask.  FIELD_CREATOR matches against names.
+	void find(const std::string& substring, U32 field_mask, id_set_t& ids,
+			  const creator_name_map_t* names = NULL) const;
+	// Creators of the entries, plus possibly a few whose entries were
+	// removed since the run lists were last rebuilt.
+	void getCreators(uuid_vec_t& creators) const;
+
+private:
+	// run lists for each field are keyed apart
+	enum { NUM_TEXT_FIELDS = 3 };
+
+	struct Slot
+	{
+		Entry	mEntry;
+		U32		mRunCount;	// run list references made when added
+		bool	mLive;
+	};
+
+	static void getAssetIDString(const LLUUID& id, char* out);
+	static size_t getFieldText(const Entry& entry, S32 field, const char*& text, char* buffer);
+	static void collectRuns(const char* text, size_t len, S32 field, std::vector<U32>& runs);
+	void indexSlot(U32 slot_index);
+	void rebuild();
+
+	std::vector<Slot>			mEntries;
+	std::vector<U32>			mFreeSlots;
+	boost::unordered_map<LLUUID, U32, FSUUIDHash> mSlots;
+
+	typedef boost::unordered_map<U32, std::vector<U32> > run_map_t;
+	run_map_t					mRuns;
+	typedef boost::unordered_map<LLUUID, std::vector<U32>, FSUUIDHash> creator_map_t;
+	creator_map_t				mCreators;
+
+	U32							mLiveRuns;
+	U32							mStaleRuns;
+	std::vector<U32>			mScratchRuns;
+};
+
+#endif // LL_LLINVENTORYSEARCHINDEX_H
@@ -39,6 +39,7 @@ namespace
 }
 
 const LLSettingsBase::TrackPosition LLSettingsBase::INVALID_TRACKPOS(-1.0);
+U64 LLSettingsBase::sSettingsVersion(0);
 const std::string LLSettingsBase::DEFAULT_SETTINGS_NAME("_default_");
 
 //=========================================================================
@@ -68,21 +69,29 @@ const U32 LLSettingsBase::Validator::VALIDATION_PARTIAL(0x01 << 0);
 LLSettingsBase::LLSettingsBase():
     mSettings(LLSD::emptyMap()),
     mDirty(true),
-    mBlendedFactor(0.0)
+    mBlendedFactor(0.0),
+    mSettingsVersion(++sSettingsVersion)
 {
 }
 
 LLSettingsBase::LLSettingsBase(const LLSD setting) :
     mSettings(setting),
     mDirty(true),
-    mBlendedFactor(0.0)
+    mBlendedFactor(0.0),
+    mSettingsVersion(++sSettingsVersion)
 {
 }
 
+void LLSettingsBase::shareSettings(const LLSettingsBase::ptr_t &source)
+{
+    replaceSettings(source->mSettings);
+    mSettingsVersion = source->mSettingsVersion;
+}
+
 //=========================================================================
 void LLSettingsBase::lerpSettings(const LLSettingsBase &other, F64 mix) 
 {
-    mSettings = interpolateSDMap(mSettings, other.mSettings, other.getParameterMap(), mix);
+    mSettings = blendSettings(other, mix);
     setDirtyFlag(true);
 }
 
@@ -334,6 +343,362 @@ LLSD LLSettingsBase::interpolateSDValue(const std::string& key_name, const LLSD
     return new_value;
 }
 
+//=========================================================================
+// A blend between two settings maps compiled into flat arrays.  mSlots lists
+// every key of mResult in map order (depth first), so applying the plan is a
+// lerp over mStart/mEnd followed by a single walk that writes each value in
+// place.  Compilation mirrors interpolateSDMap() and interpolateSDValue().
+class LLSettingsBase::BlendPlan
+{
+public:
+    BlendPlan(const LLSettingsBase &owner, const LLSettingsBase &other);
+
+    bool    isValid(const LLSettingsBase &owner, const LLSettingsBase &other) const
+    {
+        return (mStartVersion == owner.mSettingsVersion) && (mEndVersion == other.mSettingsVersion);
+    }
+
+    // Returns false if the shape of the result no longer matches the plan.
+    bool    apply(const LLSettingsBase &owner, BlendFactor mix);
+
+    LLSD &  getResult() { return mResult; }
+
+private:
+    enum slot_type_t
+    {
+        SLOT_CONST,         // value does not change with mix
+        SLOT_REAL,
+        SLOT_INTEGER,
+        SLOT_REALS,         // array of mCount reals
+        SLOT_QUATERNION,
+        SLOT_SWITCH,        // start or end value depending on BREAK_POINT
+        SLOT_LEGACY,        // mismatched types, defer to interpolateSDValue()
+        SLOT_MAP            // followed by the slots of its mCount keys
+    };
+
+    struct Slot
+    {
+        Slot(slot_type_t type = SLOT_CONST, S32 index = 0, S32 count = 0) : mType(type), mIndex(index), mCount(count) { }
+
+        slot_type_t mType;
+        S32         mIndex;
+        S32         mCount;
+    };
+    typedef std::vector<Slot> slot_list_t;
+
+    struct LegacyValue
+    {
+        std::string mName;
+        LLSD        mStart;
+        LLSD        mEnd;
+    };
+
+    LLSD    compileMap(const LLSD &settings, const LLSD &other, slot_list_t &slots);
+    LLSD    compileValue(const std::string &name, const LLSD &value, const LLSD &other, slot_list_t &slots);
+    S32     addReal(F32 start, F32 end);
+    bool    applyMap(const LLSettingsBase &owner, LLSD &settings, slot_list_t::const_iterator &slot, BlendFactor mix);
+
+    const parammapping_t    mDefaults;
+    const stringset_t       mSkip;
+    const stringset_t       mSlerps;
+    U64                     mStartVersion;
+    U64                     mEndVersion;
+
+    LLSD                    mResult;
+    slot_list_t             mSlots;
+    std::vector<F32>        mStart;
+    std::vector<F32>        mEnd;
+    std::vector<F32>        mValues;
+    std::vector<LLQuaternion> mQuatStart;
+    std::vector<LLQuaternion> mQuatEnd;
+    std::vector<std::pair<LLSD, LLSD> > mSwitches;
+    std::vector<LegacyValue> mLegacy;
+};
+
+LLSettingsBase::BlendPlan::BlendPlan(const LLSettingsBase &owner, const LLSettingsBase &other) :
+    mDefaults(other.getParameterMap()),
+    mSkip(owner.getSkipInterpolateKeys()),
+    mSlerps(owner.getSlerpKeys()),
+    mStartVersion(owner.mSettingsVersion),
+    mEndVersion(other.mSettingsVersion)
+{
+    slot_list_t slots;
+    mResult = compileMap(owner.mSettings, other.mSettings, slots);
+    mSlots.push_back(Slot(SLOT_MAP, 0, (S32)mResult.size()));
+    mSlots.insert(mSlots.end(), slots.begin(), slots.end());
+    mValues.resize(mStart.size());
+}
+
+S32 LLSettingsBase::BlendPlan::addReal(F32 start, F32 end)
+{
+    mStart.push_back(start);
+    mEnd.push_back(end);
+    return (S32)mStart.size() - 1;
+}
+
+LLSD LLSettingsBase::BlendPlan::compileMap(const LLSD &settings, const LLSD &other, slot_list_t &slots)
+{
+    LLSD newSettings;
+    std::map<std::string, slot_list_t> key_slots;
+
+    for (LLSD::map_const_iterator it = settings.beginMap(); it != settings.endMap(); ++it)
+    {
+        const std::string &key_name = (*it).first;
+        const LLSD &value = (*it).second;
+
+        if (mSkip.find(key_name) != mSkip.end())
+            continue;
+
+        LLSD other_value;
+        if (other.has(key_name))
+        {
+            other_value = other[key_name];
+        }
+        else
+        {
+            parammapping_t::const_iterator def_iter = mDefaults.find(key_name);
+            if (def_iter != mDefaults.end())
+            {
+                other_value = def_iter->second.getDefaultValue();
+            }
+            else if (value.type() == LLSD::TypeMap)
+            {
+                other_value = LLSDMap();
+            }
+            else
+            {
+                newSettings[key_name] = value;
+                key_slots[key_name].push_back(Slot(SLOT_CONST));
+                continue;
+            }
+        }
+
+        newSettings[key_name] = compileValue(key_name, value, other_value, key_slots[key_name]);
+    }
+
+    if (settings.has(SETTING_FLAGS))
+    {
+        U32 flags = (U32)settings[SETTING_FLAGS].asInteger();
+        if (other.has(SETTING_FLAGS))
+            flags |= (U32)other[SETTING_FLAGS].asInteger();
+
+        newSettings[SETTING_FLAGS] = LLSD::Integer(flags);
+        key_slots[SETTING_FLAGS].assign(1, Slot(SLOT_CONST));
+    }
+
+    for (LLSD::map_const_iterator it = other.beginMap(); it != other.endMap(); ++it)
+    {
+        const std::string &key_name = (*it).first;
+
+        if (mSkip.find(key_name) != mSkip.end())
+            continue;
+
+        if (settings.has(key_name))
+            continue;
+
+        parammapping_t::const_iterator def_iter = mDefaults.find(key_name);
+        if (def_iter != mDefaults.end())
+        {
+            newSettings[key_name] = compileValue(key_name, def_iter->second.getDefaultValue(), (*it).second, key_slots[key_name]);
+        }
+        else if ((*it).second.type() == LLSD::TypeMap)
+        {
+            newSettings[key_name] = compileValue(key_name, LLSDMap(), (*it).second, key_slots[key_name]);
+        }
+    }
+
+    for (LLSD::map_const_iterator it = other.beginMap(); it != other.endMap(); ++it)
+    {
+        if (mSkip.find((*it).first) == mSkip.end())
+            continue;
+
+        if (!settings.has((*it).first))
+            continue;
+
+        newSettings[(*it).first] = (*it).second;
+        key_slots[(*it).first].assign(1, Slot(SLOT_CONST));
+    }
+
+    // emit in the order applyMap() will find the keys
+    for (LLSD::map_const_iterator it = newSettings.beginMap(); it != newSettings.endMap(); ++it)
+    {
+        const slot_list_t &value_slots = key_slots[(*it).first];
+        slots.insert(slots.end(), value_slots.begin(), value_slots.end());
+    }
+
+    return newSettings;
+}
+
+LLSD LLSettingsBase::BlendPlan::compileValue(const std::string &name, const LLSD &value, const LLSD &other, slot_list_t &slots)
+{
+    LLSD::Type setting_type = value.type();
+
+    if (other.type() != setting_type)
+    {
+        LegacyValue legacy;
+        legacy.mName = name;
+        legacy.mStart = value;
+        legacy.mEnd = other;
+        mLegacy.push_back(legacy);
+        slots.push_back(Slot(SLOT_LEGACY, (S32)mLegacy.size() - 1));
+        return value;
+    }
+
+    switch (setting_type)
+    {
+        case LLSD::TypeInteger:
+            slots.push_back(Slot(SLOT_INTEGER, addReal((F32)value.asReal(), (F32)other.asReal())));
+            return value;
+
+        case LLSD::TypeReal:
+            slots.push_back(Slot(SLOT_REAL, addReal((F32)value.asReal(), (F32)other.asReal())));
+            return value;
+
+        case LLSD::TypeMap:
+        {
+            slot_list_t map_slots;
+            LLSD new_map = compileMap(value, other, map_slots);
+            if (new_map.size())
+            {
+                slots.push_back(Slot(SLOT_MAP, 0, (S32)new_map.size()));
+                slots.insert(slots.end(), map_slots.begin(), map_slots.end());
+            }
+            else
+            {   // an undefined or empty result has nothing to walk into
+                slots.push_back(Slot(SLOT_CONST));
+            }
+            return new_map;
+        }
+
+        case LLSD::TypeArray:
+        {
+            if (mSlerps.find(name) != mSlerps.end())
+            {
+                LLQuaternion a(value);
+                mQuatStart.push_back(a);
+                mQuatEnd.push_back(LLQuaternion(other));
+                slots.push_back(Slot(SLOT_QUATERNION, (S32)mQuatStart.size() - 1));
+                return a.getValue();
+            }
+
+            size_t len = std::max(value.size(), other.size());
+            if (!len)
+            {
+                slots.push_back(Slot(SLOT_CONST));
+                return LLSD::emptyArray();
+            }
+
+            LLSD new_array(LLSD::emptyArray());
+            S32 index = (S32)mStart.size();
+            for (size_t i = 0; i < len; ++i)
+            {
+                addReal((F32)value[i].asReal(), (F32)other[i].asReal());
+                new_array[i] = LLSD::Real(0.0);
+            }
+            slots.push_back(Slot(SLOT_REALS, index, (S32)len));
+            return new_array;
+        }
+
+        case LLSD::TypeUUID:
+            slots.push_back(Slot(SLOT_CONST));
+            return value.asUUID();
+
+        default:
+            mSwitches.push_back(std::make_pair(value, other));
+            slots.push_back(Slot(SLOT_SWITCH, (S32)mSwitches.size() - 1));
+            return value;
+    }
+}
+
+bool LLSettingsBase::BlendPlan::apply(const LLSettingsBase &owner, BlendFactor mix)
+{
+    F32 u = (F32)mix;
+
+    const F32 *start = mStart.empty() ? NULL : &mStart[0];
+    const F32 *end = mEnd.empty() ? NULL : &mEnd[0];
+    F32 *values = mValues.empty() ? NULL : &mValues[0];
+    const S32 count = (S32)mValues.size();
+    for (S32 i = 0; i < count; ++i)
+    {
+        values[i] = start[i] + ((end[i] - start[i]) * u);
+    }
+
+    slot_list_t::const_iterator slot = mSlots.begin();
+    return applyMap(owner, mResult, slot, mix);
+}
+
+bool LLSettingsBase::BlendPlan::applyMap(const LLSettingsBase &owner, LLSD &settings, slot_list_t::const_iterator &slot, BlendFactor mix)
+{
+    // The caller may have patched the previous result.  Bail out if that
+    // changed the shape of the map rather than just its values.
+    const Slot &map_slot = *slot++;
+    if (settings.size() != (size_t)map_slot.mCount)
+        return false;
+    if (!map_slot.mCount)
+        return true;    // don't turn an undefined result into a map
+
+    for (LLSD::map_iterator it = settings.beginMap(); it != settings.endMap(); ++it)
+    {
+        const Slot &cur = *slot;
+        LLSD &value = (*it).second;
+
+        switch (cur.mType)
+        {
+        case SLOT_REAL:
+            value = LLSD::Real(mValues[cur.mIndex]);
+            break;
+        case SLOT_INTEGER:
+            value = LLSD::Integer(llroundf(mValues[cur.mIndex]));
+            break;
+        case SLOT_REALS:
+            for (S32 i = 0; i < cur.mCount; ++i)
+            {
+                value[i] = LLSD::Real(mValues[cur.mIndex + i]);
+            }
+            break;
+        case SLOT_QUATERNION:
+        {
+            LLQuaternion q = slerp((F32)mix, mQuatStart[cur.mIndex], mQuatEnd[cur.mIndex]);
+            for (S32 i = 0; i < 4; ++i)
+            {
+                value[i] = LLSD::Real(q.mQ[i]);
+            }
+            break;
+        }
+        case SLOT_SWITCH:
+            value = (mix > BREAK_POINT) ? mSwitches[cur.mIndex].second : mSwitches[cur.mIndex].first;
+            break;
+        case SLOT_LEGACY:
+        {
+            const LegacyValue &legacy = mLegacy[cur.mIndex];
+            value = owner.interpolateSDValue(legacy.mName, legacy.mStart, legacy.mEnd, mDefaults, mix, mSlerps);
+            break;
+        }
+        case SLOT_MAP:
+            if (!applyMap(owner, value, slot, mix))
+                return false;
+            continue;   // applyMap() advanced past the nested slots
+        case SLOT_CONST:
+        default:
+            break;
+        }
+        ++slot;
+    }
+    return true;
+}
+
+LLSD & LLSettingsBase::blendSettings(const LLSettingsBase &other, BlendFactor mix)
+{
+    llassert(mix >= 0.0f && mix <= 1.0f);
+
+    if (!mBlendPlan || !mBlendPlan->isValid(*this, other) || !mBlendPlan->apply(*this, mix))
+    {
+        mBlendPlan = PTR_NAMESPACE::make_shared<BlendPlan>(*this, other);
+        mBlendPlan->apply(*this, mix);
+    }
+    return mBlendPlan->getResult();
+}
+
 LLSettingsBase::stringset_t LLSettingsBase::getSkipInterpolateKeys() const
 {
     static stringset_t skipSet;
@@ -380,6 +745,7 @@ bool LLSettingsBase::validate()
     }
 
     LLSD result = LLSettingsBase::settingValidation(mSettings, validations);
+    touchSettings();
 
     if (result["errors"].size() > 0)
     {
@@ -700,7 +1066,7 @@ F64 LLSettingsBlender::setBlendFactor(const LLSettingsBase::BlendFactor& blendf_
 
     if (mTarget)
     {
-        mTarget->replaceSettings(mInitial->getSettings());
+        mTarget->shareSettings(mInitial);
         mTarget->blend(mFinal, blendf);
     }
     else
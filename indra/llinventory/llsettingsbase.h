@@ -54,6 +54,7 @@ class LLSettingsBase :
 {
     friend class LLEnvironment;
     friend class LLSettingsDay;
+    class BlendPlan;
 
     friend std::ostream &operator <<(std::ostream& os, LLSettingsBase &settings);
 
@@ -108,7 +109,7 @@ public:
     inline bool hasSetting(const std::string &param) const { return mSettings.has(param); }
     virtual bool isDirty() const { return mDirty; }
     virtual bool isVeryDirty() const { return mReplaced; }
-    inline void setDirtyFlag(bool dirty) { mDirty = dirty; clearAssetId(); }
+    inline void setDirtyFlag(bool dirty) { mDirty = dirty; clearAssetId(); touchSettings(); }
 
     size_t getHash() const; // Hash will not include Name, ID or a previously stored Hash
 
@@ -163,6 +164,7 @@ public:
             mSettings[SETTING_FLAGS] = LLSD::Integer(flags);
         else
             mSettings.erase(SETTING_FLAGS);
+        touchSettings();
     }
 
     inline void clearFlag(U32 flag)
@@ -175,6 +177,7 @@ public:
             mSettings[SETTING_FLAGS] = LLSD::Integer(flags);
         else
             mSettings.erase(SETTING_FLAGS);
+        touchSettings();
     }
 
     virtual void replaceSettings(LLSD settings)
@@ -185,6 +188,10 @@ public:
         mSettings = settings;
     }
 
+    // Same as replaceSettings(source->getSettings()) but anything compiled
+    // from the source's settings (see blendSettings()) stays valid.
+    void shareSettings(const ptr_t &source);
+
     virtual LLSD getSettings() const;
 
     //---------------------------------------------------------------------
@@ -195,6 +202,7 @@ public:
         mDirty = true;
         if (name != SETTING_ASSETID)
             clearAssetId();
+        touchSettings();
     }
 
     inline void setValue(const std::string &name, const LLSD &value)
@@ -311,12 +319,16 @@ public:
     inline void setAssetId(LLUUID value)
     {   // note that this skips setLLSD
         mSettings[SETTING_ASSETID] = value;
+        touchSettings();
     }
 
     inline void clearAssetId()
     {
         if (mSettings.has(SETTING_ASSETID))
+        {
             mSettings.erase(SETTING_ASSETID);
+            touchSettings();
+        }
     }
 
     // Calculate any custom settings that may need to be cached.
@@ -342,6 +354,14 @@ protected:
     LLSD    interpolateSDMap(const LLSD &settings, const LLSD &other, const parammapping_t& defaults, BlendFactor mix) const;
     LLSD    interpolateSDValue(const std::string& name, const LLSD &value, const LLSD &other, const parammapping_t& defaults, BlendFactor mix, const stringset_t& slerps) const;
 
+    // Same result as interpolateSDMap(mSettings, other.mSettings, other.getParameterMap(), mix).
+    // The first call for a pair of settings compiles both into flat arrays of
+    // reals and quaternions; later calls only lerp/slerp those and write the
+    // results into the returned map in place, until either side is touched.
+    // Callers may overwrite values in the returned map (e.g. skipped keys)
+    // before handing it to replaceSettings(), but must not add or remove keys.
+    LLSD &  blendSettings(const LLSettingsBase &other, BlendFactor mix);
+
     /// when lerping between settings, some may require special handling.  
     /// Get a list of these key to be skipped by the default settings lerp.
     /// (handling should be performed in the override of lerpSettings.
@@ -358,8 +378,12 @@ protected:
 
     virtual parammapping_t getParameterMap() const { return parammapping_t(); }
 
+    // Anything writing mSettings directly must call touchSettings() (setLLSD,
+    // replaceSettings and setDirtyFlag do) so that cached blends are rebuilt.
     LLSD        mSettings;
 
+    inline void touchSettings() { mSettingsVersion = ++sSettingsVersion; }
+
     LLSD        cloneSettings() const;
 
     inline void setBlendFactor(BlendFactor blendfactor) 
@@ -380,6 +404,12 @@ private:
     LLSD        combineSDMaps(const LLSD &first, const LLSD &other) const;
 
     BlendFactor mBlendedFactor;
+
+    // Unique across all settings objects, so equal versions mean equal settings.
+    U64         mSettingsVersion;
+    static U64  sSettingsVersion;
+
+    PTR_NAMESPACE::shared_ptr<BlendPlan> mBlendPlan;
 };
 
 
@@ -471,6 +471,7 @@ void LLSettingsSky::blend(const LLSettingsBase::ptr_t &end, F64 blendf)
                 // We are free to change mSettings, since we are about to reset it
                 mSettings[SETTING_AMBIENT] = getAmbientColor().getValue();
                 mSettings[SETTING_LEGACY_HAZE].erase(SETTING_AMBIENT);
+                touchSettings();
             }
         }
 
@@ -497,7 +498,7 @@ void LLSettingsSky::blend(const LLSettingsBase::ptr_t &end, F64 blendf)
             cloud_shadow = lerp(mSettings[SETTING_CLOUD_SHADOW].asReal(), other->mSettings[SETTING_CLOUD_SHADOW].asReal(), blendf);
         }
 
-        LLSD blenddata = interpolateSDMap(mSettings, other->mSettings, other->getParameterMap(), blendf);
+        LLSD &blenddata = blendSettings(*other, blendf);
         blenddata[SETTING_CLOUD_SHADOW] = LLSD::Real(cloud_shadow);
         replaceSettings(blenddata);
         mNextSunTextureId = other->getSunTextureId();
@@ -1101,21 +1102,25 @@ F32 LLSettingsSky::getDistanceMultiplier() const
 void LLSettingsSky::setPlanetRadius(F32 radius)
 {
     mSettings[SETTING_PLANET_RADIUS] = radius;
+    touchSettings();
 }
 
 void LLSettingsSky::setSkyBottomRadius(F32 radius)
 {
     mSettings[SETTING_SKY_BOTTOM_RADIUS] = radius;
+    touchSettings();
 }
 
 void LLSettingsSky::setSkyTopRadius(F32 radius)
 {
     mSettings[SETTING_SKY_TOP_RADIUS] = radius;
+    touchSettings();
 }
 
 void LLSettingsSky::setSunArcRadians(F32 radians)
 {
     mSettings[SETTING_SUN_ARC_RADIANS] = radians;
+    touchSettings();
 }
 
 void LLSettingsSky::setMieAnisotropy(F32 aniso_factor)
@@ -1474,16 +1479,19 @@ LLSD LLSettingsSky::getAbsorptionConfigs() const
 void LLSettingsSky::setRayleighConfigs(const LLSD& rayleighConfig)
 {
     mSettings[SETTING_RAYLEIGH_CONFIG] = rayleighConfig;
+    touchSettings();
 }
 
 void LLSettingsSky::setMieConfigs(const LLSD& mieConfig)
 {
     mSettings[SETTING_MIE_CONFIG] = mieConfig;
+    touchSettings();
 }
 
 void LLSettingsSky::setAbsorptionConfigs(const LLSD& absorptionConfig)
 {
     mSettings[SETTING_ABSORPTION_CONFIG] = absorptionConfig;
+    touchSettings();
 }
 
 LLUUID LLSettingsSky::getBloomTextureId() const
@@ -0,0 +1,229 @@
+/**
+ * @file llinventorycache_test.cpp
+ * @brief Round trip tests for the binary inventory cache.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinventory.h"
+#include "../llinventorycache.h"
+#include "llfile.h"
+#include "llsd.h"
+#include "llsdutil.h"
+#include "llsys.h"
+#include "../test/lltut.h"
+
+static LLPointer<LLInventoryItem> make_item(const LLUUID& parent_id, PermissionMask base,
+											LLAssetType::EType type, LLInventoryType::EType inv_type,
+											const std::string& name, const std::string& desc)
+{
+	LLUUID item_id, creator_id, owner_id, last_owner_id, group_id, asset_id;
+	item_id.generate();
+	creator_id.generate();
+	owner_id.generate();
+	last_owner_id.generate();
+	group_id.generate();
+	asset_id.generate();
+	LLPermissions perm;
+	perm.init(creator_id, owner_id, last_owner_id, group_id);
+	perm.initMasks(base, base, PERM_COPY, PERM_COPY, PERM_MODIFY | PERM_COPY);
+	LLSaleInfo sale_info(LLSaleInfo::FS_COPY, 42);
+	return new LLInventoryItem(item_id, parent_id, perm, asset_id, type, inv_type,
+							   name, desc, sale_info, 0x1234, 1700000000);
+}
+
+namespace tut
+{
+	struct inventorycache_data
+	{
+		std::string mFilename;
+
+		inventorycache_data()
+		{
+			LLUUID random;
+			random.generate();
+			mFilename = STRINGIZE(LLFile::tmpdir() << "llinventorycache-test-" << random << ".inv.bin.gz");
+		}
+
+		~inventorycache_data()
+		{
+			LLFile::remove(mFilename);
+		}
+	};
+	typedef test_group<inventorycache_data> inventorycache_test;
+	typedef inventorycache_test::object inventorycache_object;
+	tut::inventorycache_test invcache("LLInventoryCacheFile");
+
+	// items and categories survive a round trip exactly as asLLSD()/fromLLSD() would carry them
+	template<> template<>
+	void inventorycache_object::test<1>()
+	{
+		LLUUID cat_id, parent_id, owner_id;
+		cat_id.generate();
+		parent_id.generate();
+		owner_id.generate();
+		LLPointer<LLInventoryCategory> cat =
+			new LLInventoryCategory(cat_id, parent_id, LLFolderType::FT_LANDMARK, "Landmarks");
+
+		std::vector<LLPointer<LLInventoryItem> > items;
+		items.push_back(make_item(cat_id, PERM_ALL, LLAssetType::AT_OBJECT,
+								  LLInventoryType::IT_ATTACHMENT, "Sample Object", "Used for Testing"));
+		// no transfer: asset id is shadowed on disk
+		items.push_back(make_item(cat_id, PERM_MOVE | PERM_COPY, LLAssetType::AT_NOTECARD,
+								  LLInventoryType::IT_NOTECARD, "Restricted", ""));
+		// mismatched inventory type gets reset like fromLLSD() does
+		items.push_back(make_item(cat_id, PERM_ALL, LLAssetType::AT_LANDMARK,
+								  LLInventoryType::IT_TEXTURE, "Bad|Type", "x"));
+
+		LLInventoryCacheFile writer;
+		writer.setCacheVersion(7);
+		writer.addCategory(cat, owner_id, 12);
+		for (size_t i = 0; i < items.size(); ++i)
+		{
+			writer.addItem(items[i]);
+		}
+		ensure("save", writer.save(mFilename));
+
+		LLInventoryCacheFile reader;
+		ensure_equals("load", reader.load(mFilename), LLInventoryCacheFile::LOAD_OK);
+		ensure_equals("cache version", reader.getCacheVersion(), 7);
+		ensure_equals("category count", reader.getCategoryCount(), 1);
+		ensure_equals("item count", reader.getItemCount(), (S32)items.size());
+
+		LLPointer<LLInventoryCategory> cat2 = new LLInventoryCategory(LLUUID::null, LLUUID::null, LLFolderType::FT_NONE, "");
+		reader.getCategory(0, cat2);
+		ensure_equals("cat id", cat2->getUUID(), cat_id);
+		ensure_equals("cat parent", cat2->getParentUUID(), parent_id);
+		ensure_equals("cat name", cat2->getName(), std::string("Landmarks"));
+		ensure_equals("cat preferred type", cat2->getPreferredType(), LLFolderType::FT_LANDMARK);
+		ensure_equals("cat owner", reader.getCategoryOwner(0), owner_id);
+		ensure_equals("cat version", reader.getCategoryVersion(0), 12);
+
+		for (S32 i = 0; i < (S32)items.size(); ++i)
+		{
+			LLPointer<LLInventoryItem> expected = new LLInventoryItem;
+			expected->fromLLSD(items[i]->asLLSD());
+			LLPointer<LLInventoryItem> actual = new LLInventoryItem;
+			reader.getItem(i, actual);
+			ensure("item llsd", llsd_equals(actual->asLLSD(), expected->asLLSD()));
+			ensure_equals("asset id", actual->getAssetUUID(), items[i]->getAssetUUID());
+		}
+		LLPointer<LLInventoryItem> fixed = new LLInventoryItem;
+		reader.getItem(2, fixed);
+		ensure_equals("inventory type reset", fixed->getInventoryType(), LLInventoryType::IT_LANDMARK);
+		ensure_equals("pipe stripped", fixed->getName(), std::string("Bad Type"));
+	}
+
+	// index lookups
+	template<> template<>
+	void inventorycache_object::test<2>()
+	{
+		LLUUID root_id;
+		root_id.generate();
+		LLInventoryCacheFile writer;
+		std::vector<LLUUID> cat_ids, item_ids;
+		for (S32 i = 0; i < 50; ++i)
+		{
+			LLUUID id;
+			id.generate();
+			cat_ids.push_back(id);
+			LLPointer<LLInventoryCategory> cat =
+				new LLInventoryCategory(id, root_id, LLFolderType::FT_NONE, STRINGIZE("folder " << i));
+			writer.addCategory(cat, root_id, i);
+		}
+		for (S32 i = 0; i < 500; ++i)
+		{
+			LLPointer<LLInventoryItem> item = make_item(cat_ids[i % cat_ids.size()], PERM_ALL,
+				LLAssetType::AT_TEXTURE, LLInventoryType::IT_TEXTURE, STRINGIZE("item " << i), "");
+			item_ids.push_back(item->getUUID());
+			writer.addItem(item);
+		}
+		ensure("save", writer.save(mFilename));
+
+		LLInventoryCacheFile reader;
+		ensure_equals("load", reader.load(mFilename), LLInventoryCacheFile::LOAD_OK);
+		for (S32 i = 0; i < (S32)cat_ids.size(); ++i)
+		{
+			ensure_equals("find category", reader.findCategory(cat_ids[i]), i);
+			ensure_equals("category is not an item", reader.findItem(cat_ids[i]), -1);
+		}
+		for (S32 i = 0; i < (S32)item_ids.size(); ++i)
+		{
+			ensure_equals("find item", reader.findItem(item_ids[i]), i);
+		}
+		LLUUID missing;
+		missing.generate();
+		ensure_equals("missing id", reader.findItem(missing), -1);
+	}
+
+	// anything that is not a complete binary image is refused
+	template<> template<>
+	void inventorycache_object::test<3>()
+	{
+		LLInventoryCacheFile reader;
+		ensure_equals("missing file", reader.load(mFilename), LLInventoryCacheFile::LOAD_NO_FILE);
+
+		// an old notation cache
+		std::string notation("{'inv_cache_version':i2}\n");
+		ensure("write notation",
+			   gzip_buffer_to_file((const U8*)notation.data(), notation.size(), mFilename));
+		ensure_equals("notation cache", reader.load(mFilename), LLInventoryCacheFile::LOAD_NOT_BINARY);
+
+		LLInventoryCacheFile writer;
+		for (S32 i = 0; i < 10; ++i)
+		{
+			LLUUID id;
+			id.generate();
+			writer.addItem(make_item(id, PERM_ALL, LLAssetType::AT_TEXTURE,
+									 LLInventoryType::IT_TEXTURE, "texture", "desc"));
+		}
+		ensure("save", writer.save(mFilename));
+		std::vector<U8> image;
+		ensure("gunzip", gunzip_file_to_buffer(mFilename, image));
+
+		std::vector<U8> truncated(image.begin(), image.end() - 1);
+		ensure_equals("truncated", reader.loadFromBuffer(truncated), LLInventoryCacheFile::LOAD_CORRUPT);
+
+		std::vector<U8> bad_version(image);
+		LLInventoryCacheFile::Header* header = reinterpret_cast<LLInventoryCacheFile::Header*>(&bad_version[0]);
+		header->mFormatVersion = LLInventoryCacheFile::FORMAT_VERSION + 1;
+		ensure_equals("format version", reader.loadFromBuffer(bad_version), LLInventoryCacheFile::LOAD_BAD_FORMAT);
+
+		std::vector<U8> bad_string(image);
+		header = reinterpret_cast<LLInventoryCacheFile::Header*>(&bad_string[0]);
+		LLInventoryCacheFile::ItemRecord* rec =
+			reinterpret_cast<LLInventoryCacheFile::ItemRecord*>(&bad_string[header->mItemOffset]);
+		rec[3].mDescription.mLength = header->mStringPoolSize + 1;
+		ensure_equals("string range", reader.loadFromBuffer(bad_string), LLInventoryCacheFile::LOAD_CORRUPT);
+
+		std::vector<U8> misaligned(image);
+		header = reinterpret_cast<LLInventoryCacheFile::Header*>(&misaligned[0]);
+		header->mItemOffset += 2;
+		ensure_equals("misaligned records", reader.loadFromBuffer(misaligned), LLInventoryCacheFile::LOAD_CORRUPT);
+
+		std::vector<U8> good(image);
+		ensure_equals("intact image", reader.loadFromBuffer(good), LLInventoryCacheFile::LOAD_OK);
+		ensure_equals("intact item count", reader.getItemCount(), 10);
+	}
+}
@@ -0,0 +1,195 @@
+/**
+ * @file llinventorysearchindex_test.cpp
+ * @brief Tests for the inventory substring index.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llinventorysearchindex.h"
+#include "llstring.h"
+#include "stringize.h"
+#include "../test/lltut.h"
+
+typedef LLInventorySearchIndex::id_set_t id_set_t;
+
+static LLInventorySearchIndex::Entry make_entry(const std::string& name, const std::string& desc,
+												const LLUUID& creator_id = LLUUID::null)
+{
+	LLInventorySearchIndex::Entry entry;
+	entry.mID.generate();
+	entry.mAssetID.generate();
+	entry.mCreatorID = creator_id;
+	entry.mName = name;
+	entry.mDescription = desc;
+	LLStringUtil::toUpper(entry.mName);
+	LLStringUtil::toUpper(entry.mDescription);
+	return entry;
+}
+
+// what LLInventoryFilter::check() would find by looking at every entry
+static id_set_t brute_force(const std::vector<LLInventorySearchIndex::Entry>& entries,
+							const std::string& substring, U32 field_mask)
+{
+	id_set_t ids;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		std::string asset_id = entries[i].mAssetID.asString();
+		LLStringUtil::toUpper(asset_id);
+		if (((field_mask & LLInventorySearchIndex::FIELD_NAME) && entries[i].mName.find(substring) != std::string::npos)
+			|| ((field_mask & LLInventorySearchIndex::FIELD_DESCRIPTION) && entries[i].mDescription.find(substring) != std::string::npos)
+			|| ((field_mask & LLInventorySearchIndex::FIELD_ASSET_ID) && asset_id.find(substring) != std::string::npos))
+		{
+			ids.insert(entries[i].mID);
+		}
+	}
+	return ids;
+}
+
+namespace tut
+{
+	struct inventorysearchindex_data
+	{
+	};
+	typedef test_group<inventorysearchindex_data> inventorysearchindex_test;
+	typedef inventorysearchindex_test::object inventorysearchindex_object;
+	tut::inventorysearchindex_test invsearchindex("LLInventorySearchIndex");
+
+	// finds exactly what a linear substring search finds, for short and long strings
+	template<> template<>
+	void inventorysearchindex_object::test<1>()
+	{
+		static const char* WORDS[] = { "Red", "Shirt", "Mesh", "Hair", "Boots", "Tree", "Sky", "Hud", "Full Perm", "a" };
+		static const S32 WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+		LLInventorySearchIndex index;
+		std::vector<LLInventorySearchIndex::Entry> entries;
+		U32 seed = 13;
+		for (S32 i = 0; i < 500; ++i)
+		{
+			seed = seed * 1664525 + 1013904223;
+			std::string name = std::string(WORDS[(seed >> 8) % WORD_COUNT]) + " " + WORDS[(seed >> 16) % WORD_COUNT];
+			std::string desc = (i % 3) ? std::string() : std::string(WORDS[(seed >> 4) % WORD_COUNT]);
+			entries.push_back(make_entry(name, desc));
+			index.add(entries.back());
+		}
+		ensure_equals("size", index.size(), 500);
+
+		static const char* QUERIES[] = { "A", "RE", "SHIRT", "D SH", "MESH HAIR", "FULL PERM", "NOPE", "-" };
+		for (size_t q = 0; q < sizeof(QUERIES) / sizeof(QUERIES[0]); ++q)
+		{
+			for (U32 mask = 1; mask <= LLInventorySearchIndex::FIELD_ASSET_ID; mask = mask * 2 + 1)
+			{
+				id_set_t found;
+				index.find(QUERIES[q], mask, found);
+				ensure(STRINGIZE("query " << QUERIES[q] << " mask " << mask),
+					   found == brute_force(entries, QUERIES[q], mask));
+			}
+		}
+
+		// part of an asset id
+		std::string asset_id = entries[42].mAssetID.asString().substr(9, 8);
+		LLStringUtil::toUpper(asset_id);
+		id_set_t found;
+		index.find(asset_id, LLInventorySearchIndex::FIELD_ASSET_ID, found);
+		ensure("asset id", found.count(entries[42].mID) == 1);
+	}
+
+	// replacing and removing entries
+	template<> template<>
+	void inventorysearchindex_object::test<2>()
+	{
+		LLInventorySearchIndex index;
+		LLInventorySearchIndex::Entry entry = make_entry("Blue Dress", "");
+		index.add(entry);
+
+		id_set_t found;
+		index.find("BLUE", LLInventorySearchIndex::FIELD_NAME, found);
+		ensure_equals("found before rename", found.size(), 1);
+
+		entry.mName = "GREEN DRESS";
+		index.add(entry);
+		ensure_equals("rename keeps one entry", index.size(), 1);
+		found.clear();
+		index.find("BLUE", LLInventorySearchIndex::FIELD_NAME, found);
+		ensure("old name is gone", found.empty());
+		index.find("GREEN", LLInventorySearchIndex::FIELD_NAME, found);
+		ensure_equals("new name", found.size(), 1);
+
+		// the freed slot gets reused by an entry that shares none of the text
+		index.remove(entry.mID);
+		ensure("removed", !index.has(entry.mID));
+		LLInventorySearchIndex::Entry other = make_entry("Hat", "");
+		index.add(other);
+		found.clear();
+		index.find("DRESS", LLInventorySearchIndex::FIELD_NAME, found);
+		ensure("reused slot does not match stale runs", found.empty());
+
+		// enough churn to force the run lists to be rebuilt
+		for (S32 i = 0; i < 20000; ++i)
+		{
+			LLInventorySearchIndex::Entry temp = make_entry(STRINGIZE("temporary item " << i), "scratch");
+			index.add(temp);
+			index.remove(temp.mID);
+		}
+		found.clear();
+		index.find("TEMPORARY", LLInventorySearchIndex::FIELD_ALL, found);
+		ensure("churned entries are gone", found.empty());
+		index.find("HAT", LLInventorySearchIndex::FIELD_NAME, found);
+		ensure("survivor is still found", found.size() == 1 && found.count(other.mID));
+	}
+
+	// creators are matched through the names handed in
+	template<> template<>
+	void inventorysearchindex_object::test<3>()
+	{
+		LLUUID alice, bob;
+		alice.generate();
+		bob.generate();
+		LLInventorySearchIndex index;
+		LLInventorySearchIndex::Entry a1 = make_entry("Chair", "", alice);
+		LLInventorySearchIndex::Entry a2 = make_entry("Table", "", alice);
+		LLInventorySearchIndex::Entry b1 = make_entry("Lamp", "", bob);
+		index.add(a1);
+		index.add(a2);
+		index.add(b1);
+
+		uuid_vec_t creators;
+		index.getCreators(creators);
+		ensure_equals("creators", creators.size(), 2);
+
+		LLInventorySearchIndex::creator_name_map_t names;
+		names[alice] = "ALICE.RESIDENT";
+		id_set_t found;
+		index.find("ALICE", LLInventorySearchIndex::FIELD_CREATOR, found, &names);
+		ensure("alice's items", found.size() == 2 && found.count(a1.mID) && found.count(a2.mID));
+
+		// bob's name isn't known yet, so nothing matches him
+		found.clear();
+		index.find("BOB", LLInventorySearchIndex::FIELD_CREATOR, found, &names);
+		ensure("unknown name", found.empty());
+		names[bob] = "BOB.RESIDENT";
+		index.find("RESIDENT", LLInventorySearchIndex::FIELD_CREATOR, found, &names);
+		ensure_equals("everybody", found.size(), 3);
+	}
+}
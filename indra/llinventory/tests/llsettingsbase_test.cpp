@@ -0,0 +1,242 @@
+/**
+ * @file llsettingsbase_test.cpp
+ * @brief Compares compiled settings blends with the LLSD interpolation.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llsettingsbase.h"
+
+#include "llsdutil.h"
+#include "llsdserialize.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+    class LLTestSettings : public LLSettingsBase
+    {
+    public:
+        typedef PTR_NAMESPACE::shared_ptr<LLTestSettings> ptr_t;
+
+        LLTestSettings(const LLSD &settings) : LLSettingsBase(settings) { }
+
+        virtual std::string getSettingsType() const SETTINGS_OVERRIDE { return std::string("test"); }
+        virtual LLSettingsType::type_e getSettingsTypeValue() const SETTINGS_OVERRIDE { return LLSettingsType::ST_SKY; }
+
+        virtual void blend(const LLSettingsBase::ptr_t &end, BlendFactor blendf) SETTINGS_OVERRIDE
+        {
+            replaceSettings(blendSettings(*end, blendf));
+        }
+
+        virtual LLSettingsBase::ptr_t buildDerivedClone() const SETTINGS_OVERRIDE
+        {
+            return LLSettingsBase::ptr_t(new LLTestSettings(cloneSettings()));
+        }
+
+        virtual validation_list_t getValidationList() const SETTINGS_OVERRIDE { return validation_list_t(); }
+
+        virtual stringset_t getSlerpKeys() const SETTINGS_OVERRIDE
+        {
+            stringset_t slerps;
+            slerps.insert("sun_rotation");
+            return slerps;
+        }
+
+        virtual parammapping_t getParameterMap() const SETTINGS_OVERRIDE
+        {
+            parammapping_t defaults;
+            defaults["star_brightness"] = DefaultParam(0, LLSD::Real(250.0));
+            return defaults;
+        }
+
+        LLSD legacyBlend(const LLTestSettings &other, BlendFactor mix) const
+        {
+            return interpolateSDMap(mSettings, other.mSettings, other.getParameterMap(), mix);
+        }
+
+        LLSD &compiledBlend(const LLTestSettings &other, BlendFactor mix)
+        {
+            return blendSettings(other, mix);
+        }
+    };
+
+    LLSD start_settings()
+    {
+        LLSD haze;
+        haze["haze_density"] = LLSD::Real(0.7);
+        haze["blue_horizon"] = LLColor3(0.2f, 0.4f, 0.6f).getValue();
+
+        LLSD settings;
+        settings["name"] = "dawn";
+        settings["hash"] = LLSD::Integer(42);
+        settings["flags"] = LLSD::Integer(LLSettingsBase::FLAG_NOCOPY);
+        settings["gamma"] = LLSD::Real(1.0);
+        settings["max_y"] = LLSD::Integer(605);
+        settings["sunlight_color"] = LLColor4(0.7f, 0.7f, 0.2f, 1.0f).getValue();
+        settings["cloud_scroll_rate"] = LLVector2(0.2f, 0.01f).getValue();
+        settings["sun_rotation"] = LLQuaternion(F_PI_BY_TWO, LLVector3::y_axis).getValue();
+        settings["cloud_id"] = LLUUID("fe0d6bb8-a2de-4a0f-b2a8-3d1f4bbd82d5");
+        settings["legacy_haze"] = haze;
+        settings["enabled"] = LLSD::Boolean(true);
+        settings["only_in_start"] = LLSD::Real(3.0);
+        return settings;
+    }
+
+    LLSD end_settings()
+    {
+        LLSD haze;
+        haze["haze_density"] = LLSD::Real(2.0);
+        haze["blue_horizon"] = LLColor3(0.9f, 0.1f, 0.3f).getValue();
+        haze["haze_horizon"] = LLSD::Real(0.5);
+
+        LLSD settings;
+        settings["name"] = "noon";
+        settings["hash"] = LLSD::Integer(7);
+        settings["flags"] = LLSD::Integer(LLSettingsBase::FLAG_NOMOD);
+        settings["gamma"] = LLSD::Real(2.5);
+        settings["max_y"] = LLSD::Integer(1000);
+        settings["sunlight_color"] = LLColor4(1.0f, 0.9f, 0.8f, 1.0f).getValue();
+        settings["cloud_scroll_rate"] = LLVector2(0.5f, 0.4f).getValue();
+        settings["sun_rotation"] = LLQuaternion(F_PI, LLVector3::z_axis).getValue();
+        settings["cloud_id"] = LLUUID("1dc1368f-e8fe-f02d-a08d-9d9f11c1af6b");
+        settings["legacy_haze"] = haze;
+        settings["enabled"] = LLSD::Boolean(false);
+        settings["star_brightness"] = LLSD::Real(100.0);
+        return settings;
+    }
+}
+
+namespace tut
+{
+    struct llsettingsbase_data
+    {
+        llsettingsbase_data() :
+            mStart(new LLTestSettings(start_settings())),
+            mEnd(new LLTestSettings(end_settings()))
+        {
+        }
+
+        void ensure_blend_matches(const std::string &msg, LLTestSettings::ptr_t start, LLTestSettings::ptr_t end, F64 mix)
+        {
+            LLSD legacy = start->legacyBlend(*end, mix);
+            LLSD compiled = start->compiledBlend(*end, mix);
+
+            std::ostringstream str;
+            str << msg << " at " << mix << ": " << compiled << " != " << legacy;
+            ensure(str.str(), llsd_equals(compiled, legacy, 16));
+        }
+
+        LLTestSettings::ptr_t mStart;
+        LLTestSettings::ptr_t mEnd;
+    };
+    typedef test_group<llsettingsbase_data> llsettingsbase_test;
+    typedef llsettingsbase_test::object llsettingsbase_object;
+    tut::llsettingsbase_test tut_llsettingsbase("LLSettingsBase");
+
+    template<> template<>
+    void llsettingsbase_object::test<1>()
+    {
+        set_test_name("compiled blend matches interpolateSDMap");
+
+        // repeat the sweep so later passes reuse the compiled plan
+        for (S32 pass = 0; pass < 2; ++pass)
+        {
+            for (S32 step = 0; step <= 8; ++step)
+            {
+                ensure_blend_matches("start to end", mStart, mEnd, step / 8.0);
+            }
+        }
+
+        for (S32 step = 0; step <= 8; ++step)
+        {
+            ensure_blend_matches("end to start", mEnd, mStart, step / 8.0);
+        }
+    }
+
+    template<> template<>
+    void llsettingsbase_object::test<2>()
+    {
+        set_test_name("compiled blend follows changes to either side");
+
+        ensure_blend_matches("before change", mStart, mEnd, 0.25);
+
+        mEnd->setValue("gamma", 4.0f);
+        ensure_blend_matches("end changed", mStart, mEnd, 0.25);
+
+        // a new key changes the shape of the result
+        mStart->setValue("density_multiplier", 0.0003f);
+        ensure_blend_matches("start changed", mStart, mEnd, 0.25);
+
+        mStart->replaceSettings(end_settings());
+        ensure_blend_matches("start replaced", mStart, mEnd, 0.75);
+    }
+
+    template<> template<>
+    void llsettingsbase_object::test<3>()
+    {
+        set_test_name("compiled blend leaves its inputs alone");
+
+        LLSD start_copy = llsd_clone(mStart->getSettings());
+        LLSD end_copy = llsd_clone(mEnd->getSettings());
+
+        // blend the way LLSettingsBlender does, keeping a result between ticks
+        LLTestSettings::ptr_t target(new LLTestSettings(LLSD::emptyMap()));
+        LLSD held;
+        for (S32 step = 0; step <= 4; ++step)
+        {
+            target->shareSettings(mStart);
+            target->blend(mEnd, step / 4.0);
+            if (step == 2)
+            {
+                held = target->getSettings();
+            }
+        }
+
+        ensure("start untouched", llsd_equals(mStart->getSettings(), start_copy));
+        ensure("end untouched", llsd_equals(mEnd->getSettings(), end_copy));
+        ensure("held result untouched", llsd_equals(held, mStart->legacyBlend(*mEnd, 0.5), 16));
+        ensure("final result", llsd_equals(target->getSettings(), mStart->legacyBlend(*mEnd, 1.0), 16));
+    }
+
+    template<> template<>
+    void llsettingsbase_object::test<4>()
+    {
+        set_test_name("patched results and mismatched types");
+
+        // overwriting a value in the result must not stick to the next blend
+        LLSD &result = mStart->compiledBlend(*mEnd, 0.5);
+        result["gamma"] = LLSD::Real(-1.0);
+        ensure_blend_matches("after patch", mStart, mEnd, 0.5);
+
+        // adding a key invalidates the plan rather than misaligning it
+        LLSD &patched = mStart->compiledBlend(*mEnd, 0.5);
+        patched["cloud_shadow"] = LLSD::Real(0.5);
+        ensure_blend_matches("after added key", mStart, mEnd, 0.5);
+
+        // integer on one side, real on the other
+        mEnd->setValue("max_y", 800.5f);
+        ensure_blend_matches("mismatched types", mStart, mEnd, 0.3);
+    }
+}
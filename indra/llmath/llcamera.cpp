@@ -29,6 +29,10 @@
 #include "llmath.h"
 #include "llcamera.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
 // ---------------- Constructors and destructors ----------------
 
 LLCamera::LLCamera() :
@@ -296,6 +300,131 @@ S32 LLCamera::AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVec
 	return AABBInFrustumNoFarClip(center, radius, mRegionPlanes);
 }
 
+// Same arithmetic as AABBInFrustum() in the same order, just with each
+// register lane holding a different box, so the results match exactly.
+void LLCamera::AABBInFrustum(const LLAABBBatch& boxes, S32* results, const LLPlane* planes, bool far_clip)
+{
+	if(!planes)
+	{
+		//use agent space
+		planes = mAgentPlanes;
+	}
+
+	const S32 count = boxes.getCount();
+	U32 max_planes = llmin(mPlaneCount, (U32) AGENT_PLANE_USER_CLIP_NUM);		// mAgentPlanes[] size is 7
+
+#if defined(__AVX__)
+	const S32 width = 8;
+#else
+	const S32 width = 4;
+#endif
+
+	for (S32 base = 0; base < count; base += width)
+	{
+		const S32 valid = (1 << llmin(width, count - base)) - 1;
+
+#if defined(__AVX__)
+		const __m256 cx = _mm256_loadu_ps(boxes.mCenter[0] + base);
+		const __m256 cy = _mm256_loadu_ps(boxes.mCenter[1] + base);
+		const __m256 cz = _mm256_loadu_ps(boxes.mCenter[2] + base);
+		const __m256 rx = _mm256_loadu_ps(boxes.mRadius[0] + base);
+		const __m256 ry = _mm256_loadu_ps(boxes.mRadius[1] + base);
+		const __m256 rz = _mm256_loadu_ps(boxes.mRadius[2] + base);
+		__m256 outside = _mm256_setzero_ps();
+		__m256 partial = _mm256_setzero_ps();
+#else
+		const LLQuad cx = _mm_load_ps(boxes.mCenter[0] + base);
+		const LLQuad cy = _mm_load_ps(boxes.mCenter[1] + base);
+		const LLQuad cz = _mm_load_ps(boxes.mCenter[2] + base);
+		const LLQuad rx = _mm_load_ps(boxes.mRadius[0] + base);
+		const LLQuad ry = _mm_load_ps(boxes.mRadius[1] + base);
+		const LLQuad rz = _mm_load_ps(boxes.mRadius[2] + base);
+		LLQuad outside = _mm_setzero_ps();
+		LLQuad partial = _mm_setzero_ps();
+#endif
+
+		for (U32 i = 0; i < max_planes; i++)
+		{
+			U8 mask = mPlaneMask[i];
+			if (mask >= PLANE_MASK_NUM || (!far_clip && i == AGENT_PLANE_FAR))
+			{
+				continue;
+			}
+
+			const LLPlane& p(planes[i]);
+			const F32* scale = sFrustumScaler[mask].getF32ptr();
+
+#if defined(__AVX__)
+			const __m256 px = _mm256_set1_ps(p[0]);
+			const __m256 py = _mm256_set1_ps(p[1]);
+			const __m256 pz = _mm256_set1_ps(p[2]);
+			const __m256 d = _mm256_set1_ps(-p[3]);
+			const __m256 sx = _mm256_mul_ps(rx, _mm256_set1_ps(scale[0]));
+			const __m256 sy = _mm256_mul_ps(ry, _mm256_set1_ps(scale[1]));
+			const __m256 sz = _mm256_mul_ps(rz, _mm256_set1_ps(scale[2]));
+
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(px, _mm256_sub_ps(cx, sx)),
+							_mm256_mul_ps(py, _mm256_sub_ps(cy, sy))),
+							_mm256_mul_ps(pz, _mm256_sub_ps(cz, sz)));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(dot, d, _CMP_GT_OQ));
+			if ((_mm256_movemask_ps(outside) & valid) == valid)
+			{
+				break;
+			}
+
+			dot = _mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(px, _mm256_add_ps(cx, sx)),
+							_mm256_mul_ps(py, _mm256_add_ps(cy, sy))),
+							_mm256_mul_ps(pz, _mm256_add_ps(cz, sz)));
+			partial = _mm256_or_ps(partial, _mm256_cmp_ps(dot, d, _CMP_GT_OQ));
+#else
+			const LLQuad px = _mm_set1_ps(p[0]);
+			const LLQuad py = _mm_set1_ps(p[1]);
+			const LLQuad pz = _mm_set1_ps(p[2]);
+			const LLQuad d = _mm_set1_ps(-p[3]);
+			const LLQuad sx = _mm_mul_ps(rx, _mm_set1_ps(scale[0]));
+			const LLQuad sy = _mm_mul_ps(ry, _mm_set1_ps(scale[1]));
+			const LLQuad sz = _mm_mul_ps(rz, _mm_set1_ps(scale[2]));
+
+			LLQuad dot = _mm_add_ps(_mm_add_ps(
+							_mm_mul_ps(px, _mm_sub_ps(cx, sx)),
+							_mm_mul_ps(py, _mm_sub_ps(cy, sy))),
+							_mm_mul_ps(pz, _mm_sub_ps(cz, sz)));
+			outside = _mm_or_ps(outside, _mm_cmpgt_ps(dot, d));
+			if ((_mm_movemask_ps(outside) & valid) == valid)
+			{
+				break;
+			}
+
+			dot = _mm_add_ps(_mm_add_ps(
+							_mm_mul_ps(px, _mm_add_ps(cx, sx)),
+							_mm_mul_ps(py, _mm_add_ps(cy, sy))),
+							_mm_mul_ps(pz, _mm_add_ps(cz, sz)));
+			partial = _mm_or_ps(partial, _mm_cmpgt_ps(dot, d));
+#endif
+		}
+
+#if defined(__AVX__)
+		const S32 outside_bits = _mm256_movemask_ps(outside);
+		const S32 partial_bits = _mm256_movemask_ps(partial);
+#else
+		const S32 outside_bits = _mm_movemask_ps(outside);
+		const S32 partial_bits = _mm_movemask_ps(partial);
+#endif
+		for (S32 lane = 0; lane < width && base + lane < count; ++lane)
+		{
+			const S32 bit = 1 << lane;
+			results[base + lane] = (outside_bits & bit) ? 0 : ((partial_bits & bit) ? 1 : 2);
+		}
+	}
+}
+
+void LLCamera::AABBInRegionFrustum(const LLAABBBatch& boxes, S32* results, bool far_clip)
+{
+	AABBInFrustum(boxes, results, mRegionPlanes, far_clip);
+}
+
 int LLCamera::sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius) 
 {
 	LLVector3 dist = sphere_center-mFrustCenter;
@@ -51,6 +51,43 @@ const F32 MIN_FAR_PLANE 	= 0.2f;
 static const F32 MIN_FIELD_OF_VIEW = 5.0f * DEG_TO_RAD;
 static const F32 MAX_FIELD_OF_VIEW = 175.f * DEG_TO_RAD;
 
+// Axis aligned boxes (center and half size) stored as a structure of arrays,
+// so LLCamera::AABBInFrustum() can test four of them (eight with AVX) per
+// instruction instead of one at a time.
+LL_ALIGN_PREFIX(16)
+class LLAABBBatch
+{
+public:
+	enum { MAX_BOXES = 8 };
+
+	LLAABBBatch() : mCount(0) { }
+
+	void clear()				{ mCount = 0; }
+	S32 getCount() const		{ return mCount; }
+	bool isFull() const			{ return mCount == MAX_BOXES; }
+
+	// Returns the index of the new box
+	S32 add(const LLVector4a& center, const LLVector4a& radius)
+	{
+		llassert(mCount < MAX_BOXES);
+		const F32* c = center.getF32ptr();
+		const F32* r = radius.getF32ptr();
+		for (S32 i = 0; i < 3; ++i)
+		{
+			mCenter[i][mCount] = c[i];
+			mRadius[i][mCount] = r[i];
+		}
+		return mCount++;
+	}
+
+	// x, y and z rows, lanes past mCount are unused
+	LL_ALIGN_16(F32 mCenter[3][MAX_BOXES]);
+	LL_ALIGN_16(F32 mRadius[3][MAX_BOXES]);
+
+private:
+	S32 mCount;
+} LL_ALIGN_POSTFIX(16);
+
 // An LLCamera is an LLCoorFrame with a view frustum.
 // This means that it has several methods for moving it around 
 // that are inherited from the LLCoordFrame() class :
@@ -209,6 +246,12 @@ public:
 	S32 AABBInFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius, const LLPlane* planes = NULL);
 	S32 AABBInRegionFrustumNoFarClip(const LLVector4a& center, const LLVector4a& radius);
 
+	// Tests every box in the batch at once.  results[i] is what
+	// AABBInFrustum() (or AABBInFrustumNoFarClip() when !far_clip) would
+	// return for box i.
+	void AABBInFrustum(const LLAABBBatch& boxes, S32* results, const LLPlane* planes = NULL, bool far_clip = true);
+	void AABBInRegionFrustum(const LLAABBBatch& boxes, S32* results, bool far_clip = true);
+
 	//does a quick 'n dirty sphere-sphere check
 	S32 sphereInFrustumQuick(const LLVector3 &sphere_center, const F32 radius); 
 
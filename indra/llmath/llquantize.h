@@ -28,6 +28,8 @@
 #ifndef LL_LLQUANTIZE_H
 #define LL_LLQUANTIZE_H
 
+#include <emmintrin.h>
+
 const U16 U16MAX = 65535;
 LL_ALIGN_16( const F32 F_U16MAX_4A[4] ) = { 65535.f, 65535.f, 65535.f, 65535.f };
 
@@ -86,6 +88,50 @@ inline F32 U16_to_F32(U16 ival, F32 lower, F32 upper)
 }
 
 
+// Dequantizes four U16 values, where value i is mapped into [lower[i],
+// upper[i]], using exactly the same arithmetic (and operation order) as
+// U16_to_F32(), so the results are bit-identical to it.  ival need not be
+// aligned.  Callers with ranges known up front should build lower and upper
+// in registers: loading them from floats just stored one at a time stalls
+// on store forwarding, which costs more than the whole conversion.
+inline __m128 U16_to_F32_4(const U16* ival, const __m128& lower, const __m128& upper)
+{
+	const __m128 oo_u16max = _mm_load_ps(F_OOU16MAX_4A);
+	const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+
+	__m128i ival_4 = _mm_loadl_epi64((const __m128i*)ival);
+	__m128 val = _mm_cvtepi32_ps(_mm_unpacklo_epi16(ival_4, _mm_setzero_si128()));
+	__m128 delta = _mm_sub_ps(upper, lower);
+
+	val = _mm_mul_ps(val, oo_u16max);
+	val = _mm_mul_ps(val, delta);
+	val = _mm_add_ps(val, lower);
+
+	__m128 max_error = _mm_mul_ps(delta, oo_u16max);
+
+	// make sure that zero's come through as zero
+	__m128 is_zero = _mm_cmplt_ps(_mm_andnot_ps(sign_mask, val), max_error);
+	return _mm_andnot_ps(is_zero, val);
+}
+
+// Dequantizes count U16 values into out, where value i is mapped into
+// [lower[i], upper[i]], four at a time with U16_to_F32_4().  None of the
+// arrays need to be aligned.
+inline void U16_to_F32_batch(const U16* ival, const F32* lower, const F32* upper, F32* out, S32 count)
+{
+	S32 i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, U16_to_F32_4(ival + i, _mm_loadu_ps(lower + i), _mm_loadu_ps(upper + i)));
+	}
+
+	for (; i < count; ++i)
+	{
+		out[i] = U16_to_F32(ival[i], lower[i], upper[i]);
+	}
+}
+
+
 inline U8 F32_to_U8_ROUND(F32 val, F32 lower, F32 upper)
 {
 	val = llclamp(val, lower, upper);
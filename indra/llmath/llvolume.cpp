@@ -703,7 +703,7 @@ LLProfile::Face* LLProfile::addHole(const LLProfileParams& params, BOOL flat, F3
 
 	Face *face = addFace(mTotalOut, mTotal-mTotalOut,0,LL_FACE_INNER_SIDE, flat);
 
-	static LLAlignedArray<LLVector4a,64> pt;
+	static thread_local LLAlignedArray<LLVector4a,64> pt;
 	pt.resize(mTotal) ;
 
 	for (S32 i=mTotalOut;i<mTotal;i++)
@@ -2058,7 +2058,7 @@ LLProfile::~LLProfile()
 }
 
 
-S32 LLVolume::sNumMeshPoints = 0;
+LLAtomicS32 LLVolume::sNumMeshPoints(0);
 
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
@@ -4069,6 +4069,72 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 	}
 }
 
+// fills in the optional outputs of a line segment hit at t on triangle tri of face
+static void get_hit_attributes(const LLVolumeFace& face, U32 tri, F32 a, F32 b, F32 t,
+							   const LLVector4a& start, const LLVector4a& dir,
+							   LLVector4a* intersection, LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
+{
+	U16 idx0 = face.mIndices[tri*3+0];
+	U16 idx1 = face.mIndices[tri*3+1];
+	U16 idx2 = face.mIndices[tri*3+2];
+
+	if (intersection != NULL)
+	{
+		LLVector4a intersect = dir;
+		intersect.mul(t);
+		intersect.add(start);
+		*intersection = intersect;
+	}
+
+	if (tex_coord != NULL)
+	{
+		LLVector2* tc = (LLVector2*) face.mTexCoords;
+		*tex_coord = ((1.f - a - b)  * tc[idx0] +
+			a              * tc[idx1] +
+			b              * tc[idx2]);
+	}
+
+	if (normal!= NULL)
+	{
+		LLVector4a* norm = face.mNormals;
+		
+		LLVector4a n1,n2,n3;
+		n1 = norm[idx0];
+		n1.mul(1.f-a-b);
+		
+		n2 = norm[idx1];
+		n2.mul(a);
+		
+		n3 = norm[idx2];
+		n3.mul(b);
+
+		n1.add(n2);
+		n1.add(n3);
+		
+		*normal		= n1; 
+	}
+
+	if (tangent_out != NULL)
+	{
+		LLVector4a* tangents = face.mTangents;
+		
+		LLVector4a t1,t2,t3;
+		t1 = tangents[idx0];
+		t1.mul(1.f-a-b);
+		
+		t2 = tangents[idx1];
+		t2.mul(a);
+		
+		t3 = tangents[idx2];
+		t3.mul(b);
+
+		t1.add(t2);
+		t1.add(t3);
+		
+		*tangent_out = t1; 
+	}
+}
+
 S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& end, 
 								   S32 face,
 								   LLVector4a* intersection,LLVector2* tex_coord, LLVector4a* normal, LLVector4a* tangent_out)
@@ -4114,19 +4180,27 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
 				genTangents(i);
 			}
 
-			if (isUnique())
-			{ //don't bother with an octree for flexi volumes
+			// flexi volumes change every frame, don't bother with a tree for them
+			const LLVolumeBVH* bvh = isUnique() ? NULL : face.getBVH();
+			if (bvh)
+			{
+				F32 a, b;
+				S32 tri = bvh->intersect(start, dir, closest_t, a, b);
+				if (tri >= 0)
+				{
+					hit_face = i;
+					get_hit_attributes(face, tri, a, b, closest_t, start, dir, intersection, tex_coord, normal, tangent_out);
+				}
+			}
+			else
+			{ //test every triangle, large faces do this until their tree is built
 				U32 tri_count = face.mNumIndices/3;
 
 				for (U32 j = 0; j < tri_count; ++j)
 				{
-					U16 idx0 = face.mIndices[j*3+0];
-					U16 idx1 = face.mIndices[j*3+1];
-					U16 idx2 = face.mIndices[j*3+2];
-
-					const LLVector4a& v0 = face.mPositions[idx0];
-					const LLVector4a& v1 = face.mPositions[idx1];
-					const LLVector4a& v2 = face.mPositions[idx2];
+					const LLVector4a& v0 = face.mPositions[face.mIndices[j*3+0]];
+					const LLVector4a& v1 = face.mPositions[face.mIndices[j*3+1]];
+					const LLVector4a& v2 = face.mPositions[face.mIndices[j*3+2]];
 				
 					F32 a,b,t;
 
@@ -4139,82 +4213,11 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
 						{
 							closest_t = t;
 							hit_face = i;
-
-							if (intersection != NULL)
-							{
-								LLVector4a intersect = dir;
-								intersect.mul(closest_t);
-								intersect.add(start);
-								*intersection = intersect;
-							}
-
-
-							if (tex_coord != NULL)
-							{
-								LLVector2* tc = (LLVector2*) face.mTexCoords;
-								*tex_coord = ((1.f - a - b)  * tc[idx0] +
-									a              * tc[idx1] +
-									b              * tc[idx2]);
-
-							}
-
-							if (normal!= NULL)
-							{
-								LLVector4a* norm = face.mNormals;
-								
-								LLVector4a n1,n2,n3;
-								n1 = norm[idx0];
-								n1.mul(1.f-a-b);
-								
-								n2 = norm[idx1];
-								n2.mul(a);
-								
-								n3 = norm[idx2];
-								n3.mul(b);
-
-								n1.add(n2);
-								n1.add(n3);
-								
-								*normal		= n1; 
-							}
-
-							if (tangent_out != NULL)
-							{
-								LLVector4a* tangents = face.mTangents;
-								
-								LLVector4a t1,t2,t3;
-								t1 = tangents[idx0];
-								t1.mul(1.f-a-b);
-								
-								t2 = tangents[idx1];
-								t2.mul(a);
-								
-								t3 = tangents[idx2];
-								t3.mul(b);
-
-								t1.add(t2);
-								t1.add(t3);
-								
-								*tangent_out = t1; 
-							}
+							get_hit_attributes(face, j, a, b, t, start, dir, intersection, tex_coord, normal, tangent_out);
 						}
 					}
 				}
 			}
-			else
-			{
-				if (!face.mOctree)
-				{
-					face.createOctree();
-				}
-			
-				LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
-				intersect.traverse(face.mOctree);
-				if (intersect.mHitFace)
-				{
-					hit_face = i;
-				}
-			}
 		}		
 	}
 	
@@ -4936,6 +4939,7 @@ void LLVolumeFace::freeData()
 
 	delete mOctree;
 	mOctree = NULL;
+	mBVH = NULL;
 }
 
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
@@ -4943,6 +4947,7 @@ BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 	//tree for this face is no longer valid
 	delete mOctree;
 	mOctree = NULL;
+	mBVH = NULL;
 
 	LL_CHECK_MEMORY
 	BOOL ret = FALSE ;
@@ -5617,6 +5622,25 @@ bool LLVolumeFace::cacheOptimize()
 	return true;
 }
 
+const LLVolumeBVH* LLVolumeFace::getBVH()
+{
+	if (mBVH.isNull())
+	{
+		mBVH = new LLVolumeBVH(*this);
+		LLVolumeBVH::requestBuild(mBVH);
+	}
+
+	return mBVH->isBuilt() ? mBVH.get() : NULL;
+}
+
+void LLVolumeFace::refitBVH()
+{
+	if (mBVH.notNull() && !mBVH->refit(*this))
+	{
+		mBVH = NULL;
+	}
+}
+
 void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVector4a& size)
 {
 	if (mOctree)
@@ -6891,7 +6915,7 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 
 	LLVector4a* norm = mNormals;
 
-	static LLAlignedArray<LLVector4a, 64> triangle_normals;
+	static thread_local LLAlignedArray<LLVector4a, 64> triangle_normals;
     try
     {
         triangle_normals.resize(count);
@@ -55,9 +55,11 @@ class LLVolumeTriangle;
 #include "v4coloru.h"
 #include "llrefcount.h"
 #include "llpointer.h"
+#include "llatomic.h"
 #include "llfile.h"
 #include "llalignedarray.h"
 #include "llrigginginfo.h"
+#include "llvolumebvh.h"
 
 //============================================================================
 
@@ -910,6 +912,13 @@ public:
 
 	void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
 
+	// Returns the pick tree of this face, or NULL while it is still being built
+	const LLVolumeBVH* getBVH();
+	void destroyBVH()	{ mBVH = NULL; }
+	// Refits the pick tree to moved positions, or drops it if it is still
+	// waiting to be built from the old ones
+	void refitBVH();
+
 	enum
 	{
 		SINGLE_MASK =	0x0001,
@@ -973,6 +982,9 @@ public:
     
 	LLOctreeNode<LLVolumeTriangle>* mOctree;
 
+	// ray pick acceleration, built on demand by getBVH()
+	LLPointer<LLVolumeBVH> mBVH;
+
 	//whether or not face has been cache optimized
 	BOOL mOptimized;
 
@@ -1061,7 +1073,7 @@ public:
 	LLFaceID generateFaceMask();
 
 	BOOL isFaceMaskValid(LLFaceID face_mask);
-	static S32 sNumMeshPoints;
+	static LLAtomicS32 sNumMeshPoints;
 
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
@@ -0,0 +1,706 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Bounding volume hierarchy for ray picks against volume faces.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "llalignedarray.h"
+#include "llmutex.h"
+#include "llthread.h"
+#include "llvolume.h"
+
+LLAtomicS32 LLVolumeBVH::sTotalMemory(0);
+
+namespace
+{
+	// half the surface area of a box, all the SAH needs
+	inline F32 half_area(const LLVector4a& min, const LLVector4a& max)
+	{
+		LLVector4a size;
+		size.setSub(max, min);
+		return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+	}
+
+	// largest and smallest of the x, y and z lanes, the w lane never takes part
+	inline F32 max3(__m128 v)
+	{
+		__m128 m = _mm_max_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+		return _mm_cvtss_f32(_mm_max_ss(m, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+	}
+
+	inline F32 min3(__m128 v)
+	{
+		__m128 m = _mm_min_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+		return _mm_cvtss_f32(_mm_min_ss(m, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+	}
+
+	// slab test of the segment against the bounds stored at min and max,
+	// which are followed by one more word that gets loaded and ignored
+	inline bool ray_box(const F32* min, const F32* max, __m128 origin, __m128 inv_dir, F32 limit, F32& t_near)
+	{
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(min), origin), inv_dir);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(max), origin), inv_dir);
+
+		F32 t_enter = max3(_mm_min_ps(t0, t1));
+		F32 t_exit = min3(_mm_max_ps(t0, t1));
+
+		t_near = t_enter;
+		return t_enter <= t_exit && t_exit >= 0.f && t_enter <= limit;
+	}
+
+	// pad a box a little so the slab test never loses a triangle that lies
+	// in one of its faces to rounding
+	inline void pad_bounds(LLVector4a& min, LLVector4a& max)
+	{
+		LLVector4a pad;
+		pad.setSub(max, min);
+		pad.splat(llmax(pad[0], pad[1], pad[2]) * 1.0e-5f + 1.0e-6f);
+		min.sub(pad);
+		max.add(pad);
+	}
+
+	// centroid of a triangle's bounds along axis, doubled since only the order matters
+	inline F32 centroid(const LLVector4a* bounds, U32 tri, S32 axis)
+	{
+		return bounds[tri * 2][axis] + bounds[tri * 2 + 1][axis];
+	}
+
+	inline U32 bin_index(F32 c, F32 c_min, F32 scale)
+	{
+		S32 bin = (S32) ((c - c_min) * scale);
+		return (U32) llclamp(bin, 0, LLVolumeBVH::NUM_BINS - 1);
+	}
+}
+
+//============================================================================
+// LLVolumeBVHThread
+
+class LLVolumeBVHThread : public LLThread
+{
+public:
+	LLVolumeBVHThread()
+	:	LLThread("Volume BVH Build")
+	{
+		mMutex = new LLMutex();
+	}
+
+	/*virtual*/ ~LLVolumeBVHThread()
+	{
+		shutdown();
+		mQueue.clear();
+		delete mMutex;
+		mMutex = NULL;
+	}
+
+	void queue(LLVolumeBVH* bvh)
+	{
+		{
+			LLMutexLock lock(mMutex);
+			mQueue.push_back(bvh);
+		}
+		wake();
+	}
+
+protected:
+	/*virtual*/ bool runCondition()
+	{
+		LLMutexLock lock(mMutex);
+		return !mQueue.empty();
+	}
+
+	/*virtual*/ void run()
+	{
+		while (!isQuitting())
+		{
+			checkPause();
+
+			LLPointer<LLVolumeBVH> bvh;
+			{
+				LLMutexLock lock(mMutex);
+				if (isQuitting() || mQueue.empty())
+				{
+					continue;
+				}
+				bvh = mQueue.front();
+				mQueue.pop_front();
+			}
+
+			// if the face let go of the tree while it was queued, nobody wants it
+			if (bvh->getNumRefs() > 1)
+			{
+				bvh->build();
+			}
+		}
+	}
+
+private:
+	LLMutex* mMutex;
+	std::deque<LLPointer<LLVolumeBVH> > mQueue;
+};
+
+static LLVolumeBVHThread* sBuildThread = NULL;
+
+//============================================================================
+// LLVolumeBVH
+
+LLVolumeBVH::LLVolumeBVH(const LLVolumeFace& face)
+:	mNumTriangles(face.mNumIndices / 3),
+	mBuilt(false)
+{
+	mVertices.resize(mNumTriangles * 9);
+	for (U32 i = 0; i < mNumTriangles * 3; ++i)
+	{
+		const F32* src = face.mPositions[face.mIndices[i]].getF32ptr();
+		mVertices[i * 3 + 0] = src[0];
+		mVertices[i * 3 + 1] = src[1];
+		mVertices[i * 3 + 2] = src[2];
+	}
+}
+
+LLVolumeBVH::~LLVolumeBVH()
+{
+	if (isBuilt())
+	{
+		sTotalMemory -= (S32) getMemoryUsage();
+	}
+}
+
+U32 LLVolumeBVH::getMemoryUsage() const
+{
+	return (U32) (sizeof(LLVolumeBVH) + mNodes.capacity() * sizeof(Node) + mPackets.capacity() * sizeof(Packet)
+				  + mVertices.capacity() * sizeof(F32));
+}
+
+void LLVolumeBVH::build()
+{
+	if (isBuilt())
+	{
+		return;
+	}
+
+	// bounds of every triangle, min followed by max
+	LLAlignedArray<LLVector4a, 64> bounds;
+	bounds.resize(mNumTriangles * 2);
+	std::vector<U32> order(mNumTriangles);
+	for (U32 i = 0; i < mNumTriangles; ++i)
+	{
+		LLVector4a v0, v1, v2;
+		v0.load3(&mVertices[i * 9]);
+		v1.load3(&mVertices[i * 9 + 3]);
+		v2.load3(&mVertices[i * 9 + 6]);
+
+		LLVector4a& min = bounds[i * 2];
+		LLVector4a& max = bounds[i * 2 + 1];
+		min.setMin(v0, v1);
+		min.setMin(min, v2);
+		max.setMax(v0, v1);
+		max.setMax(max, v2);
+
+		order[i] = i;
+	}
+
+	if (mNumTriangles)
+	{
+		// full leaves give n / 2 nodes, allow for some slack
+		mNodes.reserve(mNumTriangles);
+		mPackets.reserve(mNumTriangles / 2 + 1);
+		buildNode(0, mNumTriangles, 0, &bounds[0], order);
+	}
+
+	mNodes.shrink_to_fit();
+	mPackets.shrink_to_fit();
+	std::vector<F32>().swap(mVertices);
+
+	U32 bytes = getMemoryUsage();
+	sTotalMemory += (S32) bytes;
+	LL_DEBUGS("VolumeBVH") << "Built BVH for " << mNumTriangles << " triangles: " << mNodes.size() << " nodes, "
+						   << mPackets.size() << " packets, " << bytes << " bytes, "
+						   << getTotalMemoryUsage() << " bytes in all trees" << LL_ENDL;
+
+	mBuilt = true;
+}
+
+bool LLVolumeBVH::refit(const LLVolumeFace& face)
+{
+	if (!isBuilt() || (U32) face.mNumIndices / 3 != mNumTriangles)
+	{
+		return false;
+	}
+
+	// children are stored after their parent, so walking the nodes backwards
+	// visits both children of an inner node before the node itself
+	for (S32 n = (S32) mNodes.size() - 1; n >= 0; --n)
+	{
+		Node& node = mNodes[n];
+		LLVector4a min, max;
+		if (node.mCount)
+		{
+			Packet& packet = mPackets[node.mIndex];
+			for (U32 i = 0; i < node.mCount; ++i)
+			{
+				U32 tri = packet.mTriangle[i];
+				const LLVector4a& v0 = face.mPositions[face.mIndices[tri * 3 + 0]];
+				const LLVector4a& v1 = face.mPositions[face.mIndices[tri * 3 + 1]];
+				const LLVector4a& v2 = face.mPositions[face.mIndices[tri * 3 + 2]];
+				for (S32 k = 0; k < 3; ++k)
+				{
+					packet.mV0[k][i] = v0[k];
+					packet.mEdge1[k][i] = v1[k] - v0[k];
+					packet.mEdge2[k][i] = v2[k] - v0[k];
+				}
+
+				if (i == 0)
+				{
+					min = v0;
+					max = v0;
+				}
+				min.setMin(min, v0);
+				min.setMin(min, v1);
+				min.setMin(min, v2);
+				max.setMax(max, v0);
+				max.setMax(max, v1);
+				max.setMax(max, v2);
+			}
+			pad_bounds(min, max);
+		}
+		else
+		{	// the children are already padded
+			const Node& left = mNodes[n + 1];
+			const Node& right = mNodes[node.mIndex];
+			LLVector4a right_min, right_max;
+			min.load3(left.mMin);
+			max.load3(left.mMax);
+			right_min.load3(right.mMin);
+			right_max.load3(right.mMax);
+			min.setMin(min, right_min);
+			max.setMax(max, right_max);
+		}
+
+		for (S32 i = 0; i < 3; ++i)
+		{
+			node.mMin[i] = min[i];
+			node.mMax[i] = max[i];
+		}
+	}
+
+	return true;
+}
+
+U32 LLVolumeBVH::buildNode(U32 begin, U32 end, U32 depth, const LLVector4a* bounds, std::vector<U32>& order)
+{
+	LLVector4a min = bounds[order[begin] * 2];
+	LLVector4a max = bounds[order[begin] * 2 + 1];
+	LLVector4a centroid_min, centroid_max;
+	centroid_min.setAdd(min, max);
+	centroid_max = centroid_min;
+
+	for (U32 i = begin + 1; i < end; ++i)
+	{
+		const LLVector4a& tri_min = bounds[order[i] * 2];
+		const LLVector4a& tri_max = bounds[order[i] * 2 + 1];
+		min.setMin(min, tri_min);
+		max.setMax(max, tri_max);
+
+		LLVector4a c;
+		c.setAdd(tri_min, tri_max);
+		centroid_min.setMin(centroid_min, c);
+		centroid_max.setMax(centroid_max, c);
+	}
+
+	pad_bounds(min, max);
+
+	// the node vector grows during recursion, so refer to the node by index
+	U32 index = (U32) mNodes.size();
+	mNodes.push_back(Node());
+	for (S32 i = 0; i < 3; ++i)
+	{
+		mNodes[index].mMin[i] = min[i];
+		mNodes[index].mMax[i] = max[i];
+	}
+
+	U32 count = end - begin;
+	if (count <= PACKET_SIZE)
+	{
+		Packet packet;
+		memset(&packet, 0, sizeof(Packet));
+
+		// unused lanes keep zero edges, which the determinant test rejects
+		for (U32 i = 0; i < count; ++i)
+		{
+			U32 tri = order[begin + i];
+			const F32* v = &mVertices[tri * 9];
+			for (S32 k = 0; k < 3; ++k)
+			{
+				packet.mV0[k][i] = v[k];
+				packet.mEdge1[k][i] = v[3 + k] - v[k];
+				packet.mEdge2[k][i] = v[6 + k] - v[k];
+			}
+			packet.mTriangle[i] = tri;
+		}
+
+		mNodes[index].mCount = count;
+		mNodes[index].mIndex = (U32) mPackets.size();
+		mPackets.push_back(packet);
+		return index;
+	}
+
+	U32 mid = split(begin, end, depth, bounds, order, centroid_min, centroid_max);
+
+	mNodes[index].mCount = 0;
+	buildNode(begin, mid, depth + 1, bounds, order);	// lands at index + 1
+	U32 right = buildNode(mid, end, depth + 1, bounds, order);
+	mNodes[index].mIndex = right;
+
+	return index;
+}
+
+U32 LLVolumeBVH::split(U32 begin, U32 end, U32 depth, const LLVector4a* bounds, std::vector<U32>& order,
+					   const LLVector4a& centroid_min, const LLVector4a& centroid_max) const
+{
+	LLVector4a extent;
+	extent.setSub(centroid_max, centroid_min);
+
+	if (depth < MAX_SAH_DEPTH)
+	{
+		LLVector4a empty_min, empty_max;
+		empty_min.splat(F32_MAX);
+		empty_max.splat(-F32_MAX);
+
+		S32 best_axis = -1;
+		U32 best_bin = 0;
+		F32 best_cost = F32_MAX;
+
+		for (S32 axis = 0; axis < 3; ++axis)
+		{
+			if (extent[axis] <= 0.f)
+			{
+				continue;
+			}
+
+			F32 scale = NUM_BINS / extent[axis];
+
+			U32 bin_count[NUM_BINS];
+			LLVector4a bin_min[NUM_BINS];
+			LLVector4a bin_max[NUM_BINS];
+			for (S32 b = 0; b < NUM_BINS; ++b)
+			{
+				bin_count[b] = 0;
+				bin_min[b] = empty_min;
+				bin_max[b] = empty_max;
+			}
+
+			for (U32 i = begin; i < end; ++i)
+			{
+				U32 tri = order[i];
+				U32 b = bin_index(centroid(bounds, tri, axis), centroid_min[axis], scale);
+				++bin_count[b];
+				bin_min[b].setMin(bin_min[b], bounds[tri * 2]);
+				bin_max[b].setMax(bin_max[b], bounds[tri * 2 + 1]);
+			}
+
+			// cost of everything right of each plane, swept from the right
+			F32 right_cost[NUM_BINS];
+			U32 right_count[NUM_BINS];
+			LLVector4a acc_min = empty_min;
+			LLVector4a acc_max = empty_max;
+			U32 acc_count = 0;
+			for (S32 b = NUM_BINS - 1; b > 0; --b)
+			{
+				acc_min.setMin(acc_min, bin_min[b]);
+				acc_max.setMax(acc_max, bin_max[b]);
+				acc_count += bin_count[b];
+				right_count[b] = acc_count;
+				right_cost[b] = acc_count ? acc_count * half_area(acc_min, acc_max) : 0.f;
+			}
+
+			acc_min = empty_min;
+			acc_max = empty_max;
+			acc_count = 0;
+			for (S32 b = 0; b < NUM_BINS - 1; ++b)
+			{
+				acc_min.setMin(acc_min, bin_min[b]);
+				acc_max.setMax(acc_max, bin_max[b]);
+				acc_count += bin_count[b];
+				if (!acc_count || !right_count[b + 1])
+				{
+					continue;
+				}
+
+				F32 cost = acc_count * half_area(acc_min, acc_max) + right_cost[b + 1];
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = (U32) b;
+				}
+			}
+		}
+
+		if (best_axis >= 0)
+		{
+			F32 c_min = centroid_min[best_axis];
+			F32 scale = NUM_BINS / extent[best_axis];
+			std::vector<U32>::iterator mid = std::partition(order.begin() + begin, order.begin() + end,
+				[=](U32 tri) { return bin_index(centroid(bounds, tri, best_axis), c_min, scale) <= best_bin; });
+
+			U32 mid_index = (U32) (mid - order.begin());
+			if (mid_index > begin && mid_index < end)
+			{
+				return mid_index;
+			}
+		}
+	}
+
+	// degenerate centroids or a very deep tree, split in half along the widest axis
+	S32 axis = 0;
+	if (extent[1] > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent[2] > extent[axis])
+	{
+		axis = 2;
+	}
+
+	U32 mid = begin + (end - begin) / 2;
+	std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+		[=](U32 lhs, U32 rhs) { return centroid(bounds, lhs, axis) < centroid(bounds, rhs, axis); });
+	return mid;
+}
+
+S32 LLVolumeBVH::intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const
+{
+	if (!isBuilt() || mNodes.empty())
+	{
+		return -1;
+	}
+
+	// keep zero direction components away from 0 * inf in the slab test
+	F32 inv[3];
+	for (S32 i = 0; i < 3; ++i)
+	{
+		F32 d = dir[i];
+		if (fabsf(d) < 1.0e-20f)
+		{
+			d = d < 0.f ? -1.0e-20f : 1.0e-20f;
+		}
+		inv[i] = 1.f / d;
+	}
+	LLVector4a inv_dir(inv[0], inv[1], inv[2], 0.f);
+
+	const __m128 origin = start;
+	const __m128 idir = inv_dir;
+
+	const __m128 ox = _mm_set1_ps(start[0]);
+	const __m128 oy = _mm_set1_ps(start[1]);
+	const __m128 oz = _mm_set1_ps(start[2]);
+	const __m128 dx = _mm_set1_ps(dir[0]);
+	const __m128 dy = _mm_set1_ps(dir[1]);
+	const __m128 dz = _mm_set1_ps(dir[2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 epsilon = _mm_set1_ps(F_APPROXIMATELY_ZERO);
+
+	S32 hit = -1;
+
+	struct StackEntry
+	{
+		U32 mNode;
+		F32 mNear;
+	};
+	StackEntry stack[STACK_SIZE];
+	U32 depth = 0;
+
+	F32 t_near;
+	if (!ray_box(mNodes[0].mMin, mNodes[0].mMax, origin, idir, llmin(closest_t, 1.f), t_near))
+	{
+		return -1;
+	}
+
+	U32 node_index = 0;
+	while (true)
+	{
+		const Node& node = mNodes[node_index];
+		if (node.mCount)
+		{
+			const Packet& p = mPackets[node.mIndex];
+			__m128 e1x = _mm_loadu_ps(p.mEdge1[0]);
+			__m128 e1y = _mm_loadu_ps(p.mEdge1[1]);
+			__m128 e1z = _mm_loadu_ps(p.mEdge1[2]);
+			__m128 e2x = _mm_loadu_ps(p.mEdge2[0]);
+			__m128 e2y = _mm_loadu_ps(p.mEdge2[1]);
+			__m128 e2z = _mm_loadu_ps(p.mEdge2[2]);
+
+			// pvec = dir x edge2, det = edge1 . pvec
+			__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+			__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+			// tvec = start - v0, u = tvec . pvec
+			__m128 tx = _mm_sub_ps(ox, _mm_loadu_ps(p.mV0[0]));
+			__m128 ty = _mm_sub_ps(oy, _mm_loadu_ps(p.mV0[1]));
+			__m128 tz = _mm_sub_ps(oz, _mm_loadu_ps(p.mV0[2]));
+			__m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+
+			// qvec = tvec x edge1, v = dir . qvec, t = edge2 . qvec
+			__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+			__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+			__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+			__m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+			__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+
+			// front facing only, same as LLTriangleRayIntersect
+			__m128 mask = _mm_cmpge_ps(det, epsilon);
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(u, det));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), det));
+
+			if (_mm_movemask_ps(mask))
+			{
+				// rejected lanes may divide by zero, their results are masked off
+				t = _mm_div_ps(t, det);
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+				mask = _mm_and_ps(mask, _mm_cmple_ps(t, one));
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(closest_t)));
+
+				S32 lanes = _mm_movemask_ps(mask);
+				if (lanes)
+				{
+					LL_ALIGN_16(F32 t_lane[4]);
+					LL_ALIGN_16(F32 u_lane[4]);
+					LL_ALIGN_16(F32 v_lane[4]);
+					LL_ALIGN_16(F32 det_lane[4]);
+					_mm_store_ps(t_lane, t);
+					_mm_store_ps(u_lane, u);
+					_mm_store_ps(v_lane, v);
+					_mm_store_ps(det_lane, det);
+
+					for (S32 i = 0; i < PACKET_SIZE; ++i)
+					{
+						if ((lanes & (1 << i)) && t_lane[i] < closest_t)
+						{
+							closest_t = t_lane[i];
+							a = u_lane[i] / det_lane[i];
+							b = v_lane[i] / det_lane[i];
+							hit = (S32) p.mTriangle[i];
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			F32 limit = llmin(closest_t, 1.f);
+			U32 left = node_index + 1;
+			U32 right = node.mIndex;
+			F32 t_left, t_right;
+			bool hit_left = ray_box(mNodes[left].mMin, mNodes[left].mMax, origin, idir, limit, t_left);
+			bool hit_right = ray_box(mNodes[right].mMin, mNodes[right].mMax, origin, idir, limit, t_right);
+
+			if (hit_left && hit_right)
+			{
+				// nearer child first, the other one waits on the stack
+				if (t_right < t_left)
+				{
+					std::swap(left, right);
+					std::swap(t_left, t_right);
+				}
+				llassert(depth < STACK_SIZE);
+				stack[depth].mNode = right;
+				stack[depth].mNear = t_right;
+				++depth;
+				node_index = left;
+				continue;
+			}
+			if (hit_left || hit_right)
+			{
+				node_index = hit_left ? left : right;
+				continue;
+			}
+		}
+
+		// pop the next subtree that can still beat the closest hit
+		bool found = false;
+		while (depth)
+		{
+			--depth;
+			if (stack[depth].mNear <= closest_t)
+			{
+				node_index = stack[depth].mNode;
+				found = true;
+				break;
+			}
+		}
+		if (!found)
+		{
+			break;
+		}
+	}
+
+	return hit;
+}
+
+//static
+void LLVolumeBVH::requestBuild(LLVolumeBVH* bvh)
+{
+	if (bvh->isBuilt())
+	{
+		return;
+	}
+
+	if (!sBuildThread || bvh->getNumTriangles() < INLINE_BUILD_TRIANGLES)
+	{
+		bvh->build();
+	}
+	else
+	{
+		sBuildThread->queue(bvh);
+	}
+}
+
+//static
+void LLVolumeBVH::startBuildThread()
+{
+	if (!sBuildThread)
+	{
+		sBuildThread = new LLVolumeBVHThread();
+		sBuildThread->start();
+	}
+}
+
+//static
+void LLVolumeBVH::stopBuildThread()
+{
+	// queued trees that were never built stay unbuilt, faces fall back to brute force
+	delete sBuildThread;
+	sBuildThread = NULL;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Bounding volume hierarchy for ray picks against volume faces.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include <vector>
+
+#include "llatomic.h"
+#include "llmath.h"
+#include "llrefcount.h"
+#include "llvector4a.h"
+
+class LLVolumeFace;
+
+/**
+ * @class LLVolumeBVH
+ * @brief Binned SAH bounding volume hierarchy over the triangles of one face.
+ *
+ * Nodes are 32 bytes and stored depth first, so the first child of an inner
+ * node directly follows it.  Every leaf owns one packet of up to four
+ * triangles in SoA layout, which is tested against the ray in a single pass.
+ *
+ * The tree copies the vertex data it needs, so it never looks at the face
+ * again after the constructor and build() may run on the worker thread.
+ * LLVolumeFace keeps the tree next to its octree; since volumes are shared
+ * through LLVolumeMgr, every object using the same volume shares the tree.
+ */
+class LLVolumeBVH : public LLThreadSafeRefCount
+{
+public:
+	enum
+	{
+		PACKET_SIZE = 4,		// triangles per leaf
+		NUM_BINS = 12,			// SAH bins per axis
+		MAX_SAH_DEPTH = 40,		// below this, split at the median to bound depth
+		STACK_SIZE = 64,
+		// faces with fewer triangles are built on the spot instead of queued
+		INLINE_BUILD_TRIANGLES = 2048
+	};
+
+	// Copies the triangles of face, call build() before intersect()
+	LLVolumeBVH(const LLVolumeFace& face);
+
+	void build();
+	bool isBuilt() const	{ return mBuilt.CurrentValue(); }
+
+	// Moves the triangles to the face's current positions and recomputes the
+	// node bounds, keeping the shape of the tree.  For faces whose vertices
+	// move but whose indices don't, like rigged meshes.  Returns false if the
+	// tree isn't built yet or the face no longer matches it.
+	bool refit(const LLVolumeFace& face);
+
+	// Finds the closest front facing hit of start + t * dir with t in [0, 1]
+	// and t < closest_t, using the same test as LLTriangleRayIntersect.
+	// Returns the index of the hit triangle (its first index / 3) and updates
+	// closest_t and the barycentric a and b, or returns -1.
+	S32 intersect(const LLVector4a& start, const LLVector4a& dir, F32& closest_t, F32& a, F32& b) const;
+
+	U32 getNumTriangles() const	{ return mNumTriangles; }
+	U32 getNumNodes() const		{ return (U32) mNodes.size(); }
+	U32 getMemoryUsage() const;
+
+	// bytes held by every built tree
+	static S32 getTotalMemoryUsage()	{ return sTotalMemory.CurrentValue(); }
+
+	// Builds small trees inline and queues the rest on the worker thread
+	// if it has been started, so the caller can fall back to a brute force
+	// test until isBuilt() turns true.
+	static void requestBuild(LLVolumeBVH* bvh);
+	static void startBuildThread();
+	static void stopBuildThread();
+
+protected:
+	~LLVolumeBVH();
+
+private:
+	struct Node
+	{
+		F32 mMin[3];
+		U32 mCount;		// triangles in a leaf, 0 for inner nodes
+		F32 mMax[3];
+		U32 mIndex;		// packet of a leaf, second child of an inner node
+	};
+
+	struct Packet
+	{
+		F32 mV0[3][PACKET_SIZE];
+		F32 mEdge1[3][PACKET_SIZE];
+		F32 mEdge2[3][PACKET_SIZE];
+		U32 mTriangle[PACKET_SIZE];
+	};
+
+	U32 buildNode(U32 begin, U32 end, U32 depth, const LLVector4a* bounds, std::vector<U32>& order);
+	U32 split(U32 begin, U32 end, U32 depth, const LLVector4a* bounds, std::vector<U32>& order,
+			  const LLVector4a& centroid_min, const LLVector4a& centroid_max) const;
+
+	U32 mNumTriangles;
+	std::vector<Node> mNodes;
+	std::vector<Packet> mPackets;
+
+	// build input, three xyz vertices per triangle, released once built
+	std::vector<F32> mVertices;
+
+	LLAtomicBool mBuilt;
+
+	static LLAtomicS32 sTotalMemory;
+};
+
+#endif // LL_LLVOLUMEBVH_H
@@ -172,6 +172,35 @@ void LLVolumeMgr::unrefVolume(LLVolume *volumep)
 
 }
 
+BOOL LLVolumeMgr::hasVolume(const LLVolumeParams &volume_params, const S32 detail) const
+{
+	LLVolumeLODGroup* volgroupp = getGroup(volume_params);
+	return volgroupp && volgroupp->hasLOD(detail);
+}
+
+BOOL LLVolumeMgr::adoptVolume(LLVolume *volumep, const S32 detail)
+{
+	if (volumep->isUnique())
+	{
+		return FALSE;
+	}
+	BOOL adopted = FALSE;
+	if (mDataMutex)
+	{
+		mDataMutex->lock();
+	}
+	volume_lod_group_map_t::iterator iter = mVolumeLODGroups.find(&volumep->getParams());
+	if (iter != mVolumeLODGroups.end())
+	{
+		adopted = iter->second->adoptLOD(detail, volumep);
+	}
+	if (mDataMutex)
+	{
+		mDataMutex->unlock();
+	}
+	return adopted;
+}
+
 // protected
 void LLVolumeMgr::insertGroup(LLVolumeLODGroup* volgroup)
 {
@@ -301,6 +330,18 @@ LLVolume* LLVolumeLODGroup::refLOD(const S32 detail)
 	return mVolumeLODs[detail];
 }
 
+BOOL LLVolumeLODGroup::adoptLOD(const S32 detail, LLVolume *volumep)
+{
+	llassert(detail >=0 && detail < NUM_LODS);
+	llassert(volumep->getDetail() == mDetailScales[detail]);
+	if (mVolumeLODs[detail].notNull())
+	{
+		return FALSE;
+	}
+	mVolumeLODs[detail] = volumep;
+	return TRUE;
+}
+
 BOOL LLVolumeLODGroup::derefLOD(LLVolume *volumep)
 {
 	llassert_always(mRefs > 0);
@@ -57,6 +57,8 @@ public:
 
 	LLVolume* refLOD(const S32 detail);
 	BOOL derefLOD(LLVolume *volumep);
+	BOOL adoptLOD(const S32 detail, LLVolume *volumep);
+	BOOL hasLOD(const S32 detail) const { return mVolumeLODs[detail].notNull(); }
 	S32 getNumRefs() const { return mRefs; }
 	
 	const LLVolumeParams* getVolumeParams() const { return &mVolumeParams; };
@@ -90,6 +92,15 @@ public:
 	virtual LLVolume *refVolume(const LLVolumeParams &volume_params, const S32 detail);
 	virtual void unrefVolume(LLVolume *volumep);
 
+	// TRUE if refVolume() can hand out this LOD without generating it.
+	BOOL hasVolume(const LLVolumeParams &volume_params, const S32 detail) const;
+
+	// Takes a volume that was generated off the main thread and shares it
+	// with everything using the same params.  Returns FALSE if nothing
+	// references those params any more or the LOD has been generated in the
+	// meantime, in which case the caller still owns volumep.
+	BOOL adoptVolume(LLVolume *volumep, const S32 detail);
+
 	void dump();
 
 	// manually call this for mutex magic
@@ -0,0 +1,173 @@
+/**
+ * @file llcamera_test.cpp
+ * @brief Tests batched frustum culling against the single box path.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llcamera.h"
+
+namespace
+{
+	// small deterministic generator so failures are reproducible
+	struct BoxGenerator
+	{
+		BoxGenerator() : mSeed(12345) { }
+
+		F32 next(F32 lo, F32 hi)
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return lo + (hi - lo) * ((mSeed >> 8) / 16777216.f);
+		}
+
+		U32 mSeed;
+	};
+
+	// builds the agent frustum the way LLViewerCamera::updateFrustumPlanes() does
+	void setup_camera(LLCamera& camera, const LLVector3& origin, const LLVector3& at)
+	{
+		camera.lookAt(origin, at);
+		camera.setFar(128.f);
+
+		F32 tan_y = tanf(camera.getView() * 0.5f);
+		F32 tan_x = tan_y * camera.getAspect();
+		LLVector3 near_center = origin + camera.getAtAxis() * camera.getNear();
+		LLVector3 right = camera.getLeftAxis() * (-camera.getNear() * tan_x);
+		LLVector3 up = camera.getUpAxis() * (camera.getNear() * tan_y);
+
+		// bottom left, bottom right, top right, top left
+		LLVector3 frust[8];
+		frust[0] = near_center - right - up;
+		frust[1] = near_center + right - up;
+		frust[2] = near_center + right + up;
+		frust[3] = near_center - right + up;
+		for (U32 i = 0; i < 4; i++)
+		{
+			LLVector3 vec = frust[i] - origin;
+			vec.normVec();
+			frust[i+4] = origin + vec * camera.getFar();
+		}
+
+		camera.calcAgentFrustumPlanes(frust);
+	}
+}
+
+namespace tut
+{
+	struct llcamera_data
+	{
+		void compare(LLCamera& camera, const LLPlane* planes, bool far_clip, const std::string& msg)
+		{
+			BoxGenerator gen;
+			for (S32 pass = 0; pass < 200; ++pass)
+			{
+				LLAABBBatch batch;
+				LLVector4a centers[LLAABBBatch::MAX_BOXES];
+				LLVector4a radii[LLAABBBatch::MAX_BOXES];
+
+				// vary the batch size to cover partially filled registers
+				S32 count = 1 + (pass % LLAABBBatch::MAX_BOXES);
+				for (S32 i = 0; i < count; ++i)
+				{
+					centers[i].set(gen.next(-200.f, 200.f), gen.next(-200.f, 200.f), gen.next(-50.f, 150.f));
+					radii[i].set(gen.next(0.1f, 40.f), gen.next(0.1f, 40.f), gen.next(0.1f, 40.f));
+					batch.add(centers[i], radii[i]);
+				}
+
+				S32 results[LLAABBBatch::MAX_BOXES];
+				camera.AABBInFrustum(batch, results, planes, far_clip);
+
+				for (S32 i = 0; i < count; ++i)
+				{
+					S32 expected = far_clip ? camera.AABBInFrustum(centers[i], radii[i], planes)
+											: camera.AABBInFrustumNoFarClip(centers[i], radii[i], planes);
+					ensure_equals(msg.c_str(), results[i], expected);
+				}
+			}
+		}
+	};
+	typedef test_group<llcamera_data> llcamera_test;
+	typedef llcamera_test::object llcamera_object;
+	tut::llcamera_test tut_llcamera("LLCamera");
+
+	template<> template<>
+	void llcamera_object::test<1>()
+	{
+		set_test_name("batched AABBInFrustum matches single box test");
+
+		LLCamera camera;
+		setup_camera(camera, LLVector3(0.f, 0.f, 20.f), LLVector3(50.f, 30.f, 10.f));
+		compare(camera, NULL, true, "far clip");
+		compare(camera, NULL, false, "no far clip");
+
+		setup_camera(camera, LLVector3(-30.f, 10.f, 60.f), LLVector3(0.f, -40.f, 0.f));
+		compare(camera, NULL, true, "looking down");
+	}
+
+	template<> template<>
+	void llcamera_object::test<2>()
+	{
+		set_test_name("batched AABBInFrustum with a user clip plane and ignored planes");
+
+		LLCamera camera;
+		setup_camera(camera, LLVector3(0.f, 0.f, 20.f), LLVector3(50.f, 30.f, 10.f));
+
+		LLPlane water(LLVector3(0.f, 0.f, 20.f), LLVector3(0.f, 0.f, 1.f));
+		camera.setUserClipPlane(water);
+		compare(camera, NULL, true, "user clip");
+
+		camera.disableUserClipPlane();
+		camera.ignoreAgentFrustumPlane(LLCamera::AGENT_PLANE_NEAR);
+		compare(camera, NULL, true, "ignored near plane");
+	}
+
+	template<> template<>
+	void llcamera_object::test<3>()
+	{
+		set_test_name("batched AABBInFrustum classifies obvious boxes");
+
+		LLCamera camera;
+		setup_camera(camera, LLVector3(0.f, 0.f, 0.f), LLVector3(10.f, 0.f, 0.f));
+
+		LLAABBBatch batch;
+		LLVector4a center, radius;
+		radius.splat(1.f);
+
+		center.set(20.f, 0.f, 0.f);		// straight ahead
+		batch.add(center, radius);
+		center.set(-20.f, 0.f, 0.f);	// behind
+		batch.add(center, radius);
+		radius.splat(1000.f);
+		center.set(0.f, 0.f, 0.f);		// contains the whole frustum
+		batch.add(center, radius);
+
+		S32 results[LLAABBBatch::MAX_BOXES];
+		camera.AABBInFrustum(batch, results);
+		ensure_equals("ahead", results[0], 2);
+		ensure_equals("behind", results[1], 0);
+		ensure_equals("around", results[2], 1);
+	}
+}
@@ -0,0 +1,214 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Tests BVH picks against a brute force triangle loop.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+
+namespace
+{
+	// small deterministic generator so failures are reproducible
+	struct SegmentGenerator
+	{
+		SegmentGenerator() : mSeed(54321) { }
+
+		F32 next(F32 lo, F32 hi)
+		{
+			mSeed = mSeed * 1664525 + 1013904223;
+			return lo + (hi - lo) * ((mSeed >> 8) / 16777216.f);
+		}
+
+		U32 mSeed;
+	};
+
+	// closest hit of every triangle in face, the way the unique volume path does it
+	S32 brute_force(const LLVolumeFace& face, const LLVector4a& start, const LLVector4a& dir, F32& closest_t)
+	{
+		S32 hit = -1;
+		for (S32 j = 0; j < face.mNumIndices / 3; ++j)
+		{
+			F32 a, b, t;
+			if (LLTriangleRayIntersect(face.mPositions[face.mIndices[j * 3 + 0]],
+									   face.mPositions[face.mIndices[j * 3 + 1]],
+									   face.mPositions[face.mIndices[j * 3 + 2]],
+									   start, dir, a, b, t)
+				&& t >= 0.f && t <= 1.f && t < closest_t)
+			{
+				closest_t = t;
+				hit = j;
+			}
+		}
+		return hit;
+	}
+
+	LLVolume* make_volume(U8 profile, U8 path, F32 detail)
+	{
+		LLVolumeParams params;
+		params.setType(profile, path);
+		return new LLVolume(params, detail);
+	}
+}
+
+namespace tut
+{
+	struct llvolumebvh_data
+	{
+		// fires segments from around the unit box through the face and counts
+		// picks that disagree with the brute force test
+		S32 compare(const LLVolumeFace& face, const LLVolumeBVH* bvh, S32 count, SegmentGenerator& gen)
+		{
+			S32 mismatches = 0;
+			for (S32 i = 0; i < count; ++i)
+			{
+				LLVector4a start(gen.next(-1.f, 1.f), gen.next(-1.f, 1.f), gen.next(-1.f, 1.f));
+				LLVector4a end(gen.next(-1.f, 1.f), gen.next(-1.f, 1.f), gen.next(-1.f, 1.f));
+				LLVector4a dir;
+				dir.setSub(end, start);
+
+				F32 expected_t = 2.f;
+				S32 expected = brute_force(face, start, dir, expected_t);
+
+				F32 t = 2.f, a = 0.f, b = 0.f;
+				S32 hit = bvh->intersect(start, dir, t, a, b);
+
+				// a hit on an edge shared by two triangles may land on either
+				if ((hit >= 0) != (expected >= 0) || (hit >= 0 && fabsf(t - expected_t) > 1.0e-4f))
+				{
+					++mismatches;
+				}
+			}
+			return mismatches;
+		}
+
+		S32 compare(LLVolume* volume, S32 count)
+		{
+			SegmentGenerator gen;
+			S32 mismatches = 0;
+			for (S32 f = 0; f < volume->getNumVolumeFaces(); ++f)
+			{
+				const LLVolumeFace& face = volume->getVolumeFace(f);
+				LLPointer<LLVolumeBVH> bvh = new LLVolumeBVH(face);
+				bvh->build();
+				ensure("built", bvh->isBuilt());
+				ensure_equals("triangles", (S32) bvh->getNumTriangles(), face.mNumIndices / 3);
+
+				mismatches += compare(face, bvh, count, gen);
+			}
+			return mismatches;
+		}
+	};
+	typedef test_group<llvolumebvh_data> llvolumebvh_test;
+	typedef llvolumebvh_test::object llvolumebvh_object;
+	tut::llvolumebvh_test tut_llvolumebvh("LLVolumeBVH");
+
+	template<> template<>
+	void llvolumebvh_object::test<1>()
+	{
+		set_test_name("BVH picks match the brute force test");
+
+		LLPointer<LLVolume> box = make_volume(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE, 1.f);
+		ensure_equals("box", compare(box, 500), 0);
+
+		// enough triangles for a deep tree
+		LLPointer<LLVolume> sphere = make_volume(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE, 4.f);
+		ensure_equals("sphere", compare(sphere, 2000), 0);
+	}
+
+	template<> template<>
+	void llvolumebvh_object::test<2>()
+	{
+		set_test_name("LLVolume::lineSegmentIntersect through the face trees");
+
+		LLPointer<LLVolume> sphere = make_volume(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE, 2.f);
+
+		LLVector4a start(2.f, 0.05f, 0.1f);
+		LLVector4a end(-2.f, 0.05f, 0.1f);
+		LLVector4a intersection;
+		S32 face = sphere->lineSegmentIntersect(start, end, -1, &intersection);
+		ensure("hit", face >= 0);
+		ensure("near side", intersection[0] > 0.45f && intersection[0] < 0.5f);
+
+		// the segment stops short of the sphere
+		end.set(1.f, 0.05f, 0.1f);
+		ensure_equals("miss", sphere->lineSegmentIntersect(start, end, -1, &intersection), -1);
+	}
+
+	template<> template<>
+	void llvolumebvh_object::test<3>()
+	{
+		set_test_name("BVH memory accounting");
+
+		S32 before = LLVolumeBVH::getTotalMemoryUsage();
+
+		LLPointer<LLVolume> sphere = make_volume(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE, 2.f);
+		LLPointer<LLVolumeBVH> bvh = new LLVolumeBVH(sphere->getVolumeFace(0));
+		bvh->build();
+
+		ensure("nodes", bvh->getNumNodes() > 1);
+		ensure("leaves hold up to four triangles", bvh->getNumNodes() < bvh->getNumTriangles());
+		ensure_equals("counted", LLVolumeBVH::getTotalMemoryUsage() - before, (S32) bvh->getMemoryUsage());
+
+		bvh = NULL;
+		ensure_equals("released", LLVolumeBVH::getTotalMemoryUsage(), before);
+	}
+
+	template<> template<>
+	void llvolumebvh_object::test<4>()
+	{
+		set_test_name("refit to moved vertices");
+
+		LLPointer<LLVolume> sphere = make_volume(LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE, 4.f);
+		LLVolumeFace& face = const_cast<LLVolumeFace&>(sphere->getVolumeFace(0));
+
+		LLPointer<LLVolumeBVH> bvh = new LLVolumeBVH(face);
+		ensure("nothing to refit before the build", !bvh->refit(face));
+		bvh->build();
+		S32 nodes = (S32) bvh->getNumNodes();
+		S32 memory = LLVolumeBVH::getTotalMemoryUsage();
+
+		// bend and stretch the sphere the way skinning moves a mesh, far
+		// enough that the old bounds miss most of it
+		for (S32 i = 0; i < face.mNumVertices; ++i)
+		{
+			LLVector4a& v = face.mPositions[i];
+			v.set(v[0] * 1.6f + 0.2f, v[1] + 0.8f * v[0] * v[0] - 0.3f, v[2] * 0.5f);
+		}
+
+		ensure("refit", bvh->refit(face));
+		ensure_equals("same tree", (S32) bvh->getNumNodes(), nodes);
+		ensure_equals("no new memory", LLVolumeBVH::getTotalMemoryUsage(), memory);
+
+		SegmentGenerator gen;
+		ensure_equals("refit picks", compare(face, bvh, 2000, gen), 0);
+
+		// the face can't be matched against a tree of another triangle count
+		LLPointer<LLVolume> box = make_volume(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE, 1.f);
+		ensure("other face", !bvh->refit(box->getVolumeFace(0)));
+	}
+}
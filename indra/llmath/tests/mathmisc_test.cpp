@@ -35,6 +35,7 @@
 
 #include "../llline.h"
 #include "../llmath.h"
+#include "../llquantize.h"
 #include "../llsphere.h"
 #include "../v3math.h"
 
@@ -168,6 +169,45 @@ namespace tut
 		angle =  llsimple_angle(angle);
 		ensure("llsimple_angle  value 1", (angle <=F_PI && angle >= -F_PI));
 	}
+
+	template<> template<>
+	void math_object::test<12>()
+	{
+		// U16_to_F32_batch() must be bit-identical to the scalar U16_to_F32(),
+		// including the zero snapping, for both the SIMD body and the tail.
+		const S32 COUNT = 19;
+		const F32 ranges[][2] = { { -128.f, 384.f }, { -256.f, 256.f }, { -1.f, 1.f }, { 0.f, 4096.f }, { -64.f, 64.f } };
+		U16 ival[COUNT];
+		F32 lower[COUNT];
+		F32 upper[COUNT];
+		F32 batch[COUNT];
+
+		for (S32 pass = 0; pass < 200; ++pass)
+		{
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				switch ((pass + i) % 6)
+				{
+				case 0: ival[i] = 0; break;
+				case 1: ival[i] = U16MAX; break;
+				case 2: ival[i] = 32767; break;
+				case 3: ival[i] = 32768; break;
+				default: ival[i] = (U16)ll_rand(U16MAX + 1); break;
+				}
+				const F32* range = ranges[(pass * 7 + i) % LL_ARRAY_SIZE(ranges)];
+				lower[i] = range[0];
+				upper[i] = range[1];
+			}
+
+			U16_to_F32_batch(ival, lower, upper, batch, COUNT);
+
+			for (S32 i = 0; i < COUNT; ++i)
+			{
+				F32 scalar = U16_to_F32(ival[i], lower[i], upper[i]);
+				ensure("U16_to_F32_batch matches U16_to_F32", memcmp(&scalar, &batch[i], sizeof(F32)) == 0);
+			}
+		}
+	}
 }
 
 namespace tut
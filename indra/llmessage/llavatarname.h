@@ -34,6 +34,8 @@ class LLSD;
 
 class LL_COMMON_API LLAvatarName
 {
+	friend class LLAvatarNameCacheFile; // <FS/> Binary avatar name cache
+
 public:
 	LLAvatarName();
 	
@@ -45,6 +45,7 @@
 #include "llcorehttputil.h"
 #include "llexception.h"
 #include "stringize.h"
+#include "lltrace.h" // <FS/> Binary avatar name cache
 
 #include <map>
 #include <set>
@@ -56,9 +57,36 @@ const F64 TEMP_CACHE_ENTRY_LIFETIME = 60.0;
 // Maximum time an unrefreshed cache entry is allowed.
 const F64 MAX_UNREFRESHED_TIME = 20.0 * 60.0;
 
-// Send bulk lookup requests a few times a second at most.
-// Only need per-frame timing resolution.
-static LLFrameTimer sRequestTimer;
+// <FS> Binary avatar name cache
+//// Send bulk lookup requests a few times a second at most.
+//// Only need per-frame timing resolution.
+//static LLFrameTimer sRequestTimer;
+
+// Queued lookups are sent as soon as they fill a request, or once the
+// oldest of them has waited this long.  100 ms is the threshold for "user
+// speed" operations.
+static const F64 NAME_REQUEST_DEADLINE = 0.1;
+// Limits the burst when a busy region queues thousands of names at once.
+static const S32 MAX_NAME_REQUESTS_PER_IDLE = 4;
+
+// URL format is like:
+// http://pdp60.lindenlab.com:8000/agents/?ids=3941037e-78ab-45f0-b421-bd6e77c1804d&ids=0012809d-7d2d-4c24-9609-af1230a37715&ids=0019aaba-24af-4f0a-aa72-6457953cf7f0
+//
+// Apache can handle URLs of 4096 chars, but let's be conservative
+static const U32 NAME_URL_MAX = 4096;
+static const U32 NAME_URL_SEND_THRESHOLD = 3500;
+// "?ids=" or "&ids=" plus the id itself
+static const U32 NAME_URL_CHARS_PER_ID = 5 + UUID_STR_LENGTH - 1;
+// gCacheName batches these by itself
+static const U32 LEGACY_NAME_REQUESTS = 100;
+
+static LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > sNameCacheHitRate("avatar_name_cache_hits",
+	"Avatar name lookups answered from the cache");
+static LLTrace::EventStatHandle<> sNameRequestBatchSize("avatar_name_request_batch",
+	"Avatar ids per name lookup request");
+static LLTrace::CountStatHandle<> sNameRequestCount("avatar_name_requests",
+	"Avatar name lookup requests sent");
+// </FS>
 
 // static to avoid unnessesary dependencies
 LLCore::HttpRequest::ptr_t		sHttpRequest;
@@ -118,6 +146,8 @@ LLAvatarNameCache::LLAvatarNameCache()
 
     mUsePeopleAPI = true;
 
+    mAskQueueDeadline = 0.0; // <FS/> Binary avatar name cache
+
     sHttpRequest = LLCore::HttpRequest::ptr_t(new LLCore::HttpRequest());
     sHttpHeaders = LLCore::HttpHeaders::ptr_t(new LLCore::HttpHeaders());
     sHttpOptions = LLCore::HttpOptions::ptr_t(new LLCore::HttpOptions());
@@ -279,7 +309,10 @@ void LLAvatarNameCache::handleAvNameCacheSuccess(const LLSD &data, const LLSD &h
 // Provide some fallback for agents that return errors
 void LLAvatarNameCache::handleAgentError(const LLUUID& agent_id)
 {
-	std::map<LLUUID,LLAvatarName>::iterator existing = mCache.find(agent_id);
+	// <FS> Binary avatar name cache
+	//std::map<LLUUID,LLAvatarName>::iterator existing = mCache.find(agent_id);
+	cache_t::iterator existing = findCachedName(agent_id);
+	// </FS>
 	if (existing == mCache.end())
     {
 		// <FS:Ansariel> Don't re-request names for agents with null uuid.
@@ -323,7 +356,10 @@ void LLAvatarNameCache::processName(const LLUUID& agent_id, const LLAvatarName&
 
     bool updated_account = true; // assume obsolete value for new arrivals by default
 
-    std::map<LLUUID, LLAvatarName>::iterator it = mCache.find(agent_id);
+    // <FS> Binary avatar name cache
+    //std::map<LLUUID, LLAvatarName>::iterator it = mCache.find(agent_id);
+    cache_t::iterator it = findCachedName(agent_id);
+    // </FS>
     if (it != mCache.end()
         && (*it).second.getAccountName() == av_name.getAccountName())
     {
@@ -362,12 +398,15 @@ void LLAvatarNameCache::requestNamesViaCapability()
 {
 	F64 now = LLFrameTimer::getTotalSeconds();
 
-	// URL format is like:
-	// http://pdp60.lindenlab.com:8000/agents/?ids=3941037e-78ab-45f0-b421-bd6e77c1804d&ids=0012809d-7d2d-4c24-9609-af1230a37715&ids=0019aaba-24af-4f0a-aa72-6457953cf7f0
-	//
-	// Apache can handle URLs of 4096 chars, but let's be conservative
-	static const U32 NAME_URL_MAX = 4096;
-	static const U32 NAME_URL_SEND_THRESHOLD = 3500;
+	// <FS> Binary avatar name cache
+	//// URL format is like:
+	//// http://pdp60.lindenlab.com:8000/agents/?ids=3941037e-78ab-45f0-b421-bd6e77c1804d&ids=0012809d-7d2d-4c24-9609-af1230a37715&ids=0019aaba-24af-4f0a-aa72-6457953cf7f0
+	////
+	//// Apache can handle URLs of 4096 chars, but let's be conservative
+	//static const U32 NAME_URL_MAX = 4096;
+	//static const U32 NAME_URL_SEND_THRESHOLD = 3500;
+	const U32 batch_size = getCapabilityBatchSize();
+	// </FS>
 
 	std::string url;
 	url.reserve(NAME_URL_MAX);
@@ -377,7 +416,10 @@ void LLAvatarNameCache::requestNamesViaCapability()
 	
 	U32 ids = 0;
 	ask_queue_t::const_iterator it;
-	while(!mAskQueue.empty())
+	// <FS> Binary avatar name cache
+	//while(!mAskQueue.empty())
+	while (!mAskQueue.empty() && ids < batch_size)
+	// </FS>
 	{
 		it = mAskQueue.begin();
 		LLUUID agent_id = *it;
@@ -411,6 +453,10 @@ void LLAvatarNameCache::requestNamesViaCapability()
     if (!url.empty())
     {
         LL_DEBUGS("AvNameCache") << "requested " << ids << " ids" << LL_ENDL;
+        // <FS> Binary avatar name cache
+        LLTrace::record(sNameRequestBatchSize, (F64)ids);
+        LLTrace::add(sNameRequestCount, 1);
+        // </FS>
 
         std::string coroname = 
             LLCoros::instance().launch("LLAvatarNameCache::requestAvatarNameCache_",
@@ -430,7 +476,10 @@ void LLAvatarNameCache::legacyNameCallback(const LLUUID& agent_id,
 	// Retrieve the name and set it to never (or almost never...) expire: when we are using the legacy
 	// protocol, we do not get an expiration date for each name and there's no reason to ask the 
 	// data again and again so we set the expiration time to the largest value admissible.
-	std::map<LLUUID,LLAvatarName>::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+	// <FS> Binary avatar name cache
+	//std::map<LLUUID,LLAvatarName>::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+	cache_t::iterator av_record = LLAvatarNameCache::getInstance()->mCache.find(agent_id);
+	// </FS>
 	LLAvatarName& av_name = av_record->second;
 	av_name.setExpires(MAX_UNREFRESHED_TIME);
 }
@@ -454,10 +503,18 @@ void LLAvatarNameCache::legacyNameFetch(const LLUUID& agent_id,
 
 void LLAvatarNameCache::requestNamesViaLegacy()
 {
-	static const S32 MAX_REQUESTS = 100;
+	// <FS> Binary avatar name cache
+	//static const S32 MAX_REQUESTS = 100;
+	static const S32 MAX_REQUESTS = LEGACY_NAME_REQUESTS;
+	// </FS>
 	F64 now = LLFrameTimer::getTotalSeconds();
 	std::string full_name;
 	ask_queue_t::const_iterator it;
+	// <FS> Binary avatar name cache
+	S32 batch = llmin((S32)mAskQueue.size(), MAX_REQUESTS);
+	LLTrace::record(sNameRequestBatchSize, (F64)batch);
+	LLTrace::add(sNameRequestCount, 1);
+	// </FS>
 	for (S32 requests = 0; !mAskQueue.empty() && requests < MAX_REQUESTS; ++requests)
 	{
 		it = mAskQueue.begin();
@@ -479,6 +536,10 @@ void LLAvatarNameCache::requestNamesViaLegacy()
 void LLAvatarNameCache::clearCache()
 {
 	mCache.clear();
+	// <FS> Binary avatar name cache
+	mStoredNames.unmap();
+	mStoredNameTaken.clear();
+	// </FS>
 }
 // </FS:Ansariel>
 
@@ -514,6 +575,7 @@ bool LLAvatarNameCache::importFile(std::istream& istr)
 
 void LLAvatarNameCache::exportFile(std::ostream& ostr)
 {
+	takeStoredNames(); // <FS/> Binary avatar name cache
 	LLSD agents;
 	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
     LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << mCache.size() << LL_ENDL;
@@ -535,6 +597,105 @@ void LLAvatarNameCache::exportFile(std::ostream& ostr)
 	LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+// <FS> Binary avatar name cache
+bool LLAvatarNameCache::importBinaryFile(const std::string& filename)
+{
+	takeStoredNames();
+	if (mStoredNames.map(filename) != LLAvatarNameCacheFile::LOAD_OK)
+	{
+		return false;
+	}
+	mStoredNameTaken.assign(mStoredNames.getCount(), false);
+	LL_INFOS("AvNameCache") << "LLAvatarNameCache mapped " << mStoredNames.getCount() << LL_ENDL;
+	return true;
+}
+
+bool LLAvatarNameCache::exportBinaryFile(const std::string& filename)
+{
+	// the file may be the one still mapped
+	takeStoredNames();
+
+	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+	LL_INFOS("AvNameCache") << "LLAvatarNameCache at exit cache has " << mCache.size() << LL_ENDL;
+	LLAvatarNameCacheFile file;
+	file.reserve((S32)mCache.size());
+	S32 count = 0;
+	for (cache_t::const_iterator it = mCache.begin(); it != mCache.end(); ++it)
+	{
+		// Do not write temporary or expired entries to the stored cache
+		if (it->second.isValidName(max_unrefreshed))
+		{
+			file.addName(it->first, it->second);
+			++count;
+		}
+	}
+	LL_INFOS("AvNameCache") << "LLAvatarNameCache returning " << count << LL_ENDL;
+	return file.save(filename);
+}
+
+LLAvatarNameCache::cache_t::iterator LLAvatarNameCache::findCachedName(const LLUUID& agent_id)
+{
+	cache_t::iterator it = mCache.find(agent_id);
+	if (it != mCache.end() || !mStoredNames.isMapped())
+	{
+		return it;
+	}
+	S32 index = mStoredNames.find(agent_id);
+	if (index < 0 || mStoredNameTaken[index])
+	{
+		return it;
+	}
+	mStoredNameTaken[index] = true;
+
+	// Names this old would have gone in the first eraseUnrefreshed() had
+	// they been imported up front.
+	LLAvatarName av_name;
+	if (!mStoredNames.getName(index, av_name)
+		|| av_name.mExpires < LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME)
+	{
+		return it;
+	}
+	return mCache.insert(std::make_pair(agent_id, av_name)).first;
+}
+
+void LLAvatarNameCache::takeStoredNames()
+{
+	F64 max_unrefreshed = LLFrameTimer::getTotalSeconds() - MAX_UNREFRESHED_TIME;
+	LLAvatarName av_name;
+	for (S32 i = 0; i < mStoredNames.getCount(); ++i)
+	{
+		if (!mStoredNameTaken[i]
+			&& mStoredNames.getName(i, av_name)
+			&& av_name.mExpires >= max_unrefreshed)
+		{
+			// names looked up since are newer
+			mCache.insert(std::make_pair(mStoredNames.getID(i), av_name));
+		}
+	}
+	mStoredNames.unmap();
+	mStoredNameTaken.clear();
+}
+
+void LLAvatarNameCache::queueRequest(const LLUUID& agent_id)
+{
+	if (mAskQueue.empty())
+	{
+		mAskQueueDeadline = LLFrameTimer::getTotalSeconds() + NAME_REQUEST_DEADLINE;
+	}
+	mAskQueue.insert(agent_id);
+}
+
+U32 LLAvatarNameCache::getCapabilityBatchSize() const
+{
+	U32 base = (U32)mNameLookupURL.size();
+	if (base + NAME_URL_CHARS_PER_ID >= NAME_URL_SEND_THRESHOLD)
+	{
+		return 1;
+	}
+	return (NAME_URL_SEND_THRESHOLD - base) / NAME_URL_CHARS_PER_ID;
+}
+// </FS>
+
 void LLAvatarNameCache::setNameLookupURL(const std::string& name_lookup_url)
 {
 	mNameLookupURL = name_lookup_url;
@@ -560,33 +721,57 @@ void LLAvatarNameCache::idle()
 	// By convention, start running at first idle() call
 	mRunning = true;
 
-	// *TODO: Possibly re-enabled this based on People API load measurements
-	// 100 ms is the threshold for "user speed" operations, so we can
-	// stall for about that long to batch up requests.
-	const F32 SECS_BETWEEN_REQUESTS = 0.1f;
-	if (!sRequestTimer.hasExpired())
-	{
-		return;
-	}
+	// <FS> Binary avatar name cache
+	//// *TODO: Possibly re-enabled this based on People API load measurements
+	//// 100 ms is the threshold for "user speed" operations, so we can
+	//// stall for about that long to batch up requests.
+	//const F32 SECS_BETWEEN_REQUESTS = 0.1f;
+	//if (!sRequestTimer.hasExpired())
+	//{
+	//	return;
+	//}
+	//
+	//if (!mAskQueue.empty())
+	//{
+	//    if (usePeopleAPI())
+	//    {
+	//        requestNamesViaCapability();
+	//    }
+	//    else
+	//    {
+	//        LL_WARNS_ONCE("AvNameCache") << "LLAvatarNameCache still using legacy api" << LL_ENDL;
+	//        requestNamesViaLegacy();
+	//    }
+	//}
+	//
+	//if (mAskQueue.empty())
+	//{
+	//	// cleared the list, reset the request timer.
+	//	sRequestTimer.resetWithExpiry(SECS_BETWEEN_REQUESTS);
+	//}
 
+	// Full requests go out right away, a partly filled one once its oldest
+	// id has waited NAME_REQUEST_DEADLINE.
 	if (!mAskQueue.empty())
 	{
-        if (usePeopleAPI())
-        {
-            requestNamesViaCapability();
-        }
-        else
-        {
-            LL_WARNS_ONCE("AvNameCache") << "LLAvatarNameCache still using legacy api" << LL_ENDL;
-            requestNamesViaLegacy();
-        }
-	}
-
-	if (mAskQueue.empty())
-	{
-		// cleared the list, reset the request timer.
-		sRequestTimer.resetWithExpiry(SECS_BETWEEN_REQUESTS);
+		const bool use_people_api = usePeopleAPI();
+		const U32 batch_size = use_people_api ? getCapabilityBatchSize() : LEGACY_NAME_REQUESTS;
+		const bool deadline_passed = LLFrameTimer::getTotalSeconds() >= mAskQueueDeadline;
+		for (S32 requests = 0; requests < MAX_NAME_REQUESTS_PER_IDLE && !mAskQueue.empty()
+			 && (deadline_passed || mAskQueue.size() >= batch_size); ++requests)
+		{
+			if (use_people_api)
+			{
+				requestNamesViaCapability();
+			}
+			else
+			{
+				LL_WARNS_ONCE("AvNameCache") << "LLAvatarNameCache still using legacy api" << LL_ENDL;
+				requestNamesViaLegacy();
+			}
+		}
 	}
+	// </FS>
 
     // erase anything that has not been refreshed for more than MAX_UNREFRESHED_TIME
     eraseUnrefreshed();
@@ -657,7 +842,14 @@ bool LLAvatarNameCache::getName(const LLUUID& agent_id, LLAvatarName *av_name)
 	if (mRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+		// <FS> Binary avatar name cache
+		//std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+		cache_t::iterator it = findCachedName(agent_id);
+		// Counted like getNameCallback(): an expired entry is still handed
+		// back here but has to be fetched again, so it is a miss.
+		const bool fresh = it != mCache.end() && it->second.mExpires > LLFrameTimer::getTotalSeconds();
+		LLTrace::record(sNameCacheHitRate, LLUnits::Ratio::fromValue(fresh ? 1 : 0));
+		// </FS>
 		if (it != mCache.end())
 		{
 			*av_name = it->second;
@@ -682,7 +874,10 @@ bool LLAvatarNameCache::getName(const LLUUID& agent_id, LLAvatarName *av_name)
 				{
 					LL_DEBUGS("AvNameCache") << "LLAvatarNameCache refresh agent " << agent_id
 											 << LL_ENDL;
-					mAskQueue.insert(agent_id);
+					// <FS> Binary avatar name cache
+					//mAskQueue.insert(agent_id);
+					queueRequest(agent_id);
+					// </FS>
 				}
 			}
 				
@@ -693,7 +888,10 @@ bool LLAvatarNameCache::getName(const LLUUID& agent_id, LLAvatarName *av_name)
 	if (!isRequestPending(agent_id))
 	{
 		LL_DEBUGS("AvNameCache") << "LLAvatarNameCache queue request for agent " << agent_id << LL_ENDL;
-		mAskQueue.insert(agent_id);
+		// <FS> Binary avatar name cache
+		//mAskQueue.insert(agent_id);
+		queueRequest(agent_id);
+		// </FS>
 	}
 
 	return false;
@@ -721,7 +919,10 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::getNameCallback(cons
 	if (mRunning)
 	{
 		// ...only do immediate lookups when cache is running
-		std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+		// <FS> Binary avatar name cache
+		//std::map<LLUUID,LLAvatarName>::iterator it = mCache.find(agent_id);
+		cache_t::iterator it = findCachedName(agent_id);
+		// </FS>
 		if (it != mCache.end())
 		{
 			LLAvatarName& av_name = it->second;
@@ -744,16 +945,21 @@ LLAvatarNameCache::callback_connection_t LLAvatarNameCache::getNameCallback(cons
 			if (av_name.mExpires > LLFrameTimer::getTotalSeconds())
 			{
 				// ...name already exists in cache, fire callback now
+				LLTrace::record(sNameCacheHitRate, LLUnits::Ratio::fromValue(1)); // <FS/> Binary avatar name cache
 				fireSignal(agent_id, slot, av_name);
 				return connection;
 			}
 		}
+		LLTrace::record(sNameCacheHitRate, LLUnits::Ratio::fromValue(0)); // <FS/> Binary avatar name cache
 	}
 
 	// schedule a request
 	if (!isRequestPending(agent_id))
 	{
-		mAskQueue.insert(agent_id);
+		// <FS> Binary avatar name cache
+		//mAskQueue.insert(agent_id);
+		queueRequest(agent_id);
+		// </FS>
 	}
 
 	// always store additional callback, even if request is pending
@@ -816,25 +1022,45 @@ void LLAvatarNameCache::setUseUsernames(bool use)
 
 void LLAvatarNameCache::erase(const LLUUID& agent_id)
 {
-	mCache.erase(agent_id);
+	// <FS> Binary avatar name cache
+	//mCache.erase(agent_id);
+	// taking the stored name first keeps it from coming back
+	cache_t::iterator it = findCachedName(agent_id);
+	if (it != mCache.end())
+	{
+		mCache.erase(it);
+	}
+	// </FS>
 }
 
 void LLAvatarNameCache::fetch(const LLUUID& agent_id) // FS:TM used in LGGContactSets
 {
 	// re-request, even if request is already pending
-	mAskQueue.insert(agent_id);
+	// <FS> Binary avatar name cache
+	//mAskQueue.insert(agent_id);
+	queueRequest(agent_id);
+	// </FS>
 }
 
 void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_name)
 {
 	// *TODO: update timestamp if zero?
+	// <FS> Binary avatar name cache
+	//mCache[agent_id] = av_name;
+	// take any stored name so it can't come back after an erase()
+	findCachedName(agent_id);
 	mCache[agent_id] = av_name;
+	// </FS>
 }
 
 LLUUID LLAvatarNameCache::findIdByName(const std::string& name)
 {
-    std::map<LLUUID, LLAvatarName>::iterator it;
-    std::map<LLUUID, LLAvatarName>::iterator end = mCache.end();
+    // <FS> Binary avatar name cache
+    //std::map<LLUUID, LLAvatarName>::iterator it;
+    //std::map<LLUUID, LLAvatarName>::iterator end = mCache.end();
+    cache_t::iterator it;
+    cache_t::iterator end = mCache.end();
+    // </FS>
     for (it = mCache.begin(); it != end; ++it)
     {
         if (it->second.getUserName() == name)
@@ -843,6 +1069,18 @@ LLUUID LLAvatarNameCache::findIdByName(const std::string& name)
         }
     }
 
+    // <FS> Binary avatar name cache
+    // names still sitting in the cache file
+    LLAvatarName av_name;
+    for (S32 i = 0; i < mStoredNames.getCount(); ++i)
+    {
+        if (!mStoredNameTaken[i] && mStoredNames.getName(i, av_name) && av_name.getUserName() == name)
+        {
+            return mStoredNames.getID(i);
+        }
+    }
+    // </FS>
+
     // Legacy method
     LLUUID id;
     if (gCacheName && gCacheName->getUUID(name, id))
@@ -29,8 +29,11 @@
 #define LLAVATARNAMECACHE_H
 
 #include "llavatarname.h"	// for convenience
+#include "llavatarnamecachefile.h" // <FS/> Binary avatar name cache
 #include "llsingleton.h"
 #include <boost/signals2.hpp>
+#include <boost/unordered_map.hpp> // <FS/> Binary avatar name cache
+#include <boost/unordered_set.hpp> // <FS/> Binary avatar name cache
 #include <set>
 
 class LLSD;
@@ -56,6 +59,13 @@ public:
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// <FS> Binary avatar name cache
+	// Maps the binary cache file; names are read from it as they're asked
+	// for.  Returns false if there is no usable file.
+	bool importBinaryFile(const std::string& filename);
+	bool exportBinaryFile(const std::string& filename);
+	// </FS>
+
 	// On the viewer, usually a simulator capabilities.
 	// If empty, name cache will fall back to using legacy name lookup system.
 	void setNameLookupURL(const std::string& name_lookup_url);
@@ -132,6 +142,13 @@ private:
     void processName(const LLUUID& agent_id,
         const LLAvatarName& av_name);
 
+    // <FS> Binary avatar name cache
+    // Queue agent_id for the next lookup batch.
+    void queueRequest(const LLUUID& agent_id);
+    // How many ids fit into one capability request URL.
+    U32 getCapabilityBatchSize() const;
+    // </FS>
+
     void requestNamesViaCapability();
 
     // Legacy name system callbacks
@@ -187,12 +204,22 @@ private:
     std::string mNameLookupURL;
 
     // Accumulated agent IDs for next query against service
-    typedef std::set<LLUUID> ask_queue_t;
+    // <FS> Binary avatar name cache
+    //typedef std::set<LLUUID> ask_queue_t;
+    typedef boost::unordered_set<LLUUID, FSUUIDHash> ask_queue_t;
+    // </FS>
     ask_queue_t mAskQueue;
+    // <FS> Binary avatar name cache
+    // Time by which whatever is in mAskQueue gets sent, full batch or not.
+    F64 mAskQueueDeadline;
+    // </FS>
 
     // Agent IDs that have been requested, but with no reply.
     // Maps agent ID to frame time request was made.
-    typedef std::map<LLUUID, F64> pending_queue_t;
+    // <FS> Binary avatar name cache
+    //typedef std::map<LLUUID, F64> pending_queue_t;
+    typedef boost::unordered_map<LLUUID, F64, FSUUIDHash> pending_queue_t;
+    // </FS>
     pending_queue_t mPendingQueue;
 
     // Callbacks to fire when we received a name.
@@ -203,9 +230,25 @@ private:
     signal_map_t mSignalMap;
 
     // The cache at last, i.e. avatar names we know about.
-    typedef std::map<LLUUID, LLAvatarName> cache_t;
+    // <FS> Binary avatar name cache
+    //typedef std::map<LLUUID, LLAvatarName> cache_t;
+    typedef boost::unordered_map<LLUUID, LLAvatarName, FSUUIDHash> cache_t;
+    // </FS>
     cache_t mCache;
 
+    // <FS> Binary avatar name cache
+    // Names in the mapped cache file move into mCache when first looked
+    // up.  A taken record is never consulted again, so erased names stay
+    // erased.
+    LLAvatarNameCacheFile mStoredNames;
+    std::vector<bool> mStoredNameTaken;
+
+    // mCache entry for agent_id, taken from the cache file if need be.
+    cache_t::iterator findCachedName(const LLUUID& agent_id);
+    // Moves every name left in the cache file into mCache and unmaps it.
+    void takeStoredNames();
+    // </FS>
+
     // Time when unrefreshed cached names were checked last.
     F64 mLastExpireCheck;
 
@@ -0,0 +1,341 @@
+/**
+ * @file llavatarnamecachefile.cpp
+ * @brief Memory mapped binary store for the avatar name cache.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llavatarnamecachefile.h"
+
+#include "llavatarname.h"
+#include "llfile.h"
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char CACHE_MAGIC[8] = { 'L', 'L', 'A', 'V', 'N', 'A', 'M', 'E' };
+static const U32 EMPTY_BUCKET = 0xffffffff;
+
+static inline U32 align_offset(U32 offset)
+{
+	return (offset + 7) & ~7;
+}
+
+// Must not change between sessions, so not FSUUIDHash.
+static inline U32 bucket_hash(const LLUUID& id)
+{
+	U32 words[4];
+	memcpy(words, id.mData, sizeof(words));
+	return words[0] ^ words[1] ^ words[2] ^ words[3];
+}
+
+LLAvatarNameCacheFile::LLAvatarNameCacheFile()
+:	mData(NULL),
+	mSize(0),
+	mCount(0),
+	mBucketMask(0),
+	mNameRecords(NULL),
+	mBuckets(NULL),
+	mStringPool(NULL),
+	mStringPoolSize(0)
+{
+}
+
+LLAvatarNameCacheFile::~LLAvatarNameCacheFile()
+{
+	unmap();
+}
+
+void LLAvatarNameCacheFile::reserve(S32 names)
+{
+	mRecords.reserve(names);
+	mStrings.reserve(names * 48);
+}
+
+LLAvatarNameCacheFile::StringRef LLAvatarNameCacheFile::addString(const std::string& str)
+{
+	StringRef ref;
+	ref.mOffset = (U32)mStrings.size();
+	ref.mLength = (U32)str.size();
+	mStrings.insert(mStrings.end(), str.begin(), str.end());
+	return ref;
+}
+
+void LLAvatarNameCacheFile::addName(const LLUUID& agent_id, const LLAvatarName& av_name)
+{
+	NameRecord rec;
+	memset(&rec, 0, sizeof(rec));
+	rec.mID = agent_id;
+	rec.mExpires = av_name.mExpires;
+	rec.mNextUpdate = av_name.mNextUpdate;
+	rec.mUsername = addString(av_name.mUsername);
+	rec.mDisplayName = addString(av_name.mDisplayName);
+	rec.mLegacyFirstName = addString(av_name.mLegacyFirstName);
+	rec.mLegacyLastName = addString(av_name.mLegacyLastName);
+	rec.mIsDisplayNameDefault = av_name.mIsDisplayNameDefault ? 1 : 0;
+	mRecords.push_back(rec);
+}
+
+bool LLAvatarNameCacheFile::save(const std::string& filename)
+{
+	// at most half full, so probes stay short
+	U32 bucket_count = 2;
+	while (bucket_count < mRecords.size() * 2)
+	{
+		bucket_count *= 2;
+	}
+	std::vector<U32> buckets(bucket_count, EMPTY_BUCKET);
+	for (U32 i = 0; i < mRecords.size(); ++i)
+	{
+		U32 bucket = bucket_hash(mRecords[i].mID) & (bucket_count - 1);
+		while (buckets[bucket] != EMPTY_BUCKET)
+		{
+			bucket = (bucket + 1) & (bucket_count - 1);
+		}
+		buckets[bucket] = i;
+	}
+
+	Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.mFormatVersion = FORMAT_VERSION;
+	header.mCount = (U32)mRecords.size();
+	header.mBucketCount = bucket_count;
+	header.mStringPoolSize = (U32)mStrings.size();
+	header.mRecordOffset = align_offset(sizeof(Header));
+	header.mBucketOffset = align_offset(header.mRecordOffset + header.mCount * sizeof(NameRecord));
+	header.mStringOffset = align_offset(header.mBucketOffset + bucket_count * sizeof(U32));
+	header.mFileSize = header.mStringOffset + header.mStringPoolSize;
+
+	std::vector<U8> data(header.mFileSize, 0);
+	memcpy(&data[0], &header, sizeof(header));
+	if (!mRecords.empty())
+	{
+		memcpy(&data[header.mRecordOffset], &mRecords[0], mRecords.size() * sizeof(NameRecord));
+	}
+	memcpy(&data[header.mBucketOffset], &buckets[0], buckets.size() * sizeof(U32));
+	if (!mStrings.empty())
+	{
+		memcpy(&data[header.mStringOffset], &mStrings[0], mStrings.size());
+	}
+
+	// a crash half way through must not leave a truncated cache behind
+	std::string temp_name = filename + ".tmp";
+	LLFILE* fp = LLFile::fopen(temp_name, "wb");
+	if (!fp)
+	{
+		LL_WARNS("AvNameCache") << "Unable to create " << temp_name << LL_ENDL;
+		return false;
+	}
+	bool written = fwrite(&data[0], 1, data.size(), fp) == data.size();
+	written = (fclose(fp) == 0) && written;
+	if (written)
+	{
+		// _wrename() won't replace an existing file
+		LLFile::remove(filename, ENOENT);
+		written = (LLFile::rename(temp_name, filename) == 0);
+	}
+	if (!written)
+	{
+		LL_WARNS("AvNameCache") << "Unable to write avatar name cache " << filename << LL_ENDL;
+		LLFile::remove(temp_name, ENOENT);
+	}
+	return written;
+}
+
+LLAvatarNameCacheFile::ELoadResult LLAvatarNameCacheFile::map(const std::string& filename)
+{
+	unmap();
+
+	const U8* data = NULL;
+	size_t size = 0;
+#if LL_WINDOWS
+	HANDLE file = CreateFileW(ll_convert_string_to_wide(filename).c_str(), GENERIC_READ, FILE_SHARE_READ,
+							  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return LOAD_NO_FILE;
+	}
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart >= (LONGLONG)sizeof(Header)
+		&& file_size.QuadPart <= U32_MAX)
+	{
+		HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping)
+		{
+			// the view keeps the mapping and the file alive by itself
+			data = (const U8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			size = (size_t)file_size.QuadPart;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+#else
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return LOAD_NO_FILE;
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == 0 && file_stat.st_size >= (off_t)sizeof(Header)
+		&& (U64)file_stat.st_size <= U32_MAX)
+	{
+		size = (size_t)file_stat.st_size;
+		void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		data = (view != MAP_FAILED) ? (const U8*)view : NULL;
+	}
+	::close(fd);
+#endif
+	if (!data)
+	{
+		// empty, too short to be a cache, or not mappable
+		return LOAD_CORRUPT;
+	}
+
+	mData = data;
+	mSize = size;
+	ELoadResult result = validate(data, size);
+	if (result != LOAD_OK)
+	{
+		unmap();
+	}
+	return result;
+}
+
+void LLAvatarNameCacheFile::unmap()
+{
+	if (mData)
+	{
+#if LL_WINDOWS
+		UnmapViewOfFile(mData);
+#else
+		munmap((void*)mData, mSize);
+#endif
+	}
+	mData = NULL;
+	mSize = 0;
+	mCount = 0;
+	mBucketMask = 0;
+	mNameRecords = NULL;
+	mBuckets = NULL;
+	mStringPool = NULL;
+	mStringPoolSize = 0;
+}
+
+LLAvatarNameCacheFile::ELoadResult LLAvatarNameCacheFile::validate(const U8* data, size_t size)
+{
+	Header header;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+		|| header.mFormatVersion != FORMAT_VERSION)
+	{
+		return LOAD_BAD_FORMAT;
+	}
+
+	// All arithmetic in 64 bits so hostile counts cannot wrap.
+	if (header.mFileSize != size
+		|| header.mCount > S32_MAX
+		|| header.mBucketCount < 2
+		|| (header.mBucketCount & (header.mBucketCount - 1)) != 0
+		|| header.mBucketCount < header.mCount
+		|| (header.mRecordOffset & 7) != 0
+		|| (header.mBucketOffset & 3) != 0
+		|| (U64)header.mRecordOffset + (U64)header.mCount * sizeof(NameRecord) > size
+		|| (U64)header.mBucketOffset + (U64)header.mBucketCount * sizeof(U32) > size
+		|| (U64)header.mStringOffset + header.mStringPoolSize > size)
+	{
+		LL_WARNS("AvNameCache") << "Avatar name cache sections out of range" << LL_ENDL;
+		return LOAD_CORRUPT;
+	}
+
+	mCount = (S32)header.mCount;
+	mBucketMask = header.mBucketCount - 1;
+	mNameRecords = reinterpret_cast<const NameRecord*>(data + header.mRecordOffset);
+	mBuckets = reinterpret_cast<const U32*>(data + header.mBucketOffset);
+	mStringPool = reinterpret_cast<const char*>(data + header.mStringOffset);
+	mStringPoolSize = header.mStringPoolSize;
+	return LOAD_OK;
+}
+
+S32 LLAvatarNameCacheFile::find(const LLUUID& agent_id) const
+{
+	if (!mData)
+	{
+		return -1;
+	}
+	U32 bucket = bucket_hash(agent_id) & mBucketMask;
+	// bounded, in case a damaged table has no empty bucket left
+	for (U32 probes = 0; probes <= mBucketMask; ++probes)
+	{
+		U32 record = mBuckets[bucket];
+		if (record == EMPTY_BUCKET || record >= (U32)mCount)
+		{
+			return -1;
+		}
+		if (mNameRecords[record].mID == agent_id)
+		{
+			return (S32)record;
+		}
+		bucket = (bucket + 1) & mBucketMask;
+	}
+	return -1;
+}
+
+const LLUUID& LLAvatarNameCacheFile::getID(S32 index) const
+{
+	return mNameRecords[index].mID;
+}
+
+bool LLAvatarNameCacheFile::getString(const StringRef& ref, std::string& str) const
+{
+	if ((U64)ref.mOffset + ref.mLength > mStringPoolSize)
+	{
+		return false;
+	}
+	str.assign(mStringPool + ref.mOffset, ref.mLength);
+	return true;
+}
+
+bool LLAvatarNameCacheFile::getName(S32 index, LLAvatarName& av_name) const
+{
+	const NameRecord& rec = mNameRecords[index];
+	if (!getString(rec.mUsername, av_name.mUsername)
+		|| !getString(rec.mDisplayName, av_name.mDisplayName)
+		|| !getString(rec.mLegacyFirstName, av_name.mLegacyFirstName)
+		|| !getString(rec.mLegacyLastName, av_name.mLegacyLastName))
+	{
+		LL_WARNS("AvNameCache") << "Avatar name cache record " << index << " is corrupt" << LL_ENDL;
+		return false;
+	}
+	av_name.mExpires = rec.mExpires;
+	av_name.mNextUpdate = rec.mNextUpdate;
+	av_name.mIsDisplayNameDefault = (rec.mIsDisplayNameDefault != 0);
+	av_name.mIsTemporaryName = false;
+	return true;
+}
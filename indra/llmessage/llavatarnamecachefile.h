@@ -0,0 +1,132 @@
+/**
+ * @file llavatarnamecachefile.h
+ * @brief Memory mapped binary store for the avatar name cache.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLAVATARNAMECACHEFILE_H
+#define LL_LLAVATARNAMECACHEFILE_H
+
+#include "lluuid.h"
+#include <string>
+#include <vector>
+
+class LLAvatarName;
+
+// Binary form of the stored avatar name cache.  The file is a header, fixed
+// size name records, an open addressed hash table of record numbers keyed
+// by agent id and one string pool.  Nothing in it needs parsing: the file
+// is mapped read only and a record is decoded when somebody asks for it,
+// so loading costs the same for ten names as for a hundred thousand.
+//
+// Records are only checked when they are decoded; getName() refuses one
+// whose strings fall outside the pool.
+class LLAvatarNameCacheFile
+{
+public:
+	enum ELoadResult
+	{
+		LOAD_OK,
+		LOAD_NO_FILE,
+		LOAD_BAD_FORMAT,	// wrong magic or layout version
+		LOAD_CORRUPT		// truncated or inconsistent sections
+	};
+
+	// Bump when the record layout below changes.
+	static const U32 FORMAT_VERSION = 1;
+
+	LLAvatarNameCacheFile();
+	~LLAvatarNameCacheFile();
+
+	// Writing
+	void reserve(S32 names);
+	void addName(const LLUUID& agent_id, const LLAvatarName& av_name);
+	// Written to a temporary file first, then moved over filename.  Don't
+	// save over the file this object has mapped.
+	bool save(const std::string& filename);
+
+	// Reading
+	ELoadResult map(const std::string& filename);
+	void unmap();
+	bool isMapped() const		{ return mData != NULL; }
+
+	S32 getCount() const		{ return mCount; }
+	// Record number of agent_id, or -1.
+	S32 find(const LLUUID& agent_id) const;
+	const LLUUID& getID(S32 index) const;
+	bool getName(S32 index, LLAvatarName& av_name) const;
+
+	// File layout
+	struct Header
+	{
+		char	mMagic[8];
+		U32		mFormatVersion;
+		U32		mCount;
+		U32		mBucketCount;	// power of two
+		U32		mRecordOffset;
+		U32		mBucketOffset;
+		U32		mStringOffset;
+		U32		mStringPoolSize;
+		U32		mFileSize;
+	};
+
+	struct StringRef
+	{
+		U32		mOffset;
+		U32		mLength;
+	};
+
+	struct NameRecord
+	{
+		LLUUID		mID;
+		F64			mExpires;
+		F64			mNextUpdate;
+		StringRef	mUsername;
+		StringRef	mDisplayName;
+		StringRef	mLegacyFirstName;
+		StringRef	mLegacyLastName;
+		U8			mIsDisplayNameDefault;
+		U8			mPad[7];
+	};
+
+private:
+	StringRef addString(const std::string& str);
+	bool getString(const StringRef& ref, std::string& str) const;
+	ELoadResult validate(const U8* data, size_t size);
+
+	// writing
+	std::vector<NameRecord>	mRecords;
+	std::vector<char>		mStrings;
+
+	// reading: everything points into the mapping
+	const U8*				mData;
+	size_t					mSize;
+	S32						mCount;
+	U32						mBucketMask;
+	const NameRecord*		mNameRecords;
+	const U32*				mBuckets;
+	const char*				mStringPool;
+	U32						mStringPoolSize;
+};
+
+#endif // LL_LLAVATARNAMECACHEFILE_H
@@ -63,8 +63,6 @@ const S32 PING_START_BLOCK = 3;		// How many pings behind we have to be to consi
 const S32 PING_RELEASE_BLOCK = 2;	// How many pings behind we have to be to consider ourself unblocked.
 
 const F32Seconds TARGET_PERIOD_LENGTH(5.f);
-const F32Seconds LL_DUPLICATE_SUPPRESSION_TIMEOUT(60.f); //this can be long, as time-based cleanup is
-													// only done when wrapping packetids, now...
 
 LLCircuitData::LLCircuitData(const LLHost &host, TPACKETID in_id, 
 							 const F32Seconds circuit_heartbeat_interval, const F32Seconds circuit_timeout)
@@ -276,11 +274,28 @@ void LLCircuitData::ackReliablePacket(TPACKETID packet_num)
 
 
 
+// Orders expired packets by packet id, the order the unacked lists used
+// to be walked in.
+static bool packet_id_less(const LLTimingWheelEntry* lhs, const LLTimingWheelEntry* rhs)
+{
+	return static_cast<const LLReliablePacket*>(lhs)->getPacketID()
+		< static_cast<const LLReliablePacket*>(rhs)->getPacketID();
+}
+
 S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 {
-	S32 resent_packets = 0;
 	LLReliablePacket *packetp;
 
+	// Only packets whose expiration time has passed come off the wheel, so
+	// a frame costs nothing for circuits with plenty of packets in flight
+	// but nothing due.
+	mExpiredPackets.clear();
+	mResendWheel.collectExpired(now, mExpiredPackets);
+	if (mExpiredPackets.empty())
+	{
+		return mUnackedPacketCount;
+	}
+	std::sort(mExpiredPackets.begin(), mExpiredPackets.end(), packet_id_less);
 
 	//
 	// Theoretically we should search through the list for the packet with the oldest
@@ -289,11 +304,30 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 	// I'm not going to worry about this for now - djs
 	//
 
-	reliable_iter iter;
+	// Expired packets on their final retry are aborted after the resends,
+	// together with any we give up on below.
+	std::vector<LLReliablePacket*> failed_packets;
+
 	BOOL have_resend_overflow = FALSE;
-	for (iter = mUnackedPackets.begin(); iter != mUnackedPackets.end();)
+	BOOL stopped_resending = FALSE;
+	std::vector<LLTimingWheelEntry*>::iterator iter;
+	for (iter = mExpiredPackets.begin(); iter != mExpiredPackets.end(); ++iter)
 	{
-		packetp = iter->second;
+		packetp = static_cast<LLReliablePacket*>(*iter);
+
+		if (!packetp->mRetries)
+		{
+			// On the final retry list
+			failed_packets.push_back(packetp);
+			continue;
+		}
+
+		if (stopped_resending)
+		{
+			// Out of resend bandwidth, try again next frame
+			mResendWheel.schedule(packetp, packetp->mExpirationTime);
+			continue;
+		}
 
 		// Only check overflow if we haven't had one yet.
 		if (!have_resend_overflow)
@@ -309,18 +343,12 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 			// If we have too many unacked packets, we need to start dropping expired ones.
 			if (mUnackedPacketBytes > 512000)
 			{
-				if (now > packetp->mExpirationTime)
-				{
-					// This circuit has overflowed.  Do not retry.  Do not pass go.
-					packetp->mRetries = 0;
-					// Remove it from this list and add it to the final list.
-					mUnackedPackets.erase(iter++);
-					mFinalRetryPackets[packetp->mPacketID] = packetp;
-				}
-				else
-				{
-					++iter;
-				}
+				// This circuit has overflowed.  Do not retry.  Do not pass go.
+				packetp->mRetries = 0;
+				// Remove it from this list and add it to the final list.
+				mUnackedPackets.erase(packetp->mPacketID);
+				mFinalRetryPackets[packetp->mPacketID] = packetp;
+				failed_packets.push_back(packetp);
 				// Move on to the next unacked packet.
 				continue;
 			}
@@ -332,103 +360,86 @@ S32 LLCircuitData::resendUnackedPackets(const F64Seconds now)
 						<< " bytes of reliable messages waiting" << LL_ENDL;
 			}
 			// Stop resending.  There are less than 512000 unacked packets.
-			break;
+			stopped_resending = TRUE;
+			mResendWheel.schedule(packetp, packetp->mExpirationTime);
+			continue;
 		}
 
-		if (now > packetp->mExpirationTime)
-		{
-			packetp->mRetries--;
-			
-			// retry		
-			mCurrentResendCount++;
-
-			gMessageSystem->mResentPackets++;
+		packetp->mRetries--;
+		
+		// retry		
+		mCurrentResendCount++;
 
-			if(gMessageSystem->mVerboseLog)
-			{
-				std::ostringstream str;
-				str << "MSG: -> " << packetp->mHost
-					<< "\tRESENDING RELIABLE:\t" << packetp->mPacketID;
-				LL_INFOS() << str.str() << LL_ENDL;
-			}
+		gMessageSystem->mResentPackets++;
 
-			packetp->mBuffer[0] |= LL_RESENT_FLAG;  // tag packet id as being a resend	
+		if(gMessageSystem->mVerboseLog)
+		{
+			std::ostringstream str;
+			str << "MSG: -> " << packetp->mHost
+				<< "\tRESENDING RELIABLE:\t" << packetp->mPacketID;
+			LL_INFOS() << str.str() << LL_ENDL;
+		}
 
-			gMessageSystem->mPacketRing.sendPacket(packetp->mSocket, 
-											   (char *)packetp->mBuffer, packetp->mBufferLength, 
-											   packetp->mHost);
+		packetp->mBuffer[0] |= LL_RESENT_FLAG;  // tag packet id as being a resend	
 
-			mThrottles.throttleOverflow(TC_RESEND, packetp->mBufferLength * 8.f);
+		gMessageSystem->mPacketRing.sendPacket(packetp->mSocket, 
+										   (char *)packetp->mBuffer, packetp->mBufferLength, 
+										   packetp->mHost);
 
-			// The new method, retry time based on ping
-			if (packetp->mPingBasedRetry)
-			{
-				packetp->mExpirationTime = now + llmax(LL_MINIMUM_RELIABLE_TIMEOUT_SECONDS, F32Seconds(LL_RELIABLE_TIMEOUT_FACTOR * getPingDelayAveraged()));
-			}
-			else
-			{
-				// custom, constant retry time
-				packetp->mExpirationTime = now + packetp->mTimeout;
-			}
+		mThrottles.throttleOverflow(TC_RESEND, packetp->mBufferLength * 8.f);
 
-			if (!packetp->mRetries)
-			{
-				// Last resend, remove it from this list and add it to the final list.
-				mUnackedPackets.erase(iter++);
-				mFinalRetryPackets[packetp->mPacketID] = packetp;
-			}
-			else
-			{
-				// Don't remove it yet, it still gets to try to resend at least once.
-				++iter;
-			}
-			resent_packets++;
+		// The new method, retry time based on ping
+		if (packetp->mPingBasedRetry)
+		{
+			packetp->mExpirationTime = now + llmax(LL_MINIMUM_RELIABLE_TIMEOUT_SECONDS, F32Seconds(LL_RELIABLE_TIMEOUT_FACTOR * getPingDelayAveraged()));
 		}
 		else
 		{
-			// Don't need to do anything with this packet, keep iterating.
-			++iter;
+			// custom, constant retry time
+			packetp->mExpirationTime = now + packetp->mTimeout;
 		}
-	}
-
+		mResendWheel.schedule(packetp, packetp->mExpirationTime);
 
-	for (iter = mFinalRetryPackets.begin(); iter != mFinalRetryPackets.end();)
-	{
-		packetp = iter->second;
-		if (now > packetp->mExpirationTime)
+		if (!packetp->mRetries)
 		{
-			// fail (too many retries)
-			//LL_INFOS() << "Packet " << packetp->mPacketID << " removed from the pending list: exceeded retry limit" << LL_ENDL;
-			//if (packetp->mMessageName)
-			//{
-			//	LL_INFOS() << "Packet name " << packetp->mMessageName << LL_ENDL;
-			//}
-			gMessageSystem->mFailedResendPackets++;
-
-			if(gMessageSystem->mVerboseLog)
-			{
-				std::ostringstream str;
-				str << "MSG: -> " << packetp->mHost << "\tABORTING RELIABLE:\t"
-					<< packetp->mPacketID;
-				LL_INFOS() << str.str() << LL_ENDL;
-			}
-
-			if (packetp->mCallback)
-			{
-				packetp->mCallback(packetp->mCallbackData,LL_ERR_TCP_TIMEOUT);
-			}
+			// Last resend, remove it from this list and add it to the final list.
+			mUnackedPackets.erase(packetp->mPacketID);
+			mFinalRetryPackets[packetp->mPacketID] = packetp;
+		}
+	}
 
-			// Update stats
-			mUnackedPacketCount--;
-			mUnackedPacketBytes -= packetp->mBufferLength;
+	std::vector<LLReliablePacket*>::iterator fail_iter;
+	for (fail_iter = failed_packets.begin(); fail_iter != failed_packets.end(); ++fail_iter)
+	{
+		packetp = *fail_iter;
+
+		// fail (too many retries)
+		//LL_INFOS() << "Packet " << packetp->mPacketID << " removed from the pending list: exceeded retry limit" << LL_ENDL;
+		//if (packetp->mMessageName)
+		//{
+		//	LL_INFOS() << "Packet name " << packetp->mMessageName << LL_ENDL;
+		//}
+		gMessageSystem->mFailedResendPackets++;
 
-			mFinalRetryPackets.erase(iter++);
-			delete packetp;
+		if(gMessageSystem->mVerboseLog)
+		{
+			std::ostringstream str;
+			str << "MSG: -> " << packetp->mHost << "\tABORTING RELIABLE:\t"
+				<< packetp->mPacketID;
+			LL_INFOS() << str.str() << LL_ENDL;
 		}
-		else
+
+		if (packetp->mCallback)
 		{
-			++iter;
+			packetp->mCallback(packetp->mCallbackData,LL_ERR_TCP_TIMEOUT);
 		}
+
+		// Update stats
+		mUnackedPacketCount--;
+		mUnackedPacketBytes -= packetp->mBufferLength;
+
+		mFinalRetryPackets.erase(packetp->mPacketID);
+		delete packetp;
 	}
 
 	return mUnackedPacketCount;
@@ -588,6 +599,7 @@ void LLCircuitData::addReliablePacket(S32 mSocket, U8 *buf_ptr, S32 buf_len, LLR
 	{
 		mFinalRetryPackets[packet_info->mPacketID] = packet_info;
 	}
+	mResendWheel.schedule(packet_info, packet_info->mExpirationTime);
 }
 
 
@@ -610,7 +622,7 @@ void LLCircuit::resendUnackedPackets(S32& unacked_list_length, S32& unacked_list
 
 BOOL LLCircuitData::isDuplicateResend(TPACKETID packetnum)
 {
-	return (mRecentlyReceivedReliablePackets.find(packetnum) != mRecentlyReceivedReliablePackets.end());
+	return mRecentlyReceivedReliablePackets.contains(packetnum);
 }
 
 
@@ -1022,47 +1034,8 @@ void LLCircuitData::clearDuplicateList(TPACKETID oldest_id)
 	// purge old data from the duplicate suppression queue
 
 	// we want to KEEP all x where oldest_id <= x <= last incoming packet, and delete everything else.
-
-	//LL_INFOS() << mHost << ": clearing before oldest " << oldest_id << LL_ENDL;
-	//LL_INFOS() << "Recent list before: " << mRecentlyReceivedReliablePackets.size() << LL_ENDL;
-	if (oldest_id < mHighestPacketID)
-	{
-		// Clean up everything with a packet ID less than oldest_id.
-		packet_time_map::iterator pit_start;
-		packet_time_map::iterator pit_end;
-		pit_start = mRecentlyReceivedReliablePackets.begin();
-		pit_end = mRecentlyReceivedReliablePackets.lower_bound(oldest_id);
-		mRecentlyReceivedReliablePackets.erase(pit_start, pit_end);
-	}
-
-	// Do timeout checks on everything with an ID > mHighestPacketID.
-	// This should be empty except for wrapping IDs.  Thus, this should be
-	// highly rare.
-	U64Microseconds mt_usec = LLMessageSystem::getMessageTimeUsecs();
-
-	packet_time_map::iterator pit;
-	for(pit = mRecentlyReceivedReliablePackets.upper_bound(mHighestPacketID);
-		pit != mRecentlyReceivedReliablePackets.end(); )
-	{
-		// Validate that the packet ID seems far enough away
-		if ((pit->first - mHighestPacketID) < 100)
-		{
-			LL_WARNS() << "Probably incorrectly timing out non-wrapped packets!" << LL_ENDL;
-		}
-		U64Microseconds delta_t_usec = mt_usec - (*pit).second;
-		F64Seconds delta_t_sec = delta_t_usec;
-		if (delta_t_sec > LL_DUPLICATE_SUPPRESSION_TIMEOUT)
-		{
-			// enough time has elapsed we're not likely to get a duplicate on this one
-			LL_INFOS() << "Clearing " << pit->first << " from recent list" << LL_ENDL;
-			mRecentlyReceivedReliablePackets.erase(pit++);
-		}
-		else
-		{
-			++pit;
-		}
-	}
-	//LL_INFOS() << "Recent list after: " << mRecentlyReceivedReliablePackets.size() << LL_ENDL;
+	// Ids left over from before a wrap fall out of the window on their own.
+	mRecentlyReceivedReliablePackets.removeOlderThan(oldest_id);
 }
 
 BOOL LLCircuitData::checkCircuitTimeout()
@@ -1126,25 +1099,10 @@ void LLCircuit::sendAcks(F32 collect_time)
 			if (count>0)
 			{
 				// send the packet acks
-				S32 acks_this_packet = 0;
-				for(S32 i = 0; i < count; ++i)
-				{
-					if(acks_this_packet == 0)
-					{
-						gMessageSystem->newMessageFast(_PREHASH_PacketAck);
-					}
-					gMessageSystem->nextBlockFast(_PREHASH_Packets);
-					gMessageSystem->addU32Fast(_PREHASH_ID, cd->mAcks[i]);
-					++acks_this_packet;
-					if(acks_this_packet > 250)
-					{
-						gMessageSystem->sendMessage(cd->mHost);
-						acks_this_packet = 0;
-					}
-				}
-				if(acks_this_packet > 0)
+				for(S32 i = 0; i < count; i += LLMessageSystem::MAX_ACKS_PER_PACKET)
 				{
-					gMessageSystem->sendMessage(cd->mHost);
+					S32 acks_this_packet = llmin(count - i, LLMessageSystem::MAX_ACKS_PER_PACKET);
+					gMessageSystem->sendPacketAck(cd->mHost, &cd->mAcks[i], acks_this_packet);
 				}
 
 				if(gMessageSystem->mVerboseLog)
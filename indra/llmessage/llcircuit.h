@@ -39,6 +39,8 @@
 #include "llpacketack.h"
 #include "lluuid.h"
 #include "llthrottle.h"
+#include "llpacketidwindow.h"
+#include "lltimingwheel.h"
 
 //
 // Constants
@@ -236,7 +238,7 @@ protected:
 	typedef std::map<TPACKETID, U64Microseconds> packet_time_map;
 
 	packet_time_map							mPotentialLostPackets;
-	packet_time_map							mRecentlyReceivedReliablePackets;
+	LLPacketIDWindow						mRecentlyReceivedReliablePackets;
 	std::vector<TPACKETID> mAcks;
 	F32 mAckCreationTime; // first ack creation time
 
@@ -245,6 +247,8 @@ protected:
 
 	reliable_map							mUnackedPackets;
 	reliable_map							mFinalRetryPackets;
+	LLTimingWheel							mResendWheel;			// expiration times of both lists above
+	std::vector<LLTimingWheelEntry*>		mExpiredPackets;		// scratch space for resendUnackedPackets()
 
 	S32										mUnackedPacketCount;
 	S32										mUnackedPacketBytes;
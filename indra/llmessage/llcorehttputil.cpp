@@ -38,6 +38,10 @@
 #include "json/reader.h" // JSON
 #include "json/writer.h" // JSON
 #include "llfilesystem.h"
+#include "llthread.h"
+#include "llthreadsafequeue.h"
+#include "lltimer.h"
+#include "lltrace.h"
 
 #include "message.h" // for getting the port
 
@@ -56,6 +60,13 @@ namespace
     BoolSettingQuery_t  mBoolSettingGet;
     BoolSettingUpdate_t mBoolSettingPut;
 
+    // Bodies smaller than this are cheaper to decode inline than to hand
+    // off to a worker thread.
+    const S32 LLSD_OFF_THREAD_PARSE_MIN_SIZE = 16 * 1024;
+
+    LLTrace::EventStatHandle<F64Milliseconds> sLLSDMainThreadTime("httpllsdmainthreadtime",
+        "Main thread time spent decoding an LLSD HTTP response");
+
     inline bool getBoolSetting(const std::string &keyname)
     {
         if (!mBoolSettingGet || mBoolSettingGet.empty())
@@ -105,6 +116,16 @@ private:
 };
 
 
+//=========================================================================
+// Flattens a response body and hands it to the buffer based XML LLSD 
+// parser, which is considerably cheaper than streaming it through expat.
+static S32 parseLLSDBody(BufferArray * body, LLSD & out_llsd, bool log)
+{
+    std::vector<char> buffer(body->size());
+    body->read(0, buffer.data(), buffer.size());
+    return LLSDSerialize::fromXMLBuffer(out_llsd, buffer.data(), buffer.size(), log);
+}
+
 //=========================================================================
 // *TODO:  Currently converts only from XML content.  A mode
 // to convert using fromBinary() might be useful as well.  Mesh
@@ -118,9 +139,8 @@ bool responseToLLSD(HttpResponse * response, bool log, LLSD & out_llsd)
         return false;
     }
 
-    LLCore::BufferArrayStream bas(body);
     LLSD body_llsd;
-    S32 parse_status(LLSDSerialize::fromXML(body_llsd, bas, log));
+    S32 parse_status(parseLLSDBody(body, body_llsd, log));
     if (LLSDParser::PARSE_FAILURE == parse_status){
         return false;
     }
@@ -366,6 +386,150 @@ void HttpCoroHandler::writeStatusCodes(LLCore::HttpStatus status, const std::str
 
 }
 
+//=========================================================================
+/// The LLSDParseJob decodes a response body into LLSD on the LLSD parse 
+/// thread.  The body is kept alive by the job, and the coroutine waiting 
+/// for it is resumed through the job's promise once the result is set.
+/// 
+class LLSDParseJob
+{
+public:
+    typedef boost::shared_ptr<LLSDParseJob> ptr_t;
+
+    /// Queues body for decoding.  Returns an empty pointer when the parse 
+    /// thread is full or shut down, the caller then decodes inline.
+    static ptr_t start(LLCore::BufferArray *body);
+
+    /// Suspends the calling coroutine until the job has run.
+    void wait()
+    {
+        mDoneFuture.get();
+    }
+
+    void run()
+    {
+        LLTimer timer;
+        mSuccess = (parseLLSDBody(mBody.get(), mResult, true) != LLSDParser::PARSE_FAILURE);
+        mParseTime = F64Seconds(timer.getElapsedTimeF64());
+        if (!mSuccess)
+        {   // Keep the start of the body for the warning, the same way 
+            // responseToString() does for an inline parse.
+            char content[1024];
+            size_t len(mBody->read(0, content, sizeof(content)));
+            mRawBody.assign(content, len);
+        }
+        mBody.reset();
+        mDone.set_value(true);
+    }
+
+    LLSD        mResult;
+    bool        mSuccess;
+    F64Seconds  mParseTime;
+    std::string mRawBody;
+
+private:
+    LLSDParseJob(LLCore::BufferArray *body) :
+        mResult(),
+        mSuccess(false),
+        mParseTime(0.0),
+        mRawBody(),
+        mBody(),
+        mDone(),
+        mDoneFuture(LLCoros::getFuture(mDone))
+    {
+        body->addRef();
+        mBody = LLCore::BufferArray::ptr_t(body);
+    }
+
+    LLCore::BufferArray::ptr_t  mBody;
+    LLCoros::Promise<bool>      mDone;
+    LLCoros::Future<bool>       mDoneFuture;
+};
+
+//=========================================================================
+/// The one thread all deferred LLSD decoding runs on.  It is started on 
+/// first use and its queue is bounded, so a burst of large responses 
+/// falls back to inline decoding instead of piling up.
+/// 
+class LLSDParseThread : public LLThread
+{
+public:
+    LLSDParseThread() :
+        LLThread("LLSD parse"),
+        mQueue(LLSD_PARSE_QUEUE_SIZE)
+    {
+    }
+
+    bool queue(const LLSDParseJob::ptr_t &job)
+    {
+        return mQueue.tryPushFront(job);
+    }
+
+    /// Jobs already queued are still decoded before the thread exits.
+    void stop()
+    {
+        mQueue.close();
+        shutdown();
+    }
+
+protected:
+    virtual void run()
+    {
+        try
+        {
+            while (true)
+            {
+                mQueue.popBack()->run();
+            }
+        }
+        catch (const LLThreadSafeQueueInterrupt &)
+        {   // closed and drained
+        }
+    }
+
+private:
+    static const U32 LLSD_PARSE_QUEUE_SIZE = 32;
+
+    LLThreadSafeQueue<LLSDParseJob::ptr_t> mQueue;
+};
+
+namespace
+{
+    LLSDParseThread *sLLSDParseThread = NULL;
+    bool sLLSDParseThreadStopped = false;
+}
+
+LLSDParseJob::ptr_t LLSDParseJob::start(LLCore::BufferArray *body)
+{
+    if (sLLSDParseThreadStopped)
+    {
+        return ptr_t();
+    }
+    if (!sLLSDParseThread)
+    {
+        sLLSDParseThread = new LLSDParseThread();
+        sLLSDParseThread->start();
+    }
+
+    ptr_t job(new LLSDParseJob(body));
+    if (!sLLSDParseThread->queue(job))
+    {
+        return ptr_t();
+    }
+    return job;
+}
+
+void cleanupLLSDParseThread()
+{
+    sLLSDParseThreadStopped = true;
+    if (sLLSDParseThread)
+    {
+        sLLSDParseThread->stop();
+        delete sLLSDParseThread;
+        sLLSDParseThread = NULL;
+    }
+}
+
 //=========================================================================
 /// The HttpCoroLLSDHandler is a specialization of the LLCore::HttpHandler for 
 /// interacting with coroutines. When the request is completed the response 
@@ -385,16 +549,26 @@ void HttpCoroHandler::writeStatusCodes(LLCore::HttpStatus status, const std::str
 class HttpCoroLLSDHandler : public HttpCoroHandler
 {
 public:
-    HttpCoroLLSDHandler(LLEventStream &reply);
+    HttpCoroLLSDHandler(LLEventStream &reply, bool parseOffMainThread = false);
+
+    virtual void finishResult(LLSD &result);
 
 protected:
     virtual LLSD handleSuccess(LLCore::HttpResponse * response, LLCore::HttpStatus &status);
     virtual LLSD parseBody(LLCore::HttpResponse *response, bool &success);
+
+private:
+    bool                mParseOffMainThread;
+    bool                mDeferredIsLLSDXml;
+    LLSDParseJob::ptr_t mDeferredParse;
 };
 
 //-------------------------------------------------------------------------
-HttpCoroLLSDHandler::HttpCoroLLSDHandler(LLEventStream &reply):
-    HttpCoroHandler(reply)
+HttpCoroLLSDHandler::HttpCoroLLSDHandler(LLEventStream &reply, bool parseOffMainThread):
+    HttpCoroHandler(reply),
+    mParseOffMainThread(parseOffMainThread),
+    mDeferredIsLLSDXml(false),
+    mDeferredParse()
 {
 }
     
@@ -403,10 +577,27 @@ LLSD HttpCoroLLSDHandler::handleSuccess(LLCore::HttpResponse * response, LLCore:
 {
     LLSD result;
 
+    if (mParseOffMainThread && (response->getBodySize() >= LLSD_OFF_THREAD_PARSE_MIN_SIZE))
+    {   // Leave the decoding to a worker.  The coroutine picks up the parsed 
+        // body in finishResult() once it has been resumed.
+        LLCore::HttpHeaders::ptr_t headers(response->getHeaders());
+        const std::string *contentType = (headers) ? headers->find(HTTP_IN_HEADER_CONTENT_TYPE) : NULL;
+
+        mDeferredIsLLSDXml = (contentType && (HTTP_CONTENT_LLSD_XML == *contentType));
+        mDeferredParse = LLSDParseJob::start(response->getBody());
+        if (mDeferredParse)
+        {
+            return LLSD::emptyMap();
+        }
+    }
+
+    LLTimer parseTimer;
+
 //    const bool emit_parse_errors = false;
     bool success(false);
 
     result = parseBody(response, success);
+    LLTrace::record(sLLSDMainThreadTime, F64Seconds(parseTimer.getElapsedTimeF64()));
 
 #if 0
     bool parsed = !((response->getBodySize() == 0) ||
@@ -482,6 +673,47 @@ LLSD HttpCoroLLSDHandler::parseBody(LLCore::HttpResponse *response, bool &succes
 }
 
 
+void HttpCoroLLSDHandler::finishResult(LLSD &result)
+{
+    if (!mDeferredParse)
+        return;
+
+    LLSDParseJob::ptr_t job(mDeferredParse);
+    mDeferredParse.reset();
+
+    job->wait();
+
+    LLTimer mergeTimer;
+    LLSD &httpResults = result[HttpCoroutineAdapter::HTTP_RESULTS];
+
+    if (!job->mSuccess)
+    {
+        // Same handling as an inline parse failure in handleSuccess().
+        if (mDeferredIsLLSDXml)
+        {
+            std::string url = httpResults[HttpCoroutineAdapter::HTTP_RESULTS_URL].asString();
+            LL_WARNS("CoreHTTP") << "Failed to deserialize . " << url
+                << " body: " << job->mRawBody << LL_ENDL;
+
+            writeStatusCodes(LLCore::HttpStatus(499, "Failed to deserialize LLSD."), url, httpResults);
+        }
+    }
+    else if (job->mResult.isMap())
+    {
+        LLSD httpResultsCopy = httpResults;
+        result = job->mResult;
+        result[HttpCoroutineAdapter::HTTP_RESULTS] = httpResultsCopy;
+    }
+    else
+    {
+        result[HttpCoroutineAdapter::HTTP_RESULTS_CONTENT] = job->mResult;
+    }
+
+    LLTrace::record(sLLSDMainThreadTime, F64Seconds(mergeTimer.getElapsedTimeF64()));
+    LL_DEBUGS("CoreHTTP") << "Decoded LLSD off the main thread in " << job->mParseTime.value() * 1000.0
+        << " ms, main thread merge took " << mergeTimer.getElapsedTimeF64() * 1000.0 << " ms" << LL_ENDL;
+}
+
 //========================================================================
 /// The HttpCoroRawHandler is a specialization of the LLCore::HttpHandler for 
 /// interacting with coroutines. 
@@ -678,7 +910,8 @@ HttpCoroutineAdapter::HttpCoroutineAdapter(const std::string &name,
     mPriority(priority),
     mYieldingHandle(LLCORE_HTTP_HANDLE_INVALID),
     mWeakRequest(),
-    mWeakHandler()
+    mWeakHandler(),
+    mParseOffMainThread(false)
 {
 }
 
@@ -692,7 +925,7 @@ LLSD HttpCoroutineAdapter::postAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName, true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return postAndSuspend_(request, url, body, options, headers, httpHandler);
 }
@@ -718,7 +951,7 @@ LLSD HttpCoroutineAdapter::postAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -729,7 +962,7 @@ LLSD HttpCoroutineAdapter::postAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName, true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return postAndSuspend_(request, url, rawbody, options, headers, httpHandler);
 }
@@ -841,7 +1074,7 @@ LLSD HttpCoroutineAdapter::postAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -852,7 +1085,7 @@ LLSD HttpCoroutineAdapter::putAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return putAndSuspend_(request, url, body, options, headers, httpHandler);
 }
@@ -899,7 +1132,7 @@ LLSD HttpCoroutineAdapter::putAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -925,7 +1158,7 @@ LLSD HttpCoroutineAdapter::putAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -937,7 +1170,7 @@ LLSD HttpCoroutineAdapter::getAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return getAndSuspend_(request, url, options, headers, httpHandler);
 }
@@ -981,7 +1214,7 @@ LLSD HttpCoroutineAdapter::getAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -993,7 +1226,7 @@ LLSD HttpCoroutineAdapter::deleteAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return deleteAndSuspend_(request, url, options, headers, httpHandler);
 }
@@ -1027,7 +1260,7 @@ LLSD HttpCoroutineAdapter::deleteAndSuspend_(LLCore::HttpRequest::ptr_t &request
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -1038,7 +1271,7 @@ LLSD HttpCoroutineAdapter::patchAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     return patchAndSuspend_(request, url, body, options, headers, httpHandler);
 }
@@ -1065,7 +1298,7 @@ LLSD HttpCoroutineAdapter::patchAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -1076,7 +1309,7 @@ LLSD HttpCoroutineAdapter::copyAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     if (!headers)
         headers.reset(new LLCore::HttpHeaders);
@@ -1107,7 +1340,7 @@ LLSD HttpCoroutineAdapter::copyAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
@@ -1118,7 +1351,7 @@ LLSD HttpCoroutineAdapter::moveAndSuspend(LLCore::HttpRequest::ptr_t request,
     LLCore::HttpOptions::ptr_t options, LLCore::HttpHeaders::ptr_t headers)
 {
     LLEventStream  replyPump(mAdapterName + "Reply", true);
-    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump));
+    HttpCoroHandler::ptr_t httpHandler(new HttpCoroLLSDHandler(replyPump, mParseOffMainThread));
 
     if (!headers)
         headers.reset(new LLCore::HttpHeaders);
@@ -1149,13 +1382,21 @@ LLSD HttpCoroutineAdapter::moveAndSuspend_(LLCore::HttpRequest::ptr_t &request,
     }
 
     saveState(hhandle, request, handler);
-    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    LLSD results = suspendForResult(handler);
     cleanState();
 
     return results;
 }
 
 
+LLSD HttpCoroutineAdapter::suspendForResult(HttpCoroHandler::ptr_t &handler)
+{
+    LLSD results = llcoro::suspendUntilEventOn(handler->getReplyPump());
+    handler->finishResult(results);
+
+    return results;
+}
+
 void HttpCoroutineAdapter::checkDefaultHeaders(LLCore::HttpHeaders::ptr_t &headers)
 {
     if (!headers)
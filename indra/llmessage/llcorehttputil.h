@@ -63,6 +63,11 @@ typedef boost::function<void(const std::string &, bool, const std::string &)> Bo
 
 void setPropertyMethods(BoolSettingQuery_t queryfn, BoolSettingUpdate_t updatefn);
 
+/// Stops and joins the thread that decodes large LLSD responses for 
+/// adapters with setParseOffMainThread(), once its queued work is done.  
+/// Later responses are decoded inline.
+void cleanupLLSDParseThread();
+
 
 extern const F32 HTTP_REQUEST_EXPIRY_SECS;
 
@@ -286,6 +291,11 @@ public:
         return mReplyPump;
     }
 
+    /// Called from the suspended coroutine after the reply has been posted.
+    /// Handlers that moved part of their work off the main thread wait for
+    /// it here (yielding the coroutine) and fold the outcome into result.
+    virtual void finishResult(LLSD &result) { }
+
 protected:
     /// this method may modify the status value
     virtual LLSD handleSuccess(LLCore::HttpResponse * response, LLCore::HttpStatus &status) = 0;
@@ -333,6 +343,14 @@ public:
         LLCore::HttpRequest::priority_t priority = 0L);
     ~HttpCoroutineAdapter();
 
+    /// When set, large LLSD response bodies are decoded on a worker thread
+    /// while the calling coroutine yields, instead of inside the main loop's
+    /// HTTP callback.  The LLSD returned to the caller is unchanged.
+    void setParseOffMainThread(bool enable)
+    {
+        mParseOffMainThread = enable;
+    }
+
     /// Execute a Post transaction on the supplied URL and yield execution of 
     /// the coroutine until a result is available. 
     /// 
@@ -672,6 +690,8 @@ private:
 
     void checkDefaultHeaders(LLCore::HttpHeaders::ptr_t &headers);
 
+    LLSD suspendForResult(HttpCoroHandler::ptr_t &handler);
+
     std::string                     mAdapterName;
     LLCore::HttpRequest::priority_t mPriority;
     LLCore::HttpRequest::policy_t   mPolicyId;
@@ -679,6 +699,7 @@ private:
     LLCore::HttpHandle              mYieldingHandle;
     LLCore::HttpRequest::wptr_t     mWeakRequest;
     HttpCoroHandler::wptr_t         mWeakHandler;
+    bool                            mParseOffMainThread;
 };
 
 
@@ -29,6 +29,7 @@
 
 #include "llhost.h"
 #include "llunits.h"
+#include "lltimingwheel.h"
 
 class LLReliablePacketParams
 {
@@ -78,7 +79,8 @@ public:
 	};
 };
 
-class LLReliablePacket
+// Scheduled on its circuit's resend wheel until acked or aborted
+class LLReliablePacket : public LLTimingWheelEntry
 {
 public:
 	LLReliablePacket(
@@ -93,6 +95,8 @@ public:
 		mBuffer = NULL;
 	};
 
+	TPACKETID getPacketID() const { return mPacketID; }
+
 	friend class LLCircuitData;
 protected:
 	S32 mSocket;
@@ -0,0 +1,160 @@
+/**
+ * @file llpacketidwindow.h
+ * @brief Fixed size record of recently received packet ids.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPACKETIDWINDOW_H
+#define LL_LLPACKETIDWINDOW_H
+
+#include "llmodularmath.h"
+
+/**
+ * @class LLPacketIDWindow
+ * @brief Ring bitmap of the packet ids received within a sliding window.
+ *
+ * Used for duplicate suppression of reliable resends.  Ids are the 24 bit
+ * circuit packet ids, and the window follows the newest id added.  Ids that
+ * have fallen out of the window are reported as not received, which is only
+ * possible for a resend more than WINDOW_SIZE packets late.
+ */
+class LLPacketIDWindow
+{
+public:
+	static const U32 WINDOW_SIZE = 1 << 16;
+
+	LLPacketIDWindow()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		memset(mBits, 0, sizeof(mBits));
+		mNewest = 0;
+		mSpan = 0;
+		mEmpty = true;
+	}
+
+	void add(TPACKETID id)
+	{
+		id &= ID_MASK;
+		if (mEmpty)
+		{
+			mNewest = id;
+			mSpan = 1;
+			mEmpty = false;
+		}
+		else if (isAhead(id))
+		{
+			// slide the window forward, forgetting whatever the ids now
+			// entering it meant on the previous turn of the ring
+			U32 advance = LLModularMath::subtract<ID_WIDTH>(id, mNewest);
+			if (advance >= WINDOW_SIZE)
+			{
+				memset(mBits, 0, sizeof(mBits));
+				mSpan = 1;
+			}
+			else
+			{
+				clearBits(mNewest + 1, advance);
+				mSpan = llmin(mSpan + advance, (U32)WINDOW_SIZE);
+			}
+			mNewest = id;
+		}
+		else
+		{
+			U32 age = LLModularMath::subtract<ID_WIDTH>(mNewest, id);
+			if (age >= WINDOW_SIZE)
+			{
+				// too old to record
+				return;
+			}
+			mSpan = llmax(mSpan, age + 1);
+		}
+		mBits[(id % WINDOW_SIZE) / 64] |= (U64)1 << (id % 64);
+	}
+
+	bool contains(TPACKETID id) const
+	{
+		id &= ID_MASK;
+		if (mEmpty || isAhead(id) || LLModularMath::subtract<ID_WIDTH>(mNewest, id) >= WINDOW_SIZE)
+		{
+			return false;
+		}
+		return (mBits[(id % WINDOW_SIZE) / 64] >> (id % 64)) & 1;
+	}
+
+	// Forgets every id older than oldest_id.  Nothing is forgotten if
+	// oldest_id is ahead of the newest id received.
+	void removeOlderThan(TPACKETID oldest_id)
+	{
+		oldest_id &= ID_MASK;
+		if (mEmpty || isAhead(oldest_id))
+		{
+			return;
+		}
+		U32 keep = LLModularMath::subtract<ID_WIDTH>(mNewest, oldest_id);
+		if (keep + 1 >= mSpan)
+		{
+			// nothing recorded that far back, the usual case between pings
+			return;
+		}
+		clearBits(mNewest - (mSpan - 1), mSpan - 1 - keep);
+		mSpan = keep + 1;
+	}
+
+private:
+	static const int ID_WIDTH = 24;
+	static const U32 ID_MASK = (1 << ID_WIDTH) - 1;
+
+	// true if id is newer than mNewest, allowing for wrap around
+	bool isAhead(TPACKETID id) const
+	{
+		U32 delta = LLModularMath::subtract<ID_WIDTH>(id, mNewest);
+		return delta != 0 && delta < (1 << (ID_WIDTH - 1));
+	}
+
+	// Clears count consecutive ids starting at first, a word at a time.
+	// WINDOW_SIZE divides the id space, so unmasked ids index the ring fine.
+	void clearBits(U32 first, U32 count)
+	{
+		first %= WINDOW_SIZE;
+		while (count > 0)
+		{
+			U32 bit = first % 64;
+			U32 n = llmin(count, 64 - bit);
+			U64 mask = (n == 64) ? ~(U64)0 : (((U64)1 << n) - 1) << bit;
+			mBits[first / 64] &= ~mask;
+			first = (first + n) % WINDOW_SIZE;
+			count -= n;
+		}
+	}
+
+	U64			mBits[WINDOW_SIZE / 64];
+	TPACKETID	mNewest;
+	U32			mSpan;		// ages [0, mSpan) from mNewest are the only ones with bits set
+	bool		mEmpty;
+};
+
+#endif // LL_LLPACKETIDWINDOW_H
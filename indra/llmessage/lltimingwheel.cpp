@@ -0,0 +1,150 @@
+/**
+ * @file lltimingwheel.cpp
+ * @brief Hashed timing wheel used to track reliable resend deadlines.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltimingwheel.h"
+
+LLTimingWheelEntry::LLTimingWheelEntry()
+:	mWheelPrev(this),
+	mWheelNext(this),
+	mWheel(NULL),
+	mDeadline(0.0)
+{
+}
+
+LLTimingWheelEntry::~LLTimingWheelEntry()
+{
+	if (mWheel)
+	{
+		mWheel->cancel(this);
+	}
+}
+
+
+LLTimingWheel::LLTimingWheel(F64Seconds slot_length, U32 slot_count)
+:	mSlotLength(slot_length.value()),
+	mSlotMask(slot_count - 1),
+	mSlots(slot_count),
+	mNextTick(0),
+	mStarted(false),
+	mCount(0)
+{
+	llassert(slot_count && !(slot_count & mSlotMask));
+	llassert(mSlotLength > 0.0);
+}
+
+LLTimingWheel::~LLTimingWheel()
+{
+	// detach anything still scheduled, the entries are not ours to delete
+	for (U32 i = 0; i <= mSlotMask; ++i)
+	{
+		LLTimingWheelEntry* head = &mSlots[i];
+		while (head->mWheelNext != head)
+		{
+			cancel(head->mWheelNext);
+		}
+	}
+}
+
+U64 LLTimingWheel::getTick(F64Seconds time) const
+{
+	F64 tick = time.value() / mSlotLength;
+	return tick > 0.0 ? (U64)tick : 0;
+}
+
+void LLTimingWheel::schedule(LLTimingWheelEntry* entry, F64Seconds deadline)
+{
+	if (entry->mWheel)
+	{
+		entry->mWheel->cancel(entry);
+	}
+
+	U64 tick = getTick(deadline);
+	if (mStarted && tick < mNextTick)
+	{
+		// Already late, make sure the next collection sees it
+		tick = mNextTick;
+	}
+
+	LLTimingWheelEntry* head = &mSlots[tick & mSlotMask];
+	entry->mDeadline = deadline;
+	entry->mWheel = this;
+	entry->mWheelNext = head;
+	entry->mWheelPrev = head->mWheelPrev;
+	head->mWheelPrev->mWheelNext = entry;
+	head->mWheelPrev = entry;
+	++mCount;
+}
+
+void LLTimingWheel::cancel(LLTimingWheelEntry* entry)
+{
+	if (entry->mWheel != this)
+	{
+		return;
+	}
+
+	entry->mWheelPrev->mWheelNext = entry->mWheelNext;
+	entry->mWheelNext->mWheelPrev = entry->mWheelPrev;
+	entry->mWheelPrev = entry;
+	entry->mWheelNext = entry;
+	entry->mWheel = NULL;
+	--mCount;
+}
+
+void LLTimingWheel::collectExpired(F64Seconds now, std::vector<LLTimingWheelEntry*>& expired)
+{
+	U64 now_tick = getTick(now);
+
+	// Entries scheduled before the first call may be anywhere, and after
+	// a long stall every slot may have come due: in both cases look at the
+	// whole wheel once.
+	U64 first_tick = mNextTick;
+	if (!mStarted || now_tick < mNextTick || now_tick - mNextTick > mSlotMask)
+	{
+		first_tick = now_tick - llmin(now_tick, (U64)mSlotMask);
+	}
+
+	for (U64 tick = first_tick; tick <= now_tick && mCount; ++tick)
+	{
+		LLTimingWheelEntry* head = &mSlots[tick & mSlotMask];
+		LLTimingWheelEntry* entry = head->mWheelNext;
+		while (entry != head)
+		{
+			LLTimingWheelEntry* next = entry->mWheelNext;
+			if (entry->mDeadline < now)
+			{
+				cancel(entry);
+				expired.push_back(entry);
+			}
+			entry = next;
+		}
+	}
+
+	// The current slot may still get entries that are due later this tick,
+	// so it is looked at again next time.
+	mNextTick = now_tick;
+	mStarted = true;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file lltimingwheel.h
+ * @brief Hashed timing wheel used to track reliable resend deadlines.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTIMINGWHEEL_H
+#define LL_LLTIMINGWHEEL_H
+
+#include <vector>
+
+#include "llunits.h"
+
+class LLTimingWheel;
+
+/**
+ * @class LLTimingWheelEntry
+ * @brief Base class for anything that can be scheduled on an LLTimingWheel.
+ *
+ * The links are intrusive, so scheduling and cancelling never allocate.
+ * Destroying a scheduled entry removes it from its wheel.
+ */
+class LLTimingWheelEntry
+{
+public:
+	LLTimingWheelEntry();
+	~LLTimingWheelEntry();
+
+	bool		isScheduled() const		{ return mWheel != NULL; }
+	F64Seconds	getDeadline() const		{ return mDeadline; }
+
+private:
+	// not copyable, the links belong to exactly one wheel
+	LLTimingWheelEntry(const LLTimingWheelEntry&);
+	LLTimingWheelEntry& operator=(const LLTimingWheelEntry&);
+
+	friend class LLTimingWheel;
+	LLTimingWheelEntry* mWheelPrev;
+	LLTimingWheelEntry* mWheelNext;
+	LLTimingWheel*		mWheel;
+	F64Seconds			mDeadline;
+};
+
+/**
+ * @class LLTimingWheel
+ * @brief Buckets entries by deadline into a ring of fixed length time slots.
+ *
+ * Scheduling and cancelling are O(1).  collectExpired() only looks at the
+ * slots that came due since the previous call, so the cost of a frame is
+ * proportional to the work that is actually due rather than to the number
+ * of entries outstanding.  Deadlines further out than one turn of the wheel
+ * simply stay in their slot until a later turn.
+ */
+class LLTimingWheel
+{
+public:
+	// slot_count must be a power of two
+	LLTimingWheel(F64Seconds slot_length = F64Seconds(1.0 / 32.0), U32 slot_count = 256);
+	~LLTimingWheel();
+
+	// Schedules entry to expire at deadline, moving it if it is already
+	// scheduled.  Deadlines that have already passed expire on the next
+	// call to collectExpired().
+	void schedule(LLTimingWheelEntry* entry, F64Seconds deadline);
+	void cancel(LLTimingWheelEntry* entry);
+
+	// Removes every entry whose deadline is before now and appends it to
+	// expired, in slot order.
+	void collectExpired(F64Seconds now, std::vector<LLTimingWheelEntry*>& expired);
+
+	S32		size() const	{ return mCount; }
+	bool	empty() const	{ return mCount == 0; }
+
+private:
+	LLTimingWheel(const LLTimingWheel&);
+	LLTimingWheel& operator=(const LLTimingWheel&);
+
+	U64 getTick(F64Seconds time) const;
+
+	const F64		mSlotLength;
+	const U32		mSlotMask;
+	std::vector<LLTimingWheelEntry> mSlots;	// list heads
+	U64				mNextTick;		// first tick not known to be fully expired
+	bool			mStarted;		// false until the first collectExpired()
+	S32				mCount;
+};
+
+#endif // LL_LLTIMINGWHEEL_H
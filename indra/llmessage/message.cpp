@@ -708,7 +708,7 @@ BOOL LLMessageSystem::checkMessages(LockMessageChecker&, S64 frame_count )
 				if (cdp && recv_reliable)
 				{
 					// Add to the recently received list for duplicate suppression
-					cdp->mRecentlyReceivedReliablePackets[mCurrentRecvPacketID] = getMessageTimeUsecs();
+					cdp->mRecentlyReceivedReliablePackets.add(mCurrentRecvPacketID);
 
 					// Put it onto the list of packets to be acked
 					cdp->collectRAck(mCurrentRecvPacketID);
@@ -1320,6 +1320,47 @@ S32 LLMessageSystem::sendMessage(const LLHost &host)
 	return buffer_length;
 }
 
+S32 LLMessageSystem::sendPacketAck(const LLHost &host, const TPACKETID* packet_ids, S32 count)
+{
+	llassert(count > 0 && count <= MAX_ACKS_PER_PACKET);
+
+	newMessageFast(_PREHASH_PacketAck);
+	const LLMessageTemplate* msg_template =
+		get_if_there(mMessageTemplates, (const char*)_PREHASH_PacketAck, (LLMessageTemplate*)NULL);
+	if (mMessageBuilder != mTemplateMessageBuilder || !msg_template
+		|| msg_template->mFrequency != MFT_LOW)
+	{
+		// Not the template message we expect, go the long way round
+		for (S32 i = 0; i < count; ++i)
+		{
+			nextBlockFast(_PREHASH_Packets);
+			addU32Fast(_PREHASH_ID, packet_ids[i]);
+		}
+		return sendMessage(host);
+	}
+
+	// Same layout LLTemplateMessageBuilder::buildMessage() produces: the
+	// header, the low frequency message number, then the variable block
+	// count and the ids themselves.
+	mSendBuffer[PHL_OFFSET] = 0;
+	S32 size = LL_PACKET_ID_SIZE;
+	mSendBuffer[size++] = 255;
+	mSendBuffer[size++] = 255;
+	U16 message_num = htons((U16)(msg_template->mMessageNumber & 0xFFFF));
+	memcpy(&mSendBuffer[size], &message_num, sizeof(U16));	/* Flawfinder: ignore */
+	size += sizeof(U16);
+	mSendBuffer[size++] = (U8)count;
+	for (S32 i = 0; i < count; ++i)
+	{
+		htolememcpy(&mSendBuffer[size], &packet_ids[i], MVT_U32, sizeof(U32));
+		size += sizeof(U32);
+	}
+	mSendSize = size;
+	mMessageBuilder->setBuilt(TRUE);
+
+	return sendMessage(host);
+}
+
 void LLMessageSystem::logMsgFromInvalidCircuit( const LLHost& host, BOOL recv_reliable )
 {
 	if(mVerboseLog)
@@ -575,6 +575,11 @@ public:
 
 	S32		sendMessage(const LLHost &host);
 	S32		sendMessage(const U32 circuit);
+
+	// Sends a PacketAck for up to MAX_ACKS_PER_PACKET packet ids, written
+	// straight into the send buffer rather than through the builder.
+	static const S32 MAX_ACKS_PER_PACKET = 250;
+	S32		sendPacketAck(const LLHost &host, const TPACKETID* packet_ids, S32 count);
 private:
 	S32		sendMessage(const LLHost &host, const char* name,
 						const LLSD& message);
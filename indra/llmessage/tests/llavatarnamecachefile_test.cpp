@@ -0,0 +1,192 @@
+/**
+ * @file llavatarnamecachefile_test.cpp
+ * @brief Tests for the binary avatar name cache file.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llavatarnamecachefile.h"
+#include "../llavatarname.h"
+#include "llfile.h"
+#include "llsd.h"
+#include "llsdutil.h"
+#include "stringize.h"
+#include "../test/lltut.h"
+
+static LLAvatarName make_name(S32 i)
+{
+	LLSD info;
+	info["username"] = STRINGIZE("user" << i);
+	info["display_name"] = STRINGIZE("Display Name " << i);
+	info["legacy_first_name"] = STRINGIZE("user" << i);
+	info["legacy_last_name"] = (i % 2) ? "Resident" : "Linden";
+	info["is_display_name_default"] = (i % 3) == 0;
+	info["display_name_expires"] = LLDate(1700000000.0 + i);
+	info["display_name_next_update"] = LLDate(1700003600.0 + i);
+	LLAvatarName av_name;
+	av_name.fromLLSD(info);
+	return av_name;
+}
+
+static bool read_file(const std::string& filename, std::vector<U8>& data)
+{
+	llifstream file(filename.c_str(), std::ios::binary);
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !data.empty();
+}
+
+static bool write_file(const std::string& filename, const std::vector<U8>& data)
+{
+	llofstream file(filename.c_str(), std::ios::binary);
+	file.write((const char*)&data[0], data.size());
+	return file.good();
+}
+
+namespace tut
+{
+	struct avatarnamecachefile_data
+	{
+		std::string mFilename;
+
+		avatarnamecachefile_data()
+		{
+			LLUUID random;
+			random.generate();
+			mFilename = STRINGIZE(LLFile::tmpdir() << "llavatarnamecache-test-" << random << ".bin");
+		}
+
+		~avatarnamecachefile_data()
+		{
+			LLFile::remove(mFilename, ENOENT);
+		}
+	};
+	typedef test_group<avatarnamecachefile_data> avatarnamecachefile_test;
+	typedef avatarnamecachefile_test::object avatarnamecachefile_object;
+	tut::avatarnamecachefile_test avnamecachefile("LLAvatarNameCacheFile");
+
+	// names survive a round trip exactly as asLLSD()/fromLLSD() would carry them
+	template<> template<>
+	void avatarnamecachefile_object::test<1>()
+	{
+		static const S32 NAME_COUNT = 5000;
+		std::vector<LLUUID> ids(NAME_COUNT);
+		LLAvatarNameCacheFile writer;
+		writer.reserve(NAME_COUNT);
+		for (S32 i = 0; i < NAME_COUNT; ++i)
+		{
+			ids[i].generate();
+			writer.addName(ids[i], make_name(i));
+		}
+		ensure("save", writer.save(mFilename));
+
+		LLAvatarNameCacheFile reader;
+		ensure_equals("map", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_OK);
+		ensure_equals("count", reader.getCount(), NAME_COUNT);
+		for (S32 i = 0; i < NAME_COUNT; ++i)
+		{
+			S32 index = reader.find(ids[i]);
+			ensure("found", index >= 0);
+			ensure("id", reader.getID(index) == ids[i]);
+			LLAvatarName av_name;
+			ensure("decoded", reader.getName(index, av_name));
+			ensure(STRINGIZE("name " << i), llsd_equals(av_name.asLLSD(), make_name(i).asLLSD()));
+			ensure("valid", av_name.isValidName());
+		}
+
+		LLUUID missing;
+		missing.generate();
+		ensure_equals("missing id", reader.find(missing), -1);
+		ensure_equals("null id", reader.find(LLUUID::null), -1);
+
+		// the mapped file can be replaced once it is let go
+		reader.unmap();
+		LLAvatarNameCacheFile empty;
+		ensure("save empty", empty.save(mFilename));
+		ensure_equals("map empty", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_OK);
+		ensure_equals("empty count", reader.getCount(), 0);
+		ensure_equals("empty find", reader.find(ids[0]), -1);
+	}
+
+	// anything that is not a complete cache file is refused
+	template<> template<>
+	void avatarnamecachefile_object::test<2>()
+	{
+		LLAvatarNameCacheFile reader;
+		ensure_equals("missing file", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_NO_FILE);
+
+		LLAvatarNameCacheFile writer;
+		LLUUID id;
+		for (S32 i = 0; i < 10; ++i)
+		{
+			id.generate();
+			writer.addName(id, make_name(i));
+		}
+		ensure("save", writer.save(mFilename));
+		std::vector<U8> image;
+		ensure("read back", read_file(mFilename, image));
+
+		std::vector<U8> xml(image.size(), ' ');
+		memcpy(&xml[0], "<?xml", 5);
+		ensure("write xml", write_file(mFilename, xml));
+		ensure_equals("xml cache", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_BAD_FORMAT);
+		ensure("xml cache unmapped", !reader.isMapped());
+
+		std::vector<U8> truncated(image.begin(), image.end() - 1);
+		ensure("write truncated", write_file(mFilename, truncated));
+		ensure_equals("truncated", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_CORRUPT);
+
+		std::vector<U8> bad_version(image);
+		LLAvatarNameCacheFile::Header* header = reinterpret_cast<LLAvatarNameCacheFile::Header*>(&bad_version[0]);
+		header->mFormatVersion = LLAvatarNameCacheFile::FORMAT_VERSION + 1;
+		ensure("write bad version", write_file(mFilename, bad_version));
+		ensure_equals("format version", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_BAD_FORMAT);
+
+		// records are checked when they are read
+		std::vector<U8> bad_string(image);
+		header = reinterpret_cast<LLAvatarNameCacheFile::Header*>(&bad_string[0]);
+		LLAvatarNameCacheFile::NameRecord* rec =
+			reinterpret_cast<LLAvatarNameCacheFile::NameRecord*>(&bad_string[header->mRecordOffset]);
+		rec[3].mDisplayName.mOffset = header->mStringPoolSize;
+		ensure("write bad string", write_file(mFilename, bad_string));
+		ensure_equals("bad string maps", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_OK);
+		LLAvatarName av_name;
+		ensure("bad record refused", !reader.getName(3, av_name));
+		ensure("good record", reader.getName(4, av_name));
+
+		// a table without empty buckets must not be probed forever
+		reader.unmap();
+		std::vector<U8> full_table(image);
+		header = reinterpret_cast<LLAvatarNameCacheFile::Header*>(&full_table[0]);
+		U32* buckets = reinterpret_cast<U32*>(&full_table[header->mBucketOffset]);
+		for (U32 i = 0; i < header->mBucketCount; ++i)
+		{
+			buckets[i] = 0;
+		}
+		ensure("write full table", write_file(mFilename, full_table));
+		ensure_equals("full table maps", reader.map(mFilename), LLAvatarNameCacheFile::LOAD_OK);
+		LLUUID missing;
+		missing.generate();
+		ensure_equals("full table find", reader.find(missing), -1);
+	}
+}
@@ -0,0 +1,357 @@
+/**
+ * @file lltimingwheel_test.cpp
+ * @brief Tests for the resend timing wheel and duplicate suppression window.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../lltimingwheel.h"
+#include "../llpacketidwindow.h"
+
+#include "../test/lltut.h"
+
+namespace
+{
+	struct TestEntry : public LLTimingWheelEntry
+	{
+		TestEntry(TPACKETID id = 0) : mID(id), mSends(0) {}
+		TPACKETID mID;
+		S32 mSends;
+	};
+
+	// A packet in flight on the simulated link
+	struct InFlight
+	{
+		F64 mArrival;
+		TPACKETID mID;
+		bool mIsAck;
+		bool mResent;
+	};
+}
+
+namespace tut
+{
+	struct timingwheel_data
+	{
+	};
+	typedef test_group<timingwheel_data> timingwheel_test;
+	typedef timingwheel_test::object timingwheel_object;
+	tut::timingwheel_test timingwheel_testcase("LLTimingWheel");
+
+	template<> template<>
+	void timingwheel_object::test<1>()
+	{
+		// entries come off the wheel once their deadline has passed, no sooner
+		LLTimingWheel wheel(F64Seconds(0.1), 8);
+		TestEntry near_entry(1), far_entry(2), cancelled_entry(3);
+		wheel.schedule(&near_entry, F64Seconds(100.25));
+		wheel.schedule(&far_entry, F64Seconds(103.05));		// several turns of the wheel out
+		wheel.schedule(&cancelled_entry, F64Seconds(100.25));
+		wheel.cancel(&cancelled_entry);
+		ensure_equals("scheduled count", wheel.size(), 2);
+		ensure("cancelled entry unscheduled", !cancelled_entry.isScheduled());
+
+		std::vector<LLTimingWheelEntry*> expired;
+		wheel.collectExpired(F64Seconds(100.0), expired);
+		ensure("nothing due yet", expired.empty());
+		wheel.collectExpired(F64Seconds(100.25), expired);
+		ensure("deadline is exclusive", expired.empty());
+		wheel.collectExpired(F64Seconds(100.26), expired);
+		ensure_equals("near entry due", expired.size(), (size_t)1);
+		ensure("near entry returned", expired[0] == &near_entry);
+		ensure("near entry unscheduled", !near_entry.isScheduled());
+
+		for (F64 now = 100.3; now < 103.05; now += 0.05)
+		{
+			expired.clear();
+			wheel.collectExpired(F64Seconds(now), expired);
+			ensure("far entry not due early", expired.empty());
+		}
+		wheel.collectExpired(F64Seconds(103.1), expired);
+		ensure_equals("far entry due", expired.size(), (size_t)1);
+		ensure("far entry returned", expired[0] == &far_entry);
+		ensure("wheel empty", wheel.empty());
+	}
+
+	template<> template<>
+	void timingwheel_object::test<2>()
+	{
+		// late entries, rescheduling, long stalls and destruction
+		LLTimingWheel wheel(F64Seconds(0.1), 8);
+		std::vector<LLTimingWheelEntry*> expired;
+		wheel.collectExpired(F64Seconds(50.0), expired);
+
+		TestEntry late(1), moved(2), stalled(3);
+		wheel.schedule(&late, F64Seconds(10.0));
+		wheel.schedule(&moved, F64Seconds(50.1));
+		wheel.schedule(&moved, F64Seconds(60.0));
+		wheel.schedule(&stalled, F64Seconds(55.0));
+		ensure_equals("rescheduling does not duplicate", wheel.size(), 3);
+
+		wheel.collectExpired(F64Seconds(50.2), expired);
+		ensure_equals("only the late entry", expired.size(), (size_t)1);
+		ensure("late entry returned", expired[0] == &late);
+
+		expired.clear();
+		wheel.collectExpired(F64Seconds(58.0), expired);
+		ensure_equals("stalled entry found after a long gap", expired.size(), (size_t)1);
+		ensure("stalled entry returned", expired[0] == &stalled);
+
+		{
+			TestEntry temporary(4);
+			wheel.schedule(&temporary, F64Seconds(58.5));
+			ensure_equals("temporary scheduled", wheel.size(), 2);
+		}
+		ensure_equals("destroyed entry removed", wheel.size(), 1);
+
+		expired.clear();
+		wheel.collectExpired(F64Seconds(61.0), expired);
+		ensure_equals("moved entry due at its new time", expired.size(), (size_t)1);
+		ensure("moved entry returned", expired[0] == &moved);
+	}
+
+	template<> template<>
+	void timingwheel_object::test<3>()
+	{
+		// duplicate window basics, including packet id wrap around
+		LLPacketIDWindow window;
+		ensure("empty window", !window.contains(0));
+
+		window.add(0xFFFFFE);
+		window.add(0xFFFFFF);
+		window.add(0x000001);	// wrapped
+		ensure("before wrap", window.contains(0xFFFFFE) && window.contains(0xFFFFFF));
+		ensure("after wrap", window.contains(0x000001));
+		ensure("gap not received", !window.contains(0x000000));
+		ensure("ahead not received", !window.contains(0x000002));
+
+		window.add(0x000000);	// late arrival inside the window
+		ensure("late arrival recorded", window.contains(0x000000));
+
+		window.removeOlderThan(0xFFFFFF);
+		ensure("older forgotten", !window.contains(0xFFFFFE));
+		ensure("oldest kept", window.contains(0xFFFFFF) && window.contains(0x000001));
+
+		window.removeOlderThan(0x000100);	// ahead of anything received
+		ensure("nothing forgotten for a future oldest", window.contains(0x000001));
+
+		// sliding a whole window forward forgets what the ring held
+		window.add(0x000001 + LLPacketIDWindow::WINDOW_SIZE);
+		ensure("slid out", !window.contains(0x000001));
+		ensure("newest recorded", window.contains(0x000001 + LLPacketIDWindow::WINDOW_SIZE));
+		window.add(0x000001);
+		ensure("too old to record", !window.contains(0x000001));
+
+		window.clear();
+		ensure("cleared", !window.contains(0x000001 + LLPacketIDWindow::WINDOW_SIZE));
+	}
+
+	template<> template<>
+	void timingwheel_object::test<5>()
+	{
+		// the window against a plain set of ids, with forgets that cross
+		// word boundaries and the ring wrapping several times over
+		const U32 ID_MASK = 0xFFFFFF;
+		LLPacketIDWindow window;
+		std::set<TPACKETID> model;
+		TPACKETID newest = 0xFFF000;
+		std::mt19937 gen(7);
+		std::uniform_int_distribution<U32> step(0, 300);
+		std::uniform_int_distribution<U32> back(0, LLPacketIDWindow::WINDOW_SIZE + 100);
+		std::uniform_int_distribution<U32> action(0, 9);
+
+		for (S32 round = 0; round < 20000; ++round)
+		{
+			U32 what = action(gen);
+			if (what < 6)
+			{
+				// mostly in order, sometimes a big jump
+				newest = (newest + step(gen) * (what == 0 ? 200 : 1)) & ID_MASK;
+				window.add(newest);
+				model.insert(newest);
+				// drop what slid out so it can't alias once the ids wrap
+				for (std::set<TPACKETID>::iterator it = model.begin(); it != model.end(); )
+				{
+					if (((newest - *it) & ID_MASK) >= LLPacketIDWindow::WINDOW_SIZE)
+					{
+						model.erase(it++);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+			else if (what < 8)
+			{
+				TPACKETID late = (newest - back(gen)) & ID_MASK;
+				window.add(late);
+				if (((newest - late) & ID_MASK) < LLPacketIDWindow::WINDOW_SIZE)
+				{
+					model.insert(late);
+				}
+			}
+			else
+			{
+				U32 keep = back(gen) / 2;
+				window.removeOlderThan((newest - keep) & ID_MASK);
+				window.removeOlderThan((newest - keep) & ID_MASK);	// a second ping is a no-op
+				for (std::set<TPACKETID>::iterator it = model.begin(); it != model.end(); )
+				{
+					if (((newest - *it) & ID_MASK) > keep)
+					{
+						model.erase(it++);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+
+			for (S32 probe = 0; probe < 8; ++probe)
+			{
+				TPACKETID id = (newest - back(gen)) & ID_MASK;
+				bool expected = model.count(id) && ((newest - id) & ID_MASK) < LLPacketIDWindow::WINDOW_SIZE;
+				ensure_equals("window matches model", window.contains(id), expected);
+			}
+		}
+	}
+
+	template<> template<>
+	void timingwheel_object::test<4>()
+	{
+		// Loss simulation: reliable packets are sent over a link that drops,
+		// duplicates and reorders packets and acks.  The sender resends off
+		// the wheel until acked, the receiver suppresses duplicates with the
+		// window.  Every packet must be delivered exactly once.
+		std::minstd_rand gen(4242);
+		std::uniform_real_distribution<F64> chance(0.0, 1.0);
+		const F64 LOSS = 0.3;
+		const F64 DUPLICATION = 0.05;
+		const F64 RESEND_TIMEOUT = 0.25;
+		const F64 TICK = 0.01;
+		const S32 PACKET_COUNT = 2000;
+		const TPACKETID FIRST_ID = 0xFFFFFF - PACKET_COUNT / 2;	// wrap half way through
+
+		LLTimingWheel wheel(F64Seconds(1.0 / 32.0), 64);
+		std::map<TPACKETID, TestEntry*> unacked;
+		std::vector<TestEntry*> packets;
+		std::multimap<F64, InFlight> link;
+		LLPacketIDWindow received;
+		std::map<TPACKETID, S32> delivered;
+		S32 duplicates_suppressed = 0;
+
+		F64 now = 1000.0;
+		S32 next_packet = 0;
+		std::vector<LLTimingWheelEntry*> expired;
+
+		for (S32 step = 0; step < 100000 && (next_packet < PACKET_COUNT || !unacked.empty()); ++step)
+		{
+			now += TICK;
+
+			// send a few new packets each tick
+			for (S32 i = 0; i < 5 && next_packet < PACKET_COUNT; ++i, ++next_packet)
+			{
+				TestEntry* packet = new TestEntry((FIRST_ID + next_packet) & 0xFFFFFF);
+				packets.push_back(packet);
+				unacked[packet->mID] = packet;
+				packet->mSends = 1;
+				InFlight msg = { 0.0, packet->mID, false, false };
+				link.insert(std::make_pair(now + 0.02 + chance(gen) * 0.1, msg));
+				wheel.schedule(packet, F64Seconds(now + RESEND_TIMEOUT));
+			}
+
+			// resend whatever expired
+			expired.clear();
+			wheel.collectExpired(F64Seconds(now), expired);
+			for (size_t i = 0; i < expired.size(); ++i)
+			{
+				TestEntry* packet = static_cast<TestEntry*>(expired[i]);
+				ensure("expired only after its deadline", packet->getDeadline().value() < now);
+				ensure("acked packets never expire", unacked.count(packet->mID) == 1);
+				++packet->mSends;
+				InFlight msg = { 0.0, packet->mID, false, true };
+				link.insert(std::make_pair(now + 0.02 + chance(gen) * 0.1, msg));
+				wheel.schedule(packet, F64Seconds(now + RESEND_TIMEOUT));
+			}
+
+			// deliver everything that has arrived
+			while (!link.empty() && link.begin()->first <= now)
+			{
+				InFlight msg = link.begin()->second;
+				link.erase(link.begin());
+				if (chance(gen) < LOSS)
+				{
+					continue;
+				}
+				if (chance(gen) < DUPLICATION)
+				{
+					link.insert(std::make_pair(now + chance(gen) * 0.2, msg));
+				}
+
+				if (msg.mIsAck)
+				{
+					std::map<TPACKETID, TestEntry*>::iterator it = unacked.find(msg.mID);
+					if (it != unacked.end())
+					{
+						wheel.cancel(it->second);
+						unacked.erase(it);
+					}
+					continue;
+				}
+
+				// the receiver acks everything, but only processes new ids
+				InFlight ack = { 0.0, msg.mID, true, false };
+				link.insert(std::make_pair(now + 0.02 + chance(gen) * 0.1, ack));
+				if (received.contains(msg.mID))
+				{
+					++duplicates_suppressed;
+					continue;
+				}
+				received.add(msg.mID);
+				++delivered[msg.mID];
+			}
+		}
+
+		ensure("all packets acked", unacked.empty());
+		ensure("wheel drained", wheel.empty());
+		ensure_equals("every packet delivered", delivered.size(), (size_t)PACKET_COUNT);
+		for (std::map<TPACKETID, S32>::iterator it = delivered.begin(); it != delivered.end(); ++it)
+		{
+			ensure_equals("delivered exactly once", it->second, 1);
+		}
+		ensure("resends happened and were suppressed", duplicates_suppressed > 0);
+
+		for (size_t i = 0; i < packets.size(); ++i)
+		{
+			delete packets[i];
+		}
+	}
+}
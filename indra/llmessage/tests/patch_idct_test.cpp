@@ -0,0 +1,257 @@
+/**
+ * @file patch_idct_test.cpp
+ * @brief Checks the SSE terrain patch decoder against a scalar IDCT.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmath.h"
+#include "llbitpack.h"
+#include "v3math.h"
+
+#include "../patch_code.h"
+#include "../patch_dct.h"
+
+#include "../test/lltut.h"
+
+extern F32 gPatchDequantizeTable[];
+extern F32 gPatchICosines[];
+extern S32 gDeCopyMatrix[];
+
+namespace tut
+{
+	// LayerData payload ('L' layer, stride 32) holding a 2x2 block of 16x16
+	// land patches of rolling terrain, packed by the simulator's patch coder.
+	static U8 land_layer[] = {
+		0x20, 0x00, 0x10, 0x4c, 0x88, 0x92, 0x01, 0x63, 0x41, 0x0f, 0x00, 0x00, 0x35, 0x89, 0x89, 0x8c,
+		0x69, 0xf3, 0x33, 0x85, 0x1d, 0x4c, 0xe1, 0xc7, 0x8f, 0x30, 0xd9, 0x85, 0x4e, 0x02, 0x70, 0xc3,
+		0x0c, 0x18, 0x18, 0xe1, 0x27, 0x02, 0x38, 0xc9, 0xc4, 0x0c, 0x6a, 0x65, 0x43, 0x84, 0x9c, 0x08,
+		0xc1, 0xc6, 0x1c, 0x30, 0x39, 0x80, 0x47, 0x02, 0x1c, 0x1c, 0xe0, 0x47, 0x03, 0x39, 0xb1, 0xd2,
+		0x0e, 0x16, 0x18, 0x08, 0xe0, 0x47, 0x0a, 0x38, 0x08, 0x38, 0x08, 0xe0, 0x63, 0x80, 0x9c, 0x20,
+		0xc0, 0x66, 0x07, 0x38, 0x51, 0xc0, 0xc0, 0xe0, 0x23, 0x80, 0x80, 0x70, 0x10, 0xe0, 0x66, 0x01,
+		0x30, 0x08, 0xc0, 0x47, 0x03, 0x38, 0x08, 0x00, 0x00, 0x70, 0x10, 0x0e, 0x02, 0x51, 0x03, 0x23,
+		0xc9, 0xc8, 0x21, 0xe0, 0x04, 0x06, 0x03, 0x39, 0x81, 0xc2, 0x7c, 0x70, 0x7a, 0x93, 0x39, 0x1c,
+		0x24, 0xdc, 0x06, 0x1d, 0x38, 0x11, 0x84, 0xce, 0x4e, 0x60, 0x83, 0x0a, 0x18, 0x20, 0xe0, 0x26,
+		0x15, 0x38, 0x59, 0x8a, 0x8c, 0x74, 0x70, 0xa1, 0x8a, 0x8c, 0x9c, 0x61, 0x63, 0x81, 0x98, 0x08,
+		0xc0, 0x43, 0x03, 0x1c, 0x04, 0xe0, 0x27, 0x25, 0x39, 0x81, 0xc1, 0xce, 0x02, 0x30, 0x31, 0xc2,
+		0xce, 0x3a, 0x70, 0x43, 0x01, 0x86, 0x01, 0x18, 0x08, 0x38, 0x29, 0x80, 0x8c, 0x0a, 0x70, 0x63,
+		0x80, 0x86, 0x02, 0x38, 0x19, 0xc1, 0x07, 0x05, 0x38, 0x09, 0x80, 0x40, 0xc0, 0x21, 0xc0, 0x81,
+		0x80, 0x4e, 0x04, 0x07, 0x01, 0x38, 0x08, 0x38, 0x08, 0x00, 0x01, 0xc0, 0x40, 0x01, 0xc0, 0x40,
+		0x00, 0x00, 0x00, 0x1c, 0x04, 0xa2, 0x0f, 0x76, 0xd3, 0xd0, 0x43, 0x00, 0x00, 0x4c, 0xbd, 0x60,
+		0x23, 0x8b, 0xfa, 0x74, 0xe8, 0x26, 0x2c, 0x78, 0x11, 0xb2, 0x0c, 0x0a, 0x70, 0x83, 0x13, 0x9c,
+		0xf4, 0xe0, 0xa6, 0x1f, 0x30, 0xc8, 0xc2, 0xc7, 0x02, 0x30, 0x69, 0x83, 0x4e, 0x06, 0x60, 0x23,
+		0x23, 0x99, 0xf8, 0xc4, 0xa7, 0x08, 0x30, 0x21, 0x81, 0xc6, 0x06, 0x0e, 0x12, 0x70, 0xa3, 0x80,
+		0x9c, 0x04, 0xc0, 0x26, 0x0a, 0x38, 0xa1, 0xcc, 0x4e, 0x10, 0x60, 0x53, 0x81, 0x18, 0x04, 0xc0,
+		0x43, 0x01, 0x07, 0x01, 0x18, 0x04, 0xe0, 0x20, 0xc0, 0x67, 0x06, 0x38, 0x38, 0xe1, 0x07, 0x02,
+		0x30, 0x09, 0xc0, 0x46, 0x01, 0x18, 0x04, 0x00, 0x18, 0x04, 0xe0, 0x47, 0x02, 0x1c, 0x04, 0x70,
+		0x33, 0x80, 0x80, 0x00, 0x00, 0xe0, 0x20, 0x38, 0x08, 0x00, 0x00, 0x00, 0x03, 0x80, 0x80, 0x18,
+		0x04, 0xa2, 0x26, 0xea, 0x1d, 0xd0, 0x43, 0x80, 0x08, 0x4c, 0x8c, 0xea, 0x03, 0x48, 0x5d, 0xd4,
+		0xc7, 0xc7, 0xb8, 0x30, 0x29, 0xee, 0x4e, 0x4c, 0x60, 0x33, 0x01, 0x1c, 0xb4, 0xc8, 0xc6, 0x16,
+		0x38, 0xb8, 0xe2, 0x46, 0x08, 0x38, 0xf9, 0xcb, 0x4c, 0x0e, 0x70, 0x63, 0x1b, 0x99, 0xac, 0xc3,
+		0xa6, 0x03, 0x30, 0x11, 0xc1, 0x87, 0x05, 0x30, 0x08, 0xc3, 0x66, 0x22, 0x30, 0x21, 0x80, 0x4e,
+		0x04, 0x60, 0x83, 0x86, 0x1c, 0x98, 0xe0, 0x86, 0x04, 0x0e, 0x04, 0x38, 0x10, 0x60, 0x43, 0x81,
+		0x1c, 0x0c, 0xc0, 0x86, 0x01, 0x1c, 0x04, 0xc0, 0x47, 0x03, 0x38, 0x29, 0x80, 0x4e, 0x0c, 0x70,
+		0x13, 0x00, 0x87, 0x01, 0x1c, 0x04, 0x30, 0x08, 0x38, 0x09, 0x80, 0x41, 0x80, 0x4e, 0x02, 0x70,
+		0x20, 0x70, 0x20, 0x00, 0x00, 0x0e, 0x02, 0x03, 0x80, 0x80, 0x00, 0x00, 0x00, 0x38, 0x09, 0x30,
+		0x80 };
+
+	// Straightforward decode the way the old unrolled scalar passes did it:
+	// dequantize, then a column pass and a line pass each summing its terms
+	// one at a time.
+	static void reference_decompress(F32 *patch, S32 stride, const S32 *cpatch, const LLPatchHeader &ph, S32 size)
+	{
+		F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		S32 i, j, n, u;
+
+		for (i = 0; i < size*size; i++)
+		{
+			block[i] = cpatch[gDeCopyMatrix[i]]*gPatchDequantizeTable[i];
+		}
+
+		for (i = 0; i < size; i++)
+		{
+			for (n = 0; n < size; n++)
+			{
+				F32 total = OO_SQRT2*block[i];
+				for (u = 1; u < size; u++)
+				{
+					total += block[u*size + i]*gPatchICosines[u*size + n];
+				}
+				temp[n*size + i] = total;
+			}
+		}
+
+		F32 oosob = 2.f/size;
+		for (i = 0; i < size; i++)
+		{
+			for (n = 0; n < size; n++)
+			{
+				F32 total = OO_SQRT2*temp[i*size];
+				for (u = 1; u < size; u++)
+				{
+					total += temp[i*size + u]*gPatchICosines[u*size + n];
+				}
+				block[i*size + n] = total*oosob;
+			}
+		}
+
+		S32 prequant = (ph.quant_wbits >> 4) + 2;
+		F32 mult = ph.range/(F32)(1<<prequant);
+		F32 addval = mult*(F32)(1<<(prequant - 1)) + ph.dc_offset;
+		for (j = 0; j < size; j++)
+		{
+			for (i = 0; i < size; i++)
+			{
+				patch[j*stride + i] = block[j*size + i]*mult + addval;
+			}
+		}
+	}
+
+	struct patch_idct_test
+	{
+	};
+
+	typedef test_group<patch_idct_test> patch_idct_test_t;
+	typedef patch_idct_test_t::object patch_idct_test_object_t;
+	tut::patch_idct_test_t tut_patch_idct_test("patch_idct");
+
+	template<> template<>
+	void patch_idct_test_object_t::test<1>()
+	{
+		// decode the land layer the way LLSurface::decompressDCTPatch does
+		const S32 stride = 2*NORMAL_PATCH_SIZE;
+		F32 heights[stride*stride];
+		F32 expected[stride*stride];
+		S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+
+		LLBitPack bitpack(land_layer, sizeof(land_layer));
+		LLGroupHeader gh;
+		init_patch_decoding(bitpack);
+		decode_patch_group_header(bitpack, &gh);
+		ensure_equals("patch size", (S32)gh.patch_size, (S32)NORMAL_PATCH_SIZE);
+
+		init_patch_decompressor(gh.patch_size);
+		gh.stride = stride;
+		set_group_of_patch_header(&gh);
+
+		S32 patches = 0;
+		while (1)
+		{
+			LLPatchHeader ph;
+			decode_patch_header(bitpack, &ph, FALSE);
+			if (ph.quant_wbits == END_OF_PATCHES)
+			{
+				break;
+			}
+			S32 x = ph.patchids >> 5;
+			S32 y = ph.patchids & 0x1F;
+			ensure("patch id in range", x < 2 && y < 2);
+
+			decode_patch(bitpack, cpatch);
+			S32 offset = y*NORMAL_PATCH_SIZE*stride + x*NORMAL_PATCH_SIZE;
+			decompress_patch(heights + offset, cpatch, &ph);
+			reference_decompress(expected + offset, stride, cpatch, ph, NORMAL_PATCH_SIZE);
+			patches++;
+		}
+		ensure_equals("patch count", patches, 4);
+
+		for (S32 i = 0; i < stride*stride; i++)
+		{
+			ensure_equals("height", heights[i], expected[i]);
+			ensure("plausible height", heights[i] > 10.f && heights[i] < 35.f);
+		}
+	}
+
+	template<> template<>
+	void patch_idct_test_object_t::test<2>()
+	{
+		// 32x32 patches (Aurora/OpenSim large regions) use all 1024 coefficients
+		LLGroupHeader gh;
+		gh.stride = LARGE_PATCH_SIZE;
+		gh.patch_size = LARGE_PATCH_SIZE;
+		gh.layer_type = 'M';
+		init_patch_decompressor(gh.patch_size);
+		set_group_of_patch_header(&gh);
+
+		LLPatchHeader ph;
+		ph.dc_offset = 18.5f;
+		ph.range = 40;
+		ph.quant_wbits = (8 << 4) | 11;
+		ph.patchids = 0;
+
+		S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		U32 seed = 12345;
+		for (S32 i = 0; i < LARGE_PATCH_SIZE*LARGE_PATCH_SIZE; i++)
+		{
+			seed = seed*1664525 + 1013904223;
+			S32 falloff = 1 + i/32;
+			cpatch[i] = ((S32)(seed >> 16) % 512 - 256)/falloff;
+		}
+
+		F32 heights[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		F32 expected[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		decompress_patch(heights, cpatch, &ph);
+		reference_decompress(expected, LARGE_PATCH_SIZE, cpatch, ph, LARGE_PATCH_SIZE);
+
+		for (S32 i = 0; i < LARGE_PATCH_SIZE*LARGE_PATCH_SIZE; i++)
+		{
+			ensure_equals("height", heights[i], expected[i]);
+		}
+	}
+
+	template<> template<>
+	void patch_idct_test_object_t::test<3>()
+	{
+		// decompress_patchv writes the same heights into vertex z
+		LLGroupHeader gh;
+		gh.stride = NORMAL_PATCH_SIZE;
+		gh.patch_size = NORMAL_PATCH_SIZE;
+		gh.layer_type = 'L';
+		init_patch_decompressor(gh.patch_size);
+		set_group_of_patch_header(&gh);
+
+		LLPatchHeader ph;
+		ph.dc_offset = -3.f;
+		ph.range = 12;
+		ph.quant_wbits = (8 << 4) | 9;
+		ph.patchids = 0;
+
+		S32 cpatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+		for (S32 i = 0; i < NORMAL_PATCH_SIZE*NORMAL_PATCH_SIZE; i++)
+		{
+			cpatch[i] = (i < 40) ? ((i*37) % 61 - 30) : 0;
+		}
+
+		F32 heights[NORMAL_PATCH_SIZE*NORMAL_PATCH_SIZE];
+		LLVector3 verts[NORMAL_PATCH_SIZE*NORMAL_PATCH_SIZE];
+		decompress_patch(heights, cpatch, &ph);
+		decompress_patchv(verts, cpatch, &ph);
+
+		for (S32 i = 0; i < NORMAL_PATCH_SIZE*NORMAL_PATCH_SIZE; i++)
+		{
+			ensure_equals("vertex z", verts[i].mV[VZ], heights[i]);
+		}
+	}
+}
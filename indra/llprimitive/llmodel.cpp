@@ -1391,7 +1391,8 @@ LLMeshSkinInfo::LLMeshSkinInfo():
     mPelvisOffset(0.0),
     mLockScaleIfJointPosition(false),
     mInvalidJointsScrubbed(false),
-    mJointNumsInitialized(false)
+    mJointNumsInitialized(false),
+    mPaletteHash(0)
 {
 }
 
@@ -1399,7 +1400,8 @@ LLMeshSkinInfo::LLMeshSkinInfo(LLSD& skin):
     mPelvisOffset(0.0),
     mLockScaleIfJointPosition(false),
     mInvalidJointsScrubbed(false),
-    mJointNumsInitialized(false)
+    mJointNumsInitialized(false),
+    mPaletteHash(0)
 {
 	fromLLSD(skin);
 }
@@ -63,6 +63,10 @@ public:
     bool mLockScaleIfJointPosition;
     bool mInvalidJointsScrubbed;
     bool mJointNumsInitialized;
+    // <FS> Shared skinning palettes: hash of mJointNums and mInvBindMatrix,
+    // set together with mJointNums
+    mutable size_t mPaletteHash;
+    // </FS>
 };
 
 class LLModel : public LLVolume
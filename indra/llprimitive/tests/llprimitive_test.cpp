@@ -226,6 +226,43 @@ namespace tut
 		// Ensure that we now have a different volume
 		ensure(new_volume != primitive.getVolume());
 	}
+
+	template<> template<>
+	void llprimitive_object_t::test<7>()
+	{
+		set_test_name("Test LLVolumeMgr adoption of volumes generated elsewhere.");
+		LLVolumeMgr volume_mgr;
+		LLVolumeParams params;
+		params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+
+		// Nothing references these params yet, so there is nothing to adopt into
+		LLPointer<LLVolume> orphan = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(2));
+		ensure(!volume_mgr.hasVolume(params, 2));
+		ensure(volume_mgr.adoptVolume(orphan, 2) == FALSE);
+
+		LLPointer<LLVolume> low = volume_mgr.refVolume(params, 0);
+		ensure(volume_mgr.hasVolume(params, 0));
+		ensure(!volume_mgr.hasVolume(params, 2));
+
+		// A volume built off the main thread is shared through refVolume()
+		LLPointer<LLVolume> generated = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(2));
+		ensure(volume_mgr.adoptVolume(generated, 2) == TRUE);
+		ensure(volume_mgr.hasVolume(params, 2));
+
+		LLPointer<LLVolume> high = volume_mgr.refVolume(params, 2);
+		ensure(high == generated);
+		ensure_equals(high->getNumVolumeFaces(), generated->getNumVolumeFaces());
+
+		// A second copy of the same LOD is refused rather than replacing the shared one
+		LLPointer<LLVolume> duplicate = new LLVolume(params, LLVolumeLODGroup::getVolumeScaleFromDetail(2));
+		ensure(volume_mgr.adoptVolume(duplicate, 2) == FALSE);
+		ensure(volume_mgr.refVolume(params, 2) == generated.get());
+		volume_mgr.unrefVolume(generated);
+
+		volume_mgr.unrefVolume(high);
+		volume_mgr.unrefVolume(low);
+		ensure(!volume_mgr.hasVolume(params, 0));
+	}
 }
 
 #include "llmessagesystem_stub.cpp"
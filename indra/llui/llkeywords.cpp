@@ -34,6 +34,8 @@
 #include "lltexteditor.h"
 #include "llstl.h"
 
+#include <boost/functional/hash.hpp>
+
 inline bool LLKeywordToken::isHead(const llwchar* s) const
 {
 	// strncmp is much faster than string compare
@@ -68,7 +70,8 @@ inline bool LLKeywordToken::isTail(const llwchar* s) const
 }
 
 LLKeywords::LLKeywords()
-:	mLoaded(false)
+:	mLoaded(false),
+	mMaxWordLength(0)
 {
 }
 
@@ -76,6 +79,7 @@ LLKeywords::~LLKeywords()
 {
 	std::for_each(mWordTokenMap.begin(), mWordTokenMap.end(), DeletePairedPointer());
 	mWordTokenMap.clear();
+	mWordTokenIndex.clear();
 	std::for_each(mLineTokenList.begin(), mLineTokenList.end(), DeletePointer());
 	mLineTokenList.clear();
 	std::for_each(mDelimiterTokenList.begin(), mDelimiterTokenList.end(), DeletePointer());
@@ -111,6 +115,8 @@ void LLKeywords::addToken(LLKeywordToken::ETokenType type,
 	case LLKeywordToken::TT_TYPE:
 	case LLKeywordToken::TT_WORD:
 		mWordTokenMap[key] = new LLKeywordToken(type, color, key, tool_tip, LLWStringUtil::null);
+		mWordTokenIndex[key] = mWordTokenMap[key];
+		mMaxWordLength = llmax(mMaxWordLength, key.size());
 		break;
 
 	case LLKeywordToken::TT_LINE:
@@ -498,6 +504,17 @@ bool LLKeywords::WStringMapIndex::operator<(const LLKeywords::WStringMapIndex &o
 	return result;
 }
 
+bool LLKeywords::WStringMapIndex::operator==(const LLKeywords::WStringMapIndex &other) const
+{
+	return mLength == other.mLength
+		&& (mData == other.mData || !memcmp(mData, other.mData, mLength * sizeof(llwchar)));
+}
+
+size_t hash_value(const LLKeywords::WStringMapIndex& index)
+{
+	return boost::hash_range(index.mData, index.mData + index.mLength);
+}
+
 LLTrace::BlockTimerStatHandle FTM_SYNTAX_COLORING("Syntax Coloring");
 
 // Walk through a string, applying the rules specified by the keyword token list and
@@ -514,11 +531,13 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 
 	S32 text_len = wtext.size() + 1;
 
+	// the editor's font may have changed since the last call
+	mStyleCache.clear();
+	mLineBreakStyle = getDefaultStyle(editor);
+
 	// <FS:Ansariel> Script editor ignoring font selection
 	//seg_list->push_back( new LLNormalTextSegment( defaultColor, 0, text_len, editor ) );
-	LLStyleSP style = getDefaultStyle(editor);
-	style->setColor(defaultColor);
-	seg_list->push_back( new LLNormalTextSegment( style, 0, text_len, editor ) );
+	seg_list->push_back( new LLNormalTextSegment( getStyle(defaultColor, editor), 0, text_len, editor ) );
 	// </FS:Ansariel>
 
 	const llwchar* base = wtext.c_str();
@@ -531,7 +550,7 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 			{
 				// <FS:Ansariel> Script editor ignoring font selection
 				//LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(cur-base);
-				LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(getDefaultStyle(editor), cur-base);
+				LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(mLineBreakStyle, cur-base);
 				// </FS:Ansariel>
 				text_segment->setToken( 0 );
 				insertSegment( *seg_list, text_segment, text_len, defaultColor, editor);
@@ -714,8 +733,8 @@ void LLKeywords::findSegments(std::vector<LLTextSegmentPtr>* seg_list, const LLW
 				if( seg_len > 0 )
 				{
 					WStringMapIndex word( cur, seg_len );
-					word_token_map_t::iterator map_iter = mWordTokenMap.find(word);
-					if( map_iter != mWordTokenMap.end() )
+					word_token_index_t::iterator map_iter = (size_t)seg_len <= mMaxWordLength ? mWordTokenIndex.find(word) : mWordTokenIndex.end();
+					if( map_iter != mWordTokenIndex.end() )
 					{
 						LLKeywordToken* cur_token = map_iter->second;
 						S32 seg_start = cur - base;
@@ -748,9 +767,7 @@ void LLKeywords::insertSegments(const LLWString& wtext, std::vector<LLTextSegmen
 		{
 			// <FS:Ansariel> Script editor ignoring font selection
 			//LLTextSegmentPtr text_segment = new LLNormalTextSegment( cur_token->getColor(), seg_start, pos, editor );
-			LLStyleSP style = getDefaultStyle(editor);
-			style->setColor(cur_token->getColor());
-			LLTextSegmentPtr text_segment = new LLNormalTextSegment( style, seg_start, pos, editor );
+			LLTextSegmentPtr text_segment = new LLNormalTextSegment( getStyle(cur_token->getColor(), editor), seg_start, pos, editor );
 			// </FS:Ansariel>
 			text_segment->setToken( cur_token );
 			insertSegment( seg_list, text_segment, text_len, defaultColor, editor);
@@ -758,7 +775,7 @@ void LLKeywords::insertSegments(const LLWString& wtext, std::vector<LLTextSegmen
 
 		// <FS:Ansariel> Script editor ignoring font selection
 		//LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(pos);
-		LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(getDefaultStyle(editor), pos);
+		LLTextSegmentPtr text_segment = new LLLineBreakTextSegment(mLineBreakStyle, pos);
 		// </FS:Ansariel>
 		text_segment->setToken( cur_token );
 		insertSegment( seg_list, text_segment, text_len, defaultColor, editor);
@@ -769,9 +786,7 @@ void LLKeywords::insertSegments(const LLWString& wtext, std::vector<LLTextSegmen
 
 	// <FS:Ansariel> Script editor ignoring font selection
 	//LLTextSegmentPtr text_segment = new LLNormalTextSegment( cur_token->getColor(), seg_start, seg_end, editor );
-	LLStyleSP style = getDefaultStyle(editor);
-	style->setColor(cur_token->getColor());
-	LLTextSegmentPtr text_segment = new LLNormalTextSegment( style, seg_start, seg_end, editor );
+	LLTextSegmentPtr text_segment = new LLNormalTextSegment( getStyle(cur_token->getColor(), editor), seg_start, seg_end, editor );
 	// </FS:Ansariel>
 	text_segment->setToken( cur_token );
 	insertSegment( seg_list, text_segment, text_len, defaultColor, editor);
@@ -796,9 +811,7 @@ void LLKeywords::insertSegment(std::vector<LLTextSegmentPtr>& seg_list, LLTextSe
 	{
 		// <FS:Ansariel> Script editor ignoring font selection
 		//seg_list.push_back( new LLNormalTextSegment( defaultColor, new_seg_end, text_len, editor ) );
-		LLStyleSP style = getDefaultStyle(editor);
-		style->setColor(defaultColor);
-		seg_list.push_back( new LLNormalTextSegment( style, new_seg_end, text_len, editor ) );
+		seg_list.push_back( new LLNormalTextSegment( getStyle(defaultColor, editor), new_seg_end, text_len, editor ) );
 		// </FS:Ansariel>
 	}
 }
@@ -959,6 +972,22 @@ LLStyleSP LLKeywords::getDefaultStyle(const LLTextEditor& editor)
 	style->setFont(editor.getFont());
 	return style;
 }
+
+LLStyleSP LLKeywords::getStyle(const LLColor4& color, const LLTextEditor& editor)
+{
+	// a script has a handful of colors, a list beats hashing them
+	for (style_cache_t::const_iterator it = mStyleCache.begin(); it != mStyleCache.end(); ++it)
+	{
+		if (it->first == color)
+		{
+			return it->second;
+		}
+	}
+	LLStyleSP style = getDefaultStyle(editor);
+	style->setColor(color);
+	mStyleCache.push_back(std::make_pair(color, style));
+	return style;
+}
 // </FS:Ansariel>
 
 #ifdef _DEBUG
@@ -35,6 +35,7 @@
 #include <map>
 #include <list>
 #include <deque>
+#include <boost/unordered_map.hpp>
 #include "llpointer.h"
 
 // <FS:Ansariel> Script editor ignoring font selection
@@ -151,6 +152,8 @@ public:
 		WStringMapIndex(const llwchar *start, size_t length);
 		~WStringMapIndex();
 		bool operator<(const WStringMapIndex &other) const;
+		bool operator==(const WStringMapIndex &other) const;
+		friend size_t hash_value(const WStringMapIndex& index);
 	private:
 		void copyData(const llwchar *start, size_t length);
 		const llwchar *mData;
@@ -193,6 +196,11 @@ protected:
 	bool		mLoaded;
 	LLSD		mSyntax;
 	word_token_map_t mWordTokenMap;
+	// The same tokens hashed, for looking words up in findSegments().
+	// mWordTokenMap stays for callers that list keywords in order.
+	typedef boost::unordered_map<WStringMapIndex, LLKeywordToken*> word_token_index_t;
+	word_token_index_t mWordTokenIndex;
+	size_t mMaxWordLength;
 	typedef std::deque<LLKeywordToken*> token_list_t;
 	token_list_t mLineTokenList;
 	token_list_t mDelimiterTokenList;
@@ -206,6 +214,13 @@ protected:
 
 	// <FS:Ansariel> Script editor ignoring font selection
 	LLStyleSP getDefaultStyle(const LLTextEditor& editor);
+
+	// One style per color for the segments of a findSegments() call,
+	// rather than a new style for every segment.
+	LLStyleSP getStyle(const LLColor4& color, const LLTextEditor& editor);
+	typedef std::vector<std::pair<LLColor4, LLStyleSP> > style_cache_t;
+	style_cache_t mStyleCache;
+	LLStyleSP mLineBreakStyle;
 };
 
 #endif  // LL_LLKEYWORDS_H
@@ -150,6 +150,7 @@ public:
 	/*virtual*/ void	highlightText(S32 offset, S32 num_chars);
 
 	/*virtual*/ void	setColor(const LLColor4&);
+	void			clearColor() { mUseColor = FALSE; } // <FS/> Incremental radar list: back to the list's text colour
 	/*virtual*/ BOOL	isText() const;
 	/*virtual*/ const std::string &	getToolTip() const;
 	/*virtual*/ BOOL	needsToolTip() const;
@@ -30,6 +30,7 @@
 #include "llscrolllistctrl.h"
 
 #include <algorithm>
+#include <set>
 
 #include "llstl.h"
 #include "llboost.h"
@@ -65,6 +66,9 @@
 
 static LLDefaultChildRegistry::Register<LLScrollListCtrl> r("scroll_list");
 
+// Cells a virtual list keeps around for rows that have gone off screen
+static const S32 MAX_BUILT_DATA_ROWS = 256;
+
 // local structures & classes.
 struct SortScrollListItem
 {
@@ -122,6 +126,42 @@ struct SortScrollListItem
 	const bool mAltSort;
 };
 
+// Sorts the rows of a virtual list on the source's cell text, which keeps
+// cells from being built just to be compared.
+struct SortDataRows
+{
+	typedef std::vector<std::pair<S32, BOOL> > sort_order_t;
+	typedef std::vector<const std::vector<std::string>*> key_list_t;
+
+	SortDataRows(const sort_order_t& sort_orders, const key_list_t& keys)
+	:	mSortOrders(sort_orders),
+		mKeys(keys)
+	{}
+
+	bool operator()(const LLScrollListItem* i1, const LLScrollListItem* i2)
+	{
+		// keys are in the same order as mSortOrders
+		S32 sort_result = 0;
+		for (S32 i = (S32)mSortOrders.size() - 1; i >= 0; --i)
+		{
+			const std::vector<std::string>& keys = *mKeys[i];
+			sort_result = LLStringUtil::compareDict(keys[i1->getDataRow()], keys[i2->getDataRow()]);
+			if (sort_result != 0)
+			{
+				if (!mSortOrders[i].second)
+				{
+					sort_result = -sort_result;
+				}
+				break;
+			}
+		}
+		return sort_result < 0;
+	}
+
+	const sort_order_t& mSortOrders;
+	const key_list_t& mKeys;
+};
+
 //---------------------------------------------------------------------------
 // LLScrollListCtrl
 //---------------------------------------------------------------------------
@@ -237,7 +277,9 @@ LLScrollListCtrl::LLScrollListCtrl(const LLScrollListCtrl::Params& p)
 	mPersistSortOrder(p.persist_sort_order),
 	mPersistedSortOrderLoaded(false),
 	mPersistedSortOrderControl(""),
-	mPrimarySortOnly(p.primary_sort_only)
+	mPrimarySortOnly(p.primary_sort_only),
+	mDataSource(NULL),
+	mNumBuiltDataRows(0)
 {
 	mItemListRect.setOriginAndSize(
 		mBorderThickness,
@@ -438,14 +480,10 @@ S32 LLScrollListCtrl::getItemCount() const
 		item_list::const_iterator iter;
 		for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
 		{
-			LLScrollListItem* item  = *iter;
-			std::string filterColumnValue = item->getColumn(mFilterColumn)->getValue().asString();
-			std::transform(filterColumnValue.begin(), filterColumnValue.end(), filterColumnValue.begin(), ::tolower);
-			if (filterColumnValue.find(mFilterString) == std::string::npos)
+			if (!isFiltered(*iter))
 			{
-				continue;
+				count++;
 			}
-			count++;
 		}
 		return count;
 	}
@@ -474,6 +512,10 @@ void LLScrollListCtrl::clearRows()
 {
 	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
 	mItemList.clear();
+	mDataSource = NULL;
+	mDataItems.clear();
+	mDataKeys.clear();
+	mNumBuiltDataRows = 0;
 	//mItemCount = 0;
 
 	// Scroll the bar back up to the top.
@@ -679,6 +721,11 @@ LLRect LLScrollListCtrl::getRequiredRect()
 
 BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL requires_column )
 {
+	if (mDataSource)
+	{	// rows of a virtual list come from its data source
+		LL_WARNS() << "Not adding an item to virtual list " << getName() << LL_ENDL;
+		return FALSE;
+	}
 	BOOL not_too_big = getItemCount() < mMaxItemCount;
 	if (not_too_big)
 	{
@@ -1083,6 +1130,12 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
 
 void LLScrollListCtrl::deleteSingleItem(S32 target_index)
 {
+	if (mDataSource)
+	{	// the items belong to the data source rows
+		LL_WARNS() << "Not deleting from virtual list " << getName() << LL_ENDL;
+		return;
+	}
+
 	if (target_index < 0 || target_index >= (S32)mItemList.size())
 	{
 		return;
@@ -1104,6 +1157,12 @@ void LLScrollListCtrl::deleteSingleItem(S32 target_index)
 //FIXME: refactor item deletion
 void LLScrollListCtrl::deleteItems(const LLSD& sd)
 {
+	if (mDataSource)
+	{	// the items belong to the data source rows
+		LL_WARNS() << "Not deleting from virtual list " << getName() << LL_ENDL;
+		return;
+	}
+
 	item_list::iterator iter;
 	for (iter = mItemList.begin(); iter < mItemList.end(); )
 	{
@@ -1128,6 +1187,12 @@ void LLScrollListCtrl::deleteItems(const LLSD& sd)
 
 void LLScrollListCtrl::deleteSelectedItems()
 {
+	if (mDataSource)
+	{	// the items belong to the data source rows
+		LL_WARNS() << "Not deleting from virtual list " << getName() << LL_ENDL;
+		return;
+	}
+
 	item_list::iterator iter;
 	for (iter = mItemList.begin(); iter < mItemList.end(); )
 	{
@@ -1409,7 +1474,7 @@ LLScrollListItem* LLScrollListCtrl::getItemByLabel(const std::string& label, BOO
 	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
 		LLScrollListItem* item = *iter;
-		std::string item_text = item->getColumn(column)->getValue().asString();	// Only select enabled items with matching names
+		std::string item_text = getItemText(item, column);	// Only select enabled items with matching names
 		if (!case_sensitive)
 		{
 			LLStringUtil::toLower(item_text);
@@ -1452,8 +1517,8 @@ BOOL LLScrollListCtrl::selectItemByStringMatch(const LLWString& target, bool pre
 		{
 			LLScrollListItem* item = *iter;
 			// Only select enabled items with matching names
-			LLScrollListCell* cellp = item->getColumn(getSearchColumn());
-			BOOL select = cellp ? item->getEnabled() && ('\0' == cellp->getValue().asString()[0]) : FALSE;
+			BOOL select = (item->getColumn(getSearchColumn()) || item->getDataRow() >= 0)
+				? item->getEnabled() && getItemText(item, getSearchColumn()).empty() : FALSE;
 			if (select)
 			{
 				selectItem(item, -1);
@@ -1475,12 +1540,11 @@ BOOL LLScrollListCtrl::selectItemByStringMatch(const LLWString& target, bool pre
 			LLScrollListItem* item = *iter;
 
 			// Only select enabled items with matching names
-			LLScrollListCell* cellp = item->getColumn(getSearchColumn());
-			if (!cellp)
+			if (!item->getColumn(getSearchColumn()) && item->getDataRow() < 0)
 			{
 				continue;
 			}
-			LLWString item_label = utf8str_to_wstring(cellp->getValue().asString());
+			LLWString item_label = utf8str_to_wstring(getItemText(item, getSearchColumn()));
 			if (!case_sensitive)
 			{
 				LLWStringUtil::toLower(item_label);
@@ -1506,7 +1570,12 @@ BOOL LLScrollListCtrl::selectItemByStringMatch(const LLWString& target, bool pre
 			{
 				// find offset of matching text (might have leading whitespace)
 				S32 offset = item_label.find(target_trimmed);
-				cellp->highlightText(offset, target_trimmed.size());
+				buildDataCells(item);
+				LLScrollListCell* cellp = item->getColumn(getSearchColumn());
+				if (cellp)
+				{
+					cellp->highlightText(offset, target_trimmed.size());
+				}
 				selectItem(item, -1);
 				found = TRUE;
 				break;
@@ -1542,7 +1611,7 @@ const std::string LLScrollListCtrl::getSelectedItemLabel(S32 column) const
 	item = getFirstSelected();
 	if (item)
 	{
-		return item->getColumn(column)->getValue().asString();
+		return getItemText(item, column);
 	}
 
 	return LLStringUtil::null;
@@ -1710,6 +1779,7 @@ void LLScrollListCtrl::drawItems()
 		{
 			return;
 		}
+		std::vector<LLScrollListItem*> drawn_data_rows;
 		item_list::iterator iter;
 		// <FS:Ansariel> Fix for FS-specific people list (radar)
 		//for (S32 line = first_line; line <= last_line; line++)
@@ -1741,6 +1811,12 @@ void LLScrollListCtrl::drawItems()
 
 			if( mScrollLines <= line && line < mScrollLines + num_page_lines )
 			{
+				if (mDataSource)
+				{
+					buildDataCells(item);
+					drawn_data_rows.push_back(item);
+				}
+
 				fg_color = (item->getEnabled() ? mFgUnselectedColor.get() : mFgDisabledColor.get());
 				if( item->getSelected() && mCanSelect)
 				{
@@ -1792,6 +1868,11 @@ void LLScrollListCtrl::drawItems()
 			line++;
 			// </FS:Ansariel> Fix for FS-specific people list (radar)
 		}
+
+		if (mNumBuiltDataRows > MAX_BUILT_DATA_ROWS)
+		{
+			releaseDataCells(drawn_data_rows);
+		}
 	}
 }
 
@@ -2384,6 +2465,11 @@ LLScrollListItem* LLScrollListCtrl::hitItem( S32 x, S32 y )
 		line++;
 	}
 
+	if (hit_item)
+	{
+		buildDataCells(hit_item);
+	}
+
 	return hit_item;
 }
 
@@ -2880,16 +2966,19 @@ BOOL LLScrollListCtrl::handleUnicodeCharHere(llwchar uni_char)
 		{
 			LLScrollListItem* item = *iter;
 
-			LLScrollListCell* cellp = item->getColumn(getSearchColumn());
-			if (cellp)
+			if (item->getColumn(getSearchColumn()) || item->getDataRow() >= 0)
 			{
 				// Only select enabled items with matching first characters
-				LLWString item_label = utf8str_to_wstring(cellp->getValue().asString());
+				LLWString item_label = utf8str_to_wstring(getItemText(item, getSearchColumn()));
 				if (item->getEnabled() && LLStringOps::toLower(item_label[0]) == uni_char)
 				{
 					selectItem(item, -1);
 					mNeedsScroll = true;
-					cellp->highlightText(0, 1);
+					LLScrollListCell* cellp = item->getColumn(getSearchColumn());
+					if (cellp)
+					{
+						cellp->highlightText(0, 1);
+					}
 					mSearchTimer.reset();
 
 					if (mCommitOnKeyboardMovement
@@ -3103,11 +3192,33 @@ void LLScrollListCtrl::updateSort() const
 	{
 		mLastUpdateFrame=0;
 	// </FS:Beq>
+		std::vector<S32> rows;
+		const sort_column_t& primary = mSortColumns.back();
+		LLScrollListColumn* columnp = (mDataSource && primary.first < (S32)mColumnsIndexed.size()) ? mColumnsIndexed[primary.first] : NULL;
+		if (columnp && mDataSource->getSortedRows(columnp->mName, primary.second, rows) && rows.size() == mDataItems.size())
+		{
+			for (size_t i = 0; i < rows.size(); ++i)
+			{
+				mItemList[i] = mDataItems[rows[i]];
+			}
+		}
+		else if (mDataSource)
+		{
+			SortDataRows::key_list_t keys;
+			for (std::vector<sort_column_t>::const_iterator it = mSortColumns.begin(); it != mSortColumns.end(); ++it)
+			{
+				keys.push_back(&getDataKeys(it->first));
+			}
+			std::stable_sort(mItemList.begin(), mItemList.end(), SortDataRows(mSortColumns, keys));
+		}
+		else
+		{
 		// do stable sort to preserve any previous sorts
 		std::stable_sort(
 			mItemList.begin(), 
 			mItemList.end(), 
 			SortScrollListItem(mSortColumns,mSortCallback, mAlternateSort));
+		}
 
 		mSorted = true;
 	}
@@ -3119,6 +3230,13 @@ void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 	std::vector<std::pair<S32, BOOL> > sort_column;
 	sort_column.push_back(std::make_pair(column, ascending));
 
+	if (mDataSource)
+	{
+		SortDataRows::key_list_t keys(1, &getDataKeys(column));
+		std::stable_sort(mItemList.begin(), mItemList.end(), SortDataRows(sort_column, keys));
+		return;
+	}
+
 	// do stable sort to preserve any previous sorts
 	std::stable_sort(
 		mItemList.begin(), 
@@ -3213,7 +3331,7 @@ void	LLScrollListCtrl::copy()
 	std::vector<LLScrollListItem*>::iterator itor;
 	for (itor = items.begin(); itor != items.end(); ++itor)
 	{
-		buffer += (*itor)->getContentsCSV() + "\n";
+		buffer += getItemContentsCSV(*itor) + "\n";
 	}
 	LLClipboard::instance().copyToClipboard(utf8str_to_wstring(buffer), 0, buffer.length());
 }
@@ -3547,6 +3665,19 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 {
 	LL_RECORD_BLOCK_TIME(FTM_ADD_SCROLLLIST_ELEMENT);
 	if (!item_p.validateBlock() || !new_item) return NULL;
+	if (mDataSource)
+	{
+		LL_WARNS() << "Not adding a row to virtual list " << getName() << LL_ENDL;
+		delete new_item;
+		return NULL;
+	}
+	addCells(new_item, item_p);
+	addItem(new_item, pos);
+	return new_item;
+}
+
+void LLScrollListCtrl::addCells(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p)
+{
 	new_item->setNumColumns(mColumns.size());
 
 	// Add any columns we don't already have
@@ -3646,9 +3777,177 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 			new_item->setColumn(column_idx, new LLScrollListSpacer(cell_p));
 		}
 	}
+}
 
-	addItem(new_item, pos);
-	return new_item;
+void LLScrollListCtrl::setDataSource(LLScrollListDataSource* source)
+{
+	mDataSource = source;
+	refreshDataSource();
+}
+
+void LLScrollListCtrl::refreshDataSource()
+{
+	// selection is kept by row value
+	std::set<std::string> selected;
+	for (item_list::const_iterator it = mItemList.begin(); it != mItemList.end(); ++it)
+	{
+		if ((*it)->getSelected())
+		{
+			selected.insert((*it)->getValue().asString());
+		}
+	}
+	std::string last_selected = mLastSelected ? mLastSelected->getValue().asString() : std::string();
+
+	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
+	mItemList.clear();
+	mDataItems.clear();
+	mDataKeys.clear();
+	mNumBuiltDataRows = 0;
+	mLastSelected = NULL;
+
+	S32 row_count = mDataSource ? mDataSource->getRowCount() : 0;
+	mDataItems.reserve(row_count);
+	for (S32 row = 0; row < row_count; ++row)
+	{
+		LLScrollListItem* item = new LLScrollListItem(mDataSource->getRowValue(row), row);
+		if (!selected.empty() && selected.count(item->getValue().asString()))
+		{
+			item->setSelected(TRUE);
+			if (item->getValue().asString() == last_selected)
+			{
+				mLastSelected = item;
+			}
+		}
+		mItemList.push_back(item);
+		mDataItems.push_back(item);
+	}
+
+	// one row is enough to know the line height
+	if (!mItemList.empty())
+	{
+		buildDataCells(mItemList.front());
+	}
+
+	setNeedsSort();
+	mScrollLines = llclamp(mScrollLines, 0, llmax(0, (S32)mItemList.size() - getLinesPerPage()));
+	updateLayout();
+}
+
+void LLScrollListCtrl::refreshDataRow(S32 row)
+{
+	if (!mDataSource || row < 0 || row >= (S32)mDataItems.size())
+	{
+		return;
+	}
+
+	LLScrollListItem* item = mDataItems[row];
+	item->mItemValue = mDataSource->getRowValue(row);
+	if (item->getNumColumns())
+	{
+		// rebuilt the next time it is drawn
+		item->setNumColumns(0);
+		--mNumBuiltDataRows;
+	}
+	for (std::map<S32, std::vector<std::string> >::iterator it = mDataKeys.begin(); it != mDataKeys.end(); ++it)
+	{
+		LLScrollListColumn* column = (it->first >= 0 && it->first < (S32)mColumnsIndexed.size()) ? mColumnsIndexed[it->first] : NULL;
+		if (column && row < (S32)it->second.size())
+		{
+			it->second[row] = mDataSource->getCellText(row, column->mName);
+		}
+	}
+	setNeedsSort();
+}
+
+void LLScrollListCtrl::buildDataCells(LLScrollListItem* item)
+{
+	if (!mDataSource || item->getDataRow() < 0 || item->getNumColumns())
+	{
+		return;
+	}
+
+	LLScrollListItem::Params item_p;
+	LLParamSDParser parser;
+	parser.readSD(mDataSource->getRowElement(item->getDataRow()), item_p);
+	item->setEnabled(item_p.enabled);
+	addCells(item, item_p);
+
+	S32 num_cols = llmin(item->getNumColumns(), (S32)mColumnsIndexed.size());
+	for (S32 i = 0; i < num_cols; ++i)
+	{
+		LLScrollListCell* cell = item->getColumn(i);
+		if (cell && mColumnsIndexed[i])
+		{
+			cell->setWidth(mColumnsIndexed[i]->getWidth());
+		}
+	}
+
+	++mNumBuiltDataRows;
+	updateLineHeightInsert(item);
+}
+
+void LLScrollListCtrl::releaseDataCells(const std::vector<LLScrollListItem*>& keep)
+{
+	for (item_list::iterator it = mItemList.begin(); it != mItemList.end(); ++it)
+	{
+		LLScrollListItem* item = *it;
+		if (item->getNumColumns() && item != mLastSelected
+			&& std::find(keep.begin(), keep.end(), item) == keep.end())
+		{
+			item->setNumColumns(0);
+			--mNumBuiltDataRows;
+		}
+	}
+}
+
+const std::vector<std::string>& LLScrollListCtrl::getDataKeys(S32 column) const
+{
+	std::vector<std::string>& keys = mDataKeys[column];
+	if (keys.size() != mDataItems.size())
+	{
+		LLScrollListColumn* columnp = (column >= 0 && column < (S32)mColumnsIndexed.size()) ? mColumnsIndexed[column] : NULL;
+		keys.resize(mDataItems.size());
+		for (S32 row = 0; row < (S32)keys.size(); ++row)
+		{
+			keys[row] = columnp ? mDataSource->getCellText(row, columnp->mName) : std::string();
+		}
+	}
+	return keys;
+}
+
+std::string LLScrollListCtrl::getItemText(const LLScrollListItem* item, S32 column) const
+{
+	const LLScrollListCell* cell = item->getColumn(column);
+	if (cell)
+	{
+		return cell->getValue().asString();
+	}
+	if (mDataSource && item->getDataRow() >= 0)
+	{
+		return getDataKeys(column)[item->getDataRow()];
+	}
+	return std::string();
+}
+
+std::string LLScrollListCtrl::getItemContentsCSV(const LLScrollListItem* item) const
+{
+	if (item->getNumColumns() || !mDataSource || item->getDataRow() < 0)
+	{
+		return item->getContentsCSV();
+	}
+
+	// virtual row without cells: same text the sort and filter use
+	std::string ret;
+	S32 count = (S32)mColumnsIndexed.size();
+	for (S32 i = 0; i < count; ++i)
+	{
+		ret += getItemText(item, i);
+		if (i < count - 1)
+		{
+			ret += ", ";
+		}
+	}
+	return ret;
 }
 
 LLScrollListItem* LLScrollListCtrl::addSimpleElement(const std::string& value, EAddPosition pos, const LLSD& id)
@@ -3804,7 +4103,7 @@ bool LLScrollListCtrl::isFiltered(const LLScrollListItem* item) const
 {
 	if (mIsFiltered)
 	{
-		std::string filterColumnValue = item->getColumn(mFilterColumn)->getValue().asString();
+		std::string filterColumnValue = getItemText(item, mFilterColumn);
 		std::transform(filterColumnValue.begin(), filterColumnValue.end(), filterColumnValue.begin(), ::tolower);
 		if (filterColumnValue.find(mFilterString) == std::string::npos)
 		{
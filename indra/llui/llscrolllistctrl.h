@@ -50,6 +50,26 @@ class LLScrollListCell;
 class LLTextBox;
 class LLContextMenu;
 
+// Model behind a virtual LLScrollListCtrl, see LLScrollListCtrl::setDataSource().
+// Rows are numbered 0 .. getRowCount() - 1 and are asked for while the list
+// draws, sorts or filters, so the answers should be cheap.
+class LLScrollListDataSource
+{
+public:
+	virtual ~LLScrollListDataSource() {}
+
+	virtual S32 getRowCount() const = 0;
+	// what LLScrollListItem::getValue() returns for the row, selections are kept by it
+	virtual LLSD getRowValue(S32 row) const = 0;
+	// text the row is sorted, filtered and searched on in the named column
+	virtual std::string getCellText(S32 row, const std::string& column) const = 0;
+	// the whole row in the form addElement() takes, only asked for rows on screen
+	virtual LLSD getRowElement(S32 row) const = 0;
+	// Every row, in the order of column, for sources that keep their rows
+	// sorted.  Otherwise the list sorts on getCellText() itself.
+	virtual bool getSortedRows(const std::string& column, bool ascending, std::vector<S32>& rows) const { return false; }
+};
+
 class LLScrollListCtrl : public LLUICtrl, public LLEditMenuHandler, 
 	public LLCtrlListInterface, public LLCtrlScrollInterface
 {
@@ -194,9 +214,25 @@ public:
 	virtual LLScrollListItem* addRow(const LLScrollListItem::Params& value, EAddPosition pos = ADD_BOTTOM);
 	// Simple add element. Takes a single array of:
 	// [ "value" => value, "font" => font, "font-style" => style ]
-	virtual void clearRows(); // clears all elements
+	virtual void clearRows(); // clears all elements, and lets go of any data source
 	virtual void sortByColumn(const std::string& name, BOOL ascending);
 
+	// Virtual mode: the rows come from source instead of addElement() and
+	// friends.  Every row still gets an item for its value and selection,
+	// but cells are only made for rows that are drawn, and dropped again
+	// once the row has been off screen for a while.  Sorting and filtering
+	// use the source's cell text, kept in one array per column, rather than
+	// cells; sort callbacks and the alternate sort don't apply.
+	// Rows change through the source only: call refreshDataSource() when
+	// rows come or go and refreshDataRow() when one of them changes.  Adding
+	// and deleting items is refused while a source is set.  The source must
+	// outlive the list or be unset first.
+	void			setDataSource(LLScrollListDataSource* source);
+	LLScrollListDataSource* getDataSource() const { return mDataSource; }
+	void			refreshDataSource();
+	void			refreshDataRow(S32 row);
+	S32				getNumBuiltDataRows() const { return mNumBuiltDataRows; }
+
 	// These functions take and return an array of arrays of elements, as above
 	virtual void	setValue(const LLSD& value );
 	virtual LLSD	getValue() const;
@@ -481,6 +517,14 @@ private:
 	void			drawItems();
 	
 	void            updateLineHeightInsert(LLScrollListItem* item);
+	void			addCells(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p);
+	void			buildDataCells(LLScrollListItem* item);
+	void			releaseDataCells(const std::vector<LLScrollListItem*>& keep);
+	const std::vector<std::string>& getDataKeys(S32 column) const;
+	// cell text without making cells for a virtual row
+	std::string		getItemText(const LLScrollListItem* item, S32 column) const;
+	// getContentsCSV() that also covers virtual rows without cells
+	std::string		getItemContentsCSV(const LLScrollListItem* item) const;
 	void			reportInvalidInput();
 	BOOL			isRepeatedChars(const LLWString& string) const;
 	void			selectItem(LLScrollListItem* itemp, S32 cell, BOOL single_select = TRUE);
@@ -603,6 +647,13 @@ private:
 	sort_signal_t*	mSortCallback;
 
 	is_friend_signal_t*	mIsFriendSignal;
+
+	// virtual mode
+	LLScrollListDataSource*	mDataSource;
+	std::vector<LLScrollListItem*> mDataItems;	// by source row
+	S32				mNumBuiltDataRows;
+	// cell text of every source row, by column index
+	mutable std::map<S32, std::vector<std::string> > mDataKeys;
 }; // end class LLScrollListCtrl
 
 #endif  // LL_SCROLLLISTCTRL_H
@@ -45,7 +45,20 @@ LLScrollListItem::LLScrollListItem( const Params& p )
 	mEnabled(p.enabled),
 	mUserdata(p.userdata),
 	mItemValue(p.value),
-	mItemAltValue(p.alt_value)
+	mItemAltValue(p.alt_value),
+	mDataRow(-1)
+{
+}
+
+LLScrollListItem::LLScrollListItem( const LLSD& value, S32 data_row )
+:	mSelected(FALSE),
+	mHighlighted(FALSE),
+	mHoverIndex(-1),
+	mSelectedIndex(-1),
+	mEnabled(TRUE),
+	mUserdata(NULL),
+	mItemValue(value),
+	mDataRow(data_row)
 {
 }
 
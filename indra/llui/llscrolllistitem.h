@@ -116,6 +116,10 @@ public:
 
 	std::string getContentsCSV() const;
 
+	// Row of LLScrollListCtrl::getDataSource() this item stands for, or -1.
+	// Such items only have cells while they are on screen.
+	S32		getDataRow() const				{ return mDataRow; }
+
 	virtual void draw(const LLRect& rect,
 					  const LLColor4& fg_color,
 					  const LLColor4& hover_color, // highlight/hover selection of whole item or cell
@@ -125,6 +129,8 @@ public:
 
 protected:
 	LLScrollListItem( const Params& );
+	// placeholder for a row of a virtual list, no cells until it is drawn
+	LLScrollListItem( const LLSD& value, S32 data_row );
 
 private:
 	BOOL	mSelected;
@@ -137,6 +143,7 @@ private:
 	LLSD	mItemAltValue;
 	std::vector<LLScrollListCell *> mColumns;
 	LLRect  mRectangle;
+	S32		mDataRow;
 };
 
 #endif
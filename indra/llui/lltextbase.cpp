@@ -179,6 +179,7 @@ LLTextBase::Params::Params()
 	clip_partial("clip_partial", true),
 	line_spacing("line_spacing"),
 	max_text_length("max_length", 255),
+	max_lines("max_lines", 0),
 	font_shadow("font_shadow"),
 	wrap("wrap"),
 	trusted_content("trusted_content", true),
@@ -202,6 +203,7 @@ LLTextBase::LLTextBase(const LLTextBase::Params &p)
 	mIsFriendSignal(NULL),
 	mIsObjectBlockedSignal(NULL),
 	mMaxTextByteLength( p.max_text_length ),
+	mMaxLines(p.max_lines),
 	mFont(p.font),
 	mFontShadow(p.font_shadow),
 	mPopupMenuHandle(),
@@ -1276,11 +1278,21 @@ void LLTextBase::reshape(S32 width, S32 height, BOOL called_from_parent)
 			mScroller->goToBottom();
 		}
 
+		S32 old_width = mVisibleTextRect.getWidth();
+
 		// do this first after reshape, because other things depend on
 		// up-to-date mVisibleTextRect
 		updateRects();
 		
-		needsReflow();
+		// lines only break differently when the width changes
+		if (mVisibleTextRect.getWidth() != old_width || LLView::sForceReshape)
+		{
+			needsReflow();
+		}
+		else
+		{
+			needsRelayout();
+		}
 	}
 }
 
@@ -2424,6 +2436,13 @@ void LLTextBase::appendText(const std::string &new_text, bool prepend_newline, c
 	if(prepend_newline)
 		appendLineBreakSegment(input_params);
 	appendTextImpl(new_text,input_params);
+
+	// trim in batches so the remaining segments are shifted once per batch,
+	// not once per appended line
+	if (mMaxLines > 0 && getLineCount() > mMaxLines + mMaxLines / 8)
+	{
+		removeFirstLines(getLineCount() - mMaxLines);
+	}
 }
 
 void LLTextBase::setLabel(const LLStringExplicit& label)
@@ -2474,6 +2493,12 @@ void LLTextBase::needsReflow(S32 index)
 // [/SL:KB]
 }
 
+void LLTextBase::needsRelayout()
+{
+	// reflowing the last line is enough to place every line and widget again
+	needsReflow(mLineInfoList.empty() ? 0 : mLineInfoList.back().mDocIndexStart);
+}
+
 S32	LLTextBase::removeFirstLine()
 {
     if (!mLineInfoList.empty())
@@ -2486,6 +2511,94 @@ S32	LLTextBase::removeFirstLine()
     return 0;
 }
 
+S32 LLTextBase::removeFirstLines(S32 count)
+{
+	// cut where a paragraph starts, so every line that stays breaks where it did
+	if (count <= 0)
+	{
+		return 0;
+	}
+
+	const LLWString& text = getWText();
+	S32 line = count;
+	while (line < getLineCount())
+	{
+		S32 start = mLineInfoList[line].mDocIndexStart;
+		if (start > 0 && start <= getLength() && text[start - 1] == '\n')
+		{
+			break;
+		}
+		++line;
+	}
+	if (line >= getLineCount())
+	{
+		return 0;
+	}
+
+	// the lines being removed have to be laid out already
+	S32 cut = mLineInfoList[line].mDocIndexStart;
+	if (cut > mReflowIndex)
+	{
+		return 0;
+	}
+
+	bool scrolled_to_bottom = mScroller ? mScroller->isAtBottom() : false;
+	S32 scroll_index = llmax(mScrollIndex, cut);
+	LLRect scroll_rect = getLocalRectFromDocIndex(scroll_index);
+	// top-left relative, the scrollbar may come and go
+	scroll_rect.mTop = mVisibleTextRect.mTop - scroll_rect.mTop;
+	scroll_rect.mBottom = mVisibleTextRect.mTop - scroll_rect.mBottom;
+
+	S32 reflow_index = mReflowIndex;
+	S32 line_num = mLineInfoList[line].mLineNum;
+	S32 delta_top = mLineInfoList[0].mRect.mTop - mLineInfoList[line].mRect.mTop;
+
+	removeStringNoUndo(0, cut);
+
+	// removing the text asked for a reflow from the top, but only the
+	// positions of the remaining lines changed
+	mReflowIndex = (reflow_index == S32_MAX) ? S32_MAX : reflow_index - cut;
+	mLineInfoList.erase(mLineInfoList.begin(), mLineInfoList.begin() + line);
+	for (line_list_t::iterator it = mLineInfoList.begin(); it != mLineInfoList.end(); ++it)
+	{
+		it->mDocIndexStart -= cut;
+		it->mDocIndexEnd -= cut;
+		it->mLineNum -= line_num;
+		it->mRect.translate(0, delta_top);
+	}
+
+	mSelectionStart = llmax(mSelectionStart - cut, 0);
+	mSelectionEnd = llmax(mSelectionEnd - cut, 0);
+	mCursorPos = llmax(mCursorPos - cut, 0);
+	mScrollIndex = scroll_index - cut;
+
+	updateRects();
+	for (segment_set_t::iterator segment_it = mSegments.begin(); segment_it != mSegments.end(); ++segment_it)
+	{
+		LLTextSegmentPtr segmentp = *segment_it;
+		segmentp->updateLayout(*this);
+	}
+
+	if (mScroller && !hasMouseCapture())
+	{
+		if (scrolled_to_bottom && mTrackEnd)
+		{
+			mScroller->goToBottom();
+		}
+		else
+		{
+			// keep the text that was on screen where it was
+			LLRect new_scroll_rect = getDocRectFromDocIndex(mScrollIndex);
+			LLRect old_scroll_rect = scroll_rect;
+			old_scroll_rect.mTop = mVisibleTextRect.mTop - scroll_rect.mTop;
+			old_scroll_rect.mBottom = mVisibleTextRect.mTop - scroll_rect.mBottom;
+			mScroller->scrollToShowRect(new_scroll_rect, old_scroll_rect);
+		}
+	}
+
+	return cut;
+}
+
 void LLTextBase::appendLineBreakSegment(const LLStyle::Params& style_params)
 {
 	segment_vec_t segments;
@@ -3245,10 +3358,14 @@ void LLTextBase::updateRects()
 		// mVisibleTextRect.stretch(-1);
 		// </FS:Zi>
 	}
-	if (mVisibleTextRect != old_text_rect)
+	if (mVisibleTextRect.getWidth() != old_text_rect.getWidth())
 	{
 		needsReflow();
 	}
+	else if (mVisibleTextRect != old_text_rect)
+	{
+		needsRelayout();
+	}
 
 	// update mTextBoundingRect after mVisibleTextRect took scrolls into account
 	if (!mLineInfoList.empty() && mScroller)
@@ -3403,6 +3520,67 @@ boost::signals2::connection LLTextBase::setIsObjectBlockedCallback(const is_bloc
 // LLTextSegment
 //
 
+// Freed segments are pooled by size; a document only ever uses a handful of
+// segment classes.  Segments live on the main thread like the rest of the UI.
+static const size_t SEGMENT_POOL_COUNT = 8;
+static const size_t SEGMENT_POOL_MAX_FREE = 4096;
+
+struct LLTextSegmentPool
+{
+	LLTextSegmentPool() : mSize(0) {}
+
+	size_t				mSize;
+	std::vector<void*>	mFree;
+};
+
+static LLTextSegmentPool* get_segment_pool(size_t size)
+{
+	// never destroyed, segments may still be released during static destruction
+	static LLTextSegmentPool* pools = new LLTextSegmentPool[SEGMENT_POOL_COUNT];
+	for (size_t i = 0; i < SEGMENT_POOL_COUNT; ++i)
+	{
+		if (pools[i].mSize == size)
+		{
+			return &pools[i];
+		}
+		if (!pools[i].mSize)
+		{
+			pools[i].mSize = size;
+			return &pools[i];
+		}
+	}
+	return NULL;
+}
+
+// static
+void* LLTextSegment::operator new(size_t size)
+{
+	LLTextSegmentPool* pool = get_segment_pool(size);
+	if (pool && !pool->mFree.empty())
+	{
+		void* ptr = pool->mFree.back();
+		pool->mFree.pop_back();
+		return ptr;
+	}
+	return ::operator new(size);
+}
+
+// static
+void LLTextSegment::operator delete(void* ptr, size_t size)
+{
+	if (!ptr)
+	{
+		return;
+	}
+	LLTextSegmentPool* pool = get_segment_pool(size);
+	if (pool && pool->mFree.size() < SEGMENT_POOL_MAX_FREE)
+	{
+		pool->mFree.push_back(ptr);
+		return;
+	}
+	::operator delete(ptr);
+}
+
 LLTextSegment::~LLTextSegment()
 {}
 
@@ -116,6 +116,11 @@ public:
 	S32						getEnd() const						{ return mEnd; }
 	void					setEnd( S32 end )					{ mEnd = end; }
 
+	// Chat appends and trims segments by the thousand, freed ones are kept
+	// for the next segment of the same size instead of going back to the heap.
+	static void*			operator new(size_t size);
+	static void				operator delete(void* ptr, size_t size);
+
 protected:
 	S32				mStart;
 	S32				mEnd;
@@ -354,7 +359,8 @@ public:
 		Optional<LineSpacingParams>
 								line_spacing;
 
-		Optional<S32>			max_text_length;
+		Optional<S32>			max_text_length,
+								max_lines;
 
 		Optional<LLFontGL::ShadowType>	font_shadow;
 
@@ -461,10 +467,19 @@ public:
 
 	// force reflow of text
 	void					needsReflow(S32 index = 0);
+	// lay out the document again without moving any line breaks
+	void					needsRelayout();
 
 	S32						getLength() const { return getWText().length(); }
 	S32						getLineCount() const { return mLineInfoList.size(); }
 	S32						removeFirstLine(); // returns removed length
+	// Removes whole paragraphs from the top, at least count lines if there
+	// are enough.  Lines that stay keep their layout.  Returns removed length.
+	S32						removeFirstLines(S32 count);
+	// Once appended text grows past this many lines the oldest paragraphs
+	// are dropped, a few at a time.  0 keeps everything.
+	void					setMaxLines(S32 max_lines) { mMaxLines = max_lines; }
+	S32						getMaxLines() const { return mMaxLines; }
 
 	void					addDocumentChild(LLView* view);
 	void					removeDocumentChild(LLView* view);
@@ -761,6 +776,7 @@ protected:
 	bool						mPlainText;			// didn't use Image or Icon segments
 	bool						mAutoIndent;
 	S32							mMaxTextByteLength;	// Maximum length mText is allowed to be in bytes
+	S32							mMaxLines;			// lines kept by appendText(), 0 for no limit
 	bool						mSkipTripleClick;
 	bool						mSkipLinkUnderline;
 
@@ -292,6 +292,7 @@ LLUrlEntryHTTP::LLUrlEntryHTTP()
 	// </FS:ND>
 	// </FS:Ansariel>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	mMenuName = "menu_url_http.xml";
 	mTooltip = LLTrans::getString("TooltipHttpUrl");
 }
@@ -334,6 +335,7 @@ LLUrlEntryHTTPLabel::LLUrlEntryHTTPLabel()
 	mPattern = boost::regex("\\[(https?|ftp)://\\S+[ \t]+[^\\]]+\\]",
 	// </FS:Ansariel>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	mMenuName = "menu_url_http.xml";
 	mTooltip = LLTrans::getString("TooltipHttpUrl");
 }
@@ -363,6 +365,8 @@ LLUrlEntryHTTPNoProtocol::LLUrlEntryHTTPNoProtocol()
 {
 	mPattern = boost::regex("\\b(www|ftp)\\.\\S+\\.([^\\s<]*)?\\b", // i.e. www.FOO.BAR
 				boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("www.");
+	mAnchors.push_back("ftp.");
 	mMenuName = "menu_url_http.xml";
 	mTooltip = LLTrans::getString("TooltipHttpUrl");
 }
@@ -398,6 +402,8 @@ LLUrlEntryInvalidSLURL::LLUrlEntryInvalidSLURL()
 	// <FS:Beq> remove legacy Inworldz URI support. restore previous with addition of https
 	mPattern = boost::regex("(https?://(maps.secondlife.com|slurl.com)/secondlife/|secondlife://(/app/(worldmap|teleport)/)?)[^ /]+(/-?[0-9]+){1,3}(/?(\\?title|\\?img|\\?msg)=\\S*)?/?",
 									boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/secondlife/");
+	mAnchors.push_back("secondlife://");
 	mMenuName = "menu_url_http.xml";
 	mTooltip = LLTrans::getString("TooltipHttpUrl");
 }
@@ -485,6 +491,7 @@ LLUrlEntrySLURL::LLUrlEntrySLURL()
 	// see http://slurl.com/about.php for details on the SLURL format
 	mPattern = boost::regex("https?://(maps.secondlife.com|slurl.com)/secondlife/[^ /]+(/\\d+){0,3}(/?(\\?title|\\?img|\\?msg)=\\S*)?/?",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/secondlife/");
 	mIcon = "Hand";
 	mMenuName = "menu_url_slurl.xml";
 	mTooltip = LLTrans::getString("TooltipSLURL");
@@ -575,6 +582,7 @@ LLUrlEntrySecondlifeURL::LLUrlEntrySecondlifeURL()
 							"(https?://([-\\w\\.]*\\.)?secondlife\\.io(:\\d{1,5})?))"
 							"\\/\\S*",
 		boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	
 	mIcon = "Hand";
 	mMenuName = "menu_url_http.xml";
@@ -618,6 +626,7 @@ LLUrlEntrySimpleSecondlifeURL::LLUrlEntrySimpleSecondlifeURL()
 							"|"
 							"https?://([-\\w\\.]*\\.)?secondlifegrid\\.net(?!\\S)",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 
 	mIcon = "Hand";
 	mMenuName = "menu_url_http.xml";
@@ -632,6 +641,7 @@ LLUrlEntryAgent::LLUrlEntryAgent()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/\\w+",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 	mMenuName = "menu_url_agent.xml";
 	mIcon = "Generic_Person";
 }
@@ -935,6 +945,7 @@ LLUrlEntryAgentCompleteName::LLUrlEntryAgentCompleteName()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/completename",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 }
 
 std::string LLUrlEntryAgentCompleteName::getName(const LLAvatarName& avatar_name)
@@ -951,6 +962,7 @@ LLUrlEntryAgentLegacyName::LLUrlEntryAgentLegacyName()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/legacyname",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 }
 
 std::string LLUrlEntryAgentLegacyName::getName(const LLAvatarName& avatar_name)
@@ -967,6 +979,7 @@ LLUrlEntryAgentDisplayName::LLUrlEntryAgentDisplayName()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/displayname",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 }
 
 std::string LLUrlEntryAgentDisplayName::getName(const LLAvatarName& avatar_name)
@@ -985,6 +998,7 @@ LLUrlEntryAgentUserName::LLUrlEntryAgentUserName()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/username",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 }
 
 std::string LLUrlEntryAgentUserName::getName(const LLAvatarName& avatar_name)
@@ -1005,6 +1019,7 @@ extern std::string rlvGetAnonym(const LLAvatarName& avName);
 LLUrlEntryAgentRLVAnonymizedName::LLUrlEntryAgentRLVAnonymizedName()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agent/[\\da-f-]+/rlvanonym", boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/agent/");
 }
 
 std::string LLUrlEntryAgentRLVAnonymizedName::getName(const LLAvatarName& avatar_name)
@@ -1022,6 +1037,8 @@ FSUrlEntryAgentSelf::FSUrlEntryAgentSelf() : LLUrlEntryAgent()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/agentself/[\\da-f-]+/\\w+",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.clear();
+	mAnchors.push_back("/app/agentself/");
 }
 
 std::string FSUrlEntryAgentSelf::getLabel(const std::string &url, const LLUrlLabelCallback &cb)
@@ -1047,6 +1064,7 @@ LLUrlEntryGroup::LLUrlEntryGroup()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/group/[\\da-f-]+/\\w+",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/group/");
 	mMenuName = "menu_url_group.xml";
 	mIcon = "Generic_Group";
 	mTooltip = LLTrans::getString("TooltipGroupUrl");
@@ -1124,6 +1142,7 @@ LLUrlEntryInventory::LLUrlEntryInventory()
 	//x-grid-location-info://lincoln.lindenlab.com/app/inventory/0e346d8b-4433-4d66-a6b0-fd37083abc4c/select?name=name with spaces&param2=value
 	mPattern = boost::regex(APP_HEADER_REGEX "/inventory/[\\da-f-]+/\\w+\\S*",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/inventory/");
 	mMenuName = "menu_url_inventory.xml";
 }
 
@@ -1144,6 +1163,7 @@ LLUrlEntryObjectIM::LLUrlEntryObjectIM()
 	mPattern = boost::regex("(hop|secondlife):///app/objectim/[\\da-f-]+\?[^ \t\r\n\v\f]*",
 	// </FS:AW>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back(":///app/objectim/");
 	mMenuName = "menu_url_objectim.xml";
 }
 
@@ -1174,6 +1194,7 @@ LLUrlEntryChat::LLUrlEntryChat()
 {
     mPattern = boost::regex("secondlife:///app/chat/\\d+/\\S+",
         boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("secondlife:///app/chat/");
     mMenuName = "menu_url_slapp.xml";
     mTooltip = LLTrans::getString("TooltipSLAPP");
 }
@@ -1199,6 +1220,7 @@ LLUrlEntryParcel::LLUrlEntryParcel()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/parcel/[\\da-f-]+/about",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/parcel/");
 	mMenuName = "menu_url_parcel.xml";
 	mTooltip = LLTrans::getString("TooltipParcelUrl");
 
@@ -1290,6 +1312,7 @@ LLUrlEntryPlace::LLUrlEntryPlace()
 {
 	mPattern = boost::regex("((hop://[-\\w\\.\\:\\@]+/)|((x-grid-location-info://[-\\w\\.]+/region/)|(secondlife://)))\\S+/?(\\d+/\\d+/\\d+|\\d+/\\d+)/?", // <AW: hop:// protocol>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	mMenuName = "menu_url_slurl.xml";
 	mTooltip = LLTrans::getString("TooltipSLURL");
 }
@@ -1338,6 +1361,7 @@ LLUrlEntryRegion::LLUrlEntryRegion()
 {
 	mPattern = boost::regex("secondlife:///app/region/[A-Za-z0-9()_%]+(/\\d+)?(/\\d+)?(/\\d+)?/?",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("secondlife:///app/region/");
 	mMenuName = "menu_url_slurl.xml";
 	mTooltip = LLTrans::getString("TooltipSLURL");
 }
@@ -1402,6 +1426,7 @@ LLUrlEntryTeleport::LLUrlEntryTeleport()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/teleport/\\S+(/\\d+)?(/\\d+)?(/\\d+)?/?\\S*",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/teleport/");
 	mMenuName = "menu_url_teleport.xml";
 	mTooltip = LLTrans::getString("TooltipTeleportUrl");
 }
@@ -1473,6 +1498,7 @@ FSUrlEntryWear::FSUrlEntryWear()
 {
 	mPattern = boost::regex("(hop|secondlife):///app/wear_folder/\\S+",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back(":///app/wear_folder/");
 	mMenuName = "menu_url_slapp.xml";
 	mTooltip = LLTrans::getString("TooltipFSUrlEntryWear");
 }
@@ -1491,6 +1517,7 @@ LLUrlEntrySL::LLUrlEntrySL()
 {
 	mPattern = boost::regex("(hop|secondlife)://(\\w+)?(:\\d+)?/\\S+", // <AW: hop:// protocol>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	mMenuName = "menu_url_slapp.xml";
 	mTooltip = LLTrans::getString("TooltipSLAPP");
 }
@@ -1509,6 +1536,7 @@ FSHelpDebugUrlEntrySL::FSHelpDebugUrlEntrySL()
 {
 	mPattern = boost::regex("(hop|secondlife):///app/fshelp/showdebug/\\S+",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back(":///app/fshelp/showdebug/");
 	mMenuName = "menu_url_slapp.xml";
 	mTooltip = LLTrans::getString("TooltipFSHelpDebugSLUrl");
 }
@@ -1528,6 +1556,7 @@ LLUrlEntrySLLabel::LLUrlEntrySLLabel()
 {
 	mPattern = boost::regex("\\[(hop|secondlife)://\\S+[ \t]+[^\\]]+\\]", // <AW: hop:// protocol>
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("://");
 	mMenuName = "menu_url_slapp.xml";
 	mTooltip = LLTrans::getString("TooltipSLAPP");
 }
@@ -1577,6 +1606,7 @@ LLUrlEntryWorldMap::LLUrlEntryWorldMap()
 {
 	mPattern = boost::regex(APP_HEADER_REGEX "/worldmap/\\S+/?(\\d+)?/?(\\d+)?/?(\\d+)?/?\\S*",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/worldmap/");
 	mMenuName = "menu_url_map.xml";
 	mTooltip = LLTrans::getString("TooltipMapUrl");
 }
@@ -1618,6 +1648,7 @@ LLUrlEntryNoLink::LLUrlEntryNoLink()
 {
 	mPattern = boost::regex("<nolink>.*?</nolink>",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("<nolink>");
 }
 
 std::string LLUrlEntryNoLink::getUrl(const std::string &url) const
@@ -1645,6 +1676,7 @@ LLUrlEntryIcon::LLUrlEntryIcon()
 {
 	mPattern = boost::regex("<icon\\s*>\\s*([^<]*)?\\s*</icon\\s*>",
 							boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("<icon");
 }
 
 std::string LLUrlEntryIcon::getUrl(const std::string &url) const
@@ -1674,8 +1706,15 @@ std::string LLUrlEntryIcon::getIcon(const std::string &url)
 //
 LLUrlEntryJira::LLUrlEntryJira()
 {
-	// <FS:CR> Please make sure to sync these with the items in "static bool stringHasJira(const std::string &text)" if you make a change
-	mPattern = boost::regex("((?:ARVD|BUG|CHOP|CHUIBUG|CTS|DOC|DN|ECC|EXP|FIRE|FITMESH|LEAP|LLSD|MATBUG|MISC|OPEN|PATHBUG|PLAT|PYO|SCR|SH|SINV|SLS|SNOW|SOCIAL|STORM|SUN|SVC|SPOT|SUN|SUP|TPV|VWR|WEB)-\\d+)",
+	// the projects are listed once, the registry only looks for the anchors
+	static const char* JIRA_KEYS[] = { "ARVD", "BUG", "CHOP", "CHUIBUG", "CTS", "DOC", "DN", "ECC", "EXP", "FIRE", "FITMESH", "LEAP", "LLSD", "MATBUG", "MISC", "OPEN", "PATHBUG", "PLAT", "PYO", "SCR", "SH", "SINV", "SLS", "SNOW", "SOCIAL", "SPOT", "STORM", "SUN", "SUP", "SVC", "TPV", "VWR", "WEB" };
+	std::string keys;
+	for (const char* key : JIRA_KEYS)
+	{
+		keys += (keys.empty() ? "" : "|") + std::string(key);
+		mAnchors.push_back(std::string(key) + "-");
+	}
+	mPattern = boost::regex("((?:" + keys + ")-\\d+)",
 				// <FS:Ansariel> FIRE-917: Match case to reduce number of false positives
 				//boost::regex::perl|boost::regex::icase);
 				boost::regex::perl);
@@ -1715,6 +1754,7 @@ LLUrlEntryEmail::LLUrlEntryEmail()
 {
 	mPattern = boost::regex("(mailto:)?[\\w\\.\\-]+@[\\w\\.\\-]+\\.[a-z]{2,63}",
 							boost::regex::perl | boost::regex::icase);
+	mAnchors.push_back("@");
 	mMenuName = "menu_url_email.xml";
 	mTooltip = LLTrans::getString("TooltipEmail");
 }
@@ -1748,6 +1788,7 @@ LLUrlEntryExperienceProfile::LLUrlEntryExperienceProfile()
 {
     mPattern = boost::regex(APP_HEADER_REGEX "/experience/[\\da-f-]+/profile",
         boost::regex::perl|boost::regex::icase);
+	mAnchors.push_back("/app/experience/");
     mIcon = "Generic_Experience";
 	mMenuName = "menu_url_experience.xml";
 }
@@ -1805,6 +1846,7 @@ LLUrlEntryIPv6::LLUrlEntryIPv6()
 	mHostPath = "https?://\\[([a-f0-9:]+:+)+[a-f0-9]+]";
 	mPattern = boost::regex(mHostPath + "(:\\d{1,5})?(/\\S*)?",
 		boost::regex::perl | boost::regex::icase);
+	mAnchors.push_back("://[");
 	mMenuName = "menu_url_http.xml";
 	mTooltip = LLTrans::getString("TooltipHttpUrl");
 }
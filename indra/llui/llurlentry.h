@@ -39,6 +39,7 @@
 #include <boost/regex.hpp>
 #include <string>
 #include <map>
+#include <vector>
 
 class LLAvatarName;
 
@@ -70,7 +71,12 @@ public:
 	virtual ~LLUrlEntryBase();
 	
 	/// Return the regex pattern that matches this Url 
-	boost::regex getPattern() const { return mPattern; }
+	const boost::regex& getPattern() const { return mPattern; }
+
+	/// Return literals of which every match contains at least one,
+	/// compared ignoring case. The registry only runs the pattern on
+	/// text containing one of them; no anchors means always run it.
+	const std::vector<std::string>& getAnchors() const { return mAnchors; }
 
 	/// Return the url from a string that matched the regex
 	virtual std::string getUrl(const std::string &string) const;
@@ -126,6 +132,7 @@ protected:
 	} LLUrlEntryObserver;
 
 	boost::regex                                   	mPattern;
+	std::vector<std::string>                       	mAnchors;
 	std::string                                    	mIcon;
 	std::string                                    	mMenuName;
 	std::string                                    	mTooltip;
@@ -30,7 +30,7 @@
 #include "llurlregistry.h"
 #include "lluriparser.h"
 
-#include <boost/algorithm/string/find.hpp> //for boost::ifind_first -KC
+#include <algorithm>
 
 // default dummy callback that ignores any label updates from the server
 void LLUrlRegistryNullCallback(const std::string &url, const std::string &label, const std::string& icon)
@@ -38,6 +38,8 @@ void LLUrlRegistryNullCallback(const std::string &url, const std::string &label,
 }
 
 LLUrlRegistry::LLUrlRegistry()
+:	mHasUnanchoredEntry(false),
+	mUseAnchors(true)
 {
 //	mUrlEntry.reserve(20);
 // [RLVa:KB] - Checked: 2010-11-01 (RLVa-1.2.2a) | Added: RLVa-1.2.2a
@@ -116,14 +118,40 @@ void LLUrlRegistry::registerUrl(LLUrlEntryBase *url, bool force_front)
 {
 	if (url)
 	{
+		std::vector<S32> anchors;
+		const std::vector<std::string>& literals = url->getAnchors();
+		for (std::vector<std::string>::const_iterator it = literals.begin(); it != literals.end(); ++it)
+		{
+			anchors.push_back(mLiterals.add(*it, false));
+		}
+		mHasUnanchoredEntry |= anchors.empty();
+
 		if (force_front)  // IDEVO
+		{
 			mUrlEntry.insert(mUrlEntry.begin(), url);
+			mUrlEntryAnchors.insert(mUrlEntryAnchors.begin(), anchors);
+		}
 		else
-		mUrlEntry.push_back(url);
+		{
+			mUrlEntry.push_back(url);
+			mUrlEntryAnchors.push_back(anchors);
+		}
 	}
 }
 
-static bool matchRegex(const char *text, boost::regex regex, U32 &start, U32 &end)
+bool LLUrlRegistry::anyFound(const std::vector<S32>& ids) const
+{
+	for (std::vector<S32>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+	{
+		if (mFound[*it])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool matchRegex(const char *text, const boost::regex &regex, U32 &start, U32 &end)
 {
 	boost::cmatch result;
 	bool found;
@@ -160,67 +188,13 @@ static bool matchRegex(const char *text, boost::regex regex, U32 &start, U32 &en
 	return true;
 }
 
-static bool stringHasUrl(const std::string &text)
-{
-	// fast heuristic test for a URL in a string. This is used
-	// to avoid lots of costly regex calls, BUT it needs to be
-	// kept in sync with the LLUrlEntry regexes we support.
-	return (text.find("://") != std::string::npos ||
-			// text.find("www.") != std::string::npos ||
-			// text.find(".com") != std::string::npos ||
-			// allow ALLCAPS urls -KC
-			boost::ifind_first(text, "www.") ||
-			boost::ifind_first(text, ".com") ||
-			boost::ifind_first(text, ".net") ||
-			boost::ifind_first(text, ".edu") ||
-			boost::ifind_first(text, ".org") ||
-			text.find("<nolink>") != std::string::npos ||
-			text.find("<icon") != std::string::npos ||
-			text.find("@") != std::string::npos);
-}
-
-static bool stringHasJira(const std::string &text)
-{
-	// same as above, but for jiras
-	// <FS:CR> Please make sure to sync these with the items in LLUrlEntryJira::LLUrlEntryJira() if you make a change
-	return (text.find("ARVD") != std::string::npos ||
-			text.find("BUG") != std::string::npos ||
-			text.find("CHOP") != std::string::npos ||
-			text.find("CHUIBUG") != std::string::npos ||
-			text.find("CTS") != std::string::npos ||
-			text.find("DOC") != std::string::npos ||
-			text.find("DN") != std::string::npos ||
-			text.find("ECC") != std::string::npos ||
-			text.find("EXP") != std::string::npos ||
-			text.find("FIRE") != std::string::npos ||
-			text.find("FITMESH") != std::string::npos ||
-			text.find("LEAP") != std::string::npos ||
-			text.find("LLSD") != std::string::npos ||
-			text.find("MATBUG") != std::string::npos ||
-			text.find("MISC") != std::string::npos ||
-			text.find("OPEN") != std::string::npos ||
-			text.find("PATHBUG") != std::string::npos ||
-			text.find("PLAT") != std::string::npos ||
-			text.find("PYO") != std::string::npos ||
-			text.find("SCR") != std::string::npos ||
-			text.find("SH") != std::string::npos ||
-			text.find("SINV") != std::string::npos ||
-			text.find("SLS") != std::string::npos ||
-			text.find("SNOW") != std::string::npos ||
-			text.find("SOCIAL") != std::string::npos ||
-			text.find("STORM") != std::string::npos ||
-			text.find("SUN") != std::string::npos ||
-			text.find("SUP") != std::string::npos ||
-			text.find("SVC") != std::string::npos ||
-			text.find("TPV") != std::string::npos ||
-			text.find("VWR") != std::string::npos ||
-			text.find("WEB") != std::string::npos);
-}
-
 bool LLUrlRegistry::findUrl(const std::string &text, LLUrlMatch &match, const LLUrlLabelCallback &cb, bool is_content_trusted)
 {
-	// avoid costly regexes if there is clearly no URL in the text
-	if (! (stringHasUrl(text) || stringHasJira(text)))
+	// avoid costly regexes if there is clearly no URL in the text. Every
+	// match of an entry's regex contains one of its anchors, so one pass
+	// over the anchors tells which regexes can't match at all.
+	mLiterals.find(text, mFound);
+	if (!mHasUnanchoredEntry && std::find(mFound.begin(), mFound.end(), true) == mFound.end())
 	{
 		return false;
 	}
@@ -238,6 +212,12 @@ bool LLUrlRegistry::findUrl(const std::string &text, LLUrlMatch &match, const LL
 			continue;
 		}
 
+		const std::vector<S32>& anchors = mUrlEntryAnchors[it - mUrlEntry.begin()];
+		if (mUseAnchors && !anchors.empty() && !anyFound(anchors))
+		{
+			continue;
+		}
+
 		LLUrlEntryBase *url_entry = *it;
 
 		U32 start = 0, end = 0;
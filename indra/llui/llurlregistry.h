@@ -30,6 +30,7 @@
 
 #include "llurlentry.h"
 #include "llurlmatch.h"
+#include "llliteralmatcher.h"
 #include "llsingleton.h"
 #include "llstring.h"
 
@@ -88,8 +89,19 @@ public:
 	bool isUrl(const std::string &text);
 	bool isUrl(const LLWString &text);
 
+	/// only try the regexes of entries whose anchors occur in the text
+	/// (default); off tries every regex, for comparing the two
+	void setUseAnchors(bool use_anchors) { mUseAnchors = use_anchors; }
+
 private:
+	bool anyFound(const std::vector<S32>& ids) const;
+
 	std::vector<LLUrlEntryBase *> mUrlEntry;
+	std::vector<std::vector<S32> > mUrlEntryAnchors;	// literal ids, parallel to mUrlEntry
+	LLLiteralMatcher mLiterals;	// every entry's anchors
+	std::vector<bool> mFound;
+	bool mHasUnanchoredEntry;	// whose regex has to be tried on any text
+	bool mUseAnchors;
 	LLUrlEntryBase*	mUrlEntryTrusted;
 	LLUrlEntryBase*	mUrlEntryIcon;
 	LLUrlEntryBase* mLLUrlEntryInvalidSLURL;
@@ -35,6 +35,7 @@
 #include "../llmessage/llexperiencecache.h"
 
 #include <boost/regex.hpp>
+#include <boost/algorithm/string/find.hpp>
 
 #if LL_WINDOWS
 // because something pulls in window and lldxdiag dependencies which in turn need wbemuuid.lib
@@ -119,7 +120,17 @@ namespace tut
 		{
 			S32 start = static_cast<U32>(result[0].first - text);
 			S32 end = static_cast<U32>(result[0].second - text);
-			url = entry.getUrl(std::string(text+start, end-start));
+			std::string matched(text+start, end-start);
+			url = entry.getUrl(matched);
+
+			// the registry skips entries none of whose anchors occur
+			const std::vector<std::string>& anchors = entry.getAnchors();
+			bool anchored = anchors.empty();
+			for (size_t i = 0; i < anchors.size() && !anchored; ++i)
+			{
+				anchored = !boost::ifind_first(matched, anchors[i]).empty();
+			}
+			ensure(testname + " anchored", anchored);
 		}
 		ensure_equals(testname, url, expected);
 	}
@@ -932,4 +943,33 @@ namespace tut
 			"http://[ 2001:0db8:11a3:09d7:1f34:8a2e:07a0:765d ]",
 			"");
 	}
+
+	template<> template<>
+	void object::test<17>()
+	{
+		//
+		// test LLUrlEntryJira
+		//
+		LLUrlEntryJira url;
+
+		testRegex("match a Firestorm issue", url,
+			"fixed in FIRE-12754 at last",
+			"https://jira.firestormviewer.org/browse/FIRE-12754");
+
+		testRegex("match a Second Life issue", url,
+			"see BUG-1234",
+			"https://jira.secondlife.com/browse/BUG-1234");
+
+		testRegex("match a SPOT issue", url,
+			"SPOT-42",
+			"https://jira.secondlife.com/browse/SPOT-42");
+
+		testRegex("don't match without a number", url,
+			"FIRE- is not an issue",
+			"");
+
+		testRegex("don't match other case", url,
+			"fire-12754",
+			"");
+	}
 }
@@ -1292,6 +1292,11 @@ static LLTrace::BlockTimerStatHandle FTM_APPEND_MESSAGE("Append Chat Message");
 void FSChatHistory::appendMessage(const LLChat& chat, const LLSD &args, const LLStyle::Params& input_append_params)
 {
 	LL_RECORD_BLOCK_TIME(FTM_APPEND_MESSAGE);
+
+	// oldest lines are dropped once the history grows past this
+	static LLCachedControl<S32> max_lines(gSavedSettings, "FSChatHistoryMaxLines");
+	setMaxLines(llmax((S32)max_lines, 0));
+
 	// Ansa: FIRE-12754: Hack around a weird issue where the doc size magically increases by 1px
 	//       during draw if the doc exceeds the visible space and the scrollbar is getting visible.
 	mScrollToBottom = (mScroller->isAtBottom() || mScroller->getScrollbar(LLScrollContainer::VERTICAL)->getDocPosMax() <= 1);
@@ -87,7 +87,8 @@ FSPanelRadar::FSPanelRadar()
 		mVisibleCheckFunction(NULL),
 		mUpdateSignalConnection(),
 		mFSRadarColumnConfigConnection(),
-		mLastResizeDelta(0)
+		mLastResizeDelta(0),
+		mNeedsFullUpdate(true)
 {
 	mButtonsUpdater = new FSButtonsUpdater(boost::bind(&FSPanelRadar::updateButtons, this));
 	mCommitCallbackRegistrar.add("Radar.AddFriend",	boost::bind(&FSPanelRadar::onAddFriendButtonClicked,	this));
@@ -308,22 +309,18 @@ void FSPanelRadar::requestUpdate()
 		std::vector<LLSD> entries;
 		LLSD stats;
 		radar->getCurrentData(entries, stats);
-		updateList(entries, stats);
+		rebuildList(entries, stats);
 	}
 }
 
-void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stats)
+void FSPanelRadar::rebuildList(const std::vector<LLSD>& entries, const LLSD& stats)
 {
 	if (mVisibleCheckFunction && !mVisibleCheckFunction())
 	{
+		mNeedsFullUpdate = true;
 		return;
 	}
-
-	static const std::string flagsColumnType = getString("FlagsColumnType");
-	static const std::string flagsColumnValues [3] = { getString("FlagsColumnValue_0"), getString("FlagsColumnValue_1"), getString("FlagsColumnValue_2") };
-	static const std::string notesColumnIcon = getString("NotesColumnIcon");
-	static const std::string sittingColumnIcon = getString("SittingColumnIcon");
-	static const std::string typingColumnIcon = getString("TypingColumnIcon");
+	mNeedsFullUpdate = false;
 
 	// Store current selection and scroll position
 	LLUUID last_selected_id;
@@ -346,107 +343,272 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
 	mRadarList->setNeedsSort(false);
 
 	mRadarList->clearRows();
+	mRows.clear();
 	const std::vector<LLSD>::const_iterator it_end = entries.end();
 	for (std::vector<LLSD>::const_iterator it = entries.begin(); it != it_end; ++it)
 	{
-		LLSD entry = (*it)["entry"];
-		LLSD options = (*it)["options"];
+		addRow(*it);
+	}
+	updateSeenTimes();
+
+	mRadarList->setNeedsSort(needs_sort);
+	mRadarList->updateSort();
+
+	updateHeader(stats);
+
+	mRadarList->refreshLineHeight();
+
+	// Restore scroll position
+	mRadarList->setScrollPos(lastScroll);
+
+	// Restore selection list
+	if (!selected_ids.empty())
+	{
+		mRadarList->selectMultiple(selected_ids);
+		if (last_selected_id.notNull())
+		{
+			mRadarList->setLastSelectedItem(last_selected_id);
+		}
+	}
+
+	updateButtons();
+	mChangeSignal();
+}
+
+void FSPanelRadar::updateList(const FSRadar::RowChanges& changes, const LLSD& stats)
+{
+	if (mVisibleCheckFunction && !mVisibleCheckFunction())
+	{
+		// Changes missed while hidden are picked up with a full rebuild
+		mNeedsFullUpdate = true;
+		return;
+	}
 
-		LLSD row_data;
-		row_data["value"] = entry["id"];
-		row_data["columns"][0]["column"] = "name";
-		row_data["columns"][0]["value"] = entry["name"];
+	if (mNeedsFullUpdate)
+	{
+		requestUpdate();
+		return;
+	}
 
-		row_data["columns"][1]["column"] = "voice_level";
-		row_data["columns"][1]["type"] = "icon";
-		row_data["columns"][1]["value"] = ""; // Need to set it after the row has been created because it's to big for the row
+	mRadarList->setCommentText(RlvActions::canShowNearbyAgents() ? LLStringUtil::null : RlvStrings::getString("blocked_nearby"));
 
-		row_data["columns"][2]["column"] = "in_region";
-		row_data["columns"][2]["type"] = "icon";
-		if (entry["on_parcel"].asBoolean())
+	// Rows are patched in place, so selection and scroll position stay as they are
+	bool selection_changed = false;
+	// deleteSingleItem() sorts before it deletes, which would move the index from under us
+	mRadarList->updateSort();
+	const uuid_vec_t::const_iterator removed_end = changes.mRemoved.end();
+	for (uuid_vec_t::const_iterator it = changes.mRemoved.begin(); it != removed_end; ++it)
+	{
+		row_map_t::iterator found = mRows.find(*it);
+		if (found != mRows.end())
 		{
-			row_data["columns"][2]["value"] = "avatar_on_parcel";
+			selection_changed |= found->second.mItem->getSelected();
+			mRadarList->deleteSingleItem(mRadarList->getItemIndex(found->second.mItem));
+			mRows.erase(found);
 		}
-		else if (entry["in_region"].asBoolean())
+	}
+
+	const std::vector<LLSD>::const_iterator updated_end = changes.mUpdated.end();
+	for (std::vector<LLSD>::const_iterator it = changes.mUpdated.begin(); it != updated_end; ++it)
+	{
+		row_map_t::iterator found = mRows.find((*it)["entry"]["id"].asUUID());
+		if (found != mRows.end())
 		{
-			row_data["columns"][2]["value"] = "avatar_in_region";
+			updateRow(found->second, *it);
 		}
 		else
 		{
-			row_data["columns"][2]["value"] = "";
+			addRow(*it);
 		}
+	}
 
-		row_data["columns"][3]["column"] = "typing_status";
-		row_data["columns"][3]["type"] = "icon";
-		row_data["columns"][3]["value"] = (entry["typing"].asBoolean() ? typingColumnIcon : "");
+	const std::vector<LLSD>::const_iterator inserted_end = changes.mInserted.end();
+	for (std::vector<LLSD>::const_iterator it = changes.mInserted.begin(); it != inserted_end; ++it)
+	{
+		addRow(*it);
+	}
 
-		row_data["columns"][4]["column"] = "sitting_status";
-		row_data["columns"][4]["type"] = "icon";
-		row_data["columns"][4]["value"] = (entry["sitting"].asBoolean() ? sittingColumnIcon : "");
+	// The seen column moves every update, so the list is sorted every time
+	updateSeenTimes();
+	mRadarList->setNeedsSort(true);
+	mRadarList->updateSort();
 
-		row_data["columns"][5]["column"] = "flags";
-		row_data["columns"][5]["type"] = flagsColumnType;
+	updateHeader(stats);
 
-		row_data["columns"][6]["column"] = "has_notes";
-		row_data["columns"][6]["type"] = "icon";
-		row_data["columns"][6]["value"] = (entry["notes"].asBoolean() ? notesColumnIcon : "");
-		row_data["columns"][6]["tool_tip"] = entry["notes"].asString();
+	if (!changes.mInserted.empty())
+	{
+		mRadarList->refreshLineHeight();
+	}
 
-		row_data["columns"][7]["column"] = "age";
-		row_data["columns"][7]["value"] = entry["age"];
-		row_data["columns"][7]["halign"] = "right";
+	if (selection_changed || !changes.empty())
+	{
+		updateButtons();
+	}
+	mChangeSignal();
+}
 
-		row_data["columns"][8]["column"] = "seen";
-		row_data["columns"][8]["value"] = entry["seen"];
-		row_data["columns"][8]["halign"] = "right";
+void FSPanelRadar::addRow(const LLSD& data)
+{
+	static const std::string flagsColumnType = getString("FlagsColumnType");
 
-		row_data["columns"][9]["column"] = "range";
-		row_data["columns"][9]["value"] = entry["range"];
+	const LLSD& entry = data["entry"];
+	LLUUID id = entry["id"].asUUID();
+	row_map_t::iterator found = mRows.find(id);
+	if (found != mRows.end())
+	{
+		updateRow(found->second, data);
+		return;
+	}
 
-		row_data["columns"][10]["column"] = "seen_sort";
-		row_data["columns"][10]["value"] = entry["seen"].asString() + "_" + entry["name"].asString();
+	// Cell contents are filled in by updateRow(), like the voice level icon
+	// always was because it's too big for the row.
+	LLSD row_data;
+	row_data["value"] = id;
+	row_data["columns"][0]["column"] = "name";
+	row_data["columns"][0]["value"] = entry["name"];
 
-		LLScrollListItem* row = mRadarList->addElement(row_data);
+	row_data["columns"][1]["column"] = "voice_level";
+	row_data["columns"][1]["type"] = "icon";
+	row_data["columns"][1]["value"] = "";
 
-		static S32 rangeColumnIndex = mRadarList->getColumn("range")->mIndex;
-		static S32 nameColumnIndex = mRadarList->getColumn("name")->mIndex;
-		static S32 voiceLevelColumnIndex = mRadarList->getColumn("voice_level")->mIndex;
-		static S32 flagsColumnIndex = mRadarList->getColumn("flags")->mIndex;
-		static S32 ageColumnIndex = mRadarList->getColumn("age")->mIndex;
+	row_data["columns"][2]["column"] = "in_region";
+	row_data["columns"][2]["type"] = "icon";
+	row_data["columns"][2]["value"] = "";
 
-		LLScrollListText* radarRangeCell = (LLScrollListText*)row->getColumn(rangeColumnIndex);
-		radarRangeCell->setColor(LLColor4(options["range_color"]));
-		radarRangeCell->setFontStyle(options["range_style"].asInteger());
+	row_data["columns"][3]["column"] = "typing_status";
+	row_data["columns"][3]["type"] = "icon";
+	row_data["columns"][3]["value"] = "";
 
-		LLScrollListText* radarNameCell = (LLScrollListText*)row->getColumn(nameColumnIndex);
-		radarNameCell->setFontStyle(options["name_style"].asInteger());
-		if (options.has("name_color"))
-		{
-			radarNameCell->setColor(LLColor4(options["name_color"]));
-		}
+	row_data["columns"][4]["column"] = "sitting_status";
+	row_data["columns"][4]["type"] = "icon";
+	row_data["columns"][4]["value"] = "";
 
-		LLScrollListText* voiceLevelCell = (LLScrollListText*)row->getColumn(voiceLevelColumnIndex);
-		if (entry.has("voice_level_icon"))
-		{
-			voiceLevelCell->setValue(entry["voice_level_icon"].asString());
-		}
+	row_data["columns"][5]["column"] = "flags";
+	row_data["columns"][5]["type"] = flagsColumnType;
 
-		LLScrollListText* flagsCell = (LLScrollListText*)row->getColumn(flagsColumnIndex);
-		if (entry.has("flags"))
-		{
-			flagsCell->setValue(flagsColumnValues[entry["flags"].asInteger()]);
-		}
+	row_data["columns"][6]["column"] = "has_notes";
+	row_data["columns"][6]["type"] = "icon";
+	row_data["columns"][6]["value"] = "";
 
-		LLScrollListText* ageCell = (LLScrollListText*)row->getColumn(ageColumnIndex);
-		if (options.has("age_color"))
-		{
-			ageCell->setColor(LLColor4(options["age_color"]));
-		}
+	row_data["columns"][7]["column"] = "age";
+	row_data["columns"][7]["value"] = "";
+	row_data["columns"][7]["halign"] = "right";
+
+	row_data["columns"][8]["column"] = "seen";
+	row_data["columns"][8]["value"] = "";
+	row_data["columns"][8]["halign"] = "right";
+
+	row_data["columns"][9]["column"] = "range";
+	row_data["columns"][9]["value"] = "";
+
+	row_data["columns"][10]["column"] = "seen_sort";
+	row_data["columns"][10]["value"] = "";
+
+	RadarListRow& row = mRows[id];
+	row.mItem = mRadarList->addElement(row_data);
+	row.mAgeColored = false;
+	updateRow(row, data);
+}
+
+void FSPanelRadar::updateRow(RadarListRow& row, const LLSD& data)
+{
+	static const std::string flagsColumnValues [3] = { getString("FlagsColumnValue_0"), getString("FlagsColumnValue_1"), getString("FlagsColumnValue_2") };
+	static const std::string notesColumnIcon = getString("NotesColumnIcon");
+	static const std::string sittingColumnIcon = getString("SittingColumnIcon");
+	static const std::string typingColumnIcon = getString("TypingColumnIcon");
+
+	static S32 rangeColumnIndex = mRadarList->getColumn("range")->mIndex;
+	static S32 nameColumnIndex = mRadarList->getColumn("name")->mIndex;
+	static S32 voiceLevelColumnIndex = mRadarList->getColumn("voice_level")->mIndex;
+	static S32 inRegionColumnIndex = mRadarList->getColumn("in_region")->mIndex;
+	static S32 typingColumnIndex = mRadarList->getColumn("typing_status")->mIndex;
+	static S32 sittingColumnIndex = mRadarList->getColumn("sitting_status")->mIndex;
+	static S32 flagsColumnIndex = mRadarList->getColumn("flags")->mIndex;
+	static S32 notesColumnIndex = mRadarList->getColumn("has_notes")->mIndex;
+	static S32 ageColumnIndex = mRadarList->getColumn("age")->mIndex;
+
+	const LLSD& entry = data["entry"];
+	const LLSD& options = data["options"];
+	LLScrollListItem* item = row.mItem;
+	row.mFirstSeen = (time_t)entry["first_seen"].asDate().secondsSinceEpoch();
+
+	LLScrollListText* radarNameCell = (LLScrollListText*)item->getColumn(nameColumnIndex);
+	radarNameCell->setValue(entry["name"]);
+	radarNameCell->setFontStyle(options["name_style"].asInteger());
+	if (options.has("name_color"))
+	{
+		radarNameCell->setColor(LLColor4(options["name_color"]));
 	}
 
-	mRadarList->setNeedsSort(needs_sort);
-	mRadarList->updateSort();
+	item->getColumn(voiceLevelColumnIndex)->setValue(entry.has("voice_level_icon") ? entry["voice_level_icon"].asString() : LLStringUtil::null);
+
+	if (entry["on_parcel"].asBoolean())
+	{
+		item->getColumn(inRegionColumnIndex)->setValue("avatar_on_parcel");
+	}
+	else if (entry["in_region"].asBoolean())
+	{
+		item->getColumn(inRegionColumnIndex)->setValue("avatar_in_region");
+	}
+	else
+	{
+		item->getColumn(inRegionColumnIndex)->setValue("");
+	}
+
+	item->getColumn(typingColumnIndex)->setValue(entry["typing"].asBoolean() ? typingColumnIcon : LLStringUtil::null);
+	item->getColumn(sittingColumnIndex)->setValue(entry["sitting"].asBoolean() ? sittingColumnIcon : LLStringUtil::null);
+
+	if (entry.has("flags"))
+	{
+		item->getColumn(flagsColumnIndex)->setValue(flagsColumnValues[entry["flags"].asInteger()]);
+	}
+
+	LLScrollListCell* notesCell = item->getColumn(notesColumnIndex);
+	notesCell->setValue(entry["notes"].asBoolean() ? notesColumnIcon : LLStringUtil::null);
+	notesCell->setToolTip(entry["notes"].asString());
 
+	LLScrollListText* ageCell = (LLScrollListText*)item->getColumn(ageColumnIndex);
+	ageCell->setValue(entry["age"]);
+	if (options.has("age_color"))
+	{
+		ageCell->setColor(LLColor4(options["age_color"]));
+		row.mAgeColored = true;
+	}
+	else if (row.mAgeColored)
+	{
+		ageCell->clearColor();
+		row.mAgeColored = false;
+	}
+
+	LLScrollListText* radarRangeCell = (LLScrollListText*)item->getColumn(rangeColumnIndex);
+	radarRangeCell->setValue(entry["range"]);
+	radarRangeCell->setColor(LLColor4(options["range_color"]));
+	radarRangeCell->setFontStyle(options["range_style"].asInteger());
+}
+
+void FSPanelRadar::updateSeenTimes()
+{
+	static S32 nameColumnIndex = mRadarList->getColumn("name")->mIndex;
+	static S32 seenColumnIndex = mRadarList->getColumn("seen")->mIndex;
+	static S32 seenSortColumnIndex = mRadarList->getColumn("seen_sort")->mIndex;
+
+	time_t now = time(NULL);
+	const row_map_t::iterator it_end = mRows.end();
+	for (row_map_t::iterator it = mRows.begin(); it != it_end; ++it)
+	{
+		LLScrollListItem* item = it->second.mItem;
+		S32 seentime = (S32)difftime(now, it->second.mFirstSeen);
+		S32 hours = (S32)(seentime / 3600);
+		S32 mins = (S32)((seentime - hours * 3600) / 60);
+		S32 secs = (S32)((seentime - hours * 3600 - mins * 60));
+		std::string seen = llformat("%d:%02d:%02d", hours, mins, secs);
+		item->getColumn(seenSortColumnIndex)->setValue(seen + "_" + item->getColumn(nameColumnIndex)->getValue().asString());
+		item->getColumn(seenColumnIndex)->setValue(seen);
+	}
+}
+
+void FSPanelRadar::updateHeader(const LLSD& stats)
+{
 	LLStringUtil::format_map_t name_count_args;
 	name_count_args["[TOTAL]"] = stats["total"].asString();
 	name_count_args["[IN_REGION]"] = stats["region"].asString();
@@ -454,24 +616,6 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
 	LLScrollListColumn* column = mRadarList->getColumn("name");
 	column->mHeader->setLabel(getString("avatar_name_count", name_count_args));
 	column->mHeader->setToolTipArgs(name_count_args);
-
-	mRadarList->refreshLineHeight();
-
-	// Restore scroll position
-	mRadarList->setScrollPos(lastScroll);
-
-	// Restore selection list
-	if (!selected_ids.empty())
-	{
-		mRadarList->selectMultiple(selected_ids);
-		if (last_selected_id.notNull())
-		{
-			mRadarList->setLastSelectedItem(last_selected_id);
-		}
-	}
-
-	updateButtons();
-	mChangeSignal();
 }
 
 void FSPanelRadar::onColumnDisplayModeChanged()
@@ -505,6 +649,8 @@ void FSPanelRadar::onColumnDisplayModeChanged()
 	BOOL current_sort_asc = mRadarList->getSortAscending();
 	
 	mRadarList->clearRows();
+	mRows.clear();
+	mNeedsFullUpdate = true;
 	mRadarList->clearColumns();
 	mRadarList->updateLayout();
 
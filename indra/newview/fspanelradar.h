@@ -70,7 +70,20 @@ public:
 
 private:
 	void					updateButtons();
-	void					updateList(const std::vector<LLSD>& entries, const LLSD& stats);
+	void					updateList(const FSRadar::RowChanges& changes, const LLSD& stats);
+	void					rebuildList(const std::vector<LLSD>& entries, const LLSD& stats);
+
+	struct RadarListRow
+	{
+		LLScrollListItem*	mItem;
+		time_t				mFirstSeen;
+		bool				mAgeColored;
+	};
+
+	void					addRow(const LLSD& data);
+	void					updateRow(RadarListRow& row, const LLSD& data);
+	void					updateSeenTimes();
+	void					updateHeader(const LLSD& stats);
 
 	// UI callbacks
 	void					onAddFriendButtonClicked();
@@ -100,6 +113,11 @@ private:
 	std::map<std::string, U32> mColumnBits;
 	S32						mLastResizeDelta;
 
+	// List rows by avatar, as FSRadar reports changes to them
+	typedef boost::unordered_map<LLUUID, RadarListRow, FSUUIDHash> row_map_t;
+	row_map_t				mRows;
+	bool					mNeedsFullUpdate;
+
 	// Slot connection for FSRadar updates
 	boost::signals2::connection mUpdateSignalConnection;
 
@@ -31,9 +31,10 @@
 // libs
 #include "llavatarnamecache.h"
 #include "llanimationstates.h"
-#include "llcommonutils.h"
 #include "llnotificationsutil.h"
 #include "lleventtimer.h"
+#include "lltimer.h"
+#include "lltrace.h"
 
 // newview
 #include "fsassetblacklist.h"
@@ -62,6 +63,11 @@
 
 static const F32 FS_RADAR_LIST_UPDATE_INTERVAL = 1.f;
 
+static LLTrace::EventStatHandle<F64Milliseconds > sRadarUpdateTime("radar_update_time",
+																	"Time spent on one update of the nearby avatar list");
+static LLTrace::EventStatHandle<> sRadarRowsChanged("radar_rows_changed",
+													"Radar list rows inserted, updated or removed per update");
+
 /**
  * Periodically updates the nearby people list while the Nearby tab is active.
  * 
@@ -94,9 +100,12 @@ FSRadar::FSRadar() :
 		mRadarFrameCount(0),
 		mRadarLastBulkOffsetRequestTime(0),
 		mRadarLastRequestTime(0.f),
+		mSweep(0),
+		mRowsDirty(false),
 		mShowUsernamesCallbackConnection(),
 		mNameFormatCallbackConnection(),
-		mAgeAlertCallbackConnection()
+		mAgeAlertCallbackConnection(),
+		mContactSetChangedConnection()
 {
 	mRadarListUpdater = new FSRadarListUpdater(boost::bind(&FSRadar::updateRadarList, this));
 
@@ -106,6 +115,9 @@ FSRadar::FSRadar() :
 
 	mNameFormatCallbackConnection = gSavedSettings.getControl("RadarNameFormat")->getSignal()->connect(boost::bind(&FSRadar::updateNames, this));
 	mAgeAlertCallbackConnection = gSavedSettings.getControl("RadarAvatarAgeAlertValue")->getSignal()->connect(boost::bind(&FSRadar::updateAgeAlertCheck, this));
+
+	// Contact set colours aren't part of RowState
+	mContactSetChangedConnection = LGGContactSets::getInstance()->setContactSetChangeCallback(boost::bind(&FSRadar::onContactSetChanged, this));
 }
 
 FSRadar::~FSRadar()
@@ -132,6 +144,33 @@ FSRadar::~FSRadar()
 	{
 		mAgeAlertCallbackConnection.disconnect();
 	}
+
+	if (mContactSetChangedConnection.connected())
+	{
+		mContactSetChangedConnection.disconnect();
+	}
+}
+
+FSRadar::RowState::RowState()
+:	mRange(0),
+	mRangeBucket(RANGE_BEYOND_SHOUT),
+	mDrawRadius(0.f),
+	mVoiceLevel(-1),
+	mAge(-1),
+	mPaymentInfo(FSRADAR_PAYMENT_INFO_NONE),
+	mFlags(0)
+{
+}
+
+bool FSRadar::RowState::operator==(const RowState& other) const
+{
+	return mRange == other.mRange
+		&& mRangeBucket == other.mRangeBucket
+		&& mDrawRadius == other.mDrawRadius
+		&& mVoiceLevel == other.mVoiceLevel
+		&& mAge == other.mAge
+		&& mPaymentInfo == other.mPaymentInfo
+		&& mFlags == other.mFlags;
 }
 
 void FSRadar::radarAlertMsg(const LLUUID& agent_id, const LLAvatarName& av_name, const std::string& postMsg)
@@ -172,15 +211,15 @@ void FSRadar::radarAlertMsg(const LLUUID& agent_id, const LLAvatarName& av_name,
 
 void FSRadar::updateRadarList()
 {
+	LLTimer update_timer;
+
 	//Configuration
 	LLWorld* world = LLWorld::getInstance();
 	LLMuteList* mutelist = LLMuteList::getInstance();
 	FSAssetBlacklist* blacklist = FSAssetBlacklist::getInstance();
-	LGGContactSets* contactsets = LGGContactSets::getInstance();
 	LLLocalSpeakerMgr* speakermgr = LLLocalSpeakerMgr::getInstance();
 	LLVoiceClient* voice_client = LLVoiceClient::getInstance();
 	LLViewerParcelMgr& parcelmgr = LLViewerParcelMgr::instance();
-	LLUIColorTable& colortable = LLUIColorTable::instance();
 	LLAvatarTracker& avatartracker = LLAvatarTracker::instance();
 	FSLSLBridge& bridge = FSLSLBridge::instance();
 
@@ -216,6 +255,7 @@ void FSRadar::updateRadarList()
 	bool sUseLSLBridge = bridge.canUseBridge();
 
 	F32 drawRadius(sRenderFarClip);
+	bool voice_working = voice_client->voiceEnabled() && voice_client->isVoiceWorking();
 	const LLVector3d& posSelf = gAgent.getPositionGlobal();
 	LLViewerRegion* own_reg = gAgent.getRegion();
 	LLUUID regionSelf;
@@ -230,8 +270,9 @@ void FSRadar::updateRadarList()
 	mRadarEnterAlerts.clear();
 	mRadarLeaveAlerts.clear();
 	mRadarOffsetRequests.clear();
-	mRadarEntriesData.clear();
+	mRowChanges.clear();
 	mAvatarStats.clear();
+	++mSweep;
 
 	//STEP 1: Update our basic data model: detect Avatars & Positions in our defined range
 	std::vector<LLVector3d> positions;
@@ -248,36 +289,30 @@ void FSRadar::updateRadarList()
 		}
 	}
 
-	// Determine lists of new added and removed avatars
-	uuid_vec_t current_vec, added_vec, removed_vec;
-	uuid_vec_t::iterator vec_it_end;
-	entry_map_t::iterator em_it_end = mEntryList.end();
-	current_vec.reserve(mEntryList.size());
-	for (entry_map_t::iterator em_it = mEntryList.begin(); em_it != em_it_end; ++em_it)
+	// Add new avatars and stamp the ones still around with this sweep
+	uuid_vec_t::const_iterator vec_it_end = avatar_ids.end();
+	for (uuid_vec_t::const_iterator it = avatar_ids.begin(); it != vec_it_end; ++it)
 	{
-		current_vec.push_back(em_it->first);
+		entry_map_t::iterator found = mEntryList.find(*it);
+		if (found == mEntryList.end())
+		{
+			found = mEntryList.insert(std::make_pair(*it, new FSRadarEntry(*it))).first;
+		}
+		found->second->mSweep = mSweep;
 	}
-	LLCommonUtils::computeDifference(avatar_ids, current_vec, added_vec, removed_vec);
 
 	// Remove old avatars from our list
-	vec_it_end = removed_vec.end();
-	for (uuid_vec_t::iterator it = removed_vec.begin(); it != vec_it_end; ++it)
+	for (entry_map_t::iterator em_it = mEntryList.begin(); em_it != mEntryList.end(); )
 	{
-		LLUUID avid = *it;
-		entry_map_t::iterator found = mEntryList.find(avid);
-		if (found != mEntryList.end())
+		if (em_it->second->mSweep != mSweep)
 		{
-			delete found->second;
-			mEntryList.erase(found);
+			delete em_it->second;
+			em_it = mEntryList.erase(em_it);
+		}
+		else
+		{
+			++em_it;
 		}
-	}
-
-	// Add new avatars
-	vec_it_end = added_vec.end();
-	for (uuid_vec_t::iterator it = added_vec.begin(); it != vec_it_end; ++it)
-	{
-		LLUUID avid = *it;
-		mEntryList[avid] = new FSRadarEntry(avid);
 	}
 
 	speakermgr->update(TRUE);
@@ -342,11 +377,6 @@ void FSRadar::updateRadarList()
 		}
 		bool isInSameRegion = (avRegion == regionSelf);
 		bool isOnSameParcel = parcelmgr.inAgentParcel(avPos);
-		S32 seentime = (S32)difftime(now, ent->mFirstSeen);
-		S32 hours = (S32)(seentime / 3600);
-		S32 mins = (S32)((seentime - hours * 3600) / 60);
-		S32 secs = (S32)((seentime - hours * 3600 - mins * 60));
-		std::string avSeenStr = llformat("%d:%02d:%02d", hours, mins, secs);
 		S32 avStatusFlags     = ent->mStatus;
 		ERadarPaymentInfoFlag avFlag = FSRADAR_PAYMENT_INFO_NONE;
 		if (avStatusFlags & AVATAR_TRANSACTED)
@@ -358,7 +388,7 @@ void FSRadar::updateRadarList()
 			avFlag = FSRADAR_PAYMENT_INFO_FILLED;
 		}
 		S32 avAge = ent->mAge;
-		std::string avName = ent->mName;
+		const std::string& avName = ent->mName;
 		U32 lastZOffsetTime  = ent->mLastZOffsetTime;
 		F32 avZOffset = ent->mZOffset;
 		if (avPos[VZ] == AVATAR_UNKNOWN_Z_OFFSET) // if our official z position is AVATAR_UNKNOWN_Z_OFFSET, we need a correction.
@@ -514,143 +544,136 @@ void FSRadar::updateRadarList()
 		}
 
 		//
-		//2d. Prepare data for presentation view for this avatar
+		//2d. Prepare data for presentation view for this avatar, rebuilding its row only if something shown changed
 		//
 		if (isInSameRegion)
 		{
 			inSameRegion++;
 		}
 
-		LLSD entry;
-		LLSD entry_options;
-
-		entry["id"] = avId;
-		entry["name"] = avName;
-		entry["in_region"] = isInSameRegion;
-		entry["on_parcel"] = isOnSameParcel;
-		entry["flags"] = avFlag;
-		entry["seen"] = avSeenStr;
-		entry["range"] = (avRange > AVATAR_UNKNOWN_RANGE ? llformat("%3.2f", avRange) : llformat(">%3.2f", drawRadius));
-		entry["typing"] = (avVo && avVo->isTyping());
-		entry["sitting"] = (avVo && (avVo->getParent() || avVo->isMotionActive(ANIM_AGENT_SIT_GROUND) || avVo->isMotionActive(ANIM_AGENT_SIT_GROUND_CONSTRAINED)));
-
-		if (!gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES))
+		bool hide_names = gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES);
+		if (!hide_names && ent->hasAlertAge())
 		{
-			entry["notes"] = ent->getNotes();
-			entry["age"] = (avAge > -1 ? llformat("%d", avAge) : "");
-			if (ent->hasAlertAge())
+			if (sRadarAvatarAgeAlert && !ent->hasAgeAlertPerformed())
 			{
-				entry_options["age_color"] = colortable.getColor("AvatarListItemAgeAlert", LLColor4::red).get().getValue();
-
-				if (sRadarAvatarAgeAlert && !ent->hasAgeAlertPerformed())
-				{
-					make_ui_sound("UISndRadarAgeAlert");
-					LLStringUtil::format_map_t args;
-					args["AGE"] = llformat("%d", avAge);
-					std::string message = format_string(str_avatar_age_alert, args);
-					LLAvatarNameCache::get(avId, boost::bind(&FSRadar::radarAlertMsg, this, _1, _2, message));
-				}
-				ent->mAgeAlertPerformed = true;
+				make_ui_sound("UISndRadarAgeAlert");
+				LLStringUtil::format_map_t args;
+				args["AGE"] = llformat("%d", avAge);
+				std::string message = format_string(str_avatar_age_alert, args);
+				LLAvatarNameCache::get(avId, boost::bind(&FSRadar::radarAlertMsg, this, _1, _2, message));
 			}
+			ent->mAgeAlertPerformed = true;
 		}
-		else
+
+		RowState state;
+		state.mRange = ll_round(avRange * 100.f);
+		if (avRange > AVATAR_UNKNOWN_RANGE && avRange <= chat_range_say)
 		{
-			entry["notes"] = LLStringUtil::null;
-			entry["age"] = "---";
+			state.mRangeBucket = RowState::RANGE_CHAT;
+			inChatRange++;
 		}
-
-		//AO: Set any range colors / styles
-		LLUIColor range_color;
-		if (avRange > AVATAR_UNKNOWN_RANGE)
+		else if (avRange > AVATAR_UNKNOWN_RANGE && avRange <= chat_range_shout)
 		{
-			if (avRange <= chat_range_say)
-			{
-				range_color = colortable.getColor("AvatarListItemChatRange", LLColor4::red);
-				inChatRange++;
-			}
-			else if (avRange <= chat_range_shout)
-			{
-				range_color = colortable.getColor("AvatarListItemShoutRange", LLColor4::white);
-			}
-			else 
+			state.mRangeBucket = RowState::RANGE_SHOUT;
+		}
+		state.mDrawRadius = drawRadius;
+		state.mAge = avAge;
+		state.mPaymentInfo = avFlag;
+		if (voice_working)
+		{
+			LLSpeaker* speaker = speakermgr->findSpeaker(avId);
+			if (speaker && speaker->isInVoiceChannel())
 			{
-				range_color = colortable.getColor("AvatarListItemBeyondShoutRange", LLColor4::white);
+				state.mVoiceLevel = voice_client->getPowerLevel(avId);
 			}
 		}
-		else
+		if (isInSameRegion)
 		{
-			range_color = colortable.getColor("AvatarListItemBeyondShoutRange", LLColor4::white);
+			state.mFlags |= RowState::IN_REGION;
+		}
+		if (isOnSameParcel)
+		{
+			state.mFlags |= RowState::ON_PARCEL;
+		}
+		if (avVo && avVo->isTyping())
+		{
+			state.mFlags |= RowState::TYPING;
+		}
+		if (avVo && (avVo->getParent() || avVo->isMotionActive(ANIM_AGENT_SIT_GROUND) || avVo->isMotionActive(ANIM_AGENT_SIT_GROUND_CONSTRAINED)))
+		{
+			state.mFlags |= RowState::SITTING;
 		}
-		entry_options["range_color"] = range_color.get().getValue();
-
 		// Check if avatar is in draw distance and a VOAvatar instance actually exists
 		if (avRange <= drawRadius && avRange > AVATAR_UNKNOWN_RANGE && avVo)
 		{
-			entry_options["range_style"] = LLFontGL::BOLD;
+			state.mFlags |= RowState::IN_DRAW_RANGE;
 		}
-		else
+		if (is_muted)
 		{
-			entry_options["range_style"] = LLFontGL::NORMAL;
+			state.mFlags |= RowState::MUTED;
 		}
-
-		// Set friends colors / styles
-		LLFontGL::StyleFlags nameCellStyle = LLFontGL::NORMAL;
-		const LLRelationship* relation = avatartracker.getBuddyInfo(avId);
-		if (relation && !sFSLegacyRadarFriendColoring && !gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES))
+		if (avatartracker.getBuddyInfo(avId))
 		{
-			nameCellStyle = (LLFontGL::StyleFlags)(nameCellStyle | LLFontGL::BOLD);
+			state.mFlags |= RowState::FRIEND;
 		}
-		if (is_muted)
+		if (ent->hasAlertAge())
 		{
-			nameCellStyle = (LLFontGL::StyleFlags)(nameCellStyle | LLFontGL::ITALIC);
+			state.mFlags |= RowState::AGE_ALERT;
+		}
+		if (hide_names)
+		{
+			state.mFlags |= RowState::HIDE_NAMES;
+		}
+		if (sFSLegacyRadarFriendColoring)
+		{
+			state.mFlags |= RowState::LEGACY_FRIEND_COLORS;
+		}
+		if (sFSRadarColorNamesByDistance)
+		{
+			state.mFlags |= RowState::NAME_COLOR_BY_RANGE;
 		}
-		entry_options["name_style"] = nameCellStyle;
-
-		LLColor4 name_color = colortable.getColor("AvatarListItemIconDefaultColor", LLColor4::white).get();
-		name_color = contactsets->colorize(avId, (sFSRadarColorNamesByDistance ? range_color.get() : name_color), LGG_CS_RADAR);
-
-		contactsets->hasFriendColorThatShouldShow(avId, LGG_CS_RADAR, name_color);
-
-		entry_options["name_color"] = name_color.getValue();
 
-		// Voice power level indicator
-		if (voice_client->voiceEnabled() && voice_client->isVoiceWorking())
+		radar_row_map_t::iterator row_it = mRadarRows.find(avId);
+		bool is_new_row = (row_it == mRadarRows.end());
+		if (is_new_row)
 		{
-			LLSpeaker* speaker = speakermgr->findSpeaker(avId);
-			if (speaker && speaker->isInVoiceChannel())
+			row_it = mRadarRows.insert(std::make_pair(avId, RadarRow())).first;
+		}
+		RadarRow& row = row_it->second;
+		row.mSweep = mSweep;
+		if (is_new_row || mRowsDirty || row.mState != state || row.mName != avName || row.mNotes != ent->getNotes())
+		{
+			row.mState = state;
+			row.mName = avName;
+			row.mNotes = ent->getNotes();
+			// Listeners may still hold the old row, so it is replaced rather than changed
+			row.mData = buildRowData(ent, state);
+			if (is_new_row)
 			{
-				EVoicePowerLevel power_level = voice_client->getPowerLevel(avId);
-			
-				switch (power_level)
-				{
-					case VPL_PTT_Off:
-						entry["voice_level_icon"] = "Radar_VoicePTT_Off";
-						break;
-					case VPL_PTT_On:
-						entry["voice_level_icon"] = "Radar_VoicePTT_On";
-						break;
-					case VPL_Level1:
-						entry["voice_level_icon"] = "Radar_VoicePTT_Lvl1";
-						break;
-					case VPL_Level2:
-						entry["voice_level_icon"] = "Radar_VoicePTT_Lvl2";
-						break;
-					case VPL_Level3:
-						entry["voice_level_icon"] = "Radar_VoicePTT_Lvl3";
-						break;
-					default:
-						break;
-				}
+				mRowChanges.mInserted.push_back(row.mData);
+			}
+			else
+			{
+				mRowChanges.mUpdated.push_back(row.mData);
 			}
 		}
-
-		// Save data for our listeners
-		LLSD entry_data;
-		entry_data["entry"] = entry;
-		entry_data["options"] = entry_options;
-		mRadarEntriesData.push_back(entry_data);
 	} // End STEP 2, all model/presentation row processing complete.
 
+	// Drop the rows of avatars that left or aren't listed any more
+	for (radar_row_map_t::iterator row_it = mRadarRows.begin(); row_it != mRadarRows.end(); )
+	{
+		if (row_it->second.mSweep != mSweep)
+		{
+			mRowChanges.mRemoved.push_back(row_it->first);
+			row_it = mRadarRows.erase(row_it);
+		}
+		else
+		{
+			++row_it;
+		}
+	}
+	mRowsDirty = false;
+
 	//
 	//STEP 3, process any bulk actions that require the whole model to be known first
 	//
@@ -797,7 +820,7 @@ void FSRadar::updateRadarList()
 	//
 
 	mLastRadarSweep.clear();
-	em_it_end = mEntryList.end();
+	entry_map_t::iterator em_it_end = mEntryList.end();
 	for (entry_map_t::iterator em_it = mEntryList.begin(); em_it != em_it_end; ++em_it)
 	{
 		FSRadarEntry* ent = em_it->second;
@@ -838,8 +861,121 @@ void FSRadar::updateRadarList()
 	// Inform our subscribers about updates
 	if (!mUpdateSignal.empty())
 	{
-		mUpdateSignal(mRadarEntriesData, mAvatarStats);
+		mUpdateSignal(mRowChanges, mAvatarStats);
 	}
+
+	LLTrace::record(sRadarRowsChanged, (F64)(mRowChanges.mInserted.size() + mRowChanges.mUpdated.size() + mRowChanges.mRemoved.size()));
+	LLTrace::record(sRadarUpdateTime, F64Seconds(update_timer.getElapsedTimeF64()));
+}
+
+LLSD FSRadar::buildRowData(const FSRadarEntry* ent, const RowState& state) const
+{
+	LLUIColorTable& colortable = LLUIColorTable::instance();
+	LGGContactSets* contactsets = LGGContactSets::getInstance();
+	const LLUUID& avId = ent->mID;
+	bool hide_names = (state.mFlags & RowState::HIDE_NAMES);
+
+	LLSD entry;
+	LLSD entry_options;
+
+	entry["id"] = avId;
+	entry["name"] = ent->mName;
+	entry["in_region"] = (bool)(state.mFlags & RowState::IN_REGION);
+	entry["on_parcel"] = (bool)(state.mFlags & RowState::ON_PARCEL);
+	entry["flags"] = (S32)state.mPaymentInfo;
+	entry["first_seen"] = LLDate((F64)ent->mFirstSeen);
+	entry["range"] = (ent->mRange > AVATAR_UNKNOWN_RANGE ? llformat("%3.2f", ent->mRange) : llformat(">%3.2f", state.mDrawRadius));
+	entry["typing"] = (bool)(state.mFlags & RowState::TYPING);
+	entry["sitting"] = (bool)(state.mFlags & RowState::SITTING);
+
+	if (!hide_names)
+	{
+		entry["notes"] = ent->getNotes();
+		entry["age"] = (state.mAge > -1 ? llformat("%d", state.mAge) : "");
+		if (state.mFlags & RowState::AGE_ALERT)
+		{
+			entry_options["age_color"] = colortable.getColor("AvatarListItemAgeAlert", LLColor4::red).get().getValue();
+		}
+	}
+	else
+	{
+		entry["notes"] = LLStringUtil::null;
+		entry["age"] = "---";
+	}
+
+	//AO: Set any range colors / styles
+	LLUIColor range_color;
+	switch (state.mRangeBucket)
+	{
+		case RowState::RANGE_CHAT:
+			range_color = colortable.getColor("AvatarListItemChatRange", LLColor4::red);
+			break;
+		case RowState::RANGE_SHOUT:
+			range_color = colortable.getColor("AvatarListItemShoutRange", LLColor4::white);
+			break;
+		default:
+			range_color = colortable.getColor("AvatarListItemBeyondShoutRange", LLColor4::white);
+			break;
+	}
+	entry_options["range_color"] = range_color.get().getValue();
+	entry_options["range_style"] = (state.mFlags & RowState::IN_DRAW_RANGE) ? LLFontGL::BOLD : LLFontGL::NORMAL;
+
+	// Set friends colors / styles
+	LLFontGL::StyleFlags nameCellStyle = LLFontGL::NORMAL;
+	if ((state.mFlags & RowState::FRIEND) && !(state.mFlags & RowState::LEGACY_FRIEND_COLORS) && !hide_names)
+	{
+		nameCellStyle = (LLFontGL::StyleFlags)(nameCellStyle | LLFontGL::BOLD);
+	}
+	if (state.mFlags & RowState::MUTED)
+	{
+		nameCellStyle = (LLFontGL::StyleFlags)(nameCellStyle | LLFontGL::ITALIC);
+	}
+	entry_options["name_style"] = nameCellStyle;
+
+	LLColor4 name_color = colortable.getColor("AvatarListItemIconDefaultColor", LLColor4::white).get();
+	name_color = contactsets->colorize(avId, ((state.mFlags & RowState::NAME_COLOR_BY_RANGE) ? range_color.get() : name_color), LGG_CS_RADAR);
+
+	contactsets->hasFriendColorThatShouldShow(avId, LGG_CS_RADAR, name_color);
+
+	entry_options["name_color"] = name_color.getValue();
+
+	// Voice power level indicator
+	switch (state.mVoiceLevel)
+	{
+		case VPL_PTT_Off:
+			entry["voice_level_icon"] = "Radar_VoicePTT_Off";
+			break;
+		case VPL_PTT_On:
+			entry["voice_level_icon"] = "Radar_VoicePTT_On";
+			break;
+		case VPL_Level1:
+			entry["voice_level_icon"] = "Radar_VoicePTT_Lvl1";
+			break;
+		case VPL_Level2:
+			entry["voice_level_icon"] = "Radar_VoicePTT_Lvl2";
+			break;
+		case VPL_Level3:
+			entry["voice_level_icon"] = "Radar_VoicePTT_Lvl3";
+			break;
+		default:
+			break;
+	}
+
+	LLSD entry_data;
+	entry_data["entry"] = entry;
+	entry_data["options"] = entry_options;
+	return entry_data;
+}
+
+void FSRadar::getCurrentData(std::vector<LLSD>& entries, LLSD& stats) const
+{
+	entries.clear();
+	entries.reserve(mRadarRows.size());
+	for (radar_row_map_t::const_iterator it = mRadarRows.begin(); it != mRadarRows.end(); ++it)
+	{
+		entries.push_back(it->second.mData);
+	}
+	stats = mAvatarStats;
 }
 
 void FSRadar::requestRadarChannelAlertSync()
@@ -1058,6 +1194,11 @@ void FSRadar::updateName(const LLUUID& avatar_id)
 	}
 }
 
+void FSRadar::onContactSetChanged()
+{
+	mRowsDirty = true;
+}
+
 void FSRadar::updateAgeAlertCheck()
 {
 	const entry_map_t::iterator it_end = mEntryList.end();
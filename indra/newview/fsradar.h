@@ -78,7 +78,7 @@ public:
 	static void	onRadarReportToClicked(const LLSD& userdata);
 	static bool	radarReportToCheck(const LLSD& userdata);
 
-	void getCurrentData(std::vector<LLSD>& entries, LLSD& stats) const { entries = mRadarEntriesData; stats = mAvatarStats; }
+	void getCurrentData(std::vector<LLSD>& entries, LLSD& stats) const;
 	FSRadarEntry* getEntry(const LLUUID& avatar_id);
 
 	// internals
@@ -102,7 +102,21 @@ public:
 		callback_t		mCallback;
 	};
 
-	typedef boost::signals2::signal<void(const std::vector<LLSD>& entries, const LLSD& stats)> radar_update_callback_t;
+	// Rows that appeared, changed or went away during one update. Rows hold
+	// "entry" and "options" maps, the same as getCurrentData() hands out.
+	// Rows carry "first_seen" instead of a seen time, so a listener can keep
+	// that column current without the row being sent again.
+	struct RowChanges
+	{
+		std::vector<LLSD>	mInserted;
+		std::vector<LLSD>	mUpdated;
+		uuid_vec_t			mRemoved;
+
+		bool empty() const { return mInserted.empty() && mUpdated.empty() && mRemoved.empty(); }
+		void clear() { mInserted.clear(); mUpdated.clear(); mRemoved.clear(); }
+	};
+
+	typedef boost::signals2::signal<void(const RowChanges& changes, const LLSD& stats)> radar_update_callback_t;
 	boost::signals2::connection setUpdateCallback(const radar_update_callback_t::slot_type& cb)
 	{
 		return mUpdateSignal.connect(cb);
@@ -114,8 +128,59 @@ private:
 	void					checkTracking();
 	void					radarAlertMsg(const LLUUID& agent_id, const LLAvatarName& av_name, const std::string& postMsg);
 	void					updateAgeAlertCheck();
+	void					onContactSetChanged();
 
 	Updater*				mRadarListUpdater;
+
+	// Everything a list row is made from, so an unchanged avatar can be
+	// told apart without looking up colours or building LLSD.
+	struct RowState
+	{
+		enum
+		{
+			IN_REGION		= 1 << 0,
+			ON_PARCEL		= 1 << 1,
+			TYPING			= 1 << 2,
+			SITTING			= 1 << 3,
+			IN_DRAW_RANGE	= 1 << 4,
+			MUTED			= 1 << 5,
+			FRIEND			= 1 << 6,
+			AGE_ALERT		= 1 << 7,
+			HIDE_NAMES		= 1 << 8,
+			LEGACY_FRIEND_COLORS	= 1 << 9,
+			NAME_COLOR_BY_RANGE		= 1 << 10
+		};
+
+		enum ERangeBucket
+		{
+			RANGE_CHAT,
+			RANGE_SHOUT,
+			RANGE_BEYOND_SHOUT
+		};
+
+		RowState();
+		bool operator==(const RowState& other) const;
+		bool operator!=(const RowState& other) const { return !(*this == other); }
+
+		S32			mRange;			// centimetres, so the shown range text changes with it
+		S32			mRangeBucket;
+		F32			mDrawRadius;
+		S32			mVoiceLevel;	// EVoicePowerLevel, or -1 when not in voice
+		S32			mAge;
+		U32			mPaymentInfo;
+		U32			mFlags;
+	};
+
+	struct RadarRow
+	{
+		RowState	mState;
+		std::string	mName;
+		std::string	mNotes;
+		LLSD		mData;
+		U32			mSweep;			// last update that listed this row
+	};
+
+	LLSD					buildRowData(const FSRadarEntry* ent, const RowState& state) const;
 	
 	struct RadarFields 
 	{
@@ -131,7 +196,12 @@ private:
 	uuid_vec_t				mRadarEnterAlerts;
 	uuid_vec_t				mRadarLeaveAlerts;
 	uuid_vec_t				mRadarOffsetRequests;
-	std::vector<LLSD>		mRadarEntriesData;
+
+	typedef boost::unordered_map<LLUUID, RadarRow, FSUUIDHash> radar_row_map_t;
+	radar_row_map_t			mRadarRows;
+	RowChanges				mRowChanges;
+	U32						mSweep;
+	bool					mRowsDirty;
 	 	
 	S32						mRadarFrameCount;
 	bool					mRadarAlertRequest;
@@ -146,6 +216,7 @@ private:
 	boost::signals2::connection mShowUsernamesCallbackConnection;
 	boost::signals2::connection mNameFormatCallbackConnection;
 	boost::signals2::connection mAgeAlertCallbackConnection;
+	boost::signals2::connection mContactSetChangedConnection;
 };
 
 #endif // FS_RADAR_H
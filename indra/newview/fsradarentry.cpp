@@ -51,6 +51,7 @@ FSRadarEntry::FSRadarEntry(const LLUUID& avid)
 	mNotes(LLStringUtil::null),
 	mAlertAge(false),
 	mAgeAlertPerformed(false),
+	mSweep(0),
 	mAvatarNameCallbackConnection()
 {
 	if (mID.notNull())
@@ -85,6 +85,7 @@ private:
 	bool		mIgnore;
 	bool		mAlertAge;
 	bool		mAgeAlertPerformed;
+	U32			mSweep;			// last radar update that saw this avatar
 
 	LLAvatarNameCache::callback_connection_t mAvatarNameCallbackConnection;
 };
@@ -432,6 +432,7 @@ void AISAPI::InvokeAISCommandCoro(LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t ht
     LLCore::HttpHeaders::ptr_t httpHeaders;
 
     httpOptions->setTimeout(LLCoreHttpUtil::HTTP_REQUEST_EXPIRY_SECS);
+    httpAdapter->setParseOffMainThread(gSavedSettings.getBOOL("HttpParseLLSDOffMainThread"));
 
     LL_DEBUGS("Inventory") << "url: " << url << LL_ENDL;
 
@@ -353,6 +353,9 @@ void LLAppCoreHttp::cleanup()
 {
     LLCore::HTTPStats::instance().dumpStats();
 
+	// <FS/> Off main thread LLSD decoding
+	LLCoreHttpUtil::cleanupLLSDParseThread();
+
 	if (LLCORE_HTTP_HANDLE_INVALID == mStopHandle)
 	{
 		// Should have been started already...
@@ -287,6 +287,7 @@
 
 #include "fstelemetry.h" // <FS:Beq> Tracy profiler support
 #include "fsperfstats.h" // <FS:Beq> performance stats support
+#include "llparallelfor.h" // <FS/> Shared frame worker pool
 
 #if LL_LINUX && LL_GTK
 #include "glib.h"
@@ -1133,6 +1134,8 @@ bool LLAppViewer::init()
 	// Modify settings based on system configuration and compile options
 	settings_modify();
 
+	LLParallelFor::setSharedWorkerCount(gSavedSettings.getS32("FrameWorkerThreads")); // <FS/> Shared frame worker pool
+
 	// Find partition serial number (Windows) or hardware serial (Mac)
 	mSerialNumber = generateSerialNumber();
 
@@ -2301,6 +2304,9 @@ bool LLAppViewer::cleanup()
 
 	LLViewerObject::cleanupVOClasses();
 
+	SUBSYSTEM_CLEANUP(LLSurface); // <FS/> Parallel terrain patch update
+	LLParallelFor::setSharedWorkerCount(0); // <FS/> Shared frame worker pool
+
 	SUBSYSTEM_CLEANUP(LLAvatarAppearance);
 
 	SUBSYSTEM_CLEANUP(LLPostProcess);
@@ -5385,7 +5391,21 @@ void LLAppViewer::loadNameCache()
 	std::string filename =
 		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
 	LL_INFOS("AvNameCache") << filename << LL_ENDL;
-	llifstream name_cache_stream(filename.c_str());
+	// <FS> Binary avatar name cache
+	std::string binary_filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+	bool binary_loaded = LLAvatarNameCache::getInstance()->importBinaryFile(binary_filename);
+	if (!binary_loaded && LLFile::isfile(binary_filename))
+	{
+		LL_WARNS("AppInit") << "removing invalid '" << binary_filename << "'" << LL_ENDL;
+		LLFile::remove(binary_filename);
+	}
+	llifstream name_cache_stream;
+	if (!binary_loaded)
+	{
+		name_cache_stream.open(filename.c_str());
+	}
+	// </FS>
+	//llifstream name_cache_stream(filename.c_str()); // <FS/> Binary avatar name cache
 	if(name_cache_stream.is_open())
 	{
 		if ( ! LLAvatarNameCache::getInstance()->importFile(name_cache_stream))
@@ -5412,11 +5432,30 @@ void LLAppViewer::saveNameCache()
 	// display names cache
 	std::string filename =
 		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
-	llofstream name_cache_stream(filename.c_str());
-	if(name_cache_stream.is_open())
+	// <FS> Binary avatar name cache
+	std::string binary_filename = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.bin");
+	if (gSavedSettings.getBOOL("AvatarNameCacheBinary")
+		&& LLAvatarNameCache::getInstance()->exportBinaryFile(binary_filename))
 	{
-		LLAvatarNameCache::getInstance()->exportFile(name_cache_stream);
-    }
+		// Only one cache may exist, or a stale one gets loaded after
+		// switching formats back.
+		LLFile::remove(filename, ENOENT);
+	}
+	else
+	{
+		LLFile::remove(binary_filename, ENOENT);
+		llofstream name_cache_stream(filename.c_str());
+		if (name_cache_stream.is_open())
+		{
+			LLAvatarNameCache::getInstance()->exportFile(name_cache_stream);
+		}
+	}
+	//llofstream name_cache_stream(filename.c_str());
+	//if(name_cache_stream.is_open())
+	//{
+	//	LLAvatarNameCache::getInstance()->exportFile(name_cache_stream);
+	//}
+	// </FS>
 
     // real names cache
 	if (gCacheName)
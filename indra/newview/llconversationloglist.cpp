@@ -30,6 +30,7 @@
 #include "llfloaterreg.h"
 #include "llfloaterconversationpreview.h"
 #include "llgroupactions.h"
+#include "lllogchat.h" // <FS/> Indexed transcripts
 #include "llconversationloglist.h"
 #include "llconversationloglistitem.h"
 #include "llviewermenu.h"
@@ -43,12 +44,16 @@
 
 static LLDefaultChildRegistry::Register<LLConversationLogList> r("conversation_log_list");
 
+// <FS/> Indexed transcripts: shorter filter text only matches names and dates
+static const size_t MIN_TRANSCRIPT_FILTER_LENGTH = 3;
+
 static LLConversationLogListNameComparator NAME_COMPARATOR;
 static LLConversationLogListDateComparator DATE_COMPARATOR;
 
 LLConversationLogList::LLConversationLogList(const Params& p)
 :	LLFlatListViewEx(p),
-	mIsDirty(true)
+	mIsDirty(true),
+	mTranscriptSearch(0) // <FS/> Indexed transcripts
 {
 	LLConversationLog::instance().addObserver(this);
 
@@ -85,6 +90,15 @@ LLConversationLogList::~LLConversationLogList()
 
 void LLConversationLogList::draw()
 {
+	// <FS> Indexed transcripts
+	std::set<std::string> matches;
+	if (mTranscriptSearch && LLLogChat::instance().getTranscriptSearchResult(mTranscriptSearch, matches))
+	{
+		mTranscriptMatches.insert(matches.begin(), matches.end());
+		mTranscriptSearch = 0;
+		mIsDirty = true;
+	}
+	// </FS>
 	if (mIsDirty)
 	{
 		refresh();
@@ -211,18 +225,59 @@ void LLConversationLogList::rebuildList()
 	bool have_filter = !mNameFilter.empty();
 	LLConversationLog &log_instance = LLConversationLog::instance();
 
+	// <FS> Indexed transcripts: conversations that talked about the filter
+	// text match too.  Their transcripts are searched on a worker thread and
+	// the list is built again when the result is in.  A transcript is
+	// searched once per filter text: conversations added to the log later
+	// only have their own transcripts searched.
+	bool search_transcripts = mNameFilter.length() >= MIN_TRANSCRIPT_FILTER_LENGTH
+		&& gSavedSettings.getBOOL("FSIndexTranscriptWords");
+	if (!search_transcripts || mSearchedFilter != mNameFilter)
+	{
+		mTranscriptMatches.clear();
+		mSearchedFileNames.clear();
+		mTranscriptSearch = 0;
+		mSearchedFilter = search_transcripts ? mNameFilter : std::string();
+	}
+	std::vector<std::string> unsearched_file_names;
+	// </FS>
+
 	const std::vector<LLConversation>& conversations = log_instance.getConversations();
 	std::vector<LLConversation>::const_iterator iter = conversations.begin();
 
 	for (; iter != conversations.end(); ++iter)
 	{
 		bool not_found = have_filter && !findInsensitive(iter->getConversationName(), mNameFilter) && !findInsensitive(iter->getTimestamp(), mNameFilter);
+		// <FS> Indexed transcripts
+		if (not_found && search_transcripts)
+		{
+			std::string file_name = iter->getHistoryFileName();
+			if (LLIMModel::LLIMSession::GROUP_SESSION == iter->getConversationType() && !LLStringUtil::endsWith(file_name, GROUP_CHAT_SUFFIX))
+			{
+				file_name += GROUP_CHAT_SUFFIX;
+			}
+			not_found = !mTranscriptMatches.count(file_name);
+			if (!mSearchedFileNames.count(file_name))
+			{
+				unsearched_file_names.push_back(file_name);
+			}
+		}
+		// </FS>
 		if (not_found)
 			continue;
 
 		addNewItem(&*iter);
 	}
 
+	// <FS> Indexed transcripts: a running search is let finish, the rest
+	// is searched once its result is in
+	if (!mTranscriptSearch && !unsearched_file_names.empty())
+	{
+		mTranscriptSearch = LLLogChat::instance().searchTranscripts(unsearched_file_names, mNameFilter);
+		mSearchedFileNames.insert(unsearched_file_names.begin(), unsearched_file_names.end());
+	}
+	// </FS>
+
 	// try to restore selection of item
 	if (NULL != selected_conversationp)
 	{
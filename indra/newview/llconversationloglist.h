@@ -104,6 +104,13 @@ private:
 	bool mIsDirty;
 	bool mIsFriendsOnTop;
 	std::string mNameFilter;
+
+	// <FS> Indexed transcripts
+	std::string mSearchedFilter;					// filter the transcripts were last searched for
+	U32 mTranscriptSearch;							// search still running, 0 if none
+	std::set<std::string> mTranscriptMatches;		// transcript file names that matched
+	std::set<std::string> mSearchedFileNames;		// transcripts searched, or being searched, for mSearchedFilter
+	// </FS>
 };
 
 /**
@@ -101,10 +101,7 @@ void LLDrawable::incrementVisible()
 LLDrawable::LLDrawable(LLViewerObject *vobj, bool new_entry)
 :	LLViewerOctreeEntryData(LLViewerOctreeEntry::LLDRAWABLE),
 	LLTrace::MemTrackable<LLDrawable, 16>("LLDrawable"),
-	mVObjp(vobj),
-	mSkinningMatCache(nullptr),
-	mLastSkinningMatCacheFrame(0),
-	mCacheSize(0)
+	mVObjp(vobj)
 {
 	init(new_entry); 
 }
@@ -210,13 +207,6 @@ void LLDrawable::destroy()
 	std::for_each(mFaces.begin(), mFaces.end(), DeletePointer());
 	mFaces.clear();
 
-	// <FS:Beq> close up potential memory leak
-	if (mSkinningMatCache)
-	{
-		ll_aligned_free_16(mSkinningMatCache);
-	}
-	// </FS:Beq>
-
 	/*if (!(sNumZombieDrawables % 10))
 	{
 		LL_INFOS() << "- Zombie drawables: " << sNumZombieDrawables << LL_ENDL;
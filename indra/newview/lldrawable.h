@@ -66,9 +66,7 @@ class LLDrawable
 public:
 	LLDrawable(const LLDrawable& rhs) 
 	:	LLTrace::MemTrackable<LLDrawable, 16>("LLDrawable"),
-		LLViewerOctreeEntryData(rhs),
-		mLastSkinningMatCacheFrame(0),
-		mCacheSize(0)
+		LLViewerOctreeEntryData(rhs)
 	{
 		*this = rhs;
 	}
@@ -81,12 +79,6 @@ public:
 
 	static void initClass();
 
-	//<FS:Beq>	per frame matrix cache
-	LL_ALIGN_16(LLMatrix4a* mSkinningMatCache);
-	U32 mLastSkinningMatCacheFrame;
-	U32 mCacheSize;
-	//</FS:Beq>
-
 	LLDrawable(LLViewerObject *vobj, bool new_entry = false);
 	
 	void markDead();			// Mark this drawable as dead
@@ -2229,33 +2229,10 @@ void LLDrawPoolAvatar::updateRiggedFaceVertexBuffer(
 LLMatrix4a* LLDrawPoolAvatar::getCacheSkinningMats(LLDrawable* drawable, const LLMeshSkinInfo* skin,
                                                    U32 count, LLVOAvatar* avatar)
 {
-	if (drawable->mCacheSize < count || !drawable->mSkinningMatCache)
-	{
-//		delete[](drawable->mSkinningMatCache);
-		if (drawable->mSkinningMatCache)
-		{
-			ll_aligned_free_16(drawable->mSkinningMatCache);
-		}
-		drawable->mCacheSize = count;
-//		drawable->mSkinningMatCache = new LLMatrix4a[count];
-		drawable->mSkinningMatCache = (LLMatrix4a*)ll_aligned_malloc_16(sizeof(LLMatrix4a)*count);
-	}
-	
-	static LLCachedControl<bool> disableMatCache(gSavedSettings, "FSDisableRiggedMeshMatrixCaching"); // <FS:Beq> FIRE-23331 - disable matrix caching during appearance update due to weird side effects
-	if (disableMatCache ||
-		(avatar->isSelf() && avatar->isEditingAppearance()) ||
-		(drawable->mSkinningMatCache && LLFrameTimer::getFrameCount() != drawable->mLastSkinningMatCacheFrame))
-	{
-//		LL_DEBUGS("Skinning") << "Call InitSkinningMatrixPalette for drawable @" << (U64)drawable << LL_ENDL;
-		//<FS:Beq> add caching of matrix pallette as high up the stack as we can
-		drawable->mLastSkinningMatCacheFrame = LLFrameTimer::getFrameCount();
-		LLSkinningUtil::initSkinningMatrixPalette(drawable->mSkinningMatCache, count, skin, avatar);
-	}
-	else
-	{
-//		LL_DEBUGS("Skinning") << "Avoiding InitSkinningMatrixPalette for drawable @" << (U64)drawable << LL_ENDL;
-	}
-	return drawable->mSkinningMatCache;
+	// <FS> Shared skinning palettes: the avatar keeps one palette per frame
+	// for all rigged meshes with the same skin, instead of one per drawable
+	return avatar->getSkinningMatrixPalette(skin, count);
+	// </FS>
 }
 //</FS:Beq>
 
@@ -32,6 +32,7 @@
 
 #include "llsdserialize.h"
 #include "lleventtimer.h"
+#include "llviewercontrol.h"
 #include "llviewerregion.h"
 #include "message.h"
 #include "lltrans.h"
@@ -163,6 +164,7 @@ namespace Details
     void LLEventPollImpl::eventPollCoro(std::string url)
     {
         LLCoreHttpUtil::HttpCoroutineAdapter::ptr_t httpAdapter(new LLCoreHttpUtil::HttpCoroutineAdapter("EventPoller", mHttpPolicy));
+        httpAdapter->setParseOffMainThread(gSavedSettings.getBOOL("HttpParseLLSDOffMainThread"));
         LLSD acknowledge;
         int errorCount = 0;
         int counter = mCounter; // saved on the stack for logging. 
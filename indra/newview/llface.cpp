@@ -1423,11 +1423,95 @@ static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_NO_XFORM("No Xform");
 static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_XFORM("Xform");
 static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_PLANAR("Quick Planar");
 
+// <FS> Parallel geometry fill
+// Same as the LLVertexBuffer::getXXXStrider() calls for this face's range,
+// except that when the range was already mapped by mapGeometryVolume() it is
+// only pointer arithmetic and makes no GL calls.
+template <class T>
+bool LLFace::getGeometryStrider(LLStrider<T>& strider, S32 type, bool map_range, bool premapped)
+{
+	volatile U8* ptr = NULL;
+	if (type == LLVertexBuffer::TYPE_INDEX)
+	{
+		if (!premapped)
+		{
+			ptr = mVertexBuffer->mapIndexBuffer(mIndicesIndex, mIndicesCount, map_range);
+		}
+		else if (mVertexBuffer->getMappedIndices())
+		{
+			ptr = mVertexBuffer->getMappedIndices() + sizeof(U16) * mIndicesIndex;
+		}
+		strider = (T*) ptr;
+		strider.setStride(0);
+	}
+	else if (mVertexBuffer->hasDataType(type))
+	{
+		if (!premapped)
+		{
+			ptr = mVertexBuffer->mapVertexBuffer(type, mGeomIndex, mGeomCount, map_range);
+		}
+		else if (mVertexBuffer->getMappedData())
+		{
+			ptr = mVertexBuffer->getMappedData() + mVertexBuffer->getOffset(type) + LLVertexBuffer::sTypeSize[type] * mGeomIndex;
+		}
+		strider = (T*) ptr;
+		strider.setStride(LLVertexBuffer::sTypeSize[type]);
+	}
+	else
+	{
+		LL_ERRS() << "Face vertex buffer has no data of type " << type << LL_ENDL;
+	}
+
+	if (ptr == NULL)
+	{
+		LL_WARNS() << "Mapping face geometry failed!" << LL_ENDL;
+		return false;
+	}
+	return true;
+}
+
+bool LLFace::mapGeometryVolume(S32 f)
+{
+	if (mVertexBuffer.isNull())
+	{
+		return false;
+	}
+
+	// texture indices live in the w of the positions
+	for (S32 type = 0; type < LLVertexBuffer::TYPE_TEXTURE_INDEX; ++type)
+	{
+		if (mVertexBuffer->hasDataType(type) &&
+			!mVertexBuffer->mapVertexBuffer(type, mGeomIndex, mGeomCount, false))
+		{
+			return false;
+		}
+	}
+	if (!mVertexBuffer->mapIndexBuffer(mIndicesIndex, mIndicesCount, false))
+	{
+		return false;
+	}
+
+	// Volumes are shared between objects, so two faces being filled at the
+	// same time may want tangents for the same volume face.  Create them
+	// here rather than racing in getGeometryVolume().
+	LLVolume* volume = mVObjp->getVolume();
+	const LLTextureEntry* tep = mVObjp->getTE(f);
+	if (volume && f < volume->getNumVolumeFaces() &&
+		(mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TANGENT) ||
+		 (tep && (tep->getBumpmap() || tep->getTexGen() != LLTextureEntry::TEX_GEN_DEFAULT))))
+	{
+		volume->genTangents(f);
+	}
+	return true;
+}
+// </FS>
+
 BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							   const S32 &f,
 								const LLMatrix4& mat_vert_in, const LLMatrix3& mat_norm_in,
 								const U16 &index_offset,
-								bool force_rebuild)
+								bool force_rebuild,
+								bool premapped)
 {
 	LL_RECORD_BLOCK_TIME(FTM_FACE_GET_GEOM);
 	llassert(verify());
@@ -1591,7 +1675,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 	if (full_rebuild)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_INDEX);
-		mVertexBuffer->getIndexStrider(indicesp, mIndicesIndex, mIndicesCount, map_range);
+		getGeometryStrider(indicesp, LLVertexBuffer::TYPE_INDEX, map_range, premapped);
 
 		volatile __m128i* dst = (__m128i*) indicesp.get();
 		__m128i* src = (__m128i*) vf.mIndices;
@@ -1666,6 +1750,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 #ifdef GL_TRANSFORM_FEEDBACK_BUFFER
 	if (use_transform_feedback &&
+		!premapped && // <FS/> Parallel geometry fill: feedback needs GL
 		mVertexBuffer->getUsage() == GL_DYNAMIC_COPY_ARB &&
 		gTransformPositionProgram.mProgramObject && //transform shaders are loaded
 		mVertexBuffer->useVBOs() && //target buffer is in VRAM
@@ -1944,7 +2029,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 			if (!do_bump)
 			{ //not bump mapped, might be able to do a cheap update
-				mVertexBuffer->getTexCoord0Strider(tex_coords0, mGeomIndex, mGeomCount);
+				getGeometryStrider(tex_coords0, LLVertexBuffer::TYPE_TEXCOORD0, false, premapped);
 
 				if (texgen != LLTextureEntry::TEX_GEN_PLANAR)
 				{
@@ -2080,12 +2165,12 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 					switch (ch)
 					{
 						case 0: 
-							mVertexBuffer->getTexCoord0Strider(dst, mGeomIndex, mGeomCount, map_range); 
+							getGeometryStrider(dst, LLVertexBuffer::TYPE_TEXCOORD0, map_range, premapped); 
 							break;
 						case 1:
 							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
 							{
-								mVertexBuffer->getTexCoord1Strider(dst, mGeomIndex, mGeomCount, map_range);
+								getGeometryStrider(dst, LLVertexBuffer::TYPE_TEXCOORD1, map_range, premapped);
 								if (mat && !tex_anim)
 								{
 									r  = mat->getNormalRotation();
@@ -2105,7 +2190,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 						case 2:
 							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2))
 							{
-								mVertexBuffer->getTexCoord2Strider(dst, mGeomIndex, mGeomCount, map_range);
+								getGeometryStrider(dst, LLVertexBuffer::TYPE_TEXCOORD2, map_range, premapped);
 								if (mat && !tex_anim)
 								{
 									r  = mat->getSpecularRotation();
@@ -2171,7 +2256,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 				if (!mat && do_bump)
 				{
-					mVertexBuffer->getTexCoord1Strider(tex_coords1, mGeomIndex, mGeomCount, map_range);
+					getGeometryStrider(tex_coords1, LLVertexBuffer::TYPE_TEXCOORD1, map_range, premapped);
 		
 					for (S32 i = 0; i < num_vertices; i++)
 					{
@@ -2227,7 +2312,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			//LL_RECORD_TIME_BLOCK(FTM_FACE_GEOM_POSITION);
 			llassert(num_vertices > 0);
 		
-			mVertexBuffer->getVertexStrider(vert, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(vert, LLVertexBuffer::TYPE_VERTEX, map_range, premapped);
 			
 			LLMatrix4a mat_vert;
 			mat_vert.loadu(mat_vert_in);
@@ -2320,7 +2405,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		if (rebuild_normal)
 		{
 			//LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_NORMAL);
-			mVertexBuffer->getNormalStrider(norm, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(norm, LLVertexBuffer::TYPE_NORMAL, map_range, premapped);
 			F32* normals = (F32*) norm.get();
 			LLVector4a* src = vf.mNormals;
 			LLVector4a* end = src+num_vertices;
@@ -2342,7 +2427,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		if (rebuild_tangent)
 		{
 			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_TANGENT);
-			mVertexBuffer->getTangentStrider(tangent, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(tangent, LLVertexBuffer::TYPE_TANGENT, map_range, premapped);
 			F32* tangents = (F32*) tangent.get();
 			
 			mVObjp->getVolume()->genTangents(f);
@@ -2378,7 +2463,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		if (rebuild_weights && vf.mWeights)
 		{
 			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_WEIGHTS);
-			mVertexBuffer->getWeight4Strider(wght, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(wght, LLVertexBuffer::TYPE_WEIGHT4, map_range, premapped);
 			// <FS:Ansariel> Vectorized Weight4Strider and ClothWeightStrider by Drake Arconis
 			//F32* weights = (F32*) wght.get();
 			//LLVector4a::memcpyNonAliased16(weights, (F32*) vf.mWeights, num_vertices*4*sizeof(F32));
@@ -2396,7 +2481,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		if (rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_COLOR) )
 		{
 			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_COLOR);
-			mVertexBuffer->getColorStrider(colors, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(colors, LLVertexBuffer::TYPE_COLOR, map_range, premapped);
 
 			LLVector4a src;
 
@@ -2428,7 +2513,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		{
 			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_EMISSIVE);
 			LLStrider<LLColor4U> emissive;
-			mVertexBuffer->getEmissiveStrider(emissive, mGeomIndex, mGeomCount, map_range);
+			getGeometryStrider(emissive, LLVertexBuffer::TYPE_EMISSIVE, map_range, premapped);
 
 			U8 glow = (U8) llclamp((S32) (getTextureEntry()->getGlow()*255), 0, 255);
 
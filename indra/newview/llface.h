@@ -163,11 +163,26 @@ public:
 	//for volumes
 	void updateRebuildFlags();
 	bool canRenderAsMask(); // logic helper
+	// <FS> Parallel geometry fill
+	//BOOL getGeometryVolume(const LLVolume& volume,
+	//					const S32 &f,
+	//					const LLMatrix4& mat_vert, const LLMatrix3& mat_normal,
+	//					const U16 &index_offset,
+	//					bool force_rebuild = false);
+	// premapped means mapGeometryVolume() was called for this face first,
+	// which makes the call safe on a worker thread
 	BOOL getGeometryVolume(const LLVolume& volume,
 						const S32 &f,
 						const LLMatrix4& mat_vert, const LLMatrix3& mat_normal,
 						const U16 &index_offset,
-						bool force_rebuild = false);
+						bool force_rebuild = false,
+						bool premapped = false);
+
+	// Maps this face's range of its vertex buffer and creates anything
+	// getGeometryVolume() would otherwise create on demand.  Main thread only.
+	// Returns false if the buffer could not be mapped.
+	bool mapGeometryVolume(S32 f);
+	// </FS>
 
 	// For avatar
 	U16			 getGeometryAvatar(
@@ -249,6 +264,9 @@ public: //aligned members
 	LLVector4a		mExtents[2];
 
 private:
+	template <class T>
+	bool getGeometryStrider(LLStrider<T>& strider, S32 type, bool map_range, bool premapped); // <FS/> Parallel geometry fill
+
 	F32         adjustPartialOverlapPixelArea(F32 cos_angle_to_view_dir, F32 radius );
 	BOOL        calcPixelArea(F32& cos_angle_to_view_dir, F32& radius) ;
 public:
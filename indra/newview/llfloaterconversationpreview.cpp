@@ -36,6 +36,7 @@
 // </FS:CR> [FS communication UI]
 #include "llspinctrl.h"
 #include "lltrans.h"
+#include "lltranscriptindex.h" // <FS/> Indexed transcripts
 #include "llnotificationsutil.h"
 
 // <FS:CR>
@@ -61,6 +62,7 @@ LLFloaterConversationPreview::LLFloaterConversationPreview(const LLSD& session_i
 	mMutex(),
 	mShowHistory(false),
 	mMessages(NULL),
+	mTranscriptIndex(NULL), // <FS/> Indexed transcripts
 	mHistoryThreadsBusy(false),
 	mIsGroup(false),
 	mOpened(false)
@@ -69,6 +71,7 @@ LLFloaterConversationPreview::LLFloaterConversationPreview(const LLSD& session_i
 
 LLFloaterConversationPreview::~LLFloaterConversationPreview()
 {
+	delete mTranscriptIndex; // <FS/> Indexed transcripts
 }
 
 BOOL LLFloaterConversationPreview::postBuild()
@@ -131,15 +134,18 @@ void LLFloaterConversationPreview::setPages(std::list<LLSD>* messages, const std
 			delete mMessages; // Clean up temporary message list with "Loading..." text
 		}
 		mMessages = messages;
-		mCurrentPage = (mMessages->size() ? (mMessages->size() - 1) / mPageSize : 0);
-
-		mPageSpinner->setEnabled(true);
-		mPageSpinner->setMaxValue(mCurrentPage+1);
-		mPageSpinner->set(mCurrentPage+1);
-
-		std::string total_page_num = llformat("/ %d", mCurrentPage+1);
-		getChild<LLTextBox>("page_num_label")->setValue(total_page_num);
-		mShowHistory = true;
+		// <FS> Indexed transcripts
+		//mCurrentPage = (mMessages->size() ? (mMessages->size() - 1) / mPageSize : 0);
+		//
+		//mPageSpinner->setEnabled(true);
+		//mPageSpinner->setMaxValue(mCurrentPage+1);
+		//mPageSpinner->set(mCurrentPage+1);
+		//
+		//std::string total_page_num = llformat("/ %d", mCurrentPage+1);
+		//getChild<LLTextBox>("page_num_label")->setValue(total_page_num);
+		//mShowHistory = true;
+		setPageCount(mMessages->size());
+		// </FS>
 	}
 	LLLoadHistoryThread* loadThread = LLLogChat::getInstance()->getLoadHistoryThread(mSessionID);
 	if (loadThread)
@@ -148,6 +154,22 @@ void LLFloaterConversationPreview::setPages(std::list<LLSD>* messages, const std
 	}
 }
 
+// <FS> Indexed transcripts
+// Shows the last page
+void LLFloaterConversationPreview::setPageCount(S32 message_count)
+{
+	mCurrentPage = (message_count ? (message_count - 1) / mPageSize : 0);
+
+	mPageSpinner->setEnabled(true);
+	mPageSpinner->setMaxValue(mCurrentPage+1);
+	mPageSpinner->set(mCurrentPage+1);
+
+	std::string total_page_num = llformat("/ %d", mCurrentPage+1);
+	getChild<LLTextBox>("page_num_label")->setValue(total_page_num);
+	mShowHistory = true;
+}
+// </FS>
+
 void LLFloaterConversationPreview::draw()
 {
 	if(mShowHistory)
@@ -191,6 +213,22 @@ void LLFloaterConversationPreview::onOpen(const LLSD& key)
 	mPageSpinner->set(1);
 	mPageSpinner->setEnabled(false);
 
+	// <FS> Indexed transcripts: only the page on screen is read
+	mLoadParams = load_params;
+	delete mTranscriptIndex;
+	mTranscriptIndex = new LLTranscriptIndex(LLLogChat::makeLogFileName(mChatHistoryFileName), gSavedSettings.getBOOL("FSIndexTranscriptWords"));
+	if (mTranscriptIndex->load() && mTranscriptIndex->getCount())
+	{
+		delete mMessages;
+		mMessages = NULL;
+		setPageCount(mTranscriptIndex->getCount());
+		return;
+	}
+	// older transcripts are looked for by the loader
+	delete mTranscriptIndex;
+	mTranscriptIndex = NULL;
+	// </FS>
+
 	// The actual message list to load from file
 	// Will be deleted in a separate thread LLDeleteHistoryThread not to freeze UI
 	// LLDeleteHistoryThread is started in destructor
@@ -213,7 +251,10 @@ void LLFloaterConversationPreview::onOpen(const LLSD& key)
 void LLFloaterConversationPreview::onClose(bool app_quitting)
 {
 	mOpened = false;
-	if (!mHistoryThreadsBusy)
+	// <FS> Indexed transcripts: no loader threads were started for an indexed transcript
+	//if (!mHistoryThreadsBusy)
+	if (!mHistoryThreadsBusy && !mTranscriptIndex)
+	// </FS>
 	{
 		LLDeleteHistoryThread* deleteThread = LLLogChat::getInstance()->getDeleteHistoryThread(mSessionID);
 		if (deleteThread)
@@ -227,17 +268,42 @@ void LLFloaterConversationPreview::showHistory()
 {
 	// additional protection to avoid changes of mMessages in setPages
 	LLMutexLock lock(&mMutex);
-	if(mMessages == NULL || !mMessages->size() || mCurrentPage * mPageSize >= mMessages->size())
+	// <FS> Indexed transcripts
+	//if(mMessages == NULL || !mMessages->size() || mCurrentPage * mPageSize >= mMessages->size())
+	const std::list<LLSD>* messages = mMessages;
+	S32 first_message = mCurrentPage * mPageSize;
+	std::list<LLSD> page;
+	if (mTranscriptIndex)
+	{
+		std::vector<std::string> raw_messages;
+		mTranscriptIndex->readMessages(first_message, mPageSize, raw_messages);
+		for (std::vector<std::string>::const_iterator it = raw_messages.begin(); it != raw_messages.end(); ++it)
+		{
+			LLSD item;
+			LLLogChat::parseTranscriptMessage(*it, item, mLoadParams);
+			page.push_back(item);
+		}
+		messages = &page;
+		first_message = 0;
+	}
+	if(messages == NULL || !messages->size() || first_message >= (S32)messages->size())
+	// </FS>
 	{
 		return;
 	}
 
 	mChatHistory->clear();
 	std::ostringstream message;
-	std::list<LLSD>::const_iterator iter = mMessages->begin();
-	std::advance(iter, mCurrentPage * mPageSize);
-
-	for (int msg_num = 0; iter != mMessages->end() && msg_num < mPageSize; ++iter, ++msg_num)
+	// <FS> Indexed transcripts
+	//std::list<LLSD>::const_iterator iter = mMessages->begin();
+	//std::advance(iter, mCurrentPage * mPageSize);
+	//
+	//for (int msg_num = 0; iter != mMessages->end() && msg_num < mPageSize; ++iter, ++msg_num)
+	std::list<LLSD>::const_iterator iter = messages->begin();
+	std::advance(iter, first_message);
+
+	for (int msg_num = 0; iter != messages->end() && msg_num < mPageSize; ++iter, ++msg_num)
+	// </FS>
 	{
 		LLSD msg = *iter;
 
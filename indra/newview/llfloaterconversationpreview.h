@@ -36,6 +36,7 @@ extern const std::string LL_FCP_COMPLETE_NAME;	//"complete_name"
 extern const std::string LL_FCP_ACCOUNT_NAME;		//"user_name"
 
 class LLSpinCtrl;
+class LLTranscriptIndex; // <FS/> Indexed transcripts
 
 class LLFloaterConversationPreview : public LLFloater
 {
@@ -58,6 +59,7 @@ public:
 private:
 	void onMoreHistoryBtnClick();
 	void showHistory();
+	void setPageCount(S32 message_count); // <FS/> Indexed transcripts
 	void onBtnOpenExternal();	// <FS:CR> Open chat history externally
 	void onClickSearch();	// [FS:CR] FIRE-6545
 
@@ -72,6 +74,10 @@ private:
 	int				mPageSize;
 
 	std::list<LLSD>*	mMessages;
+	// <FS> Indexed transcripts: pages are read from the transcript when it has an index
+	LLTranscriptIndex*	mTranscriptIndex;
+	LLSD				mLoadParams;
+	// </FS>
 	std::string		mAccountName;
 	std::string		mCompleteName;
 	std::string		mChatHistoryFileName;
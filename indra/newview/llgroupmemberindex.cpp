@@ -0,0 +1,350 @@
+/**
+ * @file llgroupmemberindex.cpp
+ * @brief Sorted, filtered rows of a group's members for a virtual list.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llgroupmemberindex.h"
+
+#include <algorithm>
+#include <set>
+
+#include "llavatarnamecache.h"
+#include "llgroupmgr.h"
+#include "lltimer.h"
+
+static const char* SORT_KEY_COLUMNS[LLGroupMemberIndex::SORT_KEY_COUNT] = { "name", "donated", "online", "title" };
+
+struct LLGroupMemberIndex::KeyLess
+{
+	KeyLess(const std::vector<Member>& members, S32 key)
+	:	mMembers(members),
+		mKey(key)
+	{}
+
+	bool operator()(U32 a, U32 b) const
+	{
+		const Member& lhs = mMembers[a];
+		const Member& rhs = mMembers[b];
+		switch (mKey)
+		{
+		case SORT_DONATED:
+			return lhs.mContribution < rhs.mContribution;
+		case SORT_ONLINE:
+			return LLStringUtil::compareDict(*lhs.mOnlineStatus, *rhs.mOnlineStatus) < 0;
+		case SORT_TITLE:
+			return LLStringUtil::compareDict(*lhs.mTitle, *rhs.mTitle) < 0;
+		default:
+			return LLStringUtil::compareDict(lhs.mName, rhs.mName) < 0;
+		}
+	}
+
+	const std::vector<Member>& mMembers;
+	S32 mKey;
+};
+
+LLGroupMemberIndex::LLGroupMemberIndex()
+{
+}
+
+void LLGroupMemberIndex::clear()
+{
+	mMembers.clear();
+	for (S32 key = 0; key < SORT_KEY_COUNT; ++key)
+	{
+		mOrder[key].clear();
+	}
+	mRows.clear();
+	mRowOfMember.clear();
+	mPending.clear();
+}
+
+void LLGroupMemberIndex::setGroup(const LLGroupMgrGroupData* gdatap)
+{
+	clear();
+	if (!gdatap)
+	{
+		return;
+	}
+
+	mMembers.reserve(gdatap->mMembers.size());
+	for (LLGroupMgrGroupData::member_list_t::const_iterator it = gdatap->mMembers.begin(); it != gdatap->mMembers.end(); ++it)
+	{
+		const LLGroupMemberData* data = it->second;
+		if (data)
+		{
+			Member member;
+			member.mID = data->getID();
+			member.mTitle = &data->getTitle();
+			member.mOnlineStatus = &data->getOnlineStatus();
+			member.mContribution = data->getContribution();
+			mPending.push_back(member);
+		}
+	}
+}
+
+bool LLGroupMemberIndex::update(F32 max_time)
+{
+	if (mPending.empty())
+	{
+		return false;
+	}
+
+	LLTimer update_time;
+	update_time.setTimerExpirySec(max_time);
+
+	// each waiting member is looked at once per call at most, the ones
+	// without a name go to the back of the queue
+	U32 first_new = mMembers.size();
+	for (size_t count = mPending.size(); count && !update_time.hasExpired(); --count)
+	{
+		LLAvatarName av_name;
+		if (LLAvatarNameCache::get(mPending.front().mID, &av_name))
+		{
+			mMembers.push_back(mPending.front());
+			mMembers.back().mName = av_name.getCompleteName();
+		}
+		else
+		{
+			mPending.push_back(mPending.front());
+		}
+		mPending.pop_front();
+	}
+
+	if (mMembers.size() == first_new)
+	{
+		return false;
+	}
+
+	mergeNewMembers(first_new);
+
+	bool rows_changed = false;
+	mRowOfMember.resize(mMembers.size(), -1);
+	for (U32 i = first_new; i < mMembers.size(); ++i)
+	{
+		if (matchesFilter(mMembers[i]))
+		{
+			mRowOfMember[i] = mRows.size();
+			mRows.push_back(i);
+			rows_changed = true;
+		}
+	}
+	return rows_changed;
+}
+
+void LLGroupMemberIndex::mergeNewMembers(U32 first_new)
+{
+	for (S32 key = 0; key < SORT_KEY_COUNT; ++key)
+	{
+		std::vector<U32>& order = mOrder[key];
+		size_t old_size = order.size();
+		for (U32 i = first_new; i < mMembers.size(); ++i)
+		{
+			order.push_back(i);
+		}
+		KeyLess less(mMembers, key);
+		std::stable_sort(order.begin() + old_size, order.end(), less);
+		std::inplace_merge(order.begin(), order.begin() + old_size, order.end(), less);
+	}
+}
+
+void LLGroupMemberIndex::removeMembers(const uuid_vec_t& ids)
+{
+	std::set<LLUUID> removed(ids.begin(), ids.end());
+
+	std::deque<Member> pending;
+	for (std::deque<Member>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+	{
+		if (!removed.count(it->mID))
+		{
+			pending.push_back(*it);
+		}
+	}
+	mPending.swap(pending);
+
+	// renumber the members that stay, the orders keep their sequence
+	std::vector<S32> new_index(mMembers.size(), -1);
+	U32 kept = 0;
+	for (U32 i = 0; i < mMembers.size(); ++i)
+	{
+		if (!removed.count(mMembers[i].mID))
+		{
+			if (kept != i)
+			{
+				mMembers[kept] = mMembers[i];
+			}
+			new_index[i] = kept++;
+		}
+	}
+	if (kept == mMembers.size())
+	{
+		return;
+	}
+	mMembers.resize(kept);
+
+	for (S32 key = 0; key < SORT_KEY_COUNT; ++key)
+	{
+		std::vector<U32>& order = mOrder[key];
+		std::vector<U32>::iterator out = order.begin();
+		for (std::vector<U32>::const_iterator it = order.begin(); it != order.end(); ++it)
+		{
+			if (new_index[*it] >= 0)
+			{
+				*out++ = new_index[*it];
+			}
+		}
+		order.erase(out, order.end());
+	}
+	rebuildRows();
+}
+
+bool LLGroupMemberIndex::setFilter(const std::string& filter)
+{
+	if (filter == mFilter)
+	{
+		return false;
+	}
+	mFilter = filter;
+	rebuildRows();
+	return true;
+}
+
+bool LLGroupMemberIndex::matchesFilter(const Member& member) const
+{
+	if (mFilter.empty())
+	{
+		return true;
+	}
+	std::string name_lc(member.mName);
+	LLStringUtil::toLower(name_lc);
+	return name_lc.find(mFilter) != std::string::npos;
+}
+
+void LLGroupMemberIndex::rebuildRows()
+{
+	mRows.clear();
+	mRowOfMember.assign(mMembers.size(), -1);
+	for (U32 i = 0; i < mMembers.size(); ++i)
+	{
+		if (matchesFilter(mMembers[i]))
+		{
+			mRowOfMember[i] = mRows.size();
+			mRows.push_back(i);
+		}
+	}
+}
+
+// static
+S32 LLGroupMemberIndex::getSortKey(const std::string& column)
+{
+	for (S32 key = 0; key < SORT_KEY_COUNT; ++key)
+	{
+		if (column == SORT_KEY_COLUMNS[key])
+		{
+			return key;
+		}
+	}
+	return -1;
+}
+
+std::string LLGroupMemberIndex::getDonatedText(const Member& member) const
+{
+	std::string text = mDonationFormat.empty() ? std::string("[AREA]") : mDonationFormat;
+	LLStringUtil::replaceString(text, "[AREA]", llformat("%d", member.mContribution));
+	return text;
+}
+
+LLSD LLGroupMemberIndex::getRowValue(S32 row) const
+{
+	return mMembers[mRows[row]].mID;
+}
+
+std::string LLGroupMemberIndex::getCellText(S32 row, const std::string& column) const
+{
+	const Member& member = mMembers[mRows[row]];
+	switch (getSortKey(column))
+	{
+	case SORT_NAME:
+		return member.mName;
+	case SORT_DONATED:
+		return getDonatedText(member);
+	case SORT_ONLINE:
+		return *member.mOnlineStatus;
+	case SORT_TITLE:
+		return *member.mTitle;
+	default:
+		return std::string();
+	}
+}
+
+LLSD LLGroupMemberIndex::getRowElement(S32 row) const
+{
+	const Member& member = mMembers[mRows[row]];
+	LLSD element;
+	element["id"] = member.mID;
+	for (S32 key = 0; key < SORT_KEY_COUNT; ++key)
+	{
+		LLSD& column = element["columns"][key];
+		column["column"] = SORT_KEY_COLUMNS[key];
+		column["value"] = getCellText(row, SORT_KEY_COLUMNS[key]);
+		column["font"]["name"] = "SANSSERIF_SMALL";
+		column["font"]["style"] = "NORMAL";
+	}
+	return element;
+}
+
+bool LLGroupMemberIndex::getSortedRows(const std::string& column, bool ascending, std::vector<S32>& rows) const
+{
+	S32 key = getSortKey(column);
+	if (key < 0)
+	{
+		return false;
+	}
+
+	const std::vector<U32>& order = mOrder[key];
+	rows.clear();
+	rows.reserve(mRows.size());
+	if (ascending)
+	{
+		for (std::vector<U32>::const_iterator it = order.begin(); it != order.end(); ++it)
+		{
+			if (mRowOfMember[*it] >= 0)
+			{
+				rows.push_back(mRowOfMember[*it]);
+			}
+		}
+	}
+	else
+	{
+		for (std::vector<U32>::const_reverse_iterator it = order.rbegin(); it != order.rend(); ++it)
+		{
+			if (mRowOfMember[*it] >= 0)
+			{
+				rows.push_back(mRowOfMember[*it]);
+			}
+		}
+	}
+	return true;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file llgroupmemberindex.h
+ * @brief Sorted, filtered rows of a group's members for a virtual list.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLGROUPMEMBERINDEX_H
+#define LL_LLGROUPMEMBERINDEX_H
+
+#include <deque>
+
+#include "llscrolllistctrl.h"
+
+class LLGroupMgrGroupData;
+
+// The members of one group as rows of a virtual LLScrollListCtrl.
+//
+// A member is filed once LLAvatarNameCache knows its name.  Until then it
+// waits in a queue that update() polls a time slice per frame, which also
+// puts the missing names into the name cache's next batch request, rather
+// than holding a name callback per member.
+//
+// Every sort key keeps an order of all filed members.  Members filed in one
+// update() are sorted among themselves and merged into each order, so the
+// whole group is never sorted at once and clicking a column header only
+// reads an order that is already there.  The list asks for rows while it
+// draws, so only the rows on screen are ever turned into cells.
+//
+// The index copies what it shows; it never points into group data that
+// LLGroupMgr may throw away when the member list is refreshed.
+class LLGroupMemberIndex : public LLScrollListDataSource
+{
+public:
+	enum ESortKey
+	{
+		SORT_NAME,
+		SORT_DONATED,
+		SORT_ONLINE,
+		SORT_TITLE,
+		SORT_KEY_COUNT
+	};
+
+	LLGroupMemberIndex();
+
+	// Starts over with the members of gdatap, all of them waiting to be filed.
+	void setGroup(const LLGroupMgrGroupData* gdatap);
+	void clear();
+
+	// Files members whose names are known, for at most max_time seconds.
+	// True if the rows changed.
+	bool update(F32 max_time);
+	// No member is waiting for its name.
+	bool isComplete() const { return mPending.empty(); }
+	S32 getMemberCount() const { return mMembers.size(); }
+
+	// Drops ejected members without sorting anything again.
+	void removeMembers(const uuid_vec_t& ids);
+
+	// Only members whose complete name contains filter (lower case) are
+	// rows.  True if the rows changed.
+	bool setFilter(const std::string& filter);
+
+	// Text of the donated column, [AREA] is replaced by the contribution.
+	void setDonationFormat(const std::string& format) { mDonationFormat = format; }
+
+	/*virtual*/ S32 getRowCount() const { return mRows.size(); }
+	/*virtual*/ LLSD getRowValue(S32 row) const;
+	/*virtual*/ std::string getCellText(S32 row, const std::string& column) const;
+	/*virtual*/ LLSD getRowElement(S32 row) const;
+	/*virtual*/ bool getSortedRows(const std::string& column, bool ascending, std::vector<S32>& rows) const;
+
+private:
+	struct Member
+	{
+		LLUUID				mID;
+		std::string			mName;			// complete name, empty until known
+		const std::string*	mTitle;			// interned by LLGroupMemberData
+		const std::string*	mOnlineStatus;
+		S32					mContribution;
+	};
+
+	struct KeyLess;
+
+	static S32 getSortKey(const std::string& column);
+	bool matchesFilter(const Member& member) const;
+	std::string getDonatedText(const Member& member) const;
+	void mergeNewMembers(U32 first_new);
+	void rebuildRows();
+
+	std::vector<Member>	mMembers;					// filed
+	std::vector<U32>	mOrder[SORT_KEY_COUNT];		// filed members by key, ascending
+	std::vector<U32>	mRows;						// filed members that pass the filter
+	std::vector<S32>	mRowOfMember;				// -1 if filtered out
+	std::deque<Member>	mPending;					// waiting for a name
+	std::string			mFilter;
+	std::string			mDonationFormat;
+};
+
+#endif // LL_LLGROUPMEMBERINDEX_H
@@ -105,18 +105,44 @@ LLRoleActionSet::~LLRoleActionSet()
 // LLGroupMemberData
 //
 
+// <FS> Group member memory
+// Titles and online dates repeat across the members of a group, and across
+// groups, so every member points at one copy.  Strings are never removed.
+static LLStdStringTable& get_member_strings()
+{
+	static LLStdStringTable member_strings(1024);
+	return member_strings;
+}
+
+struct role_id_less
+{
+	bool operator()(const LLGroupMemberData::role_list_t::value_type& role, const LLUUID& id) const
+	{
+		return role.first < id;
+	}
+};
+// </FS>
+
 LLGroupMemberData::LLGroupMemberData(const LLUUID& id, 
 										S32 contribution,
 										U64 agent_powers,
 										const std::string& title,
 										const std::string& online_status,
 										BOOL is_owner) : 
-	mID(id), 
-	mContribution(contribution), 
-	mAgentPowers(agent_powers), 
-	mTitle(title), 
-	mOnlineStatus(online_status),
+	// <FS> Group member memory
+	//mID(id), 
+	//mContribution(contribution), 
+	//mAgentPowers(agent_powers), 
+	//mTitle(title), 
+	//mOnlineStatus(online_status),
+	//mIsOwner(is_owner)
+	mID(id),
+	mAgentPowers(agent_powers),
+	mTitle(get_member_strings().insert(title)),
+	mOnlineStatus(get_member_strings().insert(online_status)),
+	mContribution(contribution),
 	mIsOwner(is_owner)
+	// </FS>
 {
 }
 
@@ -124,16 +150,52 @@ LLGroupMemberData::~LLGroupMemberData()
 {
 }
 
+// <FS> Group member memory
+LLGroupMemberData::role_list_t::iterator LLGroupMemberData::findRole(const LLUUID& role)
+{
+	return std::lower_bound(mRolesList.begin(), mRolesList.end(), role, role_id_less());
+}
+
+BOOL LLGroupMemberData::isInRole(const LLUUID& role_id) const
+{
+	role_list_t::const_iterator it = std::lower_bound(mRolesList.begin(), mRolesList.end(), role_id, role_id_less());
+	return it != mRolesList.end() && it->first == role_id;
+}
+
+size_t LLGroupMemberData::getMemoryUse() const
+{
+	// a member list node holds the key, the pointer and the bucket chain
+	return sizeof(LLGroupMemberData) + mRolesList.capacity() * sizeof(role_list_t::value_type)
+		+ sizeof(LLGroupMgrGroupData::member_list_t::value_type) + 2 * sizeof(void*);
+}
+// </FS>
+
 void LLGroupMemberData::addRole(const LLUUID& role, LLGroupRoleData* rd)
 {
-	mRolesList[role] = rd;
+	// <FS> Group member memory
+	//mRolesList[role] = rd;
+	role_list_t::iterator it = findRole(role);
+	if (it != mRolesList.end() && it->first == role)
+	{
+		it->second = rd;
+	}
+	else
+	{
+		mRolesList.insert(it, std::make_pair(role, rd));
+	}
+	// </FS>
 }
 
 bool LLGroupMemberData::removeRole(const LLUUID& role)
 {
-	role_list_t::iterator it = mRolesList.find(role);
+	// <FS> Group member memory
+	//role_list_t::iterator it = mRolesList.find(role);
+	//
+	//if (it != mRolesList.end())
+	role_list_t::iterator it = findRole(role);
 
-	if (it != mRolesList.end())
+	if (it != mRolesList.end() && it->first == role)
+	// </FS>
 	{
 		mRolesList.erase(it);
 		return true;
@@ -631,6 +693,26 @@ void LLGroupMgrGroupData::recalcAgentPowers(const LLUUID& agent_id)
 	}
 }
 
+// <FS> Group member memory
+void LLGroupMgrGroupData::logMemberMemoryUse() const
+{
+	if (mMembers.empty())
+	{
+		return;
+	}
+	size_t bytes = mMembers.bucket_count() * sizeof(void*);
+	for (member_list_t::const_iterator it = mMembers.begin(); it != mMembers.end(); ++it)
+	{
+		if (it->second)
+		{
+			bytes += it->second->getMemoryUse();
+		}
+	}
+	LL_DEBUGS("GrpMgr") << "Group " << mID << ": " << mMembers.size() << " members, "
+						<< bytes / mMembers.size() << " bytes per member" << LL_ENDL;
+}
+// </FS>
+
 bool LLGroupMgrGroupData::isSingleMemberNotOwner()
 {
 	return mMembers.size() == 1 && !mMembers.begin()->second->isOwner();
@@ -995,6 +1077,9 @@ void LLGroupMgr::processGroupMembersReply(LLMessageSystem* msg, void** data)
 
 	if (group_datap->mMemberCount > 0)
 	{
+		// <FS/> Group member memory: no rehashing while the pages come in
+		group_datap->mMembers.reserve(group_datap->mMemberCount);
+
 		S32 contribution = 0;
 		std::string online_status;
 		std::string title;
@@ -1032,14 +1117,23 @@ void LLGroupMgr::processGroupMembersReply(LLMessageSystem* msg, void** data)
 																	title,
 																	online_status,
 																	is_owner);
-#if LL_DEBUG
-				LLGroupMgrGroupData::member_list_t::iterator mit = group_datap->mMembers.find(member_id);
-				if (mit != group_datap->mMembers.end())
+				// <FS> Group member memory: don't leak duplicates
+//#if LL_DEBUG
+//				LLGroupMgrGroupData::member_list_t::iterator mit = group_datap->mMembers.find(member_id);
+//				if (mit != group_datap->mMembers.end())
+//				{
+//					LL_INFOS() << " *** Received duplicate member data for agent " << member_id << LL_ENDL;
+//				}
+//#endif
+//				group_datap->mMembers[member_id] = newdata;
+				LLGroupMemberData*& member_slot = group_datap->mMembers[member_id];
+				if (member_slot)
 				{
-					LL_INFOS() << " *** Received duplicate member data for agent " << member_id << LL_ENDL;
+					LL_DEBUGS("GrpMgr") << "Received duplicate member data for agent " << member_id << LL_ENDL;
+					delete member_slot;
 				}
-#endif
-				group_datap->mMembers[member_id] = newdata;
+				member_slot = newdata;
+				// </FS>
 			}
 			else
 			{
@@ -1060,6 +1154,7 @@ void LLGroupMgr::processGroupMembersReply(LLMessageSystem* msg, void** data)
 	{
 		group_datap->mMemberDataComplete = true;
 		group_datap->mMemberRequestID.setNull();
+		group_datap->logMemberMemoryUse(); // <FS/> Group member memory
 		// We don't want to make role-member data requests until we have all the members
 		if (group_datap->mPendingRoleMemberRequest)
 		{
@@ -2302,6 +2397,7 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 	}
 	
 	group_datap->mMemberCount = num_members;
+	group_datap->mMembers.reserve(num_members); // <FS/> Group member memory
 
 	LLSD	member_list	= content["members"];
 	LLSD	titles		= content["titles"];
@@ -2359,7 +2455,11 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 			online_status,
 			is_owner);
 
-		LLGroupMemberData* member_old = group_datap->mMembers[member_id];
+		// <FS> Group member memory: the old data was leaked
+		//LLGroupMemberData* member_old = group_datap->mMembers[member_id];
+		LLGroupMemberData*& member_slot = group_datap->mMembers[member_id];
+		LLGroupMemberData* member_old = member_slot;
+		// </FS>
 		if (member_old && group_datap->mRoleMemberDataComplete)
 		{
 			LLGroupMemberData::role_list_t::iterator rit = member_old->roleBegin();
@@ -2375,7 +2475,11 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 			group_datap->mRoleMemberDataComplete = false;
 		}
 
-		group_datap->mMembers[member_id] = data;
+		// <FS> Group member memory
+		//group_datap->mMembers[member_id] = data;
+		delete member_old;
+		member_slot = data;
+		// </FS>
 	}
 
 	group_datap->mMemberVersion.generate();
@@ -2393,6 +2497,7 @@ void LLGroupMgr::processCapGroupMembersRequest(const LLSD& content)
 
 	group_datap->mMemberDataComplete = true;
 	group_datap->mMemberRequestID.setNull();
+	group_datap->logMemberMemoryUse(); // <FS/> Group member memory
 	// Make the role-member data request
 	if (group_datap->mPendingRoleMemberRequest || !group_datap->mRoleMemberDataComplete)
 	{
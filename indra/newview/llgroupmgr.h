@@ -28,10 +28,12 @@
 #define LL_LLGROUPMGR_H
 
 #include "lluuid.h"
+#include "llstringtable.h"
 #include "roles_constants.h"
 #include <vector>
 #include <string>
 #include <map>
+#include <boost/unordered_map.hpp>
 #include "lleventcoro.h"
 #include "llcoros.h"
 
@@ -77,7 +79,11 @@ class LLGroupMemberData
 friend class LLGroupMgrGroupData;
 
 public:
-	typedef std::map<LLUUID,LLGroupRoleData*> role_list_t;
+	// <FS> Group member memory: members are in one or two roles, a sorted
+	// vector costs a fraction of a map
+	//typedef std::map<LLUUID,LLGroupRoleData*> role_list_t;
+	typedef std::vector<std::pair<LLUUID, LLGroupRoleData*> > role_list_t;
+	// </FS>
 	
 	LLGroupMemberData(const LLUUID& id, 
 						S32 contribution,
@@ -92,8 +98,13 @@ public:
 	S32 getContribution() const { return mContribution; }
 	U64	getAgentPowers() const { return mAgentPowers; }
 	BOOL isOwner() const { return mIsOwner; }
-	const std::string& getTitle() const { return mTitle; }
-	const std::string& getOnlineStatus() const { return mOnlineStatus; }
+	// <FS> Group member memory: shared by every member with the same text and
+	// valid for the whole session
+	//const std::string& getTitle() const { return mTitle; }
+	//const std::string& getOnlineStatus() const { return mOnlineStatus; }
+	const std::string& getTitle() const { return *mTitle; }
+	const std::string& getOnlineStatus() const { return *mOnlineStatus; }
+	// </FS>
 	void addRole(const LLUUID& role, LLGroupRoleData* rd);
 	bool removeRole(const LLUUID& role);
 	void clearRoles() { mRolesList.clear(); };
@@ -104,16 +115,33 @@ public:
 	role_list_t::const_iterator roleEnd() const { return mRolesList.end(); }
 // [/SL:KB]
 
-	BOOL isInRole(const LLUUID& role_id) { return (mRolesList.find(role_id) != mRolesList.end()); }
+	// <FS> Group member memory
+	//BOOL isInRole(const LLUUID& role_id) { return (mRolesList.find(role_id) != mRolesList.end()); }
+	BOOL isInRole(const LLUUID& role_id) const;
+
+	// Bytes held for this member, including its entry in the member list.
+	size_t getMemoryUse() const;
+	// </FS>
 
 private:
-	LLUUID	mID;
-	S32		mContribution;
-	U64		mAgentPowers;
-	std::string	mTitle;
-	std::string	mOnlineStatus;
-	BOOL	mIsOwner;
-	role_list_t mRolesList;
+	// <FS> Group member memory: interned strings, sorted roles, no padding
+	//LLUUID	mID;
+	//S32		mContribution;
+	//U64		mAgentPowers;
+	//std::string	mTitle;
+	//std::string	mOnlineStatus;
+	//BOOL	mIsOwner;
+	//role_list_t mRolesList;
+	role_list_t::iterator findRole(const LLUUID& role);
+
+	LLUUID				mID;
+	U64					mAgentPowers;
+	LLStdStringHandle	mTitle;
+	LLStdStringHandle	mOnlineStatus;
+	role_list_t			mRolesList;
+	S32					mContribution;
+	bool				mIsOwner;
+	// </FS>
 };
 
 struct LLRoleData
@@ -289,7 +317,8 @@ public:
 	void banMemberById(const LLUUID& participant_uuid);
 	
 public:
-	typedef	std::map<LLUUID,LLGroupMemberData*> member_list_t;
+	// <FS/> Group member memory
+	typedef	boost::unordered_map<LLUUID, LLGroupMemberData*, FSUUIDHash> member_list_t;
 	typedef	std::map<LLUUID,LLGroupRoleData*> role_list_t;
 	typedef std::map<lluuid_pair,LLRoleMemberChange,lluuid_pair_less> change_map_t;
 	typedef std::map<LLUUID,LLRoleData> role_data_map_t;
@@ -325,6 +354,7 @@ public:
 protected:
 	void sendRoleChanges();
 	void cancelRoleChanges();
+	void logMemberMemoryUse() const; // <FS/> Group member memory
 
 private:
 	LLUUID				mMemberRequestID;
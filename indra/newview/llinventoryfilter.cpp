@@ -43,6 +43,7 @@
 #include "llviewerfoldertype.h"
 #include "llradiogroup.h"
 #include "llstartup.h"
+#include "llinventorysearchindexer.h" // <FS/> Inventory search index
 
 // linden library includes
 #include "llclipboard.h"
@@ -107,8 +108,16 @@ bool LLInventoryFilter::check(const LLFolderViewModelItem* item)
 	{
 		return true;
 	}
+
+	// <FS> Inventory search index
+	if (!checkAgainstSearchIndex(listener))
+	{
+		return false;
+	}
+	// </FS>
 	
-	std::string desc = listener->getSearchableCreatorName();
+	//std::string desc = listener->getSearchableCreatorName();
+	std::string desc; // <FS/> Inventory search index: the switch below always assigns it
 	switch(mSearchType)
 	{
 		case SEARCHTYPE_CREATOR:
@@ -628,6 +637,129 @@ bool LLInventoryFilter::checkAgainstCreator(const LLFolderViewModelItemInventory
 	}
 }
 
+// <FS> Inventory search index
+// Rejects items of gInventory the search index says can't match the filter
+// string without building their searchable strings.  Anything the index
+// can't vouch for is passed on to the full check.
+bool LLInventoryFilter::checkAgainstSearchIndex(const LLFolderViewModelItemInventory* listener)
+{
+	LLInventorySearchIndexer* indexer = LLInventorySearchIndexer::getInstance();
+	if (mFilterSubString.empty() || !indexer || !indexer->isReady())
+	{
+		return true;
+	}
+
+	// folders and the contents of objects aren't indexed, recently changed
+	// items may not be yet
+	const LLUUID& id = listener->getUUID();
+	if (!gInventory.getItem(id) || indexer->isPending(id))
+	{
+		return true;
+	}
+
+	if (!mSearchCandidates.mValid
+		|| mSearchCandidates.mRevision != LLInventorySearchIndexer::getRevision()
+		|| mSearchCandidates.mSearchType != mSearchType
+		|| mSearchCandidates.mSubString != mFilterSubString)
+	{
+		updateSearchCandidates(indexer);
+	}
+	if (mSearchCandidates.mSpansFields || mSearchCandidates.mIDs.count(id))
+	{
+		return true;
+	}
+
+	// label suffixes like "(worn)" are part of the searchable name but not
+	// of the index, so such items still need a look
+	if ((mSearchType == SEARCHTYPE_NAME) || (mSearchType == SEARCHTYPE_ALL))
+	{
+		const std::string& display_name = listener->getDisplayName();
+		if (listener->getSearchableName().size() != display_name.size())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void LLInventoryFilter::updateSearchCandidates(LLInventorySearchIndexer* indexer)
+{
+	U32 field_mask;
+	switch (mSearchType)
+	{
+		case SEARCHTYPE_CREATOR:
+			field_mask = LLInventorySearchIndex::FIELD_CREATOR;
+			break;
+		case SEARCHTYPE_DESCRIPTION:
+			field_mask = LLInventorySearchIndex::FIELD_DESCRIPTION;
+			break;
+		case SEARCHTYPE_UUID:
+			field_mask = LLInventorySearchIndex::FIELD_ASSET_ID;
+			break;
+		case SEARCHTYPE_ALL:
+			field_mask = LLInventorySearchIndex::FIELD_ALL;
+			break;
+		case SEARCHTYPE_NAME:
+		default:
+			field_mask = LLInventorySearchIndex::FIELD_NAME;
+			break;
+	}
+
+	mSearchCandidates.mValid = true;
+	mSearchCandidates.mRevision = LLInventorySearchIndexer::getRevision();
+	mSearchCandidates.mSearchType = mSearchType;
+	mSearchCandidates.mSubString = mFilterSubString;
+
+	// same string choice as check()
+	LLInventorySearchIndex::id_set_t& ids = mSearchCandidates.mIDs;
+	ids.clear();
+	const bool use_tokens = (mSearchType == SEARCHTYPE_NAME) || (mSearchType == SEARCHTYPE_ALL);
+
+	// getSearchableAll() joins the fields with "+", so a string holding one
+	// can match across fields, which the per field index doesn't see.  The
+	// "+" separated tokens never hold one.
+	const std::string& whole = mExactToken.empty() ? mFilterSubString : mExactToken;
+	mSearchCandidates.mSpansFields = (mSearchType == SEARCHTYPE_ALL)
+		&& mFilterTokens.empty()
+		&& (whole.find('+') != std::string::npos);
+	if (mSearchCandidates.mSpansFields)
+	{
+		return;
+	}
+
+	if (!mExactToken.empty() && use_tokens)
+	{
+		// a whole word match is also a substring match
+		indexer->find(mExactToken, field_mask, ids);
+	}
+	else if ((mFilterTokens.size() > 0) && use_tokens)
+	{
+		indexer->find(mFilterTokens[0], field_mask, ids);
+		LLInventorySearchIndex::id_set_t token_ids;
+		for (size_t i = 1; i < mFilterTokens.size() && !ids.empty(); ++i)
+		{
+			token_ids.clear();
+			indexer->find(mFilterTokens[i], field_mask, token_ids);
+			for (LLInventorySearchIndex::id_set_t::iterator it = ids.begin(); it != ids.end(); )
+			{
+				if (token_ids.count(*it))
+				{
+					++it;
+				}
+				else
+				{
+					it = ids.erase(it);
+				}
+			}
+		}
+	}
+	else
+	{
+		indexer->find(mFilterSubString, field_mask, ids);
+	}
+}
+// </FS>
+
 bool LLInventoryFilter::checkAgainstSearchVisibility(const LLFolderViewModelItemInventory* listener) const
 {
 	if (!listener || !hasFilterString()) return TRUE;
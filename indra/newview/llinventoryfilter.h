@@ -30,6 +30,7 @@
 #include "llinventorytype.h"
 #include "llpermissionsflags.h"
 #include "llfolderviewmodel.h"
+#include "llinventorysearchindex.h" // <FS/> Inventory search index
 
 class LLFolderViewItem;
 class LLFolderViewFolder;
@@ -344,6 +345,10 @@ private:
 	bool 				checkAgainstCreator(const class LLFolderViewModelItemInventory* listener) const;
 	bool				checkAgainstSearchVisibility(const class LLFolderViewModelItemInventory* listener) const;
 	bool				checkAgainstClipboard(const LLUUID& object_id) const;
+	// <FS> Inventory search index
+	bool				checkAgainstSearchIndex(const class LLFolderViewModelItemInventory* listener);
+	void				updateSearchCandidates(class LLInventorySearchIndexer* indexer);
+	// </FS>
 
 	FilterOps				mFilterOps;
 	FilterOps				mDefaultFilterOps;
@@ -373,6 +378,23 @@ private:
 
 	std::vector<std::string> mFilterTokens;
 	std::string				 mExactToken;
+
+	// <FS> Inventory search index
+	// Items the search index found for the current string, and what they
+	// were looked up for.
+	struct SearchCandidates
+	{
+		SearchCandidates() : mValid(false), mSpansFields(false), mRevision(0), mSearchType(SEARCHTYPE_NAME) {}
+
+		LLInventorySearchIndex::id_set_t	mIDs;
+		bool								mValid;
+		bool								mSpansFields;	// the index can't answer, check every item
+		U32									mRevision;
+		ESearchType							mSearchType;
+		std::string							mSubString;
+	};
+	SearchCandidates		 mSearchCandidates;
+	// </FS>
 };
 
 #endif
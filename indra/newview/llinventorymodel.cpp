@@ -83,6 +83,8 @@
 #include "aoengine.h"
 #include "fsfloaterwearablefavorites.h"
 #include "fslslbridge.h"
+#include "llinventorycache.h" // <FS/> Binary inventory cache
+#include "llparallelfor.h" // <FS/> Binary inventory cache
 #ifdef OPENSIM
 #include "llviewernetwork.h"
 #endif
@@ -99,6 +101,25 @@ BOOL LLInventoryModel::sFirstTimeInViewer2 = TRUE;
 //BOOL decompress_file(const char* src_filename, const char* dst_filename);
 static const char PRODUCTION_CACHE_FORMAT_STRING[] = "%s.inv.llsd";
 static const char GRID_CACHE_FORMAT_STRING[] = "%s.%s.inv.llsd";
+
+// <FS> Binary inventory cache
+// "<owner>.inv.llsd" -> "<owner>.inv.bin.gz", grid part kept.
+static std::string get_binary_cache_filename(const std::string& inventory_filename)
+{
+	static const std::string LLSD_EXTENSION(".llsd");
+	std::string binary_filename(inventory_filename);
+	if (binary_filename.size() > LLSD_EXTENSION.size()
+		&& binary_filename.compare(binary_filename.size() - LLSD_EXTENSION.size(), LLSD_EXTENSION.size(), LLSD_EXTENSION) == 0)
+	{
+		binary_filename.erase(binary_filename.size() - LLSD_EXTENSION.size());
+	}
+	binary_filename.append(".bin.gz");
+	return binary_filename;
+}
+
+// Items filled per LLParallelFor index when loading the binary cache.
+static const S32 INVENTORY_CACHE_LOAD_CHUNK = 4096;
+// </FS>
 static const char * const LOG_INV("Inventory");
 
 struct InventoryIDPtrLess
@@ -509,10 +530,26 @@ void LLInventoryModel::getDirectDescendentsOf(const LLUUID& cat_id,
 											  cat_array_t*& categories,
 											  item_array_t*& items) const
 {
-	categories = get_ptr_in_map(mParentChildCategoryTree, cat_id);
-	items = get_ptr_in_map(mParentChildItemTree, cat_id);
+	categories = findChildCategories(cat_id);
+	items = findChildItems(cat_id);
 }
 
+// <FS> Hashed inventory indices
+// The arrays are handed out for writing just like the heap allocated ones
+// were, hence the const_cast.
+LLInventoryModel::cat_array_t* LLInventoryModel::findChildCategories(const LLUUID& cat_id) const
+{
+	parent_cat_map_t::const_iterator it = mParentChildCategoryTree.find(cat_id);
+	return it != mParentChildCategoryTree.end() ? const_cast<cat_array_t*>(&it->second) : NULL;
+}
+
+LLInventoryModel::item_array_t* LLInventoryModel::findChildItems(const LLUUID& cat_id) const
+{
+	parent_item_map_t::const_iterator it = mParentChildItemTree.find(cat_id);
+	return it != mParentChildItemTree.end() ? const_cast<item_array_t*>(&it->second) : NULL;
+}
+// </FS>
+
 LLMD5 LLInventoryModel::hashDirectDescendentNames(const LLUUID& cat_id) const
 {
 	LLInventoryModel::cat_array_t* cat_array;
@@ -629,7 +666,7 @@ const LLUUID LLInventoryModel::findCategoryUUIDForTypeInRoot(
 	else if (root_id.notNull())
 	{
 		cat_array_t* cats = NULL;
-		cats = get_ptr_in_map(mParentChildCategoryTree, root_id);
+		cats = findChildCategories(root_id);
 		if(cats)
 		{
 			S32 count = cats->size();
@@ -720,7 +757,7 @@ LLUUID LLInventoryModel::findCategoryByName(std::string name)
 	if(root_id.notNull())
 	{
 		cat_array_t* cats = NULL;
-		cats = get_ptr_in_map(mParentChildCategoryTree, root_id);
+		cats = findChildCategories(root_id);
 		if(cats)
 		{
 			S32 count = cats->size();
@@ -1015,7 +1052,7 @@ void LLInventoryModel::collectDescendentsIf(const LLUUID& id,
 		if(trash_id.notNull() && (trash_id == id))
 			return;
 	}
-	cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, id);
+	cat_array_t* cat_array = findChildCategories(id);
 	if(cat_array)
 	{
 		S32 count = cat_array->size();
@@ -1034,7 +1071,7 @@ void LLInventoryModel::collectDescendentsIf(const LLUUID& id,
 	}
 
 	LLViewerInventoryItem* item = NULL;
-	item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, id);
+	item_array_t* item_array = findChildItems(id);
 
 	// Move onto items
 	if(item_array)
@@ -1228,12 +1265,12 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 		{
 			// need to update the parent-child tree
 			item_array_t* item_array;
-			item_array = get_ptr_in_map(mParentChildItemTree, old_parent_id);
+			item_array = findChildItems(old_parent_id);
 			if(item_array)
 			{
 				vector_replace_with_last(*item_array, old_item);
 			}
-			item_array = get_ptr_in_map(mParentChildItemTree, new_parent_id);
+			item_array = findChildItems(new_parent_id);
 			if(item_array)
 			{
 				if (update_parent_on_server)
@@ -1268,7 +1305,7 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 		{
 			const LLUUID category_id = findCategoryUUIDForType(LLFolderType::assetTypeToFolderType(new_item->getType()));
 			new_item->setParent(category_id);
-			item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, category_id);
+			item_array_t* item_array = findChildItems(category_id);
 			if( item_array )
 			{
 				LLInventoryModel::LLCategoryUpdate update(category_id, 1);
@@ -1301,7 +1338,7 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 				accountForUpdate(update);
 
 			}
-			item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, parent_id);
+			item_array_t* item_array = findChildItems(parent_id);
 			if(item_array)
 			{
 				item_array->push_back(new_item);
@@ -1313,7 +1350,7 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 								  << new_item->getName() << LL_ENDL;
 				parent_id = findCategoryUUIDForType(LLFolderType::FT_LOST_AND_FOUND);
 				new_item->setParent(parent_id);
-				item_array = get_ptr_in_map(mParentChildItemTree, parent_id);
+				item_array = findChildItems(parent_id);
 				if(item_array)
 				{
 					LLInventoryModel::LLCategoryUpdate update(parent_id, 1);
@@ -1370,7 +1407,7 @@ U32 LLInventoryModel::updateItem(const LLViewerInventoryItem* item, U32 mask)
 
 LLInventoryModel::cat_array_t* LLInventoryModel::getUnlockedCatArray(const LLUUID& id)
 {
-	cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, id);
+	cat_array_t* cat_array = findChildCategories(id);
 	if (cat_array)
 	{
 		llassert_always(mCategoryLock[id] == false);
@@ -1381,7 +1418,7 @@ LLInventoryModel::cat_array_t* LLInventoryModel::getUnlockedCatArray(const LLUUI
 
 LLInventoryModel::item_array_t* LLInventoryModel::getUnlockedItemArray(const LLUUID& id)
 {
-	item_array_t* item_array = get_ptr_in_map(mParentChildItemTree, id);
+	item_array_t* item_array = findChildItems(id);
 	if (item_array)
 	{
 		llassert_always(mItemLock[id] == false);
@@ -1458,10 +1495,14 @@ void LLInventoryModel::updateCategory(const LLViewerInventoryCategory* cat, U32
 		// make space in the tree for this category's children.
 		llassert_always(mCategoryLock[new_cat->getUUID()] == false);
 		llassert_always(mItemLock[new_cat->getUUID()] == false);
-		cat_array_t* catsp = new cat_array_t;
-		item_array_t* itemsp = new item_array_t;
-		mParentChildCategoryTree[new_cat->getUUID()] = catsp;
-		mParentChildItemTree[new_cat->getUUID()] = itemsp;
+		// <FS> Hashed inventory indices
+		//cat_array_t* catsp = new cat_array_t;
+		//item_array_t* itemsp = new item_array_t;
+		//mParentChildCategoryTree[new_cat->getUUID()] = catsp;
+		//mParentChildItemTree[new_cat->getUUID()] = itemsp;
+		mParentChildCategoryTree[new_cat->getUUID()] = cat_array_t();
+		mParentChildItemTree[new_cat->getUUID()] = item_array_t();
+		// </FS>
 		mask |= LLInventoryObserver::ADD;
 		addChangedMask(mask, cat->getUUID());
 	}
@@ -1476,7 +1517,8 @@ void LLInventoryModel::moveObject(const LLUUID& object_id, const LLUUID& cat_id)
 		return;
 	}
 
-	if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+	//if((object_id == cat_id) || !is_in_map(mCategoryMap, cat_id))
+	if((object_id == cat_id) || mCategoryMap.find(cat_id) == mCategoryMap.end()) // <FS/> Hashed inventory indices
 	{
 		LL_WARNS(LOG_INV) << "Could not move inventory object " << object_id << " to "
 						  << cat_id << LL_ENDL;
@@ -1831,7 +1873,7 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
 		{
 			LL_WARNS(LOG_INV) << "Deleting cat " << id << " while it still has child items" << LL_ENDL;
 		}
-		delete item_list;
+		//delete item_list; // <FS/> Hashed inventory indices
 		mParentChildItemTree.erase(id);
 	}
 	cat_list = getUnlockedCatArray(id);
@@ -1841,7 +1883,7 @@ void LLInventoryModel::deleteObject(const LLUUID& id, bool fix_broken_links, boo
 		{
 			LL_WARNS(LOG_INV) << "Deleting cat " << id << " while it still has child cats" << LL_ENDL;
 		}
-		delete cat_list;
+		//delete cat_list; // <FS/> Hashed inventory indices
 		mParentChildCategoryTree.erase(id);
 	}
 	addChangedMask(LLInventoryObserver::REMOVE, id);
@@ -2127,9 +2169,25 @@ void LLInventoryModel::cache(
 		INCLUDE_TRASH,
 		can_cache);
 	std::string inventory_filename = getInvCacheAddres(agent_id);
-	saveToFile(inventory_filename, categories, items);
 	std::string gzip_filename(inventory_filename);
 	gzip_filename.append(".gz");
+	// <FS> Binary inventory cache
+	std::string binary_filename = get_binary_cache_filename(inventory_filename);
+	static LLCachedControl<bool> inventory_cache_binary(gSavedSettings, "InventoryCacheBinary");
+	if (inventory_cache_binary)
+	{
+		if (saveToBinaryFile(binary_filename, categories, items))
+		{
+			// Only one cache may exist, or a stale one gets loaded after
+			// switching formats back.
+			LLFile::remove(gzip_filename, ENOENT);
+			return;
+		}
+		LL_WARNS(LOG_INV) << "Falling back to the LLSD inventory cache" << LL_ENDL;
+	}
+	LLFile::remove(binary_filename, ENOENT);
+	// </FS>
+	saveToFile(inventory_filename, categories, items);
 	if(gzip_file(inventory_filename, gzip_filename))
 	{
 		LL_DEBUGS(LOG_INV) << "Successfully compressed " << inventory_filename << LL_ENDL;
@@ -2256,15 +2314,17 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* item)
 void LLInventoryModel::empty()
 {
 //	LL_INFOS(LOG_INV) << "LLInventoryModel::empty()" << LL_ENDL;
-	std::for_each(
-		mParentChildCategoryTree.begin(),
-		mParentChildCategoryTree.end(),
-		DeletePairedPointer());
+	// <FS> Hashed inventory indices
+	//std::for_each(
+	//	mParentChildCategoryTree.begin(),
+	//	mParentChildCategoryTree.end(),
+	//	DeletePairedPointer());
 	mParentChildCategoryTree.clear();
-	std::for_each(
-		mParentChildItemTree.begin(),
-		mParentChildItemTree.end(),
-		DeletePairedPointer());
+	//std::for_each(
+	//	mParentChildItemTree.begin(),
+	//	mParentChildItemTree.end(),
+	//	DeletePairedPointer());
+	// </FS>
 	mParentChildItemTree.clear();
 	mBacklinkMMap.clear(); // forget all backlink information.
 	mCategoryMap.clear(); // remove all references (should delete entries)
@@ -2360,12 +2420,12 @@ LLInventoryModel::EHasChildren LLInventoryModel::categoryHasChildren(
 
 	// Shouldn't have to run this, but who knows.
 	parent_cat_map_t::const_iterator cat_it = mParentChildCategoryTree.find(cat->getUUID());
-	if (cat_it != mParentChildCategoryTree.end() && cat_it->second->size() > 0)
+	if (cat_it != mParentChildCategoryTree.end() && cat_it->second.size() > 0) // <FS/> Hashed inventory indices
 	{
 		return CHILDREN_YES;
 	}
 	parent_item_map_t::const_iterator item_it = mParentChildItemTree.find(cat->getUUID());
-	if (item_it != mParentChildItemTree.end() && item_it->second->size() > 0)
+	if (item_it != mParentChildItemTree.end() && item_it->second.size() > 0) // <FS/> Hashed inventory indices
 	{
 		return CHILDREN_YES;
 	}
@@ -2408,6 +2468,15 @@ bool LLInventoryModel::loadSkeleton(
 			LLFile::remove(inventory_filename);
 		}
 
+		// <FS> Binary inventory cache
+		std::string binary_filename = get_binary_cache_filename(inventory_filename);
+		if (LLFile::isfile(binary_filename))
+		{
+			LL_INFOS("LLInventoryModel") << "Purging inventory cache file: " << binary_filename << LL_ENDL;
+			LLFile::remove(binary_filename);
+		}
+		// </FS>
+
 		inventory_filename.append(".gz");
 		if (LLFile::isfile(inventory_filename))
 		{
@@ -2427,6 +2496,15 @@ bool LLInventoryModel::loadSkeleton(
 			LLFile::remove(inventory_filename);
 		}
 
+		// <FS> Binary inventory cache
+		binary_filename = get_binary_cache_filename(inventory_filename);
+		if (LLFile::isfile(binary_filename))
+		{
+			LL_INFOS("LLInventoryModel") << "Purging library cache file: " << binary_filename << LL_ENDL;
+			LLFile::remove(binary_filename);
+		}
+		// </FS>
+
 		inventory_filename.append(".gz");
 		if (LLFile::isfile(inventory_filename))
 		{
@@ -2495,7 +2573,14 @@ bool LLInventoryModel::loadSkeleton(
 		const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
 		std::string gzip_filename(inventory_filename);
 		gzip_filename.append(".gz");
-		LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+		// <FS> Binary inventory cache
+		//LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+		bool is_cache_obsolete = false;
+		bool binary_cache_loaded = loadFromBinaryFile(get_binary_cache_filename(inventory_filename),
+													  categories, items, categories_to_update, is_cache_obsolete);
+		// The LLSD cache is only consulted when there is no usable binary one.
+		LLFILE* fp = binary_cache_loaded ? NULL : LLFile::fopen(gzip_filename, "rb");
+		// </FS>
 		bool remove_inventory_file = false;
 		if(fp)
 		{
@@ -2513,8 +2598,12 @@ bool LLInventoryModel::loadSkeleton(
 				LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
 			}
 		}
-		bool is_cache_obsolete = false;
-		if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		// <FS> Binary inventory cache
+		//bool is_cache_obsolete = false;
+		//if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		if (binary_cache_loaded
+			|| loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+		// </FS>
 		{
 			// We were able to find a cache of files. So, use what we
 			// found to generate a set of categories we should add. We
@@ -2736,6 +2825,11 @@ void LLInventoryModel::buildParentChildMap()
 	cat_array_t* catsp;
 	item_array_t* itemsp;
 	
+	// <FS> Hashed inventory indices
+	cats.reserve(mCategoryMap.size());
+	mParentChildCategoryTree.reserve(mCategoryMap.size() + 1);
+	mParentChildItemTree.reserve(mCategoryMap.size());
+	// </FS>
 	for(cat_map_t::iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
 	{
 		LLViewerInventoryCategory* cat = cit->second;
@@ -2743,14 +2837,20 @@ void LLInventoryModel::buildParentChildMap()
 		if (mParentChildCategoryTree.count(cat->getUUID()) == 0)
 		{
 			llassert_always(mCategoryLock[cat->getUUID()] == false);
-			catsp = new cat_array_t;
-			mParentChildCategoryTree[cat->getUUID()] = catsp;
+			// <FS> Hashed inventory indices
+			//catsp = new cat_array_t;
+			//mParentChildCategoryTree[cat->getUUID()] = catsp;
+			mParentChildCategoryTree[cat->getUUID()];
+			// </FS>
 		}
 		if (mParentChildItemTree.count(cat->getUUID()) == 0)
 		{
 			llassert_always(mItemLock[cat->getUUID()] == false);
-			itemsp = new item_array_t;
-			mParentChildItemTree[cat->getUUID()] = itemsp;
+			// <FS> Hashed inventory indices
+			//itemsp = new item_array_t;
+			//mParentChildItemTree[cat->getUUID()] = itemsp;
+			mParentChildItemTree[cat->getUUID()];
+			// </FS>
 		}
 	}
 
@@ -2760,8 +2860,11 @@ void LLInventoryModel::buildParentChildMap()
 	// the array, but whatever - it's not that much space.
 	if (mParentChildCategoryTree.count(LLUUID::null) == 0)
 	{
-		catsp = new cat_array_t;
-		mParentChildCategoryTree[LLUUID::null] = catsp;
+		// <FS> Hashed inventory indices
+		//catsp = new cat_array_t;
+		//mParentChildCategoryTree[LLUUID::null] = catsp;
+		mParentChildCategoryTree[LLUUID::null];
+		// </FS>
 	}
 
 	// Now we have a structure with all of the categories that we can
@@ -2936,7 +3039,7 @@ void LLInventoryModel::buildParentChildMap()
 	const LLUUID &agent_inv_root_id = gInventory.getRootFolderID();
 	if (agent_inv_root_id.notNull())
 	{
-		cat_array_t* catsp = get_ptr_in_map(mParentChildCategoryTree, agent_inv_root_id);
+		cat_array_t* catsp = findChildCategories(agent_inv_root_id);
 		if(catsp)
 		{
 			// *HACK - fix root inventory folder
@@ -2947,7 +3050,8 @@ void LLInventoryModel::buildParentChildMap()
 			for (parent_cat_map_t::const_iterator it = mParentChildCategoryTree.begin(),
 					 it_end = mParentChildCategoryTree.end(); it != it_end; ++it)
 			{
-				cat_array_t* cat_array = it->second;
+				//cat_array_t* cat_array = it->second;
+				const cat_array_t* cat_array = &it->second; // <FS/> Hashed inventory indices
 				for (cat_array_t::const_iterator cat_it = cat_array->begin(),
 						 cat_it_end = cat_array->end(); cat_it != cat_it_end; ++cat_it)
 					{
@@ -3315,6 +3419,139 @@ bool LLInventoryModel::saveToFile(const std::string& filename,
     return true;
 }
 
+// <FS> Binary inventory cache
+// static
+bool LLInventoryModel::loadFromBinaryFile(const std::string& filename,
+										  LLInventoryModel::cat_array_t& categories,
+										  LLInventoryModel::item_array_t& items,
+										  LLInventoryModel::changed_items_t& cats_to_update,
+										  bool& is_cache_obsolete)
+{
+	LLInventoryCacheFile cache_file;
+	LLInventoryCacheFile::ELoadResult result = cache_file.load(filename);
+	if (result == LLInventoryCacheFile::LOAD_NO_FILE)
+	{
+		return false;
+	}
+	LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+	if (result != LLInventoryCacheFile::LOAD_OK
+		|| cache_file.getCacheVersion() != sCurrentInvCacheVersion)
+	{
+		LL_WARNS(LOG_INV) << "Binary inventory cache is out of date or unreadable (" << (S32)result << "), removing" << LL_ENDL;
+		is_cache_obsolete = true;
+		LLFile::remove(filename);
+		return false;
+	}
+	is_cache_obsolete = false;
+
+	const S32 cat_count = cache_file.getCategoryCount();
+	categories.reserve(categories.size() + cat_count);
+	for (S32 i = 0; i < cat_count; ++i)
+	{
+		LLPointer<LLViewerInventoryCategory> inv_cat = new LLViewerInventoryCategory(cache_file.getCategoryOwner(i));
+		cache_file.getCategory(i, inv_cat);
+		inv_cat->setVersion(cache_file.getCategoryVersion(i));
+		categories.push_back(inv_cat);
+	}
+
+	// Allocation stays on this thread since LLInventoryObject reports to
+	// LLTrace; only decoding the records is spread over the pool.
+	const S32 item_count = cache_file.getItemCount();
+	item_array_t loaded_items(item_count);
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		loaded_items[i] = new LLViewerInventoryItem;
+	}
+	const S32 chunk_count = (item_count + INVENTORY_CACHE_LOAD_CHUNK - 1) / INVENTORY_CACHE_LOAD_CHUNK;
+	LLParallelFor::func_t load_chunk = [&](S32 chunk)
+	{
+		const S32 end = llmin(item_count, (chunk + 1) * INVENTORY_CACHE_LOAD_CHUNK);
+		for (S32 i = chunk * INVENTORY_CACHE_LOAD_CHUNK; i < end; ++i)
+		{
+			cache_file.getItem(i, loaded_items[i]);
+		}
+	};
+	LLParallelFor* pool = LLParallelFor::getShared();
+	if (pool)
+	{
+		pool->run(chunk_count, load_chunk);
+	}
+	else
+	{
+		for (S32 chunk = 0; chunk < chunk_count; ++chunk)
+		{
+			load_chunk(chunk);
+		}
+	}
+
+	items.reserve(items.size() + item_count);
+	for (S32 i = 0; i < item_count; ++i)
+	{
+		LLViewerInventoryItem* inv_item = loaded_items[i];
+		LLInventoryCacheFile::claimItemStrings(inv_item);
+		if (inv_item->getUUID().isNull())
+		{
+			LL_WARNS(LOG_INV) << "Ignoring inventory with null item id: "
+				<< inv_item->getName() << LL_ENDL;
+		}
+		else if (inv_item->getType() == LLAssetType::AT_UNKNOWN)
+		{
+			cats_to_update.insert(inv_item->getParentUUID());
+		}
+		else
+		{
+			items.push_back(inv_item);
+		}
+	}
+
+	return true;
+}
+
+// static
+bool LLInventoryModel::saveToBinaryFile(const std::string& filename,
+										const cat_array_t& categories,
+										const item_array_t& items)
+{
+	if (filename.empty())
+	{
+		LL_ERRS(LOG_INV) << "Filename is Null!" << LL_ENDL;
+		return false;
+	}
+
+	LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+
+	LLInventoryCacheFile cache_file;
+	cache_file.setCacheVersion(sCurrentInvCacheVersion);
+	cache_file.reserve(categories.size(), items.size());
+
+	S32 cat_count = 0;
+	for (S32 i = 0, count = categories.size(); i < count; ++i)
+	{
+		LLViewerInventoryCategory* cat = categories[i];
+		if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+		{
+			cache_file.addCategory(cat, cat->getOwnerID(), cat->getVersion());
+			cat_count++;
+		}
+	}
+	S32 it_count = items.size();
+	for (S32 i = 0; i < it_count; ++i)
+	{
+		cache_file.addItem(items[i]);
+	}
+
+	if (!cache_file.save(filename))
+	{
+		LL_WARNS(LOG_INV) << "Unable to save inventory to: " << filename << LL_ENDL;
+		return false;
+	}
+
+	LL_INFOS(LOG_INV) << "Inventory saved: " << cat_count << " categories, " << it_count << " items." << LL_ENDL;
+	return true;
+}
+// </FS>
+
 // message handling functionality
 // static
 void LLInventoryModel::registerCallbacks(LLMessageSystem* msg)
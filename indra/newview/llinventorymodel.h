@@ -31,6 +31,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include <boost/unordered_map.hpp> // <FS/> Hashed inventory indices
 
 #include "llassettype.h"
 #include "llfoldertype.h"
@@ -210,19 +211,34 @@ private:
 	// the inventory using several different identifiers.
 	// mInventory member data is the 'master' list of inventory, and
 	// mCategoryMap and mItemMap store uuid->object mappings. 
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
-	typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+	// <FS> Hashed inventory indices
+	//typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
+	//typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+	typedef boost::unordered_map<LLUUID, LLPointer<LLViewerInventoryCategory>, FSUUIDHash> cat_map_t;
+	typedef boost::unordered_map<LLUUID, LLPointer<LLViewerInventoryItem>, FSUUIDHash> item_map_t;
+	// </FS>
 	cat_map_t mCategoryMap;
 	item_map_t mItemMap;
 	// This last set of indices is used to map parents to children.
-	typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
-	typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+	// <FS> Hashed inventory indices
+	// The child arrays live in the map nodes rather than on the heap.
+	// boost::unordered_map never moves its nodes, so the pointers handed
+	// out by getDirectDescendentsOf() stay valid until the folder itself
+	// is removed, same as before.
+	//typedef std::map<LLUUID, cat_array_t*> parent_cat_map_t;
+	//typedef std::map<LLUUID, item_array_t*> parent_item_map_t;
+	typedef boost::unordered_map<LLUUID, cat_array_t, FSUUIDHash> parent_cat_map_t;
+	typedef boost::unordered_map<LLUUID, item_array_t, FSUUIDHash> parent_item_map_t;
+	cat_array_t* findChildCategories(const LLUUID& cat_id) const;
+	item_array_t* findChildItems(const LLUUID& cat_id) const;
+	// </FS>
 	parent_cat_map_t mParentChildCategoryTree;
 	parent_item_map_t mParentChildItemTree;
 
 	// Track links to items and categories. We do not store item or
 	// category pointers here, because broken links are also supported.
-	typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
+	//typedef std::multimap<LLUUID, LLUUID> backlink_mmap_t;
+	typedef boost::unordered_multimap<LLUUID, LLUUID, FSUUIDHash> backlink_mmap_t; // <FS/> Hashed inventory indices
 	backlink_mmap_t mBacklinkMMap; // key = target_id: ID of item, values = link_ids: IDs of item or folder links referencing it.
 	// For internal use only
 	bool hasBacklinkInfo(const LLUUID& link_id, const LLUUID& target_id) const;
@@ -712,6 +728,16 @@ protected:
 	static bool saveToFile(const std::string& filename,
 						   const cat_array_t& categories,
 						   const item_array_t& items); 
+	// <FS> Binary inventory cache
+	static bool loadFromBinaryFile(const std::string& filename,
+								   cat_array_t& categories,
+								   item_array_t& items,
+								   changed_items_t& cats_to_update,
+								   bool& is_cache_obsolete);
+	static bool saveToBinaryFile(const std::string& filename,
+								 const cat_array_t& categories,
+								 const item_array_t& items);
+	// </FS>
 
 	//--------------------------------------------------------------------
 	// Message handling functionality
@@ -746,8 +772,12 @@ protected:
 	cat_array_t* getUnlockedCatArray(const LLUUID& id);
 	item_array_t* getUnlockedItemArray(const LLUUID& id);
 private:
-	std::map<LLUUID, bool> mCategoryLock;
-	std::map<LLUUID, bool> mItemLock;
+	// <FS> Hashed inventory indices
+	//std::map<LLUUID, bool> mCategoryLock;
+	//std::map<LLUUID, bool> mItemLock;
+	boost::unordered_map<LLUUID, bool, FSUUIDHash> mCategoryLock;
+	boost::unordered_map<LLUUID, bool, FSUUIDHash> mItemLock;
+	// </FS>
 	
 	//--------------------------------------------------------------------
 	// Debugging
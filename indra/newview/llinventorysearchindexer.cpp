@@ -0,0 +1,319 @@
+/**
+ * @file llinventorysearchindexer.cpp
+ * @brief Keeps an inventory search index up to date on a worker thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorysearchindexer.h"
+
+#include "llavatarnamecache.h"
+#include "llcallbacklist.h"
+#include "llviewerinventory.h"
+
+static LLTrace::BlockTimerStatHandle FTM_INVENTORY_INDEX_THREAD("Index Inventory (thread)");
+static LLTrace::BlockTimerStatHandle FTM_INVENTORY_INDEX_SNAPSHOT("Copy Inventory For Index");
+
+// Main thread time spent copying the login inventory, per frame.
+static const F32 SNAPSHOT_TIME_SLICE = 0.002f;
+// Requests the worker files per lock of the index.
+static const size_t INDEX_BATCH_SIZE = 512;
+
+LLInventorySearchIndexer* LLInventorySearchIndexer::sInstance = NULL;
+U32 LLInventorySearchIndexer::sRevision = 0;
+
+// static
+void LLInventorySearchIndexer::setEnabled(bool enable)
+{
+	if (enable && !sInstance && gInventory.isInventoryUsable())
+	{
+		sInstance = new LLInventorySearchIndexer();
+		gInventory.addObserver(sInstance);
+		sInstance->start();
+	}
+	else if (!enable && sInstance)
+	{
+		delete sInstance;
+	}
+}
+
+LLInventorySearchIndexer::LLInventorySearchIndexer()
+:	LLThread("Inventory Search Index"),
+	mSnapshotPos(0),
+	mSnapshotSequence(0),
+	mNextSequence(0),
+	mRetiredSequence(0),
+	mReady(false),
+	mAppliedSequence(0)
+{
+	mMutex = new LLMutex();
+
+	LLInventoryModel::cat_array_t cats;
+	gInventory.collectDescendents(gInventory.getRootFolderID(), cats, mSnapshot, LLInventoryModel::INCLUDE_TRASH);
+	gInventory.collectDescendents(gInventory.getLibraryRootFolderID(), cats, mSnapshot, LLInventoryModel::INCLUDE_TRASH);
+
+	gIdleCallbacks.addFunction(onIdle, this);
+}
+
+LLInventorySearchIndexer::~LLInventorySearchIndexer()
+{
+	gIdleCallbacks.deleteFunction(onIdle, this);
+	gInventory.removeObserver(this);
+
+	shutdown();
+	mQueue.clear();
+	delete mMutex;
+	mMutex = NULL;
+
+	if (sInstance == this)
+	{
+		sInstance = NULL;
+	}
+	++sRevision;
+}
+
+bool LLInventorySearchIndexer::isPending(const LLUUID& id) const
+{
+	return mPending.find(id) != mPending.end();
+}
+
+void LLInventorySearchIndexer::find(const std::string& substring, U32 field_mask, LLInventorySearchIndex::id_set_t& ids)
+{
+	LLInventorySearchIndex::creator_name_map_t names;
+	if (field_mask & LLInventorySearchIndex::FIELD_CREATOR)
+	{
+		uuid_vec_t creators;
+		{
+			LLMutexLock lock(mMutex);
+			mIndex.getCreators(creators);
+		}
+		// same lookup as LLInvFVBridge::getSearchableCreatorName()
+		LLAvatarName av_name;
+		for (uuid_vec_t::const_iterator it = creators.begin(); it != creators.end(); ++it)
+		{
+			if (it->isNull())
+			{
+				continue;
+			}
+			if (LLAvatarNameCache::get(*it, &av_name))
+			{
+				std::string& username = names[*it];
+				username = av_name.getUserName();
+				LLStringUtil::toUpper(username);
+			}
+			else if (mCreatorNameRequests.insert(*it).second)
+			{
+				// results computed without the name are stale once it arrives
+				LLAvatarNameCache::get(*it, boost::bind(&LLInventorySearchIndexer::onCreatorName, _1));
+			}
+		}
+	}
+
+	LLMutexLock lock(mMutex);
+	mIndex.find(substring, field_mask, ids, &names);
+}
+
+// static
+void LLInventorySearchIndexer::onCreatorName(const LLUUID& id)
+{
+	if (sInstance)
+	{
+		sInstance->mCreatorNameRequests.erase(id);
+	}
+	++sRevision;
+}
+
+void LLInventorySearchIndexer::changed(U32 mask)
+{
+	if (!(mask & (LABEL | INTERNAL | ADD | REMOVE | REBUILD)))
+	{
+		return;
+	}
+
+	const LLInventoryModel::changed_items_t& changed_ids = gInventory.getChangedIDs();
+	for (LLInventoryModel::changed_items_t::const_iterator it = changed_ids.begin(); it != changed_ids.end(); ++it)
+	{
+		const LLUUID& id = *it;
+		if (id.isNull() || gInventory.getCategory(id))
+		{
+			continue;
+		}
+		queueItem(id);
+
+		// links show the name and description of what they point at
+		const LLViewerInventoryItem* item = gInventory.getItem(id);
+		if (!item || !item->getIsLinkType())
+		{
+			LLInventoryModel::item_array_t links = gInventory.collectLinksTo(id);
+			for (LLInventoryModel::item_array_t::const_iterator link_it = links.begin(); link_it != links.end(); ++link_it)
+			{
+				queueItem((*link_it)->getUUID());
+			}
+		}
+	}
+	wake();
+}
+
+void LLInventorySearchIndexer::queueItem(const LLUUID& id)
+{
+	Request req;
+	req.mSequence = ++mNextSequence;
+	req.mEntry.mID = id;
+
+	// the same accessors the folder view bridges search through
+	const LLViewerInventoryItem* item = gInventory.getItem(id);
+	req.mRemove = (item == NULL);
+	if (item)
+	{
+		req.mEntry.mName = item->getName();
+		req.mEntry.mDescription = item->getDescription();
+		req.mEntry.mCreatorID = item->getCreatorUUID();
+		req.mEntry.mAssetID = item->getAssetUUID();
+	}
+
+	if (mSnapshotPos >= mSnapshot.size())
+	{
+		mPending[id] = req.mSequence;
+	}
+
+	LLMutexLock lock(mMutex);
+	mQueue.push_back(req);
+}
+
+// static
+void LLInventorySearchIndexer::onIdle(void* user_data)
+{
+	LLInventorySearchIndexer* self = (LLInventorySearchIndexer*)user_data;
+	self->snapshotItems();
+	self->retirePending();
+}
+
+void LLInventorySearchIndexer::snapshotItems()
+{
+	if (mSnapshotPos >= mSnapshot.size())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_INVENTORY_INDEX_SNAPSHOT);
+
+	LLTimer timer;
+	while (mSnapshotPos < mSnapshot.size() && timer.getElapsedTimeF32() < SNAPSHOT_TIME_SLICE)
+	{
+		// items deleted since login are queued as removals, which is harmless
+		queueItem(mSnapshot[mSnapshotPos++]->getUUID());
+	}
+	mSnapshotSequence = mNextSequence;
+
+	if (mSnapshotPos >= mSnapshot.size())
+	{
+		LLInventoryModel::item_array_t().swap(mSnapshot);
+		mSnapshotPos = 0;
+	}
+	wake();
+}
+
+void LLInventorySearchIndexer::retirePending()
+{
+	U32 applied;
+	S32 size;
+	{
+		LLMutexLock lock(mMutex);
+		applied = mAppliedSequence;
+		size = mIndex.size();
+	}
+
+	if (applied != mRetiredSequence)
+	{
+		mRetiredSequence = applied;
+		for (boost::unordered_map<LLUUID, U32, FSUUIDHash>::iterator it = mPending.begin(); it != mPending.end(); )
+		{
+			if (it->second <= applied)
+			{
+				it = mPending.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		++sRevision;
+	}
+
+	if (!mReady && mSnapshot.empty() && applied >= mSnapshotSequence)
+	{
+		LL_INFOS("Inventory") << "Search index holds " << size << " items" << LL_ENDL;
+		mReady = true;
+		++sRevision;
+	}
+}
+
+bool LLInventorySearchIndexer::runCondition()
+{
+	LLMutexLock lock(mMutex);
+	return !mQueue.empty();
+}
+
+void LLInventorySearchIndexer::run()
+{
+	std::vector<Request> batch;
+	while (!isQuitting())
+	{
+		checkPause();
+
+		{
+			LLMutexLock lock(mMutex);
+			if (isQuitting() || mQueue.empty())
+			{
+				continue;
+			}
+			size_t count = llmin(mQueue.size(), INDEX_BATCH_SIZE);
+			batch.assign(mQueue.begin(), mQueue.begin() + count);
+			mQueue.erase(mQueue.begin(), mQueue.begin() + count);
+		}
+
+		LL_RECORD_BLOCK_TIME(FTM_INVENTORY_INDEX_THREAD);
+
+		// upper case like LLInvFVBridge does, outside the lock
+		for (std::vector<Request>::iterator it = batch.begin(); it != batch.end(); ++it)
+		{
+			LLStringUtil::toUpper(it->mEntry.mName);
+			LLStringUtil::toUpper(it->mEntry.mDescription);
+		}
+
+		LLMutexLock lock(mMutex);
+		for (std::vector<Request>::const_iterator it = batch.begin(); it != batch.end(); ++it)
+		{
+			if (it->mRemove)
+			{
+				mIndex.remove(it->mEntry.mID);
+			}
+			else
+			{
+				mIndex.add(it->mEntry);
+			}
+		}
+		mAppliedSequence = batch.back().mSequence;
+	}
+}
@@ -0,0 +1,116 @@
+/**
+ * @file llinventorysearchindexer.h
+ * @brief Keeps an inventory search index up to date on a worker thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYSEARCHINDEXER_H
+#define LL_LLINVENTORYSEARCHINDEXER_H
+
+#include <deque>
+
+#include "llinventorymodel.h"
+#include "llinventoryobserver.h"
+#include "llinventorysearchindex.h"
+#include "llthread.h"
+
+/**
+ * @class LLInventorySearchIndexer
+ * @brief Indexes the items of gInventory for LLInventoryFilter.
+ *
+ * The item text is copied on the main thread, a time slice per frame, and
+ * handed to a worker that upper cases it and files it in an
+ * LLInventorySearchIndex.  Afterwards the indexer follows gInventory as an
+ * observer, so renamed, added and removed items (and links to changed
+ * items) are queued the same way.  Items whose latest change hasn't reached
+ * the index yet are reported as pending; callers must treat those as
+ * possible matches.
+ *
+ * Like any other observer the indexer is deleted by
+ * LLInventoryModel::cleanupInventory() if it's still registered then.
+ */
+class LLInventorySearchIndexer : public LLThread, public LLInventoryObserver
+{
+public:
+	// MAIN THREAD
+	// Starts indexing once the inventory skeleton is in place, or stops.
+	static void setEnabled(bool enable);
+	// NULL when disabled or logged out.
+	static LLInventorySearchIndexer* getInstance() { return sInstance; }
+	// Bumped whenever an indexer's results may have changed.
+	static U32 getRevision() { return sRevision; }
+
+	LLInventorySearchIndexer();
+	/*virtual*/ ~LLInventorySearchIndexer();
+
+	// MAIN THREAD
+	// True once every item present at login went through the index.
+	bool isReady() const { return mReady; }
+	bool isPending(const LLUUID& id) const;
+	// Ids of the items with substring (upper case) in the fields of
+	// field_mask, LLInventorySearchIndex::FIELD_CREATOR going by the
+	// creator names LLAvatarNameCache knows right now.  The revision is
+	// bumped when one of the names it didn't know yet arrives.
+	void find(const std::string& substring, U32 field_mask, LLInventorySearchIndex::id_set_t& ids);
+
+	/*virtual*/ void changed(U32 mask);
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	struct Request
+	{
+		bool							mRemove;
+		U32								mSequence;
+		LLInventorySearchIndex::Entry	mEntry;
+	};
+
+	static void onIdle(void* user_data);
+	static void onCreatorName(const LLUUID& id);
+	void snapshotItems();
+	void retirePending();
+	void queueItem(const LLUUID& id);
+
+	static LLInventorySearchIndexer* sInstance;
+	static U32 sRevision;
+
+	// MAIN THREAD only
+	LLInventoryModel::item_array_t mSnapshot;	// items still to be copied at startup
+	size_t				mSnapshotPos;
+	U32					mSnapshotSequence;		// last request of the startup copy
+	U32					mNextSequence;
+	U32					mRetiredSequence;
+	bool				mReady;
+	boost::unordered_map<LLUUID, U32, FSUUIDHash> mPending;	// id -> sequence of its latest request
+	uuid_set_t			mCreatorNameRequests;	// creator names find() is waiting for
+
+	// guarded by mMutex
+	LLMutex*			mMutex;
+	std::deque<Request>	mQueue;
+	LLInventorySearchIndex mIndex;
+	U32					mAppliedSequence;
+};
+
+#endif // LL_LLINVENTORYSEARCHINDEXER_H
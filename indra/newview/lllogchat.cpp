@@ -41,6 +41,10 @@
 // </FS:CR>
 #include "llinstantmessage.h"
 #include "llsingleton.h" // for LLSingleton
+// <FS> Indexed transcripts
+#include "lltranscriptindex.h"
+#include "lltranscriptsearchthread.h"
+// </FS>
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -294,6 +298,10 @@ LLLogChatTimeScanner::LLLogChatTimeScanner()
 
 LLLogChat::LLLogChat()
 : mSaveHistorySignal(NULL) // only needed in preferences
+// <FS> Indexed transcripts
+, mTranscriptSearchThread(NULL)
+, mLastTranscriptSearch(0)
+// </FS>
 {
     mHistoryThreadsMutex = new LLMutex();
 }
@@ -303,6 +311,11 @@ LLLogChat::~LLLogChat()
     delete mHistoryThreadsMutex;
     mHistoryThreadsMutex = NULL;
 
+    // <FS> Indexed transcripts
+    delete mTranscriptSearchThread;
+    mTranscriptSearchThread = NULL;
+    // </FS>
+
     if (mSaveHistorySignal)
     {
         mSaveHistorySignal->disconnect_all_slots();
@@ -371,6 +384,7 @@ void LLLogChat::renameLogFile(const std::string& old_filename, const std::string
     if (!LLFile::isfile(new_name) && LLFile::isfile(old_name))
     {
         LLFile::rename(old_name, new_name);
+        LLTranscriptIndex::removeIndex(old_name); // <FS/> Indexed transcripts
     }
 }
 
@@ -443,7 +457,11 @@ void LLLogChat::saveHistory(const std::string& filename,
 		return;
 	}
 	
-	llofstream file(LLLogChat::makeLogFileName(filename).c_str(), std::ios_base::app);
+	// <FS> Indexed transcripts
+	//llofstream file(LLLogChat::makeLogFileName(filename).c_str(), std::ios_base::app);
+	std::string log_file_name = LLLogChat::makeLogFileName(filename);
+	llofstream file(log_file_name.c_str(), std::ios_base::app);
+	// </FS>
 	if (!file.is_open())
 	{
 		LL_WARNS() << "Couldn't open chat history log! - " + filename << LL_ENDL;
@@ -472,6 +490,10 @@ void LLLogChat::saveHistory(const std::string& filename,
 
 	file.close();
 
+	// <FS> Indexed transcripts: only the line just written is read
+	LLTranscriptIndex(log_file_name, gSavedSettings.getBOOL("FSIndexTranscriptWords")).update();
+	// </FS>
+
 	LLLogChat::getInstance()->triggerHistorySignal();
 }
 
@@ -568,6 +590,77 @@ void LLLogChat::loadChatHistory(const std::string& file_name, std::list<LLSD>& m
 	fclose(fptr);
 }
 
+// <FS> Indexed transcripts
+// static
+void LLLogChat::parseTranscriptMessage(const std::string& raw, LLSD& im, const LLSD& parse_params)
+{
+	std::string::size_type end = raw.find('\n');
+	std::string line = raw.substr(0, end);
+	if (!LLChatLogParser::parse(line, im, parse_params))
+	{
+		im[LL_IM_TEXT] = line;
+	}
+
+	// the same rules as loadChatHistory() for the lines that continue a message
+	while (end != std::string::npos)
+	{
+		std::string::size_type start = end + 1;
+		end = raw.find('\n', start);
+		line = raw.substr(start, end == std::string::npos ? std::string::npos : end - start);
+		if (!line.empty() && '\r' == line[line.length() - 1])
+		{
+			line.erase(line.length() - 1);
+		}
+		if (line.empty())
+		{
+			im[LL_IM_TEXT] = im[LL_IM_TEXT].asString() + '\n';
+		}
+		else
+		{
+			line.erase(0, MULTI_LINE_PREFIX.length());
+			im[LL_IM_TEXT] = im[LL_IM_TEXT].asString() + '\n' + line;
+		}
+	}
+}
+
+U32 LLLogChat::searchTranscripts(const std::vector<std::string>& file_names, const std::string& text)
+{
+	if (!mTranscriptSearchThread)
+	{
+		mTranscriptSearchThread = new LLTranscriptSearchThread();
+		mTranscriptSearchThread->start();
+	}
+
+	LLTranscriptSearchThread::Request request;
+	request.mID = ++mLastTranscriptSearch;
+	request.mText = text;
+	request.mFileNames = file_names;
+	request.mPaths.reserve(file_names.size());
+	for (std::vector<std::string>::const_iterator it = file_names.begin(); it != file_names.end(); ++it)
+	{
+		request.mPaths.push_back(makeLogFileName(*it));
+	}
+	mTranscriptSearchThread->post(request);
+	return request.mID;
+}
+
+bool LLLogChat::getTranscriptSearchResult(U32 search_id, std::set<std::string>& file_names)
+{
+	bool found = false;
+	LLTranscriptSearchThread::Result result;
+	while (mTranscriptSearchThread && mTranscriptSearchThread->getResult(result))
+	{
+		// results of searches nobody waits for any more are dropped
+		if (result.mID == search_id)
+		{
+			file_names.swap(result.mFileNames);
+			found = true;
+		}
+	}
+	return found;
+}
+// </FS>
+
 bool LLLogChat::historyThreadsFinished(LLUUID session_id)
 {
 	LLMutexLock lock(historyThreadsMutex());
@@ -785,6 +878,7 @@ bool LLLogChat::moveTranscripts(const std::string originDirectory,
 
 			//Rename the file to its backup name so it is not overwritten
 			LLFile::rename(newFullPath, backupFileName);
+			LLTranscriptIndex::removeIndex(newFullPath); // <FS/> Indexed transcripts
 		}
 
 		S32 retry_count = 0;
@@ -803,6 +897,8 @@ bool LLLogChat::moveTranscripts(const std::string originDirectory,
 			else
 			{
 				listOfFilesMoved.push_back(newFullPath);
+				// <FS/> Indexed transcripts: built again where the transcript is now
+				LLTranscriptIndex::removeIndex(fullpath);
 
 				if (retry_count)
 				{
@@ -863,6 +959,7 @@ void LLLogChat::deleteTranscripts()
 				{
 					LL_WARNS("LLLogChat::deleteTranscripts") << "Successfully removed " << fullpath << LL_ENDL;
 				}
+				LLTranscriptIndex::removeIndex(fullpath); // <FS/> Indexed transcripts
 				break;
 			}			
 		}
@@ -29,6 +29,7 @@
 #include "llthread.h"
 
 class LLChat;
+class LLTranscriptSearchThread; // <FS/> Indexed transcripts
 
 class LLActionThread : public LLThread
 {
@@ -109,6 +110,18 @@ public:
 
 	static void loadChatHistory(const std::string& file_name, std::list<LLSD>& messages, const LLSD& load_params = LLSD(), bool is_group = false);
 
+	// <FS> Indexed transcripts
+	// One message as LLTranscriptIndex::readMessages() returns it, continuation lines included
+	static void parseTranscriptMessage(const std::string& raw, LLSD& im, const LLSD& parse_params = LLSD());
+	// Looks for messages containing every word of text in the transcripts
+	// on a worker thread, through their word index.  Returns the id to ask
+	// getTranscriptSearchResult() for.  Only the newest search is finished,
+	// older ones still waiting are dropped.
+	U32 searchTranscripts(const std::vector<std::string>& file_names, const std::string& text);
+	// True once the search is done, with the file names that matched.
+	bool getTranscriptSearchResult(U32 search_id, std::set<std::string>& file_names);
+	// </FS>
+
 	typedef boost::signals2::signal<void ()> save_history_signal_t;
 	boost::signals2::connection setSaveHistorySignal(const save_history_signal_t::slot_type& cb);
 
@@ -143,6 +156,11 @@ private:
 	std::map<LLUUID,LLLoadHistoryThread *> mLoadHistoryThreads;
 	std::map<LLUUID,LLDeleteHistoryThread *> mDeleteHistoryThreads;
 	LLMutex* mHistoryThreadsMutex;
+
+	// <FS> Indexed transcripts
+	LLTranscriptSearchThread* mTranscriptSearchThread;
+	U32 mLastTranscriptSearch;
+	// </FS>
 };
 
 /**
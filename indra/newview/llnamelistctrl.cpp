@@ -229,7 +229,11 @@ BOOL LLNameListCtrl::handleToolTip(S32 x, S32 y, MASK mask)
 {
 	BOOL handled = FALSE;
 	S32 column_index = getColumnIndexFromOffset(x);
-	LLNameListItem* hit_item = dynamic_cast<LLNameListItem*>(hitItem(x, y));
+	// <FS> Rows of a virtual list are plain scroll list items
+	//LLNameListItem* hit_item = dynamic_cast<LLNameListItem*>(hitItem(x, y));
+	LLScrollListItem* hit_item = hitItem(x, y);
+	LLNameListItem* name_item = dynamic_cast<LLNameListItem*>(hit_item);
+	// </FS>
 	LLFloater* floater = gFloaterView->getParentFloater(this);
 
 
@@ -239,7 +243,8 @@ BOOL LLNameListCtrl::handleToolTip(S32 x, S32 y, MASK mask)
 		&& ((column_index == mNameColumnIndex) || isSpecialType()))
 	{
         // ...this is the column with the avatar name
-		LLUUID item_id = isSpecialType() ? hit_item->getSpecialID() : hit_item->getUUID();
+		// <FS/> Rows of a virtual list are plain scroll list items
+		LLUUID item_id = (isSpecialType() && name_item) ? name_item->getSpecialID() : hit_item->getUUID();
 		if (item_id.notNull())
 		{
 			// ...valid avatar id
@@ -263,8 +268,12 @@ BOOL LLNameListCtrl::handleToolTip(S32 x, S32 y, MASK mask)
 				if (!snapshot_floatr || !snapshot_floatr->getRect().pointInRect(screenX + icon->getWidth(), screenY))
 				{
 					// Should we show a group or an avatar inspector?
-					bool is_group = hit_item->isGroup();
-					bool is_experience = hit_item->isExperience();
+					// <FS> Rows of a virtual list are plain scroll list items
+					//bool is_group = hit_item->isGroup();
+					//bool is_experience = hit_item->isExperience();
+					bool is_group = name_item && name_item->isGroup();
+					bool is_experience = name_item && name_item->isExperience();
+					// </FS>
 
 					LLToolTip::Params params;
 					params.background_visible(false);
@@ -813,17 +813,20 @@ LLPanelGroupMembersSubTab::LLPanelGroupMembersSubTab()
 
 LLPanelGroupMembersSubTab::~LLPanelGroupMembersSubTab()
 {
-	for (avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.begin(); it != mAvatarNameCacheConnections.end(); ++it)
-	{
-		if (it->second.connected())
-		{
-			it->second.disconnect();
-		}
-	}
-	mAvatarNameCacheConnections.clear();
+	// <FS> Members are rows of a virtual list
+	//for (avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.begin(); it != mAvatarNameCacheConnections.end(); ++it)
+	//{
+	//	if (it->second.connected())
+	//	{
+	//		it->second.disconnect();
+	//	}
+	//}
+	//mAvatarNameCacheConnections.clear();
+	// </FS>
 	if (mMembersList)
 	{
 		gSavedSettings.setString("GroupMembersSortOrder", mMembersList->getSortColumnName());
+		mMembersList->setDataSource(NULL); // <FS/> Members are rows of a virtual list
 	}
 }
 
@@ -873,6 +876,7 @@ BOOL LLPanelGroupMembersSubTab::postBuildSubTab(LLView* root)
 	{
 		mMembersList->sortByColumn(order_by, TRUE);
 	}	
+	mMembersList->setDataSource(&mMemberIndex); // <FS/> Members are rows of a virtual list
 
 	LLButton* button = parent->getChild<LLButton>("member_invite", recurse);
 	if ( button )
@@ -909,7 +913,12 @@ BOOL LLPanelGroupMembersSubTab::postBuildSubTab(LLView* root)
 void LLPanelGroupMembersSubTab::setGroupID(const LLUUID& id)
 {
 	//clear members list
-	if(mMembersList) mMembersList->deleteAllItems();
+	// <FS> Members are rows of a virtual list; deleting all items would let go of the index
+	//if(mMembersList) mMembersList->deleteAllItems();
+	mMemberIndex.clear();
+	mMemberIndexVersion.setNull();
+	if(mMembersList) mMembersList->refreshDataSource();
+	// </FS>
 	if(mAssignedRolesList) mAssignedRolesList->deleteAllItems();
 	if(mAllowedActionsList) mAllowedActionsList->deleteAllItems();
 
@@ -1250,7 +1259,11 @@ void LLPanelGroupMembersSubTab::handleEjectMembers()
 		selected_members.push_back( member_id );
 	}
 
-	mMembersList->deleteSelectedItems();
+	// <FS> Members are rows of a virtual list
+	//mMembersList->deleteSelectedItems();
+	mMemberIndex.removeMembers(selected_members);
+	mMembersList->refreshDataSource();
+	// </FS>
 
 	sendEjectNotifications(mGroupID, selected_members);
 
@@ -1717,7 +1730,24 @@ void LLPanelGroupMembersSubTab::update(LLGroupChange gc)
 		&& gdatap->isRoleDataComplete()
 		&& gdatap->isRoleMemberDataComplete())
 	{
-		mMemberProgress = gdatap->mMembers.begin();
+		// <FS> Members are rows of a virtual list
+		//mMemberProgress = gdatap->mMembers.begin();
+		bool rows_changed = false;
+		if (mMemberIndexVersion != gdatap->getMemberVersion())
+		{
+			// a new member list, file every member again
+			mMemberIndex.setDonationFormat(getString("donation_area"));
+			mMemberIndex.setGroup(gdatap);
+			mMemberIndexVersion = gdatap->getMemberVersion();
+			rows_changed = true;
+		}
+		// a filter change only picks other rows from the sorted members
+		rows_changed |= mMemberIndex.setFilter(mSearchFilter);
+		if (rows_changed)
+		{
+			mMembersList->refreshDataSource();
+		}
+		// </FS>
 		mPendingMemberUpdate = TRUE;
 		mHasMatch = FALSE;
 	}
@@ -1753,64 +1783,66 @@ void LLPanelGroupMembersSubTab::update(LLGroupChange gc)
 	}
 }
 
-void LLPanelGroupMembersSubTab::addMemberToList(LLGroupMemberData* data)
-{
-	if (!data) return;
-	LLUIString donated = getString("donation_area");
-	donated.setArg("[AREA]", llformat("%d", data->getContribution()));
-
-	LLNameListCtrl::NameItem item_params;
-	item_params.value = data->getID();
-
-	item_params.columns.add().column("name").font.name("SANSSERIF_SMALL").style("NORMAL");
-
-	item_params.columns.add().column("donated").value(donated.getString())
-			.font.name("SANSSERIF_SMALL").style("NORMAL");
-
-	item_params.columns.add().column("online").value(data->getOnlineStatus())
-			.font.name("SANSSERIF_SMALL").style("NORMAL");
-
-	item_params.columns.add().column("title").value(data->getTitle()).font.name("SANSSERIF_SMALL").style("NORMAL");;
-
-	mMembersList->addNameItemRow(item_params);
-
-	mHasMatch = TRUE;
-}
-
-void LLPanelGroupMembersSubTab::onNameCache(const LLUUID& update_id, LLGroupMemberData* member, const LLAvatarName& av_name, const LLUUID& av_id)
-{
-	avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.find(av_id);
-	if (it != mAvatarNameCacheConnections.end())
-	{
-		if (it->second.connected())
-		{
-			it->second.disconnect();
-		}
-		mAvatarNameCacheConnections.erase(it);
-	}
-
-	LLGroupMgrGroupData* gdatap = LLGroupMgr::getInstance()->getGroupData(mGroupID);
-	if (!gdatap
-		|| gdatap->getMemberVersion() != update_id
-		|| !member)
-	{
-		return;
-	}
-	
-	// trying to avoid unnecessary hash lookups
-	// <FS:CR> FIRE-11350
-	//if (matchesSearchFilter(av_name.getAccountName()))
-	if (matchesSearchFilter(av_name.getCompleteName()))
-	// </FS:CR>
-	{
-		addMemberToList(member);
-		if(!mMembersList->getEnabled())
-		{
-			mMembersList->setEnabled(TRUE);
-		}
-	}
-	
-}
+// <FS> Members are rows of a virtual list
+//void LLPanelGroupMembersSubTab::addMemberToList(LLGroupMemberData* data)
+//{
+//	if (!data) return;
+//	LLUIString donated = getString("donation_area");
+//	donated.setArg("[AREA]", llformat("%d", data->getContribution()));
+//
+//	LLNameListCtrl::NameItem item_params;
+//	item_params.value = data->getID();
+//
+//	item_params.columns.add().column("name").font.name("SANSSERIF_SMALL").style("NORMAL");
+//
+//	item_params.columns.add().column("donated").value(donated.getString())
+//			.font.name("SANSSERIF_SMALL").style("NORMAL");
+//
+//	item_params.columns.add().column("online").value(data->getOnlineStatus())
+//			.font.name("SANSSERIF_SMALL").style("NORMAL");
+//
+//	item_params.columns.add().column("title").value(data->getTitle()).font.name("SANSSERIF_SMALL").style("NORMAL");;
+//
+//	mMembersList->addNameItemRow(item_params);
+//
+//	mHasMatch = TRUE;
+//}
+//
+//void LLPanelGroupMembersSubTab::onNameCache(const LLUUID& update_id, LLGroupMemberData* member, const LLAvatarName& av_name, const LLUUID& av_id)
+//{
+//	avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.find(av_id);
+//	if (it != mAvatarNameCacheConnections.end())
+//	{
+//		if (it->second.connected())
+//		{
+//			it->second.disconnect();
+//		}
+//		mAvatarNameCacheConnections.erase(it);
+//	}
+//
+//	LLGroupMgrGroupData* gdatap = LLGroupMgr::getInstance()->getGroupData(mGroupID);
+//	if (!gdatap
+//		|| gdatap->getMemberVersion() != update_id
+//		|| !member)
+//	{
+//		return;
+//	}
+//	
+//	// trying to avoid unnecessary hash lookups
+//	// <FS:CR> FIRE-11350
+//	//if (matchesSearchFilter(av_name.getAccountName()))
+//	if (matchesSearchFilter(av_name.getCompleteName()))
+//	// </FS:CR>
+//	{
+//		addMemberToList(member);
+//		if(!mMembersList->getEnabled())
+//		{
+//			mMembersList->setEnabled(TRUE);
+//		}
+//	}
+//	
+//}
+// </FS>
 
 void LLPanelGroupMembersSubTab::updateMembers()
 {
@@ -1834,77 +1866,99 @@ void LLPanelGroupMembersSubTab::updateMembers()
 		return;
 	}
 
-	//cleanup list only for first iteration
-	if(mMemberProgress == gdatap->mMembers.begin())
+	// <FS> Members are rows of a virtual list
+	////cleanup list only for first iteration
+	//if(mMemberProgress == gdatap->mMembers.begin())
+	//{
+	//	mMembersList->deleteAllItems();
+	//}
+	//
+	//// <FS:Ansariel> Clear old callbacks so we don't end up adding people twice
+	//for (avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.begin(); it != mAvatarNameCacheConnections.end(); ++it)
+	//{
+	//	if (it->second.connected())
+	//	{
+	//		it->second.disconnect();
+	//	}
+	//}
+	//mAvatarNameCacheConnections.clear();
+	//// </FS:Ansariel>
+	//
+	//LLGroupMgrGroupData::member_list_t::iterator end = gdatap->mMembers.end();
+	//
+	//LLTimer update_time;
+	//update_time.setTimerExpirySec(UPDATE_MEMBERS_SECONDS_PER_FRAME);
+	//
+	//for( ; mMemberProgress != end && !update_time.hasExpired(); ++mMemberProgress)
+	//{
+	//	if (!mMemberProgress->second)
+	//		continue;
+	//
+	//	// Do filtering on name if it is already in the cache.
+	//	LLAvatarName av_name;
+	//	if (LLAvatarNameCache::get(mMemberProgress->first, &av_name))
+	//	{
+	//		// <FS:CR> FIRE-11350
+	//		//if (matchesSearchFilter(av_name.getAccountName()))
+	//		if (matchesSearchFilter(av_name.getCompleteName()))
+	//		// </FS:CR>
+	//		{
+	//			addMemberToList(mMemberProgress->second);
+	//		}
+	//	}
+	//	else
+	//	{
+	//		// If name is not cached, onNameCache() should be called when it is cached and add this member to list.
+	//		avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.find(mMemberProgress->first);
+	//		if (it != mAvatarNameCacheConnections.end())
+	//		{
+	//			if (it->second.connected())
+	//			{
+	//				it->second.disconnect();
+	//			}
+	//			mAvatarNameCacheConnections.erase(it);
+	//		}
+	//		mAvatarNameCacheConnections[mMemberProgress->first] = LLAvatarNameCache::get(mMemberProgress->first, boost::bind(&LLPanelGroupMembersSubTab::onNameCache, this, gdatap->getMemberVersion(), mMemberProgress->second, _2, _1));
+	//	}
+	//}
+	//
+	//if (mMemberProgress == end)
+	//{
+	//	if (mHasMatch)
+	//	{
+	//		mMembersList->setEnabled(TRUE);
+	//	}
+	//	else if (gdatap->mMembers.size()) 
+	//	{
+	//		mMembersList->setEnabled(FALSE);
+	//		mMembersList->setCommentText(std::string("No match."));
+	//	}
+	//}
+	//else
+	//{
+	//	mPendingMemberUpdate = TRUE;
+	//}
+	if (mMemberIndex.update(UPDATE_MEMBERS_SECONDS_PER_FRAME))
+	{
+		mMembersList->refreshDataSource();
+	}
+
+	mHasMatch = mMemberIndex.getRowCount() > 0;
+	if (mHasMatch)
+	{
+		mMembersList->setEnabled(TRUE);
+	}
+	else if (mMemberIndex.isComplete() && gdatap->mMembers.size())
 	{
-		mMembersList->deleteAllItems();
-	}
-
-	// <FS:Ansariel> Clear old callbacks so we don't end up adding people twice
-	for (avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.begin(); it != mAvatarNameCacheConnections.end(); ++it)
-	{
-		if (it->second.connected())
-		{
-			it->second.disconnect();
-		}
-	}
-	mAvatarNameCacheConnections.clear();
-	// </FS:Ansariel>
-
-	LLGroupMgrGroupData::member_list_t::iterator end = gdatap->mMembers.end();
-
-	LLTimer update_time;
-	update_time.setTimerExpirySec(UPDATE_MEMBERS_SECONDS_PER_FRAME);
-
-	for( ; mMemberProgress != end && !update_time.hasExpired(); ++mMemberProgress)
-	{
-		if (!mMemberProgress->second)
-			continue;
-
-		// Do filtering on name if it is already in the cache.
-		LLAvatarName av_name;
-		if (LLAvatarNameCache::get(mMemberProgress->first, &av_name))
-		{
-			// <FS:CR> FIRE-11350
-			//if (matchesSearchFilter(av_name.getAccountName()))
-			if (matchesSearchFilter(av_name.getCompleteName()))
-			// </FS:CR>
-			{
-				addMemberToList(mMemberProgress->second);
-			}
-		}
-		else
-		{
-			// If name is not cached, onNameCache() should be called when it is cached and add this member to list.
-			avatar_name_cache_connection_map_t::iterator it = mAvatarNameCacheConnections.find(mMemberProgress->first);
-			if (it != mAvatarNameCacheConnections.end())
-			{
-				if (it->second.connected())
-				{
-					it->second.disconnect();
-				}
-				mAvatarNameCacheConnections.erase(it);
-			}
-			mAvatarNameCacheConnections[mMemberProgress->first] = LLAvatarNameCache::get(mMemberProgress->first, boost::bind(&LLPanelGroupMembersSubTab::onNameCache, this, gdatap->getMemberVersion(), mMemberProgress->second, _2, _1));
-		}
+		mMembersList->setEnabled(FALSE);
+		mMembersList->setCommentText(std::string("No match."));
 	}
 
-	if (mMemberProgress == end)
-	{
-		if (mHasMatch)
-		{
-			mMembersList->setEnabled(TRUE);
-		}
-		else if (gdatap->mMembers.size()) 
-		{
-			mMembersList->setEnabled(FALSE);
-			mMembersList->setCommentText(std::string("No match."));
-		}
-	}
-	else
+	if (!mMemberIndex.isComplete())
 	{
 		mPendingMemberUpdate = TRUE;
 	}
+	// </FS>
 
 	// This should clear the other two lists, since nothing is selected.
 	handleMemberSelect();
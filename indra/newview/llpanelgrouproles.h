@@ -28,6 +28,7 @@
 #define LL_LLPANELGROUPROLES_H
 
 #include "llpanelgroup.h"
+#include "llgroupmemberindex.h" // <FS/> Members are rows of a virtual list
 
 class LLFilterEditor;
 class LLNameListCtrl;
@@ -206,8 +207,10 @@ public:
 
 	virtual void setGroupID(const LLUUID& id);
 
-	void addMemberToList(LLGroupMemberData* data);
-	void onNameCache(const LLUUID& update_id, LLGroupMemberData* member, const LLAvatarName& av_name, const LLUUID& av_id);
+	// <FS> Members are rows of a virtual list
+	//void addMemberToList(LLGroupMemberData* data);
+	//void onNameCache(const LLUUID& update_id, LLGroupMemberData* member, const LLAvatarName& av_name, const LLUUID& av_id);
+	// </FS>
 
 protected:
 	typedef std::map<LLUUID, LLRoleMemberChangeType> role_change_data_map_t;
@@ -235,9 +238,13 @@ protected:
 	member_role_changes_map_t mMemberRoleChangeData;
 	U32 mNumOwnerAdditions;
 
-	LLGroupMgrGroupData::member_list_t::iterator mMemberProgress;
-	typedef std::map<LLUUID, boost::signals2::connection> avatar_name_cache_connection_map_t;
-	avatar_name_cache_connection_map_t mAvatarNameCacheConnections;
+	// <FS> Members are rows of a virtual list
+	//LLGroupMgrGroupData::member_list_t::iterator mMemberProgress;
+	//typedef std::map<LLUUID, boost::signals2::connection> avatar_name_cache_connection_map_t;
+	//avatar_name_cache_connection_map_t mAvatarNameCacheConnections;
+	LLGroupMemberIndex mMemberIndex;
+	LLUUID mMemberIndexVersion;	// member version of the group in mMemberIndex
+	// </FS>
 	
 // [FS:CR] FIRE-12276
 private:
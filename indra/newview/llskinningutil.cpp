@@ -34,6 +34,8 @@
 #include "llvolume.h"
 #include "llrigginginfo.h"
 
+#include <boost/functional/hash.hpp>
+
 #define DEBUG_SKINNING  LL_DEBUG
 #define MAT_USE_SSE     1
 
@@ -369,6 +371,25 @@ void LLSkinningUtil::initJointNums(LLMeshSkinInfo* skin, LLVOAvatar *avatar)
             // insure we have *a* valid joint to reference
             llassert(skin->mJointNums[j] >= 0);
         }
+
+        // <FS> Shared skinning palettes: meshes with the same joints and
+        // inverse bind matrices (e.g. the pieces of a mesh body) can share
+        // one palette per avatar.
+        size_t hash = 0;
+        U32 count = getMeshJointCount(skin);
+        boost::hash_combine(hash, count);
+        for (U32 j = 0; j < count; ++j)
+        {
+            boost::hash_combine(hash, skin->mJointNums[j]);
+            const F32* m = &skin->mInvBindMatrix[j].mMatrix[0][0];
+            for (U32 k = 0; k < 16; ++k)
+            {
+                boost::hash_combine(hash, m[k]);
+            }
+        }
+        skin->mPaletteHash = hash;
+        // </FS>
+
         skin->mJointNumsInitialized = true;
     }
 }
@@ -40,6 +40,7 @@
 #include "llface.h"
 #include "llviewercamera.h"
 #include "llvector4a.h"
+#include "m3math.h"
 //<FS:Beq> needed to resolve render_hull dep
 #include "llmodel.h"
 //</FS:Beq>
@@ -660,10 +661,32 @@ class LLVolumeGeometryManager: public LLGeometryManager
 	U32 genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace** faces, U32 face_count, BOOL distance_sort = FALSE, BOOL batch_textures = FALSE, BOOL no_materials = FALSE);
 	void registerFace(LLSpatialGroup* group, LLFace* facep, U32 type);
 
+	// <FS> Parallel geometry fill
+	// 0 fills each face's vertex data inline in genDrawInfo(), -1 picks a
+	// worker count from the number of cores
+	static void setGeometryFillThreads(S32 thread_count);
+	static void cleanupClass();
+	// </FS>
+
 private:
 	void allocateFaces(U32 pMaxFaceCount);
 	void freeFaces();
 
+	// <FS> Parallel geometry fill
+	void fillGeometry();
+
+	struct GeometryFill
+	{
+		LLFace*		mFace;
+		LLVolume*	mVolume;
+		LLMatrix4	mMatVert;
+		LLMatrix3	mMatNormal;
+		U16			mIndexOffset;
+	};
+	static std::vector<GeometryFill> sGeometryFills;
+	static std::vector<LLPointer<LLVertexBuffer> > sFillBuffers;	// flushed once the fills are done
+	// </FS>
+
 	static int32_t sInstanceCount;
 	static LLFace** sFullbrightFaces;
 	static LLFace** sBumpFaces;
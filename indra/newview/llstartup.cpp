@@ -122,6 +122,7 @@
 #include "llinventorybridge.h"
 #include "llinventorymodel.h"
 #include "llinventorymodelbackgroundfetch.h"
+#include "llinventorysearchindexer.h" // <FS/> Inventory search index
 #include "llkeyboard.h"
 #include "llloginhandler.h"			// gLoginHandler, SLURL support
 #include "lllogininstance.h" // Host the login module.
@@ -2606,6 +2607,8 @@ bool idle_startup()
 		// INITIALIZE mask bit instead?
 		gInventory.addChangedMask(LLInventoryObserver::ALL, LLUUID::null);
 		gInventory.notifyObservers();
+
+		LLInventorySearchIndexer::setEnabled(gSavedSettings.getBOOL("InventorySearchIndex")); // <FS/> Inventory search index
 		
 		display_startup();
 
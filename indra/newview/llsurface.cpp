@@ -54,6 +54,7 @@
 #include "llglheaders.h"
 #include "lldrawpoolterrain.h"
 #include "lldrawable.h"
+#include "llparallelfor.h" // <FS/> Parallel terrain patch update
 
 extern LLPipeline gPipeline;
 extern bool gShiftFrame;
@@ -144,9 +145,51 @@ LLSurface::~LLSurface()
 	}
 }
 
+// <FS> Parallel terrain patch update
+static const S32 MAX_PATCH_UPDATE_THREADS = 8;
+// Below this many dirty patches the per-patch work is cheaper than waking the pool.
+static const S32 MIN_PATCHES_FOR_UPDATE_THREADS = 16;
+static LLParallelFor* sPatchUpdatePool = NULL;
+// </FS>
+
 void LLSurface::initClasses()
 {
+	setPatchUpdateThreads(gSavedSettings.getS32("TerrainPatchUpdateThreads")); // <FS/> Parallel terrain patch update
+}
+
+// <FS> Parallel terrain patch update
+//static
+void LLSurface::cleanupClass()
+{
+	delete sPatchUpdatePool;
+	sPatchUpdatePool = NULL;
+}
+
+//static
+void LLSurface::setPatchUpdateThreads(S32 thread_count)
+{
+	if (thread_count < 0)
+	{
+		thread_count = llmin(LLParallelFor::getDefaultWorkerCount(), MAX_PATCH_UPDATE_THREADS);
+	}
+	thread_count = llmin(thread_count, MAX_PATCH_UPDATE_THREADS);
+
+	if (thread_count == 0)
+	{
+		// patches are only updated inside idleUpdate(), nothing is in flight
+		delete sPatchUpdatePool;
+		sPatchUpdatePool = NULL;
+	}
+	else if (!sPatchUpdatePool)
+	{
+		sPatchUpdatePool = new LLParallelFor("TerrainPatchUpdate", thread_count);
+	}
+	else
+	{
+		sPatchUpdatePool->setWorkerCount(thread_count);
+	}
 }
+// </FS>
 
 void LLSurface::setRegion(LLViewerRegion *regionp)
 {
@@ -838,13 +881,55 @@ BOOL LLSurface::idleUpdate(F32 max_update_time)
 
 	// Always call updateNormals() / updateVerticalStats()
 	//  every frame to avoid artifacts
+	// <FS> Parallel terrain patch update
+	// Edge normals read and patch up heights across patch and region
+	// boundaries, so they run first and serially.  After that every patch's
+	// interior normals and height stats depend only on its own heights and
+	// are spread over the worker pool; the stats are then applied to the
+	// surface and region back on this thread.
+	if (!mDirtyPatchList.empty())
+	{
+		std::vector<LLSurfacePatch *> update_patches(mDirtyPatchList.begin(), mDirtyPatchList.end());
+		const S32 count = (S32)update_patches.size();
+
+		for (S32 i = 0; i < count; i++)
+		{
+			update_patches[i]->updateEdgeNormals();
+		}
+
+		auto update_patch = [&update_patches](S32 i)
+		{
+			update_patches[i]->updateMiddleNormals();
+			update_patches[i]->calcVerticalStats();
+		};
+		if (sPatchUpdatePool && count >= MIN_PATCHES_FOR_UPDATE_THREADS)
+		{
+			sPatchUpdatePool->run(count, update_patch);
+		}
+		else
+		{
+			for (S32 i = 0; i < count; i++)
+			{
+				update_patch(i);
+			}
+		}
+
+		for (S32 i = 0; i < count; i++)
+		{
+			update_patches[i]->applyVerticalStats();
+		}
+	}
+	// </FS>
+
 	for(std::set<LLSurfacePatch *>::iterator iter = mDirtyPatchList.begin();
 		iter != mDirtyPatchList.end(); )
 	{
 		std::set<LLSurfacePatch *>::iterator curiter = iter++;
 		LLSurfacePatch *patchp = *curiter;
-		patchp->updateNormals();
-		patchp->updateVerticalStats();
+		// <FS> Parallel terrain patch update
+		//patchp->updateNormals();
+		//patchp->updateVerticalStats();
+		// </FS>
 		if (max_update_time == 0.f || update_timer.getElapsedTimeF32() < max_update_time)
 		{
 			if (patchp->updateTexture())
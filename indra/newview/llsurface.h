@@ -70,6 +70,10 @@ public:
 	virtual ~LLSurface();
 
 	static void initClasses(); // Do class initialization for LLSurface and its child classes.
+	// <FS> Parallel terrain patch update
+	static void cleanupClass();
+	static void setPatchUpdateThreads(S32 thread_count);
+	// </FS>
 
 	void create(const S32 surface_grid_width,
 				const S32 surface_patch_width,
@@ -459,48 +459,84 @@ void LLSurfacePatch::updateVerticalStats()
 		return;
 	}
 
+	// <FS> Parallel terrain patch update
+	calcVerticalStats();
+	applyVerticalStats();
+	// </FS>
+}
+
+// <FS> Parallel terrain patch update
+// Only reads this patch's heights (plus the shared +1 row and column) and
+// writes its own stats, so LLSurface::idleUpdate() runs it on the worker pool.
+void LLSurfacePatch::calcVerticalStats()
+{
+	if (!mDirtyZStats)
+	{
+		return;
+	}
+
 	U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
 	U32 grids_per_edge = mSurfacep->getGridsPerEdge();
 	F32 meters_per_grid = mSurfacep->getMetersPerGrid();
 
-	U32 i, j, k;
-	F32 z, total;
-
 	llassert(mDataZ);
-	z = *(mDataZ);
 
-	mMinZ = z;
-	mMaxZ = z;
+	// Iterate to +1 because we need to do the edges correctly.
+	const U32 row_length = grids_per_patch_edge + 1;
+	const U32 vec_length = row_length & ~3;
 
-	k = 0;
-	total = 0.0f;
+	__m128 min_z = _mm_set1_ps(*mDataZ);
+	__m128 max_z = min_z;
+	__m128 total_z = _mm_setzero_ps();
+	F32 min_tail = *mDataZ;
+	F32 max_tail = *mDataZ;
+	F32 total = 0.f;
 
-	// Iterate to +1 because we need to do the edges correctly.
-	for (j=0; j<(grids_per_patch_edge+1); j++) 
+	U32 i, j;
+	for (j = 0; j < row_length; j++)
 	{
-		for (i=0; i<(grids_per_patch_edge+1); i++) 
+		const F32 *row = mDataZ + j*grids_per_edge;
+		for (i = 0; i < vec_length; i += 4)
 		{
-			z = *(mDataZ + i + j*grids_per_edge);
-
-			if (z < mMinZ)
-			{
-				mMinZ = z;
-			}
-			if (z > mMaxZ)
-			{
-				mMaxZ = z;
-			}
-			total += z;
-			k++;
+			__m128 z = _mm_loadu_ps(row + i);
+			min_z = _mm_min_ps(min_z, z);
+			max_z = _mm_max_ps(max_z, z);
+			total_z = _mm_add_ps(total_z, z);
+		}
+		for (; i < row_length; i++)
+		{
+			min_tail = llmin(min_tail, row[i]);
+			max_tail = llmax(max_tail, row[i]);
+			total += row[i];
 		}
 	}
-	mMeanZ = total / (F32) k;
+
+	LL_ALIGN_16(F32 mins[4]);
+	LL_ALIGN_16(F32 maxs[4]);
+	LL_ALIGN_16(F32 totals[4]);
+	_mm_store_ps(mins, min_z);
+	_mm_store_ps(maxs, max_z);
+	_mm_store_ps(totals, total_z);
+
+	mMinZ = llmin(llmin(mins[0], mins[1]), llmin(mins[2], mins[3]), min_tail);
+	mMaxZ = llmax(llmax(maxs[0], maxs[1]), llmax(maxs[2], maxs[3]), max_tail);
+	total += (totals[0] + totals[1]) + (totals[2] + totals[3]);
+
+	mMeanZ = total / (F32)(row_length*row_length);
 	mCenterRegion.mV[VZ] = 0.5f * (mMinZ + mMaxZ);
 
 	LLVector3 diam_vec(meters_per_grid*grids_per_patch_edge,
 						meters_per_grid*grids_per_patch_edge,
 						mMaxZ - mMinZ);
 	mRadius = diam_vec.magVec() * 0.5f;
+}
+
+void LLSurfacePatch::applyVerticalStats()
+{
+	if (!mDirtyZStats)
+	{
+		return;
+	}
 
 	mSurfacep->mMaxZ = llmax(mMaxZ, mSurfacep->mMaxZ);
 	mSurfacep->mMinZ = llmin(mMinZ, mSurfacep->mMinZ);
@@ -514,8 +550,18 @@ void LLSurfacePatch::updateVerticalStats()
 	mDirtyZStats = FALSE;
 }
 
+void LLSurfacePatch::updateNormals()
+{
+	updateEdgeNormals();
+	updateMiddleNormals();
+}
+// </FS>
 
-void LLSurfacePatch::updateNormals() 
+
+// <FS> Parallel terrain patch update
+//void LLSurfacePatch::updateNormals() 
+void LLSurfacePatch::updateEdgeNormals()
+// </FS>
 {
 	if (mSurfacep->mType == 'w')
 	{
@@ -712,13 +758,16 @@ void LLSurfacePatch::updateNormals()
 	// update the middle normals
 	if (mNormalsInvalid[MIDDLE])
 	{
-		for (j=2; j < grids_per_patch_edge - 2; j++)
-		{
-			for (i=2; i < grids_per_patch_edge - 2; i++)
-			{
-				calcNormal(i, j, 2);
-			}
-		}
+		// <FS> Parallel terrain patch update
+		// Filled in by updateMiddleNormals(), which also clears the flag.
+		//for (j=2; j < grids_per_patch_edge - 2; j++)
+		//{
+		//	for (i=2; i < grids_per_patch_edge - 2; i++)
+		//	{
+		//		calcNormal(i, j, 2);
+		//	}
+		//}
+		// </FS>
 		dirty_patch = TRUE;
 	}
 
@@ -729,9 +778,84 @@ void LLSurfacePatch::updateNormals()
 
 	for (i = 0; i < 9; i++)
 	{
-		mNormalsInvalid[i] = FALSE;
+		// <FS> Parallel terrain patch update
+		//mNormalsInvalid[i] = FALSE;
+		if (i != MIDDLE)
+		{
+			mNormalsInvalid[i] = FALSE;
+		}
+		// </FS>
+	}
+}
+
+// <FS> Parallel terrain patch update
+// Interior normals (2..grids_per_patch_edge-3) only sample heights two grids
+// away, which never leaves this patch, so this is safe on a worker thread.
+// With all four samples inside the patch calcNormal(i, j, 2) reduces to
+//   c1 = (a, a, z11 - z00), c2 = (-a, a, z01 - z10), a = 4 * meters per grid
+// and the cross product and normVec() below repeat its exact operations four
+// normals at a time.
+void LLSurfacePatch::updateMiddleNormals()
+{
+	if (mSurfacep->mType == 'w' || !mNormalsInvalid[MIDDLE])
+	{
+		return;
 	}
+
+	const U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
+	const U32 grids_per_edge = mSurfacep->getGridsPerEdge();
+	const F32 mpg = mSurfacep->getMetersPerGrid() * 2;
+	const F32 a = mpg - -mpg;
+
+	const __m128 pos_a = _mm_set1_ps(a);
+	const __m128 neg_a = _mm_set1_ps(-a);
+	const F32 normal_z = a*a - (-a)*a;
+	const __m128 nz = _mm_set1_ps(normal_z);
+	const __m128 nz_sq = _mm_mul_ps(nz, nz);
+	const __m128 threshold = _mm_set1_ps(FP_MAG_THRESHOLD);
+	const __m128 one = _mm_set1_ps(1.f);
+
+	LL_ALIGN_16(F32 nx[4]);
+	LL_ALIGN_16(F32 ny[4]);
+	LL_ALIGN_16(F32 nzs[4]);
+
+	const U32 last = grids_per_patch_edge - 2;
+	U32 i, j, k;
+	for (j = 2; j < last; j++)
+	{
+		const F32 *south = mDataZ + (j - 2)*grids_per_edge;
+		const F32 *north = mDataZ + (j + 2)*grids_per_edge;
+		LLVector3 *normals = mDataNorm + j*grids_per_edge;
+
+		for (i = 2; i + 4 <= last; i += 4)
+		{
+			__m128 dz1 = _mm_sub_ps(_mm_loadu_ps(north + i + 2), _mm_loadu_ps(south + i - 2));	// z11 - z00
+			__m128 dz2 = _mm_sub_ps(_mm_loadu_ps(north + i - 2), _mm_loadu_ps(south + i + 2));	// z01 - z10
+
+			__m128 x = _mm_sub_ps(_mm_mul_ps(pos_a, dz2), _mm_mul_ps(pos_a, dz1));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(dz1, neg_a), _mm_mul_ps(dz2, pos_a));
+
+			__m128 mag = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), nz_sq));
+			__m128 valid = _mm_cmpgt_ps(mag, threshold);
+			__m128 oomag = _mm_and_ps(valid, _mm_div_ps(one, mag));
+
+			_mm_store_ps(nx, _mm_mul_ps(x, oomag));
+			_mm_store_ps(ny, _mm_mul_ps(y, oomag));
+			_mm_store_ps(nzs, _mm_mul_ps(nz, oomag));
+			for (k = 0; k < 4; k++)
+			{
+				normals[i + k].set(nx[k], ny[k], nzs[k]);
+			}
+		}
+		for (; i < last; i++)
+		{
+			calcNormal(i, j, 2);
+		}
+	}
+
+	mNormalsInvalid[MIDDLE] = FALSE;
 }
+// </FS>
 
 void LLSurfacePatch::updateEastEdge()
 {
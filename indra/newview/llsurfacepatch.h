@@ -79,6 +79,15 @@ public:
 	void updateCompositionStats();
 	void updateNormals();
 
+	// <FS> Parallel terrain patch update
+	// updateNormals() and updateVerticalStats() split so the parts that only
+	// touch this patch's own heights can run on a worker thread.
+	void updateEdgeNormals();		// main thread: edges and corners, may read/write neighbors
+	void updateMiddleNormals();		// thread-safe: interior normals
+	void calcVerticalStats();		// thread-safe: min/max/mean/radius
+	void applyVerticalStats();		// main thread: push stats to surface, region and vobj
+	// </FS>
+
 	void updateEastEdge();
 	void updateNorthEdge();
 
@@ -59,6 +59,10 @@
 #include "llviewerjoystick.h"
 #include "llviewerobjectlist.h"
 #include "llviewerparcelmgr.h"
+#include "llviewerpartsim.h" // <FS/> Parallel particle update
+#include "llsurface.h" // <FS/> Parallel terrain patch update
+#include "llparallelfor.h" // <FS/> Shared frame worker pool
+#include "llinventorysearchindexer.h" // <FS/> Inventory search index
 #include "llparcel.h"
 #include "llkeyboard.h"
 #include "llerrorcontrol.h"
@@ -108,6 +112,7 @@
 #include "NACLantispam.h"
 #include "nd/ndlogthrottle.h"
 #include "fsperfstats.h"
+#include "llsdserialize.h"
 // <FS:Zi> Run Prio 0 default bento pose in the background to fix splayed hands, open mouths, etc.
 #include "llanimationstates.h"
 
@@ -1154,6 +1159,64 @@ void handleFPSTuningStrategyChanged(const LLSD& newValue)
 
 // </FS:Beq>
 
+// <FS> Shared frame worker pool
+static bool handleFrameWorkerThreadsChanged(const LLSD& newvalue)
+{
+	// skeletons deferred to the pool are brought up to date before it changes
+	LLVOAvatar::updatePendingSkeletons();
+	LLParallelFor::setSharedWorkerCount(newvalue.asInteger());
+	return true;
+}
+// </FS>
+
+// <FS> Parallel geometry fill
+static bool handleRenderGeometryFillThreadsChanged(const LLSD& newvalue)
+{
+	LLVolumeGeometryManager::setGeometryFillThreads(newvalue.asInteger());
+	return true;
+}
+// </FS>
+
+// <FS> Background volume generation
+static bool handleRenderBackgroundVolumeGenerationChanged(const LLSD& newvalue)
+{
+	LLVOVolume::setBackgroundVolumeGeneration(newvalue.asBoolean());
+	return true;
+}
+// </FS>
+
+// <FS> Parallel particle update
+static bool handleRenderParticleUpdateThreadsChanged(const LLSD& newvalue)
+{
+	LLViewerPartSim::setUpdateThreads(newvalue.asInteger());
+	return true;
+}
+// </FS>
+
+// <FS> Parallel terrain patch update
+static bool handleTerrainPatchUpdateThreadsChanged(const LLSD& newvalue)
+{
+	LLSurface::setPatchUpdateThreads(newvalue.asInteger());
+	return true;
+}
+// </FS>
+
+// <FS> Inventory search index
+static bool handleInventorySearchIndexChanged(const LLSD& newvalue)
+{
+	LLInventorySearchIndexer::setEnabled(newvalue.asBoolean());
+	return true;
+}
+// </FS>
+
+// <FS> Buffer based XML LLSD parser
+static bool handleLLSDFastXMLParserChanged(const LLSD& newvalue)
+{
+	LLSDSerialize::setUseFastXMLParser(newvalue.asBoolean());
+	return true;
+}
+// </FS>
+
 ////////////////////////////////////////////////////////////////////////////
 
 void settings_setup_listeners()
@@ -1421,6 +1484,35 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("FSAutoTuneImpostorByDistEnabled")->getSignal()->connect(boost::bind(&handleUserImpostorByDistEnabledChanged, _2));
 	gSavedSettings.getControl("FSTuningFPSStrategy")->getSignal()->connect(boost::bind(&handleFPSTuningStrategyChanged, _2));
 	// </FS:Beq>
+
+	// <FS> Buffer based XML LLSD parser
+	gSavedSettings.getControl("LLSDFastXMLParser")->getSignal()->connect(boost::bind(&handleLLSDFastXMLParserChanged, _2));
+	LLSDSerialize::setUseFastXMLParser(gSavedSettings.getBOOL("LLSDFastXMLParser"));
+	// </FS>
+
+	// <FS> Shared frame worker pool
+	gSavedSettings.getControl("FrameWorkerThreads")->getSignal()->connect(boost::bind(&handleFrameWorkerThreadsChanged, _2));
+	// </FS>
+
+	// <FS> Parallel geometry fill
+	gSavedSettings.getControl("RenderGeometryFillThreads")->getSignal()->connect(boost::bind(&handleRenderGeometryFillThreadsChanged, _2));
+	// </FS>
+
+	// <FS> Background volume generation
+	gSavedSettings.getControl("RenderBackgroundVolumeGeneration")->getSignal()->connect(boost::bind(&handleRenderBackgroundVolumeGenerationChanged, _2));
+	// </FS>
+
+	// <FS> Parallel particle update
+	gSavedSettings.getControl("RenderParticleUpdateThreads")->getSignal()->connect(boost::bind(&handleRenderParticleUpdateThreadsChanged, _2));
+	// </FS>
+
+	// <FS> Parallel terrain patch update
+	gSavedSettings.getControl("TerrainPatchUpdateThreads")->getSignal()->connect(boost::bind(&handleTerrainPatchUpdateThreadsChanged, _2));
+	// </FS>
+
+	// <FS> Inventory search index
+	gSavedSettings.getControl("InventorySearchIndex")->getSignal()->connect(boost::bind(&handleInventorySearchIndexChanged, _2));
+	// </FS>
 }
 
 #if TEST_CACHED_CONTROL
@@ -1690,60 +1690,41 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 					this_update_precision = 16;
 					test_pos_parent.quantize16(-0.5f*size, 1.5f*size, MIN_HEIGHT, MAX_HEIGHT);
 
+					// <FS> Dequantize the whole terse block (pos, vel, acc, rot, angv) four values at a
+					// time, with the ranges built in registers
+					{
+						const S32 TERSE_16_VALUES = 16;
+						LL_ALIGN_16(F32 terse_out[TERSE_16_VALUES]);
 #ifdef LL_BIG_ENDIAN
-					htolememcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-					val = valswizzle;
-#else
-					val = (U16 *) &data[count];
-#endif
-					count += sizeof(U16)*3;
-					new_pos_parent.mV[VX] = U16_to_F32(val[VX], -0.5f*size, 1.5f*size);
-					new_pos_parent.mV[VY] = U16_to_F32(val[VY], -0.5f*size, 1.5f*size);
-					new_pos_parent.mV[VZ] = U16_to_F32(val[VZ], MIN_HEIGHT, MAX_HEIGHT);
-
-#ifdef LL_BIG_ENDIAN
-					htolememcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-					val = valswizzle;
-#else
-					val = (U16 *) &data[count];
-#endif
-					count += sizeof(U16)*3;
-					setVelocity(U16_to_F32(val[VX], -size, size),
-								U16_to_F32(val[VY], -size, size),
-								U16_to_F32(val[VZ], -size, size));
-
-#ifdef LL_BIG_ENDIAN
-					htolememcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-					val = valswizzle;
-#else
-					val = (U16 *) &data[count];
-#endif
-					count += sizeof(U16)*3;
-					setAcceleration(U16_to_F32(val[VX], -size, size),
-									U16_to_F32(val[VY], -size, size),
-									U16_to_F32(val[VZ], -size, size));
-
-#ifdef LL_BIG_ENDIAN
-					htolememcpy(valswizzle, &data[count], MVT_U16Quat, 8); 
-					val = valswizzle;
-#else
-					val = (U16 *) &data[count];
-#endif
-					count += sizeof(U16)*4;
-					new_rot.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
-					new_rot.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
-					new_rot.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
-					new_rot.mQ[VW] = U16_to_F32(val[VW], -1.f, 1.f);
-
-#ifdef LL_BIG_ENDIAN
-					htolememcpy(valswizzle, &data[count], MVT_U16Vec3, 6); 
-					val = valswizzle;
+						U16 terse_val[TERSE_16_VALUES];
+						for (S32 i = 0; i < TERSE_16_VALUES; ++i)
+						{
+							htolememcpy(&terse_val[i], &data[count + i * sizeof(U16)], MVT_U16, sizeof(U16));
+						}
+						val = terse_val;
 #else
-					val = (U16 *) &data[count];
+						val = (U16 *) &data[count];
 #endif
-					new_angv.set(U16_to_F32(val[VX], -size, size),
-										U16_to_F32(val[VY], -size, size),
-										U16_to_F32(val[VZ], -size, size));
+						count += sizeof(U16) * TERSE_16_VALUES;
+
+						_mm_store_ps(terse_out, U16_to_F32_4(val, _mm_setr_ps(-0.5f*size, -0.5f*size, MIN_HEIGHT, -size),	// pos, vel x
+																	_mm_setr_ps(1.5f*size, 1.5f*size, MAX_HEIGHT, size)));
+						_mm_store_ps(terse_out + 4, U16_to_F32_4(val + 4, _mm_set1_ps(-size), _mm_set1_ps(size)));		// vel y z, acc x y
+						_mm_store_ps(terse_out + 8, U16_to_F32_4(val + 8, _mm_setr_ps(-size, -1.f, -1.f, -1.f),			// acc z, rot x y z
+																		  _mm_setr_ps(size, 1.f, 1.f, 1.f)));
+						_mm_store_ps(terse_out + 12, U16_to_F32_4(val + 12, _mm_setr_ps(-1.f, -size, -size, -size),		// rot w, angv
+																			_mm_setr_ps(1.f, size, size, size)));
+
+						new_pos_parent.set(terse_out[0], terse_out[1], terse_out[2]);
+						setVelocity(terse_out[3], terse_out[4], terse_out[5]);
+						setAcceleration(terse_out[6], terse_out[7], terse_out[8]);
+						new_rot.mQ[VX] = terse_out[9];
+						new_rot.mQ[VY] = terse_out[10];
+						new_rot.mQ[VZ] = terse_out[11];
+						new_rot.mQ[VW] = terse_out[12];
+						new_angv.set(terse_out[13], terse_out[14], terse_out[15]);
+					}
+					// </FS>
 					setAngularVelocity(new_angv);
 					break;
 
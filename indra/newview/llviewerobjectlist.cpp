@@ -1059,6 +1059,7 @@ void LLViewerObjectList::update(LLAgent &agent)
 				objectp->idleUpdate(agent, frame_time);
 			}
 		}
+		LLVOAvatar::updatePendingSkeletons(); // <FS/> Parallel skeleton update
 	}
 	else
 	{
@@ -1069,6 +1070,7 @@ void LLViewerObjectList::update(LLAgent &agent)
 			llassert(objectp->isActive());
                 objectp->idleUpdate(agent, frame_time);
 		}
+		LLVOAvatar::updatePendingSkeletons(); // <FS/> Parallel skeleton update
 
 		//update flexible objects
 		LLVolumeImplFlexible::updateClass();
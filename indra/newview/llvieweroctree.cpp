@@ -1383,17 +1383,93 @@ void LLViewerOctreeCull::traverse(const OctreeNode* n)
 		if (mRes)
 		{ //at least partially in, run on down
 			FSZoneN("PartiallyIn");
-			OctreeTraveler::traverse(n);
+			traverseChildren(n);
 		}
 
 		mRes = 0;
 	}
 }
+
+//same as OctreeTraveler::traverse, but lets the children share one batched frustum test
+void LLViewerOctreeCull::traverseChildren(const OctreeNode* n)
+{
+	n->accept(this);
+
+	U32 count = n->getChildCount();
+	if (count < 2)
+	{
+		for (U32 i = 0; i < count; i++)
+		{
+			traverse(n->getChild(i));
+		}
+		return;
+	}
+
+	ChildBatch batch;
+	batch.mParent = n;
+	batch.mMode = -1;
+
+	ChildBatch* prev_batch = mChildBatch;
+	mChildBatch = &batch;
+	for (U32 i = 0; i < count; i++)
+	{
+		batch.mChild = i;
+		traverse(n->getChild(i));
+	}
+	mChildBatch = prev_batch;
+}
+
+bool LLViewerOctreeCull::getBatchedResult(const LLViewerOctreeGroup* group, S32 mode, S32& res)
+{
+	ChildBatch* batch = mChildBatch;
+	if (!batch || batch->mParent->getChild(batch->mChild)->getListener(0) != group)
+	{ //not one of the children being traversed, e.g. a nested frustum check
+		return false;
+	}
+
+	if (batch->mMode != mode)
+	{
+		if (batch->mMode == -1)
+		{ //children are rebound before the traversal starts, so their bounds are final by now
+			batch->mBounds.clear();
+			for (U32 i = 0; i < batch->mParent->getChildCount(); i++)
+			{
+				const LLViewerOctreeGroup* child = (const LLViewerOctreeGroup*) batch->mParent->getChild(i)->getListener(0);
+				batch->mBounds.add(child->mBounds[0], child->mBounds[1]);
+			}
+		}
+
+		switch (mode)
+		{
+		case BATCH_AGENT:
+			mCamera->AABBInFrustum(batch->mBounds, batch->mResults, NULL, true);
+			break;
+		case BATCH_AGENT_NO_FAR_CLIP:
+			mCamera->AABBInFrustum(batch->mBounds, batch->mResults, NULL, false);
+			break;
+		case BATCH_REGION:
+			mCamera->AABBInRegionFrustum(batch->mBounds, batch->mResults, true);
+			break;
+		default:
+			mCamera->AABBInRegionFrustum(batch->mBounds, batch->mResults, false);
+			break;
+		}
+		batch->mMode = mode;
+	}
+
+	res = batch->mResults[batch->mChild];
+	return true;
+}
 	
 //------------------------------------------
 //agent space group culling
 S32 LLViewerOctreeCull::AABBInFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
+	S32 res;
+	if (getBatchedResult(group, BATCH_AGENT_NO_FAR_CLIP, res))
+	{
+		return res;
+	}
 	return mCamera->AABBInFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
 }
 
@@ -1404,6 +1480,11 @@ S32 LLViewerOctreeCull::AABBSphereIntersectGroupExtents(const LLViewerOctreeGrou
 
 S32 LLViewerOctreeCull::AABBInFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
+	S32 res;
+	if (getBatchedResult(group, BATCH_AGENT, res))
+	{
+		return res;
+	}
 	return mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
 }
 //------------------------------------------
@@ -1430,11 +1511,21 @@ S32 LLViewerOctreeCull::AABBInFrustumObjectBounds(const LLViewerOctreeGroup* gro
 //local regional space group culling
 S32 LLViewerOctreeCull::AABBInRegionFrustumNoFarClipGroupBounds(const LLViewerOctreeGroup* group)
 {
+	S32 res;
+	if (getBatchedResult(group, BATCH_REGION_NO_FAR_CLIP, res))
+	{
+		return res;
+	}
 	return mCamera->AABBInRegionFrustumNoFarClip(group->mBounds[0], group->mBounds[1]);
 }
 
 S32 LLViewerOctreeCull::AABBInRegionFrustumGroupBounds(const LLViewerOctreeGroup* group)
 {
+	S32 res;
+	if (getBatchedResult(group, BATCH_REGION, res))
+	{
+		return res;
+	}
 	return mCamera->AABBInRegionFrustum(group->mBounds[0], group->mBounds[1]);
 }
 
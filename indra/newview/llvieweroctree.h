@@ -365,7 +365,7 @@ class LLViewerOctreeCull : public OctreeTraveler
 {
 public:
 	LLViewerOctreeCull(LLCamera* camera)
-		: mCamera(camera), mRes(0) { }
+		: mCamera(camera), mRes(0), mChildBatch(NULL) { }
 	
 	virtual void traverse(const OctreeNode* n);
 
@@ -400,10 +400,36 @@ protected:
 	virtual void preprocess(LLViewerOctreeGroup* group);
 	virtual void processGroup(LLViewerOctreeGroup* group);
 	virtual void visit(const OctreeNode* branch);
+
+private:
+	enum
+	{
+		BATCH_AGENT = 0,
+		BATCH_AGENT_NO_FAR_CLIP,
+		BATCH_REGION,
+		BATCH_REGION_NO_FAR_CLIP,
+	};
+
+	// bounds of the children of a partially visible node, tested against the
+	// frustum together the first time one of them is asked for
+	struct ChildBatch
+	{
+		const OctreeNode* mParent;
+		U32 mChild;		// child currently being traversed
+		S32 mMode;		// BATCH_* the results are for, -1 when not tested yet
+		LLAABBBatch mBounds;
+		S32 mResults[LLAABBBatch::MAX_BOXES];
+	};
+
+	void traverseChildren(const OctreeNode* n);
+	bool getBatchedResult(const LLViewerOctreeGroup* group, S32 mode, S32& res);
 	
 protected:
 	LLCamera *mCamera;
 	S32 mRes;
+
+private:
+	ChildBatch* mChildBatch;
 };
 
 //scan the octree, output the info of each node for debug use.
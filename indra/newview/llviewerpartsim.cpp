@@ -42,6 +42,7 @@
 #include "llspatialpartition.h"
 #include "llvoavatarself.h"
 #include "llvovolume.h"
+#include "llparallelfor.h" // <FS/> Parallel particle update
 
 const F32 PART_SIM_BOX_SIDE = 16.f;
 
@@ -65,9 +66,12 @@ const F32 LLViewerPartSim::PART_ADAPT_RATE_MULT_RECIP = 1.0f/PART_ADAPT_RATE_MUL
 
 U32 LLViewerPart::sNextPartID = 1;
 
-F32 calc_desired_size(LLViewerCamera* camera, LLVector3 pos, LLVector2 scale)
+// <FS> Parallel particle update, takes the camera origin so worker threads can call it
+//F32 calc_desired_size(LLViewerCamera* camera, LLVector3 pos, LLVector2 scale)
+F32 calc_desired_size(const LLVector3& camera_origin, LLVector3 pos, LLVector2 scale)
+// </FS>
 {
-	F32 desired_size = (pos - camera->getOrigin()).magVec();
+	F32 desired_size = (pos - camera_origin).magVec();
 	desired_size /= 4;
 	return llclamp(desired_size, scale.magVec()*0.5f, PART_SIM_BOX_SIDE*2);
 }
@@ -273,20 +277,39 @@ BOOL LLViewerPartGroup::addPart(LLViewerPart* part, F32 desired_size)
 }
 
 
-void LLViewerPartGroup::updateParticles(const F32 lastdt)
+// <FS> Parallel particle update
+void LLViewerPartGroup::prepareUpdate(const F32 lastdt)
 {
-	F32 dt;
-	
-	LLVector3 gravity(0.f, 0.f, GRAVITY);
+	// Callbacks move the particle relative to its source object, which means
+	// reading render positions and joints that only the main thread may touch.
+	// Following the source comes first in the update, so it moves here too.
+	for (S32 i = 0; i < (S32)mParticles.size(); i++)
+	{
+		LLViewerPart* part = mParticles[i];
+		if (!part->mVPCallback)
+		{
+			continue;
+		}
 
-	LLViewerPartSim::checkParticleCount(mParticles.size());
+		if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
+		{
+			part->mPosAgent = part->mPartSourcep->mPosAgent;
+			part->mPosAgent += part->mPosOffset;
+		}
 
-	LLViewerCamera* camera = LLViewerCamera::getInstance();
+		(*part->mVPCallback)(*part, lastdt + mSkippedTime - part->mSkipOffset);
+	}
+}
+
+void LLViewerPartGroup::simulate(const F32 lastdt, const LLVector3& camera_origin)
+{
+	F32 dt;
+	
 	LLViewerRegion *regionp = getRegion();
-	S32 end = (S32) mParticles.size();
-	for (S32 i = 0 ; i < (S32)mParticles.size();)
+	const S32 count = (S32) mParticles.size();
+	mUpdateResults.resize(count);
+	for (S32 i = 0 ; i < count; i++)
 	{
-		LLVector3 a(0.f, 0.f, 0.f);
 		LLViewerPart* part = mParticles[i] ;
 
 		dt = lastdt + mSkippedTime - part->mSkipOffset;
@@ -296,19 +319,14 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 		const F32 cur_time = part->mLastUpdateTime + dt;
 		const F32 frac = cur_time / part->mMaxAge;
 
-		// "Drift" the object based on the source object
-		if (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK)
+		// "Drift" the object based on the source object, prepareUpdate()
+		// already did it for particles with a callback
+		if (!part->mVPCallback && (part->mFlags & LLPartData::LL_PART_FOLLOW_SRC_MASK))
 		{
 			part->mPosAgent = part->mPartSourcep->mPosAgent;
 			part->mPosAgent += part->mPosOffset;
 		}
 
-		// Do a custom callback if we have one...
-		if (part->mVPCallback)
-		{
-			(*part->mVPCallback)(*part, dt);
-		}
-
 		if (part->mFlags & LLPartData::LL_PART_WIND_MASK)
 		{
 			part->mVelocity *= 1.f - 0.1f*dt;
@@ -399,28 +417,54 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 		// Kill dead particles (either flagged dead, or too old)
 		if ((part->mLastUpdateTime > part->mMaxAge) || (LLViewerPart::LL_PART_DEAD_MASK == part->mFlags))
 		{
-			mParticles[i] = mParticles.back() ;
-			mParticles.pop_back() ;
-			delete part ;
+			mUpdateResults[i] = PART_DEAD;
 		}
-		else 
+		else if (!posInGroup(part->mPosAgent, calc_desired_size(camera_origin, part->mPosAgent, part->mScale)))
 		{
-			F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
-			if (!posInGroup(part->mPosAgent, desired_size))
-			{
-				// Transfer particles between groups
-				LLViewerPartSim::getInstance()->put(part) ;
-				mParticles[i] = mParticles.back() ;
-				mParticles.pop_back() ;
-			}
-			else
-			{
-				i++ ;
-			}
+			mUpdateResults[i] = PART_MOVED;
+		}
+		else
+		{
+			mUpdateResults[i] = PART_KEEP;
+		}
+	}
+}
+
+void LLViewerPartGroup::commitUpdate()
+{
+	const S32 end = (S32) mParticles.size();
+
+	// particles other groups handed over since simulate() sit past the
+	// results and are simply kept
+	const S32 simulated = llmin((S32) mUpdateResults.size(), end);
+
+	LLViewerPartSim::checkParticleCount(end);
+
+	// one compaction pass instead of swapping each removed particle with the
+	// last one, which also keeps the survivors in order
+	S32 kept = 0;
+	std::vector<LLViewerPart*> moved;
+	for (S32 i = 0; i < end; i++)
+	{
+		LLViewerPart* part = mParticles[i];
+		U8 result = i < simulated ? mUpdateResults[i] : (U8) PART_KEEP;
+		if (result == PART_DEAD)
+		{
+			delete part;
+		}
+		else if (result == PART_MOVED)
+		{
+			moved.push_back(part);
+		}
+		else
+		{
+			mParticles[kept++] = part;
 		}
 	}
+	mParticles.resize(kept);
+	mUpdateResults.clear();
 
-	S32 removed = end - (S32)mParticles.size();
+	S32 removed = end - kept;
 	if (removed > 0)
 	{
 		// we removed one or more particles, so flag this group for update
@@ -430,16 +474,19 @@ void LLViewerPartGroup::updateParticles(const F32 lastdt)
 		}
 		LLViewerPartSim::decPartCount(removed);
 	}
-	
-	// Kill the viewer object if this particle group is empty
-	if (mParticles.empty())
+
+	// Transfer particles between groups, put() counts them again
+	for (std::vector<LLViewerPart*>::iterator iter = moved.begin(); iter != moved.end(); ++iter)
 	{
-		gObjectList.killObject(mVOPartGroupp);
-		mVOPartGroupp = NULL;
+		LLViewerPartSim::getInstance()->put(*iter);
 	}
 
+	// An empty group is deleted by LLViewerPartSim::updateSimulation() once
+	// every group has committed, since another group may still hand it particles
+
 	LLViewerPartSim::checkParticleCount() ;
 }
+// </FS>
 
 
 void LLViewerPartGroup::shift(const LLVector3 &offset)
@@ -485,12 +532,48 @@ void LLViewerPartSim::checkParticleCount(U32 size)
 	}
 }
 
+// <FS> Parallel particle update
+static const S32 MAX_PARTICLE_UPDATE_THREADS = 8;
+// below this many particles in a frame the hand off costs more than it saves
+static const S32 MIN_PARTICLES_FOR_UPDATE_THREADS = 256;
+static LLParallelFor* sParticleUpdatePool = NULL;
+// </FS>
+
 LLViewerPartSim::LLViewerPartSim()
 {
 	sMaxParticleCount = llmin(gSavedSettings.getS32("RenderMaxPartCount"), LL_MAX_PARTICLE_COUNT);
 	static U32 id_seed = 0;
 	mID = ++id_seed;
+
+	setUpdateThreads(gSavedSettings.getS32("RenderParticleUpdateThreads")); // <FS/> Parallel particle update
+}
+
+// <FS> Parallel particle update
+//static
+void LLViewerPartSim::setUpdateThreads(S32 thread_count)
+{
+	if (thread_count < 0)
+	{
+		thread_count = llmin(LLParallelFor::getDefaultWorkerCount(), MAX_PARTICLE_UPDATE_THREADS);
+	}
+	thread_count = llmin(thread_count, MAX_PARTICLE_UPDATE_THREADS);
+
+	if (thread_count == 0)
+	{
+		// groups are only simulated inside updateSimulation(), nothing is in flight
+		delete sParticleUpdatePool;
+		sParticleUpdatePool = NULL;
+	}
+	else if (!sParticleUpdatePool)
+	{
+		sParticleUpdatePool = new LLParallelFor("ParticleUpdate", thread_count);
+	}
+	else
+	{
+		sParticleUpdatePool->setWorkerCount(thread_count);
+	}
 }
+// </FS>
 
 //enable/disable particle system
 void LLViewerPartSim::enable(bool enabled)
@@ -522,6 +605,11 @@ void LLViewerPartSim::destroyClass()
 
 	// Kill all of the sources 
 	mViewerPartSources.clear();
+
+	// <FS> Parallel particle update
+	delete sParticleUpdatePool;
+	sParticleUpdatePool = NULL;
+	// </FS>
 }
 
 //static
@@ -583,7 +671,7 @@ LLViewerPartGroup *LLViewerPartSim::put(LLViewerPart* part)
 	else
 	{	
 		LLViewerCamera* camera = LLViewerCamera::getInstance();
-		F32 desired_size = calc_desired_size(camera, part->mPosAgent, part->mScale);
+		F32 desired_size = calc_desired_size(camera->getOrigin(), part->mPosAgent, part->mScale); // <FS/> Parallel particle update
 
 		S32 count = (S32) mViewerPartGroups.size();
 		for (S32 i = 0; i < count; i++)
@@ -749,6 +837,8 @@ void LLViewerPartSim::updateSimulation()
 		num_updates++;
 	}
 
+	// <FS> Parallel particle update
+	/*
 	count = (S32) mViewerPartGroups.size();
 	for (i = 0; i < count; i++)
 	{
@@ -788,6 +878,91 @@ void LLViewerPartSim::updateSimulation()
 		}
 
 	}
+	*/
+	std::vector<LLViewerPartGroup*> updated_groups;
+	std::vector<F32> updated_dts;
+	S32 updated_particles = 0;
+
+	count = (S32) mViewerPartGroups.size();
+	for (i = 0; i < count; i++)
+	{
+		LLViewerObject* vobj = mViewerPartGroups[i]->mVOPartGroupp;
+
+		S32 visirate = 1;
+		if (vobj && !vobj->isDead() && vobj->mDrawable && !vobj->mDrawable->isDead())
+		{
+			LLSpatialGroup* group = vobj->mDrawable->getSpatialGroup();
+			if (group && !group->isVisible()) // && !group->isState(LLSpatialGroup::OBJECT_DIRTY))
+			{
+				visirate = 8;
+			}
+		}
+
+		if ((LLDrawable::getCurrentFrame()+mViewerPartGroups[i]->mID)%visirate == 0)
+		{
+			// <FS:CR> FIRE-11593: Opensim "4096 Bug" Fix by Latif Khalifa
+			// <vobj && !vobj->isDead())
+			if (vobj && !vobj->isDead() && vobj->mDrawable)
+			{
+				gPipeline.markRebuild(vobj->mDrawable, LLDrawable::REBUILD_ALL, TRUE);
+			}
+			mViewerPartGroups[i]->prepareUpdate(dt * visirate);
+			updated_groups.push_back(mViewerPartGroups[i]);
+			updated_dts.push_back(dt * visirate);
+			updated_particles += mViewerPartGroups[i]->getCount();
+		}
+		else
+		{	
+			mViewerPartGroups[i]->mSkippedTime+=dt;
+		}
+	}
+
+	// groups only touch their own particles while simulating
+	const LLVector3 camera_origin = LLViewerCamera::getInstance()->getOrigin();
+	LLParallelFor::func_t simulate_group = [&updated_groups, &updated_dts, &camera_origin](S32 i)
+	{
+		updated_groups[i]->simulate(updated_dts[i], camera_origin);
+	};
+
+	if (sParticleUpdatePool && updated_groups.size() > 1 && updated_particles >= MIN_PARTICLES_FOR_UPDATE_THREADS)
+	{
+		sParticleUpdatePool->run((S32)updated_groups.size(), simulate_group);
+	}
+	else
+	{
+		for (i = 0; i < (S32)updated_groups.size(); i++)
+		{
+			simulate_group(i);
+		}
+	}
+
+	// every updated group is current before any particle changes group, so
+	// a moved particle's skip offset is taken against the time already stepped
+	for (i = 0; i < (S32)updated_groups.size(); i++)
+	{
+		updated_groups[i]->mSkippedTime=0.0f;
+	}
+
+	// moving particles may create groups, which are simulated next frame
+	for (i = 0; i < (S32)updated_groups.size(); i++)
+	{
+		updated_groups[i]->commitUpdate();
+	}
+
+	// a group emptied early in the pass may have been handed particles by a later one
+	count = (S32) mViewerPartGroups.size();
+	for (i = 0; i < count; i++)
+	{
+		if (!mViewerPartGroups[i]->getCount())
+		{
+			delete mViewerPartGroups[i];
+			mViewerPartGroups.erase(mViewerPartGroups.begin() + i);
+			i--;
+			count--;
+		}
+	}
+	// </FS>
+
 	if (LLDrawable::getCurrentFrame()%16==0)
 	{
 		if (sParticleCount > sMaxParticleCount * 0.875f
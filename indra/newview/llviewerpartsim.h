@@ -97,7 +97,18 @@ public:
 
 	BOOL addPart(LLViewerPart* part, const F32 desired_size = -1.f);
 	
-	void updateParticles(const F32 lastdt);
+	// <FS> Parallel particle update
+	//void updateParticles(const F32 lastdt);
+
+	// A group update runs in three steps so the middle one, which does the
+	// bulk of the work, can run for several groups in parallel.
+	// MAIN THREAD: runs the per particle callbacks, which read objects and joints
+	void prepareUpdate(const F32 lastdt);
+	// ANY THREAD: steps every particle and notes which ones die or leave the group
+	void simulate(const F32 lastdt, const LLVector3& camera_origin);
+	// MAIN THREAD: drops dead particles and hands leaving ones to other groups
+	void commitUpdate();
+	// </FS>
 
 	BOOL posInGroup(const LLVector3 &pos, const F32 desired_size = -1.f);
 
@@ -131,6 +142,16 @@ protected:
 	LLVector3 mMaxObjPos;
 
 	LLViewerRegion *mRegionp;
+
+	// <FS> Parallel particle update
+	enum EUpdateResult
+	{
+		PART_KEEP,
+		PART_DEAD,
+		PART_MOVED
+	};
+	std::vector<U8> mUpdateResults; // per particle outcome of simulate()
+	// </FS>
 };
 
 class LLViewerPartSim : public LLSingleton<LLViewerPartSim>
@@ -210,6 +231,12 @@ public:
 	static S32 sParticleCount2;
 
 	static void checkParticleCount(U32 size = 0) ;
+
+	// <FS> Parallel particle update
+	// Worker threads used to simulate particle groups, -1 picks a default
+	// and 0 simulates every group on the main thread.
+	static void setUpdateThreads(S32 thread_count);
+	// </FS>
 };
 
 #endif // LL_LLVIEWERPARTSIM_H
@@ -118,6 +118,8 @@
 #include "llsdserialize.h"
 #include "llcallstack.h"
 #include "llrendersphere.h"
+#include "llparallelfor.h"
+#include "llskinningutil.h"
 
 #include <boost/lexical_cast.hpp>
 
@@ -631,6 +633,11 @@ F32 LLVOAvatar::sUnbakedUpdateTime = 0.f;
 F32 LLVOAvatar::sGreyTime = 0.f;
 F32 LLVOAvatar::sGreyUpdateTime = 0.f;
 
+// <FS> Parallel skeleton update
+static std::vector<LLPointer<LLVOAvatar> > sPendingSkeletonUpdates;
+static LLTrace::BlockTimerStatHandle FTM_SKELETON_UPDATE("Avatar Skeletons");
+// </FS>
+
 //-----------------------------------------------------------------------------
 // Helper functions
 //-----------------------------------------------------------------------------
@@ -657,6 +664,8 @@ LLVOAvatar::LLVOAvatar(const LLUUID& id,
 	mMeshValid(FALSE),
 	mVisible(FALSE),
 	mLastImpostorUpdateFrameTime(0.f),
+	mLastSkinningPalettePurgeFrame(0), // <FS/> Shared skinning palettes
+	mSkeletonUpdateCount(0), // <FS/> Shared skinning palettes
 	mLastImpostorUpdateReason(0),
 	mWindFreq(0.f),
 	mRipplePhase( 0.f ),
@@ -888,6 +897,11 @@ LLVOAvatar::~LLVOAvatar()
 	std::for_each(mAttachmentPoints.begin(), mAttachmentPoints.end(), DeletePairedPointer());
 	mAttachmentPoints.clear();
 
+	// <FS> Shared skinning palettes
+	std::for_each(mSkinningPalettes.begin(), mSkinningPalettes.end(), DeletePairedPointer());
+	mSkinningPalettes.clear();
+	// </FS>
+
 	mDead = TRUE;
 	
 	mAnimationSources.clear();
@@ -1216,8 +1230,50 @@ void LLVOAvatar::initClass()
 
 void LLVOAvatar::cleanupClass()
 {
+	sPendingSkeletonUpdates.clear(); // <FS/> Parallel skeleton update
 }
 
+// <FS> Parallel skeleton update
+//static
+void LLVOAvatar::updatePendingSkeletons()
+{
+	if (sPendingSkeletonUpdates.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_SKELETON_UPDATE);
+
+	// Each avatar's joints only reference joints of the same skeleton, or
+	// read the already updated transform of the object it sits on, so the
+	// skeletons can be brought up to date independently of each other.
+	// Nothing else runs on the main thread until they are all done.
+	std::vector<LLPointer<LLVOAvatar> >& pending = sPendingSkeletonUpdates;
+	LLParallelFor::func_t update_skeleton = [&pending](S32 i)
+	{
+		LLVOAvatar* avatarp = pending[i];
+		if (!avatarp->isDead() && avatarp->mRoot)
+		{
+			avatarp->mRoot->updateWorldMatrixChildren();
+		}
+	};
+
+	LLParallelFor* pool = LLParallelFor::getShared();
+	if (pool)
+	{
+		pool->run((S32)pending.size(), update_skeleton);
+	}
+	else
+	{
+		for (S32 i = 0; i < (S32)pending.size(); ++i)
+		{
+			update_skeleton(i);
+		}
+	}
+	pending.clear();
+}
+// </FS>
+
 LLPartSysData LLVOAvatar::sCloud;
 void LLVOAvatar::initCloud()
 {
@@ -4100,7 +4156,10 @@ void LLVOAvatar::idleUpdateNameTagPosition(const LLVector3& root_pos_last)
 	local_camera_up.scaleVec(avatar_ellipsoid);
 	local_camera_at.scaleVec(avatar_ellipsoid);
 
-	LLVector3 head_offset = (mHeadp->getLastWorldPosition() - mRoot->getLastWorldPosition()) * inv_root_rot;
+	// <FS> Parallel skeleton update: the skeleton may not have been updated yet this frame
+	//LLVector3 head_offset = (mHeadp->getLastWorldPosition() - mRoot->getLastWorldPosition()) * inv_root_rot;
+	LLVector3 head_offset = (mHeadp->getWorldPosition() - mRoot->getWorldPosition()) * inv_root_rot;
+	// </FS>
 
 	if (dist_vec(head_offset, mTargetRootToHeadOffset) > NAMETAG_UPDATE_THRESHOLD)
 	{
@@ -4111,7 +4170,7 @@ void LLVOAvatar::idleUpdateNameTagPosition(const LLVector3& root_pos_last)
 
 	// <FS:Ansariel> Optional legacy nametag position
 	//LLVector3 name_position = mRoot->getLastWorldPosition() + (mCurRootToHeadOffset * root_rot);
-	name_position = mRoot->getLastWorldPosition() + (mCurRootToHeadOffset * root_rot);
+	name_position = mRoot->getWorldPosition() + (mCurRootToHeadOffset * root_rot); // <FS/> Parallel skeleton update
 	name_position += (local_camera_up * root_rot) - (projected_vec(local_camera_at * root_rot, camera_to_av));	
 	name_position += pixel_up_vec * NAMETAG_VERTICAL_SCREEN_OFFSET;
 	// <FS:Ansariel> Optional legacy nametag position
@@ -5171,6 +5230,8 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
 		return FALSE;
 	}
 
+	++mSkeletonUpdateCount; // <FS/> Shared skinning palettes
+
 	BOOL visible = isVisible();
     bool is_control_avatar = isControlAvatar(); // capture state to simplify tracing
 	bool is_attachment = false;
@@ -5296,7 +5357,20 @@ bool LLVOAvatar::updateCharacter(LLAgent &agent)
     updateFootstepSounds();
 
 	// Update child joints as needed.
-	mRoot->updateWorldMatrixChildren();
+	// <FS> Parallel skeleton update
+	//mRoot->updateWorldMatrixChildren();
+	if (LLParallelFor::getShared())
+	{
+		// Done for all avatars at once in updatePendingSkeletons(). Anything
+		// reading joint transforms before then goes through the lazy
+		// getWorldPosition()/getWorldRotation() path.
+		sPendingSkeletonUpdates.push_back(this);
+	}
+	else
+	{
+		mRoot->updateWorldMatrixChildren();
+	}
+	// </FS>
 
     if (visible)
     {
@@ -5332,6 +5406,114 @@ void LLVOAvatar::updateHeadOffset()
 	}
 }
 
+// <FS> Shared skinning palettes
+static LLTrace::BlockTimerStatHandle FTM_SKINNING_PALETTE("Skinning Palettes");
+
+// Palettes nobody asked for in this many frames are freed
+static const U32 SKINNING_PALETTE_PURGE_FRAMES = 64;
+
+bool LLVOAvatar::SkinningPalette::matches(const LLMeshSkinInfo* skin, U32 count)
+{
+	if (mJointNums.size() != count)
+	{
+		return false;
+	}
+	if (skin->mMeshID.notNull() && skin->mMeshID == mMeshID)
+	{
+		// mesh assets don't change, and this avatar maps its joint names the same way
+		return true;
+	}
+	if (memcmp(&mJointNums[0], &skin->mJointNums[0], count * sizeof(S32)))
+	{
+		return false;
+	}
+	for (U32 j = 0; j < count; ++j)
+	{
+		if (memcmp(mInvBindMatrix[j].mMatrix, skin->mInvBindMatrix[j].mMatrix, sizeof(mInvBindMatrix[j].mMatrix)))
+		{
+			return false;
+		}
+	}
+	mMeshID = skin->mMeshID;
+	return true;
+}
+
+void LLVOAvatar::SkinningPalette::setSource(const LLMeshSkinInfo* skin, U32 count)
+{
+	mJointNums.assign(skin->mJointNums.begin(), skin->mJointNums.begin() + count);
+	mInvBindMatrix.assign(skin->mInvBindMatrix.begin(), skin->mInvBindMatrix.begin() + count);
+	mMeshID = skin->mMeshID;
+}
+
+LLMatrix4a* LLVOAvatar::getSkinningMatrixPalette(const LLMeshSkinInfo* skin, U32 count)
+{
+	if (!count)
+	{
+		return NULL;
+	}
+
+	// sets up skin->mPaletteHash too
+	LLSkinningUtil::initJointNums(const_cast<LLMeshSkinInfo*>(skin), this);
+
+	const U32 frame = LLFrameTimer::getFrameCount();
+	if (frame - mLastSkinningPalettePurgeFrame >= SKINNING_PALETTE_PURGE_FRAMES)
+	{
+		mLastSkinningPalettePurgeFrame = frame;
+		for (skinning_palette_map_t::iterator it = mSkinningPalettes.begin(); it != mSkinningPalettes.end(); )
+		{
+			if (frame - it->second->mFrame >= SKINNING_PALETTE_PURGE_FRAMES)
+			{
+				delete it->second;
+				it = mSkinningPalettes.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	SkinningPalette* palette = NULL;
+	std::pair<skinning_palette_map_t::iterator, skinning_palette_map_t::iterator> range =
+		mSkinningPalettes.equal_range(skin->mPaletteHash);
+	for (skinning_palette_map_t::iterator it = range.first; it != range.second; ++it)
+	{
+		if (it->second->matches(skin, count))
+		{
+			palette = it->second;
+			break;
+		}
+	}
+	if (!palette)
+	{
+		palette = new SkinningPalette;
+		palette->mFrame = frame - 1;
+		palette->mSkeletonUpdateCount = 0;
+		palette->mSkeletonSerialNum = 0;
+		palette->setSource(skin, count);
+		mSkinningPalettes.insert(std::make_pair(skin->mPaletteHash, palette));
+	}
+
+	// FIRE-23331: joints can move several times a frame while editing appearance
+	static LLCachedControl<bool> disable_cache(gSavedSettings, "FSDisableRiggedMeshMatrixCaching");
+	if (disable_cache || (isSelf() && isEditingAppearance()) ||
+		palette->mFrame != frame ||
+		palette->mSkeletonUpdateCount != mSkeletonUpdateCount ||
+		palette->mSkeletonSerialNum != getSkeletonSerialNum() ||
+		palette->mMatrices.size() != count)
+	{
+		LL_RECORD_BLOCK_TIME(FTM_SKINNING_PALETTE);
+		palette->mMatrices.resize(count);
+		LLSkinningUtil::initSkinningMatrixPalette(&palette->mMatrices[0], count, skin, this);
+		palette->mFrame = frame;
+		palette->mSkeletonUpdateCount = mSkeletonUpdateCount;
+		palette->mSkeletonSerialNum = getSkeletonSerialNum();
+	}
+
+	return &palette->mMatrices[0];
+}
+// </FS>
+
 void LLVOAvatar::debugBodySize() const
 {
 	LLVector3 pelvis_scale = mPelvisp->getScale();
@@ -31,6 +31,7 @@
 #include <map>
 #include <deque>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/signals2/trackable.hpp>
@@ -53,6 +54,7 @@
 #include "llviewerstats.h"
 #include "llvovolume.h"
 #include "llavatarrendernotifier.h"
+#include "llalignedarray.h"
 
 extern const LLUUID ANIM_AGENT_BODY_NOISE;
 extern const LLUUID ANIM_AGENT_BREATHE_ROT;
@@ -114,6 +116,10 @@ public:
 	static void			initClass(); // Initialize data that's only init'd once per class.
 	static void			cleanupClass();	// Cleanup data that's only init'd once per class.
 	static void initCloud();
+	// <FS> Skeleton matrices are updated for all avatars at once after the
+	// idle loop, on the shared worker pool when there is one.
+	static void			updatePendingSkeletons();
+	// </FS>
 	virtual void 		initInstance(); // Called after construction to initialize the class.
 protected:
 	virtual				~LLVOAvatar();
@@ -525,6 +531,12 @@ public:
 	U32 		renderRigid();
 	U32 		renderSkinned();
 	F32			getLastSkinTime() { return mLastSkinTime; }
+	// <FS> Shared skinning palettes
+	// Returns the inverse bind x joint world matrix palette for skin.  It is
+	// computed at most once per frame and shared by every rigged mesh on
+	// this avatar with the same joints and inverse bind matrices.
+	LLMatrix4a*	getSkinningMatrixPalette(const LLMeshSkinInfo* skin, U32 count);
+	// </FS>
 	U32 		renderTransparent(BOOL first_pass);
 	void 		renderCollisionVolumes();
 	void		renderBones(const std::string &selected_joint = std::string());
@@ -544,6 +556,28 @@ private:
 	BOOL 		mNeedsSkin; // avatar has been animated and verts have not been updated
 	F32			mLastSkinTime; //value of gFrameTimeSeconds at last skin update
 
+	// <FS> Shared skinning palettes
+	struct SkinningPalette
+	{
+		// The map below is keyed by a hash of the skin, so every hit is
+		// checked against the joints and inverse bind matrices it was built from
+		bool matches(const LLMeshSkinInfo* skin, U32 count);
+		void setSource(const LLMeshSkinInfo* skin, U32 count);
+
+		LLAlignedArray<LLMatrix4a, 64>	mMatrices;
+		U32								mFrame;
+		U32								mSkeletonUpdateCount;
+		U32								mSkeletonSerialNum;
+		std::vector<S32>				mJointNums;
+		std::vector<LLMatrix4>			mInvBindMatrix;
+		LLUUID							mMeshID;	// last mesh found to match
+	};
+	typedef std::unordered_multimap<size_t, SkinningPalette*> skinning_palette_map_t;
+	skinning_palette_map_t	mSkinningPalettes;
+	U32						mLastSkinningPalettePurgeFrame;
+	U32						mSkeletonUpdateCount;	// bumped whenever motions may have moved joints
+	// </FS>
+
 	S32	 		mUpdatePeriod;
 	S32  		mNumInitFaces; //number of faces generated when creating the avatar drawable, does not inculde splitted faces due to long vertex buffer.
 
@@ -0,0 +1,208 @@
+/**
+ * @file llvolumegenthread.cpp
+ * @brief Generates prim and sculpt volume LODs off the main thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llvolumegenthread.h"
+
+#include "llimage.h"
+#include "llprimitive.h"
+#include "llviewerobjectlist.h"
+#include "llvovolume.h"
+
+static LLTrace::BlockTimerStatHandle FTM_VOLUME_GEN_THREAD("Generate Volumes (thread)");
+static LLTrace::BlockTimerStatHandle FTM_VOLUME_GEN_NOTIFY("Adopt Generated Volumes");
+
+LLVolumeGenThread::Request::Request(const LLVolumeParams& params, S32 detail)
+:	mParams(params),
+	mDetail(detail),
+	mSculpt(false),
+	mSculptWidth(0),
+	mSculptHeight(0),
+	mSculptComponents(0),
+	mSculptLevel(-2),
+	mVisiblePlaceholder(false)
+{
+}
+
+LLVolumeGenThread::LLVolumeGenThread()
+:	LLThread("Volume Generation")
+{
+	mMutex = new LLMutex();
+}
+
+LLVolumeGenThread::~LLVolumeGenThread()
+{
+	shutdown();
+
+	// whatever is left was never adopted, nobody is waiting for it any more
+	for (S32 i = 0; i < LLVolumeLODGroup::NUM_LODS; ++i)
+	{
+		for (request_map_t::iterator iter = mRequests[i].begin(); iter != mRequests[i].end(); ++iter)
+		{
+			delete iter->second;
+		}
+		mRequests[i].clear();
+	}
+	mQueue.clear();
+	mComplete.clear();
+
+	delete mMutex;
+	mMutex = NULL;
+}
+
+void LLVolumeGenThread::shutdown()
+{
+	LLThread::shutdown();
+
+	// the worker is gone, anything it didn't get to is finished without a volume
+	LLMutexLock lock(mMutex);
+	mComplete.insert(mComplete.end(), mQueue.begin(), mQueue.end());
+	mQueue.clear();
+}
+
+void LLVolumeGenThread::requestVolume(const LLUUID& object_id, const LLVolumeParams& params, S32 detail,
+									  const LLImageRaw* sculpt_image, S32 sculpt_level, bool visible_placeholder)
+{
+	llassert(detail >= 0 && detail < LLVolumeLODGroup::NUM_LODS);
+
+	request_map_t::iterator iter = mRequests[detail].find(&params);
+	if (iter != mRequests[detail].end())
+	{
+		iter->second->mObjects.insert(object_id);
+		return;
+	}
+
+	Request* req = new Request(params, detail);
+	req->mObjects.insert(object_id);
+	if (sculpt_image)
+	{
+		req->mSculpt = true;
+		if (sculpt_image->getData())
+		{
+			req->mSculptWidth = sculpt_image->getWidth();
+			req->mSculptHeight = sculpt_image->getHeight();
+			req->mSculptComponents = sculpt_image->getComponents();
+			req->mSculptData.assign(sculpt_image->getData(), sculpt_image->getData() + sculpt_image->getDataSize());
+		}
+	}
+	req->mSculptLevel = sculpt_level;
+	req->mVisiblePlaceholder = visible_placeholder;
+
+	mRequests[detail][&req->mParams] = req;
+
+	{
+		LLMutexLock lock(mMutex);
+		mQueue.push_back(req);
+	}
+	wake();
+}
+
+void LLVolumeGenThread::notifyGeneratedVolumes()
+{
+	std::deque<Request*> complete;
+	{
+		LLMutexLock lock(mMutex);
+		if (mComplete.empty())
+		{
+			return;
+		}
+		complete.swap(mComplete);
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_VOLUME_GEN_NOTIFY);
+
+	LLVolumeMgr* volume_mgr = LLPrimitive::getVolumeManager();
+	for (std::deque<Request*>::iterator iter = complete.begin(); iter != complete.end(); ++iter)
+	{
+		Request* req = *iter;
+		mRequests[req->mDetail].erase(&req->mParams);
+
+		if (req->mVolume.notNull())
+		{
+			// if nothing uses these params any more, or the LOD was generated
+			// on the main thread meanwhile, the volume is simply dropped
+			volume_mgr->adoptVolume(req->mVolume, req->mDetail);
+		}
+
+		for (std::set<LLUUID>::iterator obj_iter = req->mObjects.begin(); obj_iter != req->mObjects.end(); ++obj_iter)
+		{
+			LLVOVolume* vobj = dynamic_cast<LLVOVolume*>(gObjectList.findObject(*obj_iter));
+			if (vobj && !vobj->isDead())
+			{
+				vobj->notifyVolumeGenerated();
+			}
+		}
+
+		delete req;
+	}
+}
+
+bool LLVolumeGenThread::runCondition()
+{
+	LLMutexLock lock(mMutex);
+	return !mQueue.empty();
+}
+
+void LLVolumeGenThread::run()
+{
+	while (!isQuitting())
+	{
+		checkPause();
+
+		Request* req = NULL;
+		{
+			LLMutexLock lock(mMutex);
+			if (isQuitting() || mQueue.empty())
+			{
+				continue;
+			}
+			req = mQueue.front();
+			mQueue.pop_front();
+		}
+
+		generate(req);
+
+		LLMutexLock lock(mMutex);
+		mComplete.push_back(req);
+	}
+}
+
+void LLVolumeGenThread::generate(Request* req)
+{
+	LL_RECORD_BLOCK_TIME(FTM_VOLUME_GEN_THREAD);
+
+	// same construction as LLVolumeLODGroup::refLOD(), which for sculpties
+	// leaves the faces to sculpt()
+	req->mVolume = new LLVolume(req->mParams, LLVolumeLODGroup::getVolumeScaleFromDetail(req->mDetail));
+
+	if (req->mSculpt)
+	{
+		const U8* data = req->mSculptData.empty() ? NULL : &req->mSculptData[0];
+		req->mVolume->sculpt(req->mSculptWidth, req->mSculptHeight, req->mSculptComponents,
+							 data, req->mSculptLevel, req->mVisiblePlaceholder);
+	}
+}
@@ -0,0 +1,112 @@
+/**
+ * @file llvolumegenthread.h
+ * @brief Generates prim and sculpt volume LODs off the main thread.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEGENTHREAD_H
+#define LL_LLVOLUMEGENTHREAD_H
+
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "llthread.h"
+#include "llvolume.h"
+#include "llvolumemgr.h"
+
+class LLImageRaw;
+
+/**
+ * @class LLVolumeGenThread
+ * @brief Builds LLVolume LODs for prims and sculpties on a worker thread.
+ *
+ * Objects whose LOD is not in the volume manager yet queue a request here
+ * and keep drawing the volume they already have.  Finished volumes are
+ * handed to LLVolumeMgr from notifyGeneratedVolumes(), which runs once per
+ * frame on the main thread; the waiting objects are then marked for rebuild
+ * and pick up the shared volume through the usual refVolume() path.
+ */
+class LLVolumeGenThread : public LLThread
+{
+public:
+	LLVolumeGenThread();
+	/*virtual*/ ~LLVolumeGenThread();
+
+	// MAIN THREAD
+	// Queues the detail LOD of params on behalf of object_id.  For sculpties
+	// the sculpt map is copied, so the texture may go on changing meanwhile.
+	void requestVolume(const LLUUID& object_id, const LLVolumeParams& params, S32 detail,
+					   const LLImageRaw* sculpt_image = NULL, S32 sculpt_level = -2,
+					   bool visible_placeholder = false);
+
+	// MAIN THREAD
+	// Adopts finished volumes and notifies the objects waiting on them.
+	// After shutdown() this flushes every outstanding request so waiting
+	// objects fall back to generating on the main thread.
+	void notifyGeneratedVolumes();
+
+	/*virtual*/ void shutdown();
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	struct Request
+	{
+		Request(const LLVolumeParams& params, S32 detail);
+
+		LLVolumeParams		mParams;
+		S32					mDetail;
+
+		// sculpt input, only used if mSculpt is set
+		bool				mSculpt;
+		std::vector<U8>		mSculptData;
+		U16					mSculptWidth;
+		U16					mSculptHeight;
+		S8					mSculptComponents;
+		S32					mSculptLevel;
+		bool				mVisiblePlaceholder;
+
+		// output, filled in by the worker
+		LLPointer<LLVolume>	mVolume;
+
+		// MAIN THREAD only
+		std::set<LLUUID>	mObjects;
+	};
+
+	void generate(Request* req);
+
+	// MAIN THREAD only, requests by params for each LOD so duplicates coalesce
+	typedef std::map<const LLVolumeParams*, Request*, LLVolumeParams::compare> request_map_t;
+	request_map_t mRequests[LLVolumeLODGroup::NUM_LODS];
+
+	// guarded by mMutex
+	LLMutex* mMutex;
+	std::deque<Request*> mQueue;
+	std::deque<Request*> mComplete;
+};
+
+#endif // LL_LLVOLUMEGENTHREAD_H
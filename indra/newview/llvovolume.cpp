@@ -94,6 +94,8 @@
 // [/RLVa:KB]
 #include "llviewernetwork.h"
 #include "fsperfstats.h" // <FS:Beq> performance stats support
+#include "llparallelfor.h" // <FS/> Parallel geometry fill
+#include "llvolumegenthread.h" // <FS/> Background volume generation
 
 const F32 FORCE_SIMPLE_RENDER_AREA = 512.f;
 const F32 FORCE_CULL_AREA = 8.f;
@@ -115,6 +117,8 @@ static LLTrace::BlockTimerStatHandle FTM_GEN_TRIANGLES("Generate Triangles");
 static LLTrace::BlockTimerStatHandle FTM_GEN_VOLUME("Generate Volumes");
 static LLTrace::BlockTimerStatHandle FTM_VOLUME_TEXTURES("Volume Textures");
 
+static LLVolumeGenThread* sVolumeGenThread = NULL; // <FS/> Background volume generation
+
 extern BOOL gGLDebugLoggingEnabled;
 
 // NaCl - Graphics crasher protection
@@ -330,6 +334,10 @@ void LLVOVolume::initClass()
 		sObjectMediaNavigateClient = new LLObjectMediaNavigateClient(queue_timer_delay, retry_timer_delay, 
 																	 max_retries, max_sorted_queue_size, max_round_robin_queue_size);
 	}
+
+	LLVolumeGeometryManager::setGeometryFillThreads(gSavedSettings.getS32("RenderGeometryFillThreads")); // <FS/> Parallel geometry fill
+	setBackgroundVolumeGeneration(gSavedSettings.getBOOL("RenderBackgroundVolumeGeneration")); // <FS/> Background volume generation
+	LLVolumeBVH::startBuildThread(); // <FS/> BVH picking
 }
 
 // static
@@ -337,7 +345,44 @@ void LLVOVolume::cleanupClass()
 {
     sObjectMediaClient = NULL;
     sObjectMediaNavigateClient = NULL;
+    LLVolumeGeometryManager::cleanupClass(); // <FS/> Parallel geometry fill
+    // <FS> Background volume generation
+    delete sVolumeGenThread;
+    sVolumeGenThread = NULL;
+    // </FS>
+    LLVolumeBVH::stopBuildThread(); // <FS/> BVH picking
+}
+
+// <FS> Background volume generation
+// static
+void LLVOVolume::setBackgroundVolumeGeneration(bool enable)
+{
+	if (enable && !sVolumeGenThread)
+	{
+		sVolumeGenThread = new LLVolumeGenThread();
+		sVolumeGenThread->start();
+	}
+	else if (!enable && sVolumeGenThread)
+	{
+		LLVolumeGenThread* thread = sVolumeGenThread;
+		sVolumeGenThread = NULL;
+
+		// objects still waiting on the thread rebuild on the main thread instead
+		thread->shutdown();
+		thread->notifyGeneratedVolumes();
+		delete thread;
+	}
+}
+
+// static
+void LLVOVolume::notifyGeneratedVolumes()
+{
+	if (sVolumeGenThread)
+	{
+		sVolumeGenThread->notifyGeneratedVolumes();
+	}
 }
+// </FS>
 
 U32 LLVOVolume::processUpdateMessage(LLMessageSystem *mesgsys,
 										  void **user_data,
@@ -1335,6 +1380,24 @@ void LLVOVolume::notifyMeshLoaded()
     updateVisualComplexity();
 }
 
+// <FS> Background volume generation
+// Called on the main thread once the LOD queued by requestVolumeGeneration()
+// has been generated, or given up on.  calcLOD() already moved mLOD on, so
+// the rebuild takes the adopted volume from the volume manager through
+// lodOrSculptChanged(), or generates it there if the thread didn't.
+void LLVOVolume::notifyVolumeGenerated()
+{
+	if (mDrawable.isNull())
+	{
+		return;
+	}
+
+	LL_DEBUGS("VolumeGen") << "LOD " << mLOD << " ready for " << mID << LL_ENDL;
+	mLODChanged = TRUE;
+	gPipeline.markRebuild(mDrawable, LLDrawable::REBUILD_VOLUME, FALSE);
+}
+// </FS>
+
 // sculpt replaces generate() for sculpted surfaces
 void LLVOVolume::sculpt()
 {	
@@ -2080,7 +2143,13 @@ bool LLVOVolume::lodOrSculptChanged(LLDrawable *drawable, BOOL &compiled)
 	{
 		LL_RECORD_BLOCK_TIME(FTM_GEN_VOLUME);
 		const LLVolumeParams &volume_params = getVolume()->getParams();
-		setVolume(volume_params, 0);
+		// <FS> Background volume generation
+		//setVolume(volume_params, 0);
+		if (!requestVolumeGeneration(volume_params))
+		{
+			setVolume(volume_params, 0);
+		}
+		// </FS>
 	}
 
 	new_volumep = getVolume();
@@ -2129,6 +2198,56 @@ bool LLVOVolume::lodOrSculptChanged(LLDrawable *drawable, BOOL &compiled)
 	return regen_faces;
 }
 
+// <FS> Background volume generation
+// Queues mLOD on the volume generation thread when a plain LOD change would
+// otherwise generate it here.  Returns true if the current volume should stay
+// in place until LLVolumeGenThread calls notifyVolumeGenerated().
+bool LLVOVolume::requestVolumeGeneration(const LLVolumeParams &volume_params)
+{
+	if (!sVolumeGenThread || mVolumeChanged || mSculptChanged || mVolumeImpl || isMesh())
+	{
+		return false;
+	}
+
+	LLVolume* volume = getVolume();
+	if (!volume || volume->isUnique() || mLOD == LLVolumeLODGroup::getVolumeDetailFromScale(volume->getDetail()))
+	{
+		return false;
+	}
+
+	if (LLPrimitive::getVolumeManager()->hasVolume(volume_params, mLOD))
+	{
+		// shared with something already drawing that LOD, nothing to generate
+		return false;
+	}
+
+	if (isSculpted())
+	{
+		// only queue sculpties whose map sculpt() would use as is, placeholders
+		// and missing data keep going through the synchronous path
+		if (mSculptTexture.isNull())
+		{
+			return false;
+		}
+
+		S32 discard_level = llmin(mSculptTexture->getCachedRawImageLevel(), mSculptTexture->getMaxDiscardLevel());
+		LLImageRaw* raw_image = mSculptTexture->getCachedRawImage();
+		if (!raw_image || discard_level < 0 || discard_level > MAX_DISCARD_LEVEL)
+		{
+			return false;
+		}
+
+		sVolumeGenThread->requestVolume(mID, volume_params, mLOD, raw_image, discard_level, mSculptTexture->isMissingAsset());
+	}
+	else
+	{
+		sVolumeGenThread->requestVolume(mID, volume_params, mLOD);
+	}
+
+	return true;
+}
+// </FS>
+
 BOOL LLVOVolume::updateGeometry(LLDrawable *drawable)
 {
 	LL_RECORD_BLOCK_TIME(FTM_UPDATE_PRIMITIVES);
@@ -5076,14 +5195,17 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
 
 
 	//build matrix palette
-	static const size_t kMaxJoints = LL_MAX_JOINTS_PER_MESH_OBJECT;
+	// <FS> Shared skinning palettes
+	//static const size_t kMaxJoints = LL_MAX_JOINTS_PER_MESH_OBJECT;
 
-	LLMatrix4a mat[kMaxJoints];
+	//LLMatrix4a mat[kMaxJoints];
 	U32 maxJoints = LLSkinningUtil::getMeshJointCount(skin);
 	//<FS:Beq> Skinning Matrix caching
 	//LLSkinningUtil::initSkinningMatrixPalette((LLMatrix4)mat, maxJoints, skin, avatar);
-	LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
+	//LLSkinningUtil::initSkinningMatrixPalette(mat, maxJoints, skin, avatar);
 	//</FS:Beq>
+	LLMatrix4a* mat = avatar->getSkinningMatrixPalette(skin, maxJoints);
+	// </FS>
 
     S32 rigged_vert_count = 0;
     S32 rigged_face_count = 0;
@@ -5189,23 +5311,31 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
 				delete dst_face.mOctree;
 				dst_face.mOctree = NULL;
 
-				LLVector4a size;
-				size.setSub(dst_face.mExtents[1], dst_face.mExtents[0]);
-				size.splat(size.getLength3().getF32()*0.5f);
-			
-				// <FS:ND> Create a debug log for octree insertions if requested.
-				static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
-				bool _debugOT( debugOctree );
-				if( _debugOT )
-					nd::octree::debug::gOctreeDebug += 1;
-				// </FS:ND>
-				
-				dst_face.createOctree(1.f);
-			
-				// <FS:ND> Reset octree log
-				if( _debugOT )
-					nd::octree::debug::gOctreeDebug -= 1;
-				// </FS:ND>
+				// <FS> BVH picking
+				// Picks go through the face's BVH now.  Skinning only moves the
+				// vertices, so a built tree is refit to the new positions instead
+				// of being rebuilt; the octree is only recreated on demand by the
+				// raycast debug display.
+				dst_face.refitBVH();
+
+				//LLVector4a size;
+				//size.setSub(dst_face.mExtents[1], dst_face.mExtents[0]);
+				//size.splat(size.getLength3().getF32()*0.5f);
+				//
+				//// <FS:ND> Create a debug log for octree insertions if requested.
+				//static LLCachedControl<bool> debugOctree(gSavedSettings,"FSCreateOctreeLog");
+				//bool _debugOT( debugOctree );
+				//if( _debugOT )
+				//	nd::octree::debug::gOctreeDebug += 1;
+				//// </FS:ND>
+				//
+				//dst_face.createOctree(1.f);
+				//
+				//// <FS:ND> Reset octree log
+				//if( _debugOT )
+				//	nd::octree::debug::gOctreeDebug -= 1;
+				//// </FS:ND>
+				// </FS>
 			}
 		}
 	}
@@ -5300,6 +5430,14 @@ bool can_batch_texture(LLFace* facep)
 
 const static U32 MAX_FACE_COUNT = 4096U;
 int32_t LLVolumeGeometryManager::sInstanceCount = 0;
+// <FS> Parallel geometry fill
+std::vector<LLVolumeGeometryManager::GeometryFill> LLVolumeGeometryManager::sGeometryFills;
+std::vector<LLPointer<LLVertexBuffer> > LLVolumeGeometryManager::sFillBuffers;
+
+static const S32 MAX_GEOMETRY_FILL_THREADS = 8;
+static LLParallelFor* sGeometryFillPool = NULL;
+static LLTrace::BlockTimerStatHandle FTM_REBUILD_VOLUME_FILL("Volume Geometry Fill");
+// </FS>
 LLFace** LLVolumeGeometryManager::sFullbrightFaces = NULL;
 LLFace** LLVolumeGeometryManager::sBumpFaces = NULL;
 LLFace** LLVolumeGeometryManager::sSimpleFaces = NULL;
@@ -6373,6 +6511,8 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
 	geometryBytes += genDrawInfo(group, spec_mask | LLVertexBuffer::MAP_TEXTURE_INDEX, sSpecFaces, spec_count, FALSE, FALSE);
 	geometryBytes += genDrawInfo(group, normspec_mask | LLVertexBuffer::MAP_TEXTURE_INDEX, sNormSpecFaces, normspec_count, FALSE, FALSE);
 
+	fillGeometry(); // <FS/> Parallel geometry fill
+
 	group->mGeometryBytes = geometryBytes;
 
 	if (!LLPipeline::sDelayVBUpdate)
@@ -6400,6 +6540,104 @@ void LLVolumeGeometryManager::rebuildGeom(LLSpatialGroup* group)
 	mFaceList.clear();
 }
 
+// <FS> Parallel geometry fill
+//static
+void LLVolumeGeometryManager::setGeometryFillThreads(S32 thread_count)
+{
+	if (thread_count < 0)
+	{
+		thread_count = llmin(LLParallelFor::getDefaultWorkerCount(), MAX_GEOMETRY_FILL_THREADS);
+	}
+	thread_count = llmin(thread_count, MAX_GEOMETRY_FILL_THREADS);
+
+	if (thread_count == 0)
+	{
+		// rebuilds are never in flight here, so nothing is left pending
+		delete sGeometryFillPool;
+		sGeometryFillPool = NULL;
+	}
+	else if (!sGeometryFillPool)
+	{
+		sGeometryFillPool = new LLParallelFor("VolumeGeometryFill", thread_count);
+	}
+	else
+	{
+		sGeometryFillPool->setWorkerCount(thread_count);
+	}
+}
+
+//static
+void LLVolumeGeometryManager::cleanupClass()
+{
+	sGeometryFills.clear();
+	sFillBuffers.clear();
+	delete sGeometryFillPool;
+	sGeometryFillPool = NULL;
+}
+
+// Second half of a rebuild: genDrawInfo() allocated every face's range of
+// its vertex buffer, so the faces write to disjoint memory and can be
+// filled at the same time.  Mapping and the upload stay on this thread.
+void LLVolumeGeometryManager::fillGeometry()
+{
+	if (sGeometryFills.empty() && sFillBuffers.empty())
+	{
+		return;
+	}
+
+	LL_RECORD_BLOCK_TIME(FTM_REBUILD_VOLUME_FILL);
+
+	// A face whose buffer fails to map is filled the old way, here and now,
+	// which retries the map and warns if it fails again.
+	std::vector<GeometryFill>& fills = sGeometryFills;
+	for (std::vector<GeometryFill>::iterator iter = fills.begin(); iter != fills.end(); )
+	{
+		LLFace* facep = iter->mFace;
+		if (facep->mapGeometryVolume(facep->getTEOffset()))
+		{
+			++iter;
+			continue;
+		}
+
+		if (!facep->getGeometryVolume(*iter->mVolume, facep->getTEOffset(),
+			iter->mMatVert, iter->mMatNormal, iter->mIndexOffset, true))
+		{
+			LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
+		}
+		iter = fills.erase(iter);
+	}
+
+	LLParallelFor::func_t fill_face = [&fills](S32 i)
+	{
+		GeometryFill& fill = fills[i];
+		if (!fill.mFace->getGeometryVolume(*fill.mVolume, fill.mFace->getTEOffset(),
+			fill.mMatVert, fill.mMatNormal, fill.mIndexOffset, true, true))
+		{
+			LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
+		}
+	};
+
+	if (sGeometryFillPool && fills.size() > 1)
+	{
+		sGeometryFillPool->run((S32)fills.size(), fill_face);
+	}
+	else
+	{
+		for (S32 i = 0; i < (S32)fills.size(); ++i)
+		{
+			fill_face(i);
+		}
+	}
+	fills.clear();
+
+	for (std::vector<LLPointer<LLVertexBuffer> >::iterator iter = sFillBuffers.begin(); iter != sFillBuffers.end(); ++iter)
+	{
+		(*iter)->flush();
+	}
+	sFillBuffers.clear();
+}
+// </FS>
+
 static LLTrace::BlockTimerStatHandle FTM_REBUILD_MESH_FLUSH("Flush Mesh");
 
 void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
@@ -6905,11 +7143,28 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
 
 					llassert(!facep->isState(LLFace::RIGGED));
 
-					if (!facep->getGeometryVolume(*volume, te_idx, 
+					// <FS> Parallel geometry fill
+					//if (!facep->getGeometryVolume(*volume, te_idx, 
+					//	vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
+					//{
+					//	LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
+					//}
+					if (sGeometryFillPool)
+					{ //the range is allocated, fill it in fillGeometry() with the other faces of this rebuild
+						GeometryFill fill;
+						fill.mFace = facep;
+						fill.mVolume = volume;
+						fill.mMatVert = vobj->getRelativeXform();
+						fill.mMatNormal = vobj->getRelativeXformInvTrans();
+						fill.mIndexOffset = index_offset;
+						sGeometryFills.push_back(fill);
+					}
+					else if (!facep->getGeometryVolume(*volume, te_idx, 
 						vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
 					{
 						LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
 					}
+					// </FS>
 
 					if (drawablep->isState(LLDrawable::ANIMATED_CHILD))
 					{
@@ -7218,10 +7473,20 @@ U32 LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFace
 			++face_iter;
 		}
 
-		if (buffer)
+		// <FS> Parallel geometry fill
+		//if (buffer)
+		//{
+		//	buffer->flush();
+		//}
+		if (buffer && sGeometryFillPool && !LLPipeline::sDelayVBUpdate)
+		{ //upload after fillGeometry()
+			sFillBuffers.push_back(buffer);
+		}
+		else if (buffer)
 		{
 			buffer->flush();
 		}
+		// </FS>
 	}
 
 	group->mBufferMap[mask].clear();
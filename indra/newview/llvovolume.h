@@ -105,6 +105,10 @@ public:
 	static		void	initClass();
 	static		void	cleanupClass();
 	static		void	preUpdateGeom();
+	// <FS> Background volume generation
+	static		void	setBackgroundVolumeGeneration(bool enable);
+	static		void	notifyGeneratedVolumes();
+	// </FS>
 	
 	enum 
 	{
@@ -352,6 +356,7 @@ public:
     void updateVisualComplexity();
     
 	void notifyMeshLoaded();
+	void notifyVolumeGenerated(); // <FS/> Background volume generation
 	
 	// Returns 'true' iff the media data for this object is in flight
 	bool isMediaDataBeingFetched() const;
@@ -395,6 +400,7 @@ protected:
 
 private:
 	bool lodOrSculptChanged(LLDrawable *drawable, BOOL &compiled);
+	bool requestVolumeGeneration(const LLVolumeParams &volume_params); // <FS/> Background volume generation
 
 public:
 
@@ -3067,6 +3067,7 @@ void LLPipeline::rebuildPriorityGroups()
 	assertInitialized();
 
 	gMeshRepo.notifyLoadedMeshes();
+	LLVOVolume::notifyGeneratedVolumes(); // <FS/> Background volume generation
 
 	mGroupQ1Locked = true;
 	// Iterate through all drawables on the priority build queue,
@@ -0,0 +1,279 @@
+/**
+ * @file llgroupmemberindex_test.cpp
+ * @brief Test cases for LLGroupMemberIndex
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Dependencies
+#include "linden_common.h"
+#include "llavatarname.h"
+#include "llavatarnamecache.h"
+#include "../llgroupmgr.h"
+// Class to test
+#include "../llgroupmemberindex.h"
+// Tut header
+#include "../test/lltut.h"
+
+#include <set>
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: Declarations required to link and run the class being tested
+// Notes:
+// * Add here stubbed implementation of the few classes and methods used in the class to be tested
+// * Add as little as possible (let the link errors guide you)
+// * Do not make any assumption as to how those classes or methods work (i.e. don't copy/paste code)
+// * A simulator for a class can be implemented here. Please comment and document thoroughly.
+
+// Name cache simulator: only the names in this map are known
+static std::map<LLUUID, std::string> gKnownNames;
+
+LLAvatarName::LLAvatarName() { }
+void LLAvatarName::fromString(const std::string& full_name) { mDisplayName = full_name; }
+std::string LLAvatarName::getCompleteName(bool, bool) const { return mDisplayName; }
+
+bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
+{
+	std::map<LLUUID, std::string>::const_iterator it = gKnownNames.find(agent_id);
+	if (it == gKnownNames.end())
+	{
+		return false;
+	}
+	av_name->fromString(it->second);
+	return true;
+}
+
+// Group data simulator: members keep their own title and status strings
+static std::set<std::string> gMemberStrings;
+
+LLGroupMemberData::LLGroupMemberData(const LLUUID& id, S32 contribution, U64 agent_powers,
+									 const std::string& title, const std::string& online_status, BOOL is_owner)
+:	mID(id),
+	mAgentPowers(agent_powers),
+	mTitle(&*gMemberStrings.insert(title).first),
+	mOnlineStatus(&*gMemberStrings.insert(online_status).first),
+	mContribution(contribution),
+	mIsOwner(is_owner)
+{ }
+LLGroupMemberData::~LLGroupMemberData() { }
+
+LLGroupMgrGroupData::LLGroupMgrGroupData(const LLUUID& id) : mID(id) { }
+LLGroupMgrGroupData::~LLGroupMgrGroupData() { }
+
+// End Stubbing
+// -------------------------------------------------------------------------------------------
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+namespace tut
+{
+	// Test wrapper declarations
+	struct groupmemberindex_test
+	{
+		groupmemberindex_test()
+		:	mGroup(LLUUID::null),
+			mLastID(0)
+		{
+			gKnownNames.clear();
+		}
+
+		~groupmemberindex_test()
+		{
+			for (LLGroupMgrGroupData::member_list_t::iterator it = mGroup.mMembers.begin(); it != mGroup.mMembers.end(); ++it)
+			{
+				delete it->second;
+			}
+		}
+
+		LLUUID addMember(const std::string& name, S32 contribution, const std::string& title, bool name_known = true)
+		{
+			LLUUID id;
+			id.mData[0] = ++mLastID;
+			mGroup.mMembers[id] = new LLGroupMemberData(id, contribution, 0, title, "Online", FALSE);
+			if (name_known)
+			{
+				gKnownNames[id] = name;
+			}
+			mNames[id] = name;
+			return id;
+		}
+
+		// Names of the rows in the order the index keeps for column
+		std::string sortedNames(const LLGroupMemberIndex& index, const std::string& column, bool ascending)
+		{
+			std::vector<S32> rows;
+			ensure("sorted by " + column, index.getSortedRows(column, ascending, rows));
+			ensure_equals("sorted row count", (S32)rows.size(), index.getRowCount());
+			std::string names;
+			for (std::vector<S32>::const_iterator it = rows.begin(); it != rows.end(); ++it)
+			{
+				names += (names.empty() ? "" : ",") + index.getCellText(*it, "name");
+			}
+			return names;
+		}
+
+		LLGroupMgrGroupData mGroup;
+		std::map<LLUUID, std::string> mNames;
+		U8 mLastID;
+	};
+
+	// Tut templating thingamagic: test group, object and test instance
+	typedef test_group<groupmemberindex_test> groupmemberindex_t;
+	typedef groupmemberindex_t::object groupmemberindex_object_t;
+	tut::groupmemberindex_t tut_groupmemberindex("LLGroupMemberIndex");
+
+	// ---------------------------------------------------------------------------------------
+	// Test functions
+	// ---------------------------------------------------------------------------------------
+	// Members are filed once their names are known
+	template<> template<>
+	void groupmemberindex_object_t::test<1>()
+	{
+		addMember("carol", 30, "Officer");
+		addMember("alice", 10, "Member");
+		LLUUID bob = addMember("bob", 20, "Member", false);
+
+		LLGroupMemberIndex index;
+		index.setGroup(&mGroup);
+		ensure_equals("nothing filed before update", index.getRowCount(), 0);
+
+		ensure("first update changes rows", index.update(10.f));
+		ensure_equals("members with names", index.getRowCount(), 2);
+		ensure("bob is waiting", !index.isComplete());
+		ensure("nothing new to file", !index.update(10.f));
+
+		gKnownNames[bob] = "bob";
+		ensure("bob filed", index.update(10.f));
+		ensure("all filed", index.isComplete());
+		ensure_equals("all members", index.getMemberCount(), 3);
+		ensure_equals("all rows", index.getRowCount(), 3);
+
+		std::set<LLUUID> values;
+		for (S32 row = 0; row < index.getRowCount(); ++row)
+		{
+			values.insert(index.getRowValue(row).asUUID());
+			ensure_equals("name of row", index.getCellText(row, "name"), mNames[index.getRowValue(row).asUUID()]);
+		}
+		ensure_equals("every member once", values.size(), (size_t)3);
+	}
+
+	// Orders merged from several updates equal a full sort
+	template<> template<>
+	void groupmemberindex_object_t::test<2>()
+	{
+		addMember("dave", 40, "Owner");
+		LLUUID carol = addMember("carol", 30, "Officer", false);
+		addMember("alice", 10, "Member");
+		LLUUID bob = addMember("bob", 20, "Member", false);
+
+		LLGroupMemberIndex index;
+		index.setGroup(&mGroup);
+		index.update(10.f);
+		gKnownNames[carol] = "carol";
+		index.update(10.f);
+		gKnownNames[bob] = "bob";
+		index.update(10.f);
+
+		ensure_equals("by name", sortedNames(index, "name", true), "alice,bob,carol,dave");
+		ensure_equals("by name descending", sortedNames(index, "name", false), "dave,carol,bob,alice");
+		ensure_equals("by donation", sortedNames(index, "donated", true), "alice,bob,carol,dave");
+		ensure_equals("by title", sortedNames(index, "title", true), "alice,bob,carol,dave");
+
+		std::vector<S32> rows;
+		ensure("unknown column is left to the list", !index.getSortedRows("nonesuch", true, rows));
+	}
+
+	// Filtering picks rows without filing again
+	template<> template<>
+	void groupmemberindex_object_t::test<3>()
+	{
+		addMember("Anna Resident", 0, "Member");
+		addMember("Bob Anderson", 0, "Member");
+		addMember("Carol Linden", 0, "Member");
+
+		LLGroupMemberIndex index;
+		index.setGroup(&mGroup);
+		index.update(10.f);
+
+		ensure("filter changes rows", index.setFilter("an"));
+		ensure("same filter changes nothing", !index.setFilter("an"));
+		ensure_equals("matching rows", index.getRowCount(), 2);
+		ensure_equals("filtered by name", sortedNames(index, "name", true), "Anna Resident,Bob Anderson");
+		ensure_equals("members stay filed", index.getMemberCount(), 3);
+
+		index.setFilter("");
+		ensure_equals("no filter", index.getRowCount(), 3);
+	}
+
+	// Ejected members leave the rows, the orders and the queue
+	template<> template<>
+	void groupmemberindex_object_t::test<4>()
+	{
+		addMember("alice", 10, "Member");
+		LLUUID bob = addMember("bob", 20, "Member");
+		addMember("carol", 30, "Member");
+		LLUUID dave = addMember("dave", 40, "Member", false);
+
+		LLGroupMemberIndex index;
+		index.setGroup(&mGroup);
+		index.update(10.f);
+
+		uuid_vec_t ejected;
+		ejected.push_back(bob);
+		ejected.push_back(dave);
+		index.removeMembers(ejected);
+
+		ensure_equals("members left", index.getMemberCount(), 2);
+		ensure("dave no longer waits", index.isComplete());
+		ensure_equals("by name", sortedNames(index, "name", true), "alice,carol");
+		ensure_equals("by donation descending", sortedNames(index, "donated", false), "carol,alice");
+
+		gKnownNames[dave] = "dave";
+		ensure("dave is not filed", !index.update(10.f));
+		ensure_equals("rows left", index.getRowCount(), 2);
+	}
+
+	// Cells are copied from the group data
+	template<> template<>
+	void groupmemberindex_object_t::test<5>()
+	{
+		addMember("alice", 1234, "Officer");
+
+		LLGroupMemberIndex index;
+		index.setDonationFormat("[AREA] m");
+		index.setGroup(&mGroup);
+		index.update(10.f);
+
+		ensure_equals("donated", index.getCellText(0, "donated"), "1234 m");
+		ensure_equals("title", index.getCellText(0, "title"), "Officer");
+		ensure_equals("online", index.getCellText(0, "online"), "Online");
+
+		LLSD element = index.getRowElement(0);
+		ensure_equals("element id", element["id"].asUUID(), index.getRowValue(0).asUUID());
+		ensure_equals("element columns", element["columns"].size(), 4);
+
+		index.clear();
+		ensure_equals("cleared", index.getRowCount(), 0);
+		ensure("nothing waits", index.isComplete());
+	}
+}
@@ -811,6 +811,48 @@ namespace tut
 		ensure("type is a string", v.isString());
 	}
 
+	template<> template<>
+	void SDTestObject::test<15>()
+		// common scalar values share static implementations
+	{
+		SDCleanupCheck check;
+
+		{
+			SDAllocationCheck check("common scalars", 0);
+			LLSD t = true;
+			LLSD f = false;
+			LLSD i = 0;
+			LLSD r = 0.0;
+			LLSD s = std::string();
+			LLSD u = LLUUID::null;
+			ensureTypeAndValue("shared true", t, true);
+			ensureTypeAndValue("shared false", f, false);
+			ensureTypeAndValue("shared integer zero", i, 0);
+			ensureTypeAndValue("shared real zero", r, 0.0);
+			ensureTypeAndValue("shared empty string", s, "");
+			ensureTypeAndValue("shared null uuid", u, LLUUID::null);
+		}
+
+		{
+			SDAllocationCheck check("negative zero is not shared", 1);
+			LLSD r = -0.0;
+			ensure("negative zero keeps its sign", std::signbit(r.asReal()));
+		}
+
+		{
+			SDAllocationCheck check("assigning over a shared scalar", 2);
+			LLSD a = 0;
+			LLSD b = 0;
+			a = 5;
+			ensureTypeAndValue("changed value", a, 5);
+			ensureTypeAndValue("other shared value unaltered", b, 0);
+			b = "nice day";
+			ensureTypeAndValue("changed type", b, "nice day");
+			ensureTypeAndValue("new zero unaltered", LLSD(0), 0);
+			ensureTypeAndValue("new empty string unaltered", LLSD(std::string()), "");
+		}
+	}
+
 	/* TO DO:
 		conversion of undefined to UUID, Date, URI and Binary
 		conversion of undefined to map and array
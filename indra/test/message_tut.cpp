@@ -30,10 +30,12 @@
 #include "lltut.h"
 #include "llhttpconstants.h"
 #include "llapr.h"
+#include "llcircuit.h"
 #include "llmessageconfig.h"
 #include "llsdserialize.h"
 #include "message.h"
 #include "message_prehash.h"
+#include "net.h"
 
 namespace
 {
@@ -48,6 +50,38 @@ namespace
 		virtual void extendedResult(S32 code, const LLSD& result, const LLSD& headers) { }
 		S32 mStatus;
 	};
+
+	// Exposes what the message system does to a circuit on receipt
+	struct LLCircuitDataPeer : public LLCircuitData
+	{
+		LLCircuitDataPeer(const LLHost& host) :
+			LLCircuitData(host, 0, F32Seconds(5.f), F32Seconds(100.f))
+		{
+		}
+
+		using LLCircuitData::isDuplicateResend;
+		using LLCircuitData::collectRAck;
+
+		// what LLMessageSystem::checkMessages() records for a reliable packet
+		void receiveReliable(TPACKETID id)
+		{
+			mRecentlyReceivedReliablePackets.add(id);
+		}
+	};
+
+	S32 receive_from_self(U8* buffer)
+	{
+		for (S32 tries = 0; tries < 100; ++tries)
+		{
+			S32 size = receive_packet(gMessageSystem->mSocket, (char*)buffer);
+			if (size > 0)
+			{
+				return size;
+			}
+			ms_sleep(10);
+		}
+		return 0;
+	}
 }
 
 namespace tut
@@ -143,5 +177,84 @@ namespace tut
 		gMessageSystem->dispatch(name, message, response);
 		ensure_equals(response->mStatus, HTTP_NOT_FOUND);
 	}
-}
 
+	template<> template<>
+	void LLMessageSystemTestObject::test<2>()
+		// duplicate suppression and clearDuplicateList() on a circuit
+	{
+		LLCircuitDataPeer circuit(LLHost("127.0.0.1", 13036));
+		for (TPACKETID id = 0xFFFF00; id != 0x000800; id = (id + 1) & 0xFFFFFF)
+		{
+			circuit.receiveReliable(id);
+		}
+		ensure("resend before wrap", circuit.isDuplicateResend(0xFFFF10));
+		ensure("resend after wrap", circuit.isDuplicateResend(0x000010));
+		ensure("not received yet", !circuit.isDuplicateResend(0x000800));
+
+		circuit.clearDuplicateList(0x000400);
+		ensure("older than the oldest forgotten", !circuit.isDuplicateResend(0x0003FF));
+		ensure("before the wrap forgotten", !circuit.isDuplicateResend(0xFFFF10));
+		ensure("oldest kept", circuit.isDuplicateResend(0x000400));
+		ensure("newest kept", circuit.isDuplicateResend(0x0007FF));
+
+		// pings repeat the same oldest id, and one ahead of the newest keeps everything
+		circuit.clearDuplicateList(0x000400);
+		circuit.clearDuplicateList(0x000900);
+		ensure("repeat clear keeps the window", circuit.isDuplicateResend(0x000400));
+
+		circuit.receiveReliable(0x0003FF);	// a late resend lands again
+		ensure("late resend recorded", circuit.isDuplicateResend(0x0003FF));
+		circuit.clearDuplicateList(0x000400);
+		ensure("late resend forgotten", !circuit.isDuplicateResend(0x0003FF));
+	}
+
+	template<> template<>
+	void LLMessageSystemTestObject::test<3>()
+		// collected acks go out in the same bytes the template builder makes
+	{
+		std::string template_file(mTestConfigDir + mSep + "message_template.msg");
+		{
+			llofstream file(template_file.c_str());
+			file << "version 2.0\n"
+				<< "{\n\tPacketAck Fixed 0xFFFFFFFB NotTrusted Unencoded\n"
+				<< "\t{\n\t\tPackets Variable\n\t\t{\tID U32\t}\n\t}\n}\n";
+		}
+		delete static_cast<LLMessageSystem*>(gMessageSystem);
+		gMessageSystem = new LLMessageSystem(template_file, NET_USE_OS_ASSIGNED_PORT,
+											 1, 0, 0, false, 5.f, 100.f);
+		LLFile::remove(template_file);
+		ensure("message system up", gMessageSystem->isOK());
+
+		LLHost self("127.0.0.1", gMessageSystem->mPort);
+		ensure("circuit", gMessageSystem->mCircuitInfo.addCircuitData(self, 0) != NULL);
+		// collects acks for the same host, as the receiving side of the circuit
+		LLCircuitDataPeer receiver(self);
+		const TPACKETID ids[] = { 1, 0x012345, 0xFFFFFF };
+		const S32 count = LL_ARRAY_SIZE(ids);
+
+		gMessageSystem->newMessageFast(_PREHASH_PacketAck);
+		for (S32 i = 0; i < count; ++i)
+		{
+			gMessageSystem->nextBlockFast(_PREHASH_Packets);
+			gMessageSystem->addU32Fast(_PREHASH_ID, ids[i]);
+		}
+		gMessageSystem->sendMessage(self);
+		U8 expected[NET_BUFFER_SIZE];
+		S32 expected_size = receive_from_self(expected);
+		ensure("template built ack received", expected_size > 0);
+
+		for (S32 i = 0; i < count; ++i)
+		{
+			receiver.collectRAck(ids[i]);
+		}
+		ms_sleep(10);	// sendAcks() only sends acks older than the collect time
+		gMessageSystem->mCircuitInfo.sendAcks(0.f);
+		U8 actual[NET_BUFFER_SIZE];
+		S32 actual_size = receive_from_self(actual);
+
+		ensure_equals("ack size", actual_size, expected_size);
+		ensure_equals("block count", (S32)actual[LL_PACKET_ID_SIZE + 4], count);
+		// the flags and packet id differ between the two sends
+		ensure("ack bytes", !memcmp(&expected[PHL_OFFSET], &actual[PHL_OFFSET], actual_size - PHL_OFFSET));
+	}
+}